@@ -13,6 +13,7 @@
 #import "AIUAToolsManager.h"
 #import "AIUAKeychainManager.h"
 #import "AIUAConfigID.h"
+#import "AIUATemplateCatalog.h"
 // 判断是否已接入穿山甲SDK（需要同时检查广告开关和SDK是否存在）
 #if AIUA_AD_ENABLED && __has_include(<BUAdSDK/BUAdSDK.h>)
 #import <BUAdSDK/BUAdSDK.h>
@@ -63,6 +64,9 @@
     
     NSLog(@"[启动] 越狱检测通过");
     
+    // 后台预加载热门模板目录，首页展示时无需再解析 plist
+    [[AIUATemplateCatalog sharedCatalog] preloadInBackground];
+    
     // 初始化 IAP 管理器
     [[AIUAIAPManager sharedManager] startObservingPaymentQueue];
     // 仅冷启动开启一次自动恢复窗口（用于无本地订阅时的自动恢复）
@@ -9,6 +9,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class AIUAParagraphOutputCache;
+
 // 缓存清理完成通知
 extern NSString * const AIUACacheClearedNotification;
 
@@ -52,12 +54,31 @@ extern NSString * const AIUACacheClearedNotification;
 
 // 保存写作详情到plist文件
 - (void)saveWritingToPlist:(NSDictionary *)writingRecord;
+// 按 id 原位替换写作记录（保持列表位置），不存在时新增；与已保存内容一致时不写入，返回是否写入
+- (BOOL)upsertWriting:(NSDictionary *)writingRecord;
 - (NSArray *)loadAllWritings;
 // 根据类型加载写作记录
 - (NSArray *)loadWritingsByType:(NSString *)type;
+// 加载写作记录摘要（id/title/type/createTime/wordCount/prompt/preview，不含正文），供列表页使用
+- (NSArray *)loadAllWritingSummaries;
+- (NSArray *)loadWritingSummariesByType:(NSString *)type;
+// 根据ID加载完整写作记录（含正文）
+- (nullable NSDictionary *)loadWritingWithID:(NSString *)writingID;
 // 根据ID删除写作记录
 - (BOOL)deleteWritingWithID:(NSString *)writingID;
 
+#pragma mark - 写作记录搜索
+
+// 全文搜索写作记录（标题、提示词、正文），返回按相关度排序的摘要，附带 searchText/searchField/searchLocation
+- (NSArray *)searchWritingSummariesWithText:(NSString *)text;
+// 搜索结果的摘录（提示词或正文命中时），highlightRange 为摘录内的高亮范围；标题命中返回 nil
+- (nullable NSString *)searchSnippetForWritingSummary:(NSDictionary *)summary maxLength:(NSUInteger)maxLength highlightRange:(nullable NSRange *)highlightRange;
+
+#pragma mark - 生成结果缓存
+
+// 文档改写/翻译的段落结果缓存（文档删除、清理缓存时一并清除）
+- (AIUAParagraphOutputCache *)sharedParagraphOutputCache;
+
 #pragma mark - 提示词处理
 - (NSString *)extractRequirementFromPrompt:(NSString *)prompt;
 - (NSString *)extractReasonablePartFromPrompt:(NSString *)prompt;
@@ -77,7 +98,7 @@ extern NSString * const AIUACacheClearedNotification;
 
 /**
  * 计算缓存总大小（字节）
- * 包括：AIUARecentUsed.plist、SearchHistory.plist、AIUAWritings.plist
+ * 包括：AIUARecentUsed.plist、SearchHistory.plist、AIUAWritings.plist、段落结果缓存
  */
 - (unsigned long long)calculateCacheSize;
 
@@ -90,7 +111,7 @@ extern NSString * const AIUACacheClearedNotification;
 
 /**
  * 清理缓存文件
- * 清除：AIUARecentUsed.plist、SearchHistory.plist、AIUAWritings.plist
+ * 清除：AIUARecentUsed.plist、SearchHistory.plist、AIUAWritings.plist、段落结果缓存
  * 保留：AIUAFavorites.plist（收藏文件）
  * 清理完成后会发送 AIUACacheClearedNotification 通知
  */
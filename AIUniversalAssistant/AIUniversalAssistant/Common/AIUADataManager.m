@@ -9,6 +9,12 @@
 #import "AIUAMBProgressManager.h"
 #import "AIUAToolsManager.h"
 #import "AIUAWordPackManager.h"
+#import "AIUAWritingStore.h"
+#import "AIUAWritingMigrator.h"
+#import "AIUAWritingSearchIndex.h"
+#import "AIUATemplateCatalog.h"
+#import "AIUAOrderedItemStore.h"
+#import "AIUAParagraphOutputCache.h"
 
 // 缓存清理完成通知
 NSString * const AIUACacheClearedNotification = @"AIUACacheClearedNotification";
@@ -17,6 +23,31 @@ static NSString * const kAIUAFavoritesFileName = @"AIUAFavorites.plist";
 static NSString * const kAIUARecentUsedFileName = @"AIUARecentUsed.plist";
 static NSString * const kAIUASearchHistoryFileName = @"SearchHistory.plist";
 static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
+// 最近使用最多保留的条目数
+static const NSUInteger kAIUARecentUsedLimit = 20;
+// 写作记录日志存储目录（替代整文件重写的 AIUAWritings.plist）
+static NSString * const kAIUAWritingStoreDirectoryName = @"AIUAWritingStore";
+// 写作记录全文索引目录
+static NSString * const kAIUAWritingSearchIndexDirectoryName = @"AIUAWritingSearchIndex";
+// 全文搜索最多返回的记录数
+static const NSUInteger kAIUAWritingSearchResultLimit = 200;
+// 文档改写/翻译的段落结果缓存
+static NSString * const kAIUAParagraphOutputCacheFileName = @"AIUAParagraphOutputCache.plist";
+// 段落结果缓存最多保留的段落数，超出后淘汰最久未使用的
+static const NSUInteger kAIUAParagraphOutputCacheLimit = 1000;
+// 列表摘要中正文预览的最大长度（列表 cell 展示前 100 个字符）
+static const NSUInteger kAIUAWritingPreviewLength = 101;
+
+@interface AIUADataManager ()
+
+@property (nonatomic, strong, nullable) AIUAWritingStore *writingStore;
+@property (nonatomic, strong, nullable) AIUAWritingMigrator *writingMigrator;
+@property (nonatomic, strong, nullable) AIUAWritingSearchIndex *writingSearchIndex;
+@property (nonatomic, strong, nullable) AIUAOrderedItemStore *favoritesStore;
+@property (nonatomic, strong, nullable) AIUAOrderedItemStore *recentUsedStore;
+@property (nonatomic, strong, nullable) AIUAParagraphOutputCache *paragraphOutputCache;
+
+@end
 
 @implementation AIUADataManager
 
@@ -60,9 +91,9 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
 
 #pragma mark - 热门
 
-// "热门"模块数据
+// "热门"模块数据（目录只解析一次，见 AIUATemplateCatalog）
 - (NSArray *)loadHotCategories {
-    return [self safeArrayWithContentsOfBundleResource:@"AIUAHotCategories"];
+    return [[AIUATemplateCatalog sharedCatalog] categories];
 }
 
 // 获取收藏文件路径
@@ -75,10 +106,33 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
     return [self getPlistFilePath:kAIUARecentUsedFileName];
 }
 
+// 收藏与最近使用常驻内存（热门页每个 cell 都会判断是否已收藏），修改后在后台合并写盘
+- (AIUAOrderedItemStore *)favoritesStore {
+    @synchronized (self) {
+        if (!_favoritesStore) {
+            _favoritesStore = [[AIUAOrderedItemStore alloc] initWithFilePath:[self favoritesFilePath] capacity:0 identifier:^NSString *(NSDictionary *item) {
+                return [AIUATemplateCatalog identifierForItem:item];
+            }];
+        }
+        return _favoritesStore;
+    }
+}
+
+- (AIUAOrderedItemStore *)recentUsedStore {
+    @synchronized (self) {
+        if (!_recentUsedStore) {
+            _recentUsedStore = [[AIUAOrderedItemStore alloc] initWithFilePath:[self recentUsedFilePath] capacity:kAIUARecentUsedLimit identifier:^NSString *(NSDictionary *item) {
+                return [AIUATemplateCatalog identifierForItem:item];
+            }];
+        }
+        return _recentUsedStore;
+    }
+}
+
 #pragma mark - 收藏功能
 
 - (NSArray *)loadFavorites {
-    return [self safeArrayFromFile:[self favoritesFilePath]];
+    return [[self favoritesStore] items];
 }
 
 - (void)addFavorite:(NSDictionary *)item {
@@ -86,72 +140,32 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         return;
     }
     
-    NSMutableArray *favorites = [[self loadFavorites] mutableCopy];
-    
     // 检查是否已经收藏
     NSString *itemId = [self getItemId:item];
-    if (itemId.length == 0) {
+    if (itemId.length == 0 || [[self favoritesStore] containsItemWithID:itemId]) {
         return;
     }
-    for (id favItem in favorites) {
-        if (![favItem isKindOfClass:[NSDictionary class]]) {
-            continue;
-        }
-        if ([[self getItemId:favItem] isEqualToString:itemId]) {
-            return; // 已经收藏，直接返回
-        }
-    }
     
     // 添加收藏时间
     NSMutableDictionary *itemWithTime = [item mutableCopy];
     [itemWithTime setObject:[NSDate date] forKey:@"favoriteDate"];
     
-    [favorites insertObject:itemWithTime atIndex:0]; // 最新收藏放在最前面
-    [favorites writeToFile:[self favoritesFilePath] atomically:YES];
+    // 最新收藏放在最前面
+    [[self favoritesStore] insertItem:itemWithTime moveExisting:NO];
 }
 
 - (void)removeFavorite:(NSString *)itemId {
-    if (itemId.length == 0) {
-        return;
-    }
-    
-    NSMutableArray *favorites = [[self loadFavorites] mutableCopy];
-    NSMutableArray *itemsToRemove = [NSMutableArray array];
-    
-    for (id item in favorites) {
-        if (![item isKindOfClass:[NSDictionary class]]) {
-            continue;
-        }
-        if ([[self getItemId:item] isEqualToString:itemId]) {
-            [itemsToRemove addObject:item];
-        }
-    }
-    
-    [favorites removeObjectsInArray:itemsToRemove];
-    [favorites writeToFile:[self favoritesFilePath] atomically:YES];
+    [[self favoritesStore] removeItemWithID:itemId];
 }
 
 - (BOOL)isFavorite:(NSString *)itemId {
-    if (itemId.length == 0) {
-        return NO;
-    }
-    
-    NSArray *favorites = [self loadFavorites];
-    for (id item in favorites) {
-        if (![item isKindOfClass:[NSDictionary class]]) {
-            continue;
-        }
-        if ([[self getItemId:item] isEqualToString:itemId]) {
-            return YES;
-        }
-    }
-    return NO;
+    return [[self favoritesStore] containsItemWithID:itemId];
 }
 
 #pragma mark - 最近使用功能
 
 - (NSArray *)loadRecentUsed {
-    return [self safeArrayFromFile:[self recentUsedFilePath]];
+    return [[self recentUsedStore] items];
 }
 
 - (void)addRecentUsed:(NSDictionary *)item {
@@ -159,66 +173,26 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         return;
     }
     
-    NSMutableArray *recentUsed = [[self loadRecentUsed] mutableCopy];
-    
-    // 检查是否已经存在
     NSString *itemId = [self getItemId:item];
     if (itemId.length == 0) {
         return;
     }
-    NSMutableArray *itemsToRemove = [NSMutableArray array];
-    for (id recentItem in recentUsed) {
-        if (![recentItem isKindOfClass:[NSDictionary class]]) {
-            continue;
-        }
-        if ([[self getItemId:recentItem] isEqualToString:itemId]) {
-            [itemsToRemove addObject:recentItem];
-        }
-    }
-    [recentUsed removeObjectsInArray:itemsToRemove];
     
     // 添加使用时间
     NSMutableDictionary *itemWithTime = [item mutableCopy];
     [itemWithTime setObject:[NSDate date] forKey:@"usedDate"];
     
-    [recentUsed insertObject:itemWithTime atIndex:0]; // 最新使用的放在最前面
-    
-    // 限制最近使用数量为20个
-    if (recentUsed.count > 20) {
-        recentUsed = [[recentUsed subarrayWithRange:NSMakeRange(0, 20)] mutableCopy];
-    }
-    
-    [recentUsed writeToFile:[self recentUsedFilePath] atomically:YES];
+    // 最新使用的放在最前面（已存在时移到最前），超出数量时淘汰最久未使用的
+    [[self recentUsedStore] insertItem:itemWithTime moveExisting:YES];
 }
 
 - (void)clearRecentUsed {
-    [[NSArray array] writeToFile:[self recentUsedFilePath] atomically:YES];
+    [[self recentUsedStore] removeAllItems];
 }
 
 #pragma mark - 搜索
 - (NSArray *)loadSearchCategoriesData {
-    NSArray *categoriesArray = [self loadHotCategories];
-    
-    NSMutableArray *allItems = [NSMutableArray array];
-    for (id category in categoriesArray) {
-        if (![category isKindOfClass:[NSDictionary class]]) {
-            continue;
-        }
-        NSArray *items = category[@"items"];
-        if (![items isKindOfClass:[NSArray class]]) {
-            continue;
-        }
-        for (id item in items) {
-            if ([item isKindOfClass:[NSDictionary class]]) {
-                [allItems addObject:item];
-            }
-        }
-    }
-    
-    if (allItems.count > 0) {
-        return allItems;
-    }
-    return @[];
+    return [[AIUATemplateCatalog sharedCatalog] allItems];
 }
 
 - (NSArray *)loadSearchHistorySearches {
@@ -245,22 +219,53 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         return @[];
     }
     
-    NSArray *categories = [self loadHotCategories];
-    for (id category in categories) {
-        if (![category isKindOfClass:[NSDictionary class]]) {
-            continue;
+    return [[AIUATemplateCatalog sharedCatalog] itemsForCategoryId:categoryId];
+}
+
+#pragma mark - 写作详情
+
+// 列表页只需要的轻量字段，不包含正文全文
+static NSDictionary *AIUAWritingSummaryFromRecord(NSDictionary *record) {
+    NSMutableDictionary *summary = [NSMutableDictionary dictionary];
+    for (NSString *key in @[@"id", @"title", @"type", @"createTime", @"wordCount", @"prompt"]) {
+        id value = record[key];
+        if (value) {
+            summary[key] = value;
         }
-        if ([category[@"id"] isEqualToString:categoryId]) {
-            NSArray *items = category[@"items"];
-            return [items isKindOfClass:[NSArray class]] ? items : @[];
+    }
+    NSString *content = [record[@"content"] isKindOfClass:[NSString class]] ? record[@"content"] : @"";
+    if (content.length > kAIUAWritingPreviewLength) {
+        // 按字符簇截断，避免截断 emoji 等代理对
+        NSRange range = [content rangeOfComposedCharacterSequencesForRange:NSMakeRange(0, kAIUAWritingPreviewLength)];
+        content = [content substringWithRange:range];
+    }
+    summary[@"preview"] = content;
+    return [summary copy];
+}
+
+// 写作记录存储，首次使用时打开并导入旧版 plist，同时在后台打开全文索引
+- (AIUAWritingStore *)sharedWritingStore {
+    @synchronized (self) {
+        if (!self.writingStore) {
+            NSString *directoryPath = [self getPlistFilePath:kAIUAWritingStoreDirectoryName];
+            self.writingStore = [[AIUAWritingStore alloc] initWithDirectoryPath:directoryPath summaryBuilder:^NSDictionary *(NSDictionary *record) {
+                return AIUAWritingSummaryFromRecord(record);
+            }];
+            [self.writingStore importLegacyPlistAtPathIfNeeded:[self getPlistFilePath:kAIUAWritingsFileName]];
+            [self startWritingMigrationsForStore:self.writingStore];
+            self.writingSearchIndex = [[AIUAWritingSearchIndex alloc] initWithDirectoryPath:[self getPlistFilePath:kAIUAWritingSearchIndexDirectoryName]
+                                                                                      store:self.writingStore];
         }
+        return self.writingStore;
     }
-    return @[];
 }
 
-#pragma mark - 写作详情
+- (AIUAWritingSearchIndex *)sharedWritingSearchIndex {
+    [self sharedWritingStore];
+    return self.writingSearchIndex;
+}
 
-// 保存写作详情到plist文件
+// 保存写作详情（追加到日志，最新的在最前面）
 - (void)saveWritingToPlist:(NSDictionary *)writingRecord {
     // 安全检查：确保 writingRecord 不为 nil
     if (!writingRecord || ![writingRecord isKindOfClass:[NSDictionary class]]) {
@@ -269,133 +274,128 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
     }
     
     NSLog(@"saveWritingToPlist-writingRecord:%@", writingRecord[@"content"]);
-    // 获取沙盒Documents目录
-    NSString *plistPath = [self getPlistFilePath:kAIUAWritingsFileName];
-    
-    // 读取现有的写作记录
-    NSMutableArray *writingsArray = [NSMutableArray array];
-    if ([[NSFileManager defaultManager] fileExistsAtPath:plistPath]) {
-        NSArray *existingWritings = [NSArray arrayWithContentsOfFile:plistPath];
-        if (existingWritings && [existingWritings isKindOfClass:[NSArray class]]) {
-            // 确保所有元素都是字典类型
-            for (id item in existingWritings) {
-                if ([item isKindOfClass:[NSDictionary class]]) {
-                    [writingsArray addObject:item];
-                }
-            }
-        }
-    }
-    
-    // 确保 writingsArray 是有效的可变数组
-    if (!writingsArray || ![writingsArray isKindOfClass:[NSMutableArray class]]) {
-        NSLog(@"❌ saveWritingToPlist: writingsArray 初始化失败，重新创建");
-        writingsArray = [NSMutableArray array];
-    }
-    
-    // 添加到数组开头（最新的在最前面）
-    // 安全检查：确保索引有效
-    if (writingsArray.count == 0) {
-        [writingsArray addObject:writingRecord];
+    // 只追加一条记录，不再读取并重写整个文件
+    if ([[self sharedWritingStore] insertRecord:writingRecord]) {
+        NSLog(@"✅ 写作内容已保存，共 %lu 条记录", (unsigned long)[self sharedWritingStore].count);
+        [[self sharedWritingSearchIndex] indexRecord:writingRecord];
     } else {
-        [writingsArray insertObject:writingRecord atIndex:0];
+        NSLog(@"❌ 保存失败: 无法写入写作记录");
+    }
+}
+
+// 按 id 原位替换写作记录（不改变列表位置），不存在时新增；与已保存内容一致时不写入
+- (BOOL)upsertWriting:(NSDictionary *)writingRecord {
+    NSString *writingID = [writingRecord isKindOfClass:[NSDictionary class]] ? writingRecord[@"id"] : nil;
+    if (![writingID isKindOfClass:[NSString class]] || writingID.length == 0) {
+        NSLog(@"❌ upsertWriting: writingRecord 无效或缺少 id");
+        return NO;
     }
     
-    NSData *plistData = [NSPropertyListSerialization dataWithPropertyList:writingsArray format:NSPropertyListXMLFormat_v1_0 options:0 error:nil];
-    
-    // 保存到plist文件
-    if (plistData) {
-        BOOL success = [plistData writeToFile:plistPath atomically:YES];
-        if (success) {
-            NSLog(@"✅ 写作内容已保存到: %@", plistPath);
-        } else {
-            NSLog(@"❌ 保存失败: 无法写入文件");
+    AIUAWritingStore *store = [self sharedWritingStore];
+    __block BOOL exists = NO;
+    __block NSDictionary *savedRecord = writingRecord;
+    // 在存储队列内读取并比较，只有字段变化时才追加一条记录
+    BOOL written = [store transformRecordWithID:writingID usingBlock:^NSDictionary *(NSDictionary *record) {
+        exists = YES;
+        NSMutableDictionary *merged = [record mutableCopy];
+        [merged addEntriesFromDictionary:writingRecord];
+        if ([merged isEqualToDictionary:record]) {
+            return nil;
         }
+        savedRecord = [merged copy];
+        return savedRecord;
+    }];
+    if (!exists) {
+        written = [store insertRecord:writingRecord];
+    }
+    
+    if (written) {
+        NSLog(@"✅ 写作内容已保存（%@）", exists ? @"原位更新" : @"新增");
+        [[self sharedWritingSearchIndex] indexRecord:savedRecord];
+    } else if (exists) {
+        NSLog(@"ℹ️ upsertWriting: 内容未变化，跳过写入");
     } else {
-        NSLog(@"❌ 保存失败: 无法序列化数据");
+        NSLog(@"❌ 保存失败: 无法写入写作记录");
     }
+    return written;
 }
 
-// 提供类方法用于读取所有写作记录
-- (NSArray *)loadAllWritings {
-    NSString *plistPath = [self getPlistFilePath:kAIUAWritingsFileName];
-    NSArray *writings = [self safeArrayFromFile:plistPath];
-    
-    if (writings.count > 0) {
-        
-        // 兼容性修复：历史版本可能用 NSString.length 作为 wordCount，导致与“字数包扣减口径”不一致。
-        // 这里统一为 AIUAWordPackManager 的统计规则（与扣减一致），并回写到 plist。
-        BOOL didModify = NO;
-        NSMutableArray *fixed = [NSMutableArray arrayWithCapacity:writings.count];
-        for (id item in writings) {
-            if (![item isKindOfClass:[NSDictionary class]]) {
-                continue;
-            }
-            NSMutableDictionary *m = [item mutableCopy];
-            NSString *title = m[@"title"] ?: @"";
-            NSString *content = m[@"content"] ?: @"";
-            // 与扣减口径一致：按“标题+正文”整体统计
-            NSMutableString *fullTextForCount = [NSMutableString string];
-            if (title.length > 0) {
-                [fullTextForCount appendString:title];
-            }
-            if (title.length > 0 && content.length > 0) {
-                [fullTextForCount appendString:@"\n"];
-            }
-            if (content.length > 0) {
-                [fullTextForCount appendString:content];
-            }
-            NSInteger recalculated = [AIUAWordPackManager countWordsInText:fullTextForCount];
-            NSNumber *existing = m[@"wordCount"];
-            NSInteger existingValue = [existing isKindOfClass:[NSNumber class]] ? existing.integerValue : -1;
-            
-            if (existingValue != recalculated) {
-                NSLog(@"[DataManager] 📝 修正文档 '%@': 旧=%ld, 新=%ld", 
-                      [title length] > 20 ? [[title substringToIndex:20] stringByAppendingString:@"..."] : title, 
-                      (long)existingValue, (long)recalculated);
-                m[@"wordCount"] = @(recalculated);
-                didModify = YES;
-            }
-            [fixed addObject:[m copy]];
-        }
-        
-        if (didModify) {
-            NSLog(@"[DataManager] ✅ 检测到不一致，回写 plist...");
-            NSData *plistData = [NSPropertyListSerialization dataWithPropertyList:fixed
-                                                                          format:NSPropertyListXMLFormat_v1_0
-                                                                         options:0
-                                                                           error:nil];
-            if (plistData) {
-                BOOL writeSuccess = [plistData writeToFile:plistPath atomically:YES];
-                if (writeSuccess) {
-                    NSLog(@"[DataManager] ✅ wordCount 迁移完成并已回写");
-                } else {
-                    NSLog(@"[DataManager] ❌ wordCount 迁移失败：无法写入文件");
-                }
-            } else {
-                NSLog(@"[DataManager] ❌ wordCount 迁移失败：无法序列化");
-            }
-        } else {
-            NSLog(@"[DataManager] ✓ 所有文档 wordCount 已是最新规则，无需迁移");
-        }
-        
-        return [fixed copy];
+#pragma mark - 写作记录迁移
+
+// 数据版本历史（只能追加，不能修改已发布的步骤）：
+// v1 历史版本可能用 NSString.length 作为 wordCount，导致与“字数包扣减口径”不一致，统一为 AIUAWordPackManager 的统计规则
+- (void)startWritingMigrationsForStore:(AIUAWritingStore *)store {
+    AIUAWritingMigrator *migrator = [[AIUAWritingMigrator alloc] initWithStore:store];
+    [migrator registerVersion:1 name:@"wordCount" transform:^NSDictionary *(NSDictionary *record) {
+        return [AIUADataManager writingRecordByNormalizingWordCount:record];
+    }];
+    self.writingMigrator = migrator;
+    if (![migrator needsMigration]) {
+        return;
+    }
+    // 后台执行，列表页在下次出现时读取到迁移后的摘要
+    [migrator runPendingMigrationsWithCompletion:nil];
+}
+
+// wordCount 与扣减口径一致：按“标题+正文”整体统计；无需修改时返回 nil
++ (NSDictionary *)writingRecordByNormalizingWordCount:(NSDictionary *)record {
+    NSString *title = record[@"title"] ?: @"";
+    NSString *content = record[@"content"] ?: @"";
+    NSMutableString *fullTextForCount = [NSMutableString string];
+    if (title.length > 0) {
+        [fullTextForCount appendString:title];
+    }
+    if (title.length > 0 && content.length > 0) {
+        [fullTextForCount appendString:@"\n"];
+    }
+    if (content.length > 0) {
+        [fullTextForCount appendString:content];
+    }
+    NSInteger recalculated = [AIUAWordPackManager countWordsInText:fullTextForCount];
+    NSNumber *existing = record[@"wordCount"];
+    NSInteger existingValue = [existing isKindOfClass:[NSNumber class]] ? existing.integerValue : -1;
+    if (existingValue == recalculated) {
+        return nil;
     }
     
-    return @[];
+    NSMutableDictionary *m = [record mutableCopy];
+    m[@"wordCount"] = @(recalculated);
+    return [m copy];
+}
+
+// 读取所有写作记录（含正文）
+- (NSArray *)loadAllWritings {
+    return [[self sharedWritingStore] allRecords];
 }
 
 - (NSArray *)loadWritingsByType:(NSString *)type {
-    NSArray *allWritings = [self loadAllWritings];
+    return [self filterWritings:[self loadAllWritings] byType:type];
+}
+
+// 读取所有写作记录摘要（不含正文，列表页使用）
+- (NSArray *)loadAllWritingSummaries {
+    return [[self sharedWritingStore] allSummaries];
+}
+
+- (NSArray *)loadWritingSummariesByType:(NSString *)type {
+    return [self filterWritings:[self loadAllWritingSummaries] byType:type];
+}
+
+- (NSDictionary *)loadWritingWithID:(NSString *)writingID {
+    return [[self sharedWritingStore] recordWithID:writingID];
+}
+
+- (NSArray *)filterWritings:(NSArray *)writings byType:(NSString *)type {
     if (!type || type.length == 0) {
         // 如果type为空，返回type为空或没有type字段的记录
         NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NSDictionary *writing, NSDictionary *bindings) {
             return writing[@"type"] == nil || [writing[@"type"] isEqualToString:@""];
         }];
-        return [allWritings filteredArrayUsingPredicate:predicate];
+        return [writings filteredArrayUsingPredicate:predicate];
     } else {
         // 返回指定type的记录
         NSPredicate *predicate = [NSPredicate predicateWithFormat:@"type == %@", type];
-        return [allWritings filteredArrayUsingPredicate:predicate];
+        return [writings filteredArrayUsingPredicate:predicate];
     }
 }
 
@@ -405,26 +405,84 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         return NO;
     }
     
-    NSString *plistPath = [self getPlistFilePath:kAIUAWritingsFileName];
-    
-    NSMutableArray *writingsArray = [NSMutableArray arrayWithArray:[self loadAllWritings]];
-    
-    // 查找并删除指定ID的记录
-    NSUInteger indexToDelete = NSNotFound;
-    for (NSUInteger i = 0; i < writingsArray.count; i++) {
-        NSDictionary *writing = writingsArray[i];
-        if ([writing[@"id"] isEqualToString:writingID]) {
-            indexToDelete = i;
-            break;
+    // 追加墓碑记录，不再重写整个文件
+    if (![[self sharedWritingStore] removeRecordWithID:writingID]) {
+        return NO;
+    }
+    [[self sharedWritingSearchIndex] removeRecordWithID:writingID];
+    [[self sharedParagraphOutputCache] removeOutputsForDocumentID:writingID];
+    return YES;
+}
+
+#pragma mark - 写作记录搜索
+
+- (NSArray *)searchWritingSummariesWithText:(NSString *)text {
+    NSArray<AIUAWritingSearchResult *> *results = [[self sharedWritingSearchIndex] resultsForText:text limit:kAIUAWritingSearchResultLimit];
+    if (results.count == 0) {
+        return @[];
+    }
+    NSArray *summaries = [self loadAllWritingSummaries];
+    NSMutableDictionary<NSString *, NSDictionary *> *summariesByID = [NSMutableDictionary dictionaryWithCapacity:summaries.count];
+    for (NSDictionary *summary in summaries) {
+        NSString *summaryID = summary[@"id"];
+        if (summaryID) {
+            summariesByID[summaryID] = summary;
         }
     }
-    
-    if (indexToDelete != NSNotFound) {
-        [writingsArray removeObjectAtIndex:indexToDelete];
-        return [writingsArray writeToFile:plistPath atomically:YES];
+
+    NSMutableArray *matches = [NSMutableArray arrayWithCapacity:results.count];
+    for (AIUAWritingSearchResult *result in results) {
+        NSDictionary *summary = summariesByID[result.recordID];
+        if (!summary) {
+            continue;
+        }
+        NSMutableDictionary *match = [summary mutableCopy];
+        match[@"searchText"] = text;
+        match[@"searchField"] = result.field;
+        match[@"searchLocation"] = @(result.location);
+        [matches addObject:[match copy]];
+    }
+    return matches;
+}
+
+- (NSString *)searchSnippetForWritingSummary:(NSDictionary *)summary maxLength:(NSUInteger)maxLength highlightRange:(NSRange *)highlightRange {
+    NSString *field = summary[@"searchField"];
+    if (!field || [field isEqualToString:AIUAWritingSearchFieldTitle]) {
+        return nil;
+    }
+    NSUInteger location = [summary[@"searchLocation"] unsignedIntegerValue];
+    NSString *text = nil;
+    if ([field isEqualToString:AIUAWritingSearchFieldPrompt]) {
+        text = summary[@"prompt"];
+    } else {
+        // 摘录落在列表预览范围内时不读取正文
+        NSString *preview = summary[@"preview"];
+        if ([preview isKindOfClass:[NSString class]] && location + maxLength < preview.length) {
+            text = preview;
+        } else {
+            text = [self loadWritingWithID:summary[@"id"]][@"content"];
+        }
+    }
+    if (![text isKindOfClass:[NSString class]] || text.length == 0) {
+        return nil;
+    }
+    return [AIUAWritingSearchIndex snippetFromText:text
+                                             query:summary[@"searchText"] ?: @""
+                                          location:location
+                                         maxLength:maxLength
+                                    highlightRange:highlightRange];
+}
+
+#pragma mark - 生成结果缓存
+
+- (AIUAParagraphOutputCache *)sharedParagraphOutputCache {
+    @synchronized (self) {
+        if (!_paragraphOutputCache) {
+            _paragraphOutputCache = [[AIUAParagraphOutputCache alloc] initWithFilePath:[self getPlistFilePath:kAIUAParagraphOutputCacheFileName]
+                                                                              capacity:kAIUAParagraphOutputCacheLimit];
+        }
+        return _paragraphOutputCache;
     }
-    
-    return NO;
 }
 
 #pragma mark - 提示词处理
@@ -563,14 +621,7 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
 #pragma mark - 辅助方法
 
 - (NSString *)getItemId:(NSDictionary *)item {
-    if (![item isKindOfClass:[NSDictionary class]]) {
-        return @"";
-    }
-    
-    // 使用 type + title 作为唯一标识
-    NSString *type = item[@"type"] ?: @"";
-    NSString *title = item[@"title"] ?: @"";
-    return [NSString stringWithFormat:@"%@_%@", type, title];
+    return [AIUATemplateCatalog identifierForItem:item];
 }
 
 - (NSString *)generateUniqueID {
@@ -667,6 +718,11 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         }
     }
     
+    // 写作记录日志存储与全文索引
+    totalSize += [[self sharedWritingStore] fileSize];
+    totalSize += [[self sharedWritingSearchIndex] fileSize];
+    totalSize += [[self sharedParagraphOutputCache] fileSize];
+    
     return totalSize;
 }
 
@@ -716,6 +772,20 @@ static NSString * const kAIUAWritingsFileName = @"AIUAWritings.plist";
         }
     }
     
+    // 内存中的最近使用也要清空，否则下次写盘会恢复文件
+    [[self recentUsedStore] removeAllItems];
+    [[self sharedParagraphOutputCache] removeAllOutputs];
+    
+    // 清空写作记录日志存储
+    if ([[self sharedWritingStore] removeAllRecords]) {
+        [[self sharedWritingSearchIndex] removeAllRecords];
+        NSLog(@"[DataManager] 成功清空写作记录存储");
+    } else {
+        NSString *errorMsg = @"清空写作记录存储失败";
+        [errors addObject:errorMsg];
+        NSLog(@"[DataManager] %@", errorMsg);
+    }
+    
     // 发送通知，通知相关页面更新
     [[NSNotificationCenter defaultCenter] postNotificationName:AIUACacheClearedNotification object:nil];
     
@@ -0,0 +1,61 @@
+//
+//  AIUAOrderedItemStore.h
+//  AIUniversalAssistant
+//
+//  有序条目集合（收藏、最近使用）：常驻内存，按 id 哈希，判断是否存在为 O(1)
+//  - 首次访问时读取 plist，之后读写只操作内存
+//  - 修改后延迟合并写盘，写盘在后台 I/O 队列执行；退到后台时立即写盘
+//  - 设置容量后按最近插入淘汰（LRU）
+//  - 线程安全
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 条目唯一标识
+typedef NSString * _Nonnull (^AIUAOrderedItemIdentifier)(NSDictionary *item);
+
+@interface AIUAOrderedItemStore : NSObject
+
+/**
+ * @param filePath plist 文件路径（数组，第 0 个为最新）
+ * @param capacity 最多保留条目数，0 表示不限
+ * @param identifier 条目唯一标识规则
+ */
+- (instancetype)initWithFilePath:(NSString *)filePath
+                        capacity:(NSUInteger)capacity
+                      identifier:(AIUAOrderedItemIdentifier)identifier NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 全部条目，最新在前
+- (NSArray<NSDictionary *> *)items;
+
+/// 是否包含 id 对应的条目
+- (BOOL)containsItemWithID:(NSString *)itemID;
+
+/// id 对应的条目，不存在时返回 nil
+- (nullable NSDictionary *)itemWithID:(NSString *)itemID;
+
+/**
+ * 插入条目到最前
+ * @param moveExisting 已存在时：YES 移到最前并替换为新条目，NO 保持不变
+ * @return 是否有改动
+ */
+- (BOOL)insertItem:(NSDictionary *)item moveExisting:(BOOL)moveExisting;
+
+/// 移除条目，不存在时返回 NO
+- (BOOL)removeItemWithID:(NSString *)itemID;
+
+/// 移除满足条件的条目，返回移除的数量
+- (NSUInteger)removeItemsPassingTest:(BOOL (^)(NSDictionary *item))predicate;
+
+/// 清空全部条目
+- (void)removeAllItems;
+
+/// 立即在后台写盘（有未写入的改动时）
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
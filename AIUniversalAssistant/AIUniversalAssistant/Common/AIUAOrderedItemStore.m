@@ -0,0 +1,256 @@
+//
+//  AIUAOrderedItemStore.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAOrderedItemStore.h"
+#if __has_include(<UIKit/UIKit.h>)
+#import <UIKit/UIKit.h>
+#endif
+
+// 修改后延迟写盘，连续操作只写一次
+static const NSTimeInterval kAIUAOrderedItemStoreWriteDelay = 0.5;
+
+@interface AIUAOrderedItemStore ()
+
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, assign) NSUInteger capacity;
+@property (nonatomic, copy) AIUAOrderedItemIdentifier identifier;
+@property (nonatomic, strong) dispatch_queue_t ioQueue;
+
+// 以下在 @synchronized (self) 内访问
+@property (nonatomic, assign) BOOL loaded;
+@property (nonatomic, strong) NSMutableOrderedSet<NSString *> *orderedIDs;     // 最新在前
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *itemsByID;
+@property (nonatomic, copy, nullable) NSArray<NSDictionary *> *cachedItems;
+@property (nonatomic, assign) BOOL dirty;
+@property (nonatomic, assign) BOOL writeScheduled;
+
+@end
+
+@implementation AIUAOrderedItemStore
+
+- (instancetype)initWithFilePath:(NSString *)filePath capacity:(NSUInteger)capacity identifier:(AIUAOrderedItemIdentifier)identifier {
+    self = [super init];
+    if (self) {
+        _filePath = [filePath copy];
+        _capacity = capacity;
+        _identifier = [identifier copy];
+        _ioQueue = dispatch_queue_create("com.aiua.ordereditemstore.io", DISPATCH_QUEUE_SERIAL);
+        _orderedIDs = [NSMutableOrderedSet orderedSet];
+        _itemsByID = [NSMutableDictionary dictionary];
+
+#if __has_include(<UIKit/UIKit.h>)
+        // 退到后台/即将终止时立即写盘，避免被系统回收时丢失（macOS 命令行测试没有 UIKit，不监听）
+        for (NSNotificationName name in @[UIApplicationDidEnterBackgroundNotification,
+                                          UIApplicationWillTerminateNotification]) {
+            [[NSNotificationCenter defaultCenter] addObserver:self
+                                                     selector:@selector(applicationLifecycleWillSuspend:)
+                                                         name:name
+                                                       object:nil];
+        }
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)applicationLifecycleWillSuspend:(NSNotification *)notification {
+    dispatch_sync(self.ioQueue, ^{
+        [self writeIfDirty];
+    });
+}
+
+#pragma mark - 加载
+
+// 在 @synchronized (self) 内调用
+- (void)loadIfNeeded {
+    if (self.loaded) {
+        return;
+    }
+    self.loaded = YES;
+    if (![[NSFileManager defaultManager] fileExistsAtPath:self.filePath]) {
+        return;
+    }
+    NSArray *array = [NSArray arrayWithContentsOfFile:self.filePath];
+    if (![array isKindOfClass:[NSArray class]]) {
+        NSLog(@"[OrderedItemStore] 无法读取数组文件: %@", self.filePath);
+        return;
+    }
+    for (id item in array) {
+        if (![item isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        NSString *itemID = self.identifier(item);
+        // 旧文件中可能有重复条目，保留靠前（较新）的
+        if (itemID.length == 0 || self.itemsByID[itemID]) {
+            continue;
+        }
+        [self.orderedIDs addObject:itemID];
+        self.itemsByID[itemID] = item;
+        if (self.capacity > 0 && self.orderedIDs.count >= self.capacity) {
+            break;
+        }
+    }
+}
+
+#pragma mark - 读取
+
+- (NSArray<NSDictionary *> *)items {
+    @synchronized (self) {
+        [self loadIfNeeded];
+        if (!self.cachedItems) {
+            NSMutableArray<NSDictionary *> *items = [NSMutableArray arrayWithCapacity:self.orderedIDs.count];
+            for (NSString *itemID in self.orderedIDs) {
+                [items addObject:self.itemsByID[itemID]];
+            }
+            self.cachedItems = items;
+        }
+        return self.cachedItems;
+    }
+}
+
+- (BOOL)containsItemWithID:(NSString *)itemID {
+    if (itemID.length == 0) {
+        return NO;
+    }
+    @synchronized (self) {
+        [self loadIfNeeded];
+        return self.itemsByID[itemID] != nil;
+    }
+}
+
+- (NSDictionary *)itemWithID:(NSString *)itemID {
+    if (itemID.length == 0) {
+        return nil;
+    }
+    @synchronized (self) {
+        [self loadIfNeeded];
+        return self.itemsByID[itemID];
+    }
+}
+
+#pragma mark - 修改
+
+- (BOOL)insertItem:(NSDictionary *)item moveExisting:(BOOL)moveExisting {
+    NSString *itemID = self.identifier(item);
+    if (itemID.length == 0) {
+        return NO;
+    }
+    @synchronized (self) {
+        [self loadIfNeeded];
+        if (self.itemsByID[itemID]) {
+            if (!moveExisting) {
+                return NO;
+            }
+            [self.orderedIDs removeObject:itemID];
+        }
+        [self.orderedIDs insertObject:itemID atIndex:0];
+        self.itemsByID[itemID] = [item copy];
+
+        // 超出容量时淘汰最久未使用的
+        while (self.capacity > 0 && self.orderedIDs.count > self.capacity) {
+            NSString *evictedID = self.orderedIDs.lastObject;
+            [self.orderedIDs removeObjectAtIndex:self.orderedIDs.count - 1];
+            [self.itemsByID removeObjectForKey:evictedID];
+        }
+        [self didChange];
+        return YES;
+    }
+}
+
+- (BOOL)removeItemWithID:(NSString *)itemID {
+    if (itemID.length == 0) {
+        return NO;
+    }
+    @synchronized (self) {
+        [self loadIfNeeded];
+        if (!self.itemsByID[itemID]) {
+            return NO;
+        }
+        [self.orderedIDs removeObject:itemID];
+        [self.itemsByID removeObjectForKey:itemID];
+        [self didChange];
+        return YES;
+    }
+}
+
+- (NSUInteger)removeItemsPassingTest:(BOOL (^)(NSDictionary *item))predicate {
+    @synchronized (self) {
+        [self loadIfNeeded];
+        NSMutableArray<NSString *> *removedIDs = [NSMutableArray array];
+        [self.itemsByID enumerateKeysAndObjectsUsingBlock:^(NSString *itemID, NSDictionary *item, BOOL *stop) {
+            if (predicate(item)) {
+                [removedIDs addObject:itemID];
+            }
+        }];
+        if (removedIDs.count == 0) {
+            return 0;
+        }
+        [self.orderedIDs removeObjectsInArray:removedIDs];
+        [self.itemsByID removeObjectsForKeys:removedIDs];
+        [self didChange];
+        return removedIDs.count;
+    }
+}
+
+- (void)removeAllItems {
+    @synchronized (self) {
+        // 清空后无需读取旧文件
+        self.loaded = YES;
+        [self.orderedIDs removeAllObjects];
+        [self.itemsByID removeAllObjects];
+        [self didChange];
+    }
+}
+
+#pragma mark - 写盘
+
+// 在 @synchronized (self) 内调用
+- (void)didChange {
+    self.cachedItems = nil;
+    self.dirty = YES;
+    if (self.writeScheduled) {
+        return;
+    }
+    self.writeScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kAIUAOrderedItemStoreWriteDelay * NSEC_PER_SEC)), self.ioQueue, ^{
+        [self writeIfDirty];
+    });
+}
+
+- (void)flush {
+    dispatch_async(self.ioQueue, ^{
+        [self writeIfDirty];
+    });
+}
+
+// 只在 ioQueue 上调用；写盘用的是此刻的内存快照，先后多次修改只写最后一次
+- (void)writeIfDirty {
+    NSArray<NSDictionary *> *items = nil;
+    @synchronized (self) {
+        self.writeScheduled = NO;
+        if (!self.dirty) {
+            return;
+        }
+        self.dirty = NO;
+        items = [self items];
+    }
+
+    if (items.count == 0) {
+        [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+        return;
+    }
+    if (![items writeToFile:self.filePath atomically:YES]) {
+        NSLog(@"[OrderedItemStore] ❌ 写入失败: %@", self.filePath);
+        // 留待下次修改或退到后台时重试
+        @synchronized (self) {
+            self.dirty = YES;
+        }
+    }
+}
+
+@end
@@ -0,0 +1,49 @@
+//
+//  AIUAParagraphOutputCache.h
+//  AIUniversalAssistant
+//
+//  段落生成结果缓存（改写、翻译）：段落内容哈希 → 模型输出
+//  - 按文档与生成参数（编辑类型、风格、长度、语言）区分，参数变化即不命中
+//  - 再次改写/翻译时只请求有改动的段落，未改动的段落直接拼接缓存结果
+//  - 落盘在一个有容量上限的 plist 中，按最近使用淘汰（见 AIUAOrderedItemStore）
+//  - 线程安全
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAParagraphOutputCache : NSObject
+
+/**
+ * @param filePath plist 文件路径
+ * @param capacity 最多缓存的段落数
+ */
+- (instancetype)initWithFilePath:(NSString *)filePath capacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 生成参数上下文，各参数任一不同即视为不同的缓存
++ (NSString *)contextWithDocumentID:(NSString *)documentID parameters:(NSArray<NSString *> *)parameters;
+
+/// 段落（去掉首尾空白后）的缓存结果，命中时刷新为最近使用
+- (nullable NSString *)outputForParagraph:(NSString *)paragraph context:(NSString *)context;
+
+/**
+ * 缓存一段原文（可含多个段落）的生成结果
+ * 原文与输出按非空行一一对应拆分后逐段缓存；段落数不一致时无法对应，不缓存
+ * @return 缓存的段落数
+ */
+- (NSUInteger)storeOutput:(NSString *)output forText:(NSString *)text context:(NSString *)context;
+
+/// 移除某个文档的全部缓存（文档删除时）
+- (void)removeOutputsForDocumentID:(NSString *)documentID;
+
+/// 清空全部缓存
+- (void)removeAllOutputs;
+
+/// 缓存文件大小（字节）
+- (unsigned long long)fileSize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,129 @@
+//
+//  AIUAParagraphOutputCache.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAParagraphOutputCache.h"
+#import "AIUAOrderedItemStore.h"
+#import <CommonCrypto/CommonDigest.h>
+
+// 上下文各部分的分隔符（不会出现在文档 id 与界面参数中）
+static NSString * const kAIUAParagraphCacheSeparator = @"\u001F";
+
+static NSString * const kAIUAParagraphCacheKeyID = @"id";
+static NSString * const kAIUAParagraphCacheKeyContext = @"context";
+static NSString * const kAIUAParagraphCacheKeyOutput = @"output";
+
+@interface AIUAParagraphOutputCache ()
+
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic, strong) AIUAOrderedItemStore *store;
+
+@end
+
+@implementation AIUAParagraphOutputCache
+
+- (instancetype)initWithFilePath:(NSString *)filePath capacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _filePath = [filePath copy];
+        _store = [[AIUAOrderedItemStore alloc] initWithFilePath:filePath capacity:MAX(capacity, (NSUInteger)1) identifier:^NSString *(NSDictionary *item) {
+            NSString *itemID = item[kAIUAParagraphCacheKeyID];
+            return [itemID isKindOfClass:[NSString class]] ? itemID : @"";
+        }];
+    }
+    return self;
+}
+
++ (NSString *)contextWithDocumentID:(NSString *)documentID parameters:(NSArray<NSString *> *)parameters {
+    NSMutableArray<NSString *> *components = [NSMutableArray arrayWithObject:documentID ?: @""];
+    [components addObjectsFromArray:parameters ?: @[]];
+    return [components componentsJoinedByString:kAIUAParagraphCacheSeparator];
+}
+
+#pragma mark - 键
+
++ (NSString *)keyForParagraph:(NSString *)paragraph context:(NSString *)context {
+    NSString *raw = [NSString stringWithFormat:@"%@%@%@", context, kAIUAParagraphCacheSeparator, paragraph];
+    NSData *data = [raw dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    NSMutableString *hex = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [hex appendFormat:@"%02x", digest[i]];
+    }
+    return hex;
+}
+
+// 按行拆分为段落，去掉首尾空白并丢弃空行
++ (NSArray<NSString *> *)paragraphsOfText:(NSString *)text {
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    for (NSString *line in [text componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]]) {
+        NSString *paragraph = [line stringByTrimmingCharactersInSet:whitespace];
+        if (paragraph.length > 0) {
+            [paragraphs addObject:paragraph];
+        }
+    }
+    return paragraphs;
+}
+
+#pragma mark - 读写
+
+- (NSString *)outputForParagraph:(NSString *)paragraph context:(NSString *)context {
+    NSString *trimmed = [paragraph stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if (trimmed.length == 0) {
+        return nil;
+    }
+    NSString *key = [AIUAParagraphOutputCache keyForParagraph:trimmed context:context];
+    NSDictionary *item = [self.store itemWithID:key];
+    NSString *output = item[kAIUAParagraphCacheKeyOutput];
+    if (![output isKindOfClass:[NSString class]] || output.length == 0) {
+        return nil;
+    }
+    // 命中后移到最前，避免常用的段落被淘汰
+    [self.store insertItem:item moveExisting:YES];
+    return output;
+}
+
+- (NSUInteger)storeOutput:(NSString *)output forText:(NSString *)text context:(NSString *)context {
+    NSArray<NSString *> *sources = [AIUAParagraphOutputCache paragraphsOfText:text ?: @""];
+    NSArray<NSString *> *outputs = [AIUAParagraphOutputCache paragraphsOfText:output ?: @""];
+    if (sources.count == 0 || sources.count != outputs.count) {
+        NSLog(@"[ParagraphCache] 段落数不一致，不缓存 source=%lu output=%lu",
+              (unsigned long)sources.count, (unsigned long)outputs.count);
+        return 0;
+    }
+    for (NSUInteger i = 0; i < sources.count; i++) {
+        [self.store insertItem:@{kAIUAParagraphCacheKeyID: [AIUAParagraphOutputCache keyForParagraph:sources[i] context:context],
+                                 kAIUAParagraphCacheKeyContext: context,
+                                 kAIUAParagraphCacheKeyOutput: outputs[i]}
+                  moveExisting:YES];
+    }
+    return sources.count;
+}
+
+- (void)removeOutputsForDocumentID:(NSString *)documentID {
+    if (documentID.length == 0) {
+        return;
+    }
+    NSString *prefix = [documentID stringByAppendingString:kAIUAParagraphCacheSeparator];
+    NSUInteger removed = [self.store removeItemsPassingTest:^BOOL(NSDictionary *item) {
+        NSString *context = item[kAIUAParagraphCacheKeyContext];
+        return [context isKindOfClass:[NSString class]] && [context hasPrefix:prefix];
+    }];
+    if (removed > 0) {
+        NSLog(@"[ParagraphCache] 移除文档 %@ 的缓存 %lu 段", documentID, (unsigned long)removed);
+    }
+}
+
+- (void)removeAllOutputs {
+    [self.store removeAllItems];
+}
+
+- (unsigned long long)fileSize {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.filePath error:nil];
+    return [attributes[NSFileSize] unsignedLongLongValue];
+}
+
+@end
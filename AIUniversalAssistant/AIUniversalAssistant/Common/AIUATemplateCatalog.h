@@ -0,0 +1,47 @@
+//
+//  AIUATemplateCatalog.h
+//  AIUniversalAssistant
+//
+//  热门模板目录：AIUAHotCategories.plist 只解析一次并建立索引
+//  - 启动时在后台队列预加载；预加载完成前的首次访问会等待（或直接在当前线程）加载完成
+//  - 分类 id -> 分类、模板 id -> 模板 两个哈希索引，切换分类不再重新解析 plist 和线性查找
+//  - 按当前语言预先建立搜索索引（见 AIUATemplateSearchEngine），语言变化后重新建立
+//  - 加载后数据只读，线程安全
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUATemplateSearchEngine.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUATemplateCatalog : NSObject
+
++ (instancetype)sharedCatalog;
+
+/// 在后台队列加载目录（重复调用无副作用），应在启动时尽早调用
+- (void)preloadInBackground;
+
+/// 全部分类，顺序与 plist 一致
+- (NSArray<NSDictionary *> *)categories;
+
+/// 根据分类 id 查找分类
+- (nullable NSDictionary *)categoryWithId:(NSString *)categoryId;
+
+/// 分类下的模板，分类不存在时返回空数组
+- (NSArray<NSDictionary *> *)itemsForCategoryId:(NSString *)categoryId;
+
+/// 全部模板（按分类顺序展开）
+- (NSArray<NSDictionary *> *)allItems;
+
+/// 根据模板 id（见 identifierForItem:）查找模板
+- (nullable NSDictionary *)itemWithId:(NSString *)itemId;
+
+/// 当前语言的模板搜索引擎，首次调用或语言变化时建立索引
+- (AIUATemplateSearchEngine *)searchEngine;
+
+/// 模板唯一标识：type + title
++ (NSString *)identifierForItem:(NSDictionary *)item;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,217 @@
+//
+//  AIUATemplateCatalog.m
+//  AIUniversalAssistant
+//
+
+#import "AIUATemplateCatalog.h"
+
+static NSString * const kAIUATemplateCatalogResourceName = @"AIUAHotCategories";
+
+@interface AIUATemplateCatalog ()
+
+@property (nonatomic, strong) dispatch_queue_t loadQueue;
+@property (atomic, assign) BOOL loaded;
+
+@property (nonatomic, copy) NSArray<NSDictionary *> *categoryList;
+@property (nonatomic, copy) NSDictionary<NSString *, NSDictionary *> *categoriesById;
+@property (nonatomic, copy) NSDictionary<NSString *, NSArray<NSDictionary *> *> *itemsByCategoryId;
+@property (nonatomic, copy) NSArray<NSDictionary *> *itemList;
+@property (nonatomic, copy) NSDictionary<NSString *, NSDictionary *> *itemsById;
+
+// 搜索引擎，只在 loadQueue 上读写
+@property (nonatomic, strong, nullable) AIUATemplateSearchEngine *currentSearchEngine;
+
+@end
+
+@implementation AIUATemplateCatalog
+
++ (instancetype)sharedCatalog {
+    static AIUATemplateCatalog *sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _loadQueue = dispatch_queue_create("com.aiua.templatecatalog", DISPATCH_QUEUE_SERIAL);
+        _categoryList = @[];
+        _categoriesById = @{};
+        _itemsByCategoryId = @{};
+        _itemList = @[];
+        _itemsById = @{};
+    }
+    return self;
+}
+
++ (NSString *)identifierForItem:(NSDictionary *)item {
+    if (![item isKindOfClass:[NSDictionary class]]) {
+        return @"";
+    }
+    // 使用 type + title 作为唯一标识
+    NSString *type = item[@"type"] ?: @"";
+    NSString *title = item[@"title"] ?: @"";
+    return [NSString stringWithFormat:@"%@_%@", type, title];
+}
+
+#pragma mark - 加载
+
+- (void)preloadInBackground {
+    if (self.loaded) {
+        return;
+    }
+    dispatch_async(self.loadQueue, ^{
+        [self loadIfNeeded];
+        [self searchEngineForLocale:[NSLocale currentLocale]];
+    });
+}
+
+// 预加载进行中时 dispatch_sync 会排在它后面，等待其完成
+- (void)ensureLoaded {
+    if (self.loaded) {
+        return;
+    }
+    dispatch_sync(self.loadQueue, ^{
+        [self loadIfNeeded];
+    });
+}
+
+// 只在 loadQueue 上调用
+- (void)loadIfNeeded {
+    if (self.loaded) {
+        return;
+    }
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSArray *categories = [self readBundledCategories];
+
+    NSMutableArray<NSDictionary *> *categoryList = [NSMutableArray arrayWithCapacity:categories.count];
+    NSMutableDictionary<NSString *, NSDictionary *> *categoriesById = [NSMutableDictionary dictionaryWithCapacity:categories.count];
+    NSMutableDictionary<NSString *, NSArray<NSDictionary *> *> *itemsByCategoryId = [NSMutableDictionary dictionaryWithCapacity:categories.count];
+    NSMutableArray<NSDictionary *> *itemList = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSDictionary *> *itemsById = [NSMutableDictionary dictionary];
+
+    for (id category in categories) {
+        if (![category isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        [categoryList addObject:category];
+
+        NSMutableArray<NSDictionary *> *validItems = [NSMutableArray array];
+        NSArray *items = category[@"items"];
+        if ([items isKindOfClass:[NSArray class]]) {
+            for (id item in items) {
+                if (![item isKindOfClass:[NSDictionary class]]) {
+                    continue;
+                }
+                [validItems addObject:item];
+                [itemList addObject:item];
+                // 同一模板出现在多个分类时保留第一次出现的
+                NSString *itemId = [AIUATemplateCatalog identifierForItem:item];
+                if (!itemsById[itemId]) {
+                    itemsById[itemId] = item;
+                }
+            }
+        }
+
+        NSString *categoryId = category[@"id"];
+        if ([categoryId isKindOfClass:[NSString class]] && categoryId.length > 0 && !categoriesById[categoryId]) {
+            categoriesById[categoryId] = category;
+            itemsByCategoryId[categoryId] = [validItems copy];
+        }
+    }
+
+    self.categoryList = categoryList;
+    self.categoriesById = categoriesById;
+    self.itemsByCategoryId = itemsByCategoryId;
+    self.itemList = itemList;
+    self.itemsById = itemsById;
+    self.loaded = YES;
+
+    NSLog(@"[TemplateCatalog] 加载完成：%lu 个分类，%lu 个模板，耗时 %.2fms",
+          (unsigned long)categoryList.count, (unsigned long)itemList.count,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+}
+
+// 打包时 Xcode 已将资源 plist 转为二进制格式，这里映射读取后直接反序列化为不可变对象
+- (NSArray *)readBundledCategories {
+    NSString *path = [[NSBundle mainBundle] pathForResource:kAIUATemplateCatalogResourceName ofType:@"plist"];
+    if (path.length == 0) {
+        NSLog(@"[TemplateCatalog] %@.plist 文件未找到", kAIUATemplateCatalogResourceName);
+        return @[];
+    }
+
+    NSError *error = nil;
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:&error];
+    if (!data) {
+        NSLog(@"[TemplateCatalog] 读取失败: %@", error.localizedDescription);
+        return @[];
+    }
+    id object = [NSPropertyListSerialization propertyListWithData:data
+                                                          options:NSPropertyListImmutable
+                                                           format:NULL
+                                                            error:&error];
+    if (![object isKindOfClass:[NSArray class]]) {
+        NSLog(@"[TemplateCatalog] 无法解析 %@: %@", path, error.localizedDescription);
+        return @[];
+    }
+    return object;
+}
+
+// 只在 loadQueue 上调用；语言变化时重新建立
+- (AIUATemplateSearchEngine *)searchEngineForLocale:(NSLocale *)locale {
+    if (!self.currentSearchEngine || ![self.currentSearchEngine.locale.localeIdentifier isEqualToString:locale.localeIdentifier]) {
+        self.currentSearchEngine = [[AIUATemplateSearchEngine alloc] initWithItems:self.itemList locale:locale];
+    }
+    return self.currentSearchEngine;
+}
+
+#pragma mark - 查询
+
+- (NSArray<NSDictionary *> *)categories {
+    [self ensureLoaded];
+    return self.categoryList;
+}
+
+- (NSDictionary *)categoryWithId:(NSString *)categoryId {
+    if (categoryId.length == 0) {
+        return nil;
+    }
+    [self ensureLoaded];
+    return self.categoriesById[categoryId];
+}
+
+- (NSArray<NSDictionary *> *)itemsForCategoryId:(NSString *)categoryId {
+    if (categoryId.length == 0) {
+        return @[];
+    }
+    [self ensureLoaded];
+    return self.itemsByCategoryId[categoryId] ?: @[];
+}
+
+- (NSArray<NSDictionary *> *)allItems {
+    [self ensureLoaded];
+    return self.itemList;
+}
+
+- (NSDictionary *)itemWithId:(NSString *)itemId {
+    if (itemId.length == 0) {
+        return nil;
+    }
+    [self ensureLoaded];
+    return self.itemsById[itemId];
+}
+
+- (AIUATemplateSearchEngine *)searchEngine {
+    NSLocale *locale = [NSLocale currentLocale];
+    __block AIUATemplateSearchEngine *engine = nil;
+    dispatch_sync(self.loadQueue, ^{
+        [self loadIfNeeded];
+        engine = [self searchEngineForLocale:locale];
+    });
+    return engine;
+}
+
+@end
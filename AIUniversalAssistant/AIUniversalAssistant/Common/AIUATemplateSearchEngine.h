@@ -0,0 +1,40 @@
+//
+//  AIUATemplateSearchEngine.h
+//  AIUniversalAssistant
+//
+//  模板搜索引擎：一次建立索引，逐键输入时增量收窄
+//  - 字符二元组倒排索引（单字查询用单字索引），支持中文及任意文字的子串匹配
+//  - 前缀字典树：汉字转全拼和首字母（从每个音节起始处建立后缀键，"jiang"、"jc" 都能命中「演讲词」），英文/数字按单词建立键
+//  - 新查询是上一次查询的延长时，只在上一次的结果中过滤，不再查索引
+//  - 排序：标题命中 > 副标题命中 > 描述命中；同一字段中子串命中 > 全拼命中 > 首字母命中，开头命中优先
+//  - 索引建立后只读；查询会更新收窄缓存，需在同一线程（主线程）调用
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUATemplateSearchEngine : NSObject
+
+/// 参与搜索的模板
+@property (nonatomic, copy, readonly) NSArray<NSDictionary *> *items;
+
+/// 建立索引的语言（大小写、全半角归一化规则）
+@property (nonatomic, strong, readonly) NSLocale *locale;
+
+/**
+ * 建立索引，模板越多越耗时，应在后台线程调用
+ * 参与搜索的字段：title、subtitle、description
+ */
+- (instancetype)initWithItems:(NSArray<NSDictionary *> *)items locale:(NSLocale *)locale NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 搜索模板，按相关度降序，相关度相同时保持 items 中的顺序
+ * @param text 用户输入，可为中文、英文、全拼或拼音首字母（拼音中的空格和 ' 会被忽略）
+ */
+- (NSArray<NSDictionary *> *)itemsMatchingText:(NSString *)text;
+
+@end
+
+NS_ASSUME_NONNULL_END
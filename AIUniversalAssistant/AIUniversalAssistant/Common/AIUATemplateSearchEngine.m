@@ -0,0 +1,366 @@
+//
+//  AIUATemplateSearchEngine.m
+//  AIUniversalAssistant
+//
+
+#import "AIUATemplateSearchEngine.h"
+
+// 参与搜索的字段，顺序即优先级
+typedef NS_ENUM(NSUInteger, AIUATemplateSearchField) {
+    AIUATemplateSearchFieldTitle = 0,
+    AIUATemplateSearchFieldSubtitle,
+    AIUATemplateSearchFieldDescription,
+    AIUATemplateSearchFieldCount
+};
+
+static NSString * const kAIUATemplateSearchFieldKeys[AIUATemplateSearchFieldCount] = {@"title", @"subtitle", @"description"};
+static const NSInteger kAIUATemplateSearchFieldWeights[AIUATemplateSearchFieldCount] = {300, 200, 100};
+
+// 同一字段内的命中方式得分，均小于字段权重之差，保证字段优先
+static const NSInteger kAIUATemplateSearchScoreSubstringAtStart = 40;
+static const NSInteger kAIUATemplateSearchScoreSubstring = 30;
+static const NSInteger kAIUATemplateSearchScorePinyinAtStart = 25;
+static const NSInteger kAIUATemplateSearchScorePinyin = 20;
+static const NSInteger kAIUATemplateSearchScoreInitialsAtStart = 15;
+static const NSInteger kAIUATemplateSearchScoreInitials = 10;
+
+// 与 AIUATemplateCatalog 一致：忽略大小写和全半角
+static const NSStringCompareOptions kAIUATemplateSearchFoldOptions = NSCaseInsensitiveSearch | NSWidthInsensitiveSearch;
+
+static BOOL AIUATemplateSearchIsHan(unichar c) {
+    return (c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF) || (c >= 0xF900 && c <= 0xFAFF);
+}
+
+static BOOL AIUATemplateSearchIsASCIIAlphanumeric(unichar c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+#pragma mark - 索引结构
+
+@interface AIUATemplateSearchTrieNode : NSObject
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, AIUATemplateSearchTrieNode *> *children;
+@property (nonatomic, strong) NSMutableIndexSet *items;  // 键经过该节点的模板，即以该前缀开头的模板
+@end
+
+@implementation AIUATemplateSearchTrieNode
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _children = [NSMutableDictionary dictionary];
+        _items = [NSMutableIndexSet indexSet];
+    }
+    return self;
+}
+@end
+
+// 单个模板的归一化字段和拼音键，用于打分和增量收窄时的逐条校验
+@interface AIUATemplateSearchDocument : NSObject
+@property (nonatomic, copy) NSArray<NSString *> *texts;                     // 每个字段归一化后的文本
+@property (nonatomic, copy) NSArray<NSArray<NSString *> *> *fullKeys;       // 每个字段的全拼键，下标 0 为从开头起的键
+@property (nonatomic, copy) NSArray<NSArray<NSString *> *> *initialKeys;    // 每个字段的首字母键
+@end
+
+@implementation AIUATemplateSearchDocument
+@end
+
+@interface AIUATemplateSearchEngine ()
+
+@property (nonatomic, copy, readwrite) NSArray<NSDictionary *> *items;
+@property (nonatomic, strong, readwrite) NSLocale *locale;
+@property (nonatomic, copy) NSArray<AIUATemplateSearchDocument *> *documents;
+@property (nonatomic, copy) NSDictionary<NSString *, NSIndexSet *> *unigramIndex;
+@property (nonatomic, copy) NSDictionary<NSString *, NSIndexSet *> *bigramIndex;
+@property (nonatomic, strong) AIUATemplateSearchTrieNode *trieRoot;
+
+// 上一次查询，用于增量收窄
+@property (nonatomic, copy, nullable) NSString *lastQuery;
+@property (nonatomic, copy, nullable) NSString *lastPinyinQuery;
+@property (nonatomic, copy, nullable) NSIndexSet *lastMatches;
+
+@end
+
+@implementation AIUATemplateSearchEngine
+
+- (instancetype)initWithItems:(NSArray<NSDictionary *> *)items locale:(NSLocale *)locale {
+    self = [super init];
+    if (self) {
+        _items = [items copy];
+        _locale = locale;
+        [self buildIndexes];
+    }
+    return self;
+}
+
+#pragma mark - 建立索引
+
+- (void)buildIndexes {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSMutableDictionary<NSString *, NSString *> *pinyinCache = [NSMutableDictionary dictionary];
+    NSMutableArray<AIUATemplateSearchDocument *> *documents = [NSMutableArray arrayWithCapacity:self.items.count];
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *unigramIndex = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *bigramIndex = [NSMutableDictionary dictionary];
+    AIUATemplateSearchTrieNode *trieRoot = [[AIUATemplateSearchTrieNode alloc] init];
+
+    [self.items enumerateObjectsUsingBlock:^(NSDictionary *item, NSUInteger idx, BOOL *stop) {
+        NSMutableArray<NSString *> *texts = [NSMutableArray arrayWithCapacity:AIUATemplateSearchFieldCount];
+        NSMutableArray<NSArray<NSString *> *> *fullKeys = [NSMutableArray arrayWithCapacity:AIUATemplateSearchFieldCount];
+        NSMutableArray<NSArray<NSString *> *> *initialKeys = [NSMutableArray arrayWithCapacity:AIUATemplateSearchFieldCount];
+
+        for (NSUInteger field = 0; field < AIUATemplateSearchFieldCount; field++) {
+            id value = [item isKindOfClass:[NSDictionary class]] ? item[kAIUATemplateSearchFieldKeys[field]] : nil;
+            NSString *text = [value isKindOfClass:[NSString class]] ? [self foldedString:value] : @"";
+            [texts addObject:text];
+
+            // 单字、二元组倒排
+            for (NSUInteger i = 0; i < text.length; i++) {
+                [self addIndex:idx forKey:[text substringWithRange:NSMakeRange(i, 1)] toIndex:unigramIndex];
+                if (i + 1 < text.length) {
+                    [self addIndex:idx forKey:[text substringWithRange:NSMakeRange(i, 2)] toIndex:bigramIndex];
+                }
+            }
+
+            // 拼音、英文单词前缀
+            NSArray<NSString *> *syllables = [self syllablesForText:text pinyinCache:pinyinCache];
+            NSMutableArray<NSString *> *full = [NSMutableArray arrayWithCapacity:syllables.count];
+            NSMutableArray<NSString *> *initials = [NSMutableArray arrayWithCapacity:syllables.count];
+            NSString *fullSuffix = @"";
+            NSString *initialSuffix = @"";
+            for (NSInteger i = (NSInteger)syllables.count - 1; i >= 0; i--) {
+                NSString *syllable = syllables[i];
+                fullSuffix = [syllable stringByAppendingString:fullSuffix];
+                initialSuffix = [[syllable substringToIndex:1] stringByAppendingString:initialSuffix];
+                [full insertObject:fullSuffix atIndex:0];
+                [initials insertObject:initialSuffix atIndex:0];
+                [self insertKey:fullSuffix index:idx intoTrie:trieRoot];
+                [self insertKey:initialSuffix index:idx intoTrie:trieRoot];
+            }
+            [fullKeys addObject:full];
+            [initialKeys addObject:initials];
+        }
+
+        AIUATemplateSearchDocument *document = [[AIUATemplateSearchDocument alloc] init];
+        document.texts = texts;
+        document.fullKeys = fullKeys;
+        document.initialKeys = initialKeys;
+        [documents addObject:document];
+    }];
+
+    self.documents = documents;
+    self.unigramIndex = unigramIndex;
+    self.bigramIndex = bigramIndex;
+    self.trieRoot = trieRoot;
+
+    NSLog(@"[TemplateSearch] 索引建立完成：%lu 个模板，%lu 个二元组，耗时 %.2fms",
+          (unsigned long)documents.count, (unsigned long)bigramIndex.count,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+}
+
+- (NSString *)foldedString:(NSString *)string {
+    return [string stringByFoldingWithOptions:kAIUATemplateSearchFoldOptions locale:self.locale];
+}
+
+- (void)addIndex:(NSUInteger)index forKey:(NSString *)key toIndex:(NSMutableDictionary<NSString *, NSMutableIndexSet *> *)invertedIndex {
+    NSMutableIndexSet *postings = invertedIndex[key];
+    if (!postings) {
+        postings = [NSMutableIndexSet indexSet];
+        invertedIndex[key] = postings;
+    }
+    [postings addIndex:index];
+}
+
+- (void)insertKey:(NSString *)key index:(NSUInteger)index intoTrie:(AIUATemplateSearchTrieNode *)root {
+    AIUATemplateSearchTrieNode *node = root;
+    for (NSUInteger i = 0; i < key.length; i++) {
+        NSNumber *character = @([key characterAtIndex:i]);
+        AIUATemplateSearchTrieNode *child = node.children[character];
+        if (!child) {
+            child = [[AIUATemplateSearchTrieNode alloc] init];
+            node.children[character] = child;
+        }
+        [child.items addIndex:index];
+        node = child;
+    }
+}
+
+// 汉字逐字转拼音（多音字取默认读音），连续的英文字母/数字作为一个单词，其余字符只作分隔
+- (NSArray<NSString *> *)syllablesForText:(NSString *)text pinyinCache:(NSMutableDictionary<NSString *, NSString *> *)pinyinCache {
+    NSMutableArray<NSString *> *syllables = [NSMutableArray array];
+    NSUInteger wordStart = NSNotFound;
+    for (NSUInteger i = 0; i <= text.length; i++) {
+        unichar c = i < text.length ? [text characterAtIndex:i] : 0;
+        if (i < text.length && AIUATemplateSearchIsASCIIAlphanumeric(c)) {
+            if (wordStart == NSNotFound) {
+                wordStart = i;
+            }
+            continue;
+        }
+        if (wordStart != NSNotFound) {
+            [syllables addObject:[text substringWithRange:NSMakeRange(wordStart, i - wordStart)].lowercaseString];
+            wordStart = NSNotFound;
+        }
+        if (i < text.length && AIUATemplateSearchIsHan(c)) {
+            NSString *character = [text substringWithRange:NSMakeRange(i, 1)];
+            NSString *pinyin = pinyinCache[character];
+            if (!pinyin) {
+                NSMutableString *latin = [character mutableCopy];
+                CFStringTransform((__bridge CFMutableStringRef)latin, NULL, kCFStringTransformMandarinLatin, false);
+                CFStringTransform((__bridge CFMutableStringRef)latin, NULL, kCFStringTransformStripCombiningMarks, false);
+                pinyin = [[latin.lowercaseString componentsSeparatedByString:@" "] componentsJoinedByString:@""];
+                pinyinCache[character] = pinyin;
+            }
+            if (pinyin.length > 0) {
+                [syllables addObject:pinyin];
+            }
+        }
+    }
+    return syllables;
+}
+
+#pragma mark - 查询
+
+// 拼音查询：去掉空格和 '，只含英文字母/数字时才按拼音匹配
+- (nullable NSString *)pinyinQueryForQuery:(NSString *)query {
+    NSMutableString *pinyinQuery = [NSMutableString stringWithCapacity:query.length];
+    for (NSUInteger i = 0; i < query.length; i++) {
+        unichar c = [query characterAtIndex:i];
+        if (c == ' ' || c == '\'') {
+            continue;
+        }
+        if (!AIUATemplateSearchIsASCIIAlphanumeric(c)) {
+            return nil;
+        }
+        [pinyinQuery appendFormat:@"%C", c];
+    }
+    return pinyinQuery.length > 0 ? pinyinQuery.lowercaseString : nil;
+}
+
+- (NSArray<NSDictionary *> *)itemsMatchingText:(NSString *)text {
+    if (text.length == 0) {
+        self.lastQuery = nil;
+        self.lastPinyinQuery = nil;
+        self.lastMatches = nil;
+        return @[];
+    }
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSString *query = [self foldedString:text];
+    NSString *pinyinQuery = [self pinyinQueryForQuery:query];
+
+    // 输入是上一次的延长时，结果必然是上一次结果的子集
+    BOOL narrowing = self.lastMatches && [query hasPrefix:self.lastQuery] &&
+        (!pinyinQuery || (self.lastPinyinQuery && [pinyinQuery hasPrefix:self.lastPinyinQuery]));
+    NSIndexSet *candidates = narrowing ? self.lastMatches : [self candidatesForQuery:query pinyinQuery:pinyinQuery];
+
+    NSMutableIndexSet *matches = [NSMutableIndexSet indexSet];
+    NSMutableArray<NSArray<NSNumber *> *> *scored = [NSMutableArray arrayWithCapacity:candidates.count];
+    [candidates enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        NSInteger score = [self scoreForDocument:self.documents[idx] query:query pinyinQuery:pinyinQuery];
+        if (score > 0) {
+            [matches addIndex:idx];
+            [scored addObject:@[@(score), @(idx)]];
+        }
+    }];
+    [scored sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSArray<NSNumber *> *a, NSArray<NSNumber *> *b) {
+        return [b[0] compare:a[0]];
+    }];
+
+    NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:scored.count];
+    for (NSArray<NSNumber *> *entry in scored) {
+        [results addObject:self.items[entry[1].unsignedIntegerValue]];
+    }
+
+    self.lastQuery = query;
+    self.lastPinyinQuery = pinyinQuery;
+    self.lastMatches = matches;
+
+#if DEBUG
+    NSLog(@"[TemplateSearch] \"%@\" %lu 条结果（%@，候选 %lu），耗时 %.3fms", text, (unsigned long)results.count,
+          narrowing ? @"增量收窄" : @"索引查询", (unsigned long)candidates.count,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+#endif
+    return results;
+}
+
+// 由索引得到候选集（命中的超集），再逐条打分校验
+- (NSIndexSet *)candidatesForQuery:(NSString *)query pinyinQuery:(nullable NSString *)pinyinQuery {
+    NSMutableIndexSet *candidates = [NSMutableIndexSet indexSet];
+
+    NSIndexSet *substringCandidates = nil;
+    if (query.length == 1) {
+        substringCandidates = self.unigramIndex[query];
+    } else {
+        for (NSUInteger i = 0; i + 1 < query.length; i++) {
+            NSIndexSet *postings = self.bigramIndex[[query substringWithRange:NSMakeRange(i, 2)]];
+            if (postings.count == 0) {
+                substringCandidates = nil;
+                break;
+            }
+            if (!substringCandidates) {
+                substringCandidates = postings;
+            } else {
+                NSIndexSet *previous = substringCandidates;
+                substringCandidates = [postings indexesPassingTest:^BOOL(NSUInteger idx, BOOL *stop) {
+                    return [previous containsIndex:idx];
+                }];
+            }
+            if (substringCandidates.count == 0) {
+                break;
+            }
+        }
+    }
+    if (substringCandidates) {
+        [candidates addIndexes:substringCandidates];
+    }
+
+    if (pinyinQuery) {
+        AIUATemplateSearchTrieNode *node = self.trieRoot;
+        for (NSUInteger i = 0; node && i < pinyinQuery.length; i++) {
+            node = node.children[@([pinyinQuery characterAtIndex:i])];
+        }
+        if (node) {
+            [candidates addIndexes:node.items];
+        }
+    }
+    return candidates;
+}
+
+// 0 表示不匹配
+- (NSInteger)scoreForDocument:(AIUATemplateSearchDocument *)document query:(NSString *)query pinyinQuery:(nullable NSString *)pinyinQuery {
+    NSInteger bestScore = 0;
+    for (NSUInteger field = 0; field < AIUATemplateSearchFieldCount; field++) {
+        NSInteger weight = kAIUATemplateSearchFieldWeights[field];
+        // 字段按优先级排列，低优先级字段的最高分也不会超过已有得分
+        if (bestScore >= weight) {
+            break;
+        }
+        NSInteger fieldScore = 0;
+        NSRange range = [document.texts[field] rangeOfString:query];
+        if (range.location != NSNotFound) {
+            fieldScore = range.location == 0 ? kAIUATemplateSearchScoreSubstringAtStart : kAIUATemplateSearchScoreSubstring;
+        }
+        if (pinyinQuery && fieldScore < kAIUATemplateSearchScorePinyinAtStart) {
+            fieldScore = MAX(fieldScore, [self scoreForKeys:document.fullKeys[field] pinyinQuery:pinyinQuery
+                                                    atStart:kAIUATemplateSearchScorePinyinAtStart
+                                                  elsewhere:kAIUATemplateSearchScorePinyin]);
+        }
+        if (pinyinQuery && fieldScore < kAIUATemplateSearchScoreInitialsAtStart) {
+            fieldScore = MAX(fieldScore, [self scoreForKeys:document.initialKeys[field] pinyinQuery:pinyinQuery
+                                                    atStart:kAIUATemplateSearchScoreInitialsAtStart
+                                                  elsewhere:kAIUATemplateSearchScoreInitials]);
+        }
+        if (fieldScore > 0) {
+            bestScore = MAX(bestScore, weight + fieldScore);
+        }
+    }
+    return bestScore;
+}
+
+- (NSInteger)scoreForKeys:(NSArray<NSString *> *)keys pinyinQuery:(NSString *)pinyinQuery atStart:(NSInteger)atStart elsewhere:(NSInteger)elsewhere {
+    for (NSUInteger i = 0; i < keys.count; i++) {
+        if ([keys[i] hasPrefix:pinyinQuery]) {
+            return i == 0 ? atStart : elsewhere;
+        }
+    }
+    return 0;
+}
+
+@end
@@ -0,0 +1,50 @@
+//
+//  AIUAWritingMigrator.h
+//  AIUniversalAssistant
+//
+//  写作记录数据迁移
+//  - 每个迁移步骤对应一个数据版本，按版本号从小到大执行，完成后写入存储头，之后不再执行
+//  - 在后台串行队列逐条改写记录，定期记录断点；中途被杀进程后下次启动从断点继续
+//  - 每个步骤与整体耗时、扫描/改写条数输出到日志
+//
+
+#import <Foundation/Foundation.h>
+
+@class AIUAWritingStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 迁移单条记录，返回修改后的记录；无需修改时返回 nil
+/// 需能识别已迁移的记录并返回 nil：中断后从断点续跑时，断点之后已改写过的记录（少于一个断点间隔）会再次传入
+typedef NSDictionary * _Nullable (^AIUAWritingMigrationBlock)(NSDictionary *record);
+
+@interface AIUAWritingMigrator : NSObject
+
+/// 已注册步骤中的最大版本号
+@property (nonatomic, assign, readonly) NSInteger latestVersion;
+
+/// 是否正在执行迁移
+@property (atomic, assign, readonly, getter=isRunning) BOOL running;
+
+- (instancetype)initWithStore:(AIUAWritingStore *)store NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 注册迁移步骤（需在执行前注册，版本号唯一且大于 0）
+ * @param version 执行完成后存储所处的数据版本
+ * @param name 步骤名称，用于日志
+ */
+- (void)registerVersion:(NSInteger)version name:(NSString *)name transform:(AIUAWritingMigrationBlock)transform;
+
+/// 存储版本是否落后于已注册的步骤
+- (BOOL)needsMigration;
+
+/**
+ * 在后台执行所有未完成的步骤
+ * @param completion 主线程回调，modifiedCount 为本次改写的记录数
+ */
+- (void)runPendingMigrationsWithCompletion:(nullable void (^)(BOOL success, NSUInteger modifiedCount))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
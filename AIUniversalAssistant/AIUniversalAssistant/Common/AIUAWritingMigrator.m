@@ -0,0 +1,151 @@
+//
+//  AIUAWritingMigrator.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAWritingMigrator.h"
+#import "AIUAWritingStore.h"
+
+// 每处理多少条记录保存一次断点
+static const NSUInteger kAIUAWritingMigrationCheckpointInterval = 200;
+
+@interface AIUAWritingMigrationStep : NSObject
+@property (nonatomic, assign) NSInteger version;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) AIUAWritingMigrationBlock transform;
+@end
+
+@implementation AIUAWritingMigrationStep
+@end
+
+@interface AIUAWritingMigrator ()
+
+@property (nonatomic, strong) AIUAWritingStore *store;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) NSMutableArray<AIUAWritingMigrationStep *> *steps;
+@property (atomic, assign, readwrite, getter=isRunning) BOOL running;
+
+@end
+
+@implementation AIUAWritingMigrator
+
+- (instancetype)initWithStore:(AIUAWritingStore *)store {
+    self = [super init];
+    if (self) {
+        _store = store;
+        _queue = dispatch_queue_create("com.aiua.writingmigrator", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _steps = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)registerVersion:(NSInteger)version name:(NSString *)name transform:(AIUAWritingMigrationBlock)transform {
+    NSAssert(version > 0, @"迁移版本号必须大于 0");
+    NSAssert(!self.isRunning, @"迁移执行中不能注册步骤");
+    for (AIUAWritingMigrationStep *step in self.steps) {
+        if (step.version == version) {
+            NSAssert(NO, @"迁移版本号重复: %ld", (long)version);
+            return;
+        }
+    }
+    AIUAWritingMigrationStep *step = [[AIUAWritingMigrationStep alloc] init];
+    step.version = version;
+    step.name = name;
+    step.transform = transform;
+    [self.steps addObject:step];
+    [self.steps sortUsingComparator:^NSComparisonResult(AIUAWritingMigrationStep *a, AIUAWritingMigrationStep *b) {
+        return [@(a.version) compare:@(b.version)];
+    }];
+}
+
+- (NSInteger)latestVersion {
+    return self.steps.lastObject.version;
+}
+
+- (BOOL)needsMigration {
+    return self.store.schemaVersion < self.latestVersion;
+}
+
+- (void)runPendingMigrationsWithCompletion:(void (^)(BOOL, NSUInteger))completion {
+    if (![self needsMigration] || self.isRunning) {
+        if (completion) {
+            completion(YES, 0);
+        }
+        return;
+    }
+    self.running = YES;
+    NSArray<AIUAWritingMigrationStep *> *steps = [self.steps copy];
+    dispatch_async(self.queue, ^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSInteger fromVersion = self.store.schemaVersion;
+        NSUInteger totalModified = 0;
+        BOOL success = YES;
+        for (AIUAWritingMigrationStep *step in steps) {
+            if (step.version <= self.store.schemaVersion) {
+                continue;
+            }
+            NSUInteger modified = 0;
+            if (![self runStep:step modifiedCount:&modified]) {
+                success = NO;
+                break;
+            }
+            totalModified += modified;
+        }
+        NSLog(@"[WritingMigration] %@ 版本 %ld -> %ld，共改写 %lu 条，总耗时 %.1fms",
+              success ? @"✅ 迁移完成" : @"❌ 迁移中断，下次启动从断点继续",
+              (long)fromVersion, (long)self.store.schemaVersion,
+              (unsigned long)totalModified, (CFAbsoluteTimeGetCurrent() - start) * 1000);
+        self.running = NO;
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(success, totalModified);
+            });
+        }
+    });
+}
+
+#pragma mark - 执行
+
+- (BOOL)runStep:(AIUAWritingMigrationStep *)step modifiedCount:(NSUInteger *)modifiedCount {
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSInteger previousVersion = self.store.schemaVersion;
+    // 断点只属于紧接着的下一个版本
+    NSString *checkpoint = self.store.migrationCheckpoint;
+    if (checkpoint) {
+        NSLog(@"[WritingMigration] 步骤 v%ld(%@) 从断点 %@ 继续", (long)step.version, step.name, checkpoint);
+    }
+
+    NSArray<NSString *> *recordIDs = [self.store allRecordIDs];
+    NSUInteger scanned = 0;
+    NSUInteger modified = 0;
+    NSUInteger sinceCheckpoint = 0;
+    for (NSString *recordID in recordIDs) {
+        if (checkpoint && [recordID compare:checkpoint] != NSOrderedDescending) {
+            continue;
+        }
+        @autoreleasepool {
+            if ([self.store transformRecordWithID:recordID usingBlock:step.transform]) {
+                modified += 1;
+            }
+        }
+        scanned += 1;
+        sinceCheckpoint += 1;
+        if (sinceCheckpoint >= kAIUAWritingMigrationCheckpointInterval) {
+            if (![self.store setSchemaVersion:previousVersion migrationCheckpoint:recordID]) {
+                return NO;
+            }
+            sinceCheckpoint = 0;
+        }
+    }
+
+    if (![self.store setSchemaVersion:step.version migrationCheckpoint:nil]) {
+        return NO;
+    }
+    *modifiedCount = modified;
+    NSLog(@"[WritingMigration] 步骤 v%ld(%@) 完成：扫描 %lu 条，改写 %lu 条，耗时 %.1fms",
+          (long)step.version, step.name, (unsigned long)scanned, (unsigned long)modified,
+          (CFAbsoluteTimeGetCurrent() - start) * 1000);
+    return YES;
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  AIUAWritingSearchIndex.h
+//  AIUniversalAssistant
+//
+//  写作记录全文搜索：标题、提示词、正文的倒排索引（见 AIUAFullTextIndex）
+//  - 保存/删除记录时增量更新，查询只读内存索引，不读取正文
+//  - 索引快照定期（及退到后台时）落盘；有未落盘改动时留有标记文件，启动时发现标记、快照损坏或
+//    与存储记录数不一致则从存储全量重建
+//  - 线程安全，所有读写在内部串行队列执行；打开/重建期间的查询会等待其完成
+//
+
+#import <Foundation/Foundation.h>
+
+@class AIUAWritingStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 命中字段
+extern NSString * const AIUAWritingSearchFieldTitle;
+extern NSString * const AIUAWritingSearchFieldPrompt;
+extern NSString * const AIUAWritingSearchFieldContent;
+
+@interface AIUAWritingSearchResult : NSObject
+
+@property (nonatomic, copy, readonly) NSString *recordID;
+@property (nonatomic, assign, readonly) NSUInteger score;
+/// 查询中第一个词最先出现的字段（AIUAWritingSearchField*）
+@property (nonatomic, copy, readonly) NSString *field;
+/// 该字段内的 UTF-16 偏移，用于生成摘录
+@property (nonatomic, assign, readonly) NSUInteger location;
+
+@end
+
+@interface AIUAWritingSearchIndex : NSObject
+
+/**
+ * 在后台打开索引，需要时从存储重建
+ * @param directoryPath 索引目录
+ * @param store 写作记录存储，重建时从中读取全部记录
+ */
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath store:(AIUAWritingStore *)store NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 添加或替换一条记录（需包含 id 字段），异步执行
+- (void)indexRecord:(NSDictionary *)record;
+
+/// 移除记录，异步执行
+- (void)removeRecordWithID:(NSString *)recordID;
+
+/// 清空索引并删除索引文件
+- (void)removeAllRecords;
+
+/**
+ * 查询
+ * @param text 用户输入，忽略大小写和全半角
+ * @param limit 最多返回条数，0 表示不限
+ * @return 按相关度降序；相关度相同时较新保存的记录在前
+ */
+- (NSArray<AIUAWritingSearchResult *> *)resultsForText:(NSString *)text limit:(NSUInteger)limit;
+
+/// 丢弃现有索引，从存储全量重建（索引异常时使用）
+- (void)rebuildWithCompletion:(nullable void (^)(NSUInteger documentCount))completion;
+
+/// 立即把索引快照落盘
+- (void)flush;
+
+/// 索引占用的磁盘大小（字节）
+- (unsigned long long)fileSize;
+
+/**
+ * 截取命中位置附近的摘录
+ * @param text 命中字段的原文
+ * @param query 查询文本，在命中位置附近连续出现时整体高亮，否则高亮命中位置的一个词
+ * @param location AIUAWritingSearchResult.location
+ * @param maxLength 摘录最大长度（UTF-16）
+ * @param highlightRange 输出高亮范围（相对摘录）
+ */
++ (NSString *)snippetFromText:(NSString *)text
+                        query:(NSString *)query
+                     location:(NSUInteger)location
+                    maxLength:(NSUInteger)maxLength
+               highlightRange:(nullable NSRange *)highlightRange;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,466 @@
+//
+//  AIUAWritingSearchIndex.m
+//  AIUniversalAssistant
+//
+//  索引快照（index.snapshot，二进制 plist）：
+//  { version, documents: { 记录 id -> 文档号 }, index: AIUAFullTextIndexSerialize 的结果（末尾带 crc32） }
+//  校验和不符或倒排表损坏时 AIUAFullTextIndexDeserialize 返回 NULL，按快照无效处理并从存储重建
+//  文档号按保存顺序递增，查询得分相同时文档号大（较新保存）的在前
+//
+
+#import "AIUAWritingSearchIndex.h"
+#import <UIKit/UIKit.h>
+#import "AIUAWritingStore.h"
+#import "AIUAFullTextIndex.h"
+
+NSString * const AIUAWritingSearchFieldTitle = @"title";
+NSString * const AIUAWritingSearchFieldPrompt = @"prompt";
+NSString * const AIUAWritingSearchFieldContent = @"content";
+
+static NSString * const kAIUAWritingSearchSnapshotName = @"index.snapshot";
+static NSString * const kAIUAWritingSearchDirtyMarkerName = @"index.dirty";
+static NSString * const kAIUAWritingSearchVersionKey = @"version";
+static NSString * const kAIUAWritingSearchDocumentsKey = @"documents";
+static NSString * const kAIUAWritingSearchIndexKey = @"index";
+static const NSInteger kAIUAWritingSearchSnapshotVersion = 2;
+
+static const NSStringCompareOptions kAIUAWritingSearchFoldOptions = NSCaseInsensitiveSearch | NSWidthInsensitiveSearch;
+// 改动后延迟落盘，连续保存只写一次快照
+static const NSTimeInterval kAIUAWritingSearchFlushDelay = 2.0;
+// 已删除文档超过该数量且超过有效文档的 1/4 时压缩倒排表
+static const size_t kAIUAWritingSearchCompactionMinDeleted = 64;
+
+@interface AIUAWritingSearchResult ()
+
+- (instancetype)initWithRecordID:(NSString *)recordID score:(NSUInteger)score field:(NSString *)field location:(NSUInteger)location;
+
+@end
+
+@implementation AIUAWritingSearchResult
+
+- (instancetype)initWithRecordID:(NSString *)recordID score:(NSUInteger)score field:(NSString *)field location:(NSUInteger)location {
+    self = [super init];
+    if (self) {
+        _recordID = [recordID copy];
+        _score = score;
+        _field = [field copy];
+        _location = location;
+    }
+    return self;
+}
+
+@end
+
+@interface AIUAWritingSearchIndex () {
+    // 只在 queue 上访问
+    AIUAFullTextIndex *_index;
+}
+
+@property (nonatomic, copy) NSString *directoryPath;
+@property (nonatomic, copy) NSString *snapshotPath;
+@property (nonatomic, copy) NSString *dirtyMarkerPath;
+@property (nonatomic, strong) AIUAWritingStore *store;
+@property (nonatomic, strong) dispatch_queue_t queue;
+
+// 以下只在 queue 上访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *docIDsByRecordID;
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSString *> *recordIDsByDocID;
+@property (nonatomic, assign) BOOL dirty;
+@property (nonatomic, assign) BOOL flushScheduled;
+
+@end
+
+@implementation AIUAWritingSearchIndex
+
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath store:(AIUAWritingStore *)store {
+    self = [super init];
+    if (self) {
+        _directoryPath = [directoryPath copy];
+        _snapshotPath = [directoryPath stringByAppendingPathComponent:kAIUAWritingSearchSnapshotName];
+        _dirtyMarkerPath = [directoryPath stringByAppendingPathComponent:kAIUAWritingSearchDirtyMarkerName];
+        _store = store;
+        _queue = dispatch_queue_create("com.aiua.writingsearch", DISPATCH_QUEUE_SERIAL);
+        _docIDsByRecordID = [NSMutableDictionary dictionary];
+        _recordIDsByDocID = [NSMutableDictionary dictionary];
+
+        // 退到后台时立即落盘，避免下次启动重建
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+
+        dispatch_async(_queue, ^{
+            [self openIndex];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    AIUAFullTextIndexDestroy(_index);
+}
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification {
+    [self flush];
+}
+
+#pragma mark - 打开与重建
+
+// 只在 queue 上调用
+- (void)openIndex {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![fileManager fileExistsAtPath:self.directoryPath]) {
+        [fileManager createDirectoryAtPath:self.directoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+
+    if ([fileManager fileExistsAtPath:self.dirtyMarkerPath]) {
+        NSLog(@"[WritingSearch] 上次有未落盘的改动，重建索引");
+        [self rebuildFromStore];
+        return;
+    }
+    if (![self loadSnapshot]) {
+        [self rebuildFromStore];
+        return;
+    }
+    if (AIUAFullTextIndexDocumentCount(_index) != self.store.count) {
+        NSLog(@"[WritingSearch] 索引文档数 %lu 与存储记录数 %lu 不一致，重建索引",
+              (unsigned long)AIUAFullTextIndexDocumentCount(_index), (unsigned long)self.store.count);
+        [self rebuildFromStore];
+    }
+}
+
+// 只在 queue 上调用；快照不存在或损坏时返回 NO
+- (BOOL)loadSnapshot {
+    NSData *data = [NSData dataWithContentsOfFile:self.snapshotPath options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        return NO;
+    }
+    NSDictionary *snapshot = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+    if (![snapshot isKindOfClass:[NSDictionary class]] ||
+        [snapshot[kAIUAWritingSearchVersionKey] integerValue] != kAIUAWritingSearchSnapshotVersion) {
+        NSLog(@"[WritingSearch] 快照版本不符或无法解析");
+        return NO;
+    }
+    NSDictionary *documents = snapshot[kAIUAWritingSearchDocumentsKey];
+    NSData *indexData = snapshot[kAIUAWritingSearchIndexKey];
+    if (![documents isKindOfClass:[NSDictionary class]] || ![indexData isKindOfClass:[NSData class]]) {
+        return NO;
+    }
+    AIUAFullTextIndex *index = AIUAFullTextIndexDeserialize(indexData.bytes, indexData.length);
+    if (!index) {
+        NSLog(@"[WritingSearch] 快照数据损坏");
+        return NO;
+    }
+
+    NSMutableDictionary<NSString *, NSNumber *> *docIDsByRecordID = [NSMutableDictionary dictionaryWithCapacity:documents.count];
+    NSMutableDictionary<NSNumber *, NSString *> *recordIDsByDocID = [NSMutableDictionary dictionaryWithCapacity:documents.count];
+    __block BOOL valid = YES;
+    [documents enumerateKeysAndObjectsUsingBlock:^(id recordID, id docID, BOOL *stop) {
+        if (![recordID isKindOfClass:[NSString class]] || ![docID isKindOfClass:[NSNumber class]]) {
+            valid = NO;
+            *stop = YES;
+            return;
+        }
+        docIDsByRecordID[recordID] = docID;
+        recordIDsByDocID[docID] = recordID;
+    }];
+    if (!valid || recordIDsByDocID.count != AIUAFullTextIndexDocumentCount(index)) {
+        NSLog(@"[WritingSearch] 快照文档映射与索引不一致");
+        AIUAFullTextIndexDestroy(index);
+        return NO;
+    }
+
+    AIUAFullTextIndexDestroy(_index);
+    _index = index;
+    self.docIDsByRecordID = docIDsByRecordID;
+    self.recordIDsByDocID = recordIDsByDocID;
+    return YES;
+}
+
+// 只在 queue 上调用；按从旧到新的顺序重新编号，读取每条记录的全文
+- (void)rebuildFromStore {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    AIUAFullTextIndexDestroy(_index);
+    _index = AIUAFullTextIndexCreate();
+    [self.docIDsByRecordID removeAllObjects];
+    [self.recordIDsByDocID removeAllObjects];
+
+    NSArray<NSDictionary *> *summaries = [self.store allSummaries];
+    for (NSDictionary *summary in summaries.reverseObjectEnumerator) {
+        @autoreleasepool {
+            NSString *recordID = summary[@"id"];
+            NSDictionary *record = [recordID isKindOfClass:[NSString class]] ? [self.store recordWithID:recordID] : nil;
+            if (record) {
+                [self addRecordToIndex:record];
+            }
+        }
+    }
+
+    NSLog(@"[WritingSearch] 重建索引完成：%lu 条记录，耗时 %.2fms",
+          (unsigned long)AIUAFullTextIndexDocumentCount(_index), (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+    [self writeSnapshot];
+}
+
+- (void)rebuildWithCompletion:(void (^)(NSUInteger))completion {
+    dispatch_async(self.queue, ^{
+        [self rebuildFromStore];
+        NSUInteger count = AIUAFullTextIndexDocumentCount(self->_index);
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(count);
+            });
+        }
+    });
+}
+
+#pragma mark - 增量更新
+
+- (void)indexRecord:(NSDictionary *)record {
+    NSString *recordID = record[@"id"];
+    if (![recordID isKindOfClass:[NSString class]] || recordID.length == 0) {
+        return;
+    }
+    NSDictionary *snapshot = [record copy];
+    dispatch_async(self.queue, ^{
+        [self addRecordToIndex:snapshot];
+        [self markDirty];
+    });
+}
+
+- (void)removeRecordWithID:(NSString *)recordID {
+    if (recordID.length == 0) {
+        return;
+    }
+    NSString *recordIDCopy = [recordID copy];
+    dispatch_async(self.queue, ^{
+        if ([self removeRecordFromIndex:recordIDCopy]) {
+            [self compactIfNeeded];
+            [self markDirty];
+        }
+    });
+}
+
+- (void)removeAllRecords {
+    dispatch_sync(self.queue, ^{
+        AIUAFullTextIndexDestroy(self->_index);
+        self->_index = AIUAFullTextIndexCreate();
+        [self.docIDsByRecordID removeAllObjects];
+        [self.recordIDsByDocID removeAllObjects];
+        self.dirty = NO;
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager removeItemAtPath:self.snapshotPath error:nil];
+        [fileManager removeItemAtPath:self.dirtyMarkerPath error:nil];
+    });
+}
+
+// 只在 queue 上调用；同一记录已存在时先移除旧文档
+- (void)addRecordToIndex:(NSDictionary *)record {
+    NSString *recordID = record[@"id"];
+    [self removeRecordFromIndex:recordID];
+
+    uint32_t docID = AIUAFullTextIndexMaxDocID(_index) + 1;
+    NSArray<NSString *> *keys = @[AIUAWritingSearchFieldTitle, AIUAWritingSearchFieldPrompt, AIUAWritingSearchFieldContent];
+    NSData *buffers[AIUAFullTextFieldCount];
+    const uint16_t *fields[AIUAFullTextFieldCount];
+    size_t lengths[AIUAFullTextFieldCount];
+    for (NSUInteger i = 0; i < AIUAFullTextFieldCount; i++) {
+        NSString *value = record[keys[i]];
+        buffers[i] = [self foldedCharactersOfString:[value isKindOfClass:[NSString class]] ? value : @""];
+        fields[i] = buffers[i].bytes;
+        lengths[i] = buffers[i].length / sizeof(unichar);
+    }
+    if (!AIUAFullTextIndexAddDocument(_index, docID, fields, lengths)) {
+        NSLog(@"[WritingSearch] ❌ 无法索引记录 %@", recordID);
+        return;
+    }
+    self.docIDsByRecordID[recordID] = @(docID);
+    self.recordIDsByDocID[@(docID)] = recordID;
+}
+
+// 只在 queue 上调用
+- (BOOL)removeRecordFromIndex:(NSString *)recordID {
+    NSNumber *docID = self.docIDsByRecordID[recordID];
+    if (!docID) {
+        return NO;
+    }
+    AIUAFullTextIndexRemoveDocument(_index, docID.unsignedIntValue);
+    [self.docIDsByRecordID removeObjectForKey:recordID];
+    [self.recordIDsByDocID removeObjectForKey:docID];
+    return YES;
+}
+
+// 只在 queue 上调用
+- (void)compactIfNeeded {
+    size_t deleted = AIUAFullTextIndexDeletedDocumentCount(_index);
+    if (deleted < kAIUAWritingSearchCompactionMinDeleted || deleted * 4 < AIUAFullTextIndexDocumentCount(_index)) {
+        return;
+    }
+    if (!AIUAFullTextIndexCompact(_index)) {
+        NSLog(@"[WritingSearch] ❌ 压缩倒排表失败");
+    }
+}
+
+#pragma mark - 落盘
+
+// 只在 queue 上调用；首次改动时留下标记文件，快照写入成功后移除
+- (void)markDirty {
+    if (!self.dirty) {
+        self.dirty = YES;
+        [[NSData data] writeToFile:self.dirtyMarkerPath atomically:NO];
+    }
+    if (self.flushScheduled) {
+        return;
+    }
+    self.flushScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kAIUAWritingSearchFlushDelay * NSEC_PER_SEC)), self.queue, ^{
+        self.flushScheduled = NO;
+        if (self.dirty) {
+            [self writeSnapshot];
+        }
+    });
+}
+
+- (void)flush {
+    dispatch_async(self.queue, ^{
+        if (self.dirty) {
+            [self writeSnapshot];
+        }
+    });
+}
+
+// 只在 queue 上调用
+- (void)writeSnapshot {
+    uint8_t *bytes = NULL;
+    size_t length = 0;
+    if (!AIUAFullTextIndexSerialize(_index, &bytes, &length)) {
+        NSLog(@"[WritingSearch] ❌ 序列化索引失败");
+        return;
+    }
+    NSData *indexData = [NSData dataWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+    NSDictionary *snapshot = @{
+        kAIUAWritingSearchVersionKey: @(kAIUAWritingSearchSnapshotVersion),
+        kAIUAWritingSearchDocumentsKey: [self.docIDsByRecordID copy],
+        kAIUAWritingSearchIndexKey: indexData
+    };
+    NSError *error = nil;
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:snapshot format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+    if (!data || ![data writeToFile:self.snapshotPath options:NSDataWritingAtomic error:&error]) {
+        NSLog(@"[WritingSearch] ❌ 写入索引快照失败: %@", error.localizedDescription);
+        return;
+    }
+    self.dirty = NO;
+    [[NSFileManager defaultManager] removeItemAtPath:self.dirtyMarkerPath error:nil];
+}
+
+- (unsigned long long)fileSize {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.snapshotPath error:nil];
+    return [attributes[NSFileSize] unsignedLongLongValue];
+}
+
+#pragma mark - 查询
+
+- (NSArray<AIUAWritingSearchResult *> *)resultsForText:(NSString *)text limit:(NSUInteger)limit {
+    NSString *trimmed = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if (trimmed.length == 0) {
+        return @[];
+    }
+    NSData *query = [self foldedCharactersOfString:trimmed];
+    NSArray<NSString *> *fieldNames = @[AIUAWritingSearchFieldTitle, AIUAWritingSearchFieldPrompt, AIUAWritingSearchFieldContent];
+
+#if DEBUG
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+#endif
+    __block NSMutableArray<AIUAWritingSearchResult *> *results = nil;
+    dispatch_sync(self.queue, ^{
+        AIUAFullTextHit *hits = NULL;
+        size_t count = AIUAFullTextIndexSearch(self->_index, query.bytes, query.length / sizeof(unichar), limit, &hits);
+        results = [NSMutableArray arrayWithCapacity:count];
+        for (size_t i = 0; i < count; i++) {
+            NSString *recordID = self.recordIDsByDocID[@(hits[i].docID)];
+            if (!recordID || (NSUInteger)hits[i].field >= fieldNames.count) {
+                continue;
+            }
+            [results addObject:[[AIUAWritingSearchResult alloc] initWithRecordID:recordID
+                                                                           score:hits[i].score
+                                                                           field:fieldNames[hits[i].field]
+                                                                        location:hits[i].offset]];
+        }
+        free(hits);
+    });
+#if DEBUG
+    NSLog(@"[WritingSearch] \"%@\" 命中 %lu 条，耗时 %.2fms", trimmed, (unsigned long)results.count,
+          (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0);
+#endif
+    return results;
+}
+
+// 大小写、全半角归一化后的 UTF-16 码元；与语言无关，保证快照跨语言设置可用
+- (NSData *)foldedCharactersOfString:(NSString *)string {
+    NSString *folded = [string stringByFoldingWithOptions:kAIUAWritingSearchFoldOptions locale:nil];
+    NSMutableData *data = [NSMutableData dataWithLength:folded.length * sizeof(unichar)];
+    [folded getCharacters:data.mutableBytes range:NSMakeRange(0, folded.length)];
+    return data;
+}
+
+#pragma mark - 摘录
+
++ (NSString *)snippetFromText:(NSString *)text
+                        query:(NSString *)query
+                     location:(NSUInteger)location
+                    maxLength:(NSUInteger)maxLength
+               highlightRange:(NSRange *)highlightRange {
+    if (highlightRange) {
+        *highlightRange = NSMakeRange(NSNotFound, 0);
+    }
+    if (text.length == 0 || maxLength == 0) {
+        return @"";
+    }
+    location = MIN(location, text.length - 1);
+
+    // 命中位置附近连续出现整个查询时高亮整个查询，否则高亮命中位置的两个字
+    NSString *trimmedQuery = [query stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    NSRange match = NSMakeRange(NSNotFound, 0);
+    if (trimmedQuery.length > 0) {
+        NSUInteger searchStart = location > trimmedQuery.length ? location - trimmedQuery.length : 0;
+        match = [text rangeOfString:trimmedQuery
+                            options:kAIUAWritingSearchFoldOptions
+                              range:NSMakeRange(searchStart, text.length - searchStart)];
+        if (match.location != NSNotFound && match.location > location + maxLength / 2) {
+            match = NSMakeRange(NSNotFound, 0);
+        }
+    }
+    if (match.location == NSNotFound) {
+        match = [text rangeOfComposedCharacterSequencesForRange:NSMakeRange(location, MIN((NSUInteger)2, text.length - location))];
+    }
+
+    // 命中前保留约 1/4 的上下文
+    NSUInteger lead = maxLength / 4;
+    NSUInteger start = match.location > lead ? match.location - lead : 0;
+    NSUInteger end = MIN(text.length, start + maxLength);
+    if (end - start < maxLength) {
+        start = end > maxLength ? end - maxLength : 0;
+    }
+    NSRange window = [text rangeOfComposedCharacterSequencesForRange:NSMakeRange(start, end - start)];
+
+    NSMutableString *snippet = [NSMutableString string];
+    if (window.location > 0) {
+        [snippet appendString:@"…"];
+    }
+    NSUInteger prefixLength = snippet.length;
+    NSString *body = [[text substringWithRange:window] stringByReplacingOccurrencesOfString:@"\n" withString:@" "];
+    [snippet appendString:body];
+    if (NSMaxRange(window) < text.length) {
+        [snippet appendString:@"…"];
+    }
+
+    if (highlightRange) {
+        NSRange visible = NSIntersectionRange(match, window);
+        if (visible.length > 0) {
+            *highlightRange = NSMakeRange(visible.location - window.location + prefixLength, visible.length);
+        }
+    }
+    return snippet;
+}
+
+@end
@@ -0,0 +1,88 @@
+//
+//  AIUAWritingStore.h
+//  AIUniversalAssistant
+//
+//  写作记录存储：追加写日志 + 偏移索引
+//  - 保存/删除只向日志末尾追加一条记录（删除为墓碑记录），耗时与单条记录大小相当，不再整文件重写
+//  - 内存中维护 id -> 日志偏移 的索引，索引快照定期落盘，启动时只需回放快照之后的日志尾部
+//  - 每条记录另存一份轻量摘要（随索引快照持久化），列表页只读摘要，不反序列化正文
+//  - 失效数据超过阈值后在后台压缩日志
+//  - 线程安全，所有读写在内部串行队列执行
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 由完整记录生成列表摘要（需包含 id），在保存和回放日志时调用
+typedef NSDictionary * _Nullable (^AIUAWritingSummaryBuilder)(NSDictionary *record);
+
+@interface AIUAWritingStore : NSObject
+
+/// 有效记录数
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// 数据版本（存储头），新建或从旧 plist 导入的存储为 0
+@property (nonatomic, assign, readonly) NSInteger schemaVersion;
+
+/// 进行中的迁移已处理到的最后一个记录 id（按 allRecordIDs 顺序），没有进行中的迁移时为 nil
+@property (nonatomic, copy, readonly, nullable) NSString *migrationCheckpoint;
+
+/**
+ * 打开（不存在时创建）存储目录
+ * @param directoryPath 存储目录，日志与索引文件都放在该目录下
+ * @param summaryBuilder 摘要生成规则，为 nil 时不维护摘要
+ */
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath
+                       summaryBuilder:(nullable AIUAWritingSummaryBuilder)summaryBuilder NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 一次性导入旧版 AIUAWritings.plist（数组第 0 个为最新）
+ * 仅在存储为空时导入，导入成功后删除旧文件
+ */
+- (void)importLegacyPlistAtPathIfNeeded:(NSString *)plistPath;
+
+/// 全部记录，按最新在前排序
+- (NSArray<NSDictionary *> *)allRecords;
+
+/// 全部记录的摘要，按最新在前排序（只读内存，不访问日志）
+- (NSArray<NSDictionary *> *)allSummaries;
+
+/// 按 id 读取单条记录
+- (nullable NSDictionary *)recordWithID:(NSString *)recordID;
+
+/// 新增记录并置顶（记录需包含 id 字段；id 已存在时替换旧记录）
+- (BOOL)insertRecord:(NSDictionary *)record;
+
+/// 原位替换记录，保持排序位置；id 不存在时按新增处理
+- (BOOL)updateRecord:(NSDictionary *)record;
+
+/**
+ * 在存储队列内原子地读取并改写一条记录，期间不会与其他保存交错
+ * @param block 返回修改后的记录；返回 nil 表示无需修改
+ * @return 是否写入了新内容
+ */
+- (BOOL)transformRecordWithID:(NSString *)recordID usingBlock:(NSDictionary * _Nullable (^)(NSDictionary *record))block;
+
+/// 全部记录 id，按字典序升序（顺序稳定，用于可断点续跑的遍历）
+- (NSArray<NSString *> *)allRecordIDs;
+
+/// 更新存储头；会先把日志落盘，保证断点之前的改动不会丢失
+- (BOOL)setSchemaVersion:(NSInteger)schemaVersion migrationCheckpoint:(nullable NSString *)checkpoint;
+
+/// 删除记录（追加墓碑），不存在时返回 NO
+- (BOOL)removeRecordWithID:(NSString *)recordID;
+
+/// 清空全部记录并删除文件（存储头保留）
+- (BOOL)removeAllRecords;
+
+/// 存储占用的磁盘大小（字节）
+- (unsigned long long)fileSize;
+
+/// 立即压缩日志（通常无需手动调用）
+- (void)compact;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,984 @@
+//
+//  AIUAWritingStore.m
+//  AIUniversalAssistant
+//
+//  日志文件格式（小端）：
+//  [magic u32][type u8][reserved u8 x3][sortKey i64][payloadLength u32][crc32 u32][payload]
+//  - 写入记录 payload：[idLength u16][id UTF-8][二进制 plist]
+//  - 墓碑记录 payload：[id UTF-8]
+//  sortKey 越大越新；原位替换沿用旧 sortKey，新增记录取当前最大值 + 1
+//
+//  索引快照格式：
+//  [magic u32][version u32][coveredLogLength u64][maxSortKey i64][deadBytes u64][count u32]
+//  每条：[sortKey i64][offset u64][recordLength u32][idLength u16][id UTF-8][summaryLength u32][摘要二进制 plist]
+//  摘要由调用方提供的 summaryBuilder 从完整记录生成，列表页只读摘要，不解析正文
+//
+//  存储头（writings.meta，二进制 plist）：schemaVersion 与迁移断点，供迁移器使用
+//
+
+#import "AIUAWritingStore.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static NSString * const kAIUAWritingStoreLogName = @"writings.log";
+static NSString * const kAIUAWritingStoreIndexName = @"writings.idx";
+static NSString * const kAIUAWritingStoreMetaName = @"writings.meta";
+static NSString * const kAIUAWritingMetaSchemaVersionKey = @"schemaVersion";
+static NSString * const kAIUAWritingMetaMigrationCheckpointKey = @"migrationCheckpoint";
+
+static const uint32_t kAIUAWritingLogMagic = 0x57554941;    // "AIUW"
+static const uint32_t kAIUAWritingIndexMagic = 0x49554941;  // "AIUI"
+static const uint32_t kAIUAWritingIndexVersion = 2;
+
+static const uint8_t kAIUAWritingRecordTypePut = 1;
+static const uint8_t kAIUAWritingRecordTypeDelete = 2;
+
+static const size_t kAIUAWritingRecordHeaderSize = 24;
+// 每追加多少条记录刷新一次索引快照
+static const NSUInteger kAIUAWritingIndexFlushInterval = 32;
+// 失效数据达到该大小且超过有效数据时触发压缩
+static const unsigned long long kAIUAWritingCompactionMinDeadBytes = 256 * 1024;
+
+#pragma mark - 工具函数
+
+static uint32_t AIUAWritingCRC32(const uint8_t *bytes, size_t length) {
+    static uint32_t table[256];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+    });
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void AIUAWritingWriteU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void AIUAWritingWriteU64(uint8_t *p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t AIUAWritingReadU32(const uint8_t *p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static uint64_t AIUAWritingReadU64(const uint8_t *p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// 完整写入，处理 EINTR 和部分写入
+static BOOL AIUAWritingWriteAll(int fd, const void *bytes, size_t length, off_t offset) {
+    const uint8_t *p = (const uint8_t *)bytes;
+    while (length > 0) {
+        ssize_t written = pwrite(fd, p, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NO;
+        }
+        p += written;
+        offset += written;
+        length -= (size_t)written;
+    }
+    return YES;
+}
+
+static BOOL AIUAWritingReadAll(int fd, void *bytes, size_t length, off_t offset) {
+    uint8_t *p = (uint8_t *)bytes;
+    while (length > 0) {
+        ssize_t count = pread(fd, p, length, offset);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NO;
+        }
+        if (count == 0) {
+            return NO;
+        }
+        p += count;
+        offset += count;
+        length -= (size_t)count;
+    }
+    return YES;
+}
+
+#pragma mark - 索引项
+
+@interface AIUAWritingIndexEntry : NSObject
+@property (nonatomic, copy) NSString *recordID;
+@property (nonatomic, assign) int64_t sortKey;
+@property (nonatomic, assign) uint64_t offset;          // 记录（含头部）在日志中的偏移
+@property (nonatomic, assign) uint32_t recordLength;    // 记录总长度（含头部）
+@property (nonatomic, copy, nullable) NSDictionary *summary;
+
+/// 复制全部字段，只替换日志偏移（压缩时使用）
+- (AIUAWritingIndexEntry *)entryMovedToOffset:(uint64_t)offset;
+@end
+
+@implementation AIUAWritingIndexEntry
+
+- (AIUAWritingIndexEntry *)entryMovedToOffset:(uint64_t)offset {
+    AIUAWritingIndexEntry *moved = [[AIUAWritingIndexEntry alloc] init];
+    moved.recordID = self.recordID;
+    moved.sortKey = self.sortKey;
+    moved.offset = offset;
+    moved.recordLength = self.recordLength;
+    moved.summary = self.summary;
+    return moved;
+}
+
+@end
+
+#pragma mark - 存储
+
+@interface AIUAWritingStore ()
+
+@property (nonatomic, copy) NSString *directoryPath;
+@property (nonatomic, copy) NSString *logPath;
+@property (nonatomic, copy) NSString *indexPath;
+@property (nonatomic, copy) NSString *metaPath;
+@property (nonatomic, assign) NSInteger storedSchemaVersion;
+@property (nonatomic, copy, nullable) NSString *storedMigrationCheckpoint;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, copy, nullable) AIUAWritingSummaryBuilder summaryBuilder;
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AIUAWritingIndexEntry *> *entries;
+@property (nonatomic, strong, nullable) NSArray<AIUAWritingIndexEntry *> *sortedEntries;
+@property (nonatomic, assign) int64_t maxSortKey;
+@property (nonatomic, assign) uint64_t logLength;
+@property (nonatomic, assign) uint64_t deadBytes;
+@property (nonatomic, assign) NSUInteger appendsSinceIndexFlush;
+@property (nonatomic, assign) BOOL compactionScheduled;
+
+@end
+
+@implementation AIUAWritingStore {
+    int _fd;
+}
+
+- (instancetype)initWithDirectoryPath:(NSString *)directoryPath summaryBuilder:(AIUAWritingSummaryBuilder)summaryBuilder {
+    self = [super init];
+    if (self) {
+        _directoryPath = [directoryPath copy];
+        _summaryBuilder = [summaryBuilder copy];
+        _logPath = [directoryPath stringByAppendingPathComponent:kAIUAWritingStoreLogName];
+        _indexPath = [directoryPath stringByAppendingPathComponent:kAIUAWritingStoreIndexName];
+        _metaPath = [directoryPath stringByAppendingPathComponent:kAIUAWritingStoreMetaName];
+        _queue = dispatch_queue_create("com.aiua.writingstore", DISPATCH_QUEUE_SERIAL);
+        _entries = [NSMutableDictionary dictionary];
+        _fd = -1;
+        dispatch_sync(_queue, ^{
+            [self openStore];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+#pragma mark - 打开与恢复
+
+- (void)openStore {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![fileManager fileExistsAtPath:self.directoryPath]) {
+        [fileManager createDirectoryAtPath:self.directoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+
+    _fd = open(self.logPath.fileSystemRepresentation, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        NSLog(@"[WritingStore] ❌ 无法打开日志文件: %s", strerror(errno));
+        return;
+    }
+    struct stat info;
+    if (fstat(_fd, &info) != 0) {
+        NSLog(@"[WritingStore] ❌ 无法读取日志文件信息: %s", strerror(errno));
+        return;
+    }
+    uint64_t fileLength = (uint64_t)info.st_size;
+
+    [self loadMeta];
+
+    [self.entries removeAllObjects];
+    self.maxSortKey = 0;
+    self.deadBytes = 0;
+    uint64_t replayFrom = 0;
+    if ([self loadIndexSnapshotWithLogLength:fileLength]) {
+        replayFrom = self.logLength;
+    } else {
+        [self.entries removeAllObjects];
+        self.maxSortKey = 0;
+        self.deadBytes = 0;
+    }
+
+    uint64_t validLength = [self replayLogFromOffset:replayFrom fileLength:fileLength];
+    if (validLength < fileLength) {
+        // 末尾是写了一半的记录（例如写入时进程被杀），截掉
+        NSLog(@"[WritingStore] ⚠️ 日志尾部损坏，截断 %llu 字节", fileLength - validLength);
+        ftruncate(_fd, (off_t)validLength);
+    }
+    self.logLength = validLength;
+    self.sortedEntries = nil;
+    NSUInteger rebuiltSummaries = [self rebuildMissingSummaries];
+    if (replayFrom < validLength || rebuiltSummaries > 0) {
+        [self writeIndexSnapshot];
+    }
+    NSLog(@"[WritingStore] 打开完成: %lu 条记录，日志 %llu 字节（回放 %llu 字节）",
+          (unsigned long)self.entries.count, validLength, validLength - replayFrom);
+}
+
+- (void)loadMeta {
+    NSData *data = [NSData dataWithContentsOfFile:self.metaPath];
+    NSDictionary *meta = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil] : nil;
+    if (![meta isKindOfClass:[NSDictionary class]]) {
+        // 没有存储头视为版本 0，由迁移器从头执行
+        self.storedSchemaVersion = 0;
+        self.storedMigrationCheckpoint = nil;
+        return;
+    }
+    NSNumber *version = meta[kAIUAWritingMetaSchemaVersionKey];
+    NSString *checkpoint = meta[kAIUAWritingMetaMigrationCheckpointKey];
+    self.storedSchemaVersion = [version isKindOfClass:[NSNumber class]] ? version.integerValue : 0;
+    self.storedMigrationCheckpoint = [checkpoint isKindOfClass:[NSString class]] ? checkpoint : nil;
+}
+
+// 读取索引快照；快照与日志不匹配时返回 NO，改为全量回放
+- (BOOL)loadIndexSnapshotWithLogLength:(uint64_t)fileLength {
+    // 摘要解析直接引用 data 内部字节，需保证其存活到函数结束
+    NS_VALID_UNTIL_END_OF_SCOPE NSData *data = [NSData dataWithContentsOfFile:self.indexPath];
+    if (data.length < 36) {
+        return NO;
+    }
+    const uint8_t *bytes = (const uint8_t *)data.bytes;
+    const uint8_t *end = bytes + data.length;
+    if (AIUAWritingReadU32(bytes) != kAIUAWritingIndexMagic || AIUAWritingReadU32(bytes + 4) != kAIUAWritingIndexVersion) {
+        return NO;
+    }
+    uint64_t coveredLength = AIUAWritingReadU64(bytes + 8);
+    if (coveredLength > fileLength) {
+        return NO;
+    }
+    self.maxSortKey = (int64_t)AIUAWritingReadU64(bytes + 16);
+    self.deadBytes = AIUAWritingReadU64(bytes + 24);
+    uint32_t count = AIUAWritingReadU32(bytes + 32);
+    const uint8_t *p = bytes + 36;
+    for (uint32_t i = 0; i < count; i++) {
+        if (end - p < 22) {
+            return NO;
+        }
+        AIUAWritingIndexEntry *entry = [[AIUAWritingIndexEntry alloc] init];
+        entry.sortKey = (int64_t)AIUAWritingReadU64(p);
+        entry.offset = AIUAWritingReadU64(p + 8);
+        entry.recordLength = AIUAWritingReadU32(p + 16);
+        uint16_t idLength = (uint16_t)(p[20] | (p[21] << 8));
+        p += 22;
+        if (end - p < idLength || entry.offset + entry.recordLength > coveredLength) {
+            return NO;
+        }
+        NSString *recordID = [[NSString alloc] initWithBytes:p length:idLength encoding:NSUTF8StringEncoding];
+        p += idLength;
+        if (!recordID || end - p < 4) {
+            return NO;
+        }
+        uint32_t summaryLength = AIUAWritingReadU32(p);
+        p += 4;
+        if ((uint64_t)(end - p) < summaryLength) {
+            return NO;
+        }
+        if (summaryLength > 0) {
+            NSData *summaryData = [NSData dataWithBytesNoCopy:(void *)p length:summaryLength freeWhenDone:NO];
+            id summary = [NSPropertyListSerialization propertyListWithData:summaryData options:NSPropertyListImmutable format:NULL error:nil];
+            if (![summary isKindOfClass:[NSDictionary class]]) {
+                return NO;
+            }
+            entry.summary = summary;
+        }
+        p += summaryLength;
+        entry.recordID = recordID;
+        self.entries[recordID] = entry;
+    }
+    self.logLength = coveredLength;
+    return YES;
+}
+
+// 校验 offset 处是否为一条完整且 CRC 正确的记录，是则读出头部与 payload 并返回记录总长度，否则返回 0
+- (uint64_t)readValidRecordAtOffset:(uint64_t)offset fileLength:(uint64_t)fileLength header:(uint8_t *)header payload:(NSMutableData *)payload {
+    if (offset + kAIUAWritingRecordHeaderSize > fileLength ||
+        !AIUAWritingReadAll(_fd, header, kAIUAWritingRecordHeaderSize, (off_t)offset) ||
+        AIUAWritingReadU32(header) != kAIUAWritingLogMagic) {
+        return 0;
+    }
+    uint32_t payloadLength = AIUAWritingReadU32(header + 16);
+    uint64_t recordLength = kAIUAWritingRecordHeaderSize + (uint64_t)payloadLength;
+    if (offset + recordLength > fileLength) {
+        return 0;
+    }
+    payload.length = payloadLength;
+    if (!AIUAWritingReadAll(_fd, payload.mutableBytes, payloadLength, (off_t)(offset + kAIUAWritingRecordHeaderSize)) ||
+        AIUAWritingCRC32(payload.bytes, payloadLength) != AIUAWritingReadU32(header + 20)) {
+        return 0;
+    }
+    return recordLength;
+}
+
+// 从 offset 之后按魔数查找下一条校验通过的记录，找不到返回 fileLength
+- (uint64_t)nextValidRecordOffsetAfter:(uint64_t)offset fileLength:(uint64_t)fileLength {
+    uint8_t header[kAIUAWritingRecordHeaderSize];
+    NSMutableData *payload = [NSMutableData data];
+    NSMutableData *chunk = [NSMutableData dataWithLength:64 * 1024];
+    uint64_t position = offset + 1;
+    while (position + kAIUAWritingRecordHeaderSize <= fileLength) {
+        size_t length = (size_t)MIN((uint64_t)chunk.length, fileLength - position);
+        const uint8_t *bytes = (const uint8_t *)chunk.bytes;
+        if (!AIUAWritingReadAll(_fd, chunk.mutableBytes, length, (off_t)position)) {
+            return fileLength;
+        }
+        for (size_t i = 0; i + 4 <= length; i++) {
+            if (AIUAWritingReadU32(bytes + i) == kAIUAWritingLogMagic &&
+                [self readValidRecordAtOffset:position + i fileLength:fileLength header:header payload:payload] > 0) {
+                return position + i;
+            }
+        }
+        // 魔数可能跨块
+        position += length - 3;
+    }
+    return fileLength;
+}
+
+// 从 offset 开始回放日志，返回最后一条完整记录的结束位置
+// 遇到损坏的记录时向后查找下一条校验通过的记录继续回放，只丢失损坏的这一条
+// （它覆盖的旧版本或删除的记录会重新生效）；之后再没有完整记录时视为写了一半的尾部，由调用方截断
+- (uint64_t)replayLogFromOffset:(uint64_t)offset fileLength:(uint64_t)fileLength {
+    uint8_t header[kAIUAWritingRecordHeaderSize];
+    NSMutableData *payload = [NSMutableData data];
+    while (offset < fileLength) {
+        uint64_t recordLength = [self readValidRecordAtOffset:offset fileLength:fileLength header:header payload:payload];
+        uint8_t type = recordLength > 0 ? header[4] : 0;
+        uint32_t payloadLength = (uint32_t)payload.length;
+        const uint8_t *bytes = (const uint8_t *)payload.bytes;
+        NSString *recordID = nil;
+        if (type == kAIUAWritingRecordTypePut && payloadLength >= 2) {
+            uint16_t idLength = (uint16_t)(bytes[0] | (bytes[1] << 8));
+            if (2 + (uint32_t)idLength <= payloadLength) {
+                recordID = [[NSString alloc] initWithBytes:bytes + 2 length:idLength encoding:NSUTF8StringEncoding];
+            }
+        } else if (type == kAIUAWritingRecordTypeDelete) {
+            recordID = [[NSString alloc] initWithBytes:bytes length:payloadLength encoding:NSUTF8StringEncoding];
+        }
+        if (!recordID) {
+            uint64_t next = [self nextValidRecordOffsetAfter:offset fileLength:fileLength];
+            if (next >= fileLength) {
+                break;
+            }
+            NSLog(@"[WritingStore] ⚠️ 日志偏移 %llu 处的记录损坏，跳过 %llu 字节", offset, next - offset);
+            self.deadBytes += next - offset;
+            offset = next;
+            continue;
+        }
+
+        int64_t sortKey = (int64_t)AIUAWritingReadU64(header + 8);
+        AIUAWritingIndexEntry *previous = self.entries[recordID];
+        if (previous) {
+            self.deadBytes += previous.recordLength;
+        }
+        if (type == kAIUAWritingRecordTypePut) {
+            AIUAWritingIndexEntry *entry = [[AIUAWritingIndexEntry alloc] init];
+            entry.recordID = recordID;
+            entry.sortKey = sortKey;
+            entry.offset = offset;
+            entry.recordLength = (uint32_t)recordLength;
+            entry.summary = [self summaryForPayload:payload];
+            self.entries[recordID] = entry;
+            self.maxSortKey = MAX(self.maxSortKey, sortKey);
+        } else {
+            [self.entries removeObjectForKey:recordID];
+            self.deadBytes += recordLength;
+        }
+        offset += recordLength;
+    }
+    return offset;
+}
+
+// 回放时从写入记录 payload 重新生成摘要（只发生在快照之后的日志尾部）
+- (nullable NSDictionary *)summaryForPayload:(NSData *)payload {
+    if (!self.summaryBuilder) {
+        return nil;
+    }
+    NSDictionary *record = [self recordFromPutPayload:payload];
+    return record ? self.summaryBuilder(record) : nil;
+}
+
+// 快照中缺少摘要的记录（旧版本压缩后写出的快照会丢失摘要）从日志读取完整记录重新生成
+- (NSUInteger)rebuildMissingSummaries {
+    if (!self.summaryBuilder) {
+        return 0;
+    }
+    NSUInteger rebuilt = 0;
+    for (AIUAWritingIndexEntry *entry in self.entries.objectEnumerator) {
+        if (entry.summary) {
+            continue;
+        }
+        NSDictionary *record = [self readRecordForEntry:entry];
+        NSDictionary *summary = record ? self.summaryBuilder(record) : nil;
+        if (summary) {
+            entry.summary = summary;
+            rebuilt += 1;
+        }
+    }
+    if (rebuilt > 0) {
+        NSLog(@"[WritingStore] 从日志补全 %lu 条缺失的摘要", (unsigned long)rebuilt);
+    }
+    return rebuilt;
+}
+
+- (void)writeIndexSnapshot {
+    NSMutableData *data = [NSMutableData dataWithLength:36];
+    uint8_t *header = (uint8_t *)data.mutableBytes;
+    AIUAWritingWriteU32(header, kAIUAWritingIndexMagic);
+    AIUAWritingWriteU32(header + 4, kAIUAWritingIndexVersion);
+    AIUAWritingWriteU64(header + 8, self.logLength);
+    AIUAWritingWriteU64(header + 16, (uint64_t)self.maxSortKey);
+    AIUAWritingWriteU64(header + 24, self.deadBytes);
+    AIUAWritingWriteU32(header + 32, (uint32_t)self.entries.count);
+
+    uint8_t fixed[22];
+    for (AIUAWritingIndexEntry *entry in self.entries.objectEnumerator) {
+        NSData *idData = [entry.recordID dataUsingEncoding:NSUTF8StringEncoding];
+        AIUAWritingWriteU64(fixed, (uint64_t)entry.sortKey);
+        AIUAWritingWriteU64(fixed + 8, entry.offset);
+        AIUAWritingWriteU32(fixed + 16, entry.recordLength);
+        fixed[20] = (uint8_t)(idData.length & 0xFF);
+        fixed[21] = (uint8_t)(idData.length >> 8);
+        [data appendBytes:fixed length:sizeof(fixed)];
+        [data appendData:idData];
+
+        NSData *summaryData = nil;
+        if (entry.summary) {
+            summaryData = [NSPropertyListSerialization dataWithPropertyList:entry.summary
+                                                                     format:NSPropertyListBinaryFormat_v1_0
+                                                                    options:0
+                                                                      error:nil];
+        }
+        uint8_t summaryLength[4];
+        AIUAWritingWriteU32(summaryLength, (uint32_t)summaryData.length);
+        [data appendBytes:summaryLength length:sizeof(summaryLength)];
+        if (summaryData) {
+            [data appendData:summaryData];
+        }
+    }
+    if (![data writeToFile:self.indexPath atomically:YES]) {
+        NSLog(@"[WritingStore] ⚠️ 索引快照写入失败");
+    }
+    self.appendsSinceIndexFlush = 0;
+}
+
+#pragma mark - 追加写
+
+- (nullable NSData *)recordDataWithType:(uint8_t)type sortKey:(int64_t)sortKey payload:(NSData *)payload {
+    if (payload.length > UINT32_MAX) {
+        return nil;
+    }
+    NSMutableData *data = [NSMutableData dataWithLength:kAIUAWritingRecordHeaderSize];
+    uint8_t *header = (uint8_t *)data.mutableBytes;
+    AIUAWritingWriteU32(header, kAIUAWritingLogMagic);
+    header[4] = type;
+    AIUAWritingWriteU64(header + 8, (uint64_t)sortKey);
+    AIUAWritingWriteU32(header + 16, (uint32_t)payload.length);
+    AIUAWritingWriteU32(header + 20, AIUAWritingCRC32(payload.bytes, payload.length));
+    [data appendData:payload];
+    return data;
+}
+
+- (nullable NSData *)putPayloadForRecord:(NSDictionary *)record recordID:(NSString *)recordID {
+    NSData *idData = [recordID dataUsingEncoding:NSUTF8StringEncoding];
+    if (idData.length == 0 || idData.length > UINT16_MAX) {
+        return nil;
+    }
+    NSError *error = nil;
+    NSData *plistData = [NSPropertyListSerialization dataWithPropertyList:record
+                                                                   format:NSPropertyListBinaryFormat_v1_0
+                                                                  options:0
+                                                                    error:&error];
+    if (!plistData) {
+        NSLog(@"[WritingStore] ❌ 记录序列化失败: %@", error.localizedDescription);
+        return nil;
+    }
+    NSMutableData *payload = [NSMutableData dataWithCapacity:2 + idData.length + plistData.length];
+    uint8_t idLength[2] = {(uint8_t)(idData.length & 0xFF), (uint8_t)(idData.length >> 8)};
+    [payload appendBytes:idLength length:2];
+    [payload appendData:idData];
+    [payload appendData:plistData];
+    return payload;
+}
+
+// 在队列中调用：追加一条记录，返回其偏移，失败返回 UINT64_MAX
+- (uint64_t)appendRecordData:(NSData *)recordData {
+    if (_fd < 0) {
+        return UINT64_MAX;
+    }
+    uint64_t offset = self.logLength;
+    if (!AIUAWritingWriteAll(_fd, recordData.bytes, recordData.length, (off_t)offset)) {
+        NSLog(@"[WritingStore] ❌ 日志写入失败: %s", strerror(errno));
+        // 丢弃可能写了一半的数据
+        ftruncate(_fd, (off_t)offset);
+        return UINT64_MAX;
+    }
+    self.logLength = offset + recordData.length;
+    self.appendsSinceIndexFlush += 1;
+    return offset;
+}
+
+- (void)didAppendRecord {
+    self.sortedEntries = nil;
+    if (self.appendsSinceIndexFlush >= kAIUAWritingIndexFlushInterval) {
+        [self writeIndexSnapshot];
+    }
+    [self scheduleCompactionIfNeeded];
+}
+
+- (BOOL)putRecord:(NSDictionary *)record keepPosition:(BOOL)keepPosition {
+    NSString *recordID = [record[@"id"] isKindOfClass:[NSString class]] ? record[@"id"] : nil;
+    if (recordID.length == 0) {
+        NSLog(@"[WritingStore] ❌ 记录缺少 id，无法保存");
+        return NO;
+    }
+    NSData *payload = [self putPayloadForRecord:record recordID:recordID];
+    if (!payload) {
+        return NO;
+    }
+    NSDictionary *summary = self.summaryBuilder ? self.summaryBuilder(record) : nil;
+
+    __block BOOL success = NO;
+    dispatch_sync(self.queue, ^{
+        success = [self putRecordID:recordID payload:payload summary:summary keepPosition:keepPosition];
+    });
+    return success;
+}
+
+// 在队列中调用
+- (BOOL)putRecordID:(NSString *)recordID payload:(NSData *)payload summary:(nullable NSDictionary *)summary keepPosition:(BOOL)keepPosition {
+    AIUAWritingIndexEntry *previous = self.entries[recordID];
+    int64_t sortKey = (keepPosition && previous) ? previous.sortKey : self.maxSortKey + 1;
+    NSData *recordData = [self recordDataWithType:kAIUAWritingRecordTypePut sortKey:sortKey payload:payload];
+    if (!recordData) {
+        return NO;
+    }
+    uint64_t offset = [self appendRecordData:recordData];
+    if (offset == UINT64_MAX) {
+        return NO;
+    }
+    if (previous) {
+        self.deadBytes += previous.recordLength;
+    }
+    AIUAWritingIndexEntry *entry = [[AIUAWritingIndexEntry alloc] init];
+    entry.recordID = recordID;
+    entry.sortKey = sortKey;
+    entry.offset = offset;
+    entry.recordLength = (uint32_t)recordData.length;
+    entry.summary = summary;
+    self.entries[recordID] = entry;
+    self.maxSortKey = MAX(self.maxSortKey, sortKey);
+    [self didAppendRecord];
+    return YES;
+}
+
+#pragma mark - 公开接口
+
+- (NSUInteger)count {
+    __block NSUInteger count = 0;
+    dispatch_sync(self.queue, ^{
+        count = self.entries.count;
+    });
+    return count;
+}
+
+- (BOOL)insertRecord:(NSDictionary *)record {
+    return [self putRecord:record keepPosition:NO];
+}
+
+- (BOOL)updateRecord:(NSDictionary *)record {
+    return [self putRecord:record keepPosition:YES];
+}
+
+- (BOOL)transformRecordWithID:(NSString *)recordID usingBlock:(NSDictionary * _Nullable (^)(NSDictionary *record))block {
+    if (recordID.length == 0 || !block) {
+        return NO;
+    }
+    __block BOOL changed = NO;
+    dispatch_sync(self.queue, ^{
+        AIUAWritingIndexEntry *entry = self.entries[recordID];
+        NSDictionary *record = entry ? [self readRecordForEntry:entry] : nil;
+        if (!record) {
+            return;
+        }
+        NSDictionary *transformed = block(record);
+        if (!transformed) {
+            return;
+        }
+        // 转换结果沿用原 id，避免改写到其他记录上
+        NSMutableDictionary *fixed = [transformed mutableCopy];
+        fixed[@"id"] = recordID;
+        NSData *payload = [self putPayloadForRecord:fixed recordID:recordID];
+        if (!payload) {
+            return;
+        }
+        NSDictionary *summary = self.summaryBuilder ? self.summaryBuilder(fixed) : nil;
+        changed = [self putRecordID:recordID payload:payload summary:summary keepPosition:YES];
+    });
+    return changed;
+}
+
+- (NSArray<NSString *> *)allRecordIDs {
+    __block NSArray<NSString *> *recordIDs = nil;
+    dispatch_sync(self.queue, ^{
+        recordIDs = [self.entries.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    });
+    return recordIDs;
+}
+
+- (NSInteger)schemaVersion {
+    __block NSInteger version = 0;
+    dispatch_sync(self.queue, ^{
+        version = self.storedSchemaVersion;
+    });
+    return version;
+}
+
+- (nullable NSString *)migrationCheckpoint {
+    __block NSString *checkpoint = nil;
+    dispatch_sync(self.queue, ^{
+        checkpoint = self.storedMigrationCheckpoint;
+    });
+    return checkpoint;
+}
+
+- (BOOL)setSchemaVersion:(NSInteger)schemaVersion migrationCheckpoint:(nullable NSString *)checkpoint {
+    __block BOOL success = NO;
+    dispatch_sync(self.queue, ^{
+        NSMutableDictionary *meta = [NSMutableDictionary dictionary];
+        meta[kAIUAWritingMetaSchemaVersionKey] = @(schemaVersion);
+        if (checkpoint) {
+            meta[kAIUAWritingMetaMigrationCheckpointKey] = checkpoint;
+        }
+        NSData *data = [NSPropertyListSerialization dataWithPropertyList:meta
+                                                                  format:NSPropertyListBinaryFormat_v1_0
+                                                                 options:0
+                                                                   error:nil];
+        // 断点之前的改动必须先落盘，再记录断点
+        if (self->_fd >= 0) {
+            fsync(self->_fd);
+        }
+        if (!data || ![data writeToFile:self.metaPath atomically:YES]) {
+            NSLog(@"[WritingStore] ❌ 存储头写入失败");
+            return;
+        }
+        self.storedSchemaVersion = schemaVersion;
+        self.storedMigrationCheckpoint = checkpoint;
+        success = YES;
+    });
+    return success;
+}
+
+- (BOOL)removeRecordWithID:(NSString *)recordID {
+    if (recordID.length == 0) {
+        return NO;
+    }
+    __block BOOL success = NO;
+    dispatch_sync(self.queue, ^{
+        AIUAWritingIndexEntry *previous = self.entries[recordID];
+        if (!previous) {
+            return;
+        }
+        NSData *payload = [recordID dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *recordData = [self recordDataWithType:kAIUAWritingRecordTypeDelete sortKey:0 payload:payload];
+        if (!recordData || [self appendRecordData:recordData] == UINT64_MAX) {
+            return;
+        }
+        // 被删除的记录和墓碑本身都是失效数据
+        self.deadBytes += previous.recordLength + recordData.length;
+        [self.entries removeObjectForKey:recordID];
+        [self didAppendRecord];
+        success = YES;
+    });
+    return success;
+}
+
+- (BOOL)removeAllRecords {
+    __block BOOL success = YES;
+    dispatch_sync(self.queue, ^{
+        if (self->_fd >= 0 && ftruncate(self->_fd, 0) != 0) {
+            success = NO;
+            return;
+        }
+        [self.entries removeAllObjects];
+        self.sortedEntries = nil;
+        self.maxSortKey = 0;
+        self.logLength = 0;
+        self.deadBytes = 0;
+        [[NSFileManager defaultManager] removeItemAtPath:self.indexPath error:nil];
+        self.appendsSinceIndexFlush = 0;
+    });
+    return success;
+}
+
+- (NSArray<NSDictionary *> *)allRecords {
+    __block NSMutableArray<NSDictionary *> *records = nil;
+    dispatch_sync(self.queue, ^{
+        NSArray<AIUAWritingIndexEntry *> *sorted = [self sortedEntriesInQueue];
+        records = [NSMutableArray arrayWithCapacity:sorted.count];
+        for (AIUAWritingIndexEntry *entry in sorted) {
+            NSDictionary *record = [self readRecordForEntry:entry];
+            if (record) {
+                [records addObject:record];
+            }
+        }
+    });
+    return [records copy];
+}
+
+- (NSArray<NSDictionary *> *)allSummaries {
+    __block NSMutableArray<NSDictionary *> *summaries = nil;
+    dispatch_sync(self.queue, ^{
+        NSArray<AIUAWritingIndexEntry *> *sorted = [self sortedEntriesInQueue];
+        summaries = [NSMutableArray arrayWithCapacity:sorted.count];
+        for (AIUAWritingIndexEntry *entry in sorted) {
+            if (entry.summary) {
+                [summaries addObject:entry.summary];
+            }
+        }
+    });
+    return [summaries copy];
+}
+
+- (nullable NSDictionary *)recordWithID:(NSString *)recordID {
+    if (recordID.length == 0) {
+        return nil;
+    }
+    __block NSDictionary *record = nil;
+    dispatch_sync(self.queue, ^{
+        AIUAWritingIndexEntry *entry = self.entries[recordID];
+        if (entry) {
+            record = [self readRecordForEntry:entry];
+        }
+    });
+    return record;
+}
+
+- (unsigned long long)fileSize {
+    __block unsigned long long size = 0;
+    dispatch_sync(self.queue, ^{
+        size = self.logLength;
+        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:self.indexPath error:nil];
+        size += [attributes[NSFileSize] unsignedLongLongValue];
+    });
+    return size;
+}
+
+- (void)importLegacyPlistAtPathIfNeeded:(NSString *)plistPath {
+    if (plistPath.length == 0 || ![[NSFileManager defaultManager] fileExistsAtPath:plistPath]) {
+        return;
+    }
+    if (self.count > 0) {
+        // 已有数据说明导入已完成（旧文件删除失败时残留），不重复导入
+        NSLog(@"[WritingStore] ⚠️ 存储已有数据，跳过旧 plist 导入");
+        return;
+    }
+
+    NSArray *legacy = [NSArray arrayWithContentsOfFile:plistPath];
+    if (![legacy isKindOfClass:[NSArray class]]) {
+        NSLog(@"[WritingStore] ❌ 旧 plist 无法读取，保留原文件");
+        return;
+    }
+
+    // 数组第 0 个为最新，倒序写入使其 sortKey 最大
+    NSUInteger imported = 0;
+    NSUInteger index = legacy.count;
+    for (id item in legacy.reverseObjectEnumerator) {
+        index -= 1;
+        if (![item isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        NSDictionary *record = item;
+        NSString *recordID = record[@"id"];
+        if (![recordID isKindOfClass:[NSString class]] || recordID.length == 0) {
+            // 极早期版本的记录可能没有 id，补一个稳定的 id 以便后续删除
+            NSMutableDictionary *fixed = [record mutableCopy];
+            fixed[@"id"] = [NSString stringWithFormat:@"legacy_%lu", (unsigned long)index];
+            record = [fixed copy];
+        }
+        if ([self insertRecord:record]) {
+            imported += 1;
+        }
+    }
+    dispatch_sync(self.queue, ^{
+        if (self->_fd >= 0) {
+            fsync(self->_fd);
+        }
+        [self writeIndexSnapshot];
+    });
+
+    NSError *error = nil;
+    if ([[NSFileManager defaultManager] removeItemAtPath:plistPath error:&error]) {
+        NSLog(@"[WritingStore] ✅ 已从旧 plist 导入 %lu 条记录", (unsigned long)imported);
+    } else {
+        NSLog(@"[WritingStore] ⚠️ 导入完成但旧 plist 删除失败: %@", error.localizedDescription);
+    }
+}
+
+#pragma mark - 读取
+
+- (NSArray<AIUAWritingIndexEntry *> *)sortedEntriesInQueue {
+    if (!self.sortedEntries) {
+        self.sortedEntries = [self.entries.allValues sortedArrayUsingComparator:^NSComparisonResult(AIUAWritingIndexEntry *a, AIUAWritingIndexEntry *b) {
+            if (a.sortKey == b.sortKey) {
+                return NSOrderedSame;
+            }
+            return a.sortKey > b.sortKey ? NSOrderedAscending : NSOrderedDescending;
+        }];
+    }
+    return self.sortedEntries;
+}
+
+- (nullable NSDictionary *)readRecordForEntry:(AIUAWritingIndexEntry *)entry {
+    if (_fd < 0 || entry.recordLength <= kAIUAWritingRecordHeaderSize) {
+        return nil;
+    }
+    NSMutableData *data = [NSMutableData dataWithLength:entry.recordLength];
+    if (!AIUAWritingReadAll(_fd, data.mutableBytes, entry.recordLength, (off_t)entry.offset)) {
+        NSLog(@"[WritingStore] ❌ 读取记录失败: %@", entry.recordID);
+        return nil;
+    }
+    const uint8_t *bytes = (const uint8_t *)data.bytes;
+    uint32_t payloadLength = AIUAWritingReadU32(bytes + 16);
+    const uint8_t *payload = bytes + kAIUAWritingRecordHeaderSize;
+    if (AIUAWritingReadU32(bytes) != kAIUAWritingLogMagic ||
+        payloadLength + kAIUAWritingRecordHeaderSize != entry.recordLength ||
+        AIUAWritingCRC32(payload, payloadLength) != AIUAWritingReadU32(bytes + 20)) {
+        NSLog(@"[WritingStore] ❌ 记录校验失败: %@", entry.recordID);
+        return nil;
+    }
+    return [self recordFromPutPayload:[data subdataWithRange:NSMakeRange(kAIUAWritingRecordHeaderSize, payloadLength)]];
+}
+
+- (nullable NSDictionary *)recordFromPutPayload:(NSData *)payloadData {
+    const uint8_t *payload = (const uint8_t *)payloadData.bytes;
+    NSUInteger length = payloadData.length;
+    if (length < 2) {
+        return nil;
+    }
+    uint16_t idLength = (uint16_t)(payload[0] | (payload[1] << 8));
+    NSUInteger plistOffset = 2 + (NSUInteger)idLength;
+    if (plistOffset >= length) {
+        return nil;
+    }
+    NSData *plistData = [NSData dataWithBytesNoCopy:(void *)(payload + plistOffset) length:length - plistOffset freeWhenDone:NO];
+    id record = [NSPropertyListSerialization propertyListWithData:plistData options:NSPropertyListImmutable format:NULL error:nil];
+    return [record isKindOfClass:[NSDictionary class]] ? record : nil;
+}
+
+#pragma mark - 压缩
+
+- (void)scheduleCompactionIfNeeded {
+    if (self.compactionScheduled) {
+        return;
+    }
+    uint64_t liveBytes = self.logLength - MIN(self.deadBytes, self.logLength);
+    if (self.deadBytes < kAIUAWritingCompactionMinDeadBytes || self.deadBytes < liveBytes) {
+        return;
+    }
+    self.compactionScheduled = YES;
+    // 排到队列后面执行，不阻塞本次保存
+    dispatch_async(self.queue, ^{
+        self.compactionScheduled = NO;
+        [self compactInQueue];
+    });
+}
+
+- (void)compact {
+    dispatch_sync(self.queue, ^{
+        [self compactInQueue];
+    });
+}
+
+// 把有效记录按原样复制到新日志，再原子替换
+- (void)compactInQueue {
+    if (_fd < 0 || self.deadBytes == 0) {
+        return;
+    }
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSString *tempPath = [self.logPath stringByAppendingString:@".compact"];
+    int tempFD = open(tempPath.fileSystemRepresentation, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tempFD < 0) {
+        NSLog(@"[WritingStore] ❌ 压缩失败，无法创建临时文件: %s", strerror(errno));
+        return;
+    }
+
+    NSArray<AIUAWritingIndexEntry *> *sorted = [self sortedEntriesInQueue];
+    NSMutableDictionary<NSString *, AIUAWritingIndexEntry *> *newEntries = [NSMutableDictionary dictionaryWithCapacity:sorted.count];
+    NSMutableData *buffer = [NSMutableData data];
+    uint64_t newLength = 0;
+    BOOL success = YES;
+    // 旧记录在前，保持与追加顺序一致
+    for (AIUAWritingIndexEntry *entry in sorted.reverseObjectEnumerator) {
+        buffer.length = entry.recordLength;
+        if (!AIUAWritingReadAll(_fd, buffer.mutableBytes, entry.recordLength, (off_t)entry.offset) ||
+            !AIUAWritingWriteAll(tempFD, buffer.bytes, entry.recordLength, (off_t)newLength)) {
+            success = NO;
+            break;
+        }
+        newEntries[entry.recordID] = [entry entryMovedToOffset:newLength];
+        newLength += entry.recordLength;
+    }
+
+    // 先删除旧索引快照，避免替换日志后崩溃时旧快照的偏移指向新日志
+    unlink(self.indexPath.fileSystemRepresentation);
+    if (!success || fsync(tempFD) != 0 || rename(tempPath.fileSystemRepresentation, self.logPath.fileSystemRepresentation) != 0) {
+        NSLog(@"[WritingStore] ❌ 压缩失败: %s", strerror(errno));
+        close(tempFD);
+        unlink(tempPath.fileSystemRepresentation);
+        return;
+    }
+
+    close(_fd);
+    _fd = tempFD;
+    uint64_t reclaimed = self.logLength - newLength;
+    self.entries = newEntries;
+    self.sortedEntries = nil;
+    self.logLength = newLength;
+    self.deadBytes = 0;
+    [self writeIndexSnapshot];
+    NSLog(@"[WritingStore] 压缩完成: 回收 %llu 字节，剩余 %llu 字节，耗时 %.1fms",
+          reclaimed, newLength, (CFAbsoluteTimeGetCurrent() - start) * 1000);
+}
+
+@end
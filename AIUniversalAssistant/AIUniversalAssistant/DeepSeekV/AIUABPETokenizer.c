@@ -0,0 +1,612 @@
+//
+//  AIUABPETokenizer.c
+//  AIUniversalAssistant
+//
+//  二进制表布局（均为本机字节序的 uint32，生成与读取都在本机完成）：
+//    AIUABPEHeader
+//    tokenOffsets[vocabSize + 1]           token i 的字节为 tokenBytes[tokenOffsets[i], tokenOffsets[i + 1])
+//    mergeTable[mergeCapacity][4]          { 左 id, 右 id, 优先级, 合并结果 }，空槽左 id 为 AIUA_BPE_INVALID_TOKEN
+//    vocabTable[vocabCapacity]             按 token 字节哈希的 id 索引，空槽为 AIUA_BPE_INVALID_TOKEN
+//    tokenBytes[tokenBytesLength]
+//
+
+#include "AIUABPETokenizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AIUA_BPE_MAGIC 0x54425041u     // "APBT"
+#define AIUA_BPE_VERSION 1u
+#define AIUA_BPE_FLAG_IGNORE_MERGES 1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vocabSize;
+    uint32_t mergeCount;
+    uint32_t mergeCapacity;     // 2 的幂
+    uint32_t vocabCapacity;     // 2 的幂
+    uint32_t tokenBytesLength;
+    uint32_t flags;
+    uint32_t byteTokens[256];   // 单字节对应的 token
+} AIUABPEHeader;
+
+#pragma mark - 哈希
+
+static inline uint32_t AIUABPEMix(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline uint32_t AIUABPEPairHash(uint32_t left, uint32_t right) {
+    return AIUABPEMix(left ^ AIUABPEMix(right + 0x9e3779b9u));
+}
+
+static uint32_t AIUABPEBytesHash(const uint8_t *bytes, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h ^= bytes[i];
+        h *= 16777619u;
+    }
+    return AIUABPEMix(h);
+}
+
+static uint32_t AIUABPECapacityForCount(uint32_t count) {
+    uint32_t capacity = 16;
+    while (capacity < count * 2u && capacity < (1u << 30)) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+#pragma mark - 校验
+
+// 逐项检查表内容，保证编码与取 token 字节时的下标都在范围内（DeepSeek 词表约 1ms）
+static bool AIUABPETableValid(const AIUABPEHeader *header, const uint32_t *tokenOffsets,
+                              const uint32_t *mergeTable, const uint32_t *vocabTable) {
+    uint32_t vocabSize = header->vocabSize;
+    if (tokenOffsets[0] != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < vocabSize; i++) {
+        if (tokenOffsets[i] > tokenOffsets[i + 1]) {
+            return false;
+        }
+    }
+    // 单字节 token 须确实是该字节
+    const uint8_t *tokenBytes = (const uint8_t *)(vocabTable + header->vocabCapacity);
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        uint32_t tokenID = header->byteTokens[byte];
+        if (tokenID == AIUA_BPE_INVALID_TOKEN) {
+            continue;
+        }
+        if (tokenID >= vocabSize || tokenOffsets[tokenID + 1] - tokenOffsets[tokenID] != 1 ||
+            tokenBytes[tokenOffsets[tokenID]] != byte) {
+            return false;
+        }
+    }
+    for (uint32_t slot = 0; slot < header->vocabCapacity; slot++) {
+        uint32_t tokenID = vocabTable[slot];
+        if (tokenID != AIUA_BPE_INVALID_TOKEN &&
+            (tokenID >= vocabSize || tokenOffsets[tokenID + 1] == tokenOffsets[tokenID])) {
+            return false;
+        }
+    }
+    uint32_t mergeCount = 0;
+    for (uint32_t slot = 0; slot < header->mergeCapacity; slot++) {
+        const uint32_t *entry = mergeTable + (size_t)slot * 4;
+        if (entry[0] == AIUA_BPE_INVALID_TOKEN) {
+            continue;
+        }
+        if (entry[0] >= vocabSize || entry[1] >= vocabSize || entry[3] >= vocabSize) {
+            return false;
+        }
+        mergeCount++;
+    }
+    return mergeCount == header->mergeCount;
+}
+
+#pragma mark - 分词器
+
+typedef struct {
+    uint32_t rank;
+    uint32_t position;
+    uint32_t merged;
+} AIUABPECandidate;
+
+struct AIUABPETokenizer {
+    const AIUABPEHeader *header;
+    const uint32_t *tokenOffsets;
+    const uint32_t *mergeTable;
+    const uint32_t *vocabTable;
+    const uint8_t *tokenBytes;
+
+    // 编码暂存区（按最长片段增长）
+    uint32_t *ids;
+    uint32_t *next;
+    uint32_t *prev;
+    size_t symbolCapacity;
+    AIUABPECandidate *heap;
+    size_t heapCount;
+    size_t heapCapacity;
+};
+
+AIUABPETokenizer *AIUABPETokenizerCreate(const void *data, size_t length) {
+    if (!data || length < sizeof(AIUABPEHeader) || ((uintptr_t)data & 3u) != 0) {
+        return NULL;
+    }
+    const AIUABPEHeader *header = (const AIUABPEHeader *)data;
+    if (header->magic != AIUA_BPE_MAGIC || header->version != AIUA_BPE_VERSION) {
+        return NULL;
+    }
+    if (header->vocabSize == 0 || header->vocabSize >= AIUA_BPE_INVALID_TOKEN ||
+        (header->mergeCapacity & (header->mergeCapacity - 1)) != 0 || header->mergeCapacity == 0 ||
+        (header->vocabCapacity & (header->vocabCapacity - 1)) != 0 || header->vocabCapacity == 0) {
+        return NULL;
+    }
+    uint64_t expected = sizeof(AIUABPEHeader)
+        + ((uint64_t)header->vocabSize + 1) * sizeof(uint32_t)
+        + (uint64_t)header->mergeCapacity * 4 * sizeof(uint32_t)
+        + (uint64_t)header->vocabCapacity * sizeof(uint32_t)
+        + header->tokenBytesLength;
+    if (expected > length) {
+        return NULL;
+    }
+
+    AIUABPETokenizer *tokenizer = (AIUABPETokenizer *)calloc(1, sizeof(AIUABPETokenizer));
+    if (!tokenizer) {
+        return NULL;
+    }
+    const uint32_t *words = (const uint32_t *)(header + 1);
+    tokenizer->header = header;
+    tokenizer->tokenOffsets = words;
+    tokenizer->mergeTable = tokenizer->tokenOffsets + header->vocabSize + 1;
+    tokenizer->vocabTable = tokenizer->mergeTable + (size_t)header->mergeCapacity * 4;
+    tokenizer->tokenBytes = (const uint8_t *)(tokenizer->vocabTable + header->vocabCapacity);
+    if (tokenizer->tokenOffsets[header->vocabSize] > header->tokenBytesLength ||
+        !AIUABPETableValid(header, tokenizer->tokenOffsets, tokenizer->mergeTable, tokenizer->vocabTable)) {
+        free(tokenizer);
+        return NULL;
+    }
+    return tokenizer;
+}
+
+void AIUABPETokenizerDestroy(AIUABPETokenizer *tokenizer) {
+    if (!tokenizer) {
+        return;
+    }
+    free(tokenizer->ids);
+    free(tokenizer->next);
+    free(tokenizer->prev);
+    free(tokenizer->heap);
+    free(tokenizer);
+}
+
+uint32_t AIUABPETokenizerGetVocabSize(const AIUABPETokenizer *tokenizer) {
+    return tokenizer ? tokenizer->header->vocabSize : 0;
+}
+
+const uint8_t *AIUABPETokenizerGetTokenBytes(const AIUABPETokenizer *tokenizer, uint32_t tokenID, size_t *length) {
+    if (!tokenizer || tokenID >= tokenizer->header->vocabSize) {
+        return NULL;
+    }
+    uint32_t start = tokenizer->tokenOffsets[tokenID];
+    uint32_t end = tokenizer->tokenOffsets[tokenID + 1];
+    if (length) {
+        *length = end - start;
+    }
+    return tokenizer->tokenBytes + start;
+}
+
+// 查找合并规则，找到时返回 true 并输出优先级与合并结果
+static bool AIUABPELookupMerge(const AIUABPETokenizer *tokenizer, uint32_t left, uint32_t right,
+                               uint32_t *rank, uint32_t *merged) {
+    if (left == AIUA_BPE_INVALID_TOKEN || right == AIUA_BPE_INVALID_TOKEN) {
+        return false;
+    }
+    uint32_t mask = tokenizer->header->mergeCapacity - 1;
+    uint32_t slot = AIUABPEPairHash(left, right) & mask;
+    for (uint32_t probe = 0; probe <= mask; probe++) {
+        const uint32_t *entry = tokenizer->mergeTable + (size_t)slot * 4;
+        if (entry[0] == AIUA_BPE_INVALID_TOKEN) {
+            return false;
+        }
+        if (entry[0] == left && entry[1] == right) {
+            *rank = entry[2];
+            *merged = entry[3];
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+static uint32_t AIUABPELookupToken(const AIUABPETokenizer *tokenizer, const uint8_t *bytes, size_t length) {
+    uint32_t mask = tokenizer->header->vocabCapacity - 1;
+    uint32_t slot = AIUABPEBytesHash(bytes, length) & mask;
+    for (uint32_t probe = 0; probe <= mask; probe++) {
+        uint32_t tokenID = tokenizer->vocabTable[slot];
+        if (tokenID == AIUA_BPE_INVALID_TOKEN) {
+            return AIUA_BPE_INVALID_TOKEN;
+        }
+        size_t tokenLength = 0;
+        const uint8_t *tokenBytes = AIUABPETokenizerGetTokenBytes(tokenizer, tokenID, &tokenLength);
+        if (tokenLength == length && memcmp(tokenBytes, bytes, length) == 0) {
+            return tokenID;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return AIUA_BPE_INVALID_TOKEN;
+}
+
+static inline bool AIUABPECandidateLess(const AIUABPECandidate *a, const AIUABPECandidate *b) {
+    return a->rank < b->rank || (a->rank == b->rank && a->position < b->position);
+}
+
+static void AIUABPEHeapPush(AIUABPETokenizer *tokenizer, AIUABPECandidate candidate) {
+    AIUABPECandidate *heap = tokenizer->heap;
+    size_t index = tokenizer->heapCount++;
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!AIUABPECandidateLess(&candidate, &heap[parent])) {
+            break;
+        }
+        heap[index] = heap[parent];
+        index = parent;
+    }
+    heap[index] = candidate;
+}
+
+static AIUABPECandidate AIUABPEHeapPop(AIUABPETokenizer *tokenizer) {
+    AIUABPECandidate *heap = tokenizer->heap;
+    AIUABPECandidate top = heap[0];
+    AIUABPECandidate last = heap[--tokenizer->heapCount];
+    size_t count = tokenizer->heapCount;
+    size_t index = 0;
+    while (true) {
+        size_t child = index * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && AIUABPECandidateLess(&heap[child + 1], &heap[child])) {
+            child += 1;
+        }
+        if (!AIUABPECandidateLess(&heap[child], &last)) {
+            break;
+        }
+        heap[index] = heap[child];
+        index = child;
+    }
+    if (count > 0) {
+        heap[index] = last;
+    }
+    return top;
+}
+
+static void AIUABPEPushPair(AIUABPETokenizer *tokenizer, uint32_t position) {
+    uint32_t nextPosition = tokenizer->next[position];
+    uint32_t rank = 0;
+    uint32_t merged = 0;
+    if (AIUABPELookupMerge(tokenizer, tokenizer->ids[position], tokenizer->ids[nextPosition], &rank, &merged)) {
+        AIUABPECandidate candidate = { rank, position, merged };
+        AIUABPEHeapPush(tokenizer, candidate);
+    }
+}
+
+static bool AIUABPEReserve(AIUABPETokenizer *tokenizer, size_t length) {
+    if (length <= tokenizer->symbolCapacity) {
+        return true;
+    }
+    size_t capacity = tokenizer->symbolCapacity ? tokenizer->symbolCapacity : 64;
+    while (capacity < length) {
+        capacity *= 2;
+    }
+    uint32_t *ids = (uint32_t *)realloc(tokenizer->ids, capacity * sizeof(uint32_t));
+    if (!ids) {
+        return false;
+    }
+    tokenizer->ids = ids;
+    uint32_t *next = (uint32_t *)realloc(tokenizer->next, capacity * sizeof(uint32_t));
+    if (!next) {
+        return false;
+    }
+    tokenizer->next = next;
+    uint32_t *prev = (uint32_t *)realloc(tokenizer->prev, capacity * sizeof(uint32_t));
+    if (!prev) {
+        return false;
+    }
+    tokenizer->prev = prev;
+    // 每次合并最多新增两个候选，初始候选不超过 length - 1
+    AIUABPECandidate *heap = (AIUABPECandidate *)realloc(tokenizer->heap, capacity * 3 * sizeof(AIUABPECandidate));
+    if (!heap) {
+        return false;
+    }
+    tokenizer->heap = heap;
+    tokenizer->heapCapacity = capacity * 3;
+    tokenizer->symbolCapacity = capacity;
+    return true;
+}
+
+size_t AIUABPETokenizerEncode(AIUABPETokenizer *tokenizer,
+                              const uint8_t *bytes,
+                              size_t length,
+                              uint32_t *tokens,
+                              size_t capacity) {
+    if (!tokenizer || !bytes || length == 0) {
+        return 0;
+    }
+    if ((tokenizer->header->flags & AIUA_BPE_FLAG_IGNORE_MERGES) != 0) {
+        uint32_t whole = AIUABPELookupToken(tokenizer, bytes, length);
+        if (whole != AIUA_BPE_INVALID_TOKEN) {
+            if (tokens && capacity > 0) {
+                tokens[0] = whole;
+            }
+            return 1;
+        }
+    }
+    if (length >= UINT32_MAX || !AIUABPEReserve(tokenizer, length)) {
+        return length;
+    }
+
+    // 链表中 next == length 表示末尾；被合并掉的符号 id 置为无效
+    uint32_t *ids = tokenizer->ids;
+    uint32_t *next = tokenizer->next;
+    uint32_t *prev = tokenizer->prev;
+    uint32_t end = (uint32_t)length;
+    for (uint32_t i = 0; i < end; i++) {
+        ids[i] = tokenizer->header->byteTokens[bytes[i]];
+        next[i] = i + 1;
+        prev[i] = i == 0 ? end : i - 1;
+    }
+    tokenizer->heapCount = 0;
+    for (uint32_t i = 0; i + 1 < end; i++) {
+        AIUABPEPushPair(tokenizer, i);
+    }
+
+    size_t count = length;
+    while (tokenizer->heapCount > 0) {
+        AIUABPECandidate candidate = AIUABPEHeapPop(tokenizer);
+        uint32_t position = candidate.position;
+        if (ids[position] == AIUA_BPE_INVALID_TOKEN) {
+            continue;
+        }
+        uint32_t right = next[position];
+        if (right >= end) {
+            continue;
+        }
+        // 候选可能已失效：只有当前相邻对仍合并为同一结果时才执行
+        uint32_t rank = 0;
+        uint32_t merged = 0;
+        if (!AIUABPELookupMerge(tokenizer, ids[position], ids[right], &rank, &merged) || merged != candidate.merged) {
+            continue;
+        }
+        ids[position] = merged;
+        ids[right] = AIUA_BPE_INVALID_TOKEN;
+        next[position] = next[right];
+        if (next[right] < end) {
+            prev[next[right]] = position;
+        }
+        count -= 1;
+        if (prev[position] < end) {
+            AIUABPEPushPair(tokenizer, prev[position]);
+        }
+        if (next[position] < end) {
+            AIUABPEPushPair(tokenizer, position);
+        }
+    }
+
+    if (tokens && capacity > 0) {
+        size_t written = 0;
+        for (uint32_t i = 0; i < end && written < capacity; i = next[i]) {
+            tokens[written++] = ids[i];
+        }
+    }
+    return count;
+}
+
+#pragma mark - 生成器
+
+typedef struct {
+    uint32_t left;
+    uint32_t right;
+    uint32_t merged;
+} AIUABPEMerge;
+
+struct AIUABPETokenizerBuilder {
+    uint32_t vocabSize;
+    uint32_t *tokenOffsets;     // 每个 token 在 tokenBytes 中的起点
+    uint32_t *tokenLengths;
+    uint8_t *tokenBytes;
+    size_t tokenBytesLength;
+    size_t tokenBytesCapacity;
+    AIUABPEMerge *merges;
+    size_t mergeCount;
+    size_t mergeCapacity;
+    bool ignoreMerges;
+};
+
+AIUABPETokenizerBuilder *AIUABPETokenizerBuilderCreate(uint32_t vocabSize) {
+    if (vocabSize == 0 || vocabSize >= AIUA_BPE_INVALID_TOKEN) {
+        return NULL;
+    }
+    AIUABPETokenizerBuilder *builder = (AIUABPETokenizerBuilder *)calloc(1, sizeof(AIUABPETokenizerBuilder));
+    if (!builder) {
+        return NULL;
+    }
+    builder->vocabSize = vocabSize;
+    builder->tokenOffsets = (uint32_t *)calloc(vocabSize, sizeof(uint32_t));
+    builder->tokenLengths = (uint32_t *)calloc(vocabSize, sizeof(uint32_t));
+    if (!builder->tokenOffsets || !builder->tokenLengths) {
+        AIUABPETokenizerBuilderDestroy(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+void AIUABPETokenizerBuilderDestroy(AIUABPETokenizerBuilder *builder) {
+    if (!builder) {
+        return;
+    }
+    free(builder->tokenOffsets);
+    free(builder->tokenLengths);
+    free(builder->tokenBytes);
+    free(builder->merges);
+    free(builder);
+}
+
+bool AIUABPETokenizerBuilderSetToken(AIUABPETokenizerBuilder *builder, uint32_t tokenID, const uint8_t *bytes, size_t length) {
+    if (!builder || tokenID >= builder->vocabSize || (!bytes && length > 0) || length >= UINT32_MAX) {
+        return false;
+    }
+    if (builder->tokenBytesLength + length > UINT32_MAX) {
+        return false;
+    }
+    if (builder->tokenBytesLength + length > builder->tokenBytesCapacity) {
+        size_t capacity = builder->tokenBytesCapacity ? builder->tokenBytesCapacity : 4096;
+        while (capacity < builder->tokenBytesLength + length) {
+            capacity *= 2;
+        }
+        uint8_t *tokenBytes = (uint8_t *)realloc(builder->tokenBytes, capacity);
+        if (!tokenBytes) {
+            return false;
+        }
+        builder->tokenBytes = tokenBytes;
+        builder->tokenBytesCapacity = capacity;
+    }
+    if (length > 0) {
+        memcpy(builder->tokenBytes + builder->tokenBytesLength, bytes, length);
+    }
+    builder->tokenOffsets[tokenID] = (uint32_t)builder->tokenBytesLength;
+    builder->tokenLengths[tokenID] = (uint32_t)length;
+    builder->tokenBytesLength += length;
+    return true;
+}
+
+bool AIUABPETokenizerBuilderAddMerge(AIUABPETokenizerBuilder *builder, uint32_t leftID, uint32_t rightID, uint32_t mergedID) {
+    if (!builder || leftID >= builder->vocabSize || rightID >= builder->vocabSize || mergedID >= builder->vocabSize) {
+        return false;
+    }
+    if (builder->mergeCount == builder->mergeCapacity) {
+        size_t capacity = builder->mergeCapacity ? builder->mergeCapacity * 2 : 1024;
+        AIUABPEMerge *merges = (AIUABPEMerge *)realloc(builder->merges, capacity * sizeof(AIUABPEMerge));
+        if (!merges) {
+            return false;
+        }
+        builder->merges = merges;
+        builder->mergeCapacity = capacity;
+    }
+    AIUABPEMerge merge = { leftID, rightID, mergedID };
+    builder->merges[builder->mergeCount++] = merge;
+    return true;
+}
+
+void AIUABPETokenizerBuilderSetIgnoreMerges(AIUABPETokenizerBuilder *builder, bool ignoreMerges) {
+    if (builder) {
+        builder->ignoreMerges = ignoreMerges;
+    }
+}
+
+bool AIUABPETokenizerBuilderFinish(AIUABPETokenizerBuilder *builder, uint8_t **data, size_t *length) {
+    if (!builder || !data || !length || builder->mergeCount >= UINT32_MAX / 2) {
+        return false;
+    }
+    uint32_t vocabSize = builder->vocabSize;
+    uint32_t mergeCapacity = AIUABPECapacityForCount((uint32_t)builder->mergeCount);
+    uint32_t vocabCapacity = AIUABPECapacityForCount(vocabSize);
+    size_t total = sizeof(AIUABPEHeader)
+        + ((size_t)vocabSize + 1) * sizeof(uint32_t)
+        + (size_t)mergeCapacity * 4 * sizeof(uint32_t)
+        + (size_t)vocabCapacity * sizeof(uint32_t)
+        + builder->tokenBytesLength;
+    uint8_t *buffer = (uint8_t *)malloc(total);
+    if (!buffer) {
+        return false;
+    }
+
+    AIUABPEHeader *header = (AIUABPEHeader *)buffer;
+    memset(header, 0, sizeof(AIUABPEHeader));
+    header->magic = AIUA_BPE_MAGIC;
+    header->version = AIUA_BPE_VERSION;
+    header->vocabSize = vocabSize;
+    header->mergeCapacity = mergeCapacity;
+    header->vocabCapacity = vocabCapacity;
+    header->tokenBytesLength = (uint32_t)builder->tokenBytesLength;
+    header->flags = builder->ignoreMerges ? AIUA_BPE_FLAG_IGNORE_MERGES : 0;
+
+    // token 按 id 顺序重新排列字节，offsets 单调递增
+    uint32_t *tokenOffsets = (uint32_t *)(header + 1);
+    uint32_t *mergeTable = tokenOffsets + vocabSize + 1;
+    uint32_t *vocabTable = mergeTable + (size_t)mergeCapacity * 4;
+    uint8_t *tokenBytes = (uint8_t *)(vocabTable + vocabCapacity);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < vocabSize; i++) {
+        tokenOffsets[i] = offset;
+        memcpy(tokenBytes + offset, builder->tokenBytes + builder->tokenOffsets[i], builder->tokenLengths[i]);
+        offset += builder->tokenLengths[i];
+    }
+    tokenOffsets[vocabSize] = offset;
+
+    memset(vocabTable, 0xFF, (size_t)vocabCapacity * sizeof(uint32_t));
+    for (uint32_t i = 0; i < 256; i++) {
+        header->byteTokens[i] = AIUA_BPE_INVALID_TOKEN;
+    }
+    uint32_t vocabMask = vocabCapacity - 1;
+    for (uint32_t i = 0; i < vocabSize; i++) {
+        uint32_t tokenLength = tokenOffsets[i + 1] - tokenOffsets[i];
+        if (tokenLength == 0) {
+            continue;
+        }
+        const uint8_t *bytes = tokenBytes + tokenOffsets[i];
+        if (tokenLength == 1 && header->byteTokens[bytes[0]] == AIUA_BPE_INVALID_TOKEN) {
+            header->byteTokens[bytes[0]] = i;
+        }
+        // 相同字节的 token 只索引第一个
+        uint32_t slot = AIUABPEBytesHash(bytes, tokenLength) & vocabMask;
+        bool duplicate = false;
+        while (vocabTable[slot] != AIUA_BPE_INVALID_TOKEN) {
+            uint32_t other = vocabTable[slot];
+            uint32_t otherLength = tokenOffsets[other + 1] - tokenOffsets[other];
+            if (otherLength == tokenLength && memcmp(tokenBytes + tokenOffsets[other], bytes, tokenLength) == 0) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & vocabMask;
+        }
+        if (!duplicate) {
+            vocabTable[slot] = i;
+        }
+    }
+
+    memset(mergeTable, 0xFF, (size_t)mergeCapacity * 4 * sizeof(uint32_t));
+    uint32_t mergeMask = mergeCapacity - 1;
+    uint32_t mergeCount = 0;
+    for (size_t rank = 0; rank < builder->mergeCount; rank++) {
+        const AIUABPEMerge *merge = &builder->merges[rank];
+        uint32_t slot = AIUABPEPairHash(merge->left, merge->right) & mergeMask;
+        bool duplicate = false;
+        while (mergeTable[(size_t)slot * 4] != AIUA_BPE_INVALID_TOKEN) {
+            if (mergeTable[(size_t)slot * 4] == merge->left && mergeTable[(size_t)slot * 4 + 1] == merge->right) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & mergeMask;
+        }
+        if (duplicate) {
+            continue;
+        }
+        uint32_t *entry = mergeTable + (size_t)slot * 4;
+        entry[0] = merge->left;
+        entry[1] = merge->right;
+        entry[2] = (uint32_t)rank;
+        entry[3] = merge->merged;
+        mergeCount += 1;
+    }
+    header->mergeCount = mergeCount;
+
+    *data = buffer;
+    *length = total;
+    return true;
+}
@@ -0,0 +1,83 @@
+//
+//  AIUABPETokenizer.h
+//  AIUniversalAssistant
+//
+//  字节级 BPE 分词引擎，纯C实现
+//  - 词表与合并规则编译为一块紧凑的二进制表（AIUABPETokenizerBuilder 生成），可直接内存映射使用，加载时无需解析
+//  - 合并规则存放在开放寻址哈希表中（左 id + 右 id → 优先级与合并结果），合并循环使用最小堆，单个片段 O(n log n)
+//  - 优先级相同的相邻对从左到右合并，失效的候选按当前相邻对重新核对，与 HuggingFace tokenizers 的 BPE 结果一致
+//  - 只负责单个预分词片段（UTF-8 字节）的合并，按正则预分词由调用方完成
+//  - 编码使用引擎内部的暂存区，非线程安全，由调用方串行访问
+//
+
+#ifndef AIUABPETokenizer_h
+#define AIUABPETokenizer_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 无效的 token id
+#define AIUA_BPE_INVALID_TOKEN UINT32_MAX
+
+typedef struct AIUABPETokenizer AIUABPETokenizer;
+typedef struct AIUABPETokenizerBuilder AIUABPETokenizerBuilder;
+
+#pragma mark - 编码
+
+/**
+ * 从二进制表创建分词器（不拷贝 data，data 须在分词器销毁前保持有效）
+ * 加载时校验 token 偏移单调、词表与合并规则中的 id 小于 vocabSize、单字节 token 与其字节一致，
+ * 缓存文件损坏时返回 NULL 而不是在编码时越界读
+ * @return 数据格式、长度或内容不正确时返回 NULL
+ */
+AIUABPETokenizer *AIUABPETokenizerCreate(const void *data, size_t length);
+void AIUABPETokenizerDestroy(AIUABPETokenizer *tokenizer);
+
+/**
+ * 编码一个预分词片段
+ * @param tokens 输出 token id，可以为 NULL（只计数）；写入 min(返回值, capacity) 个
+ * @return token 数；内存不足时返回字节数（token 数的上限）
+ */
+size_t AIUABPETokenizerEncode(AIUABPETokenizer *tokenizer,
+                              const uint8_t *bytes,
+                              size_t length,
+                              uint32_t *tokens,
+                              size_t capacity);
+
+/// 词表大小
+uint32_t AIUABPETokenizerGetVocabSize(const AIUABPETokenizer *tokenizer);
+
+/// token 对应的字节，id 无效时返回 NULL
+const uint8_t *AIUABPETokenizerGetTokenBytes(const AIUABPETokenizer *tokenizer, uint32_t tokenID, size_t *length);
+
+#pragma mark - 生成二进制表
+
+/// 创建生成器，vocabSize 为 token id 上限（不含）
+AIUABPETokenizerBuilder *AIUABPETokenizerBuilderCreate(uint32_t vocabSize);
+void AIUABPETokenizerBuilderDestroy(AIUABPETokenizerBuilder *builder);
+
+/// 设置 token 的字节内容（字节级映射已还原为原始字节）
+bool AIUABPETokenizerBuilderSetToken(AIUABPETokenizerBuilder *builder, uint32_t tokenID, const uint8_t *bytes, size_t length);
+
+/// 按优先级顺序添加合并规则（先添加的优先），重复的相邻对只保留第一条
+bool AIUABPETokenizerBuilderAddMerge(AIUABPETokenizerBuilder *builder, uint32_t leftID, uint32_t rightID, uint32_t mergedID);
+
+/// 整个片段在词表中时直接作为一个 token（对应 tokenizer.json 的 ignore_merges）
+void AIUABPETokenizerBuilderSetIgnoreMerges(AIUABPETokenizerBuilder *builder, bool ignoreMerges);
+
+/**
+ * 生成二进制表
+ * @param data 输出 malloc 分配的数据，由调用方 free
+ */
+bool AIUABPETokenizerBuilderFinish(AIUABPETokenizerBuilder *builder, uint8_t **data, size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUABPETokenizer_h */
@@ -0,0 +1,88 @@
+//
+//  AIUAConversationContext.h
+//  AIUniversalAssistant
+//
+//  多轮对话上下文：按 token 预算组装每次请求的消息
+//  - 系统提示与模板说明只在创建时拼接一次，之后每次请求的首条消息逐字节相同，便于上游命中前缀缓存
+//  - 历史消息的 token 数超过阈值时，一次性把较早的轮次折叠为摘要，压缩到预算的一半左右；
+//    两次压缩之间请求只在末尾追加消息，前缀保持不变
+//  - 摘要默认取每条被折叠消息的开头一句（不额外请求），可替换为自定义摘要
+//  - token 数由 AIUATokenizer 计数，每条消息只计一次
+//  - 非线程安全，在主线程使用（与 AIUADeepSeekWriter 的回调线程一致）
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * 生成摘要
+ * @param previousSummary 之前的摘要，没有时为 nil
+ * @param droppedMessages 本次被折叠的消息（按时间顺序，@{@"role": ..., @"content": ...}）
+ */
+typedef NSString * _Nonnull (^AIUAConversationSummaryBuilder)(NSString * _Nullable previousSummary,
+                                                               NSArray<NSDictionary<NSString *, NSString *> *> *droppedMessages);
+
+@interface AIUAConversationContext : NSObject
+
+/// 固定前缀（系统提示 + 模板说明），每次请求的首条 system 消息内容
+@property (nonatomic, copy, readonly) NSString *prefix;
+
+/// 单次请求的输入 token 预算
+@property (nonatomic, assign, readonly) NSUInteger tokenBudget;
+
+/// 超过预算的该比例时触发压缩，默认 0.8
+@property (nonatomic, assign) double compactionThreshold;
+
+/// 压缩后保留的比例，默认 0.5（留出空间，使后续多轮都不需要再压缩）
+@property (nonatomic, assign) double retainRatio;
+
+/// 摘要的 token 上限，超出时丢弃最早的摘要内容，默认 300
+@property (nonatomic, assign) NSUInteger summaryTokenLimit;
+
+/// 自定义摘要，为 nil 时使用默认摘要
+@property (nonatomic, copy, nullable) AIUAConversationSummaryBuilder summaryBuilder;
+
+/// 当前摘要，未压缩过时为 nil
+@property (nonatomic, copy, readonly, nullable) NSString *summary;
+
+/// 未折叠的历史消息数
+@property (nonatomic, assign, readonly) NSUInteger messageCount;
+
+/// 已压缩次数
+@property (nonatomic, assign, readonly) NSUInteger compactionCount;
+
+/// 固定前缀的 token 数（每次请求都可命中缓存的部分）
+@property (nonatomic, assign, readonly) NSUInteger stablePrefixTokenCount;
+
+/// 最近一次 messagesForRequest 与上一次请求相同的前缀 token 数（可命中上游前缀缓存的部分）
+@property (nonatomic, assign, readonly) NSUInteger cacheablePrefixTokenCount;
+
+/// 最近一次 messagesForRequest 的输入 token 数
+@property (nonatomic, assign, readonly) NSUInteger promptTokenCount;
+
+/**
+ * @param systemPrompt 系统提示
+ * @param templatePrompt 模板说明（写作模板的固定要求），可为 nil
+ * @param tokenBudget 输入 token 预算
+ */
+- (instancetype)initWithSystemPrompt:(nullable NSString *)systemPrompt
+                      templatePrompt:(nullable NSString *)templatePrompt
+                         tokenBudget:(NSUInteger)tokenBudget NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)appendUserMessage:(NSString *)content;
+- (void)appendAssistantMessage:(NSString *)content;
+
+/// 撤回最后一条用户消息（请求失败或回复为空时调用，重试时不会出现连续两条用户消息）；最后一条不是用户消息时返回 NO
+- (BOOL)removeLastUserMessage;
+
+/// 本次请求的消息（需要时先压缩），每个元素为 @{@"role": ..., @"content": ...}
+- (NSArray<NSDictionary<NSString *, NSString *> *> *)messagesForRequest;
+
+/// 清空历史与摘要（保留前缀）
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
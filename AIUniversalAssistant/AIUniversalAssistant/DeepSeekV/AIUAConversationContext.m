@@ -0,0 +1,244 @@
+//
+//  AIUAConversationContext.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAConversationContext.h"
+#import "AIUATokenizer.h"
+
+static const double kAIUAConversationDefaultCompactionThreshold = 0.8;
+static const double kAIUAConversationDefaultRetainRatio = 0.5;
+static const NSUInteger kAIUAConversationDefaultSummaryTokenLimit = 300;
+// 默认摘要中每条消息保留的最大字符数
+static const NSUInteger kAIUAConversationSummaryLineLength = 60;
+// 对话模板的开始标记与末尾的助手标记
+static const NSUInteger kAIUAConversationTemplateTokens = 2;
+
+static NSString * const kAIUAConversationSummaryHeader = @"以下是之前对话的摘要：\n";
+
+@interface AIUAConversationContext ()
+
+@property (nonatomic, copy, readwrite) NSString *prefix;
+@property (nonatomic, assign, readwrite) NSUInteger tokenBudget;
+@property (nonatomic, copy, readwrite, nullable) NSString *summary;
+@property (nonatomic, assign, readwrite) NSUInteger compactionCount;
+@property (nonatomic, assign, readwrite) NSUInteger stablePrefixTokenCount;
+@property (nonatomic, assign, readwrite) NSUInteger cacheablePrefixTokenCount;
+@property (nonatomic, assign, readwrite) NSUInteger promptTokenCount;
+
+@property (nonatomic, strong) NSMutableArray<NSDictionary<NSString *, NSString *> *> *messages;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *messageTokenCounts; // 含角色标记
+@property (nonatomic, assign) NSUInteger historyTokenCount;
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *summaryMessage;
+@property (nonatomic, assign) NSUInteger summaryTokenCount;
+
+// 上一次请求的消息，用于计算可命中缓存的前缀
+@property (nonatomic, copy) NSArray<NSDictionary<NSString *, NSString *> *> *lastRequestMessages;
+
+@end
+
+@implementation AIUAConversationContext
+
+- (instancetype)initWithSystemPrompt:(NSString *)systemPrompt
+                      templatePrompt:(NSString *)templatePrompt
+                         tokenBudget:(NSUInteger)tokenBudget {
+    self = [super init];
+    if (self) {
+        NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+        NSMutableArray<NSString *> *parts = [NSMutableArray array];
+        for (NSString *part in @[systemPrompt ?: @"", templatePrompt ?: @""]) {
+            NSString *trimmed = [part stringByTrimmingCharactersInSet:whitespace];
+            if (trimmed.length > 0) {
+                [parts addObject:trimmed];
+            }
+        }
+        // 只拼接一次，之后每次请求直接使用同一个字符串
+        _prefix = [[parts componentsJoinedByString:@"\n\n"] copy];
+        _stablePrefixTokenCount = [[AIUATokenizer sharedTokenizer] countTokensInText:_prefix];
+        _tokenBudget = tokenBudget;
+        _compactionThreshold = kAIUAConversationDefaultCompactionThreshold;
+        _retainRatio = kAIUAConversationDefaultRetainRatio;
+        _summaryTokenLimit = kAIUAConversationDefaultSummaryTokenLimit;
+        _messages = [NSMutableArray array];
+        _messageTokenCounts = [NSMutableArray array];
+        _lastRequestMessages = @[];
+    }
+    return self;
+}
+
+- (NSUInteger)messageCount {
+    return self.messages.count;
+}
+
+#pragma mark - 历史消息
+
+- (void)appendUserMessage:(NSString *)content {
+    [self appendMessageWithRole:@"user" content:content];
+}
+
+- (void)appendAssistantMessage:(NSString *)content {
+    [self appendMessageWithRole:@"assistant" content:content];
+}
+
+- (void)appendMessageWithRole:(NSString *)role content:(NSString *)content {
+    NSString *text = [content isKindOfClass:[NSString class]] ? [content copy] : @"";
+    NSUInteger tokens = [[AIUATokenizer sharedTokenizer] countTokensInText:text] + 1;
+    [self.messages addObject:@{@"role": role, @"content": text}];
+    [self.messageTokenCounts addObject:@(tokens)];
+    self.historyTokenCount += tokens;
+}
+
+- (BOOL)removeLastUserMessage {
+    if (![self.messages.lastObject[@"role"] isEqualToString:@"user"]) {
+        return NO;
+    }
+    self.historyTokenCount -= self.messageTokenCounts.lastObject.unsignedIntegerValue;
+    [self.messages removeLastObject];
+    [self.messageTokenCounts removeLastObject];
+    return YES;
+}
+
+- (void)reset {
+    [self.messages removeAllObjects];
+    [self.messageTokenCounts removeAllObjects];
+    self.historyTokenCount = 0;
+    self.summary = nil;
+    self.summaryMessage = nil;
+    self.summaryTokenCount = 0;
+    self.lastRequestMessages = @[];
+}
+
+#pragma mark - 组装请求
+
+- (NSUInteger)fixedTokenCount {
+    return kAIUAConversationTemplateTokens + self.stablePrefixTokenCount + self.summaryTokenCount;
+}
+
+- (NSArray<NSDictionary<NSString *, NSString *> *> *)messagesForRequest {
+    if ([self fixedTokenCount] + self.historyTokenCount > self.tokenBudget * self.compactionThreshold) {
+        [self compact];
+    }
+
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *request = [NSMutableArray arrayWithCapacity:self.messages.count + 2];
+    NSMutableArray<NSNumber *> *tokenCounts = [NSMutableArray arrayWithCapacity:self.messages.count + 2];
+    if (self.prefix.length > 0) {
+        [request addObject:@{@"role": @"system", @"content": self.prefix}];
+        [tokenCounts addObject:@(self.stablePrefixTokenCount)];
+    }
+    if (self.summaryMessage) {
+        [request addObject:self.summaryMessage];
+        [tokenCounts addObject:@(self.summaryTokenCount)];
+    }
+    [request addObjectsFromArray:self.messages];
+    [tokenCounts addObjectsFromArray:self.messageTokenCounts];
+
+    // 与上一次请求逐条比较，相同的前导消息在上游可命中缓存
+    NSUInteger cacheable = 1;
+    NSUInteger total = kAIUAConversationTemplateTokens;
+    BOOL matching = YES;
+    for (NSUInteger i = 0; i < request.count; i++) {
+        NSUInteger tokens = tokenCounts[i].unsignedIntegerValue;
+        total += tokens;
+        matching = matching && i < self.lastRequestMessages.count && [self.lastRequestMessages[i] isEqualToDictionary:request[i]];
+        if (matching) {
+            cacheable += tokens;
+        }
+    }
+    self.cacheablePrefixTokenCount = self.lastRequestMessages.count > 0 ? cacheable : 0;
+    self.promptTokenCount = total;
+    self.lastRequestMessages = request;
+    return [request copy];
+}
+
+#pragma mark - 压缩
+
+- (void)compact {
+    // 保留的历史不超过 预算 × retainRatio，并为摘要预留空间
+    NSUInteger reserved = kAIUAConversationTemplateTokens + self.stablePrefixTokenCount + self.summaryTokenLimit;
+    NSUInteger target = (NSUInteger)(self.tokenBudget * self.retainRatio);
+    NSUInteger keepBudget = target > reserved ? target - reserved : 0;
+
+    NSUInteger count = self.messages.count;
+    NSUInteger cut = count;
+    NSUInteger kept = 0;
+    while (cut > 0) {
+        NSUInteger tokens = self.messageTokenCounts[cut - 1].unsignedIntegerValue;
+        // 至少保留最后一条消息
+        if (cut < count && kept + tokens > keepBudget) {
+            break;
+        }
+        kept += tokens;
+        cut--;
+    }
+    // 保留的历史从用户消息开始，不留下没有提问的回答
+    NSUInteger userCut = cut;
+    while (userCut < count && ![self.messages[userCut][@"role"] isEqualToString:@"user"]) {
+        userCut++;
+    }
+    if (userCut < count) {
+        cut = userCut;
+    }
+    if (cut == 0) {
+        return;
+    }
+
+    NSRange dropped = NSMakeRange(0, cut);
+    NSArray<NSDictionary<NSString *, NSString *> *> *droppedMessages = [self.messages subarrayWithRange:dropped];
+    NSString *summary = self.summaryBuilder ? self.summaryBuilder(self.summary, droppedMessages)
+                                            : [self defaultSummaryWithPrevious:self.summary droppedMessages:droppedMessages];
+    for (NSUInteger i = 0; i < cut; i++) {
+        self.historyTokenCount -= self.messageTokenCounts[i].unsignedIntegerValue;
+    }
+    [self.messages removeObjectsInRange:dropped];
+    [self.messageTokenCounts removeObjectsInRange:dropped];
+
+    self.summary = summary.length > 0 ? summary : nil;
+    if (self.summary) {
+        NSString *content = [kAIUAConversationSummaryHeader stringByAppendingString:self.summary];
+        self.summaryMessage = @{@"role": @"system", @"content": content};
+        self.summaryTokenCount = [[AIUATokenizer sharedTokenizer] countTokensInText:content];
+    } else {
+        self.summaryMessage = nil;
+        self.summaryTokenCount = 0;
+    }
+    self.compactionCount++;
+    NSLog(@"[Conversation] 压缩上下文：折叠 %lu 条消息，保留 %lu 条，历史 %lu token，摘要 %lu token",
+          (unsigned long)cut, (unsigned long)self.messages.count,
+          (unsigned long)self.historyTokenCount, (unsigned long)self.summaryTokenCount);
+}
+
+// 每条被折叠的消息保留开头一句，超出 summaryTokenLimit 时丢弃最早的内容
+- (NSString *)defaultSummaryWithPrevious:(NSString *)previousSummary
+                         droppedMessages:(NSArray<NSDictionary<NSString *, NSString *> *> *)droppedMessages {
+    NSMutableArray<NSString *> *lines = [NSMutableArray array];
+    if (previousSummary.length > 0) {
+        [lines addObjectsFromArray:[previousSummary componentsSeparatedByString:@"\n"]];
+    }
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    NSCharacterSet *sentenceEnds = [NSCharacterSet characterSetWithCharactersInString:@"。！？!?\n"];
+    for (NSDictionary<NSString *, NSString *> *message in droppedMessages) {
+        NSString *content = [message[@"content"] stringByTrimmingCharactersInSet:whitespace];
+        if (content.length == 0) {
+            continue;
+        }
+        NSRange end = [content rangeOfCharacterFromSet:sentenceEnds];
+        NSUInteger length = MIN(end.location == NSNotFound ? content.length : end.location + 1, kAIUAConversationSummaryLineLength);
+        NSString *line = [content substringWithRange:[content rangeOfComposedCharacterSequencesForRange:NSMakeRange(0, length)]];
+        line = [[line stringByReplacingOccurrencesOfString:@"\n" withString:@" "] stringByTrimmingCharactersInSet:whitespace];
+        if (line.length < content.length) {
+            line = [line stringByAppendingString:@"…"];
+        }
+        NSString *speaker = [message[@"role"] isEqualToString:@"assistant"] ? @"助手" : @"用户";
+        [lines addObject:[NSString stringWithFormat:@"%@：%@", speaker, line]];
+    }
+
+    AIUATokenizer *tokenizer = [AIUATokenizer sharedTokenizer];
+    NSString *summary = [lines componentsJoinedByString:@"\n"];
+    while (lines.count > 1 && [tokenizer countTokensInText:summary] > self.summaryTokenLimit) {
+        [lines removeObjectAtIndex:0];
+        summary = [lines componentsJoinedByString:@"\n"];
+    }
+    return summary;
+}
+
+@end
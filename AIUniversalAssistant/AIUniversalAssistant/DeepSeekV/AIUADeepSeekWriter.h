@@ -1,4 +1,5 @@
 #import <Foundation/Foundation.h>
+#import "AIUAConversationContext.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -13,6 +14,19 @@ typedef void(^AIUAStreamHandler)(NSString *chunk, BOOL finished, NSError * _Null
 @property (nonatomic, assign) NSTimeInterval timeoutInterval;
 /// 模型名称，默认为最新版本
 @property (nonatomic, copy) NSString *modelName;
+/// 进行中的请求数（同一写作器可同时进行多个流式请求）
+@property (nonatomic, assign, readonly) NSUInteger activeRequestCount;
+
+/// 流式请求因网络中断断开后，续传完成 / 最终失败的次数（进程内累计）
+/// 服务端支持续传时（x-aiua-resumable），断线后按指数退避携带 Last-Event-ID 重连，重放的事件按 id 去重
+@property (class, nonatomic, assign, readonly) NSUInteger recoveredStreamCount;
+@property (class, nonatomic, assign, readonly) NSUInteger failedStreamCount;
+
+/**
+ * 预连接到 AI 服务（会话由所有写作器共享），进入写作页面或开始输入时调用，缩短首个 token 的等待
+ * @param serverURL 后端代理地址，传 nil 使用默认地址
+ */
++ (void)preconnectToServerURL:(nullable NSString *)serverURL;
 
 /**
  * 使用后端代理地址初始化
@@ -90,6 +104,16 @@ typedef void(^AIUAStreamHandler)(NSString *chunk, BOOL finished, NSError * _Null
                                  wordCount:(NSInteger)wordCount
                             streamHandler:(AIUAStreamHandler)streamHandler;
 
+/**
+ * 流式写作，直接指定输出 token 上限（不追加字数要求）
+ * @param prompt 写作提示
+ * @param maxTokens 最大token数（上限 4000）
+ * @param streamHandler 流式回调
+ */
+- (void)generateFullStreamWritingWithPrompt:(NSString *)prompt
+                                 maxTokens:(NSInteger)maxTokens
+                            streamHandler:(AIUAStreamHandler)streamHandler;
+
 #pragma mark - 多轮对话
 
 /**
@@ -101,7 +125,18 @@ typedef void(^AIUAStreamHandler)(NSString *chunk, BOOL finished, NSError * _Null
                          completion:(AIUACompletionHandler)completion;
 
 /**
- * 中断当前请求
+ * 基于上下文的多轮对话：追加用户消息，按 token 预算组装请求（前缀固定，较早的轮次折叠为摘要），
+ * 成功后把回复追加到上下文
+ * @param context 对话上下文
+ * @param message 本轮用户消息
+ * @param completion 完成回调
+ */
+- (void)generateWritingWithContext:(AIUAConversationContext *)context
+                           message:(NSString *)message
+                        completion:(AIUACompletionHandler)completion;
+
+/**
+ * 中断全部进行中的请求（已中断的请求不再回调）
  */
 - (void)cancelCurrentRequest;
 
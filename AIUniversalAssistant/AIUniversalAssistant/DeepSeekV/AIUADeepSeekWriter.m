@@ -1,25 +1,11 @@
 #import "AIUADeepSeekWriter.h"
 #import "AIUAConfigID.h"
+#import "AIUASSEParser.h"
+#import "AIUAJSONDeltaExtractor.h"
+#import "AIUAHTTPSessionPool.h"
+#import "AIUATokenizer.h"
 #import <CommonCrypto/CommonDigest.h>
 
-@interface AIUADeepSeekWriter () <NSURLSessionDataDelegate, NSURLSessionStreamDelegate>
-
-@property (nonatomic, strong) NSURLSession *session;
-@property (nonatomic, strong) NSURLSession *streamSession;
-@property (nonatomic, strong) NSURLSessionDataTask *currentTask;
-@property (nonatomic, strong) NSMutableData *streamData;
-@property (nonatomic, strong) NSMutableData *streamErrorData;
-@property (nonatomic, copy) AIUAStreamHandler currentStreamHandler;
-@property (nonatomic, strong) NSMutableString *accumulatedContent;
-@property (nonatomic, assign) NSInteger currentStreamStatusCode;
-@property (nonatomic, assign) BOOL streamDidReceiveDone;
-@property (nonatomic, assign) NSUInteger streamChunkCount;
-@property (nonatomic, strong) NSDate *streamStartAt;
-
-@end
-
-@implementation AIUADeepSeekWriter
-
 #ifndef AIUA_STREAM_DEBUG_LOG
 #define AIUA_STREAM_DEBUG_LOG 1
 #endif
@@ -30,6 +16,51 @@
 #define AIUAStreamLog(fmt, ...)
 #endif
 
+// 断线续传：连续失败（未收到新事件）的最大重连次数，以及指数退避的初始间隔与上限
+static const NSUInteger kAIUAStreamMaxResumeAttempts = 5;
+static const NSTimeInterval kAIUAStreamResumeBaseDelay = 0.5;
+static const NSTimeInterval kAIUAStreamResumeMaxDelay = 8.0;
+
+static NSString * const kAIUAGenerationIDHeader = @"x-aiua-generation-id";
+static NSString * const kAIUAResumableHeader = @"x-aiua-resumable";
+// 续传凭证：只有携带创建生成时同一凭证的请求才能续传该生成（服务端只保存其哈希，不会回显）
+static NSString * const kAIUAResumeKeyHeader = @"x-aiua-resume-key";
+
+// 进程内累计：断线后续传成功 / 最终失败的流式请求数
+static NSUInteger AIUAStreamRecoveredCount = 0;
+static NSUInteger AIUAStreamFailedCount = 0;
+
+#pragma mark - 单个流式请求
+
+// 一个流式请求的接收与解析状态；同一写作器可同时进行多个流式请求，各自独立分帧
+@interface AIUADeepSeekStream : NSObject <NSURLSessionDataDelegate>
+
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *task;
+/// 首次请求（带 x-aiua-generation-id 与 x-aiua-resume-key），断线重连时在此基础上追加 Last-Event-ID
+@property (nonatomic, copy, nullable) NSURLRequest *request;
+@property (nonatomic, copy, nullable) AIUAStreamHandler streamHandler;
+/// 重连前重新生成请求（刷新签名时间戳），未设置时沿用 request
+@property (nonatomic, copy, nullable) NSURLRequest * (^resumeRequestBuilder)(NSURLRequest *request);
+/// 非 SSE 结构的 chunk 回退到通用解析时使用
+@property (nonatomic, copy) NSString * _Nullable (^fallbackContentExtractor)(NSDictionary *response);
+/// 请求结束（完成、失败或取消）后调用，由写作器移出进行中的请求
+@property (nonatomic, copy, nullable) void (^finishHandler)(AIUADeepSeekStream *stream);
+
+- (void)start;
+- (void)cancel;
+
+@end
+
+@interface AIUADeepSeekWriter ()
+
+// 进行中的流式请求与普通请求
+@property (nonatomic, strong) NSMutableArray<AIUADeepSeekStream *> *activeStreams;
+@property (nonatomic, strong) NSMutableArray<NSURLSessionDataTask *> *activeTasks;
+
+@end
+
+@implementation AIUADeepSeekWriter
+
 #pragma mark - 签名辅助
 
 - (NSError *)aiua_errorWithCode:(NSInteger)code message:(NSString *)message {
@@ -109,25 +140,38 @@
         _baseURL = serverURL.length > 0 ? [serverURL copy] : AIUA_AI_PROXY_URL;
         _timeoutInterval = 120.0; // 流式/长文生成需更长时间，与服务端 UPSTREAM_TIMEOUT_MS 协调
         _modelName = @"deepseek-chat";
-        
-        // 配置普通请求的NSURLSession
-        NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
-        config.timeoutIntervalForRequest = _timeoutInterval;
-        _session = [NSURLSession sessionWithConfiguration:config];
-        
-        // 配置流式请求的NSURLSession
-        NSURLSessionConfiguration *streamConfig = [NSURLSessionConfiguration defaultSessionConfiguration];
-        streamConfig.timeoutIntervalForRequest = _timeoutInterval;
-        _streamSession = [NSURLSession sessionWithConfiguration:streamConfig delegate:self delegateQueue:[NSOperationQueue mainQueue]];
-        
-        _streamData = [NSMutableData data];
-        _streamErrorData = [NSMutableData data];
-        _accumulatedContent = [NSMutableString string];
-        _currentStreamStatusCode = 200;
+        // 会话由 AIUAHTTPSessionPool 按服务地址共享，写作器不再各自创建（避免每个页面重新握手）
+        _activeStreams = [NSMutableArray array];
+        _activeTasks = [NSMutableArray array];
+        // 提前在后台加载词表，首次计算输出预算时即可使用精确计数
+        [AIUATokenizer sharedTokenizer];
     }
     return self;
 }
 
++ (NSUInteger)recoveredStreamCount {
+    @synchronized ([AIUADeepSeekStream class]) {
+        return AIUAStreamRecoveredCount;
+    }
+}
+
++ (NSUInteger)failedStreamCount {
+    @synchronized ([AIUADeepSeekStream class]) {
+        return AIUAStreamFailedCount;
+    }
+}
+
++ (void)preconnectToServerURL:(NSString *)serverURL {
+    NSURL *url = [NSURL URLWithString:serverURL.length > 0 ? serverURL : AIUA_AI_PROXY_URL];
+    [[AIUAHTTPSessionPool sharedPool] preconnectToURL:url];
+}
+
+- (NSUInteger)activeRequestCount {
+    @synchronized (self) {
+        return self.activeStreams.count + self.activeTasks.count;
+    }
+}
+
 #pragma mark - 公开方法 - 基础写作
 
 - (void)generateWritingWithPrompt:(NSString *)prompt
@@ -190,9 +234,8 @@
 }
 
 - (NSInteger)estimatedTokensForWordCount:(NSInteger)wordCount {
-    // 中英文混合情况下，大致估算：1个token ≈ 0.75个英文单词 ≈ 1-2个中文字符
-    // 这里采用保守估计：1个中文字符 ≈ 1.5个token
-    return (NSInteger)(wordCount * 1.5) + 50; // 增加50个token作为缓冲
+    // 按本地分词器校准的 token/字 比例换算（生成内容越多越准确），并留出超写余量
+    return [[AIUATokenizer sharedTokenizer] outputTokenBudgetForWordCount:wordCount];
 }
 
 #pragma mark - 公开方法 - 流式处理
@@ -221,6 +264,23 @@
                               streamHandler:streamHandler];
 }
 
+- (void)generateFullStreamWritingWithPrompt:(NSString *)prompt
+                                 maxTokens:(NSInteger)maxTokens
+                            streamHandler:(AIUAStreamHandler)streamHandler {
+    NSString *finalPrompt = [self normalizedPrompt:prompt];
+    if (finalPrompt.length == 0) {
+        if (streamHandler) {
+            streamHandler(@"", YES, [self aiua_errorWithCode:-1001 message:@"写作提示不能为空"]);
+        }
+        return;
+    }
+    
+    [self performFullStreamRequestWithPrompt:finalPrompt
+                                   maxTokens:maxTokens
+                                 temperature:1.5
+                              streamHandler:streamHandler];
+}
+
 #pragma mark - 多轮对话
 
 - (void)generateWritingWithMessages:(NSArray<NSDictionary<NSString *, NSString *> *> *)messages
@@ -232,10 +292,55 @@
                            completion:completion];
 }
 
+- (void)generateWritingWithContext:(AIUAConversationContext *)context
+                           message:(NSString *)message
+                        completion:(AIUACompletionHandler)completion {
+    NSString *safeMessage = [self normalizedPrompt:message];
+    if (safeMessage.length == 0) {
+        if (completion) {
+            completion(nil, [self aiua_errorWithCode:-1001 message:@"写作提示不能为空"]);
+        }
+        return;
+    }
+
+    [context appendUserMessage:safeMessage];
+    NSArray<NSDictionary<NSString *, NSString *> *> *messages = [context messagesForRequest];
+    NSLog(@"[Conversation] 请求 messages=%lu promptTokens=%lu cacheablePrefix=%lu",
+          (unsigned long)messages.count,
+          (unsigned long)context.promptTokenCount,
+          (unsigned long)context.cacheablePrefixTokenCount);
+    [self generateWritingWithMessages:messages
+                            maxTokens:1000
+                          temperature:1.5
+                           completion:^(NSString * _Nullable response, NSError * _Nullable error) {
+        if (!error && response.length > 0) {
+            [context appendAssistantMessage:response];
+        } else {
+            // 失败或回复为空：撤回本轮提问，重试时重新追加
+            [context removeLastUserMessage];
+        }
+        if (completion) {
+            completion(response, error);
+        }
+    }];
+}
+
 - (void)cancelCurrentRequest {
-    [self.currentTask cancel];
-    self.currentTask = nil;
-    [self resetStreamState];
+    NSArray<AIUADeepSeekStream *> *streams = nil;
+    NSArray<NSURLSessionDataTask *> *tasks = nil;
+    @synchronized (self) {
+        streams = [self.activeStreams copy];
+        tasks = [self.activeTasks copy];
+        [self.activeStreams removeAllObjects];
+        [self.activeTasks removeAllObjects];
+    }
+    // 取消后不再回调（与之前只保留一个请求时的行为一致）
+    for (AIUADeepSeekStream *stream in streams) {
+        [stream cancel];
+    }
+    for (NSURLSessionDataTask *task in tasks) {
+        [task cancel];
+    }
 }
 
 #pragma mark - 私有方法 - 字数处理
@@ -315,7 +420,8 @@
     [self appendSecurityHeadersToRequest:request];
     
     NSError *jsonError;
-    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:body options:0 error:&jsonError];
+    // 键按字母排序，相同的消息前缀序列化后逐字节相同
+    NSData *jsonData = [NSJSONSerialization dataWithJSONObject:body options:NSJSONWritingSortedKeys error:&jsonError];
     if (jsonError) {
         if (completion) completion(nil, jsonError);
         if (streamHandler) streamHandler(@"", YES, jsonError);
@@ -323,14 +429,8 @@
     }
     request.HTTPBody = jsonData;
     
-    [self cancelCurrentRequest];
-    
     if (stream) {
-        self.currentStreamHandler = streamHandler;
-        [self resetStreamState];
-        
-        self.currentTask = [self.streamSession dataTaskWithRequest:request];
-        [self.currentTask resume];
+        [self startStreamWithRequest:request streamHandler:streamHandler];
     } else {
         [self performStandardRequest:request completion:completion];
     }
@@ -371,134 +471,526 @@
     }
     request.HTTPBody = jsonData;
     
-    [self cancelCurrentRequest];
-    
-    self.currentStreamHandler = streamHandler;
-    [self resetStreamState];
-    self.streamStartAt = [NSDate date];
     AIUAStreamLog(@"start request. timeout=%.1fs, maxTokens=%ld, promptLen=%ld",
                   self.timeoutInterval, (long)maxTokens, (long)prompt.length);
+    [self startStreamWithRequest:request streamHandler:streamHandler];
+}
+
+- (void)startStreamWithRequest:(NSURLRequest *)request streamHandler:(AIUAStreamHandler)streamHandler {
+    AIUADeepSeekStream *stream = [[AIUADeepSeekStream alloc] init];
+    stream.streamHandler = streamHandler;
+    // 生成 id 供服务端识别同一次生成，断线重连时从重放缓冲续传
+    NSMutableURLRequest *streamRequest = [request mutableCopy];
+    [streamRequest setValue:[NSUUID UUID].UUIDString forHTTPHeaderField:kAIUAGenerationIDHeader];
+    [streamRequest setValue:[NSUUID UUID].UUIDString forHTTPHeaderField:kAIUAResumeKeyHeader];
+    stream.request = streamRequest;
+    __weak typeof(self) weakSelf = self;
+    stream.resumeRequestBuilder = ^NSURLRequest *(NSURLRequest *originalRequest) {
+        NSMutableURLRequest *resumeRequest = [originalRequest mutableCopy];
+        [weakSelf appendSecurityHeadersToRequest:resumeRequest];
+        return resumeRequest;
+    };
+    stream.fallbackContentExtractor = ^NSString *(NSDictionary *response) {
+        return [weakSelf extractContentFromResponse:response];
+    };
+    stream.finishHandler = ^(AIUADeepSeekStream *finishedStream) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        @synchronized (strongSelf) {
+            [strongSelf.activeStreams removeObjectIdenticalTo:finishedStream];
+        }
+    };
+    @synchronized (self) {
+        [self.activeStreams addObject:stream];
+    }
+    [stream start];
+}
+
+#pragma mark - 标准请求处理
+
+- (void)performStandardRequest:(NSURLRequest *)request
+                    completion:(AIUACompletionHandler)completion {
+    
+    __weak typeof(self) weakSelf = self;
+    __block NSURLSessionDataTask *task = nil;
+    task = [[[AIUAHTTPSessionPool sharedPool] sessionForURL:request.URL] dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        BOOL active = NO;
+        @synchronized (strongSelf) {
+            active = [strongSelf.activeTasks containsObject:task];
+            [strongSelf.activeTasks removeObjectIdenticalTo:task];
+        }
+        // 已取消的请求不再回调
+        if (!active) {
+            return;
+        }
+        
+        if (error) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(nil, error);
+            });
+            return;
+        }
+        
+        NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+        if (httpResponse.statusCode != 200) {
+            NSError *statusError = [NSError errorWithDomain:@"AIUADeepSeekWriter"
+                                                       code:httpResponse.statusCode
+                                                   userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"HTTP错误: %ld", (long)httpResponse.statusCode]}];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(nil, statusError);
+            });
+            return;
+        }
+        
+        NSError *parseError;
+        NSDictionary *responseDict = [NSJSONSerialization JSONObjectWithData:data options:0 error:&parseError];
+        
+        if (parseError) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(nil, parseError);
+            });
+            return;
+        }
+        
+        NSString *content = [strongSelf extractContentFromResponse:responseDict];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(content, nil);
+        });
+    }];
     
-    self.currentTask = [self.streamSession dataTaskWithRequest:request];
-    [self.currentTask resume];
+    @synchronized (self) {
+        [self.activeTasks addObject:task];
+    }
+    [task resume];
 }
 
-- (void)resetStreamState {
-    [self.streamData setLength:0];
-    [self.streamErrorData setLength:0];
-    [self.accumulatedContent setString:@""];
-    self.currentStreamStatusCode = 200;
-    self.streamDidReceiveDone = NO;
-    self.streamChunkCount = 0;
-    self.streamStartAt = nil;
+- (NSString *)extractContentFromResponse:(NSDictionary *)response {
+    NSArray *choices = response[@"choices"];
+    if (choices && [choices isKindOfClass:[NSArray class]] && choices.count > 0) {
+        NSDictionary *firstChoice = choices[0];
+        NSDictionary *message = firstChoice[@"message"];
+        if (message && [message isKindOfClass:[NSDictionary class]]) {
+            return message[@"content"];
+        }
+        
+        NSDictionary *delta = firstChoice[@"delta"];
+        if (delta && [delta isKindOfClass:[NSDictionary class]]) {
+            return delta[@"content"];
+        }
+    }
+    return nil;
 }
 
-#pragma mark - NSURLSessionDataDelegate (流式处理)
+#pragma mark - 析构
+
+- (void)dealloc {
+    [self cancelCurrentRequest];
+}
+
+@end
+
+#pragma mark - AIUADeepSeekStream
+
+@interface AIUADeepSeekStream ()
+
+@property (nonatomic, strong) NSMutableData *streamData;
+@property (nonatomic, strong) NSMutableData *streamErrorData;
+@property (nonatomic, strong) NSMutableString *accumulatedContent;
+@property (nonatomic, assign) NSInteger statusCode;
+@property (nonatomic, assign) BOOL didReceiveDone;
+@property (nonatomic, assign) NSUInteger chunkCount;
+@property (nonatomic, strong, nullable) NSDate *startAt;
+@property (nonatomic, assign) NSTimeInterval timeToFirstChunk;
+@property (nonatomic, assign) BOOL finished;
+
+// 断线续传状态
+@property (nonatomic, assign) BOOL receivedResponse;        // 当前连接已收到响应头
+@property (nonatomic, assign) BOOL resumable;               // 服务端支持续传（x-aiua-resumable）
+@property (nonatomic, assign) long long lastEventID;        // 已处理的最后一个事件 id，重放的事件据此去重
+@property (nonatomic, assign) NSUInteger resumeCount;
+@property (nonatomic, assign) NSUInteger consecutiveResumeFailures;
+@property (nonatomic, assign) BOOL interrupted;             // 曾因网络中断而断开
+
+@end
+
+@implementation AIUADeepSeekStream {
+    // SSE 分帧状态（增量解析 streamData，只扫描新到达的字节）
+    AIUASSEParser _sseParser;
+    // chunk JSON 快速提取（只取 content，不构建对象树）
+    AIUAJSONDeltaExtractor _deltaExtractor;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _streamData = [NSMutableData data];
+        _streamErrorData = [NSMutableData data];
+        _accumulatedContent = [NSMutableString string];
+        _statusCode = 200;
+        AIUASSEParserInit(&_sseParser);
+        AIUAJSONDeltaExtractorInit(&_deltaExtractor);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AIUASSEParserDestroy(&_sseParser);
+    AIUAJSONDeltaExtractorDestroy(&_deltaExtractor);
+}
+
+- (void)start {
+    self.startAt = [NSDate date];
+    [self startTaskWithRequest:self.request];
+}
+
+- (void)startTaskWithRequest:(NSURLRequest *)request {
+    self.receivedResponse = NO;
+    self.statusCode = 200;
+    self.task = [[AIUAHTTPSessionPool sharedPool] dataTaskWithRequest:request delegate:self];
+    [self.task resume];
+}
+
+- (void)cancel {
+    // 先清空回调，取消后残留的数据与完成回调都不再分发
+    self.streamHandler = nil;
+    [self.task cancel];
+    [self finish];
+}
+
+- (void)finish {
+    if (self.finished) {
+        return;
+    }
+    self.finished = YES;
+    void (^finishHandler)(AIUADeepSeekStream *) = self.finishHandler;
+    self.finishHandler = nil;
+    if (finishHandler) {
+        finishHandler(self);
+    }
+}
+
+#pragma mark - NSURLSessionDataDelegate
 
 - (void)URLSession:(NSURLSession *)session
           dataTask:(NSURLSessionDataTask *)dataTask
 didReceiveResponse:(NSURLResponse *)response
  completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    if (!self.streamHandler) {
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    self.receivedResponse = YES;
     if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
         NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
-        self.currentStreamStatusCode = httpResponse.statusCode;
+        self.statusCode = httpResponse.statusCode;
+        if (httpResponse.statusCode == 200) {
+            self.resumable = [[httpResponse valueForHTTPHeaderField:kAIUAResumableHeader] isEqualToString:@"1"];
+        }
     } else {
-        self.currentStreamStatusCode = 200;
+        self.statusCode = 200;
     }
-    AIUAStreamLog(@"didReceiveResponse status=%ld", (long)self.currentStreamStatusCode);
+    AIUAStreamLog(@"task=%lu didReceiveResponse status=%ld", (unsigned long)dataTask.taskIdentifier, (long)self.statusCode);
     completionHandler(NSURLSessionResponseAllow);
 }
 
 - (void)URLSession:(NSURLSession *)session 
           dataTask:(NSURLSessionDataTask *)dataTask 
     didReceiveData:(NSData *)data {
+    // 已取消的请求可能还有残留回调，忽略
+    if (!self.streamHandler) {
+        return;
+    }
+    
     // 非 200 响应按普通文本缓存，待完成时统一转错误回调
-    if (self.currentStreamStatusCode != 200) {
+    if (self.statusCode != 200) {
         [self.streamErrorData appendData:data];
         AIUAStreamLog(@"non-200 body chunk bytes=%lu", (unsigned long)data.length);
         return;
     }
     
+    // 按字节累积并增量分帧：不再整体解码为 NSString，避免 O(n²) 开销和 UTF-8 多字节字符被拆包时解码失败
     [self.streamData appendData:data];
+    [self drainStreamDataFinished:NO];
+}
+
+static bool AIUADeepSeekStreamSSEEventCallback(const AIUASSEEvent *event, void *context) {
+    AIUADeepSeekStream *stream = (__bridge AIUADeepSeekStream *)context;
+    return [stream handleSSEEvent:event];
+}
+
+// 解析 streamData 中已完整到达的 SSE 事件，并丢弃已消费的前缀
+- (void)drainStreamDataFinished:(BOOL)finished {
+    const uint8_t *bytes = (const uint8_t *)self.streamData.bytes;
+    NSUInteger length = self.streamData.length;
+    if (finished) {
+        AIUASSEParserFinish(&_sseParser, bytes, length, AIUADeepSeekStreamSSEEventCallback, (__bridge void *)self);
+        if (_sseParser.failed) {
+            [self failWithParserError];
+        }
+        return;
+    }
     
-    NSString *dataString = [[NSString alloc] initWithData:self.streamData encoding:NSUTF8StringEncoding];
-    NSArray *lines = [dataString componentsSeparatedByString:@"\n"];
-    
-    // 处理完整的行，保留不完整的行在buffer中
-    NSMutableString *remainingData = [NSMutableString string];
-    BOOL hasIncompleteLine = NO;
-    
-    for (NSString *line in lines) {
-        if ([line hasPrefix:@"data: "]) {
-            if ([line isEqualToString:@"data: [DONE]"]) {
-                // 标记收到 DONE，由 didCompleteWithError 统一收尾，避免重复回调和状态被提前清空
-                self.streamDidReceiveDone = YES;
-                AIUAStreamLog(@"received [DONE], accumulatedLen=%lu, chunkCount=%lu",
-                              (unsigned long)self.accumulatedContent.length,
-                              (unsigned long)self.streamChunkCount);
-                continue;
-            } else {
-                NSString *jsonStr = [line substringFromIndex:6];
-                if (jsonStr.length > 0) {
-                    [self processStreamJSON:jsonStr];
-                }
+    size_t consumed = AIUASSEParserFeed(&_sseParser, bytes, length, AIUADeepSeekStreamSSEEventCallback, (__bridge void *)self);
+    // 回调中可能取消了请求，此时不再操作缓冲区
+    if (!self.streamHandler) {
+        return;
+    }
+    if (_sseParser.failed) {
+        [self failWithParserError];
+        return;
+    }
+    if (consumed > 0 && consumed <= self.streamData.length) {
+        [self.streamData replaceBytesInRange:NSMakeRange(0, consumed) withBytes:NULL length:0];
+        AIUASSEParserDidDiscard(&_sseParser, consumed);
+    }
+}
+
+// 多行 data 暂存区分配失败，事件已不完整，按错误结束本次流
+- (void)failWithParserError {
+    AIUAStreamHandler streamHandler = self.streamHandler;
+    self.streamHandler = nil;
+    [self.task cancel];
+    [self finish];
+    AIUAStreamLog(@"task=%lu sse parser failed (out of memory)", (unsigned long)self.task.taskIdentifier);
+    if (streamHandler) {
+        NSError *error = [NSError errorWithDomain:@"AIUADeepSeekWriter"
+                                             code:-1
+                                         userInfo:@{NSLocalizedDescriptionKey: @"流式数据解析失败，请稍后重试"}];
+        streamHandler(@"", YES, error);
+    }
+}
+
+- (BOOL)handleSSEEvent:(const AIUASSEEvent *)event {
+    // 续传时服务端从 Last-Event-ID 之后重放，已处理过的事件跳过
+    if (event->eventID && event->eventIDLength > 0 && event->eventIDLength < 32) {
+        char idBuffer[32];
+        memcpy(idBuffer, event->eventID, event->eventIDLength);
+        idBuffer[event->eventIDLength] = '\0';
+        char *end = NULL;
+        long long eventID = strtoll(idBuffer, &end, 10);
+        if (end && *end == '\0') {
+            if (eventID <= self.lastEventID) {
+                return YES;
             }
-        } else if (line.length > 0) {
-            // 不完整的行，保留到下一次处理
-            if (remainingData.length > 0) [remainingData appendString:@"\n"];
-            [remainingData appendString:line];
-            hasIncompleteLine = YES;
+            self.lastEventID = eventID;
+            self.consecutiveResumeFailures = 0;
         }
     }
+    if (AIUASSEEventDataEquals(event, "[DONE]")) {
+        // 标记收到 DONE，由 didCompleteWithError 统一收尾，避免重复回调和状态被提前清空
+        self.didReceiveDone = YES;
+        AIUAStreamLog(@"received [DONE], accumulatedLen=%lu, chunkCount=%lu",
+                      (unsigned long)self.accumulatedContent.length,
+                      (unsigned long)self.chunkCount);
+        return YES;
+    }
+    if (event->dataLength == 0) {
+        return YES;
+    }
     
-    if (hasIncompleteLine) {
-        self.streamData = [remainingData dataUsingEncoding:NSUTF8StringEncoding].mutableCopy;
-    } else {
-        [self.streamData setLength:0];
+    [self processStreamJSONBytes:event->data length:event->dataLength];
+    // 上层回调中取消了请求时停止继续分发
+    return self.streamHandler != nil;
+}
+
+- (void)processStreamJSONBytes:(const uint8_t *)bytes length:(size_t)length {
+    // 快速路径：直接定位 choices[0].delta.content，省去每个 chunk 的 NSDictionary 对象树
+    AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorExtract(&_deltaExtractor, bytes, length);
+    if (result == AIUAJSONDeltaResultNoContent) {
+        return;
     }
+    if (result == AIUAJSONDeltaResultContent) {
+        NSString *chunkContent = [[NSString alloc] initWithBytes:_deltaExtractor.content
+                                                          length:_deltaExtractor.contentLength
+                                                        encoding:NSUTF8StringEncoding];
+        if (chunkContent) {
+            [self appendStreamChunk:chunkContent];
+            return;
+        }
+    }
+    
+    // 非预期结构回退到通用解析（事件数据直接引用缓冲区字节，不做拷贝）
+    NSData *jsonData = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+    [self processStreamJSONData:jsonData];
 }
 
-- (void)processStreamJSON:(NSString *)jsonStr {
-    NSData *jsonData = [jsonStr dataUsingEncoding:NSUTF8StringEncoding];
+- (void)processStreamJSONData:(NSData *)jsonData {
     NSError *jsonError;
     NSDictionary *chunkDict = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&jsonError];
     
     if (!jsonError) {
-        NSString *chunkContent = [self extractContentFromResponse:chunkDict];
-        if (chunkContent && chunkContent.length > 0) {
-            self.streamChunkCount += 1;
-            [self.accumulatedContent appendString:chunkContent];
-            AIUAStreamLog(@"chunk #%lu len=%lu totalLen=%lu",
-                          (unsigned long)self.streamChunkCount,
-                          (unsigned long)chunkContent.length,
-                          (unsigned long)self.accumulatedContent.length);
-            if (self.currentStreamHandler) {
-                self.currentStreamHandler(chunkContent, NO, nil);
-            }
+        NSString *chunkContent = self.fallbackContentExtractor ? self.fallbackContentExtractor(chunkDict) : nil;
+        if ([chunkContent isKindOfClass:[NSString class]]) {
+            [self appendStreamChunk:chunkContent];
         }
     } else {
         AIUAStreamLog(@"chunk json parse failed: %@", jsonError.localizedDescription);
     }
 }
 
+- (void)appendStreamChunk:(NSString *)chunkContent {
+    if (chunkContent.length == 0) {
+        return;
+    }
+    self.chunkCount += 1;
+    if (self.chunkCount == 1 && self.startAt) {
+        // 首 token 耗时，与 [HTTPPool] 日志中的建连/首字节耗时对照
+        self.timeToFirstChunk = [[NSDate date] timeIntervalSinceDate:self.startAt];
+        AIUAStreamLog(@"task=%lu first chunk after %.0fms", (unsigned long)self.task.taskIdentifier, self.timeToFirstChunk * 1000.0);
+    }
+    [self.accumulatedContent appendString:chunkContent];
+    AIUAStreamLog(@"chunk #%lu len=%lu totalLen=%lu",
+                  (unsigned long)self.chunkCount,
+                  (unsigned long)chunkContent.length,
+                  (unsigned long)self.accumulatedContent.length);
+    if (self.streamHandler) {
+        self.streamHandler(chunkContent, NO, nil);
+    }
+}
+
+#pragma mark - 断线续传
+
++ (BOOL)isTransientNetworkError:(NSError *)error {
+    if (![error.domain isEqualToString:NSURLErrorDomain]) {
+        return NO;
+    }
+    switch (error.code) {
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorTimedOut:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorDNSLookupFailed:
+        case NSURLErrorDataNotAllowed:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+// 只在服务端支持续传时重连；尚未收到响应头时服务端按生成 id 去重，重试也不会重复生成
+- (BOOL)shouldResumeAfterError:(NSError *)error {
+    if (!error || self.didReceiveDone || self.statusCode != 200) {
+        return NO;
+    }
+    if (![AIUADeepSeekStream isTransientNetworkError:error]) {
+        return NO;
+    }
+    self.interrupted = YES;
+    if (!self.resumable && self.receivedResponse) {
+        return NO;
+    }
+    return self.consecutiveResumeFailures < kAIUAStreamMaxResumeAttempts;
+}
+
+- (void)scheduleResume {
+    self.consecutiveResumeFailures += 1;
+    // 指数退避，优先使用服务端下发的 retry 作为初始间隔，加 ±20% 抖动避免同时重连
+    NSTimeInterval base = _sseParser.retryMilliseconds > 0 ? _sseParser.retryMilliseconds / 1000.0 : kAIUAStreamResumeBaseDelay;
+    NSTimeInterval delay = MIN(base * pow(2, self.consecutiveResumeFailures - 1), kAIUAStreamResumeMaxDelay);
+    delay *= 0.8 + 0.4 * arc4random_uniform(1001) / 1000.0;
+    AIUAStreamLog(@"connection lost, resume #%lu after %.2fs lastEventID=%lld",
+                  (unsigned long)(self.resumeCount + 1), delay, self.lastEventID);
+
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        // 等待期间被取消
+        if (!strongSelf || !strongSelf.streamHandler) {
+            return;
+        }
+        [strongSelf resumeStream];
+    });
+}
+
+- (void)resumeStream {
+    self.resumeCount += 1;
+    // 丢弃断开时残留的半个事件，重放会从最后一个完整事件之后开始
+    [self.streamData setLength:0];
+    [self.streamErrorData setLength:0];
+    AIUASSEParserReset(&_sseParser, true);
+
+    NSURLRequest *baseRequest = self.resumeRequestBuilder ? self.resumeRequestBuilder(self.request) : self.request;
+    NSMutableURLRequest *request = [baseRequest mutableCopy];
+    if (self.lastEventID > 0) {
+        [request setValue:[NSString stringWithFormat:@"%lld", self.lastEventID] forHTTPHeaderField:@"Last-Event-ID"];
+    }
+    [self startTaskWithRequest:request];
+}
+
+- (void)recordInterruptionOutcome:(BOOL)recovered {
+    if (!self.interrupted) {
+        return;
+    }
+    NSUInteger recoveredCount = 0;
+    NSUInteger failedCount = 0;
+    @synchronized ([AIUADeepSeekStream class]) {
+        if (recovered) {
+            AIUAStreamRecoveredCount += 1;
+        } else {
+            AIUAStreamFailedCount += 1;
+        }
+        recoveredCount = AIUAStreamRecoveredCount;
+        failedCount = AIUAStreamFailedCount;
+    }
+    AIUAStreamLog(@"interrupted stream %@ after %lu resumes (recovered=%lu failed=%lu)",
+                  recovered ? @"recovered" : @"failed",
+                  (unsigned long)self.resumeCount,
+                  (unsigned long)recoveredCount,
+                  (unsigned long)failedCount);
+}
+
 - (void)URLSession:(NSURLSession *)session 
               task:(NSURLSessionTask *)task 
 didCompleteWithError:(NSError *)error {
-    NSTimeInterval elapsed = self.streamStartAt ? [[NSDate date] timeIntervalSinceDate:self.streamStartAt] : 0;
-    AIUAStreamLog(@"didComplete error=%@ status=%ld done=%d chunkCount=%lu totalLen=%lu elapsed=%.2fs",
+    // 断线重连后，旧连接的回调不再处理
+    if (task != self.task) {
+        return;
+    }
+    // 已取消的请求仍会回调（NSURLErrorCancelled），忽略
+    AIUAStreamHandler streamHandler = self.streamHandler;
+    if (!streamHandler) {
+        [self finish];
+        return;
+    }
+    
+    if ([self shouldResumeAfterError:error]) {
+        [self scheduleResume];
+        return;
+    }
+    
+    // 正常结束时处理缓冲区中最后一个未以空行结尾的事件
+    if (!error && self.statusCode == 200 && self.streamData.length > 0) {
+        [self drainStreamDataFinished:YES];
+        // 最后一个事件的回调中可能取消了请求
+        if (!self.streamHandler) {
+            [self finish];
+            return;
+        }
+    }
+    self.streamHandler = nil;
+    [self finish];
+    
+    NSTimeInterval elapsed = self.startAt ? [[NSDate date] timeIntervalSinceDate:self.startAt] : 0;
+    AIUAStreamLog(@"task=%lu didComplete error=%@ status=%ld done=%d chunkCount=%lu totalLen=%lu ttft=%.2fs elapsed=%.2fs fastPath=%llu fallback=%llu",
+                  (unsigned long)task.taskIdentifier,
                   error.localizedDescription ?: @"nil",
-                  (long)self.currentStreamStatusCode,
-                  self.streamDidReceiveDone,
-                  (unsigned long)self.streamChunkCount,
+                  (long)self.statusCode,
+                  self.didReceiveDone,
+                  (unsigned long)self.chunkCount,
                   (unsigned long)self.accumulatedContent.length,
-                  elapsed);
+                  self.timeToFirstChunk,
+                  elapsed,
+                  (unsigned long long)_deltaExtractor.totalFastPathHits,
+                  (unsigned long long)_deltaExtractor.totalFallbacks);
+    
+    BOOL succeeded = !error && self.statusCode == 200 && self.accumulatedContent.length > 0;
+    [self recordInterruptionOutcome:succeeded];
     
     if (error) {
-        if (self.currentStreamHandler) {
-            self.currentStreamHandler(@"", YES, error);
-        }
-    } else if (self.currentStreamStatusCode != 200) {
-        NSString *errorMessage = [NSString stringWithFormat:@"HTTP错误: %ld", (long)self.currentStreamStatusCode];
+        streamHandler(@"", YES, error);
+    } else if (self.statusCode != 200) {
+        NSString *errorMessage = [NSString stringWithFormat:@"HTTP错误: %ld", (long)self.statusCode];
         if (self.streamErrorData.length > 0) {
             NSDictionary *errorDict = [NSJSONSerialization JSONObjectWithData:self.streamErrorData options:0 error:nil];
             if ([errorDict isKindOfClass:[NSDictionary class]]) {
@@ -512,102 +1004,30 @@ didCompleteWithError:(NSError *)error {
             } else {
                 NSString *raw = [[NSString alloc] initWithData:self.streamErrorData encoding:NSUTF8StringEncoding];
                 if (raw.length > 0) {
-                    errorMessage = [NSString stringWithFormat:@"HTTP错误: %ld - %@", (long)self.currentStreamStatusCode, raw];
+                    errorMessage = [NSString stringWithFormat:@"HTTP错误: %ld - %@", (long)self.statusCode, raw];
                 }
             }
         }
         
         NSError *statusError = [NSError errorWithDomain:@"AIUADeepSeekWriter"
-                                                   code:self.currentStreamStatusCode
+                                                   code:self.statusCode
                                                userInfo:@{NSLocalizedDescriptionKey: errorMessage}];
-        if (self.currentStreamHandler) {
-            self.currentStreamHandler(@"", YES, statusError);
-        }
-    } else {
+        streamHandler(@"", YES, statusError);
+    } else if (self.accumulatedContent.length > 0) {
         // 正常完成，发送最终内容
-        if (self.currentStreamHandler) {
-            if (self.accumulatedContent.length > 0) {
-                self.currentStreamHandler(self.accumulatedContent, YES, nil);
-            } else {
-                NSString *debugDetail = [NSString stringWithFormat:@"(status=%ld, done=%@, chunks=%lu)",
-                                         (long)self.currentStreamStatusCode,
-                                         self.streamDidReceiveDone ? @"YES" : @"NO",
-                                         (unsigned long)self.streamChunkCount];
-                NSError *emptyError = [NSError errorWithDomain:@"AIUADeepSeekWriter"
-                                                          code:-1
-                                                      userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"流式响应为空，可能是响应超时或服务暂时无返回，请稍后重试 %@", debugDetail]}];
-                self.currentStreamHandler(@"", YES, emptyError);
-            }
-        }
-    }
-    [self resetStreamState];
-}
-
-#pragma mark - 标准请求处理
-
-- (void)performStandardRequest:(NSURLRequest *)request
-                    completion:(AIUACompletionHandler)completion {
-    
-    self.currentTask = [self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-        
-        if (error) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                completion(nil, error);
-            });
-            return;
-        }
-        
-        NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
-        if (httpResponse.statusCode != 200) {
-            NSError *statusError = [NSError errorWithDomain:@"AIUADeepSeekWriter"
-                                                       code:httpResponse.statusCode
-                                                   userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"HTTP错误: %ld", (long)httpResponse.statusCode]}];
-            dispatch_async(dispatch_get_main_queue(), ^{
-                completion(nil, statusError);
-            });
-            return;
-        }
-        
-        NSError *parseError;
-        NSDictionary *responseDict = [NSJSONSerialization JSONObjectWithData:data options:0 error:&parseError];
-        
-        if (parseError) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                completion(nil, parseError);
-            });
-            return;
-        }
-        
-        NSString *content = [self extractContentFromResponse:responseDict];
-        dispatch_async(dispatch_get_main_queue(), ^{
-            completion(content, nil);
-        });
-    }];
-    
-    [self.currentTask resume];
-}
-
-- (NSString *)extractContentFromResponse:(NSDictionary *)response {
-    NSArray *choices = response[@"choices"];
-    if (choices && [choices isKindOfClass:[NSArray class]] && choices.count > 0) {
-        NSDictionary *firstChoice = choices[0];
-        NSDictionary *message = firstChoice[@"message"];
-        if (message && [message isKindOfClass:[NSDictionary class]]) {
-            return message[@"content"];
-        }
-        
-        NSDictionary *delta = firstChoice[@"delta"];
-        if (delta && [delta isKindOfClass:[NSDictionary class]]) {
-            return delta[@"content"];
-        }
+        NSString *content = [self.accumulatedContent copy];
+        [[AIUATokenizer sharedTokenizer] recordGeneratedText:content];
+        streamHandler(content, YES, nil);
+    } else {
+        NSString *debugDetail = [NSString stringWithFormat:@"(status=%ld, done=%@, chunks=%lu)",
+                                 (long)self.statusCode,
+                                 self.didReceiveDone ? @"YES" : @"NO",
+                                 (unsigned long)self.chunkCount];
+        NSError *emptyError = [NSError errorWithDomain:@"AIUADeepSeekWriter"
+                                                  code:-1
+                                              userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"流式响应为空，可能是响应超时或服务暂时无返回，请稍后重试 %@", debugDetail]}];
+        streamHandler(@"", YES, emptyError);
     }
-    return nil;
-}
-
-#pragma mark - 析构
-
-- (void)dealloc {
-    [self cancelCurrentRequest];
 }
 
 @end
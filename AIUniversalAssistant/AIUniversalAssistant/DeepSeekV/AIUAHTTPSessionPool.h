@@ -0,0 +1,37 @@
+//
+//  AIUAHTTPSessionPool.h
+//  AIUniversalAssistant
+//
+//  进程内共享的 HTTP 会话池：按服务地址（scheme://host:port）共享 NSURLSession，复用 TCP/TLS/HTTP2 连接
+//  - 所有 AIUADeepSeekWriter 共用会话，新页面的第一个请求不必重新握手
+//  - 进入写作页面、聚焦输入框时可预连接，首个 token 不再等待建连
+//  - 流式任务的回调按 task 分发给各自的代理，同一会话可同时进行多个流式请求；回调在主线程
+//  - 记录每个请求的 DNS、建连、TLS 与首字节耗时（日志 [HTTPPool]），与写作器记录的首 token 耗时对照
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAHTTPSessionPool : NSObject
+
++ (instancetype)sharedPool;
+
+/// url 所在服务的共享会话（普通请求使用 completionHandler 方式创建任务）
+- (NSURLSession *)sessionForURL:(NSURL *)url;
+
+/**
+ * 创建流式任务（未 resume），数据回调转发给 delegate，任务结束后释放 delegate
+ */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     delegate:(id<NSURLSessionDataDelegate>)delegate;
+
+/**
+ * 预连接：向服务根路径发送 HEAD 请求，提前完成 DNS/TCP/TLS，连接留在会话中供后续请求复用
+ * 短时间内重复调用会被忽略
+ */
+- (void)preconnectToURL:(NSURL *)url;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,178 @@
+//
+//  AIUAHTTPSessionPool.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAHTTPSessionPool.h"
+
+// 与写作器的请求超时一致，流式/长文生成需要较长时间
+static const NSTimeInterval kAIUAHTTPSessionRequestTimeout = 120.0;
+// 预连接请求超时
+static const NSTimeInterval kAIUAHTTPPreconnectTimeout = 10.0;
+// 距上次预连接不足该间隔时不再预连接（空闲连接通常保持数十秒）
+static const NSTimeInterval kAIUAHTTPPreconnectInterval = 30.0;
+
+static NSString * const kAIUAHTTPPreconnectTaskDescription = @"preconnect";
+
+@interface AIUAHTTPSessionPool () <NSURLSessionDataDelegate>
+
+// 以下在 @synchronized (self) 内访问
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSURLSession *> *sessionsByOrigin;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDate *> *lastPreconnectByOrigin;
+@property (nonatomic, strong) NSMapTable<NSURLSessionTask *, id<NSURLSessionDataDelegate>> *delegatesByTask;
+
+@end
+
+@implementation AIUAHTTPSessionPool
+
++ (instancetype)sharedPool {
+    static AIUAHTTPSessionPool *sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _sessionsByOrigin = [NSMutableDictionary dictionary];
+        _lastPreconnectByOrigin = [NSMutableDictionary dictionary];
+        _delegatesByTask = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                 valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    return self;
+}
+
+#pragma mark - 会话
+
++ (NSString *)originOfURL:(NSURL *)url {
+    NSString *scheme = url.scheme.lowercaseString ?: @"";
+    NSNumber *port = url.port ?: ([scheme isEqualToString:@"https"] ? @443 : @80);
+    return [NSString stringWithFormat:@"%@://%@:%@", scheme, url.host.lowercaseString ?: @"", port];
+}
+
+- (NSURLSession *)sessionForURL:(NSURL *)url {
+    NSString *origin = [AIUAHTTPSessionPool originOfURL:url];
+    @synchronized (self) {
+        NSURLSession *session = self.sessionsByOrigin[origin];
+        if (!session) {
+            NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+            config.timeoutIntervalForRequest = kAIUAHTTPSessionRequestTimeout;
+            // 代理回调统一在主线程，与界面更新一致
+            session = [NSURLSession sessionWithConfiguration:config delegate:self delegateQueue:[NSOperationQueue mainQueue]];
+            self.sessionsByOrigin[origin] = session;
+            NSLog(@"[HTTPPool] 创建会话 %@", origin);
+        }
+        return session;
+    }
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate {
+    NSURLSessionDataTask *task = [[self sessionForURL:request.URL] dataTaskWithRequest:request];
+    @synchronized (self) {
+        [self.delegatesByTask setObject:delegate forKey:task];
+    }
+    return task;
+}
+
+- (id<NSURLSessionDataDelegate>)delegateForTask:(NSURLSessionTask *)task {
+    @synchronized (self) {
+        return [self.delegatesByTask objectForKey:task];
+    }
+}
+
+#pragma mark - 预连接
+
+- (void)preconnectToURL:(NSURL *)url {
+    if (url.scheme.length == 0 || url.host.length == 0) {
+        return;
+    }
+    NSString *origin = [AIUAHTTPSessionPool originOfURL:url];
+    @synchronized (self) {
+        NSDate *last = self.lastPreconnectByOrigin[origin];
+        if (last && -[last timeIntervalSinceNow] < kAIUAHTTPPreconnectInterval) {
+            return;
+        }
+        self.lastPreconnectByOrigin[origin] = [NSDate date];
+    }
+
+    NSURLComponents *components = [[NSURLComponents alloc] init];
+    components.scheme = url.scheme;
+    components.host = url.host;
+    components.port = url.port;
+    components.path = @"/";
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:components.URL];
+    request.HTTPMethod = @"HEAD";
+    request.timeoutInterval = kAIUAHTTPPreconnectTimeout;
+
+    NSURLSessionDataTask *task = [[self sessionForURL:url] dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        if (error) {
+            NSLog(@"[HTTPPool] 预连接失败 %@: %@", origin, error.localizedDescription);
+            // 失败后允许立即再次预连接
+            @synchronized (self) {
+                [self.lastPreconnectByOrigin removeObjectForKey:origin];
+            }
+        }
+    }];
+    task.taskDescription = kAIUAHTTPPreconnectTaskDescription;
+    [task resume];
+}
+
+#pragma mark - NSURLSessionDataDelegate（按任务转发）
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    id<NSURLSessionDataDelegate> delegate = [self delegateForTask:dataTask];
+    if ([delegate respondsToSelector:@selector(URLSession:dataTask:didReceiveResponse:completionHandler:)]) {
+        [delegate URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+    } else {
+        completionHandler(NSURLSessionResponseAllow);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    id<NSURLSessionDataDelegate> delegate = [self delegateForTask:dataTask];
+    if ([delegate respondsToSelector:@selector(URLSession:dataTask:didReceiveData:)]) {
+        [delegate URLSession:session dataTask:dataTask didReceiveData:data];
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics {
+    NSURLSessionTaskTransactionMetrics *transaction = metrics.transactionMetrics.lastObject;
+    if (transaction) {
+        double (^ms)(NSDate *, NSDate *) = ^double(NSDate *start, NSDate *end) {
+            return (start && end) ? [end timeIntervalSinceDate:start] * 1000.0 : 0;
+        };
+        NSLog(@"[HTTPPool] task=%lu %@ reused=%d protocol=%@ dns=%.0fms connect=%.0fms tls=%.0fms ttfb=%.0fms total=%.0fms",
+              (unsigned long)task.taskIdentifier,
+              task.taskDescription ?: task.originalRequest.URL.path,
+              transaction.isReusedConnection,
+              transaction.networkProtocolName ?: @"-",
+              ms(transaction.domainLookupStartDate, transaction.domainLookupEndDate),
+              ms(transaction.connectStartDate, transaction.connectEndDate),
+              ms(transaction.secureConnectionStartDate, transaction.secureConnectionEndDate),
+              ms(transaction.requestStartDate, transaction.responseStartDate),
+              metrics.taskInterval.duration * 1000.0);
+    }
+    id<NSURLSessionDataDelegate> delegate = [self delegateForTask:task];
+    if ([delegate respondsToSelector:@selector(URLSession:task:didFinishCollectingMetrics:)]) {
+        [delegate URLSession:session task:task didFinishCollectingMetrics:metrics];
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    id<NSURLSessionDataDelegate> delegate = nil;
+    @synchronized (self) {
+        delegate = [self.delegatesByTask objectForKey:task];
+        [self.delegatesByTask removeObjectForKey:task];
+    }
+    if ([delegate respondsToSelector:@selector(URLSession:task:didCompleteWithError:)]) {
+        [delegate URLSession:session task:task didCompleteWithError:error];
+    }
+}
+
+@end
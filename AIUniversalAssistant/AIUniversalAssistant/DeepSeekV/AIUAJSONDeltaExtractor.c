@@ -0,0 +1,595 @@
+//
+//  AIUAJSONDeltaExtractor.c
+//  AIUniversalAssistant
+//
+//  流式 chunk JSON 提取器实现
+//
+
+#include "AIUAJSONDeltaExtractor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 跳过嵌套值时允许的最大深度，超出视为非预期结构
+#define AIUA_JSON_DELTA_MAX_DEPTH 64
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} AIUAJSONCursor;
+
+// 字符串区间（不含引号）
+typedef struct {
+    const uint8_t *start;
+    size_t length;
+    bool hasEscape;
+} AIUAJSONString;
+
+typedef enum {
+    AIUAJSONContentMissing = 0,
+    AIUAJSONContentNull,
+    AIUAJSONContentString,
+    AIUAJSONContentOther,
+} AIUAJSONContentKind;
+
+// message / delta 对象的扫描结果
+typedef struct {
+    bool present;               // 字段存在且值为对象
+    AIUAJSONContentKind kind;
+    AIUAJSONString content;
+} AIUAJSONHolder;
+
+#pragma mark - 词法
+
+static void AIUAJSONSkipWhitespace(AIUAJSONCursor *cursor) {
+    while (cursor->p < cursor->end) {
+        uint8_t c = *cursor->p;
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        cursor->p++;
+    }
+}
+
+static bool AIUAJSONConsume(AIUAJSONCursor *cursor, uint8_t expected) {
+    AIUAJSONSkipWhitespace(cursor);
+    if (cursor->p < cursor->end && *cursor->p == expected) {
+        cursor->p++;
+        return true;
+    }
+    return false;
+}
+
+static bool AIUAJSONPeek(AIUAJSONCursor *cursor, uint8_t expected) {
+    AIUAJSONSkipWhitespace(cursor);
+    return cursor->p < cursor->end && *cursor->p == expected;
+}
+
+static bool AIUAJSONIsHex(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static uint32_t AIUAJSONReadHex4(const uint8_t *p) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= (uint32_t)(c - 'a' + 10);
+        } else {
+            value |= (uint32_t)(c - 'A' + 10);
+        }
+    }
+    return value;
+}
+
+// 校验 p 处的一个 UTF-8 多字节序列（拒绝过长编码和代理项），返回其长度，非法时返回 0
+static size_t AIUAJSONValidateUTF8(const uint8_t *p, const uint8_t *end) {
+    uint8_t lead = p[0];
+    size_t length;
+    uint32_t codePoint;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        codePoint = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        codePoint = lead & 0x0F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        codePoint = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if ((size_t)(end - p) < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+    if ((length == 3 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))) ||
+        (length == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))) {
+        return 0;
+    }
+    return length;
+}
+
+// 扫描字符串（cursor 指向起始引号），只校验不解码
+static bool AIUAJSONScanString(AIUAJSONCursor *cursor, AIUAJSONString *out) {
+    if (cursor->p >= cursor->end || *cursor->p != '"') {
+        return false;
+    }
+    const uint8_t *start = ++cursor->p;
+    bool hasEscape = false;
+    while (cursor->p < cursor->end) {
+        uint8_t c = *cursor->p;
+        if (c == '"') {
+            if (out) {
+                out->start = start;
+                out->length = (size_t)(cursor->p - start);
+                out->hasEscape = hasEscape;
+            }
+            cursor->p++;
+            return true;
+        }
+        if (c < 0x20) {
+            return false;
+        }
+        if (c >= 0x80) {
+            size_t sequenceLength = AIUAJSONValidateUTF8(cursor->p, cursor->end);
+            if (sequenceLength == 0) {
+                return false;
+            }
+            cursor->p += sequenceLength;
+            continue;
+        }
+        if (c == '\\') {
+            hasEscape = true;
+            if (cursor->p + 1 >= cursor->end) {
+                return false;
+            }
+            uint8_t e = cursor->p[1];
+            if (e == 'u') {
+                if (cursor->end - cursor->p < 6) {
+                    return false;
+                }
+                for (int i = 2; i < 6; i++) {
+                    if (!AIUAJSONIsHex(cursor->p[i])) {
+                        return false;
+                    }
+                }
+                // 与 NSJSONSerialization 一致：任何字段中未配对的代理项都使整段 JSON 不合法
+                uint32_t unit = AIUAJSONReadHex4(cursor->p + 2);
+                if (unit >= 0xDC00 && unit <= 0xDFFF) {
+                    return false;
+                }
+                if (unit >= 0xD800 && unit <= 0xDBFF) {
+                    if (cursor->end - cursor->p < 12 || cursor->p[6] != '\\' || cursor->p[7] != 'u') {
+                        return false;
+                    }
+                    for (int i = 8; i < 12; i++) {
+                        if (!AIUAJSONIsHex(cursor->p[i])) {
+                            return false;
+                        }
+                    }
+                    uint32_t low = AIUAJSONReadHex4(cursor->p + 8);
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    cursor->p += 6;
+                }
+                cursor->p += 6;
+                continue;
+            }
+            if (!strchr("\"\\/bfnrt", e) || e == '\0') {
+                return false;
+            }
+            cursor->p += 2;
+            continue;
+        }
+        cursor->p++;
+    }
+    return false;
+}
+
+static bool AIUAJSONScanDigits(AIUAJSONCursor *cursor) {
+    const uint8_t *start = cursor->p;
+    while (cursor->p < cursor->end && *cursor->p >= '0' && *cursor->p <= '9') {
+        cursor->p++;
+    }
+    return cursor->p > start;
+}
+
+static bool AIUAJSONScanNumber(AIUAJSONCursor *cursor) {
+    if (cursor->p < cursor->end && *cursor->p == '-') {
+        cursor->p++;
+    }
+    const uint8_t *integerStart = cursor->p;
+    if (!AIUAJSONScanDigits(cursor)) {
+        return false;
+    }
+    // 不允许前导 0
+    if (*integerStart == '0' && cursor->p - integerStart > 1) {
+        return false;
+    }
+    if (cursor->p < cursor->end && *cursor->p == '.') {
+        cursor->p++;
+        if (!AIUAJSONScanDigits(cursor)) {
+            return false;
+        }
+    }
+    if (cursor->p < cursor->end && (*cursor->p == 'e' || *cursor->p == 'E')) {
+        cursor->p++;
+        if (cursor->p < cursor->end && (*cursor->p == '+' || *cursor->p == '-')) {
+            cursor->p++;
+        }
+        if (!AIUAJSONScanDigits(cursor)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool AIUAJSONScanLiteral(AIUAJSONCursor *cursor, const char *literal) {
+    size_t length = strlen(literal);
+    if ((size_t)(cursor->end - cursor->p) < length || memcmp(cursor->p, literal, length) != 0) {
+        return false;
+    }
+    cursor->p += length;
+    return true;
+}
+
+static bool AIUAJSONSkipValue(AIUAJSONCursor *cursor, int depth);
+
+// 逐个读取对象成员：返回 1 表示读到一个 key（cursor 位于值之前），0 表示对象结束，-1 表示语法错误
+static int AIUAJSONNextMember(AIUAJSONCursor *cursor, bool *isFirst, AIUAJSONString *key) {
+    AIUAJSONSkipWhitespace(cursor);
+    if (*isFirst) {
+        *isFirst = false;
+        if (AIUAJSONConsume(cursor, '}')) {
+            return 0;
+        }
+    } else {
+        if (AIUAJSONConsume(cursor, '}')) {
+            return 0;
+        }
+        if (!AIUAJSONConsume(cursor, ',')) {
+            return -1;
+        }
+        AIUAJSONSkipWhitespace(cursor);
+    }
+    if (!AIUAJSONScanString(cursor, key) || !AIUAJSONConsume(cursor, ':')) {
+        return -1;
+    }
+    AIUAJSONSkipWhitespace(cursor);
+    return cursor->p < cursor->end ? 1 : -1;
+}
+
+static bool AIUAJSONSkipObject(AIUAJSONCursor *cursor, int depth) {
+    cursor->p++;
+    bool isFirst = true;
+    int status;
+    while ((status = AIUAJSONNextMember(cursor, &isFirst, NULL)) == 1) {
+        if (!AIUAJSONSkipValue(cursor, depth + 1)) {
+            return false;
+        }
+    }
+    return status == 0;
+}
+
+static bool AIUAJSONSkipArray(AIUAJSONCursor *cursor, int depth) {
+    cursor->p++;
+    if (AIUAJSONConsume(cursor, ']')) {
+        return true;
+    }
+    do {
+        AIUAJSONSkipWhitespace(cursor);
+        if (!AIUAJSONSkipValue(cursor, depth + 1)) {
+            return false;
+        }
+    } while (AIUAJSONConsume(cursor, ','));
+    return AIUAJSONConsume(cursor, ']');
+}
+
+static bool AIUAJSONSkipValue(AIUAJSONCursor *cursor, int depth) {
+    if (depth > AIUA_JSON_DELTA_MAX_DEPTH) {
+        return false;
+    }
+    AIUAJSONSkipWhitespace(cursor);
+    if (cursor->p >= cursor->end) {
+        return false;
+    }
+    switch (*cursor->p) {
+        case '{': return AIUAJSONSkipObject(cursor, depth);
+        case '[': return AIUAJSONSkipArray(cursor, depth);
+        case '"': return AIUAJSONScanString(cursor, NULL);
+        case 't': return AIUAJSONScanLiteral(cursor, "true");
+        case 'f': return AIUAJSONScanLiteral(cursor, "false");
+        case 'n': return AIUAJSONScanLiteral(cursor, "null");
+        default:  return AIUAJSONScanNumber(cursor);
+    }
+}
+
+// 仅比较不含转义的 key；含转义的 key 由调用方按非预期处理
+static bool AIUAJSONKeyEquals(const AIUAJSONString *key, const char *name) {
+    size_t length = strlen(name);
+    return key->length == length && memcmp(key->start, name, length) == 0;
+}
+
+#pragma mark - 结构
+
+// 扫描 message / delta 对象，记录 content 字段
+static bool AIUAJSONScanHolder(AIUAJSONCursor *cursor, AIUAJSONHolder *holder) {
+    holder->present = true;
+    holder->kind = AIUAJSONContentMissing;
+    cursor->p++;
+    bool isFirst = true;
+    AIUAJSONString key;
+    int status;
+    while ((status = AIUAJSONNextMember(cursor, &isFirst, &key)) == 1) {
+        if (key.hasEscape) {
+            return false;
+        }
+        if (AIUAJSONKeyEquals(&key, "content")) {
+            if (*cursor->p == '"') {
+                if (!AIUAJSONScanString(cursor, &holder->content)) {
+                    return false;
+                }
+                holder->kind = AIUAJSONContentString;
+                continue;
+            }
+            if (*cursor->p == 'n' && AIUAJSONScanLiteral(cursor, "null")) {
+                holder->kind = AIUAJSONContentNull;
+                continue;
+            }
+            holder->kind = AIUAJSONContentOther;
+        }
+        if (!AIUAJSONSkipValue(cursor, 3)) {
+            return false;
+        }
+    }
+    return status == 0;
+}
+
+// 扫描 choices[0]
+static bool AIUAJSONScanChoice(AIUAJSONCursor *cursor, AIUAJSONHolder *message, AIUAJSONHolder *delta) {
+    cursor->p++;
+    bool isFirst = true;
+    AIUAJSONString key;
+    int status;
+    while ((status = AIUAJSONNextMember(cursor, &isFirst, &key)) == 1) {
+        if (key.hasEscape) {
+            return false;
+        }
+        bool isMessage = AIUAJSONKeyEquals(&key, "message");
+        bool isDelta = !isMessage && AIUAJSONKeyEquals(&key, "delta");
+        if ((isMessage || isDelta) && *cursor->p == '{') {
+            if (!AIUAJSONScanHolder(cursor, isMessage ? message : delta)) {
+                return false;
+            }
+            continue;
+        }
+        if (isMessage || isDelta) {
+            // 重复 key 以最后一次为准
+            (isMessage ? message : delta)->present = false;
+        }
+        if (!AIUAJSONSkipValue(cursor, 2)) {
+            return false;
+        }
+    }
+    return status == 0;
+}
+
+// 扫描 choices 数组，返回 false 表示非预期
+static bool AIUAJSONScanChoices(AIUAJSONCursor *cursor, bool *hasChoice, AIUAJSONHolder *message, AIUAJSONHolder *delta) {
+    cursor->p++;
+    if (AIUAJSONConsume(cursor, ']')) {
+        return true;
+    }
+    AIUAJSONSkipWhitespace(cursor);
+    if (cursor->p >= cursor->end || *cursor->p != '{') {
+        return false;
+    }
+    memset(message, 0, sizeof(*message));
+    memset(delta, 0, sizeof(*delta));
+    if (!AIUAJSONScanChoice(cursor, message, delta)) {
+        return false;
+    }
+    *hasChoice = true;
+    while (AIUAJSONConsume(cursor, ',')) {
+        if (!AIUAJSONSkipValue(cursor, 2)) {
+            return false;
+        }
+    }
+    return AIUAJSONConsume(cursor, ']');
+}
+
+#pragma mark - 解码
+
+static bool AIUAJSONReserve(AIUAJSONDeltaExtractor *extractor, size_t capacity) {
+    if (capacity <= extractor->bufferCapacity) {
+        return true;
+    }
+    size_t grown = extractor->bufferCapacity > 0 ? extractor->bufferCapacity : 256;
+    while (grown < capacity) {
+        grown *= 2;
+    }
+    uint8_t *buffer = (uint8_t *)realloc(extractor->buffer, grown);
+    if (!buffer) {
+        return false;
+    }
+    extractor->buffer = buffer;
+    extractor->bufferCapacity = grown;
+    return true;
+}
+
+static size_t AIUAJSONEncodeUTF8(uint32_t codePoint, uint8_t *out) {
+    if (codePoint < 0x80) {
+        out[0] = (uint8_t)codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        out[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+        out[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        out[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+        out[1] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    out[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+    out[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+    out[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+    out[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+// 解码已通过 AIUAJSONScanString 校验的字符串；未配对的代理项视为非法
+static bool AIUAJSONDecodeString(AIUAJSONDeltaExtractor *extractor, const AIUAJSONString *string) {
+    // 转义序列解码后不会比原文更长（\uXXXX 6 字节 -> 最多 3 字节，代理对 12 字节 -> 4 字节）
+    if (!AIUAJSONReserve(extractor, string->length + 1)) {
+        return false;
+    }
+    const uint8_t *p = string->start;
+    const uint8_t *end = string->start + string->length;
+    uint8_t *out = extractor->buffer;
+    while (p < end) {
+        const uint8_t *backslash = (const uint8_t *)memchr(p, '\\', (size_t)(end - p));
+        size_t plain = backslash ? (size_t)(backslash - p) : (size_t)(end - p);
+        memcpy(out, p, plain);
+        out += plain;
+        p += plain;
+        if (!backslash) {
+            break;
+        }
+        uint8_t e = p[1];
+        p += 2;
+        switch (e) {
+            case '"':  *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/':  *out++ = '/'; break;
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'u': {
+                uint32_t codePoint = AIUAJSONReadHex4(p);
+                p += 4;
+                if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return false;
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u') {
+                        return false;
+                    }
+                    uint32_t low = AIUAJSONReadHex4(p + 2);
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    p += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                out += AIUAJSONEncodeUTF8(codePoint, out);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    extractor->content = extractor->buffer;
+    extractor->contentLength = (size_t)(out - extractor->buffer);
+    return true;
+}
+
+#pragma mark - 公开接口
+
+void AIUAJSONDeltaExtractorInit(AIUAJSONDeltaExtractor *extractor) {
+    memset(extractor, 0, sizeof(*extractor));
+}
+
+void AIUAJSONDeltaExtractorDestroy(AIUAJSONDeltaExtractor *extractor) {
+    free(extractor->buffer);
+    extractor->buffer = NULL;
+    extractor->bufferCapacity = 0;
+    extractor->content = NULL;
+    extractor->contentLength = 0;
+}
+
+static AIUAJSONDeltaResult AIUAJSONDeltaExtractorScan(AIUAJSONDeltaExtractor *extractor,
+                                                      const uint8_t *json,
+                                                      size_t length) {
+    AIUAJSONCursor cursor = { json, json + length };
+    if (!json || !AIUAJSONPeek(&cursor, '{')) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    cursor.p++;
+
+    bool hasChoice = false;
+    AIUAJSONHolder message = {0};
+    AIUAJSONHolder delta = {0};
+    bool isFirst = true;
+    AIUAJSONString key;
+    int status;
+    while ((status = AIUAJSONNextMember(&cursor, &isFirst, &key)) == 1) {
+        if (key.hasEscape) {
+            return AIUAJSONDeltaResultUnexpected;
+        }
+        if (AIUAJSONKeyEquals(&key, "choices")) {
+            hasChoice = false;
+            if (*cursor.p == '[') {
+                if (!AIUAJSONScanChoices(&cursor, &hasChoice, &message, &delta)) {
+                    return AIUAJSONDeltaResultUnexpected;
+                }
+                continue;
+            }
+        }
+        if (!AIUAJSONSkipValue(&cursor, 1)) {
+            return AIUAJSONDeltaResultUnexpected;
+        }
+    }
+    AIUAJSONSkipWhitespace(&cursor);
+    if (status != 0 || cursor.p != cursor.end) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    if (!hasChoice) {
+        return AIUAJSONDeltaResultNoContent;
+    }
+
+    // 与 extractContentFromResponse: 一致：message 为对象时优先（即使没有 content 也不再看 delta）
+    const AIUAJSONHolder *holder = message.present ? &message : (delta.present ? &delta : NULL);
+    if (!holder || holder->kind == AIUAJSONContentMissing || holder->kind == AIUAJSONContentNull) {
+        return AIUAJSONDeltaResultNoContent;
+    }
+    if (holder->kind != AIUAJSONContentString) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    if (!holder->content.hasEscape) {
+        extractor->content = holder->content.start;
+        extractor->contentLength = holder->content.length;
+        return AIUAJSONDeltaResultContent;
+    }
+    return AIUAJSONDecodeString(extractor, &holder->content) ? AIUAJSONDeltaResultContent : AIUAJSONDeltaResultUnexpected;
+}
+
+AIUAJSONDeltaResult AIUAJSONDeltaExtractorExtract(AIUAJSONDeltaExtractor *extractor,
+                                                  const uint8_t *json,
+                                                  size_t length) {
+    extractor->content = NULL;
+    extractor->contentLength = 0;
+    AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorScan(extractor, json, length);
+    if (result == AIUAJSONDeltaResultUnexpected) {
+        extractor->content = NULL;
+        extractor->contentLength = 0;
+        extractor->totalFallbacks += 1;
+    } else {
+        extractor->totalFastPathHits += 1;
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+//
+//  AIUAJSONDeltaExtractor.h
+//  AIUniversalAssistant
+//
+//  流式返回 chunk 的专用 JSON 提取器，纯C实现
+//  - 只定位 choices[0].message.content / choices[0].delta.content，不构建 NSDictionary 对象树
+//  - 其余字段仅做语法校验后跳过，整段 JSON 不合法时不会给出结果
+//  - 无转义的 content 直接返回输入缓冲区内的区间；含转义（包括 \uXXXX 代理对）时解码到可复用缓冲区
+//  - 遇到非预期结构返回 AIUAJSONDeltaResultUnexpected，由调用方回退到 NSJSONSerialization
+//
+
+#ifndef AIUAJSONDeltaExtractor_h
+#define AIUAJSONDeltaExtractor_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    AIUAJSONDeltaResultContent = 0,     // 提取到 content 字符串（可能为空串）
+    AIUAJSONDeltaResultNoContent,       // 结构正常但没有 content（如只含 role 或 finish_reason 的 chunk）
+    AIUAJSONDeltaResultUnexpected,      // JSON 不合法或结构不符合预期，需回退到通用解析
+} AIUAJSONDeltaResult;
+
+typedef struct {
+    // 最近一次提取到的 content（UTF-8），仅在下一次调用前有效
+    const uint8_t *content;
+    size_t contentLength;
+
+    // 转义解码用的可复用缓冲区
+    uint8_t *buffer;
+    size_t bufferCapacity;
+
+    // 统计
+    uint64_t totalFastPathHits;
+    uint64_t totalFallbacks;
+} AIUAJSONDeltaExtractor;
+
+/// 初始化提取器（不分配内存）
+void AIUAJSONDeltaExtractorInit(AIUAJSONDeltaExtractor *extractor);
+
+/// 释放提取器持有的内存
+void AIUAJSONDeltaExtractorDestroy(AIUAJSONDeltaExtractor *extractor);
+
+/**
+ * 从一个 chunk 的 JSON 中提取内容
+ * 取值规则与 extractContentFromResponse: 一致：choices[0].message 为对象时取其 content，否则取 choices[0].delta.content
+ * @param json chunk 的 JSON 字节（一次 SSE data），结果可能直接引用其中的字节
+ */
+AIUAJSONDeltaResult AIUAJSONDeltaExtractorExtract(AIUAJSONDeltaExtractor *extractor,
+                                                  const uint8_t *json,
+                                                  size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAJSONDeltaExtractor_h */
@@ -0,0 +1,322 @@
+//
+//  AIUASSEParser.c
+//  AIUniversalAssistant
+//
+//  SSE 字节级分帧引擎实现
+//
+
+#include "AIUASSEParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t kAIUASSEBOM[3] = {0xEF, 0xBB, 0xBF};
+
+#pragma mark - 内部辅助
+
+static void AIUASSEParserClearEvent(AIUASSEParser *parser) {
+    parser->dataOffset = 0;
+    parser->dataLength = 0;
+    parser->dataLineCount = 0;
+    parser->eventTypeOffset = 0;
+    parser->eventTypeLength = 0;
+    parser->hasEventType = false;
+    parser->eventIDOffset = 0;
+    parser->eventIDLength = 0;
+    parser->hasEventID = false;
+    parser->scratchLength = 0;
+}
+
+static bool AIUASSEParserHasPendingEvent(const AIUASSEParser *parser) {
+    return parser->dataLineCount > 0 || parser->hasEventType || parser->hasEventID;
+}
+
+static bool AIUASSEScratchAppend(AIUASSEParser *parser, const uint8_t *bytes, size_t length) {
+    size_t required = parser->scratchLength + length;
+    if (required > parser->scratchCapacity) {
+        size_t capacity = parser->scratchCapacity > 0 ? parser->scratchCapacity : 256;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        uint8_t *grown = (uint8_t *)realloc(parser->scratch, capacity);
+        if (!grown) {
+            return false;
+        }
+        parser->scratch = grown;
+        parser->scratchCapacity = capacity;
+    }
+    if (length > 0) {
+        memcpy(parser->scratch + parser->scratchLength, bytes, length);
+    }
+    parser->scratchLength = required;
+    return true;
+}
+
+static bool AIUASSEFieldEquals(const uint8_t *field, size_t length, const char *name) {
+    size_t nameLength = strlen(name);
+    return length == nameLength && memcmp(field, name, nameLength) == 0;
+}
+
+// 查找 [from, to) 内第一个 CR 或 LF，未找到返回 to
+static size_t AIUASSEFindLineEnd(const uint8_t *buffer, size_t from, size_t to) {
+    if (from >= to) {
+        return to;
+    }
+    const uint8_t *lf = (const uint8_t *)memchr(buffer + from, '\n', to - from);
+    size_t limit = lf ? (size_t)(lf - buffer) : to;
+    const uint8_t *cr = limit > from ? (const uint8_t *)memchr(buffer + from, '\r', limit - from) : NULL;
+    if (cr) {
+        return (size_t)(cr - buffer);
+    }
+    return limit;
+}
+
+// 分发当前事件，返回回调的结果
+static bool AIUASSEParserDispatch(AIUASSEParser *parser,
+                                  const uint8_t *buffer,
+                                  AIUASSEEventCallback callback,
+                                  void *context) {
+    bool shouldContinue = true;
+    size_t dataLength = parser->dataLineCount > 1 ? parser->scratchLength : parser->dataLength;
+    if (parser->dataLineCount > 0 && dataLength > 0) {
+        AIUASSEEvent event;
+        if (parser->dataLineCount > 1) {
+            event.data = parser->scratch;
+            event.dataLength = parser->scratchLength;
+        } else {
+            event.data = buffer + parser->dataOffset;
+            event.dataLength = parser->dataLength;
+        }
+        event.eventType = parser->hasEventType ? buffer + parser->eventTypeOffset : NULL;
+        event.eventTypeLength = parser->hasEventType ? parser->eventTypeLength : 0;
+        event.eventID = parser->hasEventID ? buffer + parser->eventIDOffset : NULL;
+        event.eventIDLength = parser->hasEventID ? parser->eventIDLength : 0;
+
+        parser->totalEventsDispatched += 1;
+        if (callback) {
+            shouldContinue = callback(&event, context);
+        }
+    }
+    AIUASSEParserClearEvent(parser);
+    return shouldContinue;
+}
+
+// 处理一行 [start, end)，遇到空行时分发事件
+static bool AIUASSEParserProcessLine(AIUASSEParser *parser,
+                                     const uint8_t *buffer,
+                                     size_t start,
+                                     size_t end,
+                                     AIUASSEEventCallback callback,
+                                     void *context) {
+    if (start == end) {
+        return AIUASSEParserDispatch(parser, buffer, callback, context);
+    }
+
+    if (buffer[start] == ':') {
+        parser->totalCommentLines += 1;
+        return true;
+    }
+
+    const uint8_t *colon = (const uint8_t *)memchr(buffer + start, ':', end - start);
+    size_t fieldEnd = colon ? (size_t)(colon - buffer) : end;
+    size_t valueStart = colon ? fieldEnd + 1 : end;
+    if (valueStart < end && buffer[valueStart] == ' ') {
+        valueStart += 1;
+    }
+    size_t valueLength = end - valueStart;
+    const uint8_t *field = buffer + start;
+    size_t fieldLength = fieldEnd - start;
+
+    if (AIUASSEFieldEquals(field, fieldLength, "data")) {
+        if (parser->dataLineCount == 0) {
+            parser->dataOffset = valueStart;
+            parser->dataLength = valueLength;
+        } else {
+            if (parser->dataLineCount == 1) {
+                parser->scratchLength = 0;
+            }
+            bool appended = (parser->dataLineCount > 1 || AIUASSEScratchAppend(parser, buffer + parser->dataOffset, parser->dataLength))
+                && AIUASSEScratchAppend(parser, (const uint8_t *)"\n", 1)
+                && AIUASSEScratchAppend(parser, buffer + valueStart, valueLength);
+            if (!appended) {
+                // 数据已不完整，丢弃当前事件并停止解析，不能当作完整事件分发
+                parser->failed = true;
+                AIUASSEParserClearEvent(parser);
+                return false;
+            }
+        }
+        parser->dataLineCount += 1;
+    } else if (AIUASSEFieldEquals(field, fieldLength, "event")) {
+        parser->eventTypeOffset = valueStart;
+        parser->eventTypeLength = valueLength;
+        parser->hasEventType = true;
+    } else if (AIUASSEFieldEquals(field, fieldLength, "id")) {
+        // 规范：包含 NUL 的 id 忽略
+        if (valueLength == 0 || !memchr(buffer + valueStart, '\0', valueLength)) {
+            parser->eventIDOffset = valueStart;
+            parser->eventIDLength = valueLength;
+            parser->hasEventID = true;
+            size_t copyLength = valueLength < AIUA_SSE_MAX_ID_LENGTH ? valueLength : AIUA_SSE_MAX_ID_LENGTH;
+            memcpy(parser->lastEventID, buffer + valueStart, copyLength);
+            parser->lastEventID[copyLength] = '\0';
+            parser->lastEventIDLength = copyLength;
+        }
+    } else if (AIUASSEFieldEquals(field, fieldLength, "retry")) {
+        long value = 0;
+        bool valid = valueLength > 0;
+        for (size_t i = valueStart; i < end && valid; i++) {
+            if (buffer[i] < '0' || buffer[i] > '9') {
+                valid = false;
+            } else {
+                value = value * 10 + (buffer[i] - '0');
+            }
+        }
+        if (valid) {
+            parser->retryMilliseconds = value;
+        }
+    }
+    // 其他字段按规范忽略
+    return true;
+}
+
+#pragma mark - 公开接口
+
+void AIUASSEParserInit(AIUASSEParser *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->retryMilliseconds = -1;
+}
+
+void AIUASSEParserReset(AIUASSEParser *parser, bool keepLastEventID) {
+    uint8_t *scratch = parser->scratch;
+    size_t scratchCapacity = parser->scratchCapacity;
+    char lastEventID[AIUA_SSE_MAX_ID_LENGTH + 1];
+    size_t lastEventIDLength = parser->lastEventIDLength;
+    memcpy(lastEventID, parser->lastEventID, sizeof(lastEventID));
+    long retry = parser->retryMilliseconds;
+
+    AIUASSEParserInit(parser);
+    parser->scratch = scratch;
+    parser->scratchCapacity = scratchCapacity;
+    if (keepLastEventID) {
+        memcpy(parser->lastEventID, lastEventID, sizeof(lastEventID));
+        parser->lastEventIDLength = lastEventIDLength;
+        parser->retryMilliseconds = retry;
+    }
+}
+
+void AIUASSEParserDestroy(AIUASSEParser *parser) {
+    free(parser->scratch);
+    parser->scratch = NULL;
+    parser->scratchCapacity = 0;
+    parser->scratchLength = 0;
+}
+
+size_t AIUASSEParserFeed(AIUASSEParser *parser,
+                         const uint8_t *buffer,
+                         size_t length,
+                         AIUASSEEventCallback callback,
+                         void *context) {
+    if (!buffer || length <= parser->scanOffset || parser->failed) {
+        return parser->eventStart;
+    }
+
+    if (!parser->checkedBOM) {
+        size_t available = length - parser->scanOffset;
+        size_t compare = available < sizeof(kAIUASSEBOM) ? available : sizeof(kAIUASSEBOM);
+        if (memcmp(buffer + parser->scanOffset, kAIUASSEBOM, compare) == 0) {
+            if (compare < sizeof(kAIUASSEBOM)) {
+                // BOM 被拆包，等待更多字节
+                return parser->eventStart;
+            }
+            parser->scanOffset += sizeof(kAIUASSEBOM);
+            parser->lineStart = parser->scanOffset;
+            parser->eventStart = parser->scanOffset;
+        }
+        parser->checkedBOM = true;
+    }
+
+    size_t scanned = parser->scanOffset;
+    while (parser->scanOffset < length) {
+        if (parser->skipLeadingLF) {
+            parser->skipLeadingLF = false;
+            if (buffer[parser->scanOffset] == '\n') {
+                parser->scanOffset += 1;
+                parser->lineStart = parser->scanOffset;
+                if (!AIUASSEParserHasPendingEvent(parser)) {
+                    parser->eventStart = parser->lineStart;
+                }
+                continue;
+            }
+        }
+
+        size_t lineEnd = AIUASSEFindLineEnd(buffer, parser->scanOffset, length);
+        if (lineEnd >= length) {
+            parser->scanOffset = length;
+            break;
+        }
+
+        parser->skipLeadingLF = buffer[lineEnd] == '\r';
+        parser->scanOffset = lineEnd + 1;
+        bool shouldContinue = AIUASSEParserProcessLine(parser, buffer, parser->lineStart, lineEnd, callback, context);
+        parser->lineStart = parser->scanOffset;
+        if (!AIUASSEParserHasPendingEvent(parser)) {
+            parser->eventStart = parser->lineStart;
+        }
+        if (!shouldContinue) {
+            break;
+        }
+    }
+    parser->totalBytesScanned += parser->scanOffset - scanned;
+    return parser->eventStart;
+}
+
+void AIUASSEParserDidDiscard(AIUASSEParser *parser, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (count > parser->eventStart) {
+        count = parser->eventStart;
+    }
+    parser->scanOffset -= count;
+    parser->lineStart -= count;
+    parser->eventStart -= count;
+    if (parser->dataLineCount == 1) {
+        parser->dataOffset -= count;
+    }
+    if (parser->hasEventType) {
+        parser->eventTypeOffset -= count;
+    }
+    if (parser->hasEventID) {
+        parser->eventIDOffset -= count;
+    }
+}
+
+void AIUASSEParserFinish(AIUASSEParser *parser,
+                         const uint8_t *buffer,
+                         size_t length,
+                         AIUASSEEventCallback callback,
+                         void *context) {
+    AIUASSEParserFeed(parser, buffer, length, callback, context);
+    if (parser->failed) {
+        AIUASSEParserClearEvent(parser);
+        return;
+    }
+    if (buffer && parser->lineStart < length) {
+        AIUASSEParserProcessLine(parser, buffer, parser->lineStart, length, callback, context);
+        parser->lineStart = length;
+        parser->scanOffset = length;
+    }
+    if (parser->dataLineCount > 1 || (buffer && parser->dataLineCount > 0)) {
+        AIUASSEParserDispatch(parser, buffer, callback, context);
+    }
+    AIUASSEParserClearEvent(parser);
+    parser->eventStart = parser->lineStart;
+}
+
+bool AIUASSEEventDataEquals(const AIUASSEEvent *event, const char *literal) {
+    if (!event || !literal) {
+        return false;
+    }
+    size_t length = strlen(literal);
+    return event->dataLength == length && memcmp(event->data, literal, length) == 0;
+}
@@ -0,0 +1,118 @@
+//
+//  AIUASSEParser.h
+//  AIUniversalAssistant
+//
+//  SSE（text/event-stream）字节级分帧引擎，纯C实现
+//  - 维护扫描游标，每次只解析新到达的字节，整体开销为 O(总字节数)
+//  - 按字节查找换行，不做 UTF-8 解码，分包截断在多字节字符中间也不会出错
+//  - 支持 data: / event: / id: / retry: / 注释行，以及 LF、CRLF、CR 三种换行
+//  - 单行 data 事件直接返回缓冲区内的字节区间（零拷贝）；多行 data 才会拼接到内部暂存区
+//  - data 为空的事件不分发（其 id 仍会记录到 lastEventID）
+//
+
+#ifndef AIUASSEParser_h
+#define AIUASSEParser_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 事件中 id 的最大保留长度（超出部分截断），用于断线重连时的 Last-Event-ID
+#define AIUA_SSE_MAX_ID_LENGTH 128
+
+/// 一个完整的 SSE 事件。所有指针仅在回调期间有效
+typedef struct {
+    const uint8_t *data;        // 事件数据（多行 data 以 \n 连接）
+    size_t dataLength;
+    const uint8_t *eventType;   // event 字段，未提供时为 NULL
+    size_t eventTypeLength;
+    const uint8_t *eventID;     // 本事件携带的 id 字段，未提供时为 NULL
+    size_t eventIDLength;
+} AIUASSEEvent;
+
+/// 事件回调，返回 false 表示停止继续分发（剩余字节保留到下一次 Feed）
+typedef bool (*AIUASSEEventCallback)(const AIUASSEEvent *event, void *context);
+
+typedef struct {
+    // 扫描状态（相对于调用方缓冲区起点的偏移）
+    size_t scanOffset;          // 下一个待扫描字节
+    size_t lineStart;           // 当前未结束行的起点
+    size_t eventStart;          // 当前未分发事件的起点（其之前的字节均可丢弃）
+    bool skipLeadingLF;         // 上一行以 CR 结尾，若紧跟 LF 需跳过
+    bool checkedBOM;            // 是否已检查流开头的 UTF-8 BOM
+
+    // 当前事件字段（偏移 + 长度，引用调用方缓冲区）
+    size_t dataOffset;
+    size_t dataLength;
+    size_t dataLineCount;
+    size_t eventTypeOffset;
+    size_t eventTypeLength;
+    bool hasEventType;
+    size_t eventIDOffset;
+    size_t eventIDLength;
+    bool hasEventID;
+
+    // 多行 data 的拼接暂存区（仅在出现多行 data 时分配）
+    uint8_t *scratch;
+    size_t scratchLength;
+    size_t scratchCapacity;
+
+    // 跨事件保留的状态
+    char lastEventID[AIUA_SSE_MAX_ID_LENGTH + 1];
+    size_t lastEventIDLength;
+    long retryMilliseconds;     // 服务端下发的 retry，未下发时为 -1
+    bool failed;                // 暂存区分配失败，解析已停止（不会分发被截断的事件）
+
+    // 统计
+    uint64_t totalBytesScanned;
+    uint64_t totalEventsDispatched;
+    uint64_t totalCommentLines;
+} AIUASSEParser;
+
+/// 初始化解析器（不分配内存）
+void AIUASSEParserInit(AIUASSEParser *parser);
+
+/// 重置为新流的初始状态，保留已分配的暂存区；keepLastEventID 为 true 时保留 lastEventID（用于续传）
+void AIUASSEParserReset(AIUASSEParser *parser, bool keepLastEventID);
+
+/// 释放解析器持有的内存
+void AIUASSEParserDestroy(AIUASSEParser *parser);
+
+/**
+ * 解析缓冲区中新到达的字节
+ * 暂存区分配失败时停止解析并置 failed，调用方应按错误结束本次流
+ * @param buffer 调用方持有的累积缓冲区（包含上次未消费的字节 + 新追加的字节）
+ * @param length 缓冲区总长度
+ * @return 可以丢弃的前缀字节数。调用方丢弃后必须调用 AIUASSEParserDidDiscard 同步偏移
+ */
+size_t AIUASSEParserFeed(AIUASSEParser *parser,
+                         const uint8_t *buffer,
+                         size_t length,
+                         AIUASSEEventCallback callback,
+                         void *context);
+
+/// 调用方从缓冲区头部丢弃 count 字节后调用，平移内部偏移
+void AIUASSEParserDidDiscard(AIUASSEParser *parser, size_t count);
+
+/**
+ * 流结束时调用：把最后一行（无换行结尾）按完整行处理，并分发尚未以空行结束的事件
+ * 规范要求丢弃未完成事件，这里为兼容不规范的上游而宽松处理
+ */
+void AIUASSEParserFinish(AIUASSEParser *parser,
+                         const uint8_t *buffer,
+                         size_t length,
+                         AIUASSEEventCallback callback,
+                         void *context);
+
+/// 判断事件数据是否等于给定的 C 字符串（例如 "[DONE]"）
+bool AIUASSEEventDataEquals(const AIUASSEEvent *event, const char *literal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUASSEParser_h */
@@ -0,0 +1,112 @@
+//
+//  AIUASegmentedGenerator.h
+//  AIUniversalAssistant
+//
+//  长文分段生成（改写、翻译）：位于界面与 AIUADeepSeekWriter 之间
+//  - 按段落切分（超长段落再按句子、最后按字符），每段不超过 token 预算，避免超出模型上下文
+//  - 各段并发请求（并发数有上限），输出按原文顺序拼接：最前面未完成的段实时流式输出，
+//    后面的段先缓存，等前面的段全部完成后再依次输出
+//  - 段与段之间保留原文的段落分隔
+//  - 可传入段落结果缓存：命中的段落不再请求，直接拼接缓存的结果
+//  - 单段失败时自动重试（该段尚未输出任何内容时）；可单独重试或取消某一段，取消的段保留原文
+//  - 对外的流式回调与 AIUADeepSeekWriter 一致，可直接交给 AIUAStreamCoalescer
+//  - 所有方法与回调都在主线程
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUADeepSeekWriter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, AIUASegmentState) {
+    AIUASegmentStatePending,    // 等待请求
+    AIUASegmentStateRunning,    // 请求中
+    AIUASegmentStateFinished,   // 已完成
+    AIUASegmentStateFailed,     // 失败（重试次数用尽）
+    AIUASegmentStateCancelled   // 已取消
+};
+
+/// 生成某一段的提示词
+typedef NSString * _Nonnull (^AIUASegmentPromptBuilder)(NSString *segmentText, NSUInteger index, NSUInteger count);
+
+/// 创建写作器（同时最多存在 maxConcurrentSegments 个，按需复用）
+typedef AIUADeepSeekWriter * _Nonnull (^AIUASegmentWriterFactory)(void);
+
+/// 段落（已去掉首尾空白）的缓存结果，未命中返回 nil
+typedef NSString * _Nullable (^AIUASegmentCachedOutputProvider)(NSString *paragraph);
+
+/// 某段生成完成（segmentText 与 output 均已去掉首尾空白）
+typedef void (^AIUASegmentOutputHandler)(NSString *segmentText, NSString *output);
+
+@interface AIUASegmentedGenerator : NSObject
+
+/// 分段后的原文（拼接后与原文一致）
+@property (nonatomic, copy, readonly) NSArray<NSString *> *segments;
+
+/// 命中缓存的段落结果
+@property (nonatomic, copy, readonly) NSArray<NSString *> *cachedOutputs;
+
+/// 需要请求的原文（未命中缓存的段拼接）
+@property (nonatomic, copy, readonly) NSString *uncachedText;
+
+/// 某段请求成功完成时回调，用于写入缓存；超长段落被拆成句子的段不回调
+@property (nonatomic, copy, nullable) AIUASegmentOutputHandler segmentOutputHandler;
+
+/// 最大并发请求数，默认 3，需在 start 前设置
+@property (nonatomic, assign) NSUInteger maxConcurrentSegments;
+
+/// 每段失败后的自动重试次数，默认 1
+@property (nonatomic, assign) NSUInteger maxRetryCount;
+
+/// 从开始到全部完成的耗时（秒）
+@property (nonatomic, assign, readonly) NSTimeInterval elapsedTime;
+
+/// 各段请求耗时之和（秒），近似于逐段串行请求的总耗时
+@property (nonatomic, assign, readonly) NSTimeInterval totalSegmentTime;
+
+/**
+ * 切分文本，拼接结果与原文一致
+ * @param tokenBudget 每段的 token 上限（按 estimatedTokensForText: 估算）
+ */
++ (NSArray<NSString *> *)segmentsOfText:(NSString *)text tokenBudget:(NSUInteger)tokenBudget;
+
+/// token 数（AIUATokenizer 计数，词表未加载时为估算值）
++ (NSUInteger)estimatedTokensForText:(NSString *)text;
+
+- (instancetype)initWithText:(NSString *)text
+                 tokenBudget:(NSUInteger)tokenBudget
+               promptBuilder:(AIUASegmentPromptBuilder)promptBuilder
+               writerFactory:(AIUASegmentWriterFactory)writerFactory;
+
+/**
+ * @param cachedOutputProvider 按段落查询缓存，命中的段落单独成段且不再请求
+ */
+- (instancetype)initWithText:(NSString *)text
+                 tokenBudget:(NSUInteger)tokenBudget
+        cachedOutputProvider:(nullable AIUASegmentCachedOutputProvider)cachedOutputProvider
+               promptBuilder:(AIUASegmentPromptBuilder)promptBuilder
+               writerFactory:(AIUASegmentWriterFactory)writerFactory NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * 开始生成（只能调用一次）
+ * @param streamHandler 按原文顺序回调新增文本；结束时 finished 为 YES，成功时 chunk 为全文；
+ *        某段最终失败时以该错误结束，整体取消时以 NSURLErrorCancelled 结束
+ */
+- (void)startWithStreamHandler:(AIUAStreamHandler)streamHandler;
+
+/// 某一段的状态
+- (AIUASegmentState)stateOfSegmentAtIndex:(NSUInteger)index;
+
+/// 重新请求某一段（该段内容尚未输出时才可重试），返回是否已重新排队
+- (BOOL)retrySegmentAtIndex:(NSUInteger)index;
+
+/// 取消某一段：尚未输出时以原文代替，已开始输出时保留已输出的部分
+- (BOOL)cancelSegmentAtIndex:(NSUInteger)index;
+
+/// 取消全部请求
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,507 @@
+//
+//  AIUASegmentedGenerator.m
+//  AIUniversalAssistant
+//
+
+#import "AIUASegmentedGenerator.h"
+#import "AIUATokenizer.h"
+
+static const NSUInteger kAIUASegmentedDefaultConcurrency = 3;
+// 输出 token 上限：约为输入的 2 倍（翻译成英文时 token 数会变多），并留出余量
+static const NSInteger kAIUASegmentedOutputTokenFactor = 2;
+static const NSInteger kAIUASegmentedOutputTokenSlack = 200;
+
+#pragma mark - 段
+
+@interface AIUAGenerationSegment : NSObject
+
+@property (nonatomic, copy) NSString *leading;      // 原文段首空白（段落分隔），原样输出
+@property (nonatomic, copy) NSString *core;         // 去掉首尾空白后交给模型的正文
+@property (nonatomic, copy) NSString *trailing;     // 原文段尾空白，原样输出
+@property (nonatomic, assign) AIUASegmentState state;
+@property (nonatomic, strong) NSMutableString *output;
+@property (nonatomic, assign) NSUInteger attempt;           // 第几次请求，过期请求的回调按此忽略
+@property (nonatomic, assign) NSUInteger deliveredLength;   // 已输出的正文长度
+@property (nonatomic, assign) BOOL leadingDelivered;
+@property (nonatomic, strong, nullable) AIUADeepSeekWriter *writer;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+@property (nonatomic, assign) NSTimeInterval duration;
+@property (nonatomic, assign) BOOL cached;      // 结果来自缓存，无需请求
+@property (nonatomic, assign) BOOL partial;     // 含超长段落拆开的部分句子（结果无法按段落缓存）
+
+@end
+
+@implementation AIUAGenerationSegment
+
+- (instancetype)initWithText:(NSString *)text {
+    self = [super init];
+    if (self) {
+        NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+        NSRange first = [text rangeOfCharacterFromSet:[whitespace invertedSet]];
+        if (first.location == NSNotFound) {
+            _leading = [text copy];
+            _core = @"";
+            _trailing = @"";
+        } else {
+            NSRange last = [text rangeOfCharacterFromSet:[whitespace invertedSet] options:NSBackwardsSearch];
+            _leading = [text substringToIndex:first.location];
+            _core = [text substringWithRange:NSMakeRange(first.location, NSMaxRange(last) - first.location)];
+            _trailing = [text substringFromIndex:NSMaxRange(last)];
+        }
+        _output = [NSMutableString string];
+        // 只有空白的段无需请求
+        _state = _core.length > 0 ? AIUASegmentStatePending : AIUASegmentStateFinished;
+    }
+    return self;
+}
+
+// 可输出的正文：模型输出去掉首尾空白（尾部空白可能只是段落还没写完，先不输出）；取消且未输出过时用原文
+- (NSString *)deliverableText {
+    if (self.state == AIUASegmentStateCancelled && self.deliveredLength == 0) {
+        return self.core;
+    }
+    return [self.output stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+}
+
+@end
+
+#pragma mark - 分段生成
+
+@interface AIUASegmentedGenerator ()
+
+@property (nonatomic, copy, readwrite) NSArray<NSString *> *segments;
+@property (nonatomic, copy, readwrite) NSArray<NSString *> *cachedOutputs;
+@property (nonatomic, copy, readwrite) NSString *uncachedText;
+@property (nonatomic, copy) AIUASegmentPromptBuilder promptBuilder;
+@property (nonatomic, copy) AIUASegmentWriterFactory writerFactory;
+@property (nonatomic, copy, nullable) AIUAStreamHandler streamHandler;
+
+@property (nonatomic, strong) NSArray<AIUAGenerationSegment *> *segmentStates;
+@property (nonatomic, strong) NSMutableArray<AIUADeepSeekWriter *> *idleWriters;
+@property (nonatomic, assign) NSUInteger writerCount;
+@property (nonatomic, assign) NSUInteger headIndex;         // 第一个尚未全部输出的段
+@property (nonatomic, strong) NSMutableString *fullOutput;
+@property (nonatomic, assign) BOOL started;
+@property (nonatomic, assign) BOOL ended;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+
+@property (nonatomic, assign, readwrite) NSTimeInterval elapsedTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval totalSegmentTime;
+
+@end
+
+@implementation AIUASegmentedGenerator
+
+#pragma mark - 切分
+
++ (NSUInteger)estimatedTokensForText:(NSString *)text {
+    return [[AIUATokenizer sharedTokenizer] countTokensInText:text];
+}
+
++ (NSArray<NSString *> *)segmentsOfText:(NSString *)text tokenBudget:(NSUInteger)tokenBudget {
+    return [self segmentsOfText:text tokenBudget:tokenBudget cachedOutputProvider:nil cachedOutputs:nil partialIndexes:nil];
+}
+
+// 按段落切分（超长段落拆成句子，超长句子按字符硬切），再按预算把相邻片段合并成段，拼接与原文一致
+// cachedOutputProvider 命中的段落单独成段，结果记入 cachedOutputs（段序号 → 输出）；
+// 含超长段落拆开的句子的段，序号记入 partialIndexes
++ (NSArray<NSString *> *)segmentsOfText:(NSString *)text
+                            tokenBudget:(NSUInteger)tokenBudget
+                   cachedOutputProvider:(AIUASegmentCachedOutputProvider)cachedOutputProvider
+                          cachedOutputs:(NSMutableDictionary<NSNumber *, NSString *> *)cachedOutputs
+                         partialIndexes:(NSMutableIndexSet *)partialIndexes {
+    if (text.length == 0) {
+        return @[];
+    }
+    tokenBudget = MAX(tokenBudget, (NSUInteger)16);
+
+    NSMutableArray<NSString *> *segments = [NSMutableArray array];
+    NSMutableString *current = [NSMutableString string];
+    __block NSUInteger currentTokens = 0;
+    __block BOOL currentPartial = NO;
+    void (^closeCurrent)(void) = ^{
+        if (current.length == 0) {
+            return;
+        }
+        if (currentPartial) {
+            [partialIndexes addIndex:segments.count];
+        }
+        [segments addObject:[current copy]];
+        [current setString:@""];
+        currentTokens = 0;
+        currentPartial = NO;
+    };
+
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    for (NSString *paragraph in [self rangesOfText:text enumerationOptions:NSStringEnumerationByParagraphs]) {
+        if (cachedOutputProvider) {
+            NSString *core = [paragraph stringByTrimmingCharactersInSet:whitespace];
+            NSString *cachedOutput = core.length > 0 ? cachedOutputProvider(core) : nil;
+            if (cachedOutput.length > 0) {
+                closeCurrent();
+                cachedOutputs[@(segments.count)] = cachedOutput;
+                [segments addObject:paragraph];
+                continue;
+            }
+        }
+
+        NSMutableArray<NSString *> *pieces = [NSMutableArray array];
+        BOOL partial = NO;
+        if ([self estimatedTokensForText:paragraph] <= tokenBudget) {
+            [pieces addObject:paragraph];
+        } else {
+            partial = YES;
+            for (NSString *sentence in [self rangesOfText:paragraph enumerationOptions:NSStringEnumerationBySentences]) {
+                if ([self estimatedTokensForText:sentence] <= tokenBudget) {
+                    [pieces addObject:sentence];
+                } else {
+                    [pieces addObjectsFromArray:[self hardSplitText:sentence tokenBudget:tokenBudget]];
+                }
+            }
+        }
+        for (NSString *piece in pieces) {
+            NSUInteger tokens = [self estimatedTokensForText:piece];
+            if (current.length > 0 && currentTokens + tokens > tokenBudget) {
+                closeCurrent();
+            }
+            [current appendString:piece];
+            currentTokens += tokens;
+            currentPartial = currentPartial || partial;
+        }
+    }
+    closeCurrent();
+    return segments;
+}
+
+// 按段落/句子切分，每一片从上一片结尾开始，保证覆盖全文（含分隔符与空白）
++ (NSArray<NSString *> *)rangesOfText:(NSString *)text enumerationOptions:(NSStringEnumerationOptions)options {
+    NSMutableArray<NSString *> *parts = [NSMutableArray array];
+    __block NSUInteger cut = 0;
+    [text enumerateSubstringsInRange:NSMakeRange(0, text.length)
+                             options:options | NSStringEnumerationSubstringNotRequired
+                          usingBlock:^(NSString *substring, NSRange substringRange, NSRange enclosingRange, BOOL *stop) {
+        NSUInteger end = NSMaxRange(enclosingRange);
+        if (end > cut) {
+            [parts addObject:[text substringWithRange:NSMakeRange(cut, end - cut)]];
+            cut = end;
+        }
+    }];
+    if (cut < text.length) {
+        [parts addObject:[text substringFromIndex:cut]];
+    }
+    return parts;
+}
+
+// 按字符簇硬切，不拆开代理对和组合字符
++ (NSArray<NSString *> *)hardSplitText:(NSString *)text tokenBudget:(NSUInteger)tokenBudget {
+    NSMutableArray<NSString *> *parts = [NSMutableArray array];
+    NSUInteger location = 0;
+    while (location < text.length) {
+        NSUInteger length = MIN(tokenBudget, text.length - location);
+        NSRange range = [text rangeOfComposedCharacterSequencesForRange:NSMakeRange(location, length)];
+        // ASCII 文本按 4 字符 1 token 估算，可以放得更长
+        while (NSMaxRange(range) < text.length &&
+               [self estimatedTokensForText:[text substringWithRange:range]] * 2 < tokenBudget) {
+            range = [text rangeOfComposedCharacterSequencesForRange:NSMakeRange(range.location, MIN(range.length * 2, text.length - range.location))];
+        }
+        [parts addObject:[text substringWithRange:range]];
+        location = NSMaxRange(range);
+    }
+    return parts;
+}
+
+#pragma mark - 初始化
+
+- (instancetype)initWithText:(NSString *)text
+                 tokenBudget:(NSUInteger)tokenBudget
+               promptBuilder:(AIUASegmentPromptBuilder)promptBuilder
+               writerFactory:(AIUASegmentWriterFactory)writerFactory {
+    return [self initWithText:text tokenBudget:tokenBudget cachedOutputProvider:nil promptBuilder:promptBuilder writerFactory:writerFactory];
+}
+
+- (instancetype)initWithText:(NSString *)text
+                 tokenBudget:(NSUInteger)tokenBudget
+        cachedOutputProvider:(AIUASegmentCachedOutputProvider)cachedOutputProvider
+               promptBuilder:(AIUASegmentPromptBuilder)promptBuilder
+               writerFactory:(AIUASegmentWriterFactory)writerFactory {
+    self = [super init];
+    if (self) {
+        NSMutableDictionary<NSNumber *, NSString *> *cachedOutputs = [NSMutableDictionary dictionary];
+        NSMutableIndexSet *partialIndexes = [NSMutableIndexSet indexSet];
+        _segments = [[AIUASegmentedGenerator segmentsOfText:text ?: @""
+                                                tokenBudget:tokenBudget
+                                       cachedOutputProvider:cachedOutputProvider
+                                              cachedOutputs:cachedOutputs
+                                             partialIndexes:partialIndexes] copy];
+        NSMutableArray<AIUAGenerationSegment *> *states = [NSMutableArray arrayWithCapacity:_segments.count];
+        NSMutableArray<NSString *> *cachedTexts = [NSMutableArray array];
+        NSMutableString *uncachedText = [NSMutableString string];
+        [_segments enumerateObjectsUsingBlock:^(NSString *segmentText, NSUInteger index, BOOL *stop) {
+            AIUAGenerationSegment *segment = [[AIUAGenerationSegment alloc] initWithText:segmentText];
+            segment.partial = [partialIndexes containsIndex:index];
+            NSString *cachedOutput = cachedOutputs[@(index)];
+            if (cachedOutput) {
+                segment.cached = YES;
+                segment.state = AIUASegmentStateFinished;
+                [segment.output setString:cachedOutput];
+                [cachedTexts addObject:cachedOutput];
+            } else {
+                [uncachedText appendString:segmentText];
+            }
+            [states addObject:segment];
+        }];
+        _segmentStates = [states copy];
+        _cachedOutputs = [cachedTexts copy];
+        _uncachedText = [uncachedText copy];
+        _promptBuilder = [promptBuilder copy];
+        _writerFactory = [writerFactory copy];
+        _idleWriters = [NSMutableArray array];
+        _fullOutput = [NSMutableString string];
+        _maxConcurrentSegments = kAIUASegmentedDefaultConcurrency;
+        _maxRetryCount = 1;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (AIUAGenerationSegment *segment in _segmentStates) {
+        [segment.writer cancelCurrentRequest];
+    }
+}
+
+#pragma mark - 调度
+
+- (void)startWithStreamHandler:(AIUAStreamHandler)streamHandler {
+    if (self.started) {
+        return;
+    }
+    self.started = YES;
+    self.streamHandler = streamHandler;
+    self.startTime = CFAbsoluteTimeGetCurrent();
+    NSLog(@"[SegmentedGen] 开始：%lu 段（缓存命中 %lu 段），并发 %lu", (unsigned long)self.segments.count, (unsigned long)self.cachedOutputs.count, (unsigned long)self.maxConcurrentSegments);
+    [self startPendingSegments];
+    [self deliverInOrder];
+}
+
+// 按原文顺序优先启动，保证最前面的段尽早开始输出
+- (void)startPendingSegments {
+    if (self.ended) {
+        return;
+    }
+    NSUInteger running = 0;
+    for (AIUAGenerationSegment *segment in self.segmentStates) {
+        if (segment.state == AIUASegmentStateRunning) {
+            running++;
+        }
+    }
+    for (NSUInteger index = self.headIndex; index < self.segmentStates.count && running < MAX(self.maxConcurrentSegments, (NSUInteger)1); index++) {
+        AIUAGenerationSegment *segment = self.segmentStates[index];
+        if (segment.state == AIUASegmentStatePending) {
+            [self runSegmentAtIndex:index];
+            running++;
+        }
+    }
+}
+
+- (void)runSegmentAtIndex:(NSUInteger)index {
+    AIUAGenerationSegment *segment = self.segmentStates[index];
+    segment.state = AIUASegmentStateRunning;
+    segment.attempt += 1;
+    [segment.output setString:@""];
+    segment.startTime = CFAbsoluteTimeGetCurrent();
+    segment.writer = [self dequeueWriter];
+
+    NSString *prompt = self.promptBuilder(segment.core, index, self.segmentStates.count);
+    NSInteger maxTokens = (NSInteger)[AIUASegmentedGenerator estimatedTokensForText:segment.core] * kAIUASegmentedOutputTokenFactor + kAIUASegmentedOutputTokenSlack;
+    NSUInteger attempt = segment.attempt;
+    __weak typeof(self) wself = self;
+    [segment.writer generateFullStreamWritingWithPrompt:prompt maxTokens:maxTokens streamHandler:^(NSString *chunk, BOOL finished, NSError * _Nullable error) {
+        __strong typeof(wself) sself = wself;
+        [sself segmentAtIndex:index attempt:attempt didReceiveChunk:chunk finished:finished error:error];
+    }];
+}
+
+- (AIUADeepSeekWriter *)dequeueWriter {
+    AIUADeepSeekWriter *writer = self.idleWriters.lastObject;
+    if (writer) {
+        [self.idleWriters removeLastObject];
+        return writer;
+    }
+    self.writerCount += 1;
+    return self.writerFactory();
+}
+
+- (void)recycleWriterOfSegment:(AIUAGenerationSegment *)segment {
+    if (!segment.writer) {
+        return;
+    }
+    [segment.writer cancelCurrentRequest];
+    [self.idleWriters addObject:segment.writer];
+    segment.writer = nil;
+}
+
+- (void)segmentAtIndex:(NSUInteger)index attempt:(NSUInteger)attempt didReceiveChunk:(NSString *)chunk finished:(BOOL)finished error:(NSError *)error {
+    if (self.ended || index >= self.segmentStates.count) {
+        return;
+    }
+    AIUAGenerationSegment *segment = self.segmentStates[index];
+    // 已重试/取消的旧请求仍可能回调，忽略
+    if (segment.attempt != attempt || segment.state != AIUASegmentStateRunning) {
+        return;
+    }
+
+    if (error) {
+        [self recycleWriterOfSegment:segment];
+        segment.duration += CFAbsoluteTimeGetCurrent() - segment.startTime;
+        // 该段还没有输出过内容时才能重试，否则重新生成的内容会与已输出的部分重复
+        if (segment.deliveredLength == 0 && segment.attempt <= self.maxRetryCount) {
+            NSLog(@"[SegmentedGen] 第 %lu 段失败，重试：%@", (unsigned long)index, error.localizedDescription);
+            segment.state = AIUASegmentStatePending;
+            [self startPendingSegments];
+            return;
+        }
+        NSLog(@"[SegmentedGen] 第 %lu 段失败：%@", (unsigned long)index, error.localizedDescription);
+        segment.state = AIUASegmentStateFailed;
+        [self endWithError:error];
+        return;
+    }
+
+    // 结束回调携带的是全文，增量已在之前的回调中收到
+    if (!finished) {
+        [segment.output appendString:chunk ?: @""];
+    } else {
+        segment.state = AIUASegmentStateFinished;
+        segment.duration += CFAbsoluteTimeGetCurrent() - segment.startTime;
+        [self recycleWriterOfSegment:segment];
+        if (self.segmentOutputHandler && !segment.partial) {
+            self.segmentOutputHandler(segment.core, [segment deliverableText]);
+        }
+        [self startPendingSegments];
+    }
+    [self deliverInOrder];
+}
+
+#pragma mark - 按序输出
+
+- (void)deliverInOrder {
+    if (self.ended) {
+        return;
+    }
+    NSMutableString *delta = [NSMutableString string];
+    while (self.headIndex < self.segmentStates.count) {
+        AIUAGenerationSegment *segment = self.segmentStates[self.headIndex];
+        if (segment.state == AIUASegmentStatePending || segment.state == AIUASegmentStateFailed) {
+            break;
+        }
+        if (!segment.leadingDelivered) {
+            [delta appendString:segment.leading];
+            segment.leadingDelivered = YES;
+        }
+        NSString *text = [segment deliverableText];
+        if (text.length > segment.deliveredLength) {
+            [delta appendString:[text substringFromIndex:segment.deliveredLength]];
+            segment.deliveredLength = text.length;
+        }
+        if (segment.state == AIUASegmentStateRunning) {
+            break;
+        }
+        [delta appendString:segment.trailing];
+        self.headIndex += 1;
+    }
+
+    if (delta.length > 0) {
+        [self.fullOutput appendString:delta];
+        if (self.streamHandler) {
+            self.streamHandler([delta copy], NO, nil);
+        }
+    }
+    if (self.headIndex >= self.segmentStates.count) {
+        [self endWithError:nil];
+    }
+}
+
+- (void)endWithError:(NSError *)error {
+    if (self.ended) {
+        return;
+    }
+    self.ended = YES;
+    for (AIUAGenerationSegment *segment in self.segmentStates) {
+        if (segment.state == AIUASegmentStateRunning) {
+            segment.state = AIUASegmentStateCancelled;
+        }
+        [self recycleWriterOfSegment:segment];
+    }
+
+    self.elapsedTime = CFAbsoluteTimeGetCurrent() - self.startTime;
+    NSTimeInterval total = 0;
+    for (AIUAGenerationSegment *segment in self.segmentStates) {
+        total += segment.duration;
+    }
+    self.totalSegmentTime = total;
+    NSLog(@"[SegmentedGen] 结束 error=%@ 段数=%lu 写作器=%lu 总耗时=%.2fs 各段耗时之和=%.2fs（约为单请求串行耗时）",
+          error.localizedDescription ?: @"nil", (unsigned long)self.segmentStates.count, (unsigned long)self.writerCount,
+          self.elapsedTime, self.totalSegmentTime);
+
+    AIUAStreamHandler handler = self.streamHandler;
+    self.streamHandler = nil;
+    if (handler) {
+        handler(error ? @"" : [self.fullOutput copy], YES, error);
+    }
+}
+
+#pragma mark - 单段控制
+
+- (AIUASegmentState)stateOfSegmentAtIndex:(NSUInteger)index {
+    if (index >= self.segmentStates.count) {
+        return AIUASegmentStateCancelled;
+    }
+    return self.segmentStates[index].state;
+}
+
+- (BOOL)retrySegmentAtIndex:(NSUInteger)index {
+    if (self.ended || index >= self.segmentStates.count) {
+        return NO;
+    }
+    AIUAGenerationSegment *segment = self.segmentStates[index];
+    // 已输出过内容（包括取消后按原文输出）的段不能重试，否则会重复
+    if (segment.deliveredLength > 0 || segment.core.length == 0 ||
+        (segment.state != AIUASegmentStateRunning && segment.state != AIUASegmentStateCancelled)) {
+        return NO;
+    }
+    if (segment.state == AIUASegmentStateRunning) {
+        segment.duration += CFAbsoluteTimeGetCurrent() - segment.startTime;
+        [self recycleWriterOfSegment:segment];
+    }
+    // 旧请求的回调会因状态或 attempt 不一致被忽略
+    segment.state = AIUASegmentStatePending;
+    [self startPendingSegments];
+    return YES;
+}
+
+- (BOOL)cancelSegmentAtIndex:(NSUInteger)index {
+    if (self.ended || index >= self.segmentStates.count) {
+        return NO;
+    }
+    AIUAGenerationSegment *segment = self.segmentStates[index];
+    if (segment.state != AIUASegmentStatePending && segment.state != AIUASegmentStateRunning) {
+        return NO;
+    }
+    if (segment.state == AIUASegmentStateRunning) {
+        segment.duration += CFAbsoluteTimeGetCurrent() - segment.startTime;
+        [self recycleWriterOfSegment:segment];
+    }
+    segment.state = AIUASegmentStateCancelled;
+    [self startPendingSegments];
+    [self deliverInOrder];
+    return YES;
+}
+
+- (void)cancel {
+    if (!self.started) {
+        self.ended = YES;
+        return;
+    }
+    [self endWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+}
+
+@end
@@ -0,0 +1,54 @@
+//
+//  AIUAStreamCoalescer.h
+//  AIUniversalAssistant
+//
+//  流式输出的合帧投递层：位于 AIUADeepSeekWriter 与界面之间
+//  - 把高频到达的 chunk 合并，按帧预算（默认 33ms）最多每帧向界面投递一次
+//  - 投递内容只包含新增的文本（append-only），结束回调只携带尚未投递的尾部
+//  - 所有状态与回调都在主线程
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUADeepSeekWriter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// 默认帧预算（约 30fps）
+extern const NSTimeInterval AIUAStreamCoalescerDefaultFrameBudget;
+
+/**
+ * 合帧后的投递回调（主线程）
+ * @param delta 自上次投递以来新增的文本，可能为空串
+ * @param finished 是否结束
+ * @param error 错误（错误前会先投递已缓存的文本）
+ */
+typedef void(^AIUAStreamDeliveryHandler)(NSString *delta, BOOL finished, NSError * _Nullable error);
+
+@interface AIUAStreamCoalescer : NSObject
+
+/// 帧预算（秒），例如 1/60.0 或 1/30.0
+@property (nonatomic, assign) NSTimeInterval frameBudget;
+
+/// 统计：收到的 chunk 数
+@property (nonatomic, assign, readonly) NSUInteger chunksIn;
+/// 统计：向界面投递的批次数
+@property (nonatomic, assign, readonly) NSUInteger batchesOut;
+/// 统计：被合并到同一批次的字节数（UTF-8，不含每批的第一个 chunk）
+@property (nonatomic, assign, readonly) NSUInteger bytesCoalesced;
+
+- (instancetype)initWithFrameBudget:(NSTimeInterval)frameBudget
+                    deliveryHandler:(AIUAStreamDeliveryHandler)deliveryHandler NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 交给 AIUADeepSeekWriter 的流式回调，可在任意线程调用
+- (AIUAStreamHandler)streamHandler;
+
+/// 立即投递已缓存的文本（主线程调用）
+- (void)flush;
+
+/// 丢弃缓存并忽略之后到达的 chunk（停止生成 / 重新生成 / 页面销毁时调用）
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
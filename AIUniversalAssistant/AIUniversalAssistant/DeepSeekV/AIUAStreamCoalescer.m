@@ -0,0 +1,135 @@
+//
+//  AIUAStreamCoalescer.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAStreamCoalescer.h"
+#import <QuartzCore/QuartzCore.h>
+
+const NSTimeInterval AIUAStreamCoalescerDefaultFrameBudget = 1.0 / 30.0;
+
+@interface AIUAStreamCoalescer ()
+
+@property (nonatomic, copy) AIUAStreamDeliveryHandler deliveryHandler;
+@property (nonatomic, strong) NSMutableString *pendingText;
+@property (nonatomic, assign) NSUInteger pendingChunkCount;
+@property (nonatomic, assign) CFTimeInterval lastDeliveryTime;
+@property (nonatomic, assign) BOOL flushScheduled;
+@property (nonatomic, assign) BOOL invalidated;
+
+@property (nonatomic, assign, readwrite) NSUInteger chunksIn;
+@property (nonatomic, assign, readwrite) NSUInteger batchesOut;
+@property (nonatomic, assign, readwrite) NSUInteger bytesCoalesced;
+
+@end
+
+@implementation AIUAStreamCoalescer
+
+- (instancetype)initWithFrameBudget:(NSTimeInterval)frameBudget
+                    deliveryHandler:(AIUAStreamDeliveryHandler)deliveryHandler {
+    self = [super init];
+    if (self) {
+        _frameBudget = frameBudget > 0 ? frameBudget : AIUAStreamCoalescerDefaultFrameBudget;
+        _deliveryHandler = [deliveryHandler copy];
+        _pendingText = [NSMutableString string];
+    }
+    return self;
+}
+
+- (AIUAStreamHandler)streamHandler {
+    __weak typeof(self) weakSelf = self;
+    return ^(NSString *chunk, BOOL finished, NSError * _Nullable error) {
+        if ([NSThread isMainThread]) {
+            [weakSelf receiveChunk:chunk finished:finished error:error];
+        } else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf receiveChunk:chunk finished:finished error:error];
+            });
+        }
+    };
+}
+
+#pragma mark - 接收
+
+- (void)receiveChunk:(NSString *)chunk finished:(BOOL)finished error:(NSError *)error {
+    if (self.invalidated) {
+        return;
+    }
+    
+    if (error || finished) {
+        // 结束时 writer 传入的是全文，这里只投递尚未投递的尾部
+        [self flush];
+        self.invalidated = YES;
+        NSLog(@"[StreamCoalescer] 结束 chunksIn=%lu batchesOut=%lu bytesCoalesced=%lu",
+              (unsigned long)self.chunksIn,
+              (unsigned long)self.batchesOut,
+              (unsigned long)self.bytesCoalesced);
+        if (self.deliveryHandler) {
+            self.deliveryHandler(@"", YES, error);
+        }
+        return;
+    }
+    
+    if (chunk.length == 0) {
+        return;
+    }
+    
+    self.chunksIn += 1;
+    if (self.pendingChunkCount > 0) {
+        self.bytesCoalesced += [chunk lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    }
+    [self.pendingText appendString:chunk];
+    self.pendingChunkCount += 1;
+    [self scheduleFlushIfNeeded];
+}
+
+#pragma mark - 投递
+
+- (void)scheduleFlushIfNeeded {
+    if (self.flushScheduled) {
+        return;
+    }
+    
+    // 距上次投递已超过一帧时立即投递（首个 chunk 不额外延迟），否则等到本帧结束
+    CFTimeInterval now = CACurrentMediaTime();
+    CFTimeInterval delay = self.lastDeliveryTime + self.frameBudget - now;
+    if (delay <= 0) {
+        [self flush];
+        return;
+    }
+    
+    self.flushScheduled = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        strongSelf.flushScheduled = NO;
+        [strongSelf flush];
+    });
+}
+
+- (void)flush {
+    if (self.invalidated || self.pendingText.length == 0) {
+        return;
+    }
+    
+    NSString *delta = [self.pendingText copy];
+    [self.pendingText setString:@""];
+    self.pendingChunkCount = 0;
+    self.batchesOut += 1;
+    self.lastDeliveryTime = CACurrentMediaTime();
+    
+    if (self.deliveryHandler) {
+        self.deliveryHandler(delta, NO, nil);
+    }
+}
+
+- (void)invalidate {
+    self.invalidated = YES;
+    [self.pendingText setString:@""];
+    self.pendingChunkCount = 0;
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  AIUATokenizer.h
+//  AIUniversalAssistant
+//
+//  本地 token 计数（AIUABPETokenizer 的 Objective-C 封装）
+//  - 词表使用 DeepSeek 发布的 tokenizer.json（以 AIUADeepSeekTokenizer.json 加入应用包），首次使用时在后台
+//    编译为二进制表缓存到 Caches，之后直接内存映射，不再解析 JSON
+//  - 预分词正则从 tokenizer.json 的 pre_tokenizer 读取，与服务端分词一致
+//  - 词表未就绪时按 DeepSeek 官方换算估算：1 个中文字符约 0.6 token，1 个英文字符约 0.3 token
+//  - 输出预算按实际生成内容校准：记录生成内容的 token 数与字数之比，按目标字数换算 max_tokens
+//  - 线程安全
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUATokenizer : NSObject
+
++ (instancetype)sharedTokenizer;
+
+/// 词表已加载，计数为精确值
+@property (nonatomic, assign, readonly, getter=isExact) BOOL exact;
+
+/// 在后台加载词表（创建共享实例时自动调用，可重复调用）
+- (void)prepare;
+
+/// 文本的 token 数
+- (NSUInteger)countTokensInText:(nullable NSString *)text;
+
+/**
+ * 对话请求的输入 token 数（按 DeepSeek 对话模板计入开始标记与角色标记）
+ * @param messages 每个元素为 @{@"role": ..., @"content": ...}
+ */
+- (NSUInteger)countPromptTokensForMessages:(NSArray<NSDictionary<NSString *, NSString *> *> *)messages;
+
+/// 生成约 wordCount 字内容所需的输出 token 上限（按校准后的 token/字 比例，留出超写余量）
+- (NSInteger)outputTokenBudgetForWordCount:(NSInteger)wordCount;
+
+/// 记录一次完整生成的内容，用于校准 token/字 比例（后台计算）
+- (void)recordGeneratedText:(nullable NSString *)text;
+
+@end
+
+NS_ASSUME_NONNULL_END
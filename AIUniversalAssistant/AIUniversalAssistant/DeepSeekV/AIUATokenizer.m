@@ -0,0 +1,453 @@
+//
+//  AIUATokenizer.m
+//  AIUniversalAssistant
+//
+
+#import "AIUATokenizer.h"
+#import "AIUABPETokenizer.h"
+#import "AIUAWordCounter.h"
+
+// 应用包中的词表文件名（DeepSeek tokenizer.json）
+static NSString * const kAIUATokenizerResourceName = @"AIUADeepSeekTokenizer";
+// 编译后的二进制表与预分词规则缓存
+static NSString * const kAIUATokenizerCacheDirectory = @"AIUATokenizer";
+
+// 词表未就绪时的估算（DeepSeek 官方换算）
+static const double kAIUATokenizerCJKTokensPerChar = 0.6;
+static const double kAIUATokenizerASCIITokensPerChar = 0.3;
+
+// 输出预算：token/字 比例的初始值与校准参数
+static NSString * const kAIUATokenizerRatioDefaultsKey = @"AIUATokenizerTokensPerWord";
+static const double kAIUATokenizerDefaultTokensPerWord = 0.6;
+static const double kAIUATokenizerRatioSmoothing = 0.2;         // 新样本权重
+static const NSUInteger kAIUATokenizerMinCalibrationWords = 50; // 太短的内容不参与校准
+// 模型常比要求字数多写一些，max_tokens 只是上限，预留不足会截断成半篇、需要再请求续写
+static const double kAIUATokenizerOutputMargin = 1.3;
+static const NSInteger kAIUATokenizerOutputSlack = 32;
+
+// 预分词片段在栈上转换为 UTF-8 的缓冲区大小
+static const NSUInteger kAIUATokenizerStackBufferLength = 1024;
+
+@interface AIUATokenizer ()
+
+// 以下在 @synchronized (self) 内访问
+@property (nonatomic, assign) BOOL loading;
+@property (nonatomic, strong, nullable) NSData *tableData;   // 内存映射的二进制表
+@property (nonatomic, copy, nullable) NSArray<NSRegularExpression *> *splitters;
+@property (nonatomic, assign) BOOL normalizesNFC;
+
+@property (nonatomic, strong) dispatch_queue_t calibrationQueue;
+
+@end
+
+@implementation AIUATokenizer {
+    AIUABPETokenizer *_tokenizer;
+}
+
++ (instancetype)sharedTokenizer {
+    static AIUATokenizer *sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedInstance = [[self alloc] init];
+        [sharedInstance prepare];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _calibrationQueue = dispatch_queue_create("com.aiua.tokenizer.calibration", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AIUABPETokenizerDestroy(_tokenizer);
+}
+
+- (BOOL)isExact {
+    @synchronized (self) {
+        return _tokenizer != NULL;
+    }
+}
+
+#pragma mark - 加载
+
+- (void)prepare {
+    @synchronized (self) {
+        if (self.loading || _tokenizer) {
+            return;
+        }
+        self.loading = YES;
+    }
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [self loadTables];
+        @synchronized (self) {
+            self.loading = NO;
+        }
+    });
+}
+
+- (void)loadTables {
+    NSString *jsonPath = [[NSBundle mainBundle] pathForResource:kAIUATokenizerResourceName ofType:@"json"];
+    if (!jsonPath) {
+        NSLog(@"[Tokenizer] 应用包中没有 %@.json，token 数按字符估算", kAIUATokenizerResourceName);
+        return;
+    }
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:jsonPath error:nil];
+    // 词表更新（大小或修改时间变化）后重新编译
+    NSString *cacheKey = [NSString stringWithFormat:@"%llu-%.0f",
+                          [attributes[NSFileSize] unsignedLongLongValue],
+                          [attributes[NSFileModificationDate] timeIntervalSince1970]];
+    NSString *cacheDirectory = [[NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject]
+                                stringByAppendingPathComponent:kAIUATokenizerCacheDirectory];
+    NSString *tablePath = [cacheDirectory stringByAppendingPathComponent:[cacheKey stringByAppendingPathExtension:@"bin"]];
+    NSString *rulesPath = [cacheDirectory stringByAppendingPathComponent:[cacheKey stringByAppendingPathExtension:@"plist"]];
+
+    BOOL compiled = NO;
+    NSDictionary *rules = [NSDictionary dictionaryWithContentsOfFile:rulesPath];
+    NSData *table = [NSData dataWithContentsOfFile:tablePath options:NSDataReadingMappedAlways error:nil];
+    AIUABPETokenizer *tokenizer = (rules && table) ? AIUABPETokenizerCreate(table.bytes, table.length) : NULL;
+    if (!tokenizer) {
+        [[NSFileManager defaultManager] removeItemAtPath:cacheDirectory error:nil];
+        [[NSFileManager defaultManager] createDirectoryAtPath:cacheDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+        if (![self compileTokenizerJSONAtPath:jsonPath tablePath:tablePath rulesPath:rulesPath]) {
+            return;
+        }
+        compiled = YES;
+        rules = [NSDictionary dictionaryWithContentsOfFile:rulesPath];
+        table = [NSData dataWithContentsOfFile:tablePath options:NSDataReadingMappedAlways error:nil];
+        tokenizer = (rules && table) ? AIUABPETokenizerCreate(table.bytes, table.length) : NULL;
+        if (!tokenizer) {
+            NSLog(@"[Tokenizer] 二进制表无效，token 数按字符估算");
+            return;
+        }
+    }
+
+    NSMutableArray<NSRegularExpression *> *splitters = [NSMutableArray array];
+    for (NSString *pattern in rules[@"splitPatterns"]) {
+        NSError *error = nil;
+        NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern options:0 error:&error];
+        if (!regex) {
+            NSLog(@"[Tokenizer] 预分词正则无效 %@: %@", pattern, error.localizedDescription);
+            AIUABPETokenizerDestroy(tokenizer);
+            return;
+        }
+        [splitters addObject:regex];
+    }
+
+    @synchronized (self) {
+        self.tableData = table;
+        self.splitters = splitters;
+        self.normalizesNFC = [rules[@"normalizesNFC"] boolValue];
+        _tokenizer = tokenizer;
+    }
+    NSLog(@"[Tokenizer] 词表已加载 vocab=%u splitters=%lu compiled=%d table=%luKB %.0fms",
+          AIUABPETokenizerGetVocabSize(tokenizer), (unsigned long)splitters.count, compiled,
+          (unsigned long)(table.length / 1024), (CFAbsoluteTimeGetCurrent() - start) * 1000.0);
+}
+
+#pragma mark - 编译 tokenizer.json
+
+// 字节级 BPE 把每个字节映射为一个可见字符（GPT-2 bytes_to_unicode），这里建立反向映射
+static void AIUATokenizerBuildByteDecoder(int16_t decoder[512]) {
+    for (int i = 0; i < 512; i++) {
+        decoder[i] = -1;
+    }
+    int extra = 0;
+    for (int byte = 0; byte < 256; byte++) {
+        BOOL printable = (byte >= '!' && byte <= '~') || (byte >= 0xA1 && byte <= 0xAC) || (byte >= 0xAE && byte <= 0xFF);
+        int codepoint = printable ? byte : 256 + extra++;
+        decoder[codepoint] = (int16_t)byte;
+    }
+}
+
+static BOOL AIUATokenizerDecodeTokenString(NSString *token, const int16_t decoder[512], NSMutableData *bytes) {
+    [bytes setLength:0];
+    NSUInteger length = token.length;
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = [token characterAtIndex:i];
+        if (c >= 512 || decoder[c] < 0) {
+            return NO;
+        }
+        uint8_t byte = (uint8_t)decoder[c];
+        [bytes appendBytes:&byte length:1];
+    }
+    return YES;
+}
+
+// 收集 pre_tokenizer 中的切分正则；不支持的配置返回 NO
++ (BOOL)collectSplitPatternsFromPreTokenizer:(NSDictionary *)preTokenizer into:(NSMutableArray<NSString *> *)patterns {
+    if (![preTokenizer isKindOfClass:[NSDictionary class]]) {
+        return preTokenizer == nil || [preTokenizer isKindOfClass:[NSNull class]];
+    }
+    NSString *type = preTokenizer[@"type"];
+    if ([type isEqualToString:@"Sequence"]) {
+        for (NSDictionary *child in preTokenizer[@"pretokenizers"]) {
+            if (![self collectSplitPatternsFromPreTokenizer:child into:patterns]) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+    if ([type isEqualToString:@"Split"]) {
+        NSDictionary *pattern = preTokenizer[@"pattern"];
+        NSString *regex = pattern[@"Regex"];
+        NSString *literal = pattern[@"String"];
+        if ([preTokenizer[@"invert"] boolValue] || ![preTokenizer[@"behavior"] isEqualToString:@"Isolated"]) {
+            return NO;
+        }
+        if ([regex isKindOfClass:[NSString class]]) {
+            [patterns addObject:regex];
+        } else if ([literal isKindOfClass:[NSString class]]) {
+            [patterns addObject:[NSRegularExpression escapedPatternForString:literal]];
+        } else {
+            return NO;
+        }
+        return YES;
+    }
+    if ([type isEqualToString:@"ByteLevel"]) {
+        if ([preTokenizer[@"add_prefix_space"] boolValue]) {
+            return NO;
+        }
+        if ([preTokenizer[@"use_regex"] boolValue]) {
+            // GPT-2 的默认切分
+            [patterns addObject:@"'s|'t|'re|'ve|'m|'ll|'d| ?\\p{L}+| ?\\p{N}+| ?[^\\s\\p{L}\\p{N}]+|\\s+(?!\\S)|\\s+"];
+        }
+        return YES;
+    }
+    return NO;
+}
+
+- (BOOL)compileTokenizerJSONAtPath:(NSString *)jsonPath tablePath:(NSString *)tablePath rulesPath:(NSString *)rulesPath {
+    NSData *data = [NSData dataWithContentsOfFile:jsonPath options:NSDataReadingMappedIfSafe error:nil];
+    NSDictionary *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    NSDictionary *model = [json isKindOfClass:[NSDictionary class]] ? json[@"model"] : nil;
+    if (![model isKindOfClass:[NSDictionary class]]) {
+        model = nil;
+    }
+    NSDictionary *vocab = model[@"vocab"];
+    NSArray *merges = model[@"merges"];
+    if (![model[@"type"] isEqual:@"BPE"] || ![vocab isKindOfClass:[NSDictionary class]] || ![merges isKindOfClass:[NSArray class]]) {
+        NSLog(@"[Tokenizer] tokenizer.json 不是 BPE 模型，token 数按字符估算");
+        return NO;
+    }
+
+    NSMutableArray<NSString *> *patterns = [NSMutableArray array];
+    if (![AIUATokenizer collectSplitPatternsFromPreTokenizer:json[@"pre_tokenizer"] into:patterns]) {
+        NSLog(@"[Tokenizer] 不支持的 pre_tokenizer 配置，token 数按字符估算");
+        return NO;
+    }
+    BOOL normalizesNFC = NO;
+    NSDictionary *normalizer = json[@"normalizer"];
+    if ([normalizer isKindOfClass:[NSDictionary class]]) {
+        if (![normalizer[@"type"] isEqualToString:@"NFC"]) {
+            NSLog(@"[Tokenizer] 不支持的 normalizer %@，token 数按字符估算", normalizer[@"type"]);
+            return NO;
+        }
+        normalizesNFC = YES;
+    }
+
+    uint32_t vocabSize = 0;
+    for (NSNumber *tokenID in vocab.objectEnumerator) {
+        vocabSize = MAX(vocabSize, tokenID.unsignedIntValue + 1);
+    }
+    AIUABPETokenizerBuilder *builder = AIUABPETokenizerBuilderCreate(vocabSize);
+    if (!builder) {
+        return NO;
+    }
+    AIUABPETokenizerBuilderSetIgnoreMerges(builder, [model[@"ignore_merges"] boolValue]);
+
+    int16_t decoder[512];
+    AIUATokenizerBuildByteDecoder(decoder);
+    NSMutableData *bytes = [NSMutableData data];
+    __block BOOL success = YES;
+    [vocab enumerateKeysAndObjectsUsingBlock:^(NSString *token, NSNumber *tokenID, BOOL *stop) {
+        // 无法还原为字节的（特殊 token）不参与普通文本编码
+        if (AIUATokenizerDecodeTokenString(token, decoder, bytes) &&
+            !AIUABPETokenizerBuilderSetToken(builder, tokenID.unsignedIntValue, bytes.bytes, bytes.length)) {
+            success = NO;
+            *stop = YES;
+        }
+    }];
+
+    NSUInteger skipped = 0;
+    for (id merge in merges) {
+        if (!success) {
+            break;
+        }
+        // 两种格式："左 右" 或 ["左", "右"]
+        NSString *left = nil;
+        NSString *right = nil;
+        if ([merge isKindOfClass:[NSString class]]) {
+            NSRange space = [merge rangeOfString:@" "];
+            if (space.location != NSNotFound) {
+                left = [merge substringToIndex:space.location];
+                right = [merge substringFromIndex:NSMaxRange(space)];
+            }
+        } else if ([merge isKindOfClass:[NSArray class]] && [merge count] == 2) {
+            left = merge[0];
+            right = merge[1];
+        }
+        NSNumber *leftID = left ? vocab[left] : nil;
+        NSNumber *rightID = right ? vocab[right] : nil;
+        NSNumber *mergedID = (left && right) ? vocab[[left stringByAppendingString:right]] : nil;
+        if (!leftID || !rightID || !mergedID) {
+            skipped++;
+            continue;
+        }
+        success = AIUABPETokenizerBuilderAddMerge(builder, leftID.unsignedIntValue, rightID.unsignedIntValue, mergedID.unsignedIntValue);
+    }
+
+    uint8_t *table = NULL;
+    size_t tableLength = 0;
+    success = success && AIUABPETokenizerBuilderFinish(builder, &table, &tableLength);
+    AIUABPETokenizerBuilderDestroy(builder);
+    if (!success) {
+        NSLog(@"[Tokenizer] 编译词表失败（内存不足），token 数按字符估算");
+        return NO;
+    }
+    NSData *tableData = [NSData dataWithBytesNoCopy:table length:tableLength freeWhenDone:YES];
+    NSDictionary *rules = @{@"splitPatterns": patterns, @"normalizesNFC": @(normalizesNFC)};
+    if (![tableData writeToFile:tablePath atomically:YES] || ![rules writeToFile:rulesPath atomically:YES]) {
+        NSLog(@"[Tokenizer] 写入词表缓存失败");
+        return NO;
+    }
+    NSLog(@"[Tokenizer] 已编译词表 vocab=%u merges=%lu skipped=%lu", vocabSize, (unsigned long)merges.count, (unsigned long)skipped);
+    return YES;
+}
+
+#pragma mark - 计数
+
+// 依次用每个正则切分（匹配与间隙各为一段），与 tokenizers 的 Split(Isolated) 一致
+- (NSArray<NSValue *> *)pieceRangesOfText:(NSString *)text splitters:(NSArray<NSRegularExpression *> *)splitters {
+    NSMutableArray<NSValue *> *ranges = [NSMutableArray arrayWithObject:[NSValue valueWithRange:NSMakeRange(0, text.length)]];
+    for (NSRegularExpression *splitter in splitters) {
+        NSMutableArray<NSValue *> *next = [NSMutableArray arrayWithCapacity:ranges.count * 2];
+        for (NSValue *value in ranges) {
+            NSRange range = value.rangeValue;
+            __block NSUInteger cursor = range.location;
+            [splitter enumerateMatchesInString:text options:0 range:range usingBlock:^(NSTextCheckingResult *match, NSMatchingFlags flags, BOOL *stop) {
+                if (match.range.length == 0) {
+                    return;
+                }
+                if (match.range.location > cursor) {
+                    [next addObject:[NSValue valueWithRange:NSMakeRange(cursor, match.range.location - cursor)]];
+                }
+                [next addObject:[NSValue valueWithRange:match.range]];
+                cursor = NSMaxRange(match.range);
+            }];
+            if (NSMaxRange(range) > cursor) {
+                [next addObject:[NSValue valueWithRange:NSMakeRange(cursor, NSMaxRange(range) - cursor)]];
+            }
+        }
+        ranges = next;
+    }
+    return ranges;
+}
+
+- (NSUInteger)countTokensInText:(NSString *)text {
+    if (text.length == 0) {
+        return 0;
+    }
+    @synchronized (self) {
+        if (!_tokenizer) {
+            return [AIUATokenizer estimatedTokensForText:text];
+        }
+        NSString *normalized = self.normalizesNFC ? text.precomposedStringWithCanonicalMapping : text;
+        CFStringRef string = (__bridge CFStringRef)normalized;
+        NSUInteger count = 0;
+        uint8_t stackBuffer[kAIUATokenizerStackBufferLength];
+        for (NSValue *value in [self pieceRangesOfText:normalized splitters:self.splitters]) {
+            NSRange range = value.rangeValue;
+            CFIndex byteLength = 0;
+            CFStringGetBytes(string, CFRangeMake(range.location, range.length), kCFStringEncodingUTF8, 0, false, NULL, 0, &byteLength);
+            uint8_t *buffer = byteLength <= (CFIndex)kAIUATokenizerStackBufferLength ? stackBuffer : (uint8_t *)malloc(byteLength);
+            if (!buffer) {
+                count += (NSUInteger)byteLength;
+                continue;
+            }
+            CFStringGetBytes(string, CFRangeMake(range.location, range.length), kCFStringEncodingUTF8, 0, false, buffer, byteLength, NULL);
+            count += AIUABPETokenizerEncode(_tokenizer, buffer, (size_t)byteLength, NULL, 0);
+            if (buffer != stackBuffer) {
+                free(buffer);
+            }
+        }
+        return count;
+    }
+}
+
++ (NSUInteger)estimatedTokensForText:(NSString *)text {
+    double tokens = 0;
+    NSUInteger length = text.length;
+    unichar buffer[256];
+    for (NSUInteger location = 0; location < length; location += 256) {
+        NSUInteger count = MIN((NSUInteger)256, length - location);
+        [text getCharacters:buffer range:NSMakeRange(location, count)];
+        for (NSUInteger i = 0; i < count; i++) {
+            unichar c = buffer[i];
+            if (c < 0x80) {
+                tokens += kAIUATokenizerASCIITokensPerChar;
+            } else if (c >= 0xD800 && c <= 0xDBFF) {
+                // 代理对（表情等）通常拆成多个字节 token
+                tokens += 1.0;
+            } else if (c < 0xDC00 || c > 0xDFFF) {
+                tokens += kAIUATokenizerCJKTokensPerChar;
+            }
+        }
+    }
+    return (NSUInteger)ceil(tokens);
+}
+
+- (NSUInteger)countPromptTokensForMessages:(NSArray<NSDictionary<NSString *, NSString *> *> *)messages {
+    // <｜begin▁of▁sentence｜>{system}<｜User｜>{user}<｜Assistant｜>{assistant}...<｜Assistant｜>
+    NSUInteger count = 2;
+    for (NSDictionary<NSString *, NSString *> *message in messages) {
+        NSString *content = message[@"content"];
+        count += [self countTokensInText:[content isKindOfClass:[NSString class]] ? content : @""];
+        if (![message[@"role"] isEqualToString:@"system"]) {
+            count += 1;
+        }
+    }
+    return count;
+}
+
+#pragma mark - 输出预算
+
+- (double)tokensPerWord {
+    double ratio = [[NSUserDefaults standardUserDefaults] doubleForKey:kAIUATokenizerRatioDefaultsKey];
+    return ratio > 0 ? ratio : kAIUATokenizerDefaultTokensPerWord;
+}
+
+- (NSInteger)outputTokenBudgetForWordCount:(NSInteger)wordCount {
+    if (wordCount <= 0) {
+        return kAIUATokenizerOutputSlack;
+    }
+    return (NSInteger)ceil(wordCount * [self tokensPerWord] * kAIUATokenizerOutputMargin) + kAIUATokenizerOutputSlack;
+}
+
+- (void)recordGeneratedText:(NSString *)text {
+    if (text.length == 0) {
+        return;
+    }
+    NSString *content = [text copy];
+    dispatch_async(self.calibrationQueue, ^{
+        // 估算模式下的比例只是换算常数本身，不用于校准
+        if (!self.isExact) {
+            return;
+        }
+        NSInteger words = [AIUAWordCounter countWordsInText:content];
+        if (words < (NSInteger)kAIUATokenizerMinCalibrationWords) {
+            return;
+        }
+        double sample = (double)[self countTokensInText:content] / words;
+        double ratio = [self tokensPerWord] * (1.0 - kAIUATokenizerRatioSmoothing) + sample * kAIUATokenizerRatioSmoothing;
+        ratio = MIN(MAX(ratio, 0.2), 3.0);
+        [[NSUserDefaults standardUserDefaults] setDouble:ratio forKey:kAIUATokenizerRatioDefaultsKey];
+        NSLog(@"[Tokenizer] 校准 token/字 sample=%.3f ratio=%.3f words=%ld", sample, ratio, (long)words);
+    });
+}
+
+@end
@@ -7,16 +7,28 @@
 #import "AIUAWordPackManager.h"
 #import "AIUAWordPackViewController.h"
 #import "AIUAConfigID.h"
+#import "AIUAStreamCoalescer.h"
+#import "AIUASegmentedGenerator.h"
+#import "AIUAParagraphOutputCache.h"
+#import "AIUAMarkdownStripper.h"
+#import "AIUAWordCounter.h"
+#import "AIUAParagraphHeightTracker.h"
 #import "UITextView+AIUAPlaceholder.h"
 #import <Masonry/Masonry.h>
 #import <MBProgressHUD/MBProgressHUD.h>
 
+// 编辑期间自动保存的间隔
+static const NSTimeInterval kAIUADocAutosaveInterval = 15.0;
+// 改写/翻译长文时每段的 token 上限，超过时分段并发生成
+static const NSUInteger kAIUADocSegmentTokenBudget = 600;
+
 @interface AIUADocDetailViewController () <UITableViewDelegate, UITableViewDataSource, UITextViewDelegate>
 
 @property (nonatomic, strong) UITableView *tableView;
 @property (nonatomic, strong) UITextView *titleTextView;
 @property (nonatomic, strong) UITextView *contentTextView;
 @property (nonatomic, assign) CGFloat ContentTextViewHeight;
+@property (nonatomic, strong) AIUAParagraphHeightTracker *contentHeightTracker; // 按段落缓存正文高度，输入时只重新测量改动的段落
 @property (nonatomic, strong) UIView *headerView;
 @property (nonatomic, strong) UIView *toolbarView;
 
@@ -45,6 +57,10 @@
 // 流式生成相关
 @property (nonatomic, assign) BOOL isGenerating;
 @property (nonatomic, strong) NSMutableString *generatedContent;
+@property (nonatomic, strong) AIUAStreamCoalescer *streamCoalescer; // 合帧投递，避免每个 token 都刷新界面
+@property (nonatomic, strong) AIUAMarkdownStripper *markdownStripper; // 流式移除Markdown符号，标记跨 chunk 也能正确处理
+@property (nonatomic, strong) AIUAWordCounter *generatedWordCounter; // 随生成内容累加字数，完成时无需整段重新统计
+@property (nonatomic, strong) AIUASegmentedGenerator *segmentedGenerator; // 长文改写/翻译时分段并发生成
 @property (nonatomic, strong) UITextView *generationTextView; // 生成内容显示框
 @property (nonatomic, strong) UIView *generationView; // 生成内容容器
 @property (nonatomic, assign) AIUAWritingEditType type; // 写作类型
@@ -55,6 +71,15 @@
 @property (nonatomic, assign) CGFloat keyboardHeight;
 
 @property (nonatomic, assign) BOOL isDeleteDocumentSuccess; // 是否删除文档成功
+
+// 自动保存
+@property (nonatomic, strong) NSTimer *autosaveTimer;
+@property (nonatomic, strong) dispatch_queue_t saveQueue; // 自动保存与离开页面时的保存串行执行，保证先后顺序
+@property (nonatomic, copy) NSString *lastSavedTitle;     // 上次保存的标题（已去除首尾空白）
+@property (nonatomic, copy) NSString *lastSavedContent;   // 上次保存的正文（已去除首尾空白）
+@property (nonatomic, copy) NSDictionary *savingRecord;    // 最近一次发起、尚未写入完成的记录
+@property (nonatomic, assign) NSUInteger saveSequence;     // 每发起一次保存递增
+@property (nonatomic, assign) NSUInteger savedSequence;    // 最近一次写入成功的保存序号
 @end
 
 @implementation AIUADocDetailViewController
@@ -66,6 +91,9 @@
         _hasUserEdited = NO;
         _currentTitle = @"";
         _currentContent = @"";
+        _lastSavedTitle = @"";
+        _lastSavedContent = @"";
+        _saveQueue = dispatch_queue_create("com.aiua.docdetail.save", DISPATCH_QUEUE_SERIAL);
         _selectedStyle = L(@"general");
         _selectedLength = L(@"medium");
         _selectedLanguage = L(@"english");
@@ -82,6 +110,9 @@
         _hasUserEdited = NO;
         _currentTitle = writingItem[@"title"] ?: @"";
         _currentContent = writingItem[@"content"] ?: @"";
+        _lastSavedTitle = [_currentTitle stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        _lastSavedContent = [_currentContent stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        _saveQueue = dispatch_queue_create("com.aiua.docdetail.save", DISPATCH_QUEUE_SERIAL);
         _selectedStyle = L(@"general");
         _selectedLength = L(@"medium");
         _selectedLanguage = L(@"english");
@@ -93,10 +124,13 @@
 - (void)setupDeepSeekWriter {
     // 使用后端代理，不在客户端保存第三方 API Key
     self.deepSeekWriter = [[AIUADeepSeekWriter alloc] initWithServerURL:AIUA_AI_PROXY_URL];
+    // 进入编辑页即预连接，智能编辑的首个 token 不再等待建连
+    [AIUADeepSeekWriter preconnectToServerURL:AIUA_AI_PROXY_URL];
 }
 
 - (void)viewWillDisappear:(BOOL)animated {
     [super viewWillDisappear:animated];
+    [self stopAutosave];
     if (!self.isDeleteDocumentSuccess) {
         [self saveDocumentIfNeeded];
         [self cancelCurrentGeneration];
@@ -105,6 +139,9 @@
 
 - (void)dealloc
 {
+    [_autosaveTimer invalidate];
+    [_streamCoalescer invalidate];
+    [_segmentedGenerator cancel];
     [self unregisterKeyboardNotifications];
 }
 
@@ -766,17 +803,14 @@
 
 - (void)textViewDidChange:(UITextView *)textView {
     self.hasUserEdited = YES;
+    [self startAutosaveIfNeeded];
     
     if (textView == self.titleTextView) {
         self.currentTitle = textView.text;
     } else if (textView == self.contentTextView) {
         self.currentContent = textView.text;
+        [self updateContentTextViewHeight];
     }
-    self.ContentTextViewHeight = [self getContentTextViewHeight];
-    [UIView performWithoutAnimation:^{
-        [self.tableView beginUpdates];
-        [self.tableView endUpdates];
-    }];
 }
 
 #pragma mark - 键盘处理
@@ -920,6 +954,9 @@
                            cancelAction:nil
                          confirmAction:^{
         StrongType(self);
+        // 先停止自动保存并等待进行中的保存完成，避免删除后又被写回
+        [strongself stopAutosave];
+        [strongself waitForPendingSaves];
         BOOL success = [[AIUADataManager sharedManager] deleteWritingWithID:documentID];
         if (success) {
             strongself.isDeleteDocumentSuccess = YES;
@@ -935,13 +972,35 @@
 
 - (CGFloat)getContentTextViewHeight {
     if (self.currentContent.length > 0) {
-        CGSize sizeThatFits = [self.contentTextView sizeThatFits:CGSizeMake(AIUAScreenWidth - 32, CGFLOAT_MAX)];
-        return sizeThatFits.height;
+        // 与 sizeThatFits 口径一致：排版高度加上下内边距；只重新测量改动的段落
+        UIEdgeInsets inset = self.contentTextView.textContainerInset;
+        CGFloat padding = self.contentTextView.textContainer.lineFragmentPadding;
+        CGFloat width = AIUAScreenWidth - 32 - inset.left - inset.right - padding * 2;
+        if (!self.contentHeightTracker) {
+            self.contentHeightTracker = [[AIUAParagraphHeightTracker alloc] initWithFont:self.contentTextView.font width:width];
+        } else {
+            self.contentHeightTracker.font = self.contentTextView.font;
+            self.contentHeightTracker.width = width;
+        }
+        return [self.contentHeightTracker heightForText:self.currentContent] + inset.top + inset.bottom;
     } else {
         return 300;
     }
 }
 
+// 正文高度变化时才刷新行高，逐字输入不换行时不触发表格布局
+- (void)updateContentTextViewHeight {
+    CGFloat height = [self getContentTextViewHeight];
+    if (fabs(height - self.ContentTextViewHeight) < 0.5) {
+        return;
+    }
+    self.ContentTextViewHeight = height;
+    [UIView performWithoutAnimation:^{
+        [self.tableView beginUpdates];
+        [self.tableView endUpdates];
+    }];
+}
+
 - (void)toolbarButtonTapped:(UIButton *)sender {
     // 检查VIP权限
     NSArray *featureNames = @[L(@"continue_writing"), L(@"rewrite"), L(@"expand_writing"), L(@"translate")];
@@ -1138,7 +1197,10 @@
     // 估算需要消耗的字数
     // 注意：所有功能都只消耗输出字数（outputWords），不计算输入字数（inputWords）
     // 因为原文已经存在，只有新生成的内容才需要消耗字数
-    NSInteger inputWords = [AIUAWordPackManager countWordsInText:self.currentContent];
+    // 改写/翻译分段生成，未改动的段落直接使用缓存结果，只按需要请求的部分估算
+    AIUASegmentedGenerator *segmentedGenerator = [self segmentedGeneratorForType:type];
+    NSString *textToGenerate = segmentedGenerator ? segmentedGenerator.uncachedText : self.currentContent;
+    NSInteger inputWords = [AIUAWordPackManager countWordsInText:textToGenerate ?: @""];
     NSInteger estimatedOutputWords = 0;
     NSInteger estimatedConsumeWords = 0; // 实际需要消耗的字数（只计算输出，不计算输入）
     
@@ -1150,7 +1212,7 @@
             break;
         case AIUAWritingEditTypeRewrite:
             // 改写：生成与原文相似长度的内容，只消耗输出字数（重新生成）
-            estimatedOutputWords = MAX(inputWords, 300);
+            estimatedOutputWords = inputWords > 0 ? MAX(inputWords, 300) : 0;
             estimatedConsumeWords = estimatedOutputWords;
             break;
         case AIUAWritingEditTypeExpand:
@@ -1167,7 +1229,7 @@
             break;
         case AIUAWritingEditTypeTranslate:
             // 翻译：生成与原文相似长度的内容，只消耗输出字数（重新生成）
-            estimatedOutputWords = MAX(inputWords, 500);
+            estimatedOutputWords = inputWords > 0 ? MAX(inputWords, 500) : 0;
             estimatedConsumeWords = estimatedOutputWords;
             break;
     }
@@ -1193,7 +1255,7 @@
         return;
     }
     
-    NSString *prompt = [self buildPromptForType:type];
+    NSString *prompt = [self buildPromptForType:type content:self.currentContent];
     
     // 隐藏buttonStack，显示停止生成按钮（停止按钮取代buttonStack的位置）
     self.currentButtonStack.hidden = YES;
@@ -1215,6 +1277,7 @@
     self.isGenerating = YES;
     self.generationTextView.text = @"";
     self.generatedContent = [NSMutableString string];
+    self.generatedWordCounter = [[AIUAWordCounter alloc] init];
     
     // 禁用生成视图中的返回按钮
     if (self.generationBackButton) {
@@ -1225,126 +1288,205 @@
     // 禁用输入框和工具栏按钮
     [self setUIEnabled:NO];
     
+    NSInteger cachedOutputWords = 0;
+    for (NSString *cachedOutput in segmentedGenerator.cachedOutputs) {
+        cachedOutputWords += [AIUAWordPackManager countWordsInText:cachedOutput];
+    }
+    
     // 使用流式生成
     WeakType(self);
     NSLog(@"[DocDetail] 开始流式编辑 type=%ld promptLen=%ld", (long)type, (long)prompt.length);
-    [self.deepSeekWriter generateFullStreamWritingWithPrompt:prompt
-                                                   wordCount:0
-                                              streamHandler:^(NSString *chunk, BOOL finished, NSError * _Nullable error) {
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            StrongType(self);
-            NSLog(@"[DocDetail] stream callback finished=%d error=%@ chunkLen=%ld currentLen=%ld",
-                  finished,
-                  error.localizedDescription ?: @"nil",
-                  (long)chunk.length,
-                  (long)strongself.generatedContent.length);
-            if (error) {
-                [AIUAMBProgressManager hideHUD:strongself.view];
-                strongself.isGenerating = NO;
-                strongself.stopButton.hidden = YES;
-                // 显示buttonStack
-                if (strongself.currentButtonStack) {
-                    strongself.currentButtonStack.hidden = NO;
-                } else if (strongself.generatedContent && strongself.generatedContent.length > 0) {
-                    // 如果有生成内容但没有buttonStack，创建它
-                    [strongself setupResultButtonsForType:strongself.currentEditType];
-                }
-                // 恢复生成视图中的返回按钮
-                if (strongself.generationBackButton) {
-                    strongself.generationBackButton.enabled = YES;
-                    strongself.generationBackButton.alpha = 1.0;
-                }
-                // 恢复输入框和工具栏按钮
-                [strongself setUIEnabled:YES];
-                
-                if (error.code == NSURLErrorCancelled) {
-                    NSLog(@"[DocDetail] 用户主动停止生成");
-                    return;
-                }
-                
-                NSLog(@"[DocDetail] 生成失败，展示弹窗：%@", error.localizedDescription);
-                [AIUAAlertHelper showAlertWithTitle:L(@"generation_failed")
-                                           message:error.localizedDescription
-                                     cancelBtnText:nil
-                                    confirmBtnText:L(@"confirm")
-                                      inController:strongself
-                                      cancelAction:nil
-                                     confirmAction:nil];
+    [self.streamCoalescer invalidate];
+    self.markdownStripper = [[AIUAMarkdownStripper alloc] init];
+    self.streamCoalescer = [[AIUAStreamCoalescer alloc] initWithFrameBudget:AIUAStreamCoalescerDefaultFrameBudget
+                                                            deliveryHandler:^(NSString *chunk, BOOL finished, NSError * _Nullable error) {
+        StrongType(self);
+        NSLog(@"[DocDetail] stream callback finished=%d error=%@ chunkLen=%ld currentLen=%ld",
+              finished,
+              error.localizedDescription ?: @"nil",
+              (long)chunk.length,
+              (long)strongself.generatedContent.length);
+        if (error) {
+            // 保留已生成内容中缓存的尾部
+            [strongself appendGeneratedText:[strongself.markdownStripper finish]];
+            [AIUAMBProgressManager hideHUD:strongself.view];
+            strongself.isGenerating = NO;
+            strongself.stopButton.hidden = YES;
+            // 显示buttonStack
+            if (strongself.currentButtonStack) {
+                strongself.currentButtonStack.hidden = NO;
+            } else if (strongself.generatedContent && strongself.generatedContent.length > 0) {
+                // 如果有生成内容但没有buttonStack，创建它
+                [strongself setupResultButtonsForType:strongself.currentEditType];
+            }
+            // 恢复生成视图中的返回按钮
+            if (strongself.generationBackButton) {
+                strongself.generationBackButton.enabled = YES;
+                strongself.generationBackButton.alpha = 1.0;
+            }
+            // 恢复输入框和工具栏按钮
+            [strongself setUIEnabled:YES];
+            
+            if (error.code == NSURLErrorCancelled) {
+                NSLog(@"[DocDetail] 用户主动停止生成");
                 return;
             }
             
-            if (chunk && chunk.length > 0) {
-                NSString *text = [AIUAToolsManager removeMarkdownSymbols:chunk];
-                [strongself.generatedContent appendString:text];
-                strongself.generationTextView.text = strongself.generatedContent;
-                // 自动滚动到底部
-                [strongself scrollGenerationTextViewToBottom];
+            NSLog(@"[DocDetail] 生成失败，展示弹窗：%@", error.localizedDescription);
+            [AIUAAlertHelper showAlertWithTitle:L(@"generation_failed")
+                                       message:error.localizedDescription
+                                 cancelBtnText:nil
+                                confirmBtnText:L(@"confirm")
+                                  inController:strongself
+                                  cancelAction:nil
+                                 confirmAction:nil];
+            return;
+        }
+        
+        // chunk 为合帧后的增量文本，结束回调只携带未投递的尾部（不会重复追加全文）
+        if (chunk && chunk.length > 0) {
+            [strongself appendGeneratedText:[strongself.markdownStripper appendChunk:chunk]];
+        }
+        
+        if (finished) {
+            [strongself appendGeneratedText:[strongself.markdownStripper finish]];
+            [AIUAMBProgressManager hideHUD:strongself.view];
+            strongself.isGenerating = NO;
+            NSLog(@"[DocDetail] 流式完成，总输出长度=%ld", (long)strongself.generatedContent.length);
+            // 隐藏停止生成按钮，显示buttonStack
+            strongself.stopButton.hidden = YES;
+            if (strongself.currentButtonStack) {
+                strongself.currentButtonStack.hidden = NO;
             }
+            [strongself setupResultButtonsForType:type];
+
+            // 恢复生成视图中的返回按钮
+            if (strongself.generationBackButton) {
+                strongself.generationBackButton.enabled = YES;
+                strongself.generationBackButton.alpha = 1.0;
+            }
+            // 恢复输入框和工具栏按钮
+            [strongself setUIEnabled:YES];
+            
+            // 计算实际消耗的字数
+            // 注意：所有功能都只消耗输出字数（outputWords），不计算输入字数（inputWords）
+            // 因为原文已经存在，只有新生成的内容才需要消耗字数
+            NSInteger inputWords = [AIUAWordPackManager countWordsInText:strongself.currentContent ?: @""];
+            // 与 countWordsInText: 对整段 generatedContent 统计的结果一致
+            // 缓存拼接的段落不再计费
+            NSInteger outputWords = MAX((NSInteger)0, strongself.generatedWordCounter.count - cachedOutputWords);
+            NSInteger consumeWords = 0; // 实际需要消耗的字数（只计算输出，不计算输入）
             
-            if (finished) {
-                [AIUAMBProgressManager hideHUD:strongself.view];
-                strongself.isGenerating = NO;
-                NSLog(@"[DocDetail] 流式完成，总输出长度=%ld", (long)strongself.generatedContent.length);
-                // 隐藏停止生成按钮，显示buttonStack
-                strongself.stopButton.hidden = YES;
-                if (strongself.currentButtonStack) {
-                    strongself.currentButtonStack.hidden = NO;
-                }
-                [strongself setupResultButtonsForType:type];
-
-                // 恢复生成视图中的返回按钮
-                if (strongself.generationBackButton) {
-                    strongself.generationBackButton.enabled = YES;
-                    strongself.generationBackButton.alpha = 1.0;
-                }
-                // 恢复输入框和工具栏按钮
-                [strongself setUIEnabled:YES];
-                
-                // 计算实际消耗的字数
-                // 注意：所有功能都只消耗输出字数（outputWords），不计算输入字数（inputWords）
-                // 因为原文已经存在，只有新生成的内容才需要消耗字数
-                NSInteger inputWords = [AIUAWordPackManager countWordsInText:strongself.currentContent ?: @""];
-                NSInteger outputWords = [AIUAWordPackManager countWordsInText:strongself.generatedContent];
-                NSInteger consumeWords = 0; // 实际需要消耗的字数（只计算输出，不计算输入）
-                
-                switch (type) {
-                    case AIUAWritingEditTypeContinue:
-                        // 续写：只消耗输出字数（新增的）
-                        consumeWords = outputWords;
-                        break;
-                    case AIUAWritingEditTypeRewrite:
-                        // 改写：只消耗输出字数（重新生成）
-                        consumeWords = outputWords;
-                        break;
-                    case AIUAWritingEditTypeExpand:
-                        // 扩写：只消耗输出字数（不计算输入）
-                        consumeWords = outputWords;
-                        break;
-                    case AIUAWritingEditTypeTranslate:
-                        // 翻译：只消耗输出字数（重新生成）
-                        consumeWords = outputWords;
-                        break;
-                }
-                
-                if (consumeWords > 0) {
-                    [[AIUAWordPackManager sharedManager] consumeWords:consumeWords completion:^(BOOL success, NSInteger remainingWords) {
-                        if (success) {
-                            NSLog(@"[DocDetail] 消耗字数成功: 输入 %ld 字，输出 %ld 字，消耗 %ld 字（仅输出），剩余: %ld 字", 
-                                  (long)inputWords, (long)outputWords, (long)consumeWords, (long)remainingWords);
-                        } else {
-                            NSLog(@"[DocDetail] 消耗字数失败，剩余: %ld 字", (long)remainingWords);
-                        }
-                    }];
-                } else {
-                    NSLog(@"[DocDetail] 无需消耗字数（输出字数为0）");
-                }
-                
-                // 随机触发评分提示（文档编辑完成是一个好时机）
-                [AIUAToolsManager tryShowRandomRatingPrompt];
+            switch (type) {
+                case AIUAWritingEditTypeContinue:
+                    // 续写：只消耗输出字数（新增的）
+                    consumeWords = outputWords;
+                    break;
+                case AIUAWritingEditTypeRewrite:
+                    // 改写：只消耗输出字数（重新生成）
+                    consumeWords = outputWords;
+                    break;
+                case AIUAWritingEditTypeExpand:
+                    // 扩写：只消耗输出字数（不计算输入）
+                    consumeWords = outputWords;
+                    break;
+                case AIUAWritingEditTypeTranslate:
+                    // 翻译：只消耗输出字数（重新生成）
+                    consumeWords = outputWords;
+                    break;
             }
-        });
+            
+            if (consumeWords > 0) {
+                [[AIUAWordPackManager sharedManager] consumeWords:consumeWords completion:^(BOOL success, NSInteger remainingWords) {
+                    if (success) {
+                        NSLog(@"[DocDetail] 消耗字数成功: 输入 %ld 字，输出 %ld 字，消耗 %ld 字（仅输出），剩余: %ld 字", 
+                              (long)inputWords, (long)outputWords, (long)consumeWords, (long)remainingWords);
+                    } else {
+                        NSLog(@"[DocDetail] 消耗字数失败，剩余: %ld 字", (long)remainingWords);
+                    }
+                }];
+            } else {
+                NSLog(@"[DocDetail] 无需消耗字数（输出字数为0）");
+            }
+            
+            // 随机触发评分提示（文档编辑完成是一个好时机）
+            [AIUAToolsManager tryShowRandomRatingPrompt];
+        }
+    }];
+    [self.segmentedGenerator cancel];
+    self.segmentedGenerator = segmentedGenerator;
+    if (segmentedGenerator) {
+        NSLog(@"[DocDetail] 分段生成 segments=%ld cached=%ld",
+              (long)segmentedGenerator.segments.count, (long)segmentedGenerator.cachedOutputs.count);
+        [segmentedGenerator startWithStreamHandler:[self.streamCoalescer streamHandler]];
+        return;
+    }
+    [self.deepSeekWriter generateFullStreamWritingWithPrompt:prompt
+                                                   wordCount:0
+                                              streamHandler:[self.streamCoalescer streamHandler]];
+}
+
+// 改写/翻译逐段对应原文：长文分段并发生成、按原文顺序输出，未改动的段落使用缓存结果；
+// 续写/扩写依赖全文，返回 nil 整体生成
+- (AIUASegmentedGenerator *)segmentedGeneratorForType:(AIUAWritingEditType)type {
+    if (type != AIUAWritingEditTypeRewrite && type != AIUAWritingEditTypeTranslate) {
+        return nil;
+    }
+    // 缓存按文档区分，尚未保存过的新文档没有 id，不使用缓存
+    NSString *documentID = self.writingItem[@"id"];
+    AIUAParagraphOutputCache *cache = documentID.length > 0 ? [[AIUADataManager sharedManager] sharedParagraphOutputCache] : nil;
+    NSString *cacheContext = [AIUAParagraphOutputCache contextWithDocumentID:documentID ?: @""
+                                                                  parameters:@[@(type).stringValue,
+                                                                               self.selectedStyle ?: @"",
+                                                                               self.selectedLength ?: @"",
+                                                                               self.selectedLanguage ?: @""]];
+    AIUASegmentCachedOutputProvider cachedOutputProvider = nil;
+    if (cache) {
+        cachedOutputProvider = ^NSString *(NSString *paragraph) {
+            return [cache outputForParagraph:paragraph context:cacheContext];
+        };
+    }
+    
+    WeakType(self);
+    AIUASegmentedGenerator *generator = [[AIUASegmentedGenerator alloc] initWithText:self.currentContent ?: @""
+                                                                         tokenBudget:kAIUADocSegmentTokenBudget
+                                                                cachedOutputProvider:cachedOutputProvider
+                                                                       promptBuilder:^NSString *(NSString *segmentText, NSUInteger index, NSUInteger count) {
+        StrongType(self);
+        NSString *segmentPrompt = [strongself buildPromptForType:type content:segmentText];
+        if (count <= 1) {
+            return segmentPrompt;
+        }
+        NSString *segmentNote = [NSString stringWithFormat:L(@"this_is_part_%@_of_%@_output_this_part_only"), @(index + 1), @(count)];
+        return [NSString stringWithFormat:@"%@\n\n%@", segmentPrompt, segmentNote];
+    } writerFactory:^AIUADeepSeekWriter *{
+        return [[AIUADeepSeekWriter alloc] initWithServerURL:AIUA_AI_PROXY_URL];
     }];
+    if (cache) {
+        generator.segmentOutputHandler = ^(NSString *segmentText, NSString *output) {
+            [cache storeOutput:output forText:segmentText context:cacheContext];
+        };
+    }
+    return generator;
+}
+
+// 追加已移除Markdown符号的增量文本
+- (void)appendGeneratedText:(NSString *)text {
+    if (text.length == 0) {
+        return;
+    }
+    [self.generatedContent appendString:text];
+    [self.generatedWordCounter appendText:text];
+    // 只追加增量，不重新设置整段文本
+    NSAttributedString *attributedText = [[NSAttributedString alloc] initWithString:text attributes:[self generationTextAttributes]];
+    [self.generationTextView.textStorage appendAttributedString:attributedText];
+    // 自动滚动到底部
+    [self scrollGenerationTextViewToBottom];
+}
+
+- (NSDictionary<NSAttributedStringKey, id> *)generationTextAttributes {
+    return @{NSFontAttributeName: AIUAUIFontSystem(14),
+             NSForegroundColorAttributeName: AIUA_LABEL_COLOR};
 }
 
 - (void)scrollGenerationTextViewToBottom {
@@ -1354,8 +1496,7 @@
     }
 }
 
-- (NSString *)buildPromptForType:(AIUAWritingEditType)type {
-    NSString *baseContent = self.currentContent;
+- (NSString *)buildPromptForType:(AIUAWritingEditType)type content:(NSString *)baseContent {
     NSString *typeInstruction = @"";
     NSString *additionalInstruction = @"";
     
@@ -1394,11 +1535,7 @@
         self.contentTextView.text = newText;
         self.currentContent = newText;
         self.hasUserEdited = YES;
-        self.ContentTextViewHeight = [self getContentTextViewHeight];
-        [UIView performWithoutAnimation:^{
-            [self.tableView beginUpdates];
-            [self.tableView endUpdates];
-        }];
+        [self updateContentTextViewHeight];
         [self hideAllSelectionViews];
     }
 }
@@ -1409,11 +1546,7 @@
         self.contentTextView.text = self.generatedContent;
         self.currentContent = self.generatedContent;
         self.hasUserEdited = YES;
-        self.ContentTextViewHeight = [self getContentTextViewHeight];
-        [UIView performWithoutAnimation:^{
-            [self.tableView beginUpdates];
-            [self.tableView endUpdates];
-        }];
+        [self updateContentTextViewHeight];
         [self hideAllSelectionViews];
     }
 }
@@ -1421,7 +1554,9 @@
 // 取消当前生成
 - (void)cancelCurrentGeneration {
     if (self.isGenerating) {
+        [self.streamCoalescer invalidate];
         [self.deepSeekWriter cancelCurrentRequest];
+        [self.segmentedGenerator cancel];
         [AIUAMBProgressManager hideHUD:self.view];
         self.isGenerating = NO;
         self.stopButton.hidden = YES;
@@ -1446,7 +1581,12 @@
 
 // 停止生成按钮点击事件
 - (void)stopButtonTapped {
+    // 先把已收到但未上屏的文本投递出来，再停止
+    [self.streamCoalescer flush];
+    [self.streamCoalescer invalidate];
+    [self appendGeneratedText:[self.markdownStripper finish]];
     [self.deepSeekWriter cancelCurrentRequest];
+    [self.segmentedGenerator cancel];
     [AIUAMBProgressManager hideHUD:self.view];
     self.isGenerating = NO;
     self.stopButton.hidden = YES;
@@ -1543,15 +1683,30 @@
     self.writingItem = [writingRecord copy];
 }
 
-- (void)saveDocumentIfNeeded {
+// 标题和正文与上次保存的一致时无需保存（不统计字数、不访问存储）
+- (BOOL)hasUnsavedChanges {
     if (!self.hasUserEdited) {
-        return;
+        return NO;
+    }
+    NSString *title = [self.currentTitle stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] ?: @"";
+    NSString *content = [self.currentContent stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] ?: @"";
+    // 有保存在进行中时与它比较，避免下一次自动保存重复提交同样的内容
+    NSString *baseTitle = self.savingRecord ? self.savingRecord[@"title"] : self.lastSavedTitle;
+    NSString *baseContent = self.savingRecord ? self.savingRecord[@"content"] : self.lastSavedContent;
+    return ![title isEqualToString:baseTitle ?: @""] || ![content isEqualToString:baseContent ?: @""];
+}
+
+// 生成待保存的记录并记为保存中（saveSequence 为其序号）；无需保存时返回 nil
+// 写入成功后才由 didFinishSavingRecord:sequence:success: 更新 lastSaved*，失败时下次自动保存会重试
+- (NSDictionary *)writingRecordToSave {
+    if (![self hasUnsavedChanges]) {
+        return nil;
     }
     
     NSString *trimmedCurrentContent = [self.currentContent stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
     if (trimmedCurrentContent.length == 0) {
         NSLog(@"ℹ️ saveDocumentIfNeeded: 正文为空，跳过自动保存");
-        return;
+        return nil;
     }
     
     [self updateWritingItem];
@@ -1559,21 +1714,88 @@
     // 安全检查：确保 writingItem 不为 nil
     if (!self.writingItem || ![self.writingItem isKindOfClass:[NSDictionary class]]) {
         NSLog(@"❌ saveDocumentIfNeeded: writingItem 为 nil 或不是有效的字典");
-        return;
+        return nil;
     }
     
     NSString *savedContent = [self.writingItem[@"content"] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
     if (savedContent.length == 0) {
         NSLog(@"ℹ️ saveDocumentIfNeeded: writingItem 正文为空，跳过自动保存");
-        return;
+        return nil;
     }
     
-    NSString *documentID = self.writingItem[@"id"] ?: @"";
-    BOOL success = NO;
-    if (documentID.length > 0) {
-        success = [[AIUADataManager sharedManager] deleteWritingWithID:documentID];
+    self.saveSequence++;
+    self.savingRecord = self.writingItem;
+    return self.writingItem;
+}
+
+// 主线程调用；完成顺序可能与发起顺序不同，只接受比已记录的更新的成功结果
+- (void)didFinishSavingRecord:(NSDictionary *)record sequence:(NSUInteger)sequence success:(BOOL)success {
+    if (sequence == self.saveSequence) {
+        self.savingRecord = nil;
+    }
+    if (!success) {
+        NSLog(@"❌ 保存写作记录失败，内容变化检测以上次成功保存为准，稍后重试");
+        return;
+    }
+    if (sequence > self.savedSequence) {
+        self.savedSequence = sequence;
+        self.lastSavedTitle = record[@"title"] ?: @"";
+        self.lastSavedContent = record[@"content"] ?: @"";
+    }
+}
+
+// 离开页面时保存：等待进行中的自动保存完成后同步写入，返回列表时能读到最新内容
+- (void)saveDocumentIfNeeded {
+    NSDictionary *record = [self writingRecordToSave];
+    if (!record) {
+        return;
     }
-    [[AIUADataManager sharedManager] saveWritingToPlist:self.writingItem];
+    NSUInteger sequence = self.saveSequence;
+    __block BOOL saved = NO;
+    dispatch_sync(self.saveQueue, ^{
+        // 按 id 原位替换，只追加一条记录
+        saved = [[AIUADataManager sharedManager] upsertWriting:record];
+    });
+    [self didFinishSavingRecord:record sequence:sequence success:saved];
+}
+
+#pragma mark - 自动保存
+
+- (void)startAutosaveIfNeeded {
+    if (self.autosaveTimer || self.isDeleteDocumentSuccess) {
+        return;
+    }
+    WeakType(self);
+    self.autosaveTimer = [NSTimer scheduledTimerWithTimeInterval:kAIUADocAutosaveInterval repeats:YES block:^(NSTimer * _Nonnull timer) {
+        StrongType(self);
+        [strongself autosave];
+    }];
+}
+
+- (void)stopAutosave {
+    [self.autosaveTimer invalidate];
+    self.autosaveTimer = nil;
+}
+
+- (void)waitForPendingSaves {
+    dispatch_sync(self.saveQueue, ^{});
+}
+
+// 编辑期间定时在后台保存；内容未变化时什么也不做
+- (void)autosave {
+    NSDictionary *record = [self writingRecordToSave];
+    if (!record) {
+        return;
+    }
+    NSUInteger sequence = self.saveSequence;
+    WeakType(self);
+    dispatch_async(self.saveQueue, ^{
+        BOOL saved = [[AIUADataManager sharedManager] upsertWriting:record];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            StrongType(self);
+            [strongself didFinishSavingRecord:record sequence:sequence success:saved];
+        });
+    });
 }
 
 @end
@@ -8,11 +8,18 @@
 #import "AIUAMBProgressManager.h"
 #import "AIUADocDetailViewController.h"
 
-@interface AIUADocumentsViewController () <UITableViewDelegate, UITableViewDataSource>
+// 搜索结果摘录的最大长度
+static const NSUInteger kAIUADocumentSnippetLength = 60;
+
+@interface AIUADocumentsViewController () <UITableViewDelegate, UITableViewDataSource, UISearchResultsUpdating>
 
 @property (nonatomic, strong) UITableView *tableView;
 @property (nonatomic, strong) NSArray *documents;
 @property (nonatomic, strong) UILabel *emptyLabel;
+@property (nonatomic, strong) UISearchController *searchController;
+@property (nonatomic, strong) NSArray *searchResults;
+// 已生成的摘录（按文档 id），滚动时不重复读取正文
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *searchSnippets;
 
 @end
 
@@ -27,6 +34,16 @@
     // 设置导航栏标题
     self.navigationItem.title = L(@"tab_docs");
     
+    // 全文搜索
+    self.searchController = [[UISearchController alloc] initWithSearchResultsController:nil];
+    self.searchController.searchResultsUpdater = self;
+    self.searchController.obscuresBackgroundDuringPresentation = NO;
+    self.searchController.searchBar.placeholder = L(@"search_documents_placeholder");
+    self.navigationItem.searchController = self.searchController;
+    self.navigationItem.hidesSearchBarWhenScrolling = YES;
+    self.definesPresentationContext = YES;
+    self.searchSnippets = [NSMutableDictionary dictionary];
+    
     // 表格视图
     self.tableView = [[UITableView alloc] initWithFrame:CGRectZero style:UITableViewStyleGrouped];
     self.tableView.delegate = self;
@@ -73,11 +90,69 @@
 }
 
 - (void)setupData {
-    self.documents = [[AIUADataManager sharedManager] loadAllWritings];
-    self.emptyLabel.hidden = self.documents.count > 0;
+    // 列表只加载摘要，正文在打开文档时按 id 读取
+    self.documents = [[AIUADataManager sharedManager] loadAllWritingSummaries];
+    if ([self isSearching]) {
+        [self updateSearchResultsForSearchController:self.searchController];
+        return;
+    }
+    [self updateEmptyLabel];
     [self.tableView reloadData];
 }
 
+- (void)updateEmptyLabel {
+    self.emptyLabel.text = [self isSearching] ? L(@"no_matching_documents") : L(@"no_documents");
+    self.emptyLabel.hidden = [self displayedDocuments].count > 0;
+}
+
+#pragma mark - 搜索
+
+- (NSString *)searchText {
+    return [self.searchController.searchBar.text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+}
+
+- (BOOL)isSearching {
+    return self.searchController.isActive && [self searchText].length > 0;
+}
+
+// 搜索时列表展示命中的文档
+- (NSArray *)displayedDocuments {
+    return [self isSearching] ? self.searchResults : self.documents;
+}
+
+- (void)updateSearchResultsForSearchController:(UISearchController *)searchController {
+    NSString *text = [self searchText];
+    self.searchResults = text.length > 0 ? [[AIUADataManager sharedManager] searchWritingSummariesWithText:text] : @[];
+    [self.searchSnippets removeAllObjects];
+    [self updateEmptyLabel];
+    [self.tableView reloadData];
+}
+
+// 提示词/正文命中时的摘录，命中部分高亮；标题命中返回 nil
+- (NSAttributedString *)searchSnippetForDocument:(NSDictionary *)document {
+    NSString *documentID = document[@"id"];
+    if (!documentID || !document[@"searchField"]) {
+        return nil;
+    }
+    id cached = self.searchSnippets[documentID];
+    if (cached) {
+        return cached == [NSNull null] ? nil : cached;
+    }
+    NSRange highlightRange = NSMakeRange(NSNotFound, 0);
+    NSString *snippet = [[AIUADataManager sharedManager] searchSnippetForWritingSummary:document
+                                                                              maxLength:kAIUADocumentSnippetLength
+                                                                         highlightRange:&highlightRange];
+    NSMutableAttributedString *attributedSnippet = nil;
+    if (snippet.length > 0) {
+        attributedSnippet = [[NSMutableAttributedString alloc] initWithString:snippet];
+        if (highlightRange.location != NSNotFound) {
+            [attributedSnippet addAttribute:NSForegroundColorAttributeName value:AIUA_BLUE_COLOR range:highlightRange];
+        }
+    }
+    self.searchSnippets[documentID] = attributedSnippet ?: (id)[NSNull null];
+    return attributedSnippet;
+}
+
 #pragma mark - 按钮事件
 
 - (void)createDocumentTapped {
@@ -94,9 +169,9 @@
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section {
     if (section == 0) {
-        return 1; // 新建文档cell
+        return [self isSearching] ? 0 : 1; // 新建文档cell，搜索时隐藏
     } else {
-        return self.documents.count;
+        return [self displayedDocuments].count;
     }
 }
 
@@ -110,8 +185,8 @@
         // 文档列表cell
         AIUADocumentCell *cell = [tableView dequeueReusableCellWithIdentifier:@"AIUADocumentCell" forIndexPath:indexPath];
         cell.selectionStyle = UITableViewCellSelectionStyleNone;
-        NSDictionary *document = self.documents[indexPath.row];
-        [cell configureWithDocument:document];
+        NSDictionary *document = [self displayedDocuments][indexPath.row];
+        [cell configureWithDocument:document searchSnippet:[self searchSnippetForDocument:document]];
         
         // 设置更多按钮点击事件
         WeakType(self);
@@ -154,10 +229,11 @@
         [self createDocumentTapped];
     } else {
         // 点击文档
-        NSDictionary *document = self.documents[indexPath.row];
+        NSDictionary *document = [self displayedDocuments][indexPath.row];
         // 这里可以添加点击cell查看文档详情的功能
         NSLog(@"Selected document: %@", document[@"title"]);
-        AIUADocDetailViewController *docDetailVC = [[AIUADocDetailViewController alloc] initWithWritingItem:document];
+        NSDictionary *fullDocument = [self fullDocumentForSummary:document];
+        AIUADocDetailViewController *docDetailVC = [[AIUADocDetailViewController alloc] initWithWritingItem:fullDocument];
         docDetailVC.hidesBottomBarWhenPushed = YES;
         [self.navigationController pushViewController:docDetailVC animated:YES];
     }
@@ -207,12 +283,21 @@
 
 // 增强版导出方法
 
-- (void)exportDocument:(NSDictionary *)document {
+// 列表数据是摘要，需要正文时按 id 读取完整记录
+- (NSDictionary *)fullDocumentForSummary:(NSDictionary *)summary {
+    NSString *documentID = summary[@"id"];
+    NSDictionary *document = documentID ? [[AIUADataManager sharedManager] loadWritingWithID:documentID] : nil;
+    return document ?: summary;
+}
+
+- (void)exportDocument:(NSDictionary *)summary {
+    NSDictionary *document = [self fullDocumentForSummary:summary];
     [[AIUADataManager sharedManager] exportDocument:document[@"title"] ?: @"" withContent:document[@"content"] ?: @""];
 }
 
 
-- (void)copyFullText:(NSDictionary *)document {
+- (void)copyFullText:(NSDictionary *)summary {
+    NSDictionary *document = [self fullDocumentForSummary:summary];
     NSString *content = document[@"content"] ?: @"";
     if (content.length > 0) {
         [UIPasteboard generalPasteboard].string = [NSString stringWithFormat:@"%@\n%@", document[@"title"] ?: @"", content];
@@ -223,7 +308,7 @@
 }
 
 - (void)deleteDocumentAtIndexPath:(NSIndexPath *)indexPath {
-    NSDictionary *document = self.documents[indexPath.row];
+    NSDictionary *document = [self displayedDocuments][indexPath.row];
     NSString *documentID = document[@"id"];
     
     if (!documentID) {
@@ -242,15 +327,15 @@
         StrongType(self);
         BOOL success = [[AIUADataManager sharedManager] deleteWritingWithID:documentID];
         if (success) {
-            // 从数据源中移除
-            NSMutableArray *mutableDocuments = [strongself.documents mutableCopy];
-            [mutableDocuments removeObjectAtIndex:indexPath.row];
-            strongself.documents = [mutableDocuments copy];
+            // 从数据源（及搜索结果）中移除
+            NSPredicate *remaining = [NSPredicate predicateWithFormat:@"id != %@", documentID];
+            strongself.documents = [strongself.documents filteredArrayUsingPredicate:remaining];
+            strongself.searchResults = [strongself.searchResults filteredArrayUsingPredicate:remaining];
             
             // 更新UI
             [strongself.tableView deleteRowsAtIndexPaths:@[indexPath] withRowAnimation:UITableViewRowAnimationAutomatic];
             [strongself.tableView reloadSections:[NSIndexSet indexSetWithIndex:indexPath.section] withRowAnimation:UITableViewRowAnimationAutomatic];
-            strongself.emptyLabel.hidden = strongself.documents.count > 0;
+            [strongself updateEmptyLabel];
             
             [AIUAMBProgressManager showText:nil withText:L(@"deleted_success") andSubText:nil isBottom:NO];
         } else {
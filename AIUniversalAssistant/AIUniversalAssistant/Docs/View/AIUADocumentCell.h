@@ -8,5 +8,7 @@ typedef void (^MoreButtonTappedBlock)(void);
 @property (nonatomic, copy) MoreButtonTappedBlock moreButtonTapped;
 
 - (void)configureWithDocument:(NSDictionary *)document;
+// 搜索结果：在标题下方显示命中摘录
+- (void)configureWithDocument:(NSDictionary *)document searchSnippet:(NSAttributedString *)snippet;
 
 @end
\ No newline at end of file
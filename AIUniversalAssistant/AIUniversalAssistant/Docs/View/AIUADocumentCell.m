@@ -6,6 +6,8 @@
 @property (nonatomic, strong) UIView *containerView;
 @property (nonatomic, strong) UIImageView *documentIcon;
 @property (nonatomic, strong) UILabel *titleLabel;
+@property (nonatomic, strong) UILabel *snippetLabel;
+@property (nonatomic, strong) NSLayoutConstraint *snippetTopConstraint;
 @property (nonatomic, strong) UILabel *timeLabel;
 @property (nonatomic, strong) UILabel *wordCountLabel;
 @property (nonatomic, strong) UIButton *moreButton;
@@ -37,6 +39,13 @@
     self.titleLabel.numberOfLines = 1;
     [self.containerView addSubview:self.titleLabel];
     
+    // 搜索摘录标签，仅搜索结果显示（适配暗黑模式）
+    self.snippetLabel = [[UILabel alloc] init];
+    self.snippetLabel.font = AIUAUIFontSystem(13);
+    self.snippetLabel.textColor = AIUA_SECONDARY_LABEL_COLOR;
+    self.snippetLabel.numberOfLines = 2;
+    [self.containerView addSubview:self.snippetLabel];
+    
     // 时间标签（适配暗黑模式）
     self.timeLabel = [[UILabel alloc] init];
     self.timeLabel.font = AIUAUIFontSystem(13);
@@ -68,11 +77,15 @@
     self.containerView.translatesAutoresizingMaskIntoConstraints = NO;
     self.documentIcon.translatesAutoresizingMaskIntoConstraints = NO;
     self.titleLabel.translatesAutoresizingMaskIntoConstraints = NO;
+    self.snippetLabel.translatesAutoresizingMaskIntoConstraints = NO;
     self.timeLabel.translatesAutoresizingMaskIntoConstraints = NO;
     self.wordCountLabel.translatesAutoresizingMaskIntoConstraints = NO;
     self.moreButton.translatesAutoresizingMaskIntoConstraints = NO;
     self.separatorView.translatesAutoresizingMaskIntoConstraints = NO;
     
+    // 没有摘录时标签高度为 0，间距也收起
+    self.snippetTopConstraint = [self.snippetLabel.topAnchor constraintEqualToAnchor:self.titleLabel.bottomAnchor constant:0];
+    
     [NSLayoutConstraint activateConstraints:@[
         // 容器视图
         [self.containerView.topAnchor constraintEqualToAnchor:self.contentView.topAnchor],
@@ -91,8 +104,13 @@
         [self.titleLabel.leadingAnchor constraintEqualToAnchor:self.documentIcon.trailingAnchor constant:12],
         [self.titleLabel.trailingAnchor constraintEqualToAnchor:self.moreButton.leadingAnchor constant:-8],
         
+        // 搜索摘录标签
+        self.snippetTopConstraint,
+        [self.snippetLabel.leadingAnchor constraintEqualToAnchor:self.titleLabel.leadingAnchor],
+        [self.snippetLabel.trailingAnchor constraintEqualToAnchor:self.titleLabel.trailingAnchor],
+        
         // 时间标签
-        [self.timeLabel.topAnchor constraintEqualToAnchor:self.titleLabel.bottomAnchor constant:8],
+        [self.timeLabel.topAnchor constraintEqualToAnchor:self.snippetLabel.bottomAnchor constant:8],
         [self.timeLabel.leadingAnchor constraintEqualToAnchor:self.documentIcon.trailingAnchor constant:12],
         [self.timeLabel.bottomAnchor constraintEqualToAnchor:self.containerView.bottomAnchor constant:-16],
         
@@ -115,6 +133,14 @@
 }
 
 - (void)configureWithDocument:(NSDictionary *)document {
+    [self configureWithDocument:document searchSnippet:nil];
+}
+
+- (void)configureWithDocument:(NSDictionary *)document searchSnippet:(NSAttributedString *)snippet {
+    // 搜索摘录
+    self.snippetLabel.attributedText = snippet;
+    self.snippetTopConstraint.constant = snippet.length > 0 ? 6 : 0;
+    
     // 标题
     NSString *title = document[@"title"] ?: L(@"untitled_document");
     self.titleLabel.text = title;
@@ -9,6 +9,7 @@
 #import "AIUASearchResultCell.h"
 #import "AIUAHistorySearchCell.h"
 #import "AIUADataManager.h"
+#import "AIUATemplateCatalog.h"
 #import "AIUAToolsManager.h"
 #import "AIUAAlertHelper.h"
 #import "AIUAWritingInputViewController.h"
@@ -22,7 +23,6 @@
 @property (nonatomic, strong) UIView *emptyView;
 @property (nonatomic, strong) UIView *historyHeaderView;
 
-@property (nonatomic, strong) NSArray *allCategories;
 @property (nonatomic, strong) NSArray *searchResults;
 @property (nonatomic, strong) NSMutableArray *historySearches;
 @property (nonatomic, assign) BOOL isSearching;
@@ -85,7 +85,6 @@
     self.historySearches = [NSMutableArray array];
     self.isSearching = NO;
     self.showHistory = NO;
-    self.allCategories = [[NSMutableArray alloc] initWithArray:[[AIUADataManager sharedManager] loadSearchCategoriesData]];
     [self loadHistorySearches];
     
     // 监听缓存清理通知
@@ -258,11 +257,8 @@
     } else {
         self.isSearching = YES;
         self.showHistory = NO;
-        NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NSDictionary *item, NSDictionary *bindings) {
-            NSString *title = item[@"title"];
-            return [title rangeOfString:searchText options:NSCaseInsensitiveSearch].location != NSNotFound;
-        }];
-        self.searchResults = [self.allCategories filteredArrayUsingPredicate:predicate];
+        // 支持中文、英文、全拼和拼音首字母；连续输入时在上一次结果中增量收窄
+        self.searchResults = [[[AIUATemplateCatalog sharedCatalog] searchEngine] itemsMatchingText:searchText];
     }
     
     [self updateUI];
@@ -6,6 +6,7 @@
 #import "AIUAWritingRecordsViewController.h"
 #import "AIUAWordPackManager.h"
 #import "AIUAWordPackViewController.h"
+#import "AIUADeepSeekWriter.h"
 
 @interface AIUAWritingInputViewController ()<UITextFieldDelegate, UITextViewDelegate>
 
@@ -598,6 +599,8 @@
 #pragma mark - UITextViewDelegate
 
 - (BOOL)textViewShouldBeginEditing:(UITextView *)textView {
+    // 聚焦输入框时预连接 AI 服务，提交时无需再等待建连
+    [AIUADeepSeekWriter preconnectToServerURL:nil];
     self.requirementClearButton.alpha = textView.text.length > 0 ? 1 : 0;
     return YES;
 }
@@ -0,0 +1,967 @@
+//
+//  AIUAFullTextIndex.c
+//  AIUniversalAssistant
+//
+//  倒排表编码（每篇文档一项）：[varint 文档号差值][varint (首次出现偏移 << 2) | 字段][varint 词频]
+//  词 = (首字 << 16) | 次字，单字成段时次字为 0
+//
+//  序列化格式（小端）：
+//  [magic u32][version u32][maxDocID u32][documentCount u32][deletedCount u32][aliveLength u32][termCount u32]
+//  [alive 位图][每个词：term u32][docCount u32][lastDocID u32][byteLength u32][倒排表][crc32 u32]
+//  crc32 覆盖之前的全部字节；恢复时还会逐项解码倒排表，损坏的数据不会进入查询路径
+//
+
+#include "AIUAFullTextIndex.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AIUA_FTS_MAGIC 0x46554941u      // "AIUF"
+#define AIUA_FTS_VERSION 2u
+#define AIUA_FTS_HEADER_SIZE 28
+#define AIUA_FTS_TERM_HEADER_SIZE 16
+#define AIUA_FTS_MAX_OFFSET 0x3FFFFFFFu
+
+// 字段权重与词频上限：标题命中一次即高于正文多次命中
+static const uint32_t kAIUAFullTextFieldWeights[AIUAFullTextFieldCount] = {100, 30, 10};
+static const uint32_t kAIUAFullTextMaxFrequencyScore = 10;
+
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+    uint32_t lastDocID;
+    uint32_t docCount;
+} AIUAFullTextPostings;
+
+// 词典槽位，term 为 0 表示空
+typedef struct {
+    uint32_t term;
+    uint32_t postings;
+} AIUAFullTextSlot;
+
+// 单篇文档内的词统计
+typedef struct {
+    uint32_t term;
+    uint32_t position;
+    uint32_t frequency;
+} AIUAFullTextDocTerm;
+
+struct AIUAFullTextIndex {
+    AIUAFullTextSlot *slots;
+    size_t slotCapacity;            // 2 的幂
+    size_t termCount;
+    AIUAFullTextPostings *postings;
+    size_t postingsCapacity;
+    uint8_t *alive;                 // 按文档号的位图
+    size_t aliveLength;
+    uint32_t maxDocID;
+    size_t documentCount;
+    size_t deletedCount;
+    AIUAFullTextDocTerm *scratch;   // AddDocument 使用的临时哈希表
+    size_t scratchCapacity;
+};
+
+#pragma mark - 编码
+
+// 词的高 16 位与低 16 位都要充分混合，否则按低位取模时首字的高位不起作用
+static inline uint32_t AIUAFullTextHash(uint32_t term) {
+    term ^= term >> 16;
+    term *= 0x85EBCA6Bu;
+    term ^= term >> 13;
+    term *= 0xC2B2AE35u;
+    term ^= term >> 16;
+    return term;
+}
+
+static inline uint32_t AIUAFullTextPosition(AIUAFullTextField field, size_t offset) {
+    if (offset > AIUA_FTS_MAX_OFFSET) {
+        offset = AIUA_FTS_MAX_OFFSET;
+    }
+    return ((uint32_t)offset << 2) | (uint32_t)field;
+}
+
+// 先比字段再比偏移
+static inline bool AIUAFullTextPositionBefore(uint32_t a, uint32_t b) {
+    if ((a & 3) != (b & 3)) {
+        return (a & 3) < (b & 3);
+    }
+    return (a >> 2) < (b >> 2);
+}
+
+static inline size_t AIUAFullTextWriteVarint(uint8_t *p, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+static inline bool AIUAFullTextReadVarint(const uint8_t *p, size_t length, size_t *cursor, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && *cursor < length; shift += 7) {
+        uint8_t byte = p[(*cursor)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void AIUAFullTextWriteU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t AIUAFullTextReadU32(const uint8_t *p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static uint32_t AIUAFullTextCRC32(const uint8_t *bytes, size_t length) {
+    uint32_t table[256];
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#pragma mark - 分词
+
+static inline bool AIUAFullTextIsWordCharacter(uint16_t c) {
+    if (c < 0x80) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+    if (c <= 0xBF || c == 0xD7 || c == 0xF7) {
+        return false;   // C1 控制符、Latin-1 标点符号
+    }
+    if ((c >= 0x2000 && c <= 0x206F) || (c >= 0x2190 && c <= 0x2BFF)) {
+        return false;   // 通用标点、箭头/数学/制表/杂项符号
+    }
+    if ((c >= 0x3000 && c <= 0x303F) || (c >= 0xFE30 && c <= 0xFE4F)) {
+        return false;   // 中日韩标点、竖排标点
+    }
+    if ((c >= 0xFF01 && c <= 0xFF0F) || (c >= 0xFF1A && c <= 0xFF20) ||
+        (c >= 0xFF3B && c <= 0xFF40) || (c >= 0xFF5B && c <= 0xFF65)) {
+        return false;   // 全角标点
+    }
+    return true;
+}
+
+static inline uint16_t AIUAFullTextLowercase(uint16_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint16_t)(c + 32) : c;
+}
+
+typedef bool (*AIUAFullTextTermVisitor)(uint32_t term, size_t offset, void *context);
+
+// 返回 false 表示 visitor 中止
+static bool AIUAFullTextTokenize(const uint16_t *text, size_t length, AIUAFullTextTermVisitor visitor, void *context) {
+    size_t i = 0;
+    while (i < length) {
+        if (!AIUAFullTextIsWordCharacter(text[i])) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < length && AIUAFullTextIsWordCharacter(text[i])) {
+            i++;
+        }
+        if (i - start == 1) {
+            if (!visitor((uint32_t)AIUAFullTextLowercase(text[start]) << 16, start, context)) {
+                return false;
+            }
+            continue;
+        }
+        for (size_t k = start; k + 1 < i; k++) {
+            uint32_t term = ((uint32_t)AIUAFullTextLowercase(text[k]) << 16) | AIUAFullTextLowercase(text[k + 1]);
+            if (!visitor(term, k, context)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#pragma mark - 词典
+
+static AIUAFullTextSlot *AIUAFullTextFindSlot(AIUAFullTextSlot *slots, size_t capacity, uint32_t term) {
+    size_t mask = capacity - 1;
+    size_t i = AIUAFullTextHash(term) & mask;
+    while (slots[i].term != 0 && slots[i].term != term) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+static const AIUAFullTextPostings *AIUAFullTextLookup(const AIUAFullTextIndex *index, uint32_t term) {
+    if (index->slotCapacity == 0) {
+        return NULL;
+    }
+    AIUAFullTextSlot *slot = AIUAFullTextFindSlot(index->slots, index->slotCapacity, term);
+    return slot->term == term ? &index->postings[slot->postings] : NULL;
+}
+
+static bool AIUAFullTextRehash(AIUAFullTextIndex *index, size_t capacity) {
+    AIUAFullTextSlot *slots = calloc(capacity, sizeof(AIUAFullTextSlot));
+    if (!slots) {
+        return false;
+    }
+    for (size_t i = 0; i < index->slotCapacity; i++) {
+        if (index->slots[i].term != 0) {
+            *AIUAFullTextFindSlot(slots, capacity, index->slots[i].term) = index->slots[i];
+        }
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->slotCapacity = capacity;
+    return true;
+}
+
+// 查找或新建词的倒排表
+static AIUAFullTextPostings *AIUAFullTextPostingsForTerm(AIUAFullTextIndex *index, uint32_t term) {
+    if ((index->termCount + 1) * 2 > index->slotCapacity) {
+        if (!AIUAFullTextRehash(index, index->slotCapacity ? index->slotCapacity * 2 : 1024)) {
+            return NULL;
+        }
+    }
+    AIUAFullTextSlot *slot = AIUAFullTextFindSlot(index->slots, index->slotCapacity, term);
+    if (slot->term == term) {
+        return &index->postings[slot->postings];
+    }
+    if (index->termCount == index->postingsCapacity) {
+        size_t capacity = index->postingsCapacity ? index->postingsCapacity * 2 : 512;
+        AIUAFullTextPostings *postings = realloc(index->postings, capacity * sizeof(AIUAFullTextPostings));
+        if (!postings) {
+            return NULL;
+        }
+        index->postings = postings;
+        index->postingsCapacity = capacity;
+    }
+    AIUAFullTextPostings *postings = &index->postings[index->termCount];
+    memset(postings, 0, sizeof(*postings));
+    slot->term = term;
+    slot->postings = (uint32_t)index->termCount;
+    index->termCount++;
+    return postings;
+}
+
+static bool AIUAFullTextPostingsAppend(AIUAFullTextPostings *postings, uint32_t docID, uint32_t position, uint32_t frequency) {
+    // 一项最多 3 个 5 字节变长整数
+    if (postings->length + 15 > postings->capacity) {
+        size_t capacity = postings->capacity ? postings->capacity : 16;
+        while (capacity < postings->length + 15) {
+            capacity *= 2;
+        }
+        uint8_t *bytes = realloc(postings->bytes, capacity);
+        if (!bytes) {
+            return false;
+        }
+        postings->bytes = bytes;
+        postings->capacity = capacity;
+    }
+    uint8_t *p = postings->bytes + postings->length;
+    size_t n = AIUAFullTextWriteVarint(p, docID - postings->lastDocID);
+    n += AIUAFullTextWriteVarint(p + n, position);
+    n += AIUAFullTextWriteVarint(p + n, frequency);
+    postings->length += n;
+    postings->lastDocID = docID;
+    postings->docCount++;
+    return true;
+}
+
+// 顺序解码倒排表
+typedef struct {
+    const AIUAFullTextPostings *postings;
+    size_t cursor;
+    uint32_t docID;
+    uint32_t position;
+    uint32_t frequency;
+} AIUAFullTextCursor;
+
+static inline bool AIUAFullTextCursorNext(AIUAFullTextCursor *cursor) {
+    const AIUAFullTextPostings *postings = cursor->postings;
+    uint32_t delta = 0;
+    if (!AIUAFullTextReadVarint(postings->bytes, postings->length, &cursor->cursor, &delta) ||
+        !AIUAFullTextReadVarint(postings->bytes, postings->length, &cursor->cursor, &cursor->position) ||
+        !AIUAFullTextReadVarint(postings->bytes, postings->length, &cursor->cursor, &cursor->frequency)) {
+        return false;
+    }
+    cursor->docID += delta;
+    return true;
+}
+
+#pragma mark - 文档状态
+
+static inline bool AIUAFullTextIsAlive(const AIUAFullTextIndex *index, uint32_t docID) {
+    size_t byte = docID >> 3;
+    return byte < index->aliveLength && (index->alive[byte] & (1u << (docID & 7)));
+}
+
+static bool AIUAFullTextSetAlive(AIUAFullTextIndex *index, uint32_t docID, bool alive) {
+    size_t byte = docID >> 3;
+    if (byte >= index->aliveLength) {
+        if (!alive) {
+            return true;
+        }
+        size_t length = index->aliveLength ? index->aliveLength : 64;
+        while (length <= byte) {
+            length *= 2;
+        }
+        uint8_t *bitmap = realloc(index->alive, length);
+        if (!bitmap) {
+            return false;
+        }
+        memset(bitmap + index->aliveLength, 0, length - index->aliveLength);
+        index->alive = bitmap;
+        index->aliveLength = length;
+    }
+    if (alive) {
+        index->alive[byte] |= (uint8_t)(1u << (docID & 7));
+    } else {
+        index->alive[byte] &= (uint8_t)~(1u << (docID & 7));
+    }
+    return true;
+}
+
+#pragma mark - 创建与释放
+
+AIUAFullTextIndex *AIUAFullTextIndexCreate(void) {
+    return calloc(1, sizeof(AIUAFullTextIndex));
+}
+
+static void AIUAFullTextFreePostings(AIUAFullTextIndex *index) {
+    for (size_t i = 0; i < index->termCount; i++) {
+        free(index->postings[i].bytes);
+    }
+    free(index->postings);
+    free(index->slots);
+    index->postings = NULL;
+    index->postingsCapacity = 0;
+    index->slots = NULL;
+    index->slotCapacity = 0;
+    index->termCount = 0;
+}
+
+void AIUAFullTextIndexDestroy(AIUAFullTextIndex *index) {
+    if (!index) {
+        return;
+    }
+    AIUAFullTextFreePostings(index);
+    free(index->alive);
+    free(index->scratch);
+    free(index);
+}
+
+#pragma mark - 添加与删除
+
+typedef struct {
+    AIUAFullTextDocTerm *table;
+    size_t mask;
+    AIUAFullTextField field;
+} AIUAFullTextAddContext;
+
+static bool AIUAFullTextCollectTerm(uint32_t term, size_t offset, void *context) {
+    AIUAFullTextAddContext *add = context;
+    size_t i = AIUAFullTextHash(term) & add->mask;
+    while (add->table[i].term != 0 && add->table[i].term != term) {
+        i = (i + 1) & add->mask;
+    }
+    if (add->table[i].term == 0) {
+        // 字段按权重顺序处理，第一次出现即最靠前的位置
+        add->table[i].term = term;
+        add->table[i].position = AIUAFullTextPosition(add->field, offset);
+        add->table[i].frequency = 1;
+    } else if (add->table[i].frequency < UINT32_MAX) {
+        add->table[i].frequency++;
+    }
+    return true;
+}
+
+bool AIUAFullTextIndexAddDocument(AIUAFullTextIndex *index, uint32_t docID,
+                                  const uint16_t *const fields[AIUAFullTextFieldCount],
+                                  const size_t lengths[AIUAFullTextFieldCount]) {
+    if (!index || docID == 0 || docID <= index->maxDocID) {
+        return false;
+    }
+
+    // 不同词数不超过码元数，按 2 倍装载预留
+    size_t total = 0;
+    for (int f = 0; f < AIUAFullTextFieldCount; f++) {
+        total += fields[f] ? lengths[f] : 0;
+    }
+    size_t capacity = 64;
+    while (capacity < total * 2) {
+        capacity *= 2;
+    }
+    if (capacity > index->scratchCapacity) {
+        AIUAFullTextDocTerm *scratch = realloc(index->scratch, capacity * sizeof(AIUAFullTextDocTerm));
+        if (!scratch) {
+            return false;
+        }
+        index->scratch = scratch;
+        index->scratchCapacity = capacity;
+    }
+    memset(index->scratch, 0, capacity * sizeof(AIUAFullTextDocTerm));
+
+    AIUAFullTextAddContext context = {index->scratch, capacity - 1, AIUAFullTextFieldTitle};
+    for (int f = 0; f < AIUAFullTextFieldCount; f++) {
+        if (!fields[f] || lengths[f] == 0) {
+            continue;
+        }
+        context.field = (AIUAFullTextField)f;
+        AIUAFullTextTokenize(fields[f], lengths[f], AIUAFullTextCollectTerm, &context);
+    }
+
+    if (!AIUAFullTextSetAlive(index, docID, true)) {
+        return false;
+    }
+    index->maxDocID = docID;
+    for (size_t i = 0; i < capacity; i++) {
+        AIUAFullTextDocTerm *entry = &index->scratch[i];
+        if (entry->term == 0) {
+            continue;
+        }
+        AIUAFullTextPostings *postings = AIUAFullTextPostingsForTerm(index, entry->term);
+        if (!postings || !AIUAFullTextPostingsAppend(postings, docID, entry->position, entry->frequency)) {
+            // 已写入的部分倒排项随文档一起视为已删除，查询时跳过，压缩时移除
+            AIUAFullTextSetAlive(index, docID, false);
+            index->deletedCount++;
+            return false;
+        }
+    }
+    index->documentCount++;
+    return true;
+}
+
+void AIUAFullTextIndexRemoveDocument(AIUAFullTextIndex *index, uint32_t docID) {
+    if (!index || !AIUAFullTextIsAlive(index, docID)) {
+        return;
+    }
+    AIUAFullTextSetAlive(index, docID, false);
+    index->documentCount--;
+    index->deletedCount++;
+}
+
+void AIUAFullTextIndexRemoveAllDocuments(AIUAFullTextIndex *index) {
+    if (!index) {
+        return;
+    }
+    AIUAFullTextFreePostings(index);
+    if (index->alive) {
+        memset(index->alive, 0, index->aliveLength);
+    }
+    index->documentCount = 0;
+    index->deletedCount = 0;
+}
+
+size_t AIUAFullTextIndexDocumentCount(const AIUAFullTextIndex *index) {
+    return index ? index->documentCount : 0;
+}
+
+size_t AIUAFullTextIndexDeletedDocumentCount(const AIUAFullTextIndex *index) {
+    return index ? index->deletedCount : 0;
+}
+
+uint32_t AIUAFullTextIndexMaxDocID(const AIUAFullTextIndex *index) {
+    return index ? index->maxDocID : 0;
+}
+
+bool AIUAFullTextIndexCompact(AIUAFullTextIndex *index) {
+    if (!index) {
+        return false;
+    }
+    // 先重写到新的倒排表和词典，全部成功后再替换，失败时索引不变
+    size_t termCapacity = index->termCount ? index->termCount : 1;
+    AIUAFullTextPostings *rewritten = calloc(termCapacity, sizeof(AIUAFullTextPostings));
+    uint32_t *terms = calloc(termCapacity, sizeof(uint32_t));
+    bool ok = rewritten && terms;
+    for (size_t i = 0; ok && i < index->slotCapacity; i++) {
+        if (index->slots[i].term != 0) {
+            terms[index->slots[i].postings] = index->slots[i].term;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; ok && i < index->termCount; i++) {
+        AIUAFullTextPostings *target = &rewritten[kept];
+        AIUAFullTextCursor cursor = {&index->postings[i], 0, 0, 0, 0};
+        while (ok && AIUAFullTextCursorNext(&cursor)) {
+            if (AIUAFullTextIsAlive(index, cursor.docID)) {
+                ok = AIUAFullTextPostingsAppend(target, cursor.docID, cursor.position, cursor.frequency);
+            }
+        }
+        if (ok && target->docCount > 0) {
+            terms[kept] = terms[i];     // kept <= i，不会覆盖尚未读取的词
+            kept++;
+        } else {
+            free(target->bytes);
+            memset(target, 0, sizeof(*target));
+        }
+    }
+
+    size_t slotCapacity = 1024;
+    while (slotCapacity < (kept + 1) * 2) {
+        slotCapacity *= 2;
+    }
+    AIUAFullTextSlot *slots = ok ? calloc(slotCapacity, sizeof(AIUAFullTextSlot)) : NULL;
+    if (!slots) {
+        for (size_t i = 0; rewritten && i < kept; i++) {
+            free(rewritten[i].bytes);
+        }
+        free(rewritten);
+        free(terms);
+        return false;
+    }
+    for (size_t i = 0; i < kept; i++) {
+        AIUAFullTextSlot *slot = AIUAFullTextFindSlot(slots, slotCapacity, terms[i]);
+        slot->term = terms[i];
+        slot->postings = (uint32_t)i;
+    }
+    free(terms);
+
+    AIUAFullTextFreePostings(index);
+    index->postings = rewritten;
+    index->postingsCapacity = termCapacity;
+    index->termCount = kept;
+    index->slots = slots;
+    index->slotCapacity = slotCapacity;
+    index->deletedCount = 0;
+    return true;
+}
+
+#pragma mark - 查询
+
+// 一个查询子句的命中，按文档号升序
+typedef struct {
+    uint32_t *docIDs;
+    uint32_t *positions;
+    uint32_t *frequencies;
+    size_t count;
+} AIUAFullTextClauseHits;
+
+typedef struct {
+    uint32_t term;          // 二元组子句
+    uint16_t character;     // 单字子句（term 为 0 时）
+} AIUAFullTextClause;
+
+typedef struct {
+    AIUAFullTextClause *clauses;
+    size_t count;
+    size_t capacity;
+} AIUAFullTextQuery;
+
+static bool AIUAFullTextAddBigramClause(uint32_t term, size_t offset, void *context) {
+    (void)offset;
+    AIUAFullTextQuery *query = context;
+    if ((term & 0xFFFF) == 0) {
+        return true;    // 单字段由调用方单独处理
+    }
+    for (size_t i = 0; i < query->count; i++) {
+        if (query->clauses[i].term == term) {
+            return true;
+        }
+    }
+    query->clauses[query->count].term = term;
+    query->clauses[query->count].character = 0;
+    query->count++;
+    return true;
+}
+
+static void AIUAFullTextClauseHitsFree(AIUAFullTextClauseHits *hits) {
+    free(hits->docIDs);
+    free(hits->positions);
+    free(hits->frequencies);
+    memset(hits, 0, sizeof(*hits));
+}
+
+static bool AIUAFullTextClauseHitsAllocate(AIUAFullTextClauseHits *hits, size_t capacity) {
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    hits->docIDs = malloc(capacity * sizeof(uint32_t));
+    hits->positions = malloc(capacity * sizeof(uint32_t));
+    hits->frequencies = malloc(capacity * sizeof(uint32_t));
+    hits->count = 0;
+    if (!hits->docIDs || !hits->positions || !hits->frequencies) {
+        AIUAFullTextClauseHitsFree(hits);
+        return false;
+    }
+    return true;
+}
+
+static bool AIUAFullTextEvaluateTerm(const AIUAFullTextIndex *index, uint32_t term, AIUAFullTextClauseHits *hits) {
+    const AIUAFullTextPostings *postings = AIUAFullTextLookup(index, term);
+    if (!postings) {
+        memset(hits, 0, sizeof(*hits));
+        return true;
+    }
+    if (!AIUAFullTextClauseHitsAllocate(hits, postings->docCount)) {
+        return false;
+    }
+    AIUAFullTextCursor cursor = {postings, 0, 0, 0, 0};
+    while (AIUAFullTextCursorNext(&cursor)) {
+        if (!AIUAFullTextIsAlive(index, cursor.docID)) {
+            continue;
+        }
+        hits->docIDs[hits->count] = cursor.docID;
+        hits->positions[hits->count] = cursor.position;
+        hits->frequencies[hits->count] = cursor.frequency;
+        hits->count++;
+    }
+    return true;
+}
+
+// 单字：合并所有以该字开头或结尾的词
+static bool AIUAFullTextEvaluateCharacter(const AIUAFullTextIndex *index, uint16_t character, AIUAFullTextClauseHits *hits) {
+    size_t docSlots = (size_t)index->maxDocID + 1;
+    uint32_t *positions = malloc(docSlots * sizeof(uint32_t));
+    uint32_t *frequencies = calloc(docSlots, sizeof(uint32_t));
+    if (!positions || !frequencies) {
+        free(positions);
+        free(frequencies);
+        return false;
+    }
+    size_t matched = 0;
+    for (size_t i = 0; i < index->slotCapacity; i++) {
+        uint32_t term = index->slots[i].term;
+        if (term == 0) {
+            continue;
+        }
+        uint16_t first = (uint16_t)(term >> 16);
+        uint16_t second = (uint16_t)(term & 0xFFFF);
+        if (first != character && second != character) {
+            continue;
+        }
+        // 只作为次字出现时，字的位置在词起点之后一个码元
+        uint32_t shift = first == character ? 0 : 4;
+        AIUAFullTextCursor cursor = {&index->postings[index->slots[i].postings], 0, 0, 0, 0};
+        while (AIUAFullTextCursorNext(&cursor)) {
+            if (!AIUAFullTextIsAlive(index, cursor.docID) || cursor.docID > index->maxDocID) {
+                continue;
+            }
+            uint32_t position = cursor.position + shift;
+            if (frequencies[cursor.docID] == 0) {
+                matched++;
+                positions[cursor.docID] = position;
+            } else if (AIUAFullTextPositionBefore(position, positions[cursor.docID])) {
+                positions[cursor.docID] = position;
+            }
+            uint32_t sum = frequencies[cursor.docID] + cursor.frequency;
+            frequencies[cursor.docID] = sum < cursor.frequency ? UINT32_MAX : sum;
+        }
+    }
+
+    bool ok = AIUAFullTextClauseHitsAllocate(hits, matched);
+    for (size_t docID = 1; ok && docID < docSlots; docID++) {
+        if (frequencies[docID] == 0) {
+            continue;
+        }
+        hits->docIDs[hits->count] = (uint32_t)docID;
+        hits->positions[hits->count] = positions[docID];
+        hits->frequencies[hits->count] = frequencies[docID];
+        hits->count++;
+    }
+    free(positions);
+    free(frequencies);
+    return ok;
+}
+
+static uint32_t AIUAFullTextClauseScore(uint32_t position, uint32_t frequency) {
+    uint32_t frequencyScore = frequency < kAIUAFullTextMaxFrequencyScore ? frequency : kAIUAFullTextMaxFrequencyScore;
+    uint32_t field = position & 3;
+    return (field < AIUAFullTextFieldCount ? kAIUAFullTextFieldWeights[field] : 0) + frequencyScore;
+}
+
+static int AIUAFullTextCompareHits(const void *a, const void *b) {
+    const AIUAFullTextHit *x = a;
+    const AIUAFullTextHit *y = b;
+    if (x->score != y->score) {
+        return x->score > y->score ? -1 : 1;
+    }
+    if (x->docID != y->docID) {
+        return x->docID > y->docID ? -1 : 1;
+    }
+    return 0;
+}
+
+size_t AIUAFullTextIndexSearch(const AIUAFullTextIndex *index, const uint16_t *query, size_t length,
+                               size_t limit, AIUAFullTextHit **hits) {
+    *hits = NULL;
+    if (!index || !query || length == 0 || index->documentCount == 0) {
+        return 0;
+    }
+
+    // 1. 查询切分为子句：二元组各一个子句（去重），单字成段的每个字一个子句，按查询中的顺序
+    AIUAFullTextQuery parsed = {calloc(length + 1, sizeof(AIUAFullTextClause)), 0, length + 1};
+    if (!parsed.clauses) {
+        return 0;
+    }
+    size_t i = 0;
+    while (i < length) {
+        if (!AIUAFullTextIsWordCharacter(query[i])) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < length && AIUAFullTextIsWordCharacter(query[i])) {
+            i++;
+        }
+        if (i - start == 1) {
+            uint16_t character = AIUAFullTextLowercase(query[start]);
+            bool exists = false;
+            for (size_t k = 0; k < parsed.count; k++) {
+                exists = exists || (parsed.clauses[k].term == 0 && parsed.clauses[k].character == character);
+            }
+            if (!exists) {
+                parsed.clauses[parsed.count].term = 0;
+                parsed.clauses[parsed.count].character = character;
+                parsed.count++;
+            }
+        } else {
+            AIUAFullTextTokenize(query + start, i - start, AIUAFullTextAddBigramClause, &parsed);
+        }
+    }
+    if (parsed.count == 0) {
+        free(parsed.clauses);
+        return 0;
+    }
+
+    // 2. 逐个子句求命中；任一子句无命中即可结束
+    AIUAFullTextClauseHits *clauseHits = calloc(parsed.count, sizeof(AIUAFullTextClauseHits));
+    size_t *order = calloc(parsed.count, sizeof(size_t));
+    bool ok = clauseHits && order;
+    bool empty = false;
+    for (size_t c = 0; ok && !empty && c < parsed.count; c++) {
+        if (parsed.clauses[c].term != 0) {
+            ok = AIUAFullTextEvaluateTerm(index, parsed.clauses[c].term, &clauseHits[c]);
+        } else {
+            ok = AIUAFullTextEvaluateCharacter(index, parsed.clauses[c].character, &clauseHits[c]);
+        }
+        empty = ok && clauseHits[c].count == 0;
+        order[c] = c;
+    }
+
+    // 3. 从命中最少的子句出发，依次在其余子句中归并查找
+    size_t resultCount = 0;
+    AIUAFullTextHit *results = NULL;
+    if (ok && !empty) {
+        for (size_t a = 1; a < parsed.count; a++) {
+            for (size_t b = a; b > 0 && clauseHits[order[b]].count < clauseHits[order[b - 1]].count; b--) {
+                size_t t = order[b];
+                order[b] = order[b - 1];
+                order[b - 1] = t;
+            }
+        }
+        const AIUAFullTextClauseHits *smallest = &clauseHits[order[0]];
+        size_t *cursors = calloc(parsed.count, sizeof(size_t));
+        results = malloc(smallest->count * sizeof(AIUAFullTextHit));
+        ok = cursors && results;
+        for (size_t h = 0; ok && h < smallest->count; h++) {
+            uint32_t docID = smallest->docIDs[h];
+            uint32_t score = 0;
+            uint32_t primaryPosition = 0;
+            bool all = true;
+            for (size_t c = 0; c < parsed.count && all; c++) {
+                const AIUAFullTextClauseHits *clause = &clauseHits[c];
+                size_t k = cursors[c];
+                while (k < clause->count && clause->docIDs[k] < docID) {
+                    k++;
+                }
+                cursors[c] = k;
+                if (k == clause->count || clause->docIDs[k] != docID) {
+                    all = false;
+                    break;
+                }
+                score += AIUAFullTextClauseScore(clause->positions[k], clause->frequencies[k]);
+                if (c == 0) {
+                    primaryPosition = clause->positions[k];
+                }
+            }
+            if (!all) {
+                continue;
+            }
+            results[resultCount].docID = docID;
+            results[resultCount].score = score;
+            results[resultCount].field = (AIUAFullTextField)(primaryPosition & 3);
+            results[resultCount].offset = primaryPosition >> 2;
+            resultCount++;
+        }
+        free(cursors);
+    }
+
+    for (size_t c = 0; clauseHits && c < parsed.count; c++) {
+        AIUAFullTextClauseHitsFree(&clauseHits[c]);
+    }
+    free(clauseHits);
+    free(order);
+    free(parsed.clauses);
+
+    if (!ok || resultCount == 0) {
+        free(results);
+        return 0;
+    }
+    qsort(results, resultCount, sizeof(AIUAFullTextHit), AIUAFullTextCompareHits);
+    if (limit > 0 && resultCount > limit) {
+        resultCount = limit;
+    }
+    *hits = results;
+    return resultCount;
+}
+
+#pragma mark - 序列化
+
+bool AIUAFullTextIndexSerialize(const AIUAFullTextIndex *index, uint8_t **bytes, size_t *length) {
+    *bytes = NULL;
+    *length = 0;
+    if (!index) {
+        return false;
+    }
+    size_t total = AIUA_FTS_HEADER_SIZE + index->aliveLength + sizeof(uint32_t);
+    for (size_t i = 0; i < index->termCount; i++) {
+        total += AIUA_FTS_TERM_HEADER_SIZE + index->postings[i].length;
+    }
+    uint8_t *buffer = malloc(total);
+    if (!buffer) {
+        return false;
+    }
+    AIUAFullTextWriteU32(buffer, AIUA_FTS_MAGIC);
+    AIUAFullTextWriteU32(buffer + 4, AIUA_FTS_VERSION);
+    AIUAFullTextWriteU32(buffer + 8, index->maxDocID);
+    AIUAFullTextWriteU32(buffer + 12, (uint32_t)index->documentCount);
+    AIUAFullTextWriteU32(buffer + 16, (uint32_t)index->deletedCount);
+    AIUAFullTextWriteU32(buffer + 20, (uint32_t)index->aliveLength);
+    AIUAFullTextWriteU32(buffer + 24, (uint32_t)index->termCount);
+    size_t p = AIUA_FTS_HEADER_SIZE;
+    if (index->aliveLength > 0) {
+        memcpy(buffer + p, index->alive, index->aliveLength);
+        p += index->aliveLength;
+    }
+    for (size_t i = 0; i < index->slotCapacity; i++) {
+        if (index->slots[i].term == 0) {
+            continue;
+        }
+        const AIUAFullTextPostings *postings = &index->postings[index->slots[i].postings];
+        AIUAFullTextWriteU32(buffer + p, index->slots[i].term);
+        AIUAFullTextWriteU32(buffer + p + 4, postings->docCount);
+        AIUAFullTextWriteU32(buffer + p + 8, postings->lastDocID);
+        AIUAFullTextWriteU32(buffer + p + 12, (uint32_t)postings->length);
+        p += AIUA_FTS_TERM_HEADER_SIZE;
+        if (postings->length > 0) {
+            memcpy(buffer + p, postings->bytes, postings->length);
+            p += postings->length;
+        }
+    }
+    AIUAFullTextWriteU32(buffer + p, AIUAFullTextCRC32(buffer, p));
+    p += sizeof(uint32_t);
+    *bytes = buffer;
+    *length = p;
+    return true;
+}
+
+// 逐项解码倒排表：文档号严格递增且在 [1, maxDocID] 内，字段有效，词频非零，条数与末项文档号与记录一致
+static bool AIUAFullTextPostingsValid(const AIUAFullTextPostings *postings, uint32_t maxDocID) {
+    AIUAFullTextCursor cursor = {postings, 0, 0, 0, 0};
+    uint32_t count = 0;
+    while (cursor.cursor < postings->length) {
+        uint32_t previous = cursor.docID;
+        if (!AIUAFullTextCursorNext(&cursor)) {
+            return false;
+        }
+        // 文档号差值为 0 或相加溢出时都不会大于上一项
+        if (cursor.docID <= previous || cursor.docID > maxDocID ||
+            (cursor.position & 3) >= AIUAFullTextFieldCount || cursor.frequency == 0) {
+            return false;
+        }
+        count++;
+    }
+    return count == postings->docCount && cursor.docID == postings->lastDocID;
+}
+
+AIUAFullTextIndex *AIUAFullTextIndexDeserialize(const uint8_t *bytes, size_t length) {
+    if (!bytes || length < AIUA_FTS_HEADER_SIZE + sizeof(uint32_t) ||
+        AIUAFullTextReadU32(bytes) != AIUA_FTS_MAGIC || AIUAFullTextReadU32(bytes + 4) != AIUA_FTS_VERSION) {
+        return NULL;
+    }
+    // 校验和之后只处理其覆盖的部分
+    length -= sizeof(uint32_t);
+    if (AIUAFullTextCRC32(bytes, length) != AIUAFullTextReadU32(bytes + length)) {
+        return NULL;
+    }
+    AIUAFullTextIndex *index = AIUAFullTextIndexCreate();
+    if (!index) {
+        return NULL;
+    }
+    index->maxDocID = AIUAFullTextReadU32(bytes + 8);
+    index->documentCount = AIUAFullTextReadU32(bytes + 12);
+    index->deletedCount = AIUAFullTextReadU32(bytes + 16);
+    size_t aliveLength = AIUAFullTextReadU32(bytes + 20);
+    size_t termCount = AIUAFullTextReadU32(bytes + 24);
+    size_t p = AIUA_FTS_HEADER_SIZE;
+    if (aliveLength > length - p || index->documentCount > index->maxDocID) {
+        AIUAFullTextIndexDestroy(index);
+        return NULL;
+    }
+    if (aliveLength > 0) {
+        index->alive = malloc(aliveLength);
+        if (!index->alive) {
+            AIUAFullTextIndexDestroy(index);
+            return NULL;
+        }
+        memcpy(index->alive, bytes + p, aliveLength);
+        index->aliveLength = aliveLength;
+        p += aliveLength;
+    }
+    for (size_t i = 0; i < termCount; i++) {
+        if (length - p < AIUA_FTS_TERM_HEADER_SIZE) {
+            AIUAFullTextIndexDestroy(index);
+            return NULL;
+        }
+        uint32_t term = AIUAFullTextReadU32(bytes + p);
+        uint32_t docCount = AIUAFullTextReadU32(bytes + p + 4);
+        uint32_t lastDocID = AIUAFullTextReadU32(bytes + p + 8);
+        size_t byteLength = AIUAFullTextReadU32(bytes + p + 12);
+        p += AIUA_FTS_TERM_HEADER_SIZE;
+        if (term == 0 || byteLength > length - p || AIUAFullTextLookup(index, term)) {
+            AIUAFullTextIndexDestroy(index);
+            return NULL;
+        }
+        AIUAFullTextPostings *postings = AIUAFullTextPostingsForTerm(index, term);
+        uint8_t *copy = malloc(byteLength ? byteLength : 1);
+        if (!postings || !copy) {
+            free(copy);
+            AIUAFullTextIndexDestroy(index);
+            return NULL;
+        }
+        memcpy(copy, bytes + p, byteLength);
+        postings->bytes = copy;
+        postings->length = byteLength;
+        postings->capacity = byteLength ? byteLength : 1;
+        postings->docCount = docCount;
+        postings->lastDocID = lastDocID;
+        p += byteLength;
+        if (!AIUAFullTextPostingsValid(postings, index->maxDocID)) {
+            AIUAFullTextIndexDestroy(index);
+            return NULL;
+        }
+    }
+    if (p != length) {
+        AIUAFullTextIndexDestroy(index);
+        return NULL;
+    }
+    return index;
+}
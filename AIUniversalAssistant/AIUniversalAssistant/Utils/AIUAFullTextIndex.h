@@ -0,0 +1,97 @@
+//
+//  AIUAFullTextIndex.h
+//  AIUniversalAssistant
+//
+//  全文倒排索引，纯C实现
+//  - 分词：字母、数字、汉字等"文字字符"连续成段，段内按相邻两字切分为二元组（单字成段时为单字词），
+//    中英文统一处理，查询时所有二元组都出现即命中（不校验相邻）
+//  - 倒排表按文档号递增追加，文档号差值、首次出现位置、词频均以变长整数编码
+//  - 删除只做标记，查询时跳过；删除过多后由调用方触发 Compact 重写倒排表
+//  - 单字查询匹配所有包含该字的二元组
+//  - 只处理 UTF-16 码元，大小写/全半角归一化由调用方完成（ASCII 大写字母会转为小写）
+//  - 非线程安全，由调用方串行访问
+//
+
+#ifndef AIUAFullTextIndex_h
+#define AIUAFullTextIndex_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// 参与索引的字段，序号越小排序权重越高
+typedef enum {
+    AIUAFullTextFieldTitle = 0,
+    AIUAFullTextFieldPrompt,
+    AIUAFullTextFieldContent,
+    AIUAFullTextFieldCount
+} AIUAFullTextField;
+
+/// 查询命中
+typedef struct {
+    uint32_t docID;
+    uint32_t score;
+    AIUAFullTextField field;    // 查询中第一个词最先出现的字段
+    uint32_t offset;            // 该字段内的 UTF-16 偏移，用于摘要与高亮
+} AIUAFullTextHit;
+
+typedef struct AIUAFullTextIndex AIUAFullTextIndex;
+
+AIUAFullTextIndex *AIUAFullTextIndexCreate(void);
+void AIUAFullTextIndexDestroy(AIUAFullTextIndex *index);
+
+/**
+ * 添加文档
+ * @param docID 由调用方分配，必须大于之前添加过的所有文档号（0 保留）
+ * @param fields 各字段的 UTF-16 文本，可为 NULL
+ * @param lengths 各字段长度
+ * @return 内存不足或 docID 不递增时返回 false，此时索引不变
+ */
+bool AIUAFullTextIndexAddDocument(AIUAFullTextIndex *index, uint32_t docID,
+                                  const uint16_t *const fields[AIUAFullTextFieldCount],
+                                  const size_t lengths[AIUAFullTextFieldCount]);
+
+/// 标记删除文档
+void AIUAFullTextIndexRemoveDocument(AIUAFullTextIndex *index, uint32_t docID);
+
+/// 移除全部文档（文档号不复用，仍需大于之前的最大值）
+void AIUAFullTextIndexRemoveAllDocuments(AIUAFullTextIndex *index);
+
+/// 有效文档数
+size_t AIUAFullTextIndexDocumentCount(const AIUAFullTextIndex *index);
+
+/// 已标记删除、尚未从倒排表中移除的文档数
+size_t AIUAFullTextIndexDeletedDocumentCount(const AIUAFullTextIndex *index);
+
+/// 已添加过的最大文档号
+uint32_t AIUAFullTextIndexMaxDocID(const AIUAFullTextIndex *index);
+
+/// 从倒排表中移除已删除的文档
+bool AIUAFullTextIndexCompact(AIUAFullTextIndex *index);
+
+/**
+ * 查询
+ * @param hits 输出命中数组（按得分降序，得分相同时文档号大的在前），调用方用 free() 释放；无命中时为 NULL
+ * @param limit 最多返回条数，0 表示不限
+ * @return 命中条数
+ */
+size_t AIUAFullTextIndexSearch(const AIUAFullTextIndex *index, const uint16_t *query, size_t length,
+                               size_t limit, AIUAFullTextHit **hits);
+
+/**
+ * 序列化为连续字节（小端），调用方用 free() 释放
+ */
+bool AIUAFullTextIndexSerialize(const AIUAFullTextIndex *index, uint8_t **bytes, size_t *length);
+
+/// 从 AIUAFullTextIndexSerialize 的结果恢复；校验和不符、倒排表中文档号越界或字段无效等数据损坏时返回 NULL
+AIUAFullTextIndex *AIUAFullTextIndexDeserialize(const uint8_t *bytes, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAFullTextIndex_h */
@@ -95,6 +95,10 @@ typedef void(^AIUAIAPRestoreCompletion)(BOOL success, NSInteger restoredCount, N
 /// 本地验证收据
 - (BOOL)verifyReceiptLocally;
 
+/// 使收据验证快照失效，下次 checkSubscriptionStatus 重新完整解析收据
+/// 恢复购买、新交易完成、清除购买数据时会自动调用
+- (void)invalidateReceiptVerificationSnapshot;
+
 /// 检测设备是否越狱
 + (BOOL)isJailbroken;
 
@@ -10,6 +10,8 @@
 #import "AIUATrialManager.h"
 #import "AIUAConfigID.h"
 #import "AIUAAlertHelper.h"
+#import "AIUAReceiptParser.h"
+#import "AIUAReceiptSnapshotStore.h"
 #import <sys/stat.h>
 #import <mach-o/dyld.h>
 
@@ -21,9 +23,52 @@ static NSString * const kAIUAHasLifetimeEntitlement = @"kAIUAHasLifetimeEntitlem
 static NSString * const kAIUAHasSubscriptionHistory = @"hasSubscriptionHistory";
 /// 用户主动清除购买数据后置为 YES，仅在用户点击「恢复购买」且恢复成功时清除，用于避免清除后冷启动/收据验证再次自动恢复
 static NSString * const kAIUAUserClearedPurchaseData = @"AIUAUserClearedPurchaseData";
+/// 上次完整验证通过时的收据指纹（大小、修改时间、SHA-256），收据未变化时冷启动直接沿用本地订阅状态
+static NSString * const kAIUAReceiptVerificationSnapshot = @"kAIUAReceiptVerificationSnapshot";
+/// 快照最长沿用时间，超过后即使收据未变化也重新完整验证一次（与本地订阅 7 天刷新规则一致）
+static const NSTimeInterval kAIUAReceiptSnapshotMaxAge = 7 * 24 * 60 * 60;
 
 NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING";
 
+#pragma mark - 收据解析回调
+
+static NSString *AIUAIAPManagerStringFromReceiptString(AIUAReceiptString string) {
+    if (!string.bytes || string.length == 0) {
+        return nil;
+    }
+    return [[NSString alloc] initWithBytes:string.bytes length:string.length encoding:NSUTF8StringEncoding];
+}
+
+static NSDate *AIUAIAPManagerDateFromReceiptString(AIUAReceiptString string) {
+    int64_t seconds = 0;
+    if (!AIUAReceiptParseDate(string, &seconds)) {
+        return nil;
+    }
+    return [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)seconds];
+}
+
+// 每条内购记录转换为字典（字段名与 Apple 验证接口的 in_app 一致）
+static void AIUAIAPManagerCollectInAppPurchase(const AIUAReceiptInAppPurchase *purchase, void *context) {
+    NSMutableArray *inAppPurchases = (__bridge NSMutableArray *)context;
+    NSString *productId = AIUAIAPManagerStringFromReceiptString(purchase->productID);
+    if (productId.length == 0) {
+        return;
+    }
+    // 已退款/取消的交易视同未购买
+    if (purchase->cancellationDate.length > 0) {
+        NSLog(@"[IAP] 忽略已取消的交易: %@", productId);
+        return;
+    }
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    record[@"product_id"] = productId;
+    record[@"quantity"] = @(purchase->quantity);
+    record[@"transaction_id"] = AIUAIAPManagerStringFromReceiptString(purchase->transactionID);
+    record[@"original_transaction_id"] = AIUAIAPManagerStringFromReceiptString(purchase->originalTransactionID);
+    record[@"purchase_date"] = AIUAIAPManagerDateFromReceiptString(purchase->purchaseDate);
+    record[@"expires_date"] = AIUAIAPManagerDateFromReceiptString(purchase->expiresDate);
+    [inAppPurchases addObject:record];
+}
+
 @interface AIUAIAPManager () <SKProductsRequestDelegate, SKPaymentTransactionObserver>
 
 @property (nonatomic, strong) NSMutableDictionary<NSString *, SKProduct *> *productsCache;
@@ -43,6 +88,8 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
 
 // 上次收据验证时间（避免频繁验证收据）
 @property (nonatomic, strong) NSDate *lastReceiptVerificationTime;
+// 收据验证快照（指纹、版本与时效判断）
+@property (nonatomic, strong) AIUAReceiptSnapshotStore *receiptSnapshotStore;
 
 // 上次自动恢复购买尝试时间（用于网络恢复后重试，避免频繁请求）
 @property (nonatomic, strong) NSDate *lastRestoreAttemptDate;
@@ -387,6 +434,8 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     self.restoredPurchasesCount = 0;
     self.lastRestoreAttemptDate = [NSDate date];
     self.hasScheduledRestoreRetryForNetworkError = NO; // 允许本次恢复在网络错误时延迟重试一次
+    // 恢复会刷新收据，旧快照不再可信
+    [self invalidateReceiptVerificationSnapshot];
     
     [[SKPaymentQueue defaultQueue] restoreCompletedTransactions];
     
@@ -461,7 +510,24 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
         }
     }
     
-    BOOL isValid = [self verifyReceiptLocally];
+    // 收据文件大小、修改时间与上次验证快照一致时不再解析收据，直接沿用本地订阅状态，内容哈希放到后台复核
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSDictionary *snapshot = [self receiptVerificationSnapshotMatchingReceiptFile];
+    if (snapshot) {
+        self.lastReceiptVerificationTime = now;
+        NSLog(@"[IAP] ⚡️ 收据未变化，沿用验证快照，耗时 %.3fms（上次完整验证 %.3fms）",
+              (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0, [snapshot[@"verifyDuration"] doubleValue]);
+        [self revalidateReceiptSnapshotInBackground:snapshot];
+        if (self.subscriptionExpiryDate && [now compare:self.subscriptionExpiryDate] == NSOrderedDescending) {
+            NSLog(@"[IAP] 订阅已过期");
+            _isVIPMember = NO;
+            [self saveLocalSubscriptionInfo];
+        }
+        return;
+    }
+    
+    NSData *receiptData = [self readReceiptData];
+    BOOL isValid = receiptData ? [self verifyReceiptData:receiptData] : NO;
     self.lastReceiptVerificationTime = now; // 记录验证时间
     
     if (!isValid) {
@@ -483,6 +549,10 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
         return;
     }
     
+    CFAbsoluteTime verifyDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    NSLog(@"[IAP] 收据完整验证耗时 %.3fms", verifyDuration * 1000.0);
+    [self saveReceiptVerificationSnapshotForData:receiptData duration:verifyDuration];
+    
     // 检查订阅是否过期
     if (self.subscriptionExpiryDate) {
         if ([now compare:self.subscriptionExpiryDate] == NSOrderedDescending) {
@@ -525,8 +595,8 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     // 3. 重置试用次数
     [[AIUATrialManager sharedManager] resetTrialCount];
     
-    // 4. 清除收据验证时间缓存
-    self.lastReceiptVerificationTime = nil;
+    // 4. 清除收据验证时间缓存和验证快照
+    [self invalidateReceiptVerificationSnapshot];
     // 5. 关闭冷启动恢复窗口
     self.launchRestoreWindowActive = NO;
     self.autoRestoreInProgress = NO;
@@ -717,8 +787,8 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
         [defaults synchronize];
     }
     
-    // 恢复完成后，强制清除节流时间戳，确保 checkSubscriptionStatus 重新解析收据
-    self.lastReceiptVerificationTime = nil;
+    // 恢复完成后，强制清除节流时间戳和验证快照，确保 checkSubscriptionStatus 重新解析收据
+    [self invalidateReceiptVerificationSnapshot];
     [self checkSubscriptionStatus];
     
     // 如果恢复过程中检测到永久会员，但收据解析未能识别，则强制设置永久会员
@@ -847,7 +917,7 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     // 保存当前到期时间，verifyReceipt 可能用收据中单笔购买的到期时间覆盖它
     NSDate *previousExpiryDate = self.subscriptionExpiryDate;
     
-    self.lastReceiptVerificationTime = nil;
+    [self invalidateReceiptVerificationSnapshot];
     [self verifyReceipt:transaction];
     
     if (![self isWordPackProductId:productIdentifier]) {
@@ -1102,20 +1172,31 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
 }
 
 - (BOOL)verifyReceiptLocally {
+    NSData *receiptData = [self readReceiptData];
+    if (!receiptData) {
+        return NO;
+    }
+    return [self verifyReceiptData:receiptData];
+}
+
+- (nullable NSData *)readReceiptData {
     // 1. 检查收据文件是否存在
     NSURL *receiptURL = [[NSBundle mainBundle] appStoreReceiptURL];
     if (!receiptURL) {
         NSLog(@"[IAP] ❌ 收据URL为空");
-        return NO;
+        return nil;
     }
     
     NSData *receiptData = [NSData dataWithContentsOfURL:receiptURL];
     if (!receiptData || receiptData.length == 0) {
         NSLog(@"[IAP] ❌ 收据数据为空（可能是重装后收据未生成）");
         NSLog(@"[IAP] 💡 解决方案：请在App中点击「恢复购买」按钮，系统会自动刷新收据并恢复订阅");
-        return NO;
+        return nil;
     }
-    
+    return receiptData;
+}
+
+- (BOOL)verifyReceiptData:(NSData *)receiptData {
     NSLog(@"[IAP] 收据文件存在，大小: %lu bytes", (unsigned long)receiptData.length);
     
     // 2. 验证 Bundle ID
@@ -1281,57 +1362,32 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
 
 
 
-// 解析收据中的订阅信息
+// 解析收据中的订阅信息（单次线性遍历 PKCS#7/ASN.1 结构，见 AIUAReceiptParser）
 - (NSDictionary *)parseReceiptData:(NSData *)receiptData {
     if (!receiptData || receiptData.length == 0) {
         return nil;
     }
     
-    // 注意：完整的ASN.1解析非常复杂
-    // 这里实现简化版本，提取关键信息
-    
-    NSMutableDictionary *result = [NSMutableDictionary dictionary];
     NSMutableArray *inAppPurchases = [NSMutableArray array];
-    NSMutableSet *foundProductIds = [NSMutableSet set]; // 避免重复添加相同产品
+    AIUAReceiptInfo info;
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    AIUAReceiptParseResult parseResult = AIUAReceiptParse(receiptData.bytes, receiptData.length, &info,
+                                                          AIUAIAPManagerCollectInAppPurchase,
+                                                          (__bridge void *)inAppPurchases);
     
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    BOOL bundleIdFound = NO; // 标记是否已找到 Bundle ID
-    
-    // 尝试查找Bundle ID和购买记录
-    // Bundle ID 在收据中的字段类型为 2
-    // In-App Purchase 在收据中的字段类型为 17
-    
-    for (NSUInteger i = 0; i < length - 20; i++) {
-        // 查找 Bundle ID 模式（只查找一次）
-        if (!bundleIdFound && i + 100 < length) {
-            NSString *bundleId = [self extractBundleIdFromReceipt:receiptData atOffset:i];
-            if (bundleId && bundleId.length > 0) {
-                result[@"bundle_id"] = bundleId;
-                NSLog(@"[IAP] ✓ 从收据中提取 Bundle ID: %@", bundleId);
-                bundleIdFound = YES; // 找到后不再重复查找
-            }
-        }
-        
-        // 查找产品ID模式（简化查找）
-        NSString *productId = [self extractProductIdFromReceipt:receiptData atOffset:i];
-        if (productId && [productId containsString:@"."] && ![foundProductIds containsObject:productId]) {
-            // 可能是一个有效的产品ID，且未重复添加
-            NSMutableDictionary *purchase = [NSMutableDictionary dictionary];
-            purchase[@"product_id"] = productId;
-            
-            // 尝试提取过期时间（对于自动续订订阅）
-            NSDate *expiresDate = [self extractExpiresDateFromReceipt:receiptData nearOffset:i];
-            if (expiresDate) {
-                purchase[@"expires_date"] = expiresDate;
-            }
-            
-            [inAppPurchases addObject:purchase];
-            [foundProductIds addObject:productId]; // 标记为已找到
-            NSLog(@"[IAP] ✓ 从收据中提取产品: %@", productId);
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    if (parseResult == AIUAReceiptParseOK) {
+        NSString *bundleId = AIUAIAPManagerStringFromReceiptString(info.bundleID);
+        if (bundleId.length > 0) {
+            result[@"bundle_id"] = bundleId;
+            NSLog(@"[IAP] ✓ 从收据中提取 Bundle ID: %@", bundleId);
         }
+        NSLog(@"[IAP] 收据解析完成：%lu 条交易记录，耗时 %.2fms",
+              (unsigned long)info.inAppPurchaseCount, (CFAbsoluteTimeGetCurrent() - start) * 1000);
+    } else {
+        NSLog(@"[IAP] ❌ 收据结构解析失败，错误码: %d", (int)parseResult);
     }
+    AIUAReceiptInfoRelease(&info);
     
     if (inAppPurchases.count > 0) {
         result[@"in_app"] = inAppPurchases;
@@ -1340,124 +1396,6 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     return result.count > 0 ? result : nil;
 }
 
-// 从收据中提取 Bundle ID
-- (NSString *)extractBundleIdFromReceipt:(NSData *)receiptData atOffset:(NSUInteger)offset {
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    if (offset + 50 > length) return nil;
-    
-    // 查找可能的Bundle ID字符串
-    // Bundle ID通常是 com.company.appname 格式
-    for (NSUInteger i = offset; i < MIN(offset + 100, length - 30); i++) {
-        if (bytes[i] == 'c' && bytes[i+1] == 'o' && bytes[i+2] == 'm' && bytes[i+3] == '.') {
-            // 可能找到了Bundle ID
-            NSUInteger endPos = i;
-            while (endPos < length && endPos < i + 100) {
-                char c = bytes[endPos];
-                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || 
-                    (c >= '0' && c <= '9') || c == '.' || c == '-') {
-                    endPos++;
-                } else {
-                    break;
-                }
-            }
-            
-            if (endPos > i + 10) { // Bundle ID至少有一定长度
-                NSData *bundleData = [receiptData subdataWithRange:NSMakeRange(i, endPos - i)];
-                NSString *bundleId = [[NSString alloc] initWithData:bundleData encoding:NSUTF8StringEncoding];
-                if (bundleId && [bundleId componentsSeparatedByString:@"."].count >= 3) {
-                    return bundleId;
-                }
-            }
-        }
-    }
-    
-    return nil;
-}
-
-// 从收据中提取产品ID
-- (NSString *)extractProductIdFromReceipt:(NSData *)receiptData atOffset:(NSUInteger)offset {
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    if (offset + 50 > length) return nil;
-    
-    // 查找可能的产品ID（收据中可能为 lifetimeBenefits 或 LifetimeBenefits）
-    NSArray *productTypes = @[@"lifetimeBenefits", @"LifetimeBenefits", @"lifetimebenefits", @"lifetime", @"yearly", @"monthly", @"weekly"];
-    
-    for (NSString *type in productTypes) {
-        const char *typeStr = [type UTF8String];
-        NSUInteger typeLen = strlen(typeStr);
-        
-        if (offset + typeLen < length) {
-            BOOL found = YES;
-            for (NSUInteger j = 0; j < typeLen; j++) {
-                if (bytes[offset + j] != typeStr[j]) {
-                    found = NO;
-                    break;
-                }
-            }
-            
-            if (found) {
-                // 向前查找完整的产品ID
-                NSUInteger startPos = offset;
-                while (startPos > 0 && startPos > offset - 100) {
-                    char c = bytes[startPos - 1];
-                    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || 
-                        (c >= '0' && c <= '9') || c == '.' || c == '-') {
-                        startPos--;
-                    } else {
-                        break;
-                    }
-                }
-                
-                NSUInteger endPos = offset + typeLen;
-                NSData *productData = [receiptData subdataWithRange:NSMakeRange(startPos, endPos - startPos)];
-                NSString *productId = [[NSString alloc] initWithData:productData encoding:NSUTF8StringEncoding];
-                
-                if (productId && [productId containsString:@"."]) {
-                    return productId;
-                }
-            }
-        }
-    }
-    
-    return nil;
-}
-
-// 从收据中提取过期时间
-- (NSDate *)extractExpiresDateFromReceipt:(NSData *)receiptData nearOffset:(NSUInteger)offset {
-    if (!receiptData || receiptData.length == 0) {
-        return nil;
-    }
-    
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    // 在产品ID附近搜索时间戳
-    // ASN.1 时间戳格式：YYYYMMDDTHHMMSSZ 或 YYYY-MM-DDTHH:MM:SSZ
-    NSUInteger searchStart = (offset > 200) ? offset - 200 : 0;
-    NSUInteger searchEnd = MIN(offset + 500, length);
-    
-    // 方法1: 查找 ISO 8601 格式时间戳 (YYYY-MM-DD)
-    NSDate *isoDate = [self findISO8601DateInReceipt:receiptData start:searchStart end:searchEnd];
-    if (isoDate) {
-        NSLog(@"[IAP] 从收据中提取到 ISO 8601 时间戳: %@", isoDate);
-        return isoDate;
-    }
-    
-    // 方法2: 查找 ASN.1 GeneralizedTime 格式 (YYYYMMDDHHMMSSZ)
-    NSDate *asnDate = [self findASN1DateInReceipt:receiptData start:searchStart end:searchEnd];
-    if (asnDate) {
-        NSLog(@"[IAP] 从收据中提取到 ASN.1 时间戳: %@", asnDate);
-        return asnDate;
-    }
-    
-    NSLog(@"[IAP] 未能从收据中提取过期时间");
-    return nil;
-}
-
 - (BOOL)isReasonableExpiryDate:(NSDate *)expiryDate
                 forProductType:(AIUASubscriptionProductType)type
                  referenceDate:(NSDate *)referenceDate {
@@ -1490,197 +1428,6 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     return (interval >= minPastInterval && interval <= maxFutureInterval);
 }
 
-// 查找 ISO 8601 格式的时间戳 (YYYY-MM-DDTHH:MM:SSZ)
-- (NSDate *)findISO8601DateInReceipt:(NSData *)receiptData start:(NSUInteger)start end:(NSUInteger)end {
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    // 查找模式: 20XX-XX-XX (未来日期，作为订阅到期时间)
-    for (NSUInteger i = start; i < end && i < length - 20; i++) {
-        // 检查是否是年份开头 (20)
-        if (bytes[i] == '2' && bytes[i+1] == '0' && 
-            bytes[i+2] >= '2' && bytes[i+2] <= '9' && 
-            bytes[i+3] >= '0' && bytes[i+3] <= '9') {
-            
-            // 检查日期分隔符 (-)
-            if (i + 10 < length && bytes[i+4] == '-' && bytes[i+7] == '-') {
-                // 提取完整的时间戳字符串
-                NSString *dateString = [self extractDateStringFromReceipt:receiptData offset:i];
-                
-                if (dateString && dateString.length >= 10) {
-                    NSDate *date = [self parseDateString:dateString];
-                    if (date) {
-                        // 验证日期是否在未来（订阅到期时间应该在未来）
-                        NSDate *now = [NSDate date];
-                        NSTimeInterval interval = [date timeIntervalSinceDate:now];
-                        
-                        // 只接受未来3个月到10年之间的日期（合理的订阅周期）
-                        if (interval > -30*24*3600 && interval < 10*365*24*3600) {
-                            return date;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    return nil;
-}
-
-// 查找 ASN.1 GeneralizedTime 格式 (YYYYMMDDHHMMSSZ)
-- (NSDate *)findASN1DateInReceipt:(NSData *)receiptData start:(NSUInteger)start end:(NSUInteger)end {
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    // ASN.1 GeneralizedTime 标签是 0x18
-    for (NSUInteger i = start; i < end && i < length - 20; i++) {
-        if (bytes[i] == 0x18) {
-            // 下一个字节是长度
-            NSUInteger timeLength = bytes[i+1];
-            
-            // GeneralizedTime 通常是 15 字节 (YYYYMMDDHHMMSSZ)
-            if (timeLength >= 14 && timeLength <= 17 && i + 2 + timeLength < length) {
-                NSData *timeData = [receiptData subdataWithRange:NSMakeRange(i+2, timeLength)];
-                NSString *timeString = [[NSString alloc] initWithData:timeData encoding:NSASCIIStringEncoding];
-                
-                if (timeString && [self isValidASN1TimeString:timeString]) {
-                    NSDate *date = [self parseASN1TimeString:timeString];
-                    if (date) {
-                        // 验证日期合理性
-                        NSDate *now = [NSDate date];
-                        NSTimeInterval interval = [date timeIntervalSinceDate:now];
-                        
-                        if (interval > -30*24*3600 && interval < 10*365*24*3600) {
-                            return date;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    return nil;
-}
-
-// 从收据中提取日期字符串
-- (NSString *)extractDateStringFromReceipt:(NSData *)receiptData offset:(NSUInteger)offset {
-    const uint8_t *bytes = [receiptData bytes];
-    NSUInteger length = receiptData.length;
-    
-    if (offset + 30 > length) return nil;
-    
-    // 尝试提取完整的 ISO 8601 时间戳
-    // 格式: YYYY-MM-DDTHH:MM:SSZ 或 YYYY-MM-DD HH:MM:SS
-    NSMutableString *dateString = [NSMutableString string];
-    
-    for (NSUInteger i = offset; i < MIN(offset + 30, length); i++) {
-        char c = bytes[i];
-        
-        // 有效的日期时间字符
-        if ((c >= '0' && c <= '9') || c == '-' || c == ':' || 
-            c == 'T' || c == 'Z' || c == ' ' || c == '.') {
-            [dateString appendFormat:@"%c", c];
-        } else {
-            // 遇到非日期字符，停止
-            break;
-        }
-        
-        // 至少获取 YYYY-MM-DD
-        if (dateString.length >= 10) {
-            break;
-        }
-    }
-    
-    return dateString.length >= 10 ? dateString : nil;
-}
-
-// 解析日期字符串
-- (NSDate *)parseDateString:(NSString *)dateString {
-    if (!dateString || dateString.length < 10) {
-        return nil;
-    }
-    
-    // 尝试多种格式
-    NSArray *formatters = @[
-        [self createDateFormatterWithFormat:@"yyyy-MM-dd'T'HH:mm:ss'Z'"],      // ISO 8601 完整格式
-        [self createDateFormatterWithFormat:@"yyyy-MM-dd'T'HH:mm:ss"],         // ISO 8601 无Z
-        [self createDateFormatterWithFormat:@"yyyy-MM-dd HH:mm:ss"],           // 空格分隔
-        [self createDateFormatterWithFormat:@"yyyy-MM-dd"],                    // 仅日期
-    ];
-    
-    for (NSDateFormatter *formatter in formatters) {
-        NSDate *date = [formatter dateFromString:dateString];
-        if (date) {
-            return date;
-        }
-    }
-    
-    return nil;
-}
-
-// 创建日期格式化器
-- (NSDateFormatter *)createDateFormatterWithFormat:(NSString *)format {
-    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
-    formatter.dateFormat = format;
-    formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
-    formatter.timeZone = [NSTimeZone timeZoneWithName:@"UTC"];
-    return formatter;
-}
-
-// 验证 ASN.1 时间字符串格式
-- (BOOL)isValidASN1TimeString:(NSString *)timeString {
-    if (!timeString || timeString.length < 14) {
-        return NO;
-    }
-    
-    // GeneralizedTime 格式: YYYYMMDDHHMMSSZ
-    // 至少14个字符，以Z结尾
-    return [timeString hasSuffix:@"Z"] && timeString.length >= 14;
-}
-
-// 解析 ASN.1 GeneralizedTime 字符串
-- (NSDate *)parseASN1TimeString:(NSString *)timeString {
-    if (![self isValidASN1TimeString:timeString]) {
-        return nil;
-    }
-    
-    // 格式: YYYYMMDDHHMMSSZ
-    // 提取各个部分
-    if (timeString.length < 14) return nil;
-    
-    NSInteger year = [[timeString substringWithRange:NSMakeRange(0, 4)] integerValue];
-    NSInteger month = [[timeString substringWithRange:NSMakeRange(4, 2)] integerValue];
-    NSInteger day = [[timeString substringWithRange:NSMakeRange(6, 2)] integerValue];
-    NSInteger hour = [[timeString substringWithRange:NSMakeRange(8, 2)] integerValue];
-    NSInteger minute = [[timeString substringWithRange:NSMakeRange(10, 2)] integerValue];
-    NSInteger second = [[timeString substringWithRange:NSMakeRange(12, 2)] integerValue];
-    
-    // 验证范围
-    if (year < 2020 || year > 2100 || 
-        month < 1 || month > 12 || 
-        day < 1 || day > 31 ||
-        hour < 0 || hour > 23 ||
-        minute < 0 || minute > 59 ||
-        second < 0 || second > 59) {
-        return nil;
-    }
-    
-    // 创建日期组件
-    NSDateComponents *components = [[NSDateComponents alloc] init];
-    components.year = year;
-    components.month = month;
-    components.day = day;
-    components.hour = hour;
-    components.minute = minute;
-    components.second = second;
-    components.timeZone = [NSTimeZone timeZoneWithName:@"UTC"];
-    
-    NSCalendar *calendar = [NSCalendar calendarWithIdentifier:NSCalendarIdentifierGregorian];
-    calendar.timeZone = [NSTimeZone timeZoneWithName:@"UTC"];
-    
-    return [calendar dateFromComponents:components];
-}
-
 // 找到最新的有效订阅
 - (NSDictionary *)findLatestValidSubscription:(NSArray *)inAppPurchases {
     if (!inAppPurchases || inAppPurchases.count == 0) {
@@ -1737,6 +1484,53 @@ NSString * const AIUARestoredExistingSubscriptionHint = @"AIUA_RESTORED_EXISTING
     return nil;
 }
 
+#pragma mark - Receipt Verification Snapshot
+
+- (AIUAReceiptSnapshotStore *)receiptSnapshotStore {
+    if (!_receiptSnapshotStore) {
+        _receiptSnapshotStore = [[AIUAReceiptSnapshotStore alloc] initWithReceiptURL:[[NSBundle mainBundle] appStoreReceiptURL]
+                                                                          appVersion:[[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]
+                                                                            defaults:[NSUserDefaults standardUserDefaults]
+                                                                              maxAge:kAIUAReceiptSnapshotMaxAge];
+    }
+    return _receiptSnapshotStore;
+}
+
+- (nullable NSDictionary *)receiptVerificationSnapshotMatchingReceiptFile {
+    return [self.receiptSnapshotStore snapshotMatchingReceiptFileForKey:[self scopedDefaultsKey:kAIUAReceiptVerificationSnapshot]];
+}
+
+- (void)saveReceiptVerificationSnapshotForData:(NSData *)receiptData duration:(CFAbsoluteTime)duration {
+    [self.receiptSnapshotStore saveSnapshotForReceiptData:receiptData
+                                                 duration:duration
+                                                   forKey:[self scopedDefaultsKey:kAIUAReceiptVerificationSnapshot]];
+}
+
+// 大小和修改时间相同不代表内容相同，后台读取收据比对哈希，不一致时回到主线程重新完整验证
+- (void)revalidateReceiptSnapshotInBackground:(NSDictionary *)snapshot {
+    __weak typeof(self) wself = self;
+    [self.receiptSnapshotStore revalidateSnapshot:snapshot completionQueue:dispatch_get_main_queue() mismatchHandler:^{
+        __strong typeof(wself) sself = wself;
+        if (!sself) {
+            return;
+        }
+        NSLog(@"[IAP] 后台复核不一致，重新完整验证");
+        BOOL wasVIPMember = sself.isVIPMember;
+        NSDate *previousExpiryDate = sself.subscriptionExpiryDate;
+        [sself invalidateReceiptVerificationSnapshot];
+        [sself checkSubscriptionStatus];
+        if (wasVIPMember != sself.isVIPMember ||
+            (previousExpiryDate != sself.subscriptionExpiryDate && ![previousExpiryDate isEqualToDate:sself.subscriptionExpiryDate])) {
+            [[NSNotificationCenter defaultCenter] postNotificationName:@"AIUASubscriptionStatusChanged" object:nil];
+        }
+    }];
+}
+
+- (void)invalidateReceiptVerificationSnapshot {
+    self.lastReceiptVerificationTime = nil;
+    [self.receiptSnapshotStore invalidateSnapshotForKey:[self scopedDefaultsKey:kAIUAReceiptVerificationSnapshot]];
+}
+
 #pragma mark - VIP Member Status
 
 // 重写 isVIPMember 的 getter，根据配置开关决定是否进行检测
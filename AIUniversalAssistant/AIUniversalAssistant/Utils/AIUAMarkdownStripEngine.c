@@ -0,0 +1,492 @@
+//
+//  AIUAMarkdownStripEngine.c
+//  AIUniversalAssistant
+//
+//  Markdown 符号移除引擎实现
+//
+//  各阶段与原正则的对应关系（均不跨越换行符，"." 不匹配的字符见 AIUAMDIsLineTerminator）：
+//  粗体 (\*\*|__)(.*?)\1          -> $2
+//  斜体 (\*|_)(.*?)\1             -> $2
+//  标题 ^(#{1,6})\s+（多行模式）  -> ""
+//  代码 `(.*?)`                   -> $1
+//  链接 \[(.*?)\]\(.*?\)          -> $1
+//  正则在某位置匹配失败后会从下一个位置重新尝试，粗体/斜体阶段对应地把缓存的内容重新送回本阶段；
+//  代码/链接阶段匹配失败说明本行后续也不可能再匹配，直接原样输出
+//
+
+#include "AIUAMarkdownStripEngine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint16_t *characters;
+    size_t length;
+    size_t capacity;
+} AIUAMDBuffer;
+
+typedef enum {
+    AIUAMDHeaderStateNormal = 0,
+    AIUAMDHeaderStateHashes,    // 行首已读到若干 '#'
+    AIUAMDHeaderStateSpaces,    // 已匹配 '#'+空白，继续吞掉后续空白
+} AIUAMDHeaderState;
+
+typedef enum {
+    AIUAMDLinkStateIdle = 0,
+    AIUAMDLinkStateText,        // 已读到 '['，寻找 "]("
+    AIUAMDLinkStateTarget,      // 已读到 "]("，寻找 ')'
+} AIUAMDLinkState;
+
+struct AIUAMarkdownStripEngine {
+    // 粗体：held 为待确认的单个 '*'/'_'，marker 非 0 表示已打开
+    uint16_t boldHeld;
+    uint16_t boldMarker;
+    AIUAMDBuffer boldContent;
+    AIUAMDBuffer boldSpare;
+
+    // 斜体
+    uint16_t italicMarker;
+    AIUAMDBuffer italicContent;
+    AIUAMDBuffer italicSpare;
+
+    // 标题
+    AIUAMDHeaderState headerState;
+    bool headerLineStart;
+    int headerHashCount;
+
+    // 行内代码
+    bool codeOpen;
+    AIUAMDBuffer codeContent;
+
+    // 链接（buffer 保存 '[' 之后的全部字符）
+    AIUAMDLinkState linkState;
+    size_t linkTextLength;
+    AIUAMDBuffer linkBuffer;
+
+    AIUAMDBuffer output;
+    bool failed;
+};
+
+#pragma mark - 字符分类（与 ICU 正则一致）
+
+// "." 不匹配的行结束符；多行模式下 '^' 也以它们为行首依据
+static inline bool AIUAMDIsLineTerminator(uint16_t c) {
+    return (c >= 0x0A && c <= 0x0D) || c == 0x85 || c == 0x2028 || c == 0x2029;
+}
+
+// \s（ICU 中为 \p{White_Space}）
+static inline bool AIUAMDIsWhitespace(uint16_t c) {
+    if (c <= 0x20) {
+        return c == 0x20 || (c >= 0x09 && c <= 0x0D);
+    }
+    if (c < 0x85) {
+        return false;
+    }
+    return c == 0x85 || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A) ||
+           c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+}
+
+#pragma mark - 缓冲区
+
+static bool AIUAMDBufferReserve(AIUAMarkdownStripEngine *engine, AIUAMDBuffer *buffer, size_t extra) {
+    size_t required = buffer->length + extra;
+    if (required <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 64;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    uint16_t *characters = (uint16_t *)realloc(buffer->characters, capacity * sizeof(uint16_t));
+    if (!characters) {
+        engine->failed = true;
+        return false;
+    }
+    buffer->characters = characters;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static inline void AIUAMDBufferAppend(AIUAMarkdownStripEngine *engine, AIUAMDBuffer *buffer, uint16_t c) {
+    if (buffer->length < buffer->capacity || AIUAMDBufferReserve(engine, buffer, 1)) {
+        buffer->characters[buffer->length++] = c;
+    }
+}
+
+static void AIUAMDBufferFree(AIUAMDBuffer *buffer) {
+    free(buffer->characters);
+    buffer->characters = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+static void AIUAMDSwapBuffers(AIUAMDBuffer *a, AIUAMDBuffer *b) {
+    AIUAMDBuffer temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+#pragma mark - 链接阶段（流水线末端）
+
+static inline void AIUAMDEmit(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    AIUAMDBufferAppend(engine, &engine->output, c);
+}
+
+static void AIUAMDEmitRange(AIUAMarkdownStripEngine *engine, const uint16_t *characters, size_t length) {
+    if (length == 0 || !AIUAMDBufferReserve(engine, &engine->output, length)) {
+        return;
+    }
+    memcpy(engine->output.characters + engine->output.length, characters, length * sizeof(uint16_t));
+    engine->output.length += length;
+}
+
+static void AIUAMDLinkFail(AIUAMarkdownStripEngine *engine) {
+    AIUAMDEmit(engine, '[');
+    AIUAMDEmitRange(engine, engine->linkBuffer.characters, engine->linkBuffer.length);
+    engine->linkBuffer.length = 0;
+    engine->linkState = AIUAMDLinkStateIdle;
+}
+
+static void AIUAMDLinkPush(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    AIUAMDBuffer *buffer = &engine->linkBuffer;
+    switch (engine->linkState) {
+        case AIUAMDLinkStateIdle:
+            if (c == '[') {
+                engine->linkState = AIUAMDLinkStateText;
+                buffer->length = 0;
+            } else {
+                AIUAMDEmit(engine, c);
+            }
+            return;
+        case AIUAMDLinkStateText:
+            if (AIUAMDIsLineTerminator(c)) {
+                break;
+            }
+            if (c == '(' && buffer->length > 0 && buffer->characters[buffer->length - 1] == ']') {
+                // 最早出现的 "](" 决定链接文字
+                engine->linkTextLength = buffer->length - 1;
+                engine->linkState = AIUAMDLinkStateTarget;
+            }
+            AIUAMDBufferAppend(engine, buffer, c);
+            return;
+        case AIUAMDLinkStateTarget:
+            if (AIUAMDIsLineTerminator(c)) {
+                break;
+            }
+            if (c == ')') {
+                AIUAMDEmitRange(engine, buffer->characters, engine->linkTextLength);
+                buffer->length = 0;
+                engine->linkState = AIUAMDLinkStateIdle;
+                return;
+            }
+            AIUAMDBufferAppend(engine, buffer, c);
+            return;
+    }
+    // 行内没有完整的 [..](..)：本行剩余部分也不可能再匹配，原样输出
+    AIUAMDLinkFail(engine);
+    AIUAMDEmit(engine, c);
+}
+
+#pragma mark - 代码阶段
+
+static void AIUAMDCodeFail(AIUAMarkdownStripEngine *engine) {
+    AIUAMDLinkPush(engine, '`');
+    for (size_t i = 0; i < engine->codeContent.length; i++) {
+        AIUAMDLinkPush(engine, engine->codeContent.characters[i]);
+    }
+    engine->codeContent.length = 0;
+    engine->codeOpen = false;
+}
+
+static void AIUAMDCodePush(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    if (engine->codeOpen) {
+        if (c == '`') {
+            for (size_t i = 0; i < engine->codeContent.length; i++) {
+                AIUAMDLinkPush(engine, engine->codeContent.characters[i]);
+            }
+            engine->codeContent.length = 0;
+            engine->codeOpen = false;
+        } else if (AIUAMDIsLineTerminator(c)) {
+            // 缓存内容中不含 '`'，原样输出即可
+            AIUAMDCodeFail(engine);
+            AIUAMDLinkPush(engine, c);
+        } else {
+            AIUAMDBufferAppend(engine, &engine->codeContent, c);
+        }
+        return;
+    }
+    if (c == '`') {
+        engine->codeOpen = true;
+        engine->codeContent.length = 0;
+        return;
+    }
+    AIUAMDLinkPush(engine, c);
+}
+
+#pragma mark - 标题阶段
+
+static void AIUAMDHeaderEmitHashes(AIUAMarkdownStripEngine *engine) {
+    for (int i = 0; i < engine->headerHashCount; i++) {
+        AIUAMDCodePush(engine, '#');
+    }
+    engine->headerHashCount = 0;
+}
+
+static void AIUAMDHeaderPush(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    switch (engine->headerState) {
+        case AIUAMDHeaderStateHashes:
+            if (c == '#') {
+                engine->headerHashCount += 1;
+                if (engine->headerHashCount > 6) {
+                    AIUAMDHeaderEmitHashes(engine);
+                    engine->headerState = AIUAMDHeaderStateNormal;
+                    engine->headerLineStart = false;
+                }
+                return;
+            }
+            if (AIUAMDIsWhitespace(c)) {
+                engine->headerHashCount = 0;
+                engine->headerState = AIUAMDHeaderStateSpaces;
+                engine->headerLineStart = AIUAMDIsLineTerminator(c);
+                return;
+            }
+            AIUAMDHeaderEmitHashes(engine);
+            engine->headerState = AIUAMDHeaderStateNormal;
+            engine->headerLineStart = false;
+            break;
+        case AIUAMDHeaderStateSpaces:
+            // \s+ 贪婪匹配，会跨过换行继续吞掉空白
+            if (AIUAMDIsWhitespace(c)) {
+                engine->headerLineStart = AIUAMDIsLineTerminator(c);
+                return;
+            }
+            engine->headerState = AIUAMDHeaderStateNormal;
+            break;
+        case AIUAMDHeaderStateNormal:
+            break;
+    }
+
+    if (engine->headerLineStart && c == '#') {
+        engine->headerState = AIUAMDHeaderStateHashes;
+        engine->headerHashCount = 1;
+        return;
+    }
+    AIUAMDCodePush(engine, c);
+    engine->headerLineStart = AIUAMDIsLineTerminator(c);
+}
+
+#pragma mark - 斜体阶段
+
+static void AIUAMDItalicPush(AIUAMarkdownStripEngine *engine, uint16_t c);
+
+// 当前位置匹配失败：输出起始符，把其后的缓存内容重新送回本阶段（从下一个位置重新尝试）
+static void AIUAMDItalicFail(AIUAMarkdownStripEngine *engine) {
+    uint16_t marker = engine->italicMarker;
+    engine->italicMarker = 0;
+    AIUAMDHeaderPush(engine, marker);
+    AIUAMDSwapBuffers(&engine->italicContent, &engine->italicSpare);
+    AIUAMDBuffer *pending = &engine->italicSpare;
+    for (size_t i = 0; i < pending->length; i++) {
+        AIUAMDItalicPush(engine, pending->characters[i]);
+    }
+    pending->length = 0;
+}
+
+static void AIUAMDItalicPush(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    if (engine->italicMarker) {
+        if (c == engine->italicMarker) {
+            for (size_t i = 0; i < engine->italicContent.length; i++) {
+                AIUAMDHeaderPush(engine, engine->italicContent.characters[i]);
+            }
+            engine->italicContent.length = 0;
+            engine->italicMarker = 0;
+        } else if (AIUAMDIsLineTerminator(c)) {
+            AIUAMDItalicFail(engine);
+            AIUAMDItalicPush(engine, c);
+        } else {
+            AIUAMDBufferAppend(engine, &engine->italicContent, c);
+        }
+        return;
+    }
+    if (c == '*' || c == '_') {
+        engine->italicMarker = c;
+        engine->italicContent.length = 0;
+        return;
+    }
+    AIUAMDHeaderPush(engine, c);
+}
+
+#pragma mark - 粗体阶段
+
+static void AIUAMDBoldPush(AIUAMarkdownStripEngine *engine, uint16_t c);
+
+static void AIUAMDBoldFail(AIUAMarkdownStripEngine *engine) {
+    uint16_t marker = engine->boldMarker;
+    engine->boldMarker = 0;
+    AIUAMDItalicPush(engine, marker);
+    AIUAMDSwapBuffers(&engine->boldContent, &engine->boldSpare);
+    // 下一个尝试位置是起始符的第二个字符
+    AIUAMDBoldPush(engine, marker);
+    AIUAMDBuffer *pending = &engine->boldSpare;
+    for (size_t i = 0; i < pending->length; i++) {
+        AIUAMDBoldPush(engine, pending->characters[i]);
+    }
+    pending->length = 0;
+}
+
+static void AIUAMDBoldPush(AIUAMarkdownStripEngine *engine, uint16_t c) {
+    if (engine->boldMarker) {
+        AIUAMDBuffer *content = &engine->boldContent;
+        if (c == engine->boldMarker && content->length > 0 && content->characters[content->length - 1] == c) {
+            // 最早出现的成对结束符
+            content->length -= 1;
+            for (size_t i = 0; i < content->length; i++) {
+                AIUAMDItalicPush(engine, content->characters[i]);
+            }
+            content->length = 0;
+            engine->boldMarker = 0;
+        } else if (AIUAMDIsLineTerminator(c)) {
+            AIUAMDBoldFail(engine);
+            AIUAMDBoldPush(engine, c);
+        } else {
+            AIUAMDBufferAppend(engine, content, c);
+        }
+        return;
+    }
+    if (engine->boldHeld) {
+        uint16_t held = engine->boldHeld;
+        engine->boldHeld = 0;
+        if (c == held) {
+            engine->boldMarker = held;
+            engine->boldContent.length = 0;
+            return;
+        }
+        AIUAMDItalicPush(engine, held);
+    }
+    if (c == '*' || c == '_') {
+        engine->boldHeld = c;
+        return;
+    }
+    AIUAMDItalicPush(engine, c);
+}
+
+#pragma mark - 公开接口
+
+AIUAMarkdownStripEngine *AIUAMarkdownStripEngineCreate(void) {
+    AIUAMarkdownStripEngine *engine = (AIUAMarkdownStripEngine *)calloc(1, sizeof(AIUAMarkdownStripEngine));
+    if (engine) {
+        engine->headerLineStart = true;
+    }
+    return engine;
+}
+
+void AIUAMarkdownStripEngineDestroy(AIUAMarkdownStripEngine *engine) {
+    if (!engine) {
+        return;
+    }
+    AIUAMDBufferFree(&engine->boldContent);
+    AIUAMDBufferFree(&engine->boldSpare);
+    AIUAMDBufferFree(&engine->italicContent);
+    AIUAMDBufferFree(&engine->italicSpare);
+    AIUAMDBufferFree(&engine->codeContent);
+    AIUAMDBufferFree(&engine->linkBuffer);
+    AIUAMDBufferFree(&engine->output);
+    free(engine);
+}
+
+void AIUAMarkdownStripEngineReset(AIUAMarkdownStripEngine *engine) {
+    engine->boldHeld = 0;
+    engine->boldMarker = 0;
+    engine->boldContent.length = 0;
+    engine->boldSpare.length = 0;
+    engine->italicMarker = 0;
+    engine->italicContent.length = 0;
+    engine->italicSpare.length = 0;
+    engine->headerState = AIUAMDHeaderStateNormal;
+    engine->headerLineStart = true;
+    engine->headerHashCount = 0;
+    engine->codeOpen = false;
+    engine->codeContent.length = 0;
+    engine->linkState = AIUAMDLinkStateIdle;
+    engine->linkTextLength = 0;
+    engine->linkBuffer.length = 0;
+    engine->output.length = 0;
+    engine->failed = false;
+}
+
+// 所有阶段都处于空闲状态，普通字符可以直接输出
+static inline bool AIUAMDEngineIsIdle(const AIUAMarkdownStripEngine *engine) {
+    return !engine->boldHeld && !engine->boldMarker && !engine->italicMarker &&
+           engine->headerState == AIUAMDHeaderStateNormal && !engine->codeOpen &&
+           engine->linkState == AIUAMDLinkStateIdle;
+}
+
+// 不会改变任何阶段状态的字符（标记符和行结束符之外）
+static inline bool AIUAMDIsPlain(uint16_t c) {
+    switch (c) {
+        case '*': case '_': case '#': case '`': case '[':
+            return false;
+        default:
+            return !AIUAMDIsLineTerminator(c);
+    }
+}
+
+void AIUAMarkdownStripEngineFeed(AIUAMarkdownStripEngine *engine, const uint16_t *characters, size_t length) {
+    // 大多数输出与输入等长，预留空间减少扩容次数
+    AIUAMDBufferReserve(engine, &engine->output, length);
+    size_t i = 0;
+    while (i < length) {
+        if (AIUAMDEngineIsIdle(engine) && AIUAMDIsPlain(characters[i])) {
+            // 快速路径：连续的普通字符整段拷贝
+            size_t start = i;
+            while (i < length && AIUAMDIsPlain(characters[i])) {
+                i++;
+            }
+            AIUAMDEmitRange(engine, characters + start, i - start);
+            engine->headerLineStart = false;
+            continue;
+        }
+        AIUAMDBoldPush(engine, characters[i]);
+        i++;
+    }
+}
+
+void AIUAMarkdownStripEngineFinish(AIUAMarkdownStripEngine *engine) {
+    // 按流水线顺序依次收尾，前一阶段输出的内容还会经过后续阶段
+    while (engine->boldMarker) {
+        AIUAMDBoldFail(engine);
+    }
+    if (engine->boldHeld) {
+        uint16_t held = engine->boldHeld;
+        engine->boldHeld = 0;
+        AIUAMDItalicPush(engine, held);
+    }
+    while (engine->italicMarker) {
+        AIUAMDItalicFail(engine);
+    }
+    if (engine->headerState == AIUAMDHeaderStateHashes) {
+        AIUAMDHeaderEmitHashes(engine);
+    }
+    engine->headerState = AIUAMDHeaderStateNormal;
+    if (engine->codeOpen) {
+        AIUAMDCodeFail(engine);
+    }
+    if (engine->linkState != AIUAMDLinkStateIdle) {
+        AIUAMDLinkFail(engine);
+    }
+}
+
+const uint16_t *AIUAMarkdownStripEngineGetOutput(const AIUAMarkdownStripEngine *engine, size_t *length) {
+    if (length) {
+        *length = engine->output.length;
+    }
+    return engine->output.characters;
+}
+
+void AIUAMarkdownStripEngineClearOutput(AIUAMarkdownStripEngine *engine) {
+    engine->output.length = 0;
+}
+
+bool AIUAMarkdownStripEngineHasFailed(const AIUAMarkdownStripEngine *engine) {
+    return engine->failed;
+}
@@ -0,0 +1,54 @@
+//
+//  AIUAMarkdownStripEngine.h
+//  AIUniversalAssistant
+//
+//  Markdown 符号移除引擎，纯C实现
+//  - 逐字符（UTF-16）一次遍历，替代 removeMarkdownSymbols: 中依次执行的五个正则
+//  - 粗体、斜体、标题、行内代码、链接五个阶段串联为流水线，每个阶段都是流式状态机，
+//    输出与原正则级联（粗体 -> 斜体 -> 标题 -> 代码 -> 链接）逐字一致
+//  - 支持流式输入：状态跨 chunk 保留，"**bo" + "ld**" 与整段输入结果相同；
+//    尚未确定的片段（例如未闭合的 "**"）最多缓存到行尾
+//
+
+#ifndef AIUAMarkdownStripEngine_h
+#define AIUAMarkdownStripEngine_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AIUAMarkdownStripEngine AIUAMarkdownStripEngine;
+
+/// 创建引擎，失败返回 NULL
+AIUAMarkdownStripEngine *AIUAMarkdownStripEngineCreate(void);
+
+/// 释放引擎
+void AIUAMarkdownStripEngineDestroy(AIUAMarkdownStripEngine *engine);
+
+/// 重置为新文本的初始状态（保留已分配的缓冲区）
+void AIUAMarkdownStripEngineReset(AIUAMarkdownStripEngine *engine);
+
+/// 输入一段 UTF-16 文本，已确定的结果追加到输出缓冲区
+void AIUAMarkdownStripEngineFeed(AIUAMarkdownStripEngine *engine, const uint16_t *characters, size_t length);
+
+/// 文本结束：把所有未闭合的片段按原样输出
+void AIUAMarkdownStripEngineFinish(AIUAMarkdownStripEngine *engine);
+
+/// 当前累积的输出（调用 ClearOutput 之前有效）
+const uint16_t *AIUAMarkdownStripEngineGetOutput(const AIUAMarkdownStripEngine *engine, size_t *length);
+
+/// 清空输出缓冲区（不影响解析状态）
+void AIUAMarkdownStripEngineClearOutput(AIUAMarkdownStripEngine *engine);
+
+/// 内存分配失败后为 true，此时输出不可信，调用方应回退到其他实现
+bool AIUAMarkdownStripEngineHasFailed(const AIUAMarkdownStripEngine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAMarkdownStripEngine_h */
@@ -0,0 +1,32 @@
+//
+//  AIUAMarkdownStripper.h
+//  AIUniversalAssistant
+//
+//  Markdown 符号移除（AIUAMarkdownStripEngine 的 Objective-C 封装）
+//  与 +[AIUAToolsManager removeMarkdownSymbols:] 输出一致，另外提供跨 chunk 的流式模式
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAMarkdownStripper : NSObject
+
+/// 一次性处理整段文本，内存分配失败时返回 nil
++ (nullable NSString *)stripMarkdownInText:(NSString *)text;
+
+/**
+ * 流式输入一个 chunk
+ * @return 本次已经确定的输出（未闭合的标记会缓存到闭合或行尾再输出），可能为空串
+ */
+- (NSString *)appendChunk:(NSString *)chunk;
+
+/// 结束当前文本，返回缓存中剩余的输出，之后可继续用于下一段文本
+- (NSString *)finish;
+
+/// 丢弃缓存，开始新的文本
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
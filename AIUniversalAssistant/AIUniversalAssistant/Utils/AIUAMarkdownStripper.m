@@ -0,0 +1,94 @@
+//
+//  AIUAMarkdownStripper.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAMarkdownStripper.h"
+#import "AIUAMarkdownStripEngine.h"
+
+// 小段文本使用栈上缓冲区，避免每个 chunk 都分配内存
+static const NSUInteger kAIUAMarkdownStackBufferLength = 512;
+
+@implementation AIUAMarkdownStripper {
+    AIUAMarkdownStripEngine *_engine;
+}
+
++ (nullable NSString *)stripMarkdownInText:(NSString *)text {
+    if (text.length == 0) {
+        return @"";
+    }
+    AIUAMarkdownStripper *stripper = [[AIUAMarkdownStripper alloc] init];
+    if (!stripper->_engine) {
+        return nil;
+    }
+    NSMutableString *result = [NSMutableString stringWithString:[stripper appendChunk:text]];
+    AIUAMarkdownStripEngineFinish(stripper->_engine);
+    if (AIUAMarkdownStripEngineHasFailed(stripper->_engine)) {
+        return nil;
+    }
+    [result appendString:[stripper takeOutput]];
+    return [result copy];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _engine = AIUAMarkdownStripEngineCreate();
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AIUAMarkdownStripEngineDestroy(_engine);
+}
+
+- (NSString *)appendChunk:(NSString *)chunk {
+    NSUInteger length = chunk.length;
+    if (!_engine || length == 0) {
+        return @"";
+    }
+    
+    const UniChar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)chunk);
+    if (characters) {
+        AIUAMarkdownStripEngineFeed(_engine, characters, length);
+    } else if (length <= kAIUAMarkdownStackBufferLength) {
+        UniChar buffer[kAIUAMarkdownStackBufferLength];
+        [chunk getCharacters:buffer range:NSMakeRange(0, length)];
+        AIUAMarkdownStripEngineFeed(_engine, buffer, length);
+    } else {
+        UniChar *buffer = (UniChar *)malloc(length * sizeof(UniChar));
+        if (!buffer) {
+            return @"";
+        }
+        [chunk getCharacters:buffer range:NSMakeRange(0, length)];
+        AIUAMarkdownStripEngineFeed(_engine, buffer, length);
+        free(buffer);
+    }
+    return [self takeOutput];
+}
+
+- (NSString *)finish {
+    if (!_engine) {
+        return @"";
+    }
+    AIUAMarkdownStripEngineFinish(_engine);
+    NSString *output = [self takeOutput];
+    AIUAMarkdownStripEngineReset(_engine);
+    return output;
+}
+
+- (void)reset {
+    if (_engine) {
+        AIUAMarkdownStripEngineReset(_engine);
+    }
+}
+
+- (NSString *)takeOutput {
+    size_t length = 0;
+    const uint16_t *characters = AIUAMarkdownStripEngineGetOutput(_engine, &length);
+    NSString *output = length > 0 ? [[NSString alloc] initWithCharacters:characters length:length] : @"";
+    AIUAMarkdownStripEngineClearOutput(_engine);
+    return output;
+}
+
+@end
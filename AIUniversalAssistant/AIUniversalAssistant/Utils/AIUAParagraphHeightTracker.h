@@ -0,0 +1,30 @@
+//
+//  AIUAParagraphHeightTracker.h
+//  AIUniversalAssistant
+//
+//  文本高度的增量计算（AIUAParagraphLayoutEngine 的 Objective-C 封装）
+//  每次输入只重新测量改动所在的段落，其余段落沿用缓存的高度；长文档逐字输入时不再整篇排版
+//  高度与 UITextView 的文本排版一致（不含 textContainerInset），字体或宽度变化后全部重新测量
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAParagraphHeightTracker : NSObject
+
+/// 字体，变化后下次计算全量测量
+@property (nonatomic, strong) UIFont *font;
+/// 排版宽度（文本容器宽度减去左右 lineFragmentPadding），变化后下次计算全量测量
+@property (nonatomic, assign) CGFloat width;
+/// 最近一次计算重新测量的段落数
+@property (nonatomic, assign, readonly) NSUInteger lastMeasuredParagraphCount;
+
+- (instancetype)initWithFont:(UIFont *)font width:(CGFloat)width;
+
+/// 按排版宽度与字体计算文本高度（已向上取整），只重新测量与上一次文本不同的段落
+- (CGFloat)heightForText:(nullable NSString *)text;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,115 @@
+//
+//  AIUAParagraphHeightTracker.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAParagraphHeightTracker.h"
+#import "AIUAParagraphLayoutEngine.h"
+
+// 小段文本使用栈上缓冲区
+static const NSUInteger kAIUAParagraphHeightStackBufferLength = 512;
+
+@interface AIUAParagraphHeightTracker ()
+
+@property (nonatomic, copy) NSDictionary<NSAttributedStringKey, id> *attributes;
+
+- (CGFloat)measureParagraph:(NSString *)paragraph;
+
+@end
+
+// 测量单个段落；空段落占一行
+static double AIUAParagraphHeightTrackerMeasure(const uint16_t *characters, size_t length, void *context) {
+    AIUAParagraphHeightTracker *tracker = (__bridge AIUAParagraphHeightTracker *)context;
+    if (length == 0) {
+        return tracker.font.lineHeight;
+    }
+    CFStringRef paragraph = CFStringCreateWithCharactersNoCopy(kCFAllocatorDefault, characters, (CFIndex)length, kCFAllocatorNull);
+    if (!paragraph) {
+        return tracker.font.lineHeight;
+    }
+    CGFloat height = [tracker measureParagraph:(__bridge NSString *)paragraph];
+    CFRelease(paragraph);
+    return height;
+}
+
+@implementation AIUAParagraphHeightTracker {
+    AIUAParagraphLayoutEngine *_engine;
+}
+
+- (instancetype)initWithFont:(UIFont *)font width:(CGFloat)width {
+    self = [super init];
+    if (self) {
+        _font = font;
+        _width = width;
+        _attributes = @{NSFontAttributeName: font};
+        _engine = AIUAParagraphLayoutEngineCreate(AIUAParagraphHeightTrackerMeasure, (__bridge void *)self);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AIUAParagraphLayoutEngineDestroy(_engine);
+}
+
+- (void)setFont:(UIFont *)font {
+    if ([_font isEqual:font]) {
+        return;
+    }
+    _font = font;
+    self.attributes = @{NSFontAttributeName: font};
+    AIUAParagraphLayoutEngineInvalidate(_engine);
+}
+
+- (void)setWidth:(CGFloat)width {
+    if (_width == width) {
+        return;
+    }
+    _width = width;
+    AIUAParagraphLayoutEngineInvalidate(_engine);
+}
+
+- (NSUInteger)lastMeasuredParagraphCount {
+    return (NSUInteger)AIUAParagraphLayoutEngineGetLastMeasuredCount(_engine);
+}
+
+- (CGFloat)measureParagraph:(NSString *)paragraph {
+    CGRect rect = [paragraph boundingRectWithSize:CGSizeMake(MAX(self.width, 1), CGFLOAT_MAX)
+                                          options:NSStringDrawingUsesLineFragmentOrigin | NSStringDrawingUsesFontLeading
+                                       attributes:self.attributes
+                                          context:nil];
+    return MAX(CGRectGetHeight(rect), self.font.lineHeight);
+}
+
+- (CGFloat)heightForText:(NSString *)text {
+    NSString *content = text ?: @"";
+    if (!_engine) {
+        return ceil([self measureParagraph:content]);
+    }
+    NSUInteger length = content.length;
+    AIUAParagraphLayoutEngine *engine = _engine;
+    BOOL success = YES;
+    const UniChar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)content);
+    if (characters || length == 0) {
+        success = AIUAParagraphLayoutEngineSetText(engine, characters, length);
+    } else if (length <= kAIUAParagraphHeightStackBufferLength) {
+        UniChar buffer[kAIUAParagraphHeightStackBufferLength];
+        [content getCharacters:buffer range:NSMakeRange(0, length)];
+        success = AIUAParagraphLayoutEngineSetText(engine, buffer, length);
+    } else {
+        UniChar *buffer = (UniChar *)malloc(length * sizeof(UniChar));
+        if (buffer) {
+            [content getCharacters:buffer range:NSMakeRange(0, length)];
+            success = AIUAParagraphLayoutEngineSetText(engine, buffer, length);
+            free(buffer);
+        } else {
+            success = NO;
+        }
+    }
+    if (!success) {
+        // 内存不足时整段测量
+        return ceil([self measureParagraph:content]);
+    }
+    return ceil(AIUAParagraphLayoutEngineGetHeight(engine));
+}
+
+@end
@@ -0,0 +1,310 @@
+//
+//  AIUAParagraphLayoutEngine.c
+//  AIUniversalAssistant
+//
+//  段落表：lengths[i] 为第 i 段的码元数（含段落分隔符），heights[i] 为该段高度
+//  最后一段没有分隔符（可能为空）；\r\n 作为一个分隔符，归属于它前面的段落
+//
+
+#include "AIUAParagraphLayoutEngine.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct AIUAParagraphLayoutEngine {
+    AIUAParagraphMeasure measure;
+    void *context;
+
+    // 上一次的文本，用于比较改动范围
+    uint16_t *text;
+    size_t length;
+    size_t textCapacity;
+
+    size_t *lengths;
+    double *heights;
+    size_t count;
+    size_t capacity;
+
+    double totalHeight;
+    size_t lastMeasuredCount;
+    bool valid;     // 段落表与 text 一致
+};
+
+#pragma mark - 段落划分
+
+// characters[index] 是否为段落分隔符；\r\n 中的 \r 不算，由其后的 \n 结束段落
+static bool AIUAParagraphIsTerminator(const uint16_t *characters, size_t length, size_t index) {
+    uint16_t c = characters[index];
+    if (c == '\n' || c == 0x2029) {
+        return true;
+    }
+    if (c == '\r') {
+        return !(index + 1 < length && characters[index + 1] == '\n');
+    }
+    return false;
+}
+
+// 段落内容长度（去掉末尾的分隔符）
+static size_t AIUAParagraphContentLength(const uint16_t *paragraph, size_t length, bool terminated) {
+    if (!terminated || length == 0) {
+        return length;
+    }
+    size_t content = length - 1;
+    if (paragraph[content] == '\n' && content > 0 && paragraph[content - 1] == '\r') {
+        content -= 1;
+    }
+    return content;
+}
+
+typedef struct {
+    size_t *lengths;
+    double *heights;
+    size_t count;
+    size_t capacity;
+} AIUAParagraphList;
+
+static bool AIUAParagraphListAppend(AIUAParagraphList *list, size_t length, double height) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        size_t *lengths = (size_t *)realloc(list->lengths, capacity * sizeof(size_t));
+        if (!lengths) {
+            return false;
+        }
+        list->lengths = lengths;
+        double *heights = (double *)realloc(list->heights, capacity * sizeof(double));
+        if (!heights) {
+            return false;
+        }
+        list->heights = heights;
+        list->capacity = capacity;
+    }
+    list->lengths[list->count] = length;
+    list->heights[list->count] = height;
+    list->count += 1;
+    return true;
+}
+
+static void AIUAParagraphListFree(AIUAParagraphList *list) {
+    free(list->lengths);
+    free(list->heights);
+}
+
+// 切分并测量 characters[start, end)；includesLast 为 false 时区间以分隔符结束
+static bool AIUAParagraphLayoutMeasureRegion(const AIUAParagraphLayoutEngine *engine,
+                                             const uint16_t *characters, size_t length,
+                                             size_t start, size_t end, bool includesLast,
+                                             AIUAParagraphList *list) {
+    size_t paragraphStart = start;
+    for (size_t i = start; i < end; i++) {
+        if (!AIUAParagraphIsTerminator(characters, length, i)) {
+            continue;
+        }
+        size_t paragraphLength = i + 1 - paragraphStart;
+        size_t contentLength = AIUAParagraphContentLength(characters + paragraphStart, paragraphLength, true);
+        double height = engine->measure(characters + paragraphStart, contentLength, engine->context);
+        if (!AIUAParagraphListAppend(list, paragraphLength, height)) {
+            return false;
+        }
+        paragraphStart = i + 1;
+    }
+    // 文本末尾的段落没有分隔符（可能为空）
+    if (includesLast) {
+        size_t paragraphLength = end - paragraphStart;
+        double height = engine->measure(characters + paragraphStart, paragraphLength, engine->context);
+        if (!AIUAParagraphListAppend(list, paragraphLength, height)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 包含 offset 的段落；offset 为文本末尾时返回最后一段。*start 返回该段起始偏移
+static size_t AIUAParagraphLayoutIndexAtOffset(const AIUAParagraphLayoutEngine *engine, size_t offset, size_t *start) {
+    size_t position = 0;
+    for (size_t i = 0; i < engine->count; i++) {
+        if (offset < position + engine->lengths[i] || i + 1 == engine->count) {
+            *start = position;
+            return i;
+        }
+        position += engine->lengths[i];
+    }
+    *start = 0;
+    return 0;
+}
+
+#pragma mark - 生命周期
+
+AIUAParagraphLayoutEngine *AIUAParagraphLayoutEngineCreate(AIUAParagraphMeasure measure, void *context) {
+    if (!measure) {
+        return NULL;
+    }
+    AIUAParagraphLayoutEngine *engine = (AIUAParagraphLayoutEngine *)calloc(1, sizeof(AIUAParagraphLayoutEngine));
+    if (!engine) {
+        return NULL;
+    }
+    engine->measure = measure;
+    engine->context = context;
+    return engine;
+}
+
+void AIUAParagraphLayoutEngineDestroy(AIUAParagraphLayoutEngine *engine) {
+    if (!engine) {
+        return;
+    }
+    free(engine->text);
+    free(engine->lengths);
+    free(engine->heights);
+    free(engine);
+}
+
+void AIUAParagraphLayoutEngineInvalidate(AIUAParagraphLayoutEngine *engine) {
+    if (engine) {
+        engine->valid = false;
+    }
+}
+
+static void AIUAParagraphLayoutReset(AIUAParagraphLayoutEngine *engine) {
+    engine->valid = false;
+    engine->count = 0;
+    engine->length = 0;
+    engine->totalHeight = 0;
+}
+
+#pragma mark - 更新
+
+bool AIUAParagraphLayoutEngineSetText(AIUAParagraphLayoutEngine *engine, const uint16_t *characters, size_t length) {
+    if (!engine || (!characters && length > 0)) {
+        return false;
+    }
+    engine->lastMeasuredCount = 0;
+
+    // 改动范围：旧文本 [prefix, oldLength - suffix) 被替换为新文本 [prefix, length - suffix)
+    size_t oldLength = engine->length;
+    size_t firstIndex = 0;
+    size_t lastIndex = 0;
+    size_t regionStart = 0;
+    size_t oldRegionEnd = 0;
+    bool includesLast = true;
+    if (engine->valid && engine->count > 0) {
+        size_t common = oldLength < length ? oldLength : length;
+        size_t prefix = 0;
+        while (prefix < common && engine->text[prefix] == characters[prefix]) {
+            prefix++;
+        }
+        if (prefix == oldLength && prefix == length) {
+            return true;
+        }
+        size_t suffix = 0;
+        while (suffix < common - prefix &&
+               engine->text[oldLength - 1 - suffix] == characters[length - 1 - suffix]) {
+            suffix++;
+        }
+
+        size_t firstStart = 0;
+        firstIndex = AIUAParagraphLayoutIndexAtOffset(engine, prefix, &firstStart);
+        // 前一段一起重测：改动可能与前一段末尾的 \r 组成 \r\n
+        if (firstIndex > 0) {
+            firstIndex -= 1;
+            firstStart -= engine->lengths[firstIndex];
+        }
+        size_t lastStart = 0;
+        lastIndex = AIUAParagraphLayoutIndexAtOffset(engine, oldLength - suffix, &lastStart);
+        regionStart = firstStart;
+        oldRegionEnd = lastStart + engine->lengths[lastIndex];
+        includesLast = (lastIndex + 1 == engine->count);
+    } else {
+        AIUAParagraphLayoutReset(engine);
+        oldLength = 0;
+    }
+
+    // 改动区间之后的文本不变，新区间结束位置按长度差平移
+    size_t newRegionEnd = oldRegionEnd + length - oldLength;
+    AIUAParagraphList list = {0};
+    if (!AIUAParagraphLayoutMeasureRegion(engine, characters, length, regionStart, newRegionEnd, includesLast, &list)) {
+        AIUAParagraphListFree(&list);
+        AIUAParagraphLayoutReset(engine);
+        return false;
+    }
+
+    // 替换段落表中 [firstIndex, lastIndex] 为新测量的段落
+    size_t removed = engine->valid ? lastIndex - firstIndex + 1 : 0;
+    size_t newCount = engine->count - removed + list.count;
+    if (newCount > engine->capacity) {
+        size_t capacity = engine->capacity ? engine->capacity : 16;
+        while (capacity < newCount) {
+            capacity *= 2;
+        }
+        size_t *lengths = (size_t *)realloc(engine->lengths, capacity * sizeof(size_t));
+        if (lengths) {
+            engine->lengths = lengths;
+        }
+        double *heights = lengths ? (double *)realloc(engine->heights, capacity * sizeof(double)) : NULL;
+        if (heights) {
+            engine->heights = heights;
+        }
+        if (!lengths || !heights) {
+            AIUAParagraphListFree(&list);
+            AIUAParagraphLayoutReset(engine);
+            return false;
+        }
+        engine->capacity = capacity;
+    }
+    if (length > engine->textCapacity) {
+        size_t capacity = engine->textCapacity ? engine->textCapacity : 256;
+        while (capacity < length) {
+            capacity *= 2;
+        }
+        uint16_t *text = (uint16_t *)realloc(engine->text, capacity * sizeof(uint16_t));
+        if (!text) {
+            AIUAParagraphListFree(&list);
+            AIUAParagraphLayoutReset(engine);
+            return false;
+        }
+        engine->text = text;
+        engine->textCapacity = capacity;
+    }
+
+    for (size_t i = 0; i < removed; i++) {
+        engine->totalHeight -= engine->heights[firstIndex + i];
+    }
+    size_t tail = engine->count - firstIndex - removed;
+    if (list.count != removed && tail > 0) {
+        memmove(engine->lengths + firstIndex + list.count, engine->lengths + firstIndex + removed, tail * sizeof(size_t));
+        memmove(engine->heights + firstIndex + list.count, engine->heights + firstIndex + removed, tail * sizeof(double));
+    }
+    for (size_t i = 0; i < list.count; i++) {
+        engine->lengths[firstIndex + i] = list.lengths[i];
+        engine->heights[firstIndex + i] = list.heights[i];
+        engine->totalHeight += list.heights[i];
+    }
+    engine->count = newCount;
+    engine->lastMeasuredCount = list.count;
+    AIUAParagraphListFree(&list);
+
+    if (length > 0) {
+        memcpy(engine->text, characters, length * sizeof(uint16_t));
+    }
+    engine->length = length;
+    engine->valid = true;
+    // 全量测量时重新求和，避免长期增减累积浮点误差
+    if (removed == 0) {
+        engine->totalHeight = 0;
+        for (size_t i = 0; i < engine->count; i++) {
+            engine->totalHeight += engine->heights[i];
+        }
+    }
+    return true;
+}
+
+#pragma mark - 查询
+
+double AIUAParagraphLayoutEngineGetHeight(const AIUAParagraphLayoutEngine *engine) {
+    return engine && engine->valid ? engine->totalHeight : 0;
+}
+
+size_t AIUAParagraphLayoutEngineGetParagraphCount(const AIUAParagraphLayoutEngine *engine) {
+    return engine && engine->valid ? engine->count : 0;
+}
+
+size_t AIUAParagraphLayoutEngineGetLastMeasuredCount(const AIUAParagraphLayoutEngine *engine) {
+    return engine ? engine->lastMeasuredCount : 0;
+}
@@ -0,0 +1,59 @@
+//
+//  AIUAParagraphLayoutEngine.h
+//  AIUniversalAssistant
+//
+//  按段落增量计算文本高度，纯C实现
+//  - 文本按段落分隔符（\n、\r、\r\n、U+2029）切成段落，逐段测量高度，总高度为各段之和
+//  - 每次更新文本时与上一次的文本比较首尾相同部分，只重新测量改动涉及的段落（及其前一段），
+//    其余段落沿用已测量的高度，总高度随之增减，不再整段重新排版
+//  - 末尾的空段落（文本以换行结尾或为空）也参与测量，与文本视图中光标所在的空行一致
+//  - 实际测量由调用方提供（Apple 平台使用 TextKit/boundingRect），引擎只负责段落划分与缓存
+//  - 非线程安全，由调用方串行访问
+//
+
+#ifndef AIUAParagraphLayoutEngine_h
+#define AIUAParagraphLayoutEngine_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 测量一个段落的高度
+ * @param characters 段落内容（不含段落分隔符），空段落时 length 为 0
+ */
+typedef double (*AIUAParagraphMeasure)(const uint16_t *characters, size_t length, void *context);
+
+typedef struct AIUAParagraphLayoutEngine AIUAParagraphLayoutEngine;
+
+/// 创建引擎，失败返回 NULL
+AIUAParagraphLayoutEngine *AIUAParagraphLayoutEngineCreate(AIUAParagraphMeasure measure, void *context);
+void AIUAParagraphLayoutEngineDestroy(AIUAParagraphLayoutEngine *engine);
+
+/**
+ * 更新文本，只重新测量与上一次文本不同的段落
+ * @return 内存不足时返回 false，此时引擎回到未测量状态，下次调用全量测量
+ */
+bool AIUAParagraphLayoutEngineSetText(AIUAParagraphLayoutEngine *engine, const uint16_t *characters, size_t length);
+
+/// 字体、宽度等测量条件变化后调用，下次 SetText 全量测量
+void AIUAParagraphLayoutEngineInvalidate(AIUAParagraphLayoutEngine *engine);
+
+/// 当前文本的总高度
+double AIUAParagraphLayoutEngineGetHeight(const AIUAParagraphLayoutEngine *engine);
+
+/// 当前文本的段落数
+size_t AIUAParagraphLayoutEngineGetParagraphCount(const AIUAParagraphLayoutEngine *engine);
+
+/// 最近一次 SetText 测量的段落数（用于统计增量效果）
+size_t AIUAParagraphLayoutEngineGetLastMeasuredCount(const AIUAParagraphLayoutEngine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAParagraphLayoutEngine_h */
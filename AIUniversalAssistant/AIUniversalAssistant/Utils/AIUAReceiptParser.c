@@ -0,0 +1,631 @@
+//
+//  AIUAReceiptParser.c
+//  AIUniversalAssistant
+//
+//  收据解析实现
+//
+//  收据结构：
+//  ContentInfo ::= SEQUENCE { contentType OID(signedData), [0] EXPLICIT SignedData }
+//  SignedData  ::= SEQUENCE { version, digestAlgorithms SET, encapContentInfo, [0] certificates, ..., signerInfos }
+//  encapContentInfo ::= SEQUENCE { contentType OID(data), [0] EXPLICIT OCTET STRING 负载 }
+//  负载 ::= SET OF ReceiptAttribute
+//  ReceiptAttribute ::= SEQUENCE { type INTEGER, version INTEGER, value OCTET STRING（内含 DER 编码的值） }
+//  类型 17 的 value 同样是 SET OF ReceiptAttribute（一条内购记录）
+//
+//  PKCS#7 外层可能使用 BER 不定长编码（长度 0x80，以 00 00 结束），负载内部为 DER
+//
+
+#include "AIUAReceiptParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 嵌套深度上限，防止恶意数据导致深度递归
+#define AIUA_RECEIPT_MAX_DEPTH 32
+
+// ASN.1 通用标签
+#define AIUA_ASN1_INTEGER       0x02
+#define AIUA_ASN1_OCTET_STRING  0x04
+#define AIUA_ASN1_OID           0x06
+#define AIUA_ASN1_UTF8_STRING   0x0C
+#define AIUA_ASN1_SEQUENCE      0x10
+#define AIUA_ASN1_SET           0x11
+#define AIUA_ASN1_PRINTABLE     0x13
+#define AIUA_ASN1_IA5_STRING    0x16
+
+#define AIUA_ASN1_CLASS_UNIVERSAL 0
+#define AIUA_ASN1_CLASS_CONTEXT   2
+
+// 收据属性类型
+enum {
+    AIUAReceiptAttributeBundleID = 2,
+    AIUAReceiptAttributeAppVersion = 3,
+    AIUAReceiptAttributeCreationDate = 12,
+    AIUAReceiptAttributeInAppPurchase = 17,
+    AIUAReceiptAttributeOriginalAppVersion = 19,
+    AIUAReceiptAttributeExpirationDate = 21,
+
+    AIUAReceiptAttributeQuantity = 1701,
+    AIUAReceiptAttributeProductID = 1702,
+    AIUAReceiptAttributeTransactionID = 1703,
+    AIUAReceiptAttributePurchaseDate = 1704,
+    AIUAReceiptAttributeOriginalTransactionID = 1705,
+    AIUAReceiptAttributeOriginalPurchaseDate = 1706,
+    AIUAReceiptAttributeExpiresDate = 1708,
+    AIUAReceiptAttributeWebOrderLineItemID = 1711,
+    AIUAReceiptAttributeCancellationDate = 1712,
+};
+
+// 1.2.840.113549.1.7.2 / 1.2.840.113549.1.7.1
+static const uint8_t kAIUAOIDSignedData[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+static const uint8_t kAIUAOIDData[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01 };
+
+typedef struct {
+    uint8_t tagClass;
+    bool constructed;
+    uint32_t tagNumber;
+    const uint8_t *content;
+    size_t length;              // 定长时为内容长度
+    bool indefinite;            // 不定长：内容以 00 00 结束，结束位置需遍历子元素得到
+} AIUAReceiptTLV;
+
+// 顺序读取一个容器的子元素
+typedef struct {
+    const uint8_t *cursor;
+    const uint8_t *end;         // 定长容器的内容末尾；不定长容器为外层上限
+    bool indefinite;
+    bool finished;
+    int depth;
+} AIUAReceiptIterator;
+
+#pragma mark - TLV
+
+static bool AIUAReceiptReadHeader(const uint8_t *p, const uint8_t *end, AIUAReceiptTLV *tlv) {
+    if (p >= end) {
+        return false;
+    }
+    uint8_t first = *p++;
+    tlv->tagClass = first >> 6;
+    tlv->constructed = (first & 0x20) != 0;
+    tlv->tagNumber = first & 0x1F;
+    if (tlv->tagNumber == 0x1F) {
+        // 高标签号：base-128，最多 4 字节
+        uint32_t number = 0;
+        int count = 0;
+        uint8_t b;
+        do {
+            if (p >= end || count == 4) {
+                return false;
+            }
+            b = *p++;
+            number = (number << 7) | (b & 0x7F);
+            count++;
+        } while (b & 0x80);
+        tlv->tagNumber = number;
+    }
+
+    if (p >= end) {
+        return false;
+    }
+    uint8_t lengthByte = *p++;
+    tlv->indefinite = false;
+    if (lengthByte < 0x80) {
+        tlv->length = lengthByte;
+    } else if (lengthByte == 0x80) {
+        if (!tlv->constructed) {
+            return false;
+        }
+        tlv->indefinite = true;
+        tlv->length = 0;
+    } else {
+        size_t count = lengthByte & 0x7F;
+        if (count > 4 || (size_t)(end - p) < count) {
+            return false;
+        }
+        size_t length = 0;
+        for (size_t i = 0; i < count; i++) {
+            length = (length << 8) | *p++;
+        }
+        tlv->length = length;
+    }
+    tlv->content = p;
+    if (!tlv->indefinite && tlv->length > (size_t)(end - p)) {
+        return false;
+    }
+    return true;
+}
+
+// 计算元素结束位置；不定长元素需要跳过全部子元素直到 00 00
+static const uint8_t *AIUAReceiptElementEnd(const AIUAReceiptTLV *tlv, const uint8_t *end, int depth) {
+    if (!tlv->indefinite) {
+        return tlv->content + tlv->length;
+    }
+    if (depth >= AIUA_RECEIPT_MAX_DEPTH) {
+        return NULL;
+    }
+    const uint8_t *p = tlv->content;
+    while (true) {
+        if (end - p >= 2 && p[0] == 0 && p[1] == 0) {
+            return p + 2;
+        }
+        AIUAReceiptTLV child;
+        if (!AIUAReceiptReadHeader(p, end, &child)) {
+            return NULL;
+        }
+        p = AIUAReceiptElementEnd(&child, end, depth + 1);
+        if (!p) {
+            return NULL;
+        }
+    }
+}
+
+static bool AIUAReceiptTLVIs(const AIUAReceiptTLV *tlv, uint8_t tagClass, bool constructed, uint32_t tagNumber) {
+    return tlv->tagClass == tagClass && tlv->constructed == constructed && tlv->tagNumber == tagNumber;
+}
+
+static bool AIUAReceiptIteratorInit(AIUAReceiptIterator *iterator, const AIUAReceiptTLV *container,
+                                    const uint8_t *outerEnd, int depth) {
+    if (depth >= AIUA_RECEIPT_MAX_DEPTH) {
+        return false;
+    }
+    iterator->cursor = container->content;
+    iterator->end = container->indefinite ? outerEnd : container->content + container->length;
+    iterator->indefinite = container->indefinite;
+    iterator->finished = false;
+    iterator->depth = depth;
+    return true;
+}
+
+// 返回 1 读到子元素，0 容器结束，-1 数据错误；读到的子元素由调用方处理，下次调用时自动跳过
+static int AIUAReceiptIteratorNext(AIUAReceiptIterator *iterator, AIUAReceiptTLV *child, const AIUAReceiptTLV *previous) {
+    if (iterator->finished) {
+        return 0;
+    }
+    if (previous) {
+        const uint8_t *next = AIUAReceiptElementEnd(previous, iterator->end, iterator->depth + 1);
+        if (!next) {
+            return -1;
+        }
+        iterator->cursor = next;
+    }
+    if (iterator->indefinite) {
+        if (iterator->end - iterator->cursor >= 2 && iterator->cursor[0] == 0 && iterator->cursor[1] == 0) {
+            iterator->finished = true;
+            return 0;
+        }
+    } else if (iterator->cursor >= iterator->end) {
+        iterator->finished = true;
+        return 0;
+    }
+    return AIUAReceiptReadHeader(iterator->cursor, iterator->end, child) ? 1 : -1;
+}
+
+#pragma mark - 值解码
+
+static bool AIUAReceiptDecodeInteger(const uint8_t *content, size_t length, int64_t *value) {
+    if (length == 0 || length > 8) {
+        return false;
+    }
+    // 二进制补码，大端
+    uint64_t result = (content[0] & 0x80) ? UINT64_MAX : 0;
+    for (size_t i = 0; i < length; i++) {
+        result = (result << 8) | content[i];
+    }
+    *value = (int64_t)result;
+    return true;
+}
+
+// 属性值（OCTET STRING 的内容）是一个完整的 DER 元素
+static bool AIUAReceiptDecodeValue(const uint8_t *bytes, size_t length, AIUAReceiptTLV *value) {
+    if (!AIUAReceiptReadHeader(bytes, bytes + length, value) || value->indefinite) {
+        return false;
+    }
+    return true;
+}
+
+static void AIUAReceiptDecodeString(const uint8_t *bytes, size_t length, AIUAReceiptString *string) {
+    AIUAReceiptTLV value;
+    if (!AIUAReceiptDecodeValue(bytes, length, &value) || value.constructed || value.tagClass != AIUA_ASN1_CLASS_UNIVERSAL) {
+        return;
+    }
+    if (value.tagNumber == AIUA_ASN1_UTF8_STRING || value.tagNumber == AIUA_ASN1_IA5_STRING ||
+        value.tagNumber == AIUA_ASN1_PRINTABLE) {
+        string->bytes = value.content;
+        string->length = value.length;
+    }
+}
+
+static void AIUAReceiptDecodeIntegerValue(const uint8_t *bytes, size_t length, int64_t *result) {
+    AIUAReceiptTLV value;
+    if (!AIUAReceiptDecodeValue(bytes, length, &value) ||
+        !AIUAReceiptTLVIs(&value, AIUA_ASN1_CLASS_UNIVERSAL, false, AIUA_ASN1_INTEGER)) {
+        return;
+    }
+    AIUAReceiptDecodeInteger(value.content, value.length, result);
+}
+
+#pragma mark - 收据属性
+
+// 读取下一条 ReceiptAttribute，返回 1 成功，0 集合结束，-1 数据错误
+static int AIUAReceiptNextAttribute(AIUAReceiptIterator *set, AIUAReceiptTLV *attribute, bool *hasPrevious,
+                                    int64_t *type, const uint8_t **value, size_t *valueLength) {
+    int status = AIUAReceiptIteratorNext(set, attribute, *hasPrevious ? attribute : NULL);
+    *hasPrevious = status == 1;
+    if (status != 1) {
+        return status;
+    }
+    if (!AIUAReceiptTLVIs(attribute, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SEQUENCE) || attribute->indefinite) {
+        return -1;
+    }
+    const uint8_t *p = attribute->content;
+    const uint8_t *end = attribute->content + attribute->length;
+    AIUAReceiptTLV field;
+
+    // type
+    if (!AIUAReceiptReadHeader(p, end, &field) || !AIUAReceiptTLVIs(&field, AIUA_ASN1_CLASS_UNIVERSAL, false, AIUA_ASN1_INTEGER) ||
+        !AIUAReceiptDecodeInteger(field.content, field.length, type)) {
+        return -1;
+    }
+    p = field.content + field.length;
+
+    // version（不使用）
+    if (!AIUAReceiptReadHeader(p, end, &field) || !AIUAReceiptTLVIs(&field, AIUA_ASN1_CLASS_UNIVERSAL, false, AIUA_ASN1_INTEGER)) {
+        return -1;
+    }
+    p = field.content + field.length;
+
+    // value
+    if (!AIUAReceiptReadHeader(p, end, &field) || !AIUAReceiptTLVIs(&field, AIUA_ASN1_CLASS_UNIVERSAL, false, AIUA_ASN1_OCTET_STRING)) {
+        return -1;
+    }
+    *value = field.content;
+    *valueLength = field.length;
+    return 1;
+}
+
+static bool AIUAReceiptParseInAppPurchase(const uint8_t *bytes, size_t length, int depth,
+                                          AIUAReceiptInAppPurchaseHandler handler, void *context) {
+    AIUAReceiptTLV setTLV;
+    if (!AIUAReceiptDecodeValue(bytes, length, &setTLV) ||
+        !AIUAReceiptTLVIs(&setTLV, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SET)) {
+        return false;
+    }
+    AIUAReceiptIterator set;
+    if (!AIUAReceiptIteratorInit(&set, &setTLV, bytes + length, depth)) {
+        return false;
+    }
+
+    AIUAReceiptInAppPurchase purchase;
+    memset(&purchase, 0, sizeof(purchase));
+    AIUAReceiptTLV attribute;
+    bool hasPrevious = false;
+    int64_t type = 0;
+    const uint8_t *value = NULL;
+    size_t valueLength = 0;
+    int status;
+    while ((status = AIUAReceiptNextAttribute(&set, &attribute, &hasPrevious, &type, &value, &valueLength)) == 1) {
+        switch (type) {
+            case AIUAReceiptAttributeQuantity:
+                AIUAReceiptDecodeIntegerValue(value, valueLength, &purchase.quantity);
+                break;
+            case AIUAReceiptAttributeProductID:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.productID);
+                break;
+            case AIUAReceiptAttributeTransactionID:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.transactionID);
+                break;
+            case AIUAReceiptAttributePurchaseDate:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.purchaseDate);
+                break;
+            case AIUAReceiptAttributeOriginalTransactionID:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.originalTransactionID);
+                break;
+            case AIUAReceiptAttributeOriginalPurchaseDate:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.originalPurchaseDate);
+                break;
+            case AIUAReceiptAttributeExpiresDate:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.expiresDate);
+                break;
+            case AIUAReceiptAttributeWebOrderLineItemID:
+                AIUAReceiptDecodeIntegerValue(value, valueLength, &purchase.webOrderLineItemID);
+                break;
+            case AIUAReceiptAttributeCancellationDate:
+                AIUAReceiptDecodeString(value, valueLength, &purchase.cancellationDate);
+                break;
+            default:
+                break;
+        }
+    }
+    if (status < 0) {
+        return false;
+    }
+    if (handler) {
+        handler(&purchase, context);
+    }
+    return true;
+}
+
+static AIUAReceiptParseResult AIUAReceiptParsePayload(const uint8_t *bytes, size_t length, AIUAReceiptInfo *info,
+                                                      AIUAReceiptInAppPurchaseHandler handler, void *context) {
+    AIUAReceiptTLV setTLV;
+    if (!AIUAReceiptReadHeader(bytes, bytes + length, &setTLV) ||
+        !AIUAReceiptTLVIs(&setTLV, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SET)) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+    AIUAReceiptIterator set;
+    if (!AIUAReceiptIteratorInit(&set, &setTLV, bytes + length, 0)) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+
+    AIUAReceiptTLV attribute;
+    bool hasPrevious = false;
+    int64_t type = 0;
+    const uint8_t *value = NULL;
+    size_t valueLength = 0;
+    int status;
+    while ((status = AIUAReceiptNextAttribute(&set, &attribute, &hasPrevious, &type, &value, &valueLength)) == 1) {
+        switch (type) {
+            case AIUAReceiptAttributeBundleID:
+                AIUAReceiptDecodeString(value, valueLength, &info->bundleID);
+                break;
+            case AIUAReceiptAttributeAppVersion:
+                AIUAReceiptDecodeString(value, valueLength, &info->appVersion);
+                break;
+            case AIUAReceiptAttributeCreationDate:
+                AIUAReceiptDecodeString(value, valueLength, &info->creationDate);
+                break;
+            case AIUAReceiptAttributeOriginalAppVersion:
+                AIUAReceiptDecodeString(value, valueLength, &info->originalAppVersion);
+                break;
+            case AIUAReceiptAttributeExpirationDate:
+                AIUAReceiptDecodeString(value, valueLength, &info->expirationDate);
+                break;
+            case AIUAReceiptAttributeInAppPurchase:
+                if (!AIUAReceiptParseInAppPurchase(value, valueLength, 1, handler, context)) {
+                    return AIUAReceiptParseErrorMalformed;
+                }
+                info->inAppPurchaseCount++;
+                break;
+            default:
+                break;
+        }
+    }
+    return status < 0 ? AIUAReceiptParseErrorMalformed : AIUAReceiptParseOK;
+}
+
+#pragma mark - PKCS#7
+
+// 分段 OCTET STRING：计算总长度或把各段拷贝到 buffer（buffer 为 NULL 时只计算长度）
+static bool AIUAReceiptGatherOctetString(const AIUAReceiptTLV *tlv, const uint8_t *end, int depth,
+                                         uint8_t *buffer, size_t *offset) {
+    if (!tlv->constructed) {
+        if (buffer) {
+            memcpy(buffer + *offset, tlv->content, tlv->length);
+        }
+        *offset += tlv->length;
+        return true;
+    }
+    AIUAReceiptIterator iterator;
+    if (!AIUAReceiptIteratorInit(&iterator, tlv, end, depth)) {
+        return false;
+    }
+    AIUAReceiptTLV child;
+    bool hasPrevious = false;
+    int status;
+    while ((status = AIUAReceiptIteratorNext(&iterator, &child, hasPrevious ? &child : NULL)) == 1) {
+        hasPrevious = true;
+        if (child.tagClass != AIUA_ASN1_CLASS_UNIVERSAL || child.tagNumber != AIUA_ASN1_OCTET_STRING) {
+            return false;
+        }
+        if (!AIUAReceiptGatherOctetString(&child, iterator.end, depth + 1, buffer, offset)) {
+            return false;
+        }
+    }
+    return status == 0;
+}
+
+// 读取容器中的第一个子元素
+static bool AIUAReceiptFirstChild(const AIUAReceiptTLV *container, const uint8_t *end, int depth, AIUAReceiptTLV *child) {
+    AIUAReceiptIterator iterator;
+    return AIUAReceiptIteratorInit(&iterator, container, end, depth) && AIUAReceiptIteratorNext(&iterator, child, NULL) == 1;
+}
+
+static bool AIUAReceiptOIDEquals(const AIUAReceiptTLV *tlv, const uint8_t *oid, size_t oidLength) {
+    return AIUAReceiptTLVIs(tlv, AIUA_ASN1_CLASS_UNIVERSAL, false, AIUA_ASN1_OID) &&
+           tlv->length == oidLength && memcmp(tlv->content, oid, oidLength) == 0;
+}
+
+// 从 SignedData 中找到 encapContentInfo 的负载 OCTET STRING
+static AIUAReceiptParseResult AIUAReceiptFindPayload(const uint8_t *bytes, size_t length, AIUAReceiptTLV *payload,
+                                                     const uint8_t **payloadEnd) {
+    const uint8_t *end = bytes + length;
+    AIUAReceiptTLV contentInfo;
+    if (!AIUAReceiptReadHeader(bytes, end, &contentInfo) ||
+        !AIUAReceiptTLVIs(&contentInfo, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SEQUENCE)) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+
+    // ContentInfo: contentType, [0] content
+    AIUAReceiptIterator iterator;
+    AIUAReceiptTLV contentType, explicitContent;
+    if (!AIUAReceiptIteratorInit(&iterator, &contentInfo, end, 0) ||
+        AIUAReceiptIteratorNext(&iterator, &contentType, NULL) != 1) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+    if (!AIUAReceiptOIDEquals(&contentType, kAIUAOIDSignedData, sizeof(kAIUAOIDSignedData))) {
+        return AIUAReceiptParseErrorNotSignedData;
+    }
+    if (AIUAReceiptIteratorNext(&iterator, &explicitContent, &contentType) != 1 ||
+        !AIUAReceiptTLVIs(&explicitContent, AIUA_ASN1_CLASS_CONTEXT, true, 0)) {
+        return AIUAReceiptParseErrorNotSignedData;
+    }
+    const uint8_t *limit = iterator.end;
+
+    // SignedData: version, digestAlgorithms, encapContentInfo, ...（只读到 encapContentInfo，证书与签名不遍历）
+    AIUAReceiptTLV signedData;
+    if (!AIUAReceiptFirstChild(&explicitContent, limit, 1, &signedData) ||
+        !AIUAReceiptTLVIs(&signedData, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SEQUENCE)) {
+        return AIUAReceiptParseErrorNotSignedData;
+    }
+    AIUAReceiptTLV version, digestAlgorithms, encapContentInfo;
+    if (!AIUAReceiptIteratorInit(&iterator, &signedData, limit, 2) ||
+        AIUAReceiptIteratorNext(&iterator, &version, NULL) != 1 ||
+        AIUAReceiptIteratorNext(&iterator, &digestAlgorithms, &version) != 1 ||
+        AIUAReceiptIteratorNext(&iterator, &encapContentInfo, &digestAlgorithms) != 1 ||
+        !AIUAReceiptTLVIs(&encapContentInfo, AIUA_ASN1_CLASS_UNIVERSAL, true, AIUA_ASN1_SEQUENCE)) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+    limit = iterator.end;
+
+    // encapContentInfo: contentType(data), [0] OCTET STRING
+    AIUAReceiptTLV dataType, explicitPayload;
+    if (!AIUAReceiptIteratorInit(&iterator, &encapContentInfo, limit, 3) ||
+        AIUAReceiptIteratorNext(&iterator, &dataType, NULL) != 1 ||
+        !AIUAReceiptOIDEquals(&dataType, kAIUAOIDData, sizeof(kAIUAOIDData))) {
+        return AIUAReceiptParseErrorNoPayload;
+    }
+    if (AIUAReceiptIteratorNext(&iterator, &explicitPayload, &dataType) != 1 ||
+        !AIUAReceiptTLVIs(&explicitPayload, AIUA_ASN1_CLASS_CONTEXT, true, 0)) {
+        return AIUAReceiptParseErrorNoPayload;
+    }
+    limit = iterator.end;
+    if (!AIUAReceiptFirstChild(&explicitPayload, limit, 4, payload) ||
+        payload->tagClass != AIUA_ASN1_CLASS_UNIVERSAL || payload->tagNumber != AIUA_ASN1_OCTET_STRING) {
+        return AIUAReceiptParseErrorNoPayload;
+    }
+    *payloadEnd = explicitPayload.indefinite ? limit : explicitPayload.content + explicitPayload.length;
+    return AIUAReceiptParseOK;
+}
+
+#pragma mark - 公开接口
+
+AIUAReceiptParseResult AIUAReceiptParse(const uint8_t *bytes, size_t length,
+                                        AIUAReceiptInfo *info,
+                                        AIUAReceiptInAppPurchaseHandler handler, void *context) {
+    memset(info, 0, sizeof(*info));
+    if (!bytes || length == 0) {
+        return AIUAReceiptParseErrorMalformed;
+    }
+
+    AIUAReceiptTLV payload;
+    const uint8_t *payloadEnd = NULL;
+    AIUAReceiptParseResult result = AIUAReceiptFindPayload(bytes, length, &payload, &payloadEnd);
+    if (result != AIUAReceiptParseOK) {
+        return result;
+    }
+
+    if (!payload.constructed) {
+        return AIUAReceiptParsePayload(payload.content, payload.length, info, handler, context);
+    }
+
+    // BER 分段负载：拼接成连续缓冲区后再解析（整个解析过程唯一的一次分配）
+    size_t total = 0;
+    if (!AIUAReceiptGatherOctetString(&payload, payloadEnd, 5, NULL, &total) || total == 0) {
+        return AIUAReceiptParseErrorNoPayload;
+    }
+    uint8_t *buffer = (uint8_t *)malloc(total);
+    if (!buffer) {
+        return AIUAReceiptParseErrorOutOfMemory;
+    }
+    size_t offset = 0;
+    AIUAReceiptGatherOctetString(&payload, payloadEnd, 5, buffer, &offset);
+    info->storage = buffer;
+    return AIUAReceiptParsePayload(buffer, total, info, handler, context);
+}
+
+void AIUAReceiptInfoRelease(AIUAReceiptInfo *info) {
+    if (!info) {
+        return;
+    }
+    free(info->storage);
+    memset(info, 0, sizeof(*info));
+}
+
+#pragma mark - 时间
+
+static bool AIUAReceiptReadDigits(const uint8_t **p, const uint8_t *end, int count, int *value) {
+    if (end - *p < count) {
+        return false;
+    }
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        uint8_t c = (*p)[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        result = result * 10 + (c - '0');
+    }
+    *p += count;
+    *value = result;
+    return true;
+}
+
+static bool AIUAReceiptExpect(const uint8_t **p, const uint8_t *end, uint8_t c) {
+    if (*p >= end || **p != c) {
+        return false;
+    }
+    (*p)++;
+    return true;
+}
+
+// 公历日期转自 1970-01-01 起的天数（Howard Hinnant days_from_civil）
+static int64_t AIUAReceiptDaysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool AIUAReceiptParseDate(AIUAReceiptString string, int64_t *secondsSince1970) {
+    const uint8_t *p = string.bytes;
+    const uint8_t *end = string.bytes + string.length;
+    int year, month, day, hour, minute, second;
+    if (!string.bytes ||
+        !AIUAReceiptReadDigits(&p, end, 4, &year) || !AIUAReceiptExpect(&p, end, '-') ||
+        !AIUAReceiptReadDigits(&p, end, 2, &month) || !AIUAReceiptExpect(&p, end, '-') ||
+        !AIUAReceiptReadDigits(&p, end, 2, &day)) {
+        return false;
+    }
+    if (p >= end || (*p != 'T' && *p != 't' && *p != ' ')) {
+        return false;
+    }
+    p++;
+    if (!AIUAReceiptReadDigits(&p, end, 2, &hour) || !AIUAReceiptExpect(&p, end, ':') ||
+        !AIUAReceiptReadDigits(&p, end, 2, &minute) || !AIUAReceiptExpect(&p, end, ':') ||
+        !AIUAReceiptReadDigits(&p, end, 2, &second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    // 小数秒忽略
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    int offsetSeconds = 0;
+    if (p < end && (*p == 'Z' || *p == 'z')) {
+        p++;
+    } else if (p < end && (*p == '+' || *p == '-')) {
+        int sign = *p == '-' ? -1 : 1;
+        int offsetHour, offsetMinute;
+        p++;
+        if (!AIUAReceiptReadDigits(&p, end, 2, &offsetHour) || !AIUAReceiptExpect(&p, end, ':') ||
+            !AIUAReceiptReadDigits(&p, end, 2, &offsetMinute)) {
+            return false;
+        }
+        offsetSeconds = sign * (offsetHour * 3600 + offsetMinute * 60);
+    } else {
+        return false;
+    }
+    if (p != end) {
+        return false;
+    }
+    int64_t days = AIUAReceiptDaysFromCivil(year, month, day);
+    *secondsSince1970 = days * 86400 + hour * 3600 + minute * 60 + second - offsetSeconds;
+    return true;
+}
@@ -0,0 +1,89 @@
+//
+//  AIUAReceiptParser.h
+//  AIUniversalAssistant
+//
+//  App Store 收据解析（PKCS#7 + ASN.1 DER/BER），纯C实现
+//  - 一次线性遍历：PKCS#7 SignedData -> 收据属性集合 -> 内购记录集合，不逐字节试探匹配
+//  - 解析结果中的字符串直接指向输入缓冲区，不复制；只有负载为分段 OCTET STRING（BER）时才分配一次内存
+//  - 只负责解码，不校验签名
+//
+
+#ifndef AIUAReceiptParser_h
+#define AIUAReceiptParser_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    AIUAReceiptParseOK = 0,
+    AIUAReceiptParseErrorMalformed,         // TLV 结构错误或越界
+    AIUAReceiptParseErrorNotSignedData,     // 不是 PKCS#7 SignedData
+    AIUAReceiptParseErrorNoPayload,         // 缺少收据负载
+    AIUAReceiptParseErrorOutOfMemory
+} AIUAReceiptParseResult;
+
+/// 指向输入缓冲区（或解析期间的临时负载）的字节串，length 为 0 表示字段不存在
+typedef struct {
+    const uint8_t *bytes;
+    size_t length;
+} AIUAReceiptString;
+
+/// 内购记录（收据属性 17 中的一条）
+typedef struct {
+    AIUAReceiptString productID;                // 1702
+    AIUAReceiptString transactionID;            // 1703
+    AIUAReceiptString purchaseDate;             // 1704，RFC 3339
+    AIUAReceiptString originalTransactionID;    // 1705
+    AIUAReceiptString originalPurchaseDate;     // 1706
+    AIUAReceiptString expiresDate;              // 1708，仅自动续订订阅
+    AIUAReceiptString cancellationDate;         // 1712，退款/取消时存在
+    int64_t quantity;                           // 1701
+    int64_t webOrderLineItemID;                 // 1711
+} AIUAReceiptInAppPurchase;
+
+/// 收据顶层字段
+typedef struct {
+    AIUAReceiptString bundleID;                 // 2
+    AIUAReceiptString appVersion;               // 3
+    AIUAReceiptString creationDate;             // 12
+    AIUAReceiptString originalAppVersion;       // 19
+    AIUAReceiptString expirationDate;           // 21
+    size_t inAppPurchaseCount;
+    void *storage;                              // 分段负载拼接后的缓冲区，由 AIUAReceiptInfoRelease 释放
+} AIUAReceiptInfo;
+
+/**
+ * 每解析出一条内购记录回调一次（按收据中的顺序）
+ * purchase 中的字符串只在回调期间有效
+ */
+typedef void (*AIUAReceiptInAppPurchaseHandler)(const AIUAReceiptInAppPurchase *purchase, void *context);
+
+/**
+ * 解析收据
+ * info 中的字符串指向 bytes 或 info->storage，在 bytes 有效且调用 AIUAReceiptInfoRelease 之前可用
+ * 无论成功与否，调用方都应调用 AIUAReceiptInfoRelease
+ * @param handler 可为 NULL（只统计条数）
+ */
+AIUAReceiptParseResult AIUAReceiptParse(const uint8_t *bytes, size_t length,
+                                        AIUAReceiptInfo *info,
+                                        AIUAReceiptInAppPurchaseHandler handler, void *context);
+
+/// 释放 info 持有的内存并清空
+void AIUAReceiptInfoRelease(AIUAReceiptInfo *info);
+
+/**
+ * 解析收据中的 RFC 3339 时间（如 2024-05-01T08:00:00Z，可带小数秒或 ±hh:mm 时区）
+ * @return 成功时写入自 1970-01-01 UTC 起的秒数
+ */
+bool AIUAReceiptParseDate(AIUAReceiptString string, int64_t *secondsSince1970);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAReceiptParser_h */
@@ -0,0 +1,60 @@
+//
+//  AIUAReceiptSnapshotStore.h
+//  AIUniversalAssistant
+//
+//  收据验证快照：上次完整验证通过时的收据指纹（大小、修改时间、SHA-256）、应用版本与验证时间
+//  - 收据文件的大小和修改时间与快照一致、应用版本未变且快照未超过最长沿用时间时，冷启动可跳过完整验证
+//  - 大小和修改时间相同不代表内容相同，沿用快照后在后台比对哈希
+//  - 收据路径、应用版本、存储与后台队列均由调用方注入，不依赖 AIUAIAPManager，可在命令行下测试
+//  - 快照保存在 NSUserDefaults 中，key 由调用方给出（按账号命名空间区分）
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAReceiptSnapshotStore : NSObject
+
+/// 快照代数，每次 invalidateSnapshotForKey: +1，用于丢弃失效前发起的后台复核结果
+@property (nonatomic, assign, readonly) NSUInteger generation;
+
+/// 后台复核读取收据与计算哈希的队列，默认全局 utility 队列
+@property (nonatomic, strong) dispatch_queue_t revalidationQueue;
+
+/**
+ * @param receiptURL 收据文件路径（App 内为 appStoreReceiptURL）
+ * @param appVersion 当前应用版本，与快照中的不同时快照失效
+ * @param defaults 快照存储
+ * @param maxAge 快照最长沿用时间，超过后即使收据未变化也需要重新完整验证
+ */
+- (instancetype)initWithReceiptURL:(nullable NSURL *)receiptURL
+                        appVersion:(nullable NSString *)appVersion
+                          defaults:(NSUserDefaults *)defaults
+                            maxAge:(NSTimeInterval)maxAge NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 收据文件指纹、应用版本与快照一致且未超过最长沿用时间时返回快照，否则返回 nil
+- (nullable NSDictionary *)snapshotMatchingReceiptFileForKey:(NSString *)key;
+
+/**
+ * 完整验证通过后保存快照
+ * @param receiptData 本次验证的收据内容；与当前收据文件大小不一致（验证期间被替换）时不保存
+ * @param duration 本次完整验证耗时（秒）
+ * @return 是否已保存
+ */
+- (BOOL)saveSnapshotForReceiptData:(NSData *)receiptData duration:(CFAbsoluteTime)duration forKey:(NSString *)key;
+
+/**
+ * 在 revalidationQueue 上读取收据并与快照中的哈希比对
+ * 不一致且期间快照未失效时，在 completionQueue 上调用 mismatchHandler；快照代数在 completionQueue 上判断
+ */
+- (void)revalidateSnapshot:(NSDictionary *)snapshot
+           completionQueue:(dispatch_queue_t)completionQueue
+           mismatchHandler:(void (^)(void))mismatchHandler;
+
+/// 删除快照并使之前发起的后台复核结果作废
+- (void)invalidateSnapshotForKey:(NSString *)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
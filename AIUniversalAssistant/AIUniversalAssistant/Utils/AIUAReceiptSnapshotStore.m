@@ -0,0 +1,140 @@
+//
+//  AIUAReceiptSnapshotStore.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAReceiptSnapshotStore.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
+
+static NSString *AIUAReceiptSnapshotSHA256Hex(NSData *data) {
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    NSMutableString *hex = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [hex appendFormat:@"%02x", digest[i]];
+    }
+    return hex;
+}
+
+@interface AIUAReceiptSnapshotStore ()
+
+@property (nonatomic, strong, nullable) NSURL *receiptURL;
+@property (nonatomic, copy) NSString *appVersion;
+@property (nonatomic, strong) NSUserDefaults *defaults;
+@property (nonatomic, assign) NSTimeInterval maxAge;
+@property (nonatomic, assign, readwrite) NSUInteger generation;
+
+@end
+
+@implementation AIUAReceiptSnapshotStore
+
+- (instancetype)initWithReceiptURL:(NSURL *)receiptURL
+                        appVersion:(NSString *)appVersion
+                          defaults:(NSUserDefaults *)defaults
+                            maxAge:(NSTimeInterval)maxAge {
+    self = [super init];
+    if (self) {
+        _receiptURL = receiptURL;
+        _appVersion = [appVersion copy] ?: @"";
+        _defaults = defaults;
+        _maxAge = maxAge;
+        _revalidationQueue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+    }
+    return self;
+}
+
+// 收据文件的大小和修改时间，只 stat 不读内容
+- (BOOL)receiptFileSize:(unsigned long long *)size modificationTime:(double *)modificationTime {
+    if (!self.receiptURL) {
+        return NO;
+    }
+    struct stat fileStat;
+    if (stat(self.receiptURL.fileSystemRepresentation, &fileStat) != 0 || fileStat.st_size <= 0) {
+        return NO;
+    }
+    *size = (unsigned long long)fileStat.st_size;
+    *modificationTime = (double)fileStat.st_mtimespec.tv_sec + (double)fileStat.st_mtimespec.tv_nsec / 1e9;
+    return YES;
+}
+
+- (NSDictionary *)snapshotMatchingReceiptFileForKey:(NSString *)key {
+    NSDictionary *snapshot = [self.defaults dictionaryForKey:key];
+    if (!snapshot) {
+        return nil;
+    }
+    if (![snapshot[@"appVersion"] isEqual:self.appVersion]) {
+        NSLog(@"[IAP] 应用版本变化，验证快照失效");
+        return nil;
+    }
+    NSDate *verifiedAt = snapshot[@"verifiedAt"];
+    if (![verifiedAt isKindOfClass:[NSDate class]] || fabs([verifiedAt timeIntervalSinceNow]) > self.maxAge) {
+        NSLog(@"[IAP] 验证快照已超过最长沿用时间，重新完整验证");
+        return nil;
+    }
+    unsigned long long size = 0;
+    double modificationTime = 0;
+    if (![self receiptFileSize:&size modificationTime:&modificationTime]) {
+        return nil;
+    }
+    if ([snapshot[@"receiptSize"] unsignedLongLongValue] != size ||
+        [snapshot[@"receiptModificationTime"] doubleValue] != modificationTime) {
+        NSLog(@"[IAP] 收据文件已变化，验证快照失效");
+        return nil;
+    }
+    return snapshot;
+}
+
+- (BOOL)saveSnapshotForReceiptData:(NSData *)receiptData duration:(CFAbsoluteTime)duration forKey:(NSString *)key {
+    unsigned long long size = 0;
+    double modificationTime = 0;
+    // 验证期间收据被替换时不保存，下次启动重新验证
+    if (![self receiptFileSize:&size modificationTime:&modificationTime] || size != receiptData.length) {
+        return NO;
+    }
+    NSDictionary *snapshot = @{
+        @"receiptSize": @(size),
+        @"receiptModificationTime": @(modificationTime),
+        @"receiptHash": AIUAReceiptSnapshotSHA256Hex(receiptData),
+        @"appVersion": self.appVersion,
+        @"verifiedAt": [NSDate date],
+        @"verifyDuration": @(duration * 1000.0)
+    };
+    [self.defaults setObject:snapshot forKey:key];
+    [self.defaults synchronize];
+    return YES;
+}
+
+- (void)revalidateSnapshot:(NSDictionary *)snapshot
+           completionQueue:(dispatch_queue_t)completionQueue
+           mismatchHandler:(void (^)(void))mismatchHandler {
+    NSURL *receiptURL = self.receiptURL;
+    NSString *expectedHash = snapshot[@"receiptHash"];
+    NSUInteger generation = self.generation;
+    __weak typeof(self) wself = self;
+    dispatch_async(self.revalidationQueue, ^{
+        NSData *receiptData = receiptURL ? [NSData dataWithContentsOfURL:receiptURL] : nil;
+        NSString *receiptHash = receiptData.length > 0 ? AIUAReceiptSnapshotSHA256Hex(receiptData) : nil;
+        if (receiptHash && [receiptHash isEqualToString:expectedHash]) {
+            NSLog(@"[IAP] 后台复核：收据内容与验证快照一致");
+            return;
+        }
+        dispatch_async(completionQueue, ^{
+            __strong typeof(wself) sself = wself;
+            // 复核期间快照已失效（清除购买、切换账号、已重新验证等），结果作废
+            if (!sself || sself.generation != generation) {
+                return;
+            }
+            NSLog(@"[IAP] 后台复核：收据内容与验证快照不一致");
+            mismatchHandler();
+        });
+    });
+}
+
+- (void)invalidateSnapshotForKey:(NSString *)key {
+    self.generation++;
+    [self.defaults removeObjectForKey:key];
+    [self.defaults synchronize];
+}
+
+@end
@@ -6,6 +6,7 @@
 //
 
 #import "AIUAToolsManager.h"
+#import "AIUAMarkdownStripper.h"
 #import <StoreKit/StoreKit.h>
 
 // 评分相关的UserDefaults键
@@ -87,6 +88,16 @@ static NSString * const kUserDeclinedRatingKey = @"AIUAUserDeclinedRating";
 + (NSString *)removeMarkdownSymbols:(NSString *)text {
     if (!text) return @"";
     
+    // 单次遍历的状态机实现，输出与下面的正则级联一致
+    NSString *result = [AIUAMarkdownStripper stripMarkdownInText:text];
+    if (result) {
+        return result;
+    }
+    return [self removeMarkdownSymbolsWithRegex:text];
+}
+
+// 正则实现，仅在状态机分配内存失败时使用
++ (NSString *)removeMarkdownSymbolsWithRegex:(NSString *)text {
     NSMutableString *cleanText = [text mutableCopy];
     
     // 移除粗体符号
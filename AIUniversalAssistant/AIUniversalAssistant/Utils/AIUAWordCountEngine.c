@@ -0,0 +1,518 @@
+//
+//  AIUAWordCountEngine.c
+//  AIUniversalAssistant
+//
+//  字数统计引擎实现
+//
+//  "简单字符"的判定依据：字符不是 CR、Extend、SpacingMark、ZWJ、Prepend、Regional_Indicator、
+//  韩文字母（L/V/T）、Extended_Pictographic，也不是代理项。两个简单字符之间没有任何规则会阻止断开，
+//  因此简单字符对之间必然是簇边界；复杂片段以"前一个简单字符"开头、以"下一对简单字符"之间结束。
+//
+
+#include "AIUAWordCountEngine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AIUA_WORD_COUNT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define AIUA_WORD_COUNT_SSE2 1
+#endif
+
+// UTF-8 解码时的栈上缓冲区长度
+#define AIUA_WORD_COUNT_UTF8_BUFFER_LENGTH 256
+
+struct AIUAWordCountEngine {
+    AIUAWordCountSpanCounter spanCounter;
+    void *context;
+
+    // 尚未确定的末尾（从最后一个确定的簇边界开始）
+    uint16_t *pending;
+    size_t pendingLength;
+    size_t pendingCapacity;
+    size_t spanResume;          // >0 表示 pending 以未结束的复杂片段开头，边界查找从该位置继续
+    uint64_t total;             // 已确定的字数
+
+    // 跨 chunk 的 UTF-8 多字节字符
+    uint32_t utf8CodePoint;
+    uint8_t utf8Remaining;
+    uint32_t utf8Minimum;
+
+    bool failed;
+};
+
+#pragma mark - 简单字符判定
+
+static inline bool AIUAWordCountIsSimple(uint16_t c) {
+    if (c < 0x0300) {
+        // 拉丁字母与符号；CR 可能与 LF 组成一个簇，© ® 属于 Extended_Pictographic
+        return c != 0x0D && c != 0xA9 && c != 0xAE;
+    }
+    if (c >= 0x4E00) {
+        if (c <= 0x9FFF) {
+            return true;                                // 中日韩统一表意文字
+        }
+        if (c >= 0xAC00 && c <= 0xD7A3) {
+            return true;                                // 韩文音节（音节之间总是断开）
+        }
+        return c >= 0xFF01 && c <= 0xFF9D;              // 全角字符、半角片假名（不含浊点 FF9E/FF9F）
+    }
+    if (c >= 0x3000) {
+        if (c <= 0x3029) {
+            return true;                                // 中日韩标点（302A-302F 为组合符号）
+        }
+        if (c >= 0x3031 && c <= 0x303C) {
+            return true;                                // 3030、303D 属于 Extended_Pictographic
+        }
+        if (c >= 0x3041 && c <= 0x3096) {
+            return true;                                // 平假名（3099/309A 为组合浊点）
+        }
+        if (c >= 0x309B && c <= 0x30FF) {
+            return true;                                // 片假名
+        }
+        return c >= 0x3400 && c <= 0x4DBF;              // 扩展 A
+    }
+    // 常用中文标点：破折号、引号、省略号
+    return c >= 0x2010 && c <= 0x2027;
+}
+
+#if AIUA_WORD_COUNT_NEON
+
+// 8 个码元是否都属于 ASCII/拉丁（排除 CR © ®）或基本汉字区段
+static inline bool AIUAWordCountFastLanes8(const uint16_t *c) {
+    uint16x8_t v = vld1q_u16(c);
+    uint16x8_t latin = vcleq_u16(v, vdupq_n_u16(0x02FF));
+    uint16x8_t excluded = vorrq_u16(vceqq_u16(v, vdupq_n_u16(0x0D)),
+                                    vorrq_u16(vceqq_u16(v, vdupq_n_u16(0xA9)), vceqq_u16(v, vdupq_n_u16(0xAE))));
+    uint16x8_t cjk = vcleq_u16(vsubq_u16(v, vdupq_n_u16(0x4E00)), vdupq_n_u16(0x9FFF - 0x4E00));
+    uint16x8_t ok = vorrq_u16(vbicq_u16(latin, excluded), cjk);
+    return vminvq_u16(ok) == 0xFFFF;
+}
+
+#elif AIUA_WORD_COUNT_SSE2
+
+static inline bool AIUAWordCountFastLanes8(const uint16_t *c) {
+    __m128i v = _mm_loadu_si128((const __m128i *)c);
+    __m128i zero = _mm_setzero_si128();
+    // 无符号 a <= b 等价于 saturating(a - b) == 0
+    __m128i latin = _mm_cmpeq_epi16(_mm_subs_epu16(v, _mm_set1_epi16(0x02FF)), zero);
+    __m128i excluded = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x0D)),
+                                    _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0xA9)),
+                                                 _mm_cmpeq_epi16(v, _mm_set1_epi16(0xAE))));
+    __m128i offset = _mm_sub_epi16(v, _mm_set1_epi16(0x4E00));
+    __m128i cjk = _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(0x9FFF - 0x4E00)), zero);
+    __m128i ok = _mm_or_si128(_mm_andnot_si128(excluded, latin), cjk);
+    return _mm_movemask_epi8(ok) == 0xFFFF;
+}
+
+#endif
+
+// 返回从 i 开始的连续简单字符的结束位置
+static size_t AIUAWordCountSimpleRunEnd(const uint16_t *c, size_t i, size_t n) {
+    while (i < n) {
+#if AIUA_WORD_COUNT_NEON || AIUA_WORD_COUNT_SSE2
+        while (i + 8 <= n && AIUAWordCountFastLanes8(c + i)) {
+            i += 8;
+        }
+#endif
+        // 向量判定不覆盖的简单字符（假名、全角符号等）逐个判断，最多 8 个后再回到向量路径
+        size_t limit = i + 8 < n ? i + 8 : n;
+        while (i < limit && AIUAWordCountIsSimple(c[i])) {
+            i += 1;
+        }
+        if (i < limit) {
+            break;
+        }
+    }
+    return i;
+}
+
+#pragma mark - 内置片段计数
+
+typedef enum {
+    AIUAGraphemeOther,
+    AIUAGraphemeCR,
+    AIUAGraphemeLF,
+    AIUAGraphemeControl,
+    AIUAGraphemeExtend,         // 含 SpacingMark，两者都不与前一个字符断开
+    AIUAGraphemeZWJ,
+    AIUAGraphemeRegionalIndicator,
+    AIUAGraphemeL,
+    AIUAGraphemeV,
+    AIUAGraphemeT,
+    AIUAGraphemeLV,
+    AIUAGraphemeLVT,
+    AIUAGraphemePictographic,
+} AIUAGraphemeClass;
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} AIUACodePointRange;
+
+// 常见的组合符号、变体选择符、肤色修饰、标签字符（按起点升序）
+static const AIUACodePointRange kAIUAExtendRanges[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF}, {0x05C1, 0x05C2},
+    {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A}, {0x064B, 0x065F}, {0x0670, 0x0670},
+    {0x06D6, 0x06DC}, {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0900, 0x0903},
+    {0x093A, 0x093C}, {0x093E, 0x094F}, {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0E31, 0x0E31},
+    {0x0E33, 0x0E3A}, {0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200C, 0x200C},
+    {0x20D0, 0x20FF}, {0x302A, 0x302F}, {0x3099, 0x309A}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F},
+    {0xFF9E, 0xFF9F}, {0x1F3FB, 0x1F3FF}, {0xE0020, 0xE007F}, {0xE0100, 0xE01EF},
+};
+
+// Extended_Pictographic 的主要区段
+static const AIUACodePointRange kAIUAPictographicRanges[] = {
+    {0x00A9, 0x00A9}, {0x00AE, 0x00AE}, {0x203C, 0x203C}, {0x2049, 0x2049}, {0x2122, 0x2122},
+    {0x2139, 0x2139}, {0x2194, 0x2199}, {0x21A9, 0x21AA}, {0x231A, 0x231B}, {0x2328, 0x2328},
+    {0x23CF, 0x23CF}, {0x23E9, 0x23F3}, {0x23F8, 0x23FA}, {0x24C2, 0x24C2}, {0x25AA, 0x25AB},
+    {0x25B6, 0x25B6}, {0x25C0, 0x25C0}, {0x25FB, 0x25FE}, {0x2600, 0x27BF}, {0x2934, 0x2935},
+    {0x2B05, 0x2B07}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x3030, 0x3030},
+    {0x303D, 0x303D}, {0x3297, 0x3297}, {0x3299, 0x3299}, {0x1F000, 0x1F0FF}, {0x1F10D, 0x1F10F},
+    {0x1F12F, 0x1F12F}, {0x1F16C, 0x1F171}, {0x1F17E, 0x1F17F}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+    {0x1F1AD, 0x1F1E5}, {0x1F201, 0x1F20F}, {0x1F21A, 0x1F21A}, {0x1F22F, 0x1F22F}, {0x1F232, 0x1F23A},
+    {0x1F23C, 0x1F23F}, {0x1F249, 0x1F3FA}, {0x1F400, 0x1F53D}, {0x1F546, 0x1F64F}, {0x1F680, 0x1F6FF},
+    {0x1F774, 0x1F77F}, {0x1F7D5, 0x1F7FF}, {0x1F80C, 0x1F80F}, {0x1F848, 0x1F84F}, {0x1F85A, 0x1F85F},
+    {0x1F888, 0x1F88F}, {0x1F8AE, 0x1F8FF}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945}, {0x1F947, 0x1FAFF},
+    {0x1FC00, 0x1FFFD},
+};
+
+static bool AIUACodePointInRanges(uint32_t cp, const AIUACodePointRange *ranges, size_t count) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (cp < ranges[mid].first) {
+            high = mid;
+        } else if (cp > ranges[mid].last) {
+            low = mid + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+static AIUAGraphemeClass AIUAGraphemeClassify(uint32_t cp) {
+    if (cp == 0x0D) {
+        return AIUAGraphemeCR;
+    }
+    if (cp == 0x0A) {
+        return AIUAGraphemeLF;
+    }
+    if (cp < 0x20 || (cp >= 0x7F && cp <= 0x9F) || cp == 0x00AD || cp == 0x200B ||
+        cp == 0x2028 || cp == 0x2029 || (cp >= 0x2060 && cp <= 0x206F) || cp == 0xFEFF) {
+        return AIUAGraphemeControl;
+    }
+    if (cp == 0x200D) {
+        return AIUAGraphemeZWJ;
+    }
+    if (cp >= 0x1F1E6 && cp <= 0x1F1FF) {
+        return AIUAGraphemeRegionalIndicator;
+    }
+    if ((cp >= 0x1100 && cp <= 0x115F) || (cp >= 0xA960 && cp <= 0xA97C)) {
+        return AIUAGraphemeL;
+    }
+    if ((cp >= 0x1160 && cp <= 0x11A7) || (cp >= 0xD7B0 && cp <= 0xD7C6)) {
+        return AIUAGraphemeV;
+    }
+    if ((cp >= 0x11A8 && cp <= 0x11FF) || (cp >= 0xD7CB && cp <= 0xD7FB)) {
+        return AIUAGraphemeT;
+    }
+    if (cp >= 0xAC00 && cp <= 0xD7A3) {
+        return (cp - 0xAC00) % 28 == 0 ? AIUAGraphemeLV : AIUAGraphemeLVT;
+    }
+    if (AIUACodePointInRanges(cp, kAIUAExtendRanges, sizeof(kAIUAExtendRanges) / sizeof(kAIUAExtendRanges[0]))) {
+        return AIUAGraphemeExtend;
+    }
+    if (AIUACodePointInRanges(cp, kAIUAPictographicRanges, sizeof(kAIUAPictographicRanges) / sizeof(kAIUAPictographicRanges[0]))) {
+        return AIUAGraphemePictographic;
+    }
+    return AIUAGraphemeOther;
+}
+
+static bool AIUAGraphemeIsControlLike(AIUAGraphemeClass cls) {
+    return cls == AIUAGraphemeCR || cls == AIUAGraphemeLF || cls == AIUAGraphemeControl;
+}
+
+size_t AIUAWordCountDefaultSpanCounter(const uint16_t *characters, size_t length, void *context) {
+    (void)context;
+    size_t count = 0;
+    AIUAGraphemeClass previous = AIUAGraphemeOther;
+    int pictographicState = 0;  // 1: ExtPict Extend*，2: ExtPict Extend* ZWJ
+    size_t regionalRun = 0;     // 紧邻的连续区域旗帜字符数
+    size_t i = 0;
+    while (i < length) {
+        uint32_t cp = characters[i];
+        i += 1;
+        if (cp >= 0xD800 && cp <= 0xDBFF && i < length && characters[i] >= 0xDC00 && characters[i] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (characters[i] - 0xDC00);
+            i += 1;
+        }
+        AIUAGraphemeClass cls = AIUAGraphemeClassify(cp);
+
+        bool isBreak;
+        if (count == 0) {
+            isBreak = true;
+        } else if (previous == AIUAGraphemeCR && cls == AIUAGraphemeLF) {
+            isBreak = false;                                                    // GB3
+        } else if (AIUAGraphemeIsControlLike(previous) || AIUAGraphemeIsControlLike(cls)) {
+            isBreak = true;                                                     // GB4, GB5
+        } else if (previous == AIUAGraphemeL &&
+                   (cls == AIUAGraphemeL || cls == AIUAGraphemeV || cls == AIUAGraphemeLV || cls == AIUAGraphemeLVT)) {
+            isBreak = false;                                                    // GB6
+        } else if ((previous == AIUAGraphemeLV || previous == AIUAGraphemeV) &&
+                   (cls == AIUAGraphemeV || cls == AIUAGraphemeT)) {
+            isBreak = false;                                                    // GB7
+        } else if ((previous == AIUAGraphemeLVT || previous == AIUAGraphemeT) && cls == AIUAGraphemeT) {
+            isBreak = false;                                                    // GB8
+        } else if (cls == AIUAGraphemeExtend || cls == AIUAGraphemeZWJ) {
+            isBreak = false;                                                    // GB9
+        } else if (pictographicState == 2 && cls == AIUAGraphemePictographic) {
+            isBreak = false;                                                    // GB11
+        } else if (previous == AIUAGraphemeRegionalIndicator && cls == AIUAGraphemeRegionalIndicator) {
+            isBreak = regionalRun % 2 == 0;                                     // GB12, GB13
+        } else {
+            isBreak = true;                                                     // GB999
+        }
+        if (isBreak) {
+            count += 1;
+        }
+
+        if (cls == AIUAGraphemePictographic) {
+            pictographicState = 1;
+        } else if (cls == AIUAGraphemeExtend && pictographicState == 1) {
+            pictographicState = 1;
+        } else if (cls == AIUAGraphemeZWJ && pictographicState == 1) {
+            pictographicState = 2;
+        } else {
+            pictographicState = 0;
+        }
+        regionalRun = cls == AIUAGraphemeRegionalIndicator ? regionalRun + 1 : 0;
+        previous = cls;
+    }
+    return count;
+}
+
+#pragma mark - 扫描
+
+/**
+ * 统计 characters[0, length) 中已确定的字数，返回已确定部分的结束位置（一定是簇边界）
+ * final 为 true 时处理到末尾；spanResume 见 AIUAWordCountEngine
+ */
+static size_t AIUAWordCountScan(const uint16_t *c,
+                                size_t n,
+                                bool final,
+                                AIUAWordCountSpanCounter spanCounter,
+                                void *context,
+                                size_t *spanResume,
+                                uint64_t *total) {
+    size_t i = 0;
+    size_t j = *spanResume;
+    *spanResume = 0;
+    while (i < n) {
+        if (j == 0) {
+            size_t runEnd = AIUAWordCountSimpleRunEnd(c, i, n);
+            if (runEnd > i) {
+                if (runEnd == n) {
+                    if (final) {
+                        *total += runEnd - i;
+                        return n;
+                    }
+                    // 最后一个字符之后可能还会到达组合符号，留到下一次输入
+                    *total += runEnd - i - 1;
+                    return runEnd - 1;
+                }
+                // 最后一个简单字符可能与后面的复杂字符组成一个簇，归入复杂片段
+                *total += runEnd - i - 1;
+                i = runEnd - 1;
+            }
+            j = i + 1;
+        }
+        while (j < n && !(AIUAWordCountIsSimple(c[j - 1]) && AIUAWordCountIsSimple(c[j]))) {
+            j += 1;
+        }
+        if (j >= n && !final) {
+            *spanResume = j - i;
+            return i;
+        }
+        *total += spanCounter(c + i, j - i, context);
+        i = j;
+        j = 0;
+    }
+    return n;
+}
+
+size_t AIUAWordCountUTF16(const uint16_t *characters, size_t length, AIUAWordCountSpanCounter spanCounter, void *context) {
+    if (!characters || length == 0) {
+        return 0;
+    }
+    size_t spanResume = 0;
+    uint64_t total = 0;
+    AIUAWordCountScan(characters, length, true, spanCounter ? spanCounter : AIUAWordCountDefaultSpanCounter, context, &spanResume, &total);
+    return (size_t)total;
+}
+
+#pragma mark - 流式接口
+
+AIUAWordCountEngine *AIUAWordCountEngineCreate(AIUAWordCountSpanCounter spanCounter, void *context) {
+    AIUAWordCountEngine *engine = (AIUAWordCountEngine *)calloc(1, sizeof(AIUAWordCountEngine));
+    if (!engine) {
+        return NULL;
+    }
+    engine->spanCounter = spanCounter ? spanCounter : AIUAWordCountDefaultSpanCounter;
+    engine->context = context;
+    return engine;
+}
+
+void AIUAWordCountEngineDestroy(AIUAWordCountEngine *engine) {
+    if (!engine) {
+        return;
+    }
+    free(engine->pending);
+    free(engine);
+}
+
+void AIUAWordCountEngineReset(AIUAWordCountEngine *engine) {
+    if (!engine) {
+        return;
+    }
+    engine->pendingLength = 0;
+    engine->spanResume = 0;
+    engine->total = 0;
+    engine->utf8Remaining = 0;
+    engine->failed = false;
+}
+
+static bool AIUAWordCountEngineStorePending(AIUAWordCountEngine *engine, const uint16_t *characters, size_t length) {
+    size_t required = engine->pendingLength + length;
+    if (required > engine->pendingCapacity) {
+        size_t capacity = engine->pendingCapacity > 0 ? engine->pendingCapacity : 64;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        uint16_t *grown = (uint16_t *)realloc(engine->pending, capacity * sizeof(uint16_t));
+        if (!grown) {
+            engine->failed = true;
+            return false;
+        }
+        engine->pending = grown;
+        engine->pendingCapacity = capacity;
+    }
+    memcpy(engine->pending + engine->pendingLength, characters, length * sizeof(uint16_t));
+    engine->pendingLength = required;
+    return true;
+}
+
+void AIUAWordCountEngineFeedUTF16(AIUAWordCountEngine *engine, const uint16_t *characters, size_t length) {
+    if (!engine || engine->failed || !characters || length == 0) {
+        return;
+    }
+    if (engine->pendingLength == 0) {
+        // 没有缓存时直接扫描输入，只拷贝未确定的末尾
+        size_t consumed = AIUAWordCountScan(characters, length, false, engine->spanCounter, engine->context,
+                                            &engine->spanResume, &engine->total);
+        AIUAWordCountEngineStorePending(engine, characters + consumed, length - consumed);
+        return;
+    }
+    if (!AIUAWordCountEngineStorePending(engine, characters, length)) {
+        return;
+    }
+    size_t consumed = AIUAWordCountScan(engine->pending, engine->pendingLength, false, engine->spanCounter, engine->context,
+                                        &engine->spanResume, &engine->total);
+    if (consumed > 0) {
+        memmove(engine->pending, engine->pending + consumed, (engine->pendingLength - consumed) * sizeof(uint16_t));
+        engine->pendingLength -= consumed;
+    }
+}
+
+void AIUAWordCountEngineFeedUTF8(AIUAWordCountEngine *engine, const uint8_t *bytes, size_t length) {
+    if (!engine || engine->failed || !bytes || length == 0) {
+        return;
+    }
+    uint16_t buffer[AIUA_WORD_COUNT_UTF8_BUFFER_LENGTH];
+    size_t bufferLength = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = bytes[i];
+        uint32_t cp = 0;
+        bool emit = false;
+        if (engine->utf8Remaining > 0) {
+            if ((byte & 0xC0) == 0x80) {
+                engine->utf8CodePoint = (engine->utf8CodePoint << 6) | (byte & 0x3F);
+                engine->utf8Remaining -= 1;
+                if (engine->utf8Remaining == 0) {
+                    cp = engine->utf8CodePoint;
+                    // 过长编码、代理项、超出范围均视为非法
+                    if (cp < engine->utf8Minimum || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+                        cp = 0xFFFD;
+                    }
+                    emit = true;
+                }
+            } else {
+                // 多字节字符被截断：先输出替换字符，再按新字符处理当前字节
+                engine->utf8Remaining = 0;
+                buffer[bufferLength++] = 0xFFFD;
+                i -= 1;
+            }
+        } else if (byte < 0x80) {
+            cp = byte;
+            emit = true;
+        } else if ((byte & 0xE0) == 0xC0) {
+            engine->utf8CodePoint = byte & 0x1F;
+            engine->utf8Remaining = 1;
+            engine->utf8Minimum = 0x80;
+        } else if ((byte & 0xF0) == 0xE0) {
+            engine->utf8CodePoint = byte & 0x0F;
+            engine->utf8Remaining = 2;
+            engine->utf8Minimum = 0x800;
+        } else if ((byte & 0xF8) == 0xF0) {
+            engine->utf8CodePoint = byte & 0x07;
+            engine->utf8Remaining = 3;
+            engine->utf8Minimum = 0x10000;
+        } else {
+            cp = 0xFFFD;
+            emit = true;
+        }
+
+        if (emit) {
+            if (cp >= 0x10000) {
+                cp -= 0x10000;
+                buffer[bufferLength++] = (uint16_t)(0xD800 + (cp >> 10));
+                buffer[bufferLength++] = (uint16_t)(0xDC00 + (cp & 0x3FF));
+            } else {
+                buffer[bufferLength++] = (uint16_t)cp;
+            }
+        }
+        if (bufferLength + 2 > AIUA_WORD_COUNT_UTF8_BUFFER_LENGTH) {
+            AIUAWordCountEngineFeedUTF16(engine, buffer, bufferLength);
+            bufferLength = 0;
+        }
+    }
+    if (bufferLength > 0) {
+        AIUAWordCountEngineFeedUTF16(engine, buffer, bufferLength);
+    }
+}
+
+uint64_t AIUAWordCountEngineGetTotal(AIUAWordCountEngine *engine) {
+    if (!engine) {
+        return 0;
+    }
+    uint64_t total = engine->total;
+    if (engine->pendingLength > 0) {
+        size_t spanResume = engine->spanResume;
+        AIUAWordCountScan(engine->pending, engine->pendingLength, true, engine->spanCounter, engine->context,
+                          &spanResume, &total);
+    }
+    // 未完成的 UTF-8 多字节字符按一个替换字符计
+    if (engine->utf8Remaining > 0) {
+        total += 1;
+    }
+    return total;
+}
+
+bool AIUAWordCountEngineHasFailed(const AIUAWordCountEngine *engine) {
+    return !engine || engine->failed;
+}
@@ -0,0 +1,64 @@
+//
+//  AIUAWordCountEngine.h
+//  AIUniversalAssistant
+//
+//  字数统计引擎（按字符簇计数，1 个字符簇计 1 字），纯C实现
+//  - 快速路径：ASCII/拉丁字母、常用中日韩汉字与标点、假名、韩文音节等"简单字符"两两之间必然是簇边界，
+//    直接按码元计数；其中 ASCII 与基本汉字区段使用 NEON/SSE2 一次判断 8 个码元
+//  - 只有组合附加符号、ZWJ 表情序列、区域旗帜、代理对等"复杂片段"才交给 spanCounter 精确计数；
+//    复杂片段两端都是确定的簇边界，可以独立计数
+//  - 支持流式输入：末尾尚未确定的簇缓存到下一次输入，结果与整段统计相同
+//
+
+#ifndef AIUAWordCountEngine_h
+#define AIUAWordCountEngine_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 统计复杂片段中的字符簇数。片段两端均为簇边界
+ * Apple 平台应传入基于 CFStringGetRangeOfComposedCharactersAtIndex 的实现，以与系统口径保持一致
+ */
+typedef size_t (*AIUAWordCountSpanCounter)(const uint16_t *characters, size_t length, void *context);
+
+/// 内置的可移植片段计数（按 UAX #29 扩展字符簇的主要规则：CRLF、控制符、韩文音节、
+/// 组合符号/变体选择符/肤色修饰、ZWJ 表情序列、区域旗帜；不含 Prepend 与印度语系连写规则）
+size_t AIUAWordCountDefaultSpanCounter(const uint16_t *characters, size_t length, void *context);
+
+/// 一次性统计 UTF-16 文本，spanCounter 为 NULL 时使用内置实现
+size_t AIUAWordCountUTF16(const uint16_t *characters, size_t length, AIUAWordCountSpanCounter spanCounter, void *context);
+
+typedef struct AIUAWordCountEngine AIUAWordCountEngine;
+
+/// 创建流式统计引擎，失败返回 NULL；spanCounter 为 NULL 时使用内置实现
+AIUAWordCountEngine *AIUAWordCountEngineCreate(AIUAWordCountSpanCounter spanCounter, void *context);
+
+/// 释放引擎
+void AIUAWordCountEngineDestroy(AIUAWordCountEngine *engine);
+
+/// 重置为新文本（保留已分配的缓冲区）
+void AIUAWordCountEngineReset(AIUAWordCountEngine *engine);
+
+/// 输入一段 UTF-16 文本
+void AIUAWordCountEngineFeedUTF16(AIUAWordCountEngine *engine, const uint16_t *characters, size_t length);
+
+/// 输入一段 UTF-8 文本（多字节字符可以跨 chunk；非法字节按 U+FFFD 计）
+void AIUAWordCountEngineFeedUTF8(AIUAWordCountEngine *engine, const uint8_t *bytes, size_t length);
+
+/// 当前总字数：已确定部分 + 把缓存的末尾当作文本结束时的字数（不改变状态）
+uint64_t AIUAWordCountEngineGetTotal(AIUAWordCountEngine *engine);
+
+/// 内存分配失败后为 true，此时结果不可信，调用方应回退到其他实现
+bool AIUAWordCountEngineHasFailed(const AIUAWordCountEngine *engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AIUAWordCountEngine_h */
@@ -0,0 +1,30 @@
+//
+//  AIUAWordCounter.h
+//  AIUniversalAssistant
+//
+//  字数统计（AIUAWordCountEngine 的 Objective-C 封装）
+//  口径与 NSStringEnumerationByComposedCharacterSequences 逐字符簇一致：1 个字符簇计 1 字
+//  另外提供流式模式，生成过程中逐 chunk 累加，结束时无需再整段统计
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface AIUAWordCounter : NSObject
+
+/// 一次性统计整段文本
++ (NSInteger)countWordsInText:(nullable NSString *)text;
+
+/// 当前累计字数（包含尚未确定边界的末尾字符）
+@property (nonatomic, assign, readonly) NSInteger count;
+
+/// 追加一段文本（字符簇可以跨 chunk）
+- (void)appendText:(nullable NSString *)text;
+
+/// 清零，开始新的统计
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,129 @@
+//
+//  AIUAWordCounter.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAWordCounter.h"
+#import "AIUAWordCountEngine.h"
+
+// 小段文本使用栈上缓冲区，避免每个 chunk 都分配内存
+static const NSUInteger kAIUAWordCountStackBufferLength = 512;
+
+// 复杂片段交给 CoreFoundation 计数，与 NSStringEnumerationByComposedCharacterSequences 口径一致
+static size_t AIUAWordCounterComposedSpanCounter(const uint16_t *characters, size_t length, void *context) {
+    CFStringRef span = CFStringCreateWithCharactersNoCopy(kCFAllocatorDefault, characters, (CFIndex)length, kCFAllocatorNull);
+    if (!span) {
+        return AIUAWordCountDefaultSpanCounter(characters, length, context);
+    }
+    size_t count = 0;
+    CFIndex index = 0;
+    while (index < (CFIndex)length) {
+        CFRange range = CFStringGetRangeOfComposedCharactersAtIndex(span, index);
+        index = range.location + MAX(range.length, 1);
+        count += 1;
+    }
+    CFRelease(span);
+    return count;
+}
+
+// 取得文本的 UTF-16 码元并回调；优先零拷贝
+static BOOL AIUAWordCounterWithCharacters(NSString *text, void (^block)(const uint16_t *characters, size_t length)) {
+    NSUInteger length = text.length;
+    const UniChar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)text);
+    if (characters) {
+        block(characters, length);
+    } else if (length <= kAIUAWordCountStackBufferLength) {
+        UniChar buffer[kAIUAWordCountStackBufferLength];
+        [text getCharacters:buffer range:NSMakeRange(0, length)];
+        block(buffer, length);
+    } else {
+        UniChar *buffer = (UniChar *)malloc(length * sizeof(UniChar));
+        if (!buffer) {
+            return NO;
+        }
+        [text getCharacters:buffer range:NSMakeRange(0, length)];
+        block(buffer, length);
+        free(buffer);
+    }
+    return YES;
+}
+
+@implementation AIUAWordCounter {
+    AIUAWordCountEngine *_engine;
+    NSInteger _fallbackCount;   // 引擎不可用时的累计（逐段按字符簇统计）
+}
+
++ (NSInteger)countWordsInText:(NSString *)text {
+    if (text.length == 0) {
+        return 0;
+    }
+    __block size_t count = 0;
+    BOOL success = AIUAWordCounterWithCharacters(text, ^(const uint16_t *characters, size_t length) {
+        count = AIUAWordCountUTF16(characters, length, AIUAWordCounterComposedSpanCounter, NULL);
+    });
+    if (!success) {
+        return [self countComposedCharacterSequencesInText:text];
+    }
+    return (NSInteger)count;
+}
+
+// 原始实现，仅在内存不足时使用
++ (NSInteger)countComposedCharacterSequencesInText:(NSString *)text {
+    __block NSInteger count = 0;
+    [text enumerateSubstringsInRange:NSMakeRange(0, text.length)
+                             options:NSStringEnumerationByComposedCharacterSequences | NSStringEnumerationSubstringNotRequired
+                          usingBlock:^(NSString * _Nullable substring, NSRange substringRange, NSRange enclosingRange, BOOL * _Nonnull stop) {
+        count++;
+    }];
+    return count;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _engine = AIUAWordCountEngineCreate(AIUAWordCounterComposedSpanCounter, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    AIUAWordCountEngineDestroy(_engine);
+}
+
+- (NSInteger)count {
+    if (!_engine) {
+        return _fallbackCount;
+    }
+    return (NSInteger)AIUAWordCountEngineGetTotal(_engine);
+}
+
+- (void)appendText:(NSString *)text {
+    if (text.length == 0) {
+        return;
+    }
+    if (!_engine || AIUAWordCountEngineHasFailed(_engine)) {
+        // 引擎不可用时按段统计（跨段的字符簇可能多计，仅在内存不足时发生）
+        if (_engine) {
+            _fallbackCount = (NSInteger)AIUAWordCountEngineGetTotal(_engine);
+            AIUAWordCountEngineDestroy(_engine);
+            _engine = NULL;
+        }
+        _fallbackCount += [AIUAWordCounter countComposedCharacterSequencesInText:text];
+        return;
+    }
+    AIUAWordCountEngine *engine = _engine;
+    AIUAWordCounterWithCharacters(text, ^(const uint16_t *characters, size_t length) {
+        AIUAWordCountEngineFeedUTF16(engine, characters, length);
+    });
+}
+
+- (void)reset {
+    _fallbackCount = 0;
+    if (!_engine) {
+        _engine = AIUAWordCountEngineCreate(AIUAWordCounterComposedSpanCounter, NULL);
+    } else {
+        AIUAWordCountEngineReset(_engine);
+    }
+}
+
+@end
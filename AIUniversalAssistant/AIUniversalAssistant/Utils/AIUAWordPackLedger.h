@@ -0,0 +1,111 @@
+//
+//  AIUAWordPackLedger.h
+//  AIUniversalAssistant
+//
+//  字数包内存账本：赠送字数、累计消耗、购买批次与多设备同步状态的内存副本
+//  - 按命名空间从存储（Keychain）加载一次，之后读写只访问内存
+//  - 修改只标记脏 key：入账（购买、奖励、赠送）立即写回，消耗等高频修改延迟 flushDelay 后批量写回
+//  - 写回后需要上传时调用 uploadHandler（由 AIUAWordPackManager 注入 iCloud 上传）
+//  - 存储通过协议注入，不依赖 AIUAWordPackManager/AIUAIAPManager 等单例，可在命令行下测试
+//  - 带 Locked 后缀的方法与账本属性只能在 performBlock: 的 block 内访问
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLotStore.h"
+#import "AIUAWordPackSyncState.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 存储 key（实际写入时追加 ".<命名空间>"）
+extern NSString * const AIUAWordPackLedgerGiftedWordsKey;
+extern NSString * const AIUAWordPackLedgerGiftAwardedKey;
+extern NSString * const AIUAWordPackLedgerConsumedWordsKey;
+extern NSString * const AIUAWordPackLedgerPurchasesKey;
+extern NSString * const AIUAWordPackLedgerSyncEntriesKey;
+
+/// 账本的持久化存储，AIUAKeychainManager 已实现
+@protocol AIUAWordPackLedgerStorage <NSObject>
+- (BOOL)setInteger:(NSInteger)value forKey:(NSString *)key;
+- (NSInteger)integerForKey:(NSString *)key;
+- (BOOL)setObject:(id)object forKey:(NSString *)key;
+- (id _Nullable)objectForKey:(NSString *)key;
+@end
+
+@interface AIUAWordPackLedger : NSObject
+
+/// 消耗后延迟写回的间隔，默认 1 秒
+@property (nonatomic, assign) NSTimeInterval flushDelay;
+
+/// 写回时若有修改需要上传则在账本队列上调用
+@property (nonatomic, copy, nullable) void (^uploadHandler)(void);
+
+#pragma mark - 账本状态（只能在 performBlock: 内访问）
+
+/// 已加载的命名空间，nil 表示尚未加载
+@property (nonatomic, copy, readonly, nullable) NSString *loadedNamespace;
+@property (nonatomic, assign) NSInteger giftedWords;
+@property (nonatomic, assign) BOOL giftAwarded;
+@property (nonatomic, assign) NSInteger consumedWords;
+/// 购买/奖励记录
+@property (nonatomic, strong, readonly) AIUAWordPackLotStore *lots;
+/// 多设备同步状态，上面的余额由它计算得出
+@property (nonatomic, strong, readonly, nullable) AIUAWordPackSyncState *syncState;
+/// 已上传的本设备条目版本，加载时重置
+@property (nonatomic, assign) NSUInteger uploadedSyncVersion;
+/// 有修改尚未上传
+@property (nonatomic, assign) BOOL needsUpload;
+
+/**
+ * @param storage 持久化存储
+ * @param giftWords VIP 一次性赠送的总字数（迁移旧账本时使用）
+ * @param deviceIDProvider 首次加载时取本设备 id
+ */
+- (instancetype)initWithStorage:(id<AIUAWordPackLedgerStorage>)storage
+                      giftWords:(NSInteger)giftWords
+               deviceIDProvider:(NSString * (^)(void))deviceIDProvider NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 在账本队列上同步执行；已在队列上时直接执行
+- (void)performBlock:(void (^)(void))block;
+
+/// 收到这些通知时（如 App 退到后台、即将终止）立即写回
+- (void)flushOnNotificationsNamed:(NSArray<NSNotificationName> *)names;
+
+/// 立即写回未落盘的修改并按需上传
+- (void)flush;
+
+#pragma mark - 以下只能在 performBlock: 内调用
+
+/// 命名空间与已加载的不同时加载（先把旧账本写回旧命名空间）；首次使用同步状态时把旧账本作为基线迁移
+- (void)loadNamespaceIfNeededLocked:(NSString *)ns;
+
+/// 按同步状态重建余额、赠送字数与累计消耗
+- (void)applySyncStateLocked;
+
+/// 移除在 date 之前过期的购买记录，返回移除的记录
+- (NSArray<NSDictionary *> *)removeExpiredPurchasesAtDateLocked:(NSDate *)date;
+
+/// 余额足够时从购买/奖励批次扣减，remainingWords 返回扣减后（不足时为当前）的余额
+- (BOOL)consumeWordsLocked:(NSInteger)words remainingWords:(NSInteger * _Nullable)remainingWords;
+
+/// 累计消耗统计（不扣余额），返回累计消耗
+- (NSInteger)recordConsumedWordsLocked:(NSInteger)words;
+
+/// 标记脏 key，不安排写回（由调用方随后写回）
+- (void)addDirtyKeysLocked:(NSArray<NSString *> *)keys;
+
+/// 标记脏 key 并需要上传：immediately 为 YES 时立即写回，否则延迟 flushDelay 批量写回
+- (void)markDirtyLocked:(NSArray<NSString *> *)keys immediately:(BOOL)immediately;
+
+/// 只把脏 key 写回存储
+- (void)writeDirtyKeysLocked;
+
+/// 写回脏 key，需要上传时调用 uploadHandler
+- (void)flushLocked;
+
+/// 丢弃未写回的修改并卸载账本，下次访问时重新加载
+- (void)discardLocked;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,256 @@
+//
+//  AIUAWordPackLedger.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAWordPackLedger.h"
+
+NSString * const AIUAWordPackLedgerGiftedWordsKey = @"kAIUAVIPGiftedWords";
+NSString * const AIUAWordPackLedgerGiftAwardedKey = @"kAIUAVIPGiftAwarded"; // 标记是否已赠送过一次性50万字
+NSString * const AIUAWordPackLedgerConsumedWordsKey = @"kAIUAConsumedWords";
+NSString * const AIUAWordPackLedgerPurchasesKey = @"kAIUAWordPackPurchases";
+NSString * const AIUAWordPackLedgerSyncEntriesKey = @"kAIUAWordPackSyncEntries"; // 多设备同步状态（各设备条目）
+
+static const NSTimeInterval kAIUAWordPackLedgerDefaultFlushDelay = 1.0;
+static void *kAIUAWordPackLedgerQueueKey = &kAIUAWordPackLedgerQueueKey;
+
+@interface AIUAWordPackLedger ()
+
+@property (nonatomic, strong) id<AIUAWordPackLedgerStorage> storage;
+@property (nonatomic, assign) NSInteger giftWords;
+@property (nonatomic, copy) NSString * (^deviceIDProvider)(void);
+@property (nonatomic, strong) dispatch_queue_t queue;
+
+@property (nonatomic, copy, readwrite, nullable) NSString *loadedNamespace;
+@property (nonatomic, strong, readwrite) AIUAWordPackLotStore *lots;
+@property (nonatomic, strong, readwrite, nullable) AIUAWordPackSyncState *syncState;
+@property (nonatomic, strong) NSMutableSet<NSString *> *dirtyKeys;
+@property (nonatomic, assign) BOOL flushScheduled;
+
+@end
+
+@implementation AIUAWordPackLedger
+
+- (instancetype)initWithStorage:(id<AIUAWordPackLedgerStorage>)storage
+                      giftWords:(NSInteger)giftWords
+               deviceIDProvider:(NSString * (^)(void))deviceIDProvider {
+    self = [super init];
+    if (self) {
+        _storage = storage;
+        _giftWords = giftWords;
+        _deviceIDProvider = [deviceIDProvider copy];
+        _flushDelay = kAIUAWordPackLedgerDefaultFlushDelay;
+        // 队列标记使用实例地址，多个账本实例互不混淆
+        _queue = dispatch_queue_create("com.aiua.wordpack.ledger", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_queue, kAIUAWordPackLedgerQueueKey, (__bridge void *)self, NULL);
+        _lots = [[AIUAWordPackLotStore alloc] init];
+        _dirtyKeys = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (void)performBlock:(void (^)(void))block {
+    if (dispatch_get_specific(kAIUAWordPackLedgerQueueKey) == (__bridge void *)self) {
+        block();
+    } else {
+        dispatch_sync(self.queue, block);
+    }
+}
+
+- (void)flushOnNotificationsNamed:(NSArray<NSNotificationName> *)names {
+    for (NSNotificationName name in names) {
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(flushForNotification:)
+                                                     name:name
+                                                   object:nil];
+    }
+}
+
+- (void)flushForNotification:(NSNotification *)notification {
+    [self flush];
+}
+
+- (void)flush {
+    [self performBlock:^{
+        [self flushLocked];
+    }];
+}
+
+#pragma mark - 加载
+
+- (NSString *)scopedKey:(NSString *)key namespace:(NSString *)ns {
+    return [NSString stringWithFormat:@"%@.%@", key, ns];
+}
+
+- (void)loadNamespaceIfNeededLocked:(NSString *)ns {
+    if ([self.loadedNamespace isEqualToString:ns]) {
+        return;
+    }
+    if (self.loadedNamespace) {
+        // 命名空间切换时先把旧账本写回旧命名空间
+        [self flushLocked];
+    }
+
+    self.giftedWords = [self.storage integerForKey:[self scopedKey:AIUAWordPackLedgerGiftedWordsKey namespace:ns]];
+    self.giftAwarded = [self.storage integerForKey:[self scopedKey:AIUAWordPackLedgerGiftAwardedKey namespace:ns]] != 0;
+    self.consumedWords = [self.storage integerForKey:[self scopedKey:AIUAWordPackLedgerConsumedWordsKey namespace:ns]];
+    NSArray *storedPurchases = [self.storage objectForKey:[self scopedKey:AIUAWordPackLedgerPurchasesKey namespace:ns]];
+
+    // 余额由同步状态计算；首次使用时把现有账本作为基线迁移
+    NSDictionary *syncEntries = [self.storage objectForKey:[self scopedKey:AIUAWordPackLedgerSyncEntriesKey namespace:ns]];
+    BOOL migrated = ![syncEntries isKindOfClass:[NSDictionary class]];
+    self.syncState = [[AIUAWordPackSyncState alloc] initWithDeviceID:self.deviceIDProvider()
+                                                             entries:migrated ? nil : syncEntries];
+    if (migrated) {
+        [self.syncState mergeBaselineWithPurchases:[storedPurchases isKindOfClass:[NSArray class]] ? storedPurchases : nil
+                                         giftWords:self.giftWords
+                                remainingGiftWords:self.giftedWords
+                                       giftAwarded:self.giftAwarded
+                                     consumedWords:self.consumedWords];
+    }
+    [self applySyncStateLocked];
+
+    self.loadedNamespace = ns;
+    [self.dirtyKeys removeAllObjects];
+    self.needsUpload = NO;
+    self.uploadedSyncVersion = 0;
+    if (migrated) {
+        [self.dirtyKeys addObjectsFromArray:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerPurchasesKey]];
+        [self writeDirtyKeysLocked];
+        self.needsUpload = YES;
+        NSLog(@"[WordPack] 账本已迁移为多设备同步状态（设备 %@）", self.syncState.deviceID);
+    }
+    NSLog(@"[WordPack] 账本已加载（%@）：购买记录 %lu 条", ns, (unsigned long)self.lots.count);
+}
+
+- (void)applySyncStateLocked {
+    AIUAWordPackConsumePolicy policy = self.lots.policy;
+    NSArray *purchases = [self.syncState purchaseRecordsAtDate:[NSDate date] policy:policy];
+    self.lots = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:[purchases isKindOfClass:[NSArray class]] ? purchases : nil];
+    self.lots.policy = policy;
+    self.giftedWords = self.syncState.giftedWords;
+    self.giftAwarded = self.syncState.giftAwarded;
+    self.consumedWords = self.syncState.consumedWords;
+}
+
+- (void)discardLocked {
+    [self.dirtyKeys removeAllObjects];
+    self.needsUpload = NO;
+    self.loadedNamespace = nil;
+    self.syncState = nil;
+}
+
+#pragma mark - 修改
+
+- (NSArray<NSDictionary *> *)removeExpiredPurchasesAtDateLocked:(NSDate *)date {
+    NSArray<NSDictionary *> *expired = [self.lots removeExpiredLotsAtDate:date];
+    for (NSDictionary *purchase in expired) {
+        NSInteger expiredWords = [purchase[@"remainingWords"] integerValue];
+        if (expiredWords > 0) {
+            NSLog(@"[WordPack] 清除过期记录: %@ 字，过期时间: %@", @(expiredWords), purchase[@"expiryDate"]);
+        }
+    }
+    if (expired.count > 0) {
+        [self markDirtyLocked:@[AIUAWordPackLedgerPurchasesKey] immediately:NO];
+    }
+    // 账本按同步状态重建时已滤掉过期批次，这里不能以账本是否有过期记录为条件；
+    // 同步状态中还留有过期批次（含其他设备创建或合并进来的）时移除并记入移除记录，上传后其他设备不会再把它们合并回来
+    if ([self.syncState pruneLotsExpiredBeforeDate:date]) {
+        [self markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey] immediately:NO];
+    }
+    return expired;
+}
+
+- (BOOL)consumeWordsLocked:(NSInteger)words remainingWords:(NSInteger *)remainingWords {
+    NSInteger available = self.lots.remainingWords;
+    if (available < words) {
+        NSLog(@"[WordPack] 字数不足，需要: %ld，可用: %ld", (long)words, (long)available);
+        if (remainingWords) {
+            *remainingWords = available;
+        }
+        return NO;
+    }
+    // 按消耗顺序扣减（默认先购买的先消耗），同时记录各批次的扣减计数用于同步
+    NSInteger consumed = words > 0 ? [self.lots consumeWords:words usingBlock:^(NSDictionary *record, NSInteger consumedWords) {
+        [self.syncState recordWords:consumedWords consumedFromLot:[AIUAWordPackSyncState lotIDForLegacyRecord:record]];
+    }] : 0;
+    if (consumed > 0) {
+        NSLog(@"[WordPack] 从购买字数包消耗 %ld 字，剩余 %ld 字", (long)consumed, (long)self.lots.remainingWords);
+        [self markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerPurchasesKey] immediately:NO];
+    }
+    if (remainingWords) {
+        *remainingWords = available - words;
+    }
+    return YES;
+}
+
+- (NSInteger)recordConsumedWordsLocked:(NSInteger)words {
+    self.consumedWords += words;
+    [self.syncState recordConsumedWords:words];
+    [self markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerConsumedWordsKey] immediately:NO];
+    return self.consumedWords;
+}
+
+#pragma mark - 写回
+
+- (void)addDirtyKeysLocked:(NSArray<NSString *> *)keys {
+    [self.dirtyKeys addObjectsFromArray:keys];
+}
+
+- (void)markDirtyLocked:(NSArray<NSString *> *)keys immediately:(BOOL)immediately {
+    [self.dirtyKeys addObjectsFromArray:keys];
+    self.needsUpload = YES;
+    if (immediately) {
+        [self flushLocked];
+        return;
+    }
+    if (self.flushScheduled) {
+        return;
+    }
+    self.flushScheduled = YES;
+    __weak typeof(self) wself = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.flushDelay * NSEC_PER_SEC)), self.queue, ^{
+        __strong typeof(wself) sself = wself;
+        sself.flushScheduled = NO;
+        [sself flushLocked];
+    });
+}
+
+- (void)writeDirtyKeysLocked {
+    if (!self.loadedNamespace || self.dirtyKeys.count == 0) {
+        return;
+    }
+    NSString *ns = self.loadedNamespace;
+    for (NSString *key in self.dirtyKeys) {
+        NSString *scopedKey = [self scopedKey:key namespace:ns];
+        if ([key isEqualToString:AIUAWordPackLedgerGiftedWordsKey]) {
+            [self.storage setInteger:self.giftedWords forKey:scopedKey];
+        } else if ([key isEqualToString:AIUAWordPackLedgerGiftAwardedKey]) {
+            [self.storage setInteger:self.giftAwarded ? 1 : 0 forKey:scopedKey];
+        } else if ([key isEqualToString:AIUAWordPackLedgerConsumedWordsKey]) {
+            [self.storage setInteger:self.consumedWords forKey:scopedKey];
+        } else if ([key isEqualToString:AIUAWordPackLedgerPurchasesKey]) {
+            [self.storage setObject:[self.lots purchaseRecords] forKey:scopedKey];
+        } else if ([key isEqualToString:AIUAWordPackLedgerSyncEntriesKey]) {
+            [self.storage setObject:[self.syncState entries] forKey:scopedKey];
+        }
+    }
+    NSLog(@"[WordPack] 账本写回Keychain: %@", [self.dirtyKeys.allObjects componentsJoinedByString:@", "]);
+    [self.dirtyKeys removeAllObjects];
+}
+
+- (void)flushLocked {
+    [self writeDirtyKeysLocked];
+    if (self.needsUpload) {
+        self.needsUpload = NO;
+        if (self.uploadHandler) {
+            self.uploadHandler();
+        }
+    }
+}
+
+@end
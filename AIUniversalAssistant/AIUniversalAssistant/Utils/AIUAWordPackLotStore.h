@@ -0,0 +1,72 @@
+//
+//  AIUAWordPackLotStore.h
+//  AIUniversalAssistant
+//
+//  字数包批次（购买记录/奖励记录）索引
+//  - 同时按购买时间、过期时间、消耗顺序维护有序索引，消耗时直接从消耗顺序的队首扣减，不再每次排序
+//  - 过期记录按过期时间从队首批量移除，剩余总字数随增删和消耗增量维护
+//  - "N 天内即将过期"只需遍历过期时间索引的前缀
+//  - 记录仍以字典形式持久化（productID/words/remainingWords/purchaseDate/expiryDate），格式与原来一致
+//  - 非线程安全，由调用方串行访问
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// 消耗顺序
+typedef NS_ENUM(NSUInteger, AIUAWordPackConsumePolicy) {
+    AIUAWordPackConsumePolicyPurchaseDate = 0,  // 先购买的先消耗（默认）
+    AIUAWordPackConsumePolicyEarliestExpiry     // 先过期的先消耗
+};
+
+@interface AIUAWordPackLotStore : NSObject
+
+/// 消耗顺序，修改后按新顺序重建消耗索引
+@property (nonatomic, assign) AIUAWordPackConsumePolicy policy;
+
+/// 记录条数（含已用完但未过期的记录）
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// 全部记录的剩余字数之和；调用前应先 removeExpiredLotsAtDate: 才表示未过期字数
+@property (nonatomic, assign, readonly) NSInteger remainingWords;
+
+/**
+ * 从持久化的记录数组创建
+ * 缺少过期时间的记录视为已过期，缺少购买时间的记录排在最前
+ */
+- (instancetype)initWithPurchaseRecords:(nullable NSArray<NSDictionary *> *)records;
+
+/// 追加一条记录
+- (void)addPurchaseRecord:(NSDictionary *)record;
+
+/**
+ * 移除在 date 时已过期（过期时间不晚于 date）的记录
+ * @return 被移除的记录，按过期时间升序
+ */
+- (NSArray<NSDictionary *> *)removeExpiredLotsAtDate:(NSDate *)date;
+
+/**
+ * 按消耗顺序扣减字数，调用前应先移除过期记录
+ * @return 实际扣减的字数（余额不足时小于 words）
+ */
+- (NSInteger)consumeWords:(NSInteger)words;
+
+/**
+ * 按消耗顺序扣减字数，每扣减一条记录回调一次（用于记录各批次的扣减）
+ * @return 实际扣减的字数（余额不足时小于 words）
+ */
+- (NSInteger)consumeWords:(NSInteger)words
+               usingBlock:(nullable void (^)(NSDictionary *record, NSInteger consumedWords))block;
+
+/**
+ * days 天内即将过期的字数，按剩余天数（向上取整，1...days）分组
+ */
+- (NSDictionary<NSNumber *, NSNumber *> *)expiringWordsWithinDays:(NSInteger)days atDate:(NSDate *)date;
+
+/// 用于持久化的记录数组，按购买时间升序
+- (NSArray<NSDictionary *> *)purchaseRecords;
+
+@end
+
+NS_ASSUME_NONNULL_END
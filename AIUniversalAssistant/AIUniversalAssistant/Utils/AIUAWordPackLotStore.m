@@ -0,0 +1,229 @@
+//
+//  AIUAWordPackLotStore.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAWordPackLotStore.h"
+
+static const NSTimeInterval kAIUAWordPackSecondsPerDay = 24 * 60 * 60;
+
+@interface AIUAWordPackLot : NSObject
+@property (nonatomic, strong) NSMutableDictionary *record;
+@property (nonatomic, strong) NSDate *purchaseDate;
+@property (nonatomic, strong) NSDate *expiryDate;
+@property (nonatomic, assign) NSInteger remainingWords;
+@property (nonatomic, assign) NSUInteger sequence;  // 加入顺序，日期相同时保持原有先后
+@end
+
+@implementation AIUAWordPackLot
+@end
+
+// 日期相同时按加入顺序，保证排序稳定且每条记录位置唯一（便于二分查找定位）
+static NSComparisonResult AIUAWordPackCompareLots(NSDate *date1, NSDate *date2, AIUAWordPackLot *lot1, AIUAWordPackLot *lot2) {
+    NSComparisonResult result = [date1 compare:date2];
+    if (result != NSOrderedSame) {
+        return result;
+    }
+    if (lot1.sequence == lot2.sequence) {
+        return NSOrderedSame;
+    }
+    return lot1.sequence < lot2.sequence ? NSOrderedAscending : NSOrderedDescending;
+}
+
+@interface AIUAWordPackLotStore ()
+
+@property (nonatomic, strong) NSMutableArray<AIUAWordPackLot *> *purchaseOrder;  // 全部记录，按购买时间
+@property (nonatomic, strong) NSMutableArray<AIUAWordPackLot *> *expiryOrder;    // 全部记录，按过期时间
+@property (nonatomic, strong) NSMutableArray<AIUAWordPackLot *> *consumeOrder;   // 有剩余字数的记录，按消耗顺序
+@property (nonatomic, assign, readwrite) NSInteger remainingWords;
+@property (nonatomic, assign) NSUInteger nextSequence;
+
+@end
+
+@implementation AIUAWordPackLotStore
+
+- (instancetype)init {
+    return [self initWithPurchaseRecords:nil];
+}
+
+- (instancetype)initWithPurchaseRecords:(NSArray<NSDictionary *> *)records {
+    self = [super init];
+    if (self) {
+        _purchaseOrder = [NSMutableArray arrayWithCapacity:records.count];
+        _expiryOrder = [NSMutableArray arrayWithCapacity:records.count];
+        _consumeOrder = [NSMutableArray arrayWithCapacity:records.count];
+        for (NSDictionary *record in records) {
+            if (![record isKindOfClass:[NSDictionary class]]) {
+                continue;
+            }
+            AIUAWordPackLot *lot = [self lotWithRecord:record];
+            [_purchaseOrder addObject:lot];
+            [_expiryOrder addObject:lot];
+            if (lot.remainingWords > 0) {
+                [_consumeOrder addObject:lot];
+            }
+            _remainingWords += lot.remainingWords;
+        }
+        // 批量加载只排序一次，之后增删都在有序数组上二分定位
+        [_purchaseOrder sortUsingComparator:[self purchaseComparator]];
+        [_expiryOrder sortUsingComparator:[self expiryComparator]];
+        [_consumeOrder sortUsingComparator:[self consumeComparator]];
+    }
+    return self;
+}
+
+- (AIUAWordPackLot *)lotWithRecord:(NSDictionary *)record {
+    AIUAWordPackLot *lot = [[AIUAWordPackLot alloc] init];
+    lot.record = [record mutableCopy];
+    NSDate *purchaseDate = record[@"purchaseDate"];
+    NSDate *expiryDate = record[@"expiryDate"];
+    lot.purchaseDate = [purchaseDate isKindOfClass:[NSDate class]] ? purchaseDate : [NSDate distantPast];
+    lot.expiryDate = [expiryDate isKindOfClass:[NSDate class]] ? expiryDate : [NSDate distantPast];
+    lot.remainingWords = MAX(0, [record[@"remainingWords"] integerValue]);
+    lot.sequence = self.nextSequence++;
+    return lot;
+}
+
+#pragma mark - 排序规则
+
+- (NSComparator)purchaseComparator {
+    return ^NSComparisonResult(AIUAWordPackLot *a, AIUAWordPackLot *b) {
+        return AIUAWordPackCompareLots(a.purchaseDate, b.purchaseDate, a, b);
+    };
+}
+
+- (NSComparator)expiryComparator {
+    return ^NSComparisonResult(AIUAWordPackLot *a, AIUAWordPackLot *b) {
+        return AIUAWordPackCompareLots(a.expiryDate, b.expiryDate, a, b);
+    };
+}
+
+- (NSComparator)consumeComparator {
+    switch (self.policy) {
+        case AIUAWordPackConsumePolicyEarliestExpiry:
+            return [self expiryComparator];
+        case AIUAWordPackConsumePolicyPurchaseDate:
+        default:
+            return [self purchaseComparator];
+    }
+}
+
+- (void)setPolicy:(AIUAWordPackConsumePolicy)policy {
+    if (_policy == policy) {
+        return;
+    }
+    _policy = policy;
+    [self.consumeOrder sortUsingComparator:[self consumeComparator]];
+}
+
+#pragma mark - 有序数组操作
+
+- (void)insertLot:(AIUAWordPackLot *)lot into:(NSMutableArray<AIUAWordPackLot *> *)array comparator:(NSComparator)comparator {
+    NSUInteger index = [array indexOfObject:lot
+                              inSortedRange:NSMakeRange(0, array.count)
+                                    options:NSBinarySearchingInsertionIndex
+                            usingComparator:comparator];
+    [array insertObject:lot atIndex:index];
+}
+
+- (void)removeLot:(AIUAWordPackLot *)lot from:(NSMutableArray<AIUAWordPackLot *> *)array comparator:(NSComparator)comparator {
+    NSUInteger index = [array indexOfObject:lot
+                              inSortedRange:NSMakeRange(0, array.count)
+                                    options:NSBinarySearchingFirstEqual
+                            usingComparator:comparator];
+    if (index != NSNotFound) {
+        [array removeObjectAtIndex:index];
+    }
+}
+
+#pragma mark - 公开方法
+
+- (NSUInteger)count {
+    return self.purchaseOrder.count;
+}
+
+- (void)addPurchaseRecord:(NSDictionary *)record {
+    AIUAWordPackLot *lot = [self lotWithRecord:record];
+    [self insertLot:lot into:self.purchaseOrder comparator:[self purchaseComparator]];
+    [self insertLot:lot into:self.expiryOrder comparator:[self expiryComparator]];
+    if (lot.remainingWords > 0) {
+        [self insertLot:lot into:self.consumeOrder comparator:[self consumeComparator]];
+    }
+    self.remainingWords += lot.remainingWords;
+}
+
+- (NSArray<NSDictionary *> *)removeExpiredLotsAtDate:(NSDate *)date {
+    NSMutableArray<NSDictionary *> *removed = nil;
+    // 过期时间索引的队首即最早过期的记录，没有过期记录时只比较一次
+    while (self.expiryOrder.count > 0) {
+        AIUAWordPackLot *lot = self.expiryOrder.firstObject;
+        if ([date compare:lot.expiryDate] == NSOrderedAscending) {
+            break;
+        }
+        [self.expiryOrder removeObjectAtIndex:0];
+        [self removeLot:lot from:self.purchaseOrder comparator:[self purchaseComparator]];
+        if (lot.remainingWords > 0) {
+            [self removeLot:lot from:self.consumeOrder comparator:[self consumeComparator]];
+            self.remainingWords -= lot.remainingWords;
+        }
+        if (!removed) {
+            removed = [NSMutableArray array];
+        }
+        [removed addObject:[lot.record copy]];
+    }
+    return removed ?: @[];
+}
+
+- (NSInteger)consumeWords:(NSInteger)words {
+    return [self consumeWords:words usingBlock:nil];
+}
+
+- (NSInteger)consumeWords:(NSInteger)words usingBlock:(void (^)(NSDictionary *, NSInteger))block {
+    NSInteger remainingToConsume = words;
+    // 从消耗顺序的队首扣减，用完的记录出队（NSMutableArray 头部删除为常数时间）
+    while (remainingToConsume > 0 && self.consumeOrder.count > 0) {
+        AIUAWordPackLot *lot = self.consumeOrder.firstObject;
+        NSInteger consumeFromThis = MIN(remainingToConsume, lot.remainingWords);
+        lot.remainingWords -= consumeFromThis;
+        lot.record[@"remainingWords"] = @(lot.remainingWords);
+        remainingToConsume -= consumeFromThis;
+        if (block && consumeFromThis > 0) {
+            block(lot.record, consumeFromThis);
+        }
+        if (lot.remainingWords == 0) {
+            [self.consumeOrder removeObjectAtIndex:0];
+        }
+    }
+    NSInteger consumed = words - remainingToConsume;
+    self.remainingWords -= consumed;
+    return consumed;
+}
+
+- (NSDictionary<NSNumber *, NSNumber *> *)expiringWordsWithinDays:(NSInteger)days atDate:(NSDate *)date {
+    NSMutableDictionary<NSNumber *, NSNumber *> *expiringByDays = [NSMutableDictionary dictionary];
+    NSTimeInterval limit = days * kAIUAWordPackSecondsPerDay;
+    // 过期时间索引有序，遍历到超出范围即可停止
+    for (AIUAWordPackLot *lot in self.expiryOrder) {
+        NSTimeInterval timeInterval = [lot.expiryDate timeIntervalSinceDate:date];
+        if (timeInterval <= 0) {
+            continue; // 已过期但尚未移除
+        }
+        if (timeInterval > limit) {
+            break;
+        }
+        // 剩余天数向上取整，今天过期的算1天
+        NSNumber *daysKey = @((NSInteger)ceil(timeInterval / kAIUAWordPackSecondsPerDay));
+        expiringByDays[daysKey] = @([expiringByDays[daysKey] integerValue] + lot.remainingWords);
+    }
+    return [expiringByDays copy];
+}
+
+- (NSArray<NSDictionary *> *)purchaseRecords {
+    NSMutableArray<NSDictionary *> *records = [NSMutableArray arrayWithCapacity:self.purchaseOrder.count];
+    for (AIUAWordPackLot *lot in self.purchaseOrder) {
+        [records addObject:[lot.record copy]];
+    }
+    return [records copy];
+}
+
+@end
@@ -6,6 +6,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "AIUAWordPackLotStore.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -110,6 +111,12 @@ extern NSString * const AIUAWordConsumedNotification;
 
 #pragma mark - 字数消耗
 
+/**
+ * 购买字数包的消耗顺序，默认先购买的先消耗（AIUAWordPackConsumePolicyPurchaseDate）
+ * VIP赠送字数始终优先消耗
+ */
+@property (nonatomic, assign) AIUAWordPackConsumePolicy consumePolicy;
+
 /**
  * 消耗字数
  * @param words 要消耗的字数
@@ -131,6 +138,15 @@ extern NSString * const AIUAWordConsumedNotification;
  */
 + (NSInteger)countWordsInText:(NSString *)text;
 
+#pragma mark - 持久化
+
+/**
+ * 立即将内存账本中未写回的修改保存到Keychain并同步到iCloud
+ * 字数消耗只修改内存账本并延迟约1秒批量写回；购买、奖励、VIP赠送等入账会立即写回
+ * App 退到后台或即将终止时会自动调用
+ */
+- (void)flushPendingChanges;
+
 #pragma mark - iCloud同步
 
 /**
@@ -13,6 +13,8 @@
 #import "AIUAToolsManager.h"
 #import "AIUAMacros.h"
 #import "AIUAConfigID.h"
+#import "AIUAWordCounter.h"
+#import "AIUAWordPackLedger.h"
 #import <UIKit/UIKit.h>
 
 // 通知名称
@@ -20,15 +22,13 @@ NSString * const AIUAWordPackPurchasedNotification = @"AIUAWordPackPurchasedNoti
 NSString * const AIUAWordConsumedNotification = @"AIUAWordConsumedNotification";
 
 // 本地存储Key
-static NSString * const kAIUAVIPGiftedWords = @"kAIUAVIPGiftedWords";
 static NSString * const kAIUAVIPGiftedWordsLastRefreshDate = @"kAIUAVIPGiftedWordsLastRefreshDate"; // 已废弃，保留用于兼容
-static NSString * const kAIUAVIPGiftAwarded = @"kAIUAVIPGiftAwarded"; // 标记是否已赠送过一次性50万字
 static NSString * const kAIUAPurchasedWords = @"kAIUAPurchasedWords";
-static NSString * const kAIUAConsumedWords = @"kAIUAConsumedWords";
-static NSString * const kAIUAWordPackPurchases = @"kAIUAWordPackPurchases";
+static NSString * const kAIUAWordPackDeviceID = @"kAIUAWordPackDeviceID";
 
 // iCloud Keys
-static NSString * const kAIUAiCloudWordPackDataPrefix = @"AIUAWordPackData";
+static NSString * const kAIUAiCloudWordPackDataPrefix = @"AIUAWordPackData"; // 旧版本的整份快照，只读取用于迁移
+static NSString * const kAIUAiCloudDeviceEntryInfix = @"device";             // 各设备条目：AIUAWordPackData.<命名空间>.device.<设备id>
 
 // VIP赠送字数常量
 static const NSInteger kVIPOneTimeGiftWords = 500000; // 订阅后一次性赠送50万字
@@ -45,6 +45,16 @@ static NSString * kProductIDWordPack6M = nil;
 @property (nonatomic, strong) AIUAKeychainManager *keychainManager;
 @property (nonatomic, copy) NSString *storageNamespace;
 
+// 内存账本，只能在 performLedgerBlock: 内读写
+@property (nonatomic, strong) AIUAWordPackLedger *ledger;
+
+@end
+
+// Keychain 作为账本的持久化存储
+@interface AIUAKeychainManager (AIUAWordPackLedgerStorage) <AIUAWordPackLedgerStorage>
+@end
+
+@implementation AIUAKeychainManager (AIUAWordPackLedgerStorage)
 @end
 
 @implementation AIUAWordPackManager
@@ -68,6 +78,18 @@ static NSString * kProductIDWordPack6M = nil;
         _keychainManager = [AIUAKeychainManager sharedManager];
         _storageNamespace = [self currentStoreEnvironmentTag];
         NSLog(@"[WordPack] 存储命名空间: %@", _storageNamespace);
+        __weak typeof(self) wself = self;
+        _ledger = [[AIUAWordPackLedger alloc] initWithStorage:_keychainManager
+                                                    giftWords:kVIPOneTimeGiftWords
+                                             deviceIDProvider:^NSString *{
+            return [wself deviceIdentifier];
+        }];
+        _ledger.uploadHandler = ^{
+            __strong typeof(wself) sself = wself;
+            if (sself.iCloudSyncEnabled) {
+                [sself uploadLedgerToiCloudLocked];
+            }
+        };
 
         // 移除危险的兜底重置逻辑
         // 原因：初始化时VIP状态可能还未加载完成，错误地清除赠送字数会导致用户损失
@@ -76,7 +98,12 @@ static NSString * kProductIDWordPack6M = nil;
                                                  selector:@selector(subscriptionStatusChanged:)
                                                      name:@"AIUASubscriptionStatusChanged"
                                                    object:nil];
-        
+
+        // 退到后台/即将终止时立即写回未落盘的账本，避免被系统回收时丢失
+        [_ledger flushOnNotificationsNamed:@[UIApplicationWillResignActiveNotification,
+                                             UIApplicationDidEnterBackgroundNotification,
+                                             UIApplicationWillTerminateNotification]];
+
         // 启动时清除已过期的购买记录
         [self cleanExpiredPurchases];
     }
@@ -113,6 +140,10 @@ static NSString * kProductIDWordPack6M = nil;
 
 - (NSString *)scopedKey:(NSString *)key {
     NSString *ns = [self activeStorageNamespace];
+    return [self scopedKey:key namespace:ns];
+}
+
+- (NSString *)scopedKey:(NSString *)key namespace:(NSString *)ns {
     return [NSString stringWithFormat:@"%@.%@", key, ns];
 }
 
@@ -121,6 +152,24 @@ static NSString * kProductIDWordPack6M = nil;
     return [NSString stringWithFormat:@"%@.%@", kAIUAiCloudWordPackDataPrefix, ns];
 }
 
+- (NSString *)iCloudDeviceEntryPrefixForNamespace:(NSString *)ns {
+    return [NSString stringWithFormat:@"%@.%@.%@.", kAIUAiCloudWordPackDataPrefix, ns, kAIUAiCloudDeviceEntryInfix];
+}
+
+// 本设备 id：优先使用 identifierForVendor（不随备份恢复到其他设备），取不到时使用保存的随机 id
+- (NSString *)deviceIdentifier {
+    NSString *vendorID = [UIDevice currentDevice].identifierForVendor.UUIDString;
+    if (vendorID.length > 0) {
+        return vendorID;
+    }
+    NSString *storedID = [self.keychainManager stringForKey:kAIUAWordPackDeviceID];
+    if (storedID.length == 0) {
+        storedID = [NSUUID UUID].UUIDString;
+        [self.keychainManager setString:storedID forKey:kAIUAWordPackDeviceID];
+    }
+    return storedID;
+}
+
 - (NSString *)activeStorageNamespace {
     NSString *latest = [self currentStoreEnvironmentTag];
     if (latest.length == 0) {
@@ -133,28 +182,34 @@ static NSString * kProductIDWordPack6M = nil;
     return self.storageNamespace;
 }
 
-- (void)setLocalInteger:(NSInteger)value forKey:(NSString *)key {
-    [self.keychainManager setInteger:value forKey:[self scopedKey:key]];
+- (void)setLocalObject:(id)object forKey:(NSString *)key {
+    [self.keychainManager setObject:object forKey:[self scopedKey:key]];
 }
 
-- (NSInteger)localIntegerForKey:(NSString *)key {
-    return [self.keychainManager integerForKey:[self scopedKey:key]];
+- (id)localObjectForKey:(NSString *)key {
+    return [self.keychainManager objectForKey:[self scopedKey:key]];
 }
 
-- (void)setLocalBool:(BOOL)value forKey:(NSString *)key {
-    [self.keychainManager setInteger:value ? 1 : 0 forKey:[self scopedKey:key]];
+#pragma mark - 内存账本
+
+// 在账本队列上同步执行；已在队列上时直接执行，避免重入死锁
+- (void)performLedgerBlock:(void (^)(void))block {
+    [self.ledger performBlock:block];
 }
 
-- (BOOL)localBoolForKey:(NSString *)key {
-    return [self.keychainManager integerForKey:[self scopedKey:key]] != 0;
+// 以下 *Locked 方法只能在 performLedgerBlock: 内调用
+
+- (void)loadLedgerIfNeededLocked {
+    [self.ledger loadNamespaceIfNeededLocked:[self activeStorageNamespace]];
 }
 
-- (void)setLocalObject:(id)object forKey:(NSString *)key {
-    [self.keychainManager setObject:object forKey:[self scopedKey:key]];
+// 移除已过期的购买记录，返回移除条数
+- (NSInteger)removeExpiredPurchasesLocked {
+    return (NSInteger)[self.ledger removeExpiredPurchasesAtDateLocked:[NSDate date]].count;
 }
 
-- (id)localObjectForKey:(NSString *)key {
-    return [self.keychainManager objectForKey:[self scopedKey:key]];
+- (void)flushPendingChanges {
+    [self.ledger flush];
 }
 
 #pragma mark - 字数查询
@@ -168,31 +223,26 @@ static NSString * kProductIDWordPack6M = nil;
     }
     
     // 不再每日刷新，直接返回已赠送的字数
-    NSInteger giftedWords = [self localIntegerForKey:kAIUAVIPGiftedWords];
+    __block NSInteger giftedWords = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        giftedWords = self.ledger.giftedWords;
+    }];
     NSLog(@"[WordPack] VIP剩余赠送字数: %ld", (long)giftedWords);
     return MAX(0, giftedWords);
 }
 
 - (NSInteger)purchasedWords {
-    // 先清除已过期的记录（避免数据积累）
-    [self cleanExpiredPurchases];
-    
-    // 遍历所有购买记录，计算未过期的字数
-    NSArray *purchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    if (!purchases) {
-        return 0;
-    }
-    
-    NSInteger totalWords = 0;
-    NSDate *now = [NSDate date];
-    
-    for (NSDictionary *purchase in purchases) {
-        NSDate *expiryDate = purchase[@"expiryDate"];
-        if (expiryDate && [now compare:expiryDate] == NSOrderedAscending) {
-            // 未过期
-            NSInteger remainingWords = [purchase[@"remainingWords"] integerValue];
-            totalWords += remainingWords;
-        }
+    // 先清除已过期的记录（避免数据积累），再计算未过期的字数
+    __block NSInteger expiredCount = 0;
+    __block NSInteger totalWords = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        expiredCount = [self removeExpiredPurchasesLocked];
+        totalWords = self.ledger.lots.remainingWords;
+    }];
+    if (expiredCount > 0) {
+        [self postExpiredPurchasesRemoved:expiredCount];
     }
     
     NSLog(@"[WordPack] 购买字数（未过期）: %ld", (long)totalWords);
@@ -206,7 +256,11 @@ static NSString * kProductIDWordPack6M = nil;
 }
 
 - (NSInteger)consumedWords {
-    NSInteger consumed = [self localIntegerForKey:kAIUAConsumedWords];
+    __block NSInteger consumed = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        consumed = self.ledger.consumedWords;
+    }];
     return consumed;
 }
 
@@ -217,39 +271,15 @@ static NSString * kProductIDWordPack6M = nil;
         return [self getTestExpiringWordsByDays];
     }
     
-    // 遍历所有购买记录，按天数分组计算7天内即将过期的字数
-    NSArray *purchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    if (!purchases) {
-        return @{};
-    }
-    
-    NSMutableDictionary<NSNumber *, NSNumber *> *expiringByDays = [NSMutableDictionary dictionary];
-    NSDate *now = [NSDate date];
-    
-    for (NSDictionary *purchase in purchases) {
-        NSDate *expiryDate = purchase[@"expiryDate"];
-        if (expiryDate) {
-            // 检查是否未过期
-            if ([now compare:expiryDate] == NSOrderedAscending) {
-                // 计算剩余天数（向上取整，确保今天过期的也算1天）
-                NSTimeInterval timeInterval = [expiryDate timeIntervalSinceDate:now];
-                NSInteger daysRemaining = (NSInteger)ceil(timeInterval / (24 * 60 * 60));
-                
-                // 只处理1-7天内的（不包括今天，今天过期的算1天）
-                if (daysRemaining >= 1 && daysRemaining <= 7) {
-                    NSInteger remainingWords = [purchase[@"remainingWords"] integerValue];
-                    NSNumber *daysKey = @(daysRemaining);
-                    
-                    // 累加对应天数的字数
-                    NSInteger existingWords = [expiringByDays[daysKey] integerValue];
-                    expiringByDays[daysKey] = @(existingWords + remainingWords);
-                }
-            }
-        }
-    }
+    // 只遍历过期时间索引中7天内的前缀，按剩余天数（向上取整，今天过期的算1天）分组
+    __block NSDictionary<NSNumber *, NSNumber *> *expiringByDays = nil;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        expiringByDays = [self.ledger.lots expiringWordsWithinDays:7 atDate:[NSDate date]];
+    }];
     
     NSLog(@"[WordPack] 按天数分组的即将过期字数: %@", expiringByDays);
-    return [expiringByDays copy];
+    return expiringByDays;
 }
 
 #pragma mark - 测试数据
@@ -280,49 +310,24 @@ static NSString * kProductIDWordPack6M = nil;
 #pragma mark - 清除过期记录
 
 - (void)cleanExpiredPurchases {
-    NSArray *existingPurchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    if (!existingPurchases || existingPurchases.count == 0) {
-        return;
-    }
-    
-    NSMutableArray *validPurchases = [NSMutableArray array];
-    NSDate *now = [NSDate date];
-    NSInteger expiredCount = 0;
-    
-    for (NSDictionary *purchase in existingPurchases) {
-        NSDate *expiryDate = purchase[@"expiryDate"];
-        if (expiryDate && [now compare:expiryDate] == NSOrderedAscending) {
-            // 未过期，保留
-            [validPurchases addObject:purchase];
-        } else {
-            // 已过期，清除
-            expiredCount++;
-            NSInteger expiredWords = [purchase[@"remainingWords"] integerValue];
-            if (expiredWords > 0) {
-                NSLog(@"[WordPack] 清除过期记录: %@ 字，过期时间: %@", @(expiredWords), expiryDate);
-            }
-        }
-    }
-    
+    __block NSInteger expiredCount = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        expiredCount = [self removeExpiredPurchasesLocked];
+    }];
     if (expiredCount > 0) {
-        // 保存清理后的记录
-        [self setLocalObject:[validPurchases copy] forKey:kAIUAWordPackPurchases];
-        
-        // 同步到iCloud
-        if (self.iCloudSyncEnabled) {
-            [self syncToiCloud];
-        }
-        
-        NSLog(@"[WordPack] ✓ 已清除 %ld 条过期购买记录，剩余 %ld 条有效记录", 
-              (long)expiredCount, (long)validPurchases.count);
-        
-        // 发送通知，通知UI更新
-        [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification
-                                                            object:nil
-                                                          userInfo:nil];
+        [self postExpiredPurchasesRemoved:expiredCount];
     }
 }
 
+- (void)postExpiredPurchasesRemoved:(NSInteger)expiredCount {
+    NSLog(@"[WordPack] ✓ 已清除 %ld 条过期购买记录", (long)expiredCount);
+    
+    // 发送通知，通知UI更新
+    [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification
+                                                        object:nil
+                                                      userInfo:nil];
+}
 #pragma mark - 字数包购买
 
 - (void)purchaseWordPack:(AIUAWordPackType)type
@@ -339,13 +344,9 @@ static NSString * kProductIDWordPack6M = nil;
             NSLog(@"[WordPack] 购买成功，添加 %ld 字", (long)words);
             
             // 添加购买记录
+            // 添加购买记录（立即写回Keychain，并同步到iCloud）
             [self addPurchaseRecord:words forProductID:productID];
             
-            // 同步到iCloud
-            if (self.iCloudSyncEnabled) {
-                [self syncToiCloud];
-            }
-            
             // 发送通知
             [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification
                                                                 object:nil
@@ -379,14 +380,12 @@ static NSString * kProductIDWordPack6M = nil;
 }
 
 - (void)addPurchaseRecord:(NSInteger)words forProductID:(NSString *)productID {
-    NSArray *existingPurchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    NSMutableArray *purchases = existingPurchases ? [existingPurchases mutableCopy] : [NSMutableArray array];
-    
     // 创建购买记录
     NSDate *now = [NSDate date];
     NSDate *expiryDate = [now dateByAddingTimeInterval:90 * 24 * 60 * 60]; // 90天后过期
     
     NSDictionary *purchase = @{
+        @"lotID": [NSUUID UUID].UUIDString,
         @"productID": productID,
         @"words": @(words),
         @"remainingWords": @(words),
@@ -394,10 +393,13 @@ static NSString * kProductIDWordPack6M = nil;
         @"expiryDate": expiryDate
     };
     
-    [purchases addObject:purchase];
-    
-    // 保存到Keychain
-    [self setLocalObject:purchases forKey:kAIUAWordPackPurchases];
+    // 保存到Keychain（付费入账不走延迟写回）
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        [self.ledger.lots addPurchaseRecord:purchase];
+        [self.ledger.syncState addLot:purchase];
+        [self.ledger markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerPurchasesKey] immediately:YES];
+    }];
     
     NSLog(@"[WordPack] 购买记录已保存: %@ 字，过期时间: %@", @(words), expiryDate);
 }
@@ -409,27 +411,28 @@ static NSString * kProductIDWordPack6M = nil;
         if (completion) completion();
         return;
     }
-    NSArray *existingPurchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    NSMutableArray *purchases = existingPurchases ? [existingPurchases mutableCopy] : [NSMutableArray array];
     NSDate *now = [NSDate date];
     NSDate *expiryDate = [now dateByAddingTimeInterval:MAX(1, days) * 24 * 60 * 60];
     NSDictionary *purchase = @{
+        @"lotID": [NSUUID UUID].UUIDString,
         @"productID": @"reward.bonus",
         @"words": @(words),
         @"remainingWords": @(words),
         @"purchaseDate": now,
         @"expiryDate": expiryDate
     };
-    [purchases addObject:purchase];
-    [self setLocalObject:purchases forKey:kAIUAWordPackPurchases];
-
-    // iCloud 同步
-    if (self.iCloudSyncEnabled) {
-        [self syncToiCloud];
-    }
+    // 立即写回Keychain并同步到iCloud
+    __block NSUInteger purchaseCount = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        [self.ledger.lots addPurchaseRecord:purchase];
+        [self.ledger.syncState addLot:purchase];
+        [self.ledger markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerPurchasesKey] immediately:YES];
+        purchaseCount = self.ledger.lots.count;
+    }];
     // 通知刷新
     [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification object:nil userInfo:@{ @"words": @(words) }];
-    NSLog(@"[WordPack] 奖励入账: %ld 字，当前记录数: %lu", (long)words, (unsigned long)purchases.count);
+    NSLog(@"[WordPack] 奖励入账: %ld 字，当前记录数: %lu", (long)words, (unsigned long)purchaseCount);
     if (completion) completion();
 }
 
@@ -501,41 +504,63 @@ static NSString * kProductIDWordPack6M = nil;
     
     NSLog(@"[WordPack] 刷新VIP赠送字数 - 当前VIP状态: %@", isVIP ? @"是" : @"否");
     
-    if (isVIP) {
-        // 检查是否已经赠送过一次性50万字
-        BOOL hasAwarded = [self localBoolForKey:kAIUAVIPGiftAwarded];
-        NSLog(@"[WordPack] 是否已赠送过: %@", hasAwarded ? @"是" : @"否");
-        
-        if (!hasAwarded) {
-            // 首次订阅，一次性赠送50万字
-            NSLog(@"[WordPack] ✓ 检测到新VIP用户，一次性赠送 %ld 字", (long)kVIPOneTimeGiftWords);
-            [self setLocalInteger:kVIPOneTimeGiftWords forKey:kAIUAVIPGiftedWords];
-            [self setLocalBool:YES forKey:kAIUAVIPGiftAwarded];
+    __block BOOL didAward = NO;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        if (isVIP) {
+            // 检查是否已经赠送过一次性50万字
+            BOOL hasAwarded = self.ledger.giftAwarded;
+            NSLog(@"[WordPack] 是否已赠送过: %@", hasAwarded ? @"是" : @"否");
             
-            // 同步到iCloud
-            if (self.iCloudSyncEnabled) {
-                [self syncToiCloud];
+            if (!hasAwarded) {
+                // 首次订阅，一次性赠送50万字（立即写回Keychain并同步到iCloud）
+                NSLog(@"[WordPack] ✓ 检测到新VIP用户，一次性赠送 %ld 字", (long)kVIPOneTimeGiftWords);
+                [self.ledger.syncState awardGiftWords:kVIPOneTimeGiftWords atDate:[NSDate date]];
+                self.ledger.giftedWords = self.ledger.syncState.giftedWords;
+                self.ledger.giftAwarded = YES;
+                [self.ledger markDirtyLocked:@[AIUAWordPackLedgerGiftedWordsKey, AIUAWordPackLedgerSyncEntriesKey,
+                                               AIUAWordPackLedgerGiftAwardedKey] immediately:YES];
+                didAward = YES;
+            } else {
+                NSLog(@"[WordPack] VIP用户已赠送过一次性字数，当前剩余: %ld", (long)self.ledger.giftedWords);
             }
-            
-            // 发送通知
-            [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification 
-                                                                object:nil 
-                                                              userInfo:@{ @"words": @(kVIPOneTimeGiftWords) }];
-            
-            NSLog(@"[WordPack] ✓ 赠送字数已发放并保存");
         } else {
-            NSInteger currentWords = [self localIntegerForKey:kAIUAVIPGiftedWords];
-            NSLog(@"[WordPack] VIP用户已赠送过一次性字数，当前剩余: %ld", (long)currentWords);
+            NSLog(@"[WordPack] 用户不是VIP，无赠送字数");
+            // 清除赠送字数，但保留已赠送标记（防止用户退订后重新订阅时重复赠送）
+            if (self.ledger.giftedWords != 0) {
+                self.ledger.giftedWords = 0;
+                [self.ledger.syncState forfeitGiftWords];
+                [self.ledger markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey, AIUAWordPackLedgerGiftedWordsKey] immediately:YES];
+            }
         }
-    } else {
-        NSLog(@"[WordPack] 用户不是VIP，无赠送字数");
-        // 清除赠送字数，但保留已赠送标记（防止用户退订后重新订阅时重复赠送）
-        [self setLocalInteger:0 forKey:kAIUAVIPGiftedWords];
+    }];
+    
+    if (didAward) {
+        // 发送通知
+        [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification 
+                                                            object:nil 
+                                                          userInfo:@{ @"words": @(kVIPOneTimeGiftWords) }];
+        
+        NSLog(@"[WordPack] ✓ 赠送字数已发放并保存");
     }
 }
 
 #pragma mark - 字数消耗
 
+- (AIUAWordPackConsumePolicy)consumePolicy {
+    __block AIUAWordPackConsumePolicy policy = AIUAWordPackConsumePolicyPurchaseDate;
+    [self performLedgerBlock:^{
+        policy = self.ledger.lots.policy;
+    }];
+    return policy;
+}
+
+- (void)setConsumePolicy:(AIUAWordPackConsumePolicy)consumePolicy {
+    [self performLedgerBlock:^{
+        self.ledger.lots.policy = consumePolicy;
+    }];
+}
+
 - (void)consumeWords:(NSInteger)words completion:(void (^)(BOOL, NSInteger))completion {
     NSLog(@"[WordPack] 尝试消耗 %ld 字", (long)words);
 
@@ -571,112 +596,59 @@ static NSString * kProductIDWordPack6M = nil;
         }
     }
     
-    // 检查是否有足够字数
-    if (![self hasEnoughWords:words]) {
+    // 检查余额与扣减在同一个账本任务中完成，并发消耗不会超扣
+    __block BOOL success = NO;
+    __block NSInteger remainingWords = 0;
+    __block NSInteger expiredCount = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        expiredCount = [self removeExpiredPurchasesLocked];
+        // 会员已在上面提前返回，这里只从购买/奖励的字数包中扣减（VIP 赠送字数只在会员有效期内可用）
+        NSInteger remaining = 0;
+        success = [self.ledger consumeWordsLocked:words remainingWords:&remaining];
+        remainingWords = remaining;
+    }];
+    
+    if (expiredCount > 0) {
+        [self postExpiredPurchasesRemoved:expiredCount];
+    }
+    if (!success) {
         NSLog(@"[WordPack] ❌ 字数不足");
         if (completion) {
             dispatch_async(dispatch_get_main_queue(), ^{
-                completion(NO, [self totalAvailableWords]);
+                completion(NO, remainingWords);
             });
         }
         return;
     }
     
-    NSInteger remainingToConsume = words;
-    
-    // 1. 优先消耗VIP赠送字数
-    NSInteger vipWords = [self vipGiftedWords];
-    if (vipWords > 0) {
-        NSInteger consumeFromVIP = MIN(remainingToConsume, vipWords);
-        NSInteger newVIPWords = vipWords - consumeFromVIP;
-        
-        [self setLocalInteger:newVIPWords forKey:kAIUAVIPGiftedWords];
-        remainingToConsume -= consumeFromVIP;
-        
-        NSLog(@"[WordPack] 从VIP赠送消耗 %ld 字，剩余 %ld 字", (long)consumeFromVIP, (long)newVIPWords);
-    }
-    
-    // 2. 如果还需要消耗，则从购买的字数包中消耗
-    if (remainingToConsume > 0) {
-        [self consumeFromPurchasedPacks:remainingToConsume];
-    }
-    
-    // 3. 记录消耗统计
+    // 记录消耗统计
     [self recordConsumption:words];
     
     if (completion) {
         dispatch_async(dispatch_get_main_queue(), ^{
-            completion(YES, [self totalAvailableWords]);
+            completion(YES, remainingWords);
         });
     }
 }
 
 // 记录字数消耗统计（不实际扣除字数，仅用于统计）
 - (void)recordConsumption:(NSInteger)words {
-    // 更新总消耗字数
-    NSInteger totalConsumed = [self localIntegerForKey:kAIUAConsumedWords];
-    totalConsumed += words;
-    [self setLocalInteger:totalConsumed forKey:kAIUAConsumedWords];
+    // 更新总消耗字数（延迟批量写回Keychain/iCloud）
+    __block NSInteger totalConsumed = 0;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        totalConsumed = [self.ledger recordConsumedWordsLocked:words];
+    }];
     
     NSLog(@"[WordPack] ✓ 记录消耗统计: %ld 字，累计消耗: %ld 字", (long)words, (long)totalConsumed);
     
-    // 同步到iCloud
-    if (self.iCloudSyncEnabled) {
-        [self syncToiCloud];
-    }
-    
     // 发送通知
     [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordConsumedNotification
                                                         object:nil
                                                       userInfo:@{@"words": @(words)}];
 }
 
-- (void)consumeFromPurchasedPacks:(NSInteger)words {
-    NSArray *existingPurchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    if (!existingPurchases || existingPurchases.count == 0) {
-        return;
-    }
-    
-    // 创建可变数组，并将每个字典转换为可变字典
-    NSMutableArray *purchases = [NSMutableArray array];
-    for (NSDictionary *purchase in existingPurchases) {
-        [purchases addObject:[purchase mutableCopy]];
-    }
-    
-    NSInteger remainingToConsume = words;
-    NSDate *now = [NSDate date];
-    
-    // 按购买时间排序（先购买的先消耗）
-    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"purchaseDate" ascending:YES];
-    [purchases sortUsingDescriptors:@[sortDescriptor]];
-    
-    for (NSMutableDictionary *purchase in purchases) {
-        if (remainingToConsume <= 0) {
-            break;
-        }
-        
-        // 检查是否过期
-        NSDate *expiryDate = purchase[@"expiryDate"];
-        if ([now compare:expiryDate] == NSOrderedDescending) {
-            continue; // 已过期，跳过
-        }
-        
-        NSInteger remainingWords = [purchase[@"remainingWords"] integerValue];
-        if (remainingWords > 0) {
-            NSInteger consumeFromThis = MIN(remainingToConsume, remainingWords);
-            NSInteger newRemaining = remainingWords - consumeFromThis;
-            
-            purchase[@"remainingWords"] = @(newRemaining);
-            remainingToConsume -= consumeFromThis;
-            
-            NSLog(@"[WordPack] 从购买字数包消耗 %ld 字，剩余 %ld 字", (long)consumeFromThis, (long)newRemaining);
-        }
-    }
-    
-    // 保存更新后的购买记录到Keychain（转换为不可变数组）
-    [self setLocalObject:[purchases copy] forKey:kAIUAWordPackPurchases];
-}
-
 - (BOOL)hasEnoughWords:(NSInteger)words {
     // 订阅会员在有效期内不限字数
     if ([[AIUAIAPManager sharedManager] isVIPMember]) {
@@ -716,17 +688,10 @@ static NSString * kProductIDWordPack6M = nil;
     // 对于大多数字符（包括中文、英文、数字、标点、空格），每个字符占用1个UTF-16代码单元
     // 对于emoji等特殊字符，可能占用2个UTF-16代码单元，但按照规则也应该计为1字
     
-    // 为了准确统计，我们需要遍历字符串并统计实际的字符数量（而不是UTF-16代码单元）
-    // 使用enumerateSubstringsInRange:options:usingBlock:来正确处理所有Unicode字符
-    __block NSInteger count = 0;
-    [text enumerateSubstringsInRange:NSMakeRange(0, text.length)
-                             options:NSStringEnumerationByComposedCharacterSequences
-                          usingBlock:^(NSString * _Nullable substring, NSRange substringRange, NSRange enclosingRange, BOOL * _Nonnull stop) {
-        // 每个composed character sequence（包括emoji）计为1字
-        count++;
-    }];
-    
-    return count;
+    // 为了准确统计，我们需要统计实际的字符数量（而不是UTF-16代码单元）
+    // 每个composed character sequence（包括emoji）计为1字；AIUAWordCounter 与逐个枚举字符簇的结果一致，
+    // 但只在组合符号、表情序列等附近才按字符簇规则计算，不再为每个字符创建 NSString
+    return [AIUAWordCounter countWordsInText:text];
 }
 
 #pragma mark - iCloud同步
@@ -870,48 +835,85 @@ static NSString * kProductIDWordPack6M = nil;
 }
 
 - (void)iCloudStoreDidChange:(NSNotification *)notification {
-    NSLog(@"[WordPack] iCloud数据发生变化，同步到本地");
-    [self syncFromiCloud];
+    NSArray<NSString *> *changedKeys = notification.userInfo[NSUbiquitousKeyValueStoreChangedKeysKey];
+    NSLog(@"[WordPack] iCloud数据发生变化（%lu 个key），同步到本地", (unsigned long)changedKeys.count);
+    [self syncFromiCloudKeys:[changedKeys isKindOfClass:[NSArray class]] ? changedKeys : nil];
 }
 
 - (void)syncFromiCloud {
+    [self syncFromiCloudKeys:nil];
+}
+
+// 合并iCloud中的设备条目；keys 为变化的key，nil 表示全部
+- (void)syncFromiCloudKeys:(NSArray<NSString *> *)keys {
     if (!self.iCloudSyncEnabled) {
         return;
     }
     
     NSLog(@"[WordPack] 从iCloud同步数据");
     
-    NSDictionary *iCloudData = [self.iCloudStore dictionaryForKey:[self scopediCloudWordPackKey]];
-    if (!iCloudData) {
-        NSLog(@"[WordPack] iCloud中没有数据");
-        return;
-    }
-    
-    // 同步VIP赠送字数
-    if (iCloudData[@"vipGiftedWords"]) {
-        [self setLocalInteger:[iCloudData[@"vipGiftedWords"] integerValue] forKey:kAIUAVIPGiftedWords];
+    NSString *legacyKey = [self scopediCloudWordPackKey];
+    NSString *devicePrefix = [self iCloudDeviceEntryPrefixForNamespace:[self activeStorageNamespace]];
+    if (!keys) {
+        keys = self.iCloudStore.dictionaryRepresentation.allKeys;
+    }
+    NSDictionary *legacyData = nil;
+    NSMutableDictionary<NSString *, NSDictionary *> *deviceEntries = [NSMutableDictionary dictionary];
+    for (NSString *key in keys) {
+        if ([key isEqualToString:legacyKey]) {
+            legacyData = [self.iCloudStore dictionaryForKey:key];
+        } else if ([key hasPrefix:devicePrefix] && key.length > devicePrefix.length) {
+            NSDictionary *entry = [self.iCloudStore dictionaryForKey:key];
+            if (entry) {
+                deviceEntries[[key substringFromIndex:devicePrefix.length]] = entry;
+            }
+        }
     }
-    
-    // 同步是否已赠送标记
-    if (iCloudData[@"vipGiftAwarded"] != nil) {
-        [self setLocalBool:[iCloudData[@"vipGiftAwarded"] boolValue] forKey:kAIUAVIPGiftAwarded];
+    if (!legacyData && deviceEntries.count == 0) {
+        NSLog(@"[WordPack] iCloud中没有需要合并的数据");
+        return;
     }
     
     // 同步上次刷新日期（保留兼容性，但不再使用）
-    if (iCloudData[@"vipGiftedWordsLastRefreshDate"]) {
-        [self setLocalObject:iCloudData[@"vipGiftedWordsLastRefreshDate"] forKey:kAIUAVIPGiftedWordsLastRefreshDate];
-    }
-    
-    // 同步购买记录
-    if (iCloudData[@"purchases"]) {
-        [self setLocalObject:iCloudData[@"purchases"] forKey:kAIUAWordPackPurchases];
-    }
+    if (legacyData[@"vipGiftedWordsLastRefreshDate"]) {
+        [self setLocalObject:legacyData[@"vipGiftedWordsLastRefreshDate"] forKey:kAIUAVIPGiftedWordsLastRefreshDate];
+    }
+    
+    // 逐个设备条目合并（与顺序无关、可重复合并），有变化时重建账本并写回Keychain
+    __block BOOL changed = NO;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        NSUInteger localVersion = self.ledger.syncState.localVersion;
+        if (legacyData) {
+            // 旧版本设备上传的整份快照，作为基线合并（已合并过的快照不会改变状态）
+            changed = [self.ledger.syncState mergeBaselineWithPurchases:[legacyData[@"purchases"] isKindOfClass:[NSArray class]] ? legacyData[@"purchases"] : nil
+                                                               giftWords:kVIPOneTimeGiftWords
+                                                      remainingGiftWords:[legacyData[@"vipGiftedWords"] integerValue]
+                                                             giftAwarded:[legacyData[@"vipGiftAwarded"] boolValue]
+                                                           consumedWords:[legacyData[@"consumedWords"] integerValue]];
+        }
+        for (NSString *deviceID in deviceEntries) {
+            changed |= [self.ledger.syncState mergeEntry:deviceEntries[deviceID] forDeviceID:deviceID];
+        }
+        if (!changed) {
+            return;
+        }
+        [self.ledger applySyncStateLocked];
+        [self.ledger addDirtyKeysLocked:@[AIUAWordPackLedgerGiftedWordsKey, AIUAWordPackLedgerGiftAwardedKey, AIUAWordPackLedgerConsumedWordsKey,
+                                          AIUAWordPackLedgerPurchasesKey, AIUAWordPackLedgerSyncEntriesKey]];
+        if (self.ledger.syncState.localVersion != localVersion) {
+            // 本设备条目也因合并而变化（如重装后取回云端的本设备条目），需要重新上传
+            [self.ledger markDirtyLocked:@[AIUAWordPackLedgerSyncEntriesKey] immediately:NO];
+        }
+        [self.ledger writeDirtyKeysLocked];
+    }];
     
-    // 同步消耗记录
-    if (iCloudData[@"consumedWords"]) {
-        [self setLocalInteger:[iCloudData[@"consumedWords"] integerValue] forKey:kAIUAConsumedWords];
+    if (changed) {
+        [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification
+                                                            object:nil
+                                                          userInfo:nil];
     }
-    NSLog(@"[WordPack] iCloud同步完成");
+    NSLog(@"[WordPack] iCloud同步完成（设备条目 %lu 个，%@）", (unsigned long)deviceEntries.count, changed ? @"有变化" : @"无变化");
 }
 
 - (void)syncToiCloud {
@@ -919,37 +921,51 @@ static NSString * kProductIDWordPack6M = nil;
         return;
     }
     
-    NSLog(@"[WordPack] 上传数据到iCloud");
-    
-    // 构建要上传的数据
-    NSMutableDictionary *data = [NSMutableDictionary dictionary];
-    
-    // VIP赠送字数（一次性）
-    data[@"vipGiftedWords"] = @([self localIntegerForKey:kAIUAVIPGiftedWords]);
-    
-    // VIP是否已赠送标记
-    data[@"vipGiftAwarded"] = @([self localBoolForKey:kAIUAVIPGiftAwarded]);
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        [self.ledger writeDirtyKeysLocked];
+        self.ledger.needsUpload = NO;
+        [self uploadLedgerToiCloudLocked];
+    }];
+}
 
-    // VIP赠送字数上次刷新日期（保留兼容性，但不再使用）
-    NSDate *lastRefreshDate = [self localObjectForKey:kAIUAVIPGiftedWordsLastRefreshDate];
-    if (lastRefreshDate) {
-        data[@"vipGiftedWordsLastRefreshDate"] = lastRefreshDate;
+// 只上传本设备条目，且只在版本变化时上传；其他设备的修改在各自的条目中，互不覆盖
+- (void)uploadLedgerToiCloudLocked {
+    NSString *ns = self.ledger.loadedNamespace;
+    AIUAWordPackSyncState *syncState = self.ledger.syncState;
+    if (!ns || !syncState) {
+        return;
     }
-    
-    // 购买记录
-    NSArray *purchases = [self localObjectForKey:kAIUAWordPackPurchases];
-    if (purchases) {
-        data[@"purchases"] = purchases;
+    NSUInteger version = syncState.localVersion;
+    if (version == self.ledger.uploadedSyncVersion) {
+        return;
     }
     
-    // 消耗记录
-    data[@"consumedWords"] = @([self localIntegerForKey:kAIUAConsumedWords]);
-    
-    // 上传到iCloud
-    [self.iCloudStore setDictionary:data forKey:[self scopediCloudWordPackKey]];
+    // 上传到iCloud（账本切换命名空间时仍上传到账本所属的命名空间）
+    NSDictionary *entry = [syncState localEntry];
+    NSString *iCloudKey = [[self iCloudDeviceEntryPrefixForNamespace:ns] stringByAppendingString:syncState.deviceID];
+    [self.iCloudStore setDictionary:entry forKey:iCloudKey];
     [self.iCloudStore synchronize];
+    self.ledger.uploadedSyncVersion = version;
     
-    NSLog(@"[WordPack] iCloud上传完成");
+    NSData *encoded = [NSPropertyListSerialization dataWithPropertyList:entry
+                                                                 format:NSPropertyListBinaryFormat_v1_0
+                                                                options:0
+                                                                  error:nil];
+    NSLog(@"[WordPack] iCloud上传本设备条目 v%lu（%lu 字节）", (unsigned long)version, (unsigned long)encoded.length);
+}
+
+// 将 iCloud旧版快照/导入数据作为基线合并到同步状态并重建账本，标记脏（调用方负责落盘），只能在 performLedgerBlock: 内调用
+- (void)applyWordPackData:(NSDictionary *)data {
+    NSArray *purchases = [data[@"purchases"] isKindOfClass:[NSArray class]] ? data[@"purchases"] : nil;
+    [self.ledger.syncState mergeBaselineWithPurchases:purchases
+                                            giftWords:kVIPOneTimeGiftWords
+                                   remainingGiftWords:[data[@"vipGiftedWords"] integerValue]
+                                          giftAwarded:[data[@"vipGiftAwarded"] boolValue]
+                                        consumedWords:[data[@"consumedWords"] integerValue]];
+    [self.ledger applySyncStateLocked];
+    [self.ledger addDirtyKeysLocked:@[AIUAWordPackLedgerGiftedWordsKey, AIUAWordPackLedgerGiftAwardedKey, AIUAWordPackLedgerConsumedWordsKey,
+                                      AIUAWordPackLedgerPurchasesKey, AIUAWordPackLedgerSyncEntriesKey]];
 }
 
 #pragma mark - 数据导出/导入（iCloud不可用时的替代方案）
@@ -959,12 +975,21 @@ static NSString * kProductIDWordPack6M = nil;
     
     // 构建要导出的数据
     NSMutableDictionary *data = [NSMutableDictionary dictionary];
-    
-    // VIP赠送字数
-    data[@"vipGiftedWords"] = @([self localIntegerForKey:kAIUAVIPGiftedWords]);
-    
-    // VIP是否已赠送标记
-    data[@"vipGiftAwarded"] = @([self localBoolForKey:kAIUAVIPGiftAwarded]);
+    __block NSArray *purchases = nil;
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        
+        // VIP赠送字数
+        data[@"vipGiftedWords"] = @(self.ledger.giftedWords);
+        
+        // VIP是否已赠送标记
+        data[@"vipGiftAwarded"] = @(self.ledger.giftAwarded);
+        
+        // 消耗记录
+        data[@"consumedWords"] = @(self.ledger.consumedWords);
+        
+        purchases = [self.ledger.lots purchaseRecords];
+    }];
     
     // VIP赠送字数上次刷新日期（保留兼容性，但不再使用）
     NSDate *lastRefreshDate = [self localObjectForKey:kAIUAVIPGiftedWordsLastRefreshDate];
@@ -973,7 +998,6 @@ static NSString * kProductIDWordPack6M = nil;
     }
     
     // 购买记录
-    NSArray *purchases = [self localObjectForKey:kAIUAWordPackPurchases];
     if (purchases) {
         // 将NSDate转换为时间戳，以便JSON序列化
         NSMutableArray *purchasesJSON = [NSMutableArray array];
@@ -992,9 +1016,6 @@ static NSString * kProductIDWordPack6M = nil;
         data[@"purchases"] = purchasesJSON;
     }
     
-    // 消耗记录
-    data[@"consumedWords"] = @([self localIntegerForKey:kAIUAConsumedWords]);
-    
     // 添加版本号和导出时间
     data[@"version"] = @1;
     data[@"exportTime"] = @([[NSDate date] timeIntervalSince1970]);
@@ -1052,16 +1073,6 @@ static NSString * kProductIDWordPack6M = nil;
         return;
     }
     
-    // 导入VIP赠送字数
-    if (data[@"vipGiftedWords"]) {
-        [self setLocalInteger:[data[@"vipGiftedWords"] integerValue] forKey:kAIUAVIPGiftedWords];
-    }
-    
-    // 导入VIP是否已赠送标记
-    if (data[@"vipGiftAwarded"] != nil) {
-        [self setLocalBool:[data[@"vipGiftAwarded"] boolValue] forKey:kAIUAVIPGiftAwarded];
-    }
-    
     // 导入VIP赠送字数上次刷新日期（保留兼容性，但不再使用）
     if (data[@"vipGiftedWordsLastRefreshDate"]) {
         NSTimeInterval timestamp = [data[@"vipGiftedWordsLastRefreshDate"] doubleValue];
@@ -1069,6 +1080,8 @@ static NSString * kProductIDWordPack6M = nil;
         [self setLocalObject:lastRefreshDate forKey:kAIUAVIPGiftedWordsLastRefreshDate];
     }
     
+    NSMutableDictionary *ledgerData = [data mutableCopy];
+    
     // 导入购买记录
     if (data[@"purchases"]) {
         NSArray *purchasesJSON = data[@"purchases"];
@@ -1090,21 +1103,23 @@ static NSString * kProductIDWordPack6M = nil;
             [purchases addObject:purchase];
         }
         
-        [self setLocalObject:purchases forKey:kAIUAWordPackPurchases];
-    }
-    
-    // 导入消耗记录
-    if (data[@"consumedWords"]) {
-        [self setLocalInteger:[data[@"consumedWords"] integerValue] forKey:kAIUAConsumedWords];
-    }
+        ledgerData[@"purchases"] = purchases;
+    }
+    
+    // 导入VIP赠送字数、已赠送标记、购买记录、消耗记录：写入账本后立即写回Keychain，iCloud可用时同步到iCloud
+    BOOL uploadToiCloud = self.iCloudSyncEnabled && [self isiCloudAvailable];
+    [self performLedgerBlock:^{
+        [self loadLedgerIfNeededLocked];
+        [self applyWordPackData:ledgerData];
+        [self.ledger writeDirtyKeysLocked];
+        self.ledger.needsUpload = NO;
+        if (uploadToiCloud) {
+            [self uploadLedgerToiCloudLocked];
+        }
+    }];
     
     NSLog(@"[WordPack] 导入成功");
     
-    // 如果iCloud可用，同步到iCloud
-    if (self.iCloudSyncEnabled && [self isiCloudAvailable]) {
-        [self syncToiCloud];
-    }
-    
     // 发送通知
     [[NSNotificationCenter defaultCenter] postNotificationName:AIUAWordPackPurchasedNotification
                                                         object:nil
@@ -1121,21 +1136,32 @@ static NSString * kProductIDWordPack6M = nil;
     NSLog(@"[WordPack] ⚠️ 开始清除所有字数包数据...");
     
     NSArray<NSString *> *allKeys = @[
-        kAIUAVIPGiftedWords,
-        kAIUAVIPGiftAwarded,
+        AIUAWordPackLedgerGiftedWordsKey,
+        AIUAWordPackLedgerGiftAwardedKey,
         kAIUAVIPGiftedWordsLastRefreshDate,
-        kAIUAWordPackPurchases,
+        AIUAWordPackLedgerPurchasesKey,
         kAIUAPurchasedWords,
-        kAIUAConsumedWords
+        AIUAWordPackLedgerConsumedWordsKey,
+        AIUAWordPackLedgerSyncEntriesKey
     ];
-    // 同时清理命名空间 key 与历史未隔离 key，避免旧数据残留
-    for (NSString *key in allKeys) {
-        [self.keychainManager removeObjectForKey:[self scopedKey:key]];
-        [self.keychainManager removeObjectForKey:key];
-    }
+    // 在账本队列上清理，丢弃尚未写回的修改，避免延迟写回把旧数据写回来
+    [self performLedgerBlock:^{
+        // 同时清理命名空间 key 与历史未隔离 key，避免旧数据残留
+        for (NSString *key in allKeys) {
+            [self.keychainManager removeObjectForKey:[self scopedKey:key]];
+            [self.keychainManager removeObjectForKey:key];
+        }
+        [self.ledger discardLocked];
+    }];
     
-    // 清除iCloud数据
+    // 清除iCloud数据（其他设备的条目仍在各自设备上，下次同步时会合并回来）
     if (self.iCloudSyncEnabled && [self isiCloudAvailable]) {
+        NSString *devicePrefix = [self iCloudDeviceEntryPrefixForNamespace:[self activeStorageNamespace]];
+        for (NSString *key in self.iCloudStore.dictionaryRepresentation.allKeys) {
+            if ([key hasPrefix:devicePrefix]) {
+                [self.iCloudStore removeObjectForKey:key];
+            }
+        }
         [self.iCloudStore removeObjectForKey:[self scopediCloudWordPackKey]];
         [self.iCloudStore synchronize];
         NSLog(@"[WordPack] 已清除iCloud字数包数据");
@@ -0,0 +1,112 @@
+//
+//  AIUAWordPackSyncState.h
+//  AIUniversalAssistant
+//
+//  字数包多设备同步状态（CRDT），账本余额由它合并后计算得出
+//  - 每台设备一个条目，只有该设备自己修改：创建的批次（购买/奖励/VIP赠送）、对每个批次的扣减计数、
+//    累计消耗计数，全部只增不减（G-Counter）；批次剩余 = 字数 - 各设备对该批次的扣减之和
+//  - 合并按设备逐项取最大值、批次取并集，与顺序无关且可重复合并（幂等），所有设备最终得到相同的余额
+//  - 过期批次的移除记为只增不减的移除记录（tombstone），合并时取并集，被移除的键不会因合并而复活
+//  - 各设备同时扣减同一批次导致超扣时，超出部分按消耗顺序从其他批次扣除，总余额始终等于 入账 - 消耗
+//  - 同步时只上传本设备条目（版本号变化时），只合并变化的远端条目
+//  - 旧版本的账本快照作为基线迁移：批次 id 由产品与购买时间确定，已扣减字数只补足各设备计数之外的部分并跨设备取最大值，多台设备重复迁移不会重复扣减
+//  - 条目只包含属性列表类型，可直接存入 Keychain 与 NSUbiquitousKeyValueStore
+//  - 非线程安全，由调用方串行访问
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLotStore.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// VIP 一次性赠送对应的批次 id（各设备相同，重复赠送合并为一次）
+extern NSString * const AIUAWordPackGiftLotID;
+
+@interface AIUAWordPackSyncState : NSObject
+
+/// 本设备 id
+@property (nonatomic, copy, readonly) NSString *deviceID;
+
+/// 本设备条目的版本号，每次本地修改加 1
+@property (nonatomic, assign, readonly) NSUInteger localVersion;
+
+/**
+ * @param deviceID 本设备 id
+ * @param entries 持久化的全部设备条目（entries 的返回值），nil 表示新建
+ */
+- (instancetype)initWithDeviceID:(NSString *)deviceID
+                         entries:(nullable NSDictionary<NSString *, NSDictionary *> *)entries NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// 全部设备条目（用于持久化）
+- (NSDictionary<NSString *, NSDictionary *> *)entries;
+
+/// 本设备条目（用于上传）
+- (NSDictionary *)localEntry;
+
+#pragma mark - 本地修改
+
+/// 新增批次，record 需包含 lotID/productID/words/purchaseDate/expiryDate
+- (void)addLot:(NSDictionary *)record;
+
+/// 记录从某批次扣减的字数
+- (void)recordWords:(NSInteger)words consumedFromLot:(NSString *)lotID;
+
+/// 累计消耗统计（包括会员、试用期间不扣余额的消耗）
+- (void)recordConsumedWords:(NSInteger)words;
+
+/// 发放 VIP 一次性赠送（已发放过时不重复）
+- (void)awardGiftWords:(NSInteger)words atDate:(NSDate *)date;
+
+/// 取消剩余的 VIP 赠送字数（退订后），之后不再恢复
+- (void)forfeitGiftWords;
+
+/**
+ * 以旧版本账本快照为基线合并（purchases 为旧格式记录，可不含 lotID）
+ * 快照中的已扣减字数与累计消耗只补足各设备计数之外的部分（跨设备取最大值），重复合并同一快照不改变结果
+ * @param giftWords VIP 一次性赠送的总字数
+ * @param remainingGiftWords 快照中剩余的赠送字数
+ * @return 合并后状态是否变化
+ */
+- (BOOL)mergeBaselineWithPurchases:(nullable NSArray<NSDictionary *> *)purchases
+                         giftWords:(NSInteger)giftWords
+                remainingGiftWords:(NSInteger)remainingGiftWords
+                       giftAwarded:(BOOL)giftAwarded
+                     consumedWords:(NSInteger)consumedWords;
+
+/**
+ * 从本设备条目中移除在 date 之前已过期的批次及其计数，并记入只增不减的移除记录
+ * 合并时移除记录取并集并优先于批次与计数，旧的本设备条目或其他设备的副本不会把它们加回来；
+ * 过期批次在读取时本就不计入余额，移除不改变任何设备看到的余额
+ * @return 本设备条目是否变化（需要落盘并上传）
+ */
+- (BOOL)pruneLotsExpiredBeforeDate:(NSDate *)date;
+
+#pragma mark - 合并
+
+/**
+ * 合并远端设备条目
+ * @return 合并后状态是否变化
+ */
+- (BOOL)mergeEntry:(NSDictionary *)entry forDeviceID:(NSString *)deviceID;
+
+#pragma mark - 余额
+
+/// date 时未过期的购买/奖励记录（含 lotID 与 remainingWords），用于重建 AIUAWordPackLotStore
+- (NSArray<NSDictionary *> *)purchaseRecordsAtDate:(NSDate *)date policy:(AIUAWordPackConsumePolicy)policy;
+
+/// 剩余 VIP 赠送字数
+- (NSInteger)giftedWords;
+
+/// 是否已发放过 VIP 赠送
+- (BOOL)giftAwarded;
+
+/// 全部设备的累计消耗
+- (NSInteger)consumedWords;
+
+/// 旧记录对应的批次 id（由产品与购买时间确定）
++ (NSString *)lotIDForLegacyRecord:(NSDictionary *)record;
+
+@end
+
+NS_ASSUME_NONNULL_END
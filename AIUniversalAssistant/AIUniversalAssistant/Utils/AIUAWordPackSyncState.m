@@ -0,0 +1,500 @@
+//
+//  AIUAWordPackSyncState.m
+//  AIUniversalAssistant
+//
+
+#import "AIUAWordPackSyncState.h"
+
+NSString * const AIUAWordPackGiftLotID = @"vip.gift";
+
+// 设备条目字段
+static NSString * const kAIUASyncVersion = @"v";
+static NSString * const kAIUASyncLots = @"lots";                 // lotID → 批次（productID/words/purchaseDate/expiryDate）
+static NSString * const kAIUASyncUsed = @"used";                 // lotID → 本设备扣减字数
+static NSString * const kAIUASyncConsumed = @"consumed";         // 本设备累计消耗
+static NSString * const kAIUASyncBaseUsed = @"baseUsed";         // lotID → 旧快照中的已扣减字数（跨设备取最大值）
+static NSString * const kAIUASyncBaseConsumed = @"baseConsumed"; // 旧快照中的累计消耗（跨设备取最大值）
+static NSString * const kAIUASyncGiftAwarded = @"giftAwarded";
+static NSString * const kAIUASyncGiftForfeited = @"giftForfeited";
+static NSString * const kAIUASyncPruned = @"pruned";             // lotID → YES，已过期并移除的批次（只增不减，合并取并集）
+
+static NSInteger AIUASyncInteger(id value) {
+    return [value isKindOfClass:[NSNumber class]] ? MAX(0, [value integerValue]) : 0;
+}
+
+static NSDate *AIUASyncDate(id value) {
+    return [value isKindOfClass:[NSDate class]] ? value : [NSDate distantPast];
+}
+
+// 计数只增不减：value 更大时更新，返回是否变化
+static BOOL AIUASyncRaiseCounter(NSMutableDictionary *counters, NSString *key, NSInteger value) {
+    if (value <= AIUASyncInteger(counters[key])) {
+        return NO;
+    }
+    counters[key] = @(value);
+    return YES;
+}
+
+@interface AIUAWordPackSyncState ()
+
+@property (nonatomic, copy, readwrite) NSString *deviceID;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableDictionary *> *mutableEntries;
+
+// 合并视图缓存，条目变化时失效
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSDictionary *> *cachedLots;
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *cachedUsed;
+
+@end
+
+@implementation AIUAWordPackSyncState
+
+- (instancetype)initWithDeviceID:(NSString *)deviceID entries:(NSDictionary<NSString *, NSDictionary *> *)entries {
+    self = [super init];
+    if (self) {
+        _deviceID = [deviceID copy];
+        _mutableEntries = [NSMutableDictionary dictionary];
+        if ([entries isKindOfClass:[NSDictionary class]]) {
+            [entries enumerateKeysAndObjectsUsingBlock:^(NSString *device, NSDictionary *entry, BOOL *stop) {
+                if ([device isKindOfClass:[NSString class]] && [entry isKindOfClass:[NSDictionary class]]) {
+                    [self mergeEntry:entry forDeviceID:device];
+                }
+            }];
+        }
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, NSDictionary *> *)entries {
+    NSMutableDictionary<NSString *, NSDictionary *> *entries = [NSMutableDictionary dictionaryWithCapacity:self.mutableEntries.count];
+    [self.mutableEntries enumerateKeysAndObjectsUsingBlock:^(NSString *device, NSMutableDictionary *entry, BOOL *stop) {
+        entries[device] = [self immutableEntry:entry];
+    }];
+    return [entries copy];
+}
+
+- (NSDictionary *)localEntry {
+    return [self immutableEntry:[self entryForDeviceID:self.deviceID]];
+}
+
+- (NSDictionary *)immutableEntry:(NSDictionary *)entry {
+    return (NSDictionary *)CFBridgingRelease(CFPropertyListCreateDeepCopy(kCFAllocatorDefault,
+                                                                          (__bridge CFPropertyListRef)entry,
+                                                                          kCFPropertyListImmutable));
+}
+
+- (NSUInteger)localVersion {
+    return (NSUInteger)AIUASyncInteger([self entryForDeviceID:self.deviceID][kAIUASyncVersion]);
+}
+
+- (NSMutableDictionary *)entryForDeviceID:(NSString *)deviceID {
+    NSMutableDictionary *entry = self.mutableEntries[deviceID];
+    if (!entry) {
+        entry = [@{kAIUASyncVersion: @0,
+                   kAIUASyncLots: [NSMutableDictionary dictionary],
+                   kAIUASyncUsed: [NSMutableDictionary dictionary],
+                   kAIUASyncBaseUsed: [NSMutableDictionary dictionary],
+                   kAIUASyncPruned: [NSMutableDictionary dictionary],
+                   kAIUASyncConsumed: @0,
+                   kAIUASyncBaseConsumed: @0} mutableCopy];
+        self.mutableEntries[deviceID] = entry;
+    }
+    return entry;
+}
+
+// 本设备条目修改后调用：版本号加 1，合并视图失效
+- (void)touchLocalEntry:(NSMutableDictionary *)entry {
+    entry[kAIUASyncVersion] = @(AIUASyncInteger(entry[kAIUASyncVersion]) + 1);
+    self.cachedLots = nil;
+    self.cachedUsed = nil;
+}
+
+#pragma mark - 本地修改
+
++ (NSDictionary *)lotFromRecord:(NSDictionary *)record {
+    NSMutableDictionary *lot = [NSMutableDictionary dictionaryWithCapacity:4];
+    lot[@"productID"] = [record[@"productID"] isKindOfClass:[NSString class]] ? record[@"productID"] : @"";
+    lot[@"words"] = @(AIUASyncInteger(record[@"words"]));
+    lot[@"purchaseDate"] = AIUASyncDate(record[@"purchaseDate"]);
+    lot[@"expiryDate"] = AIUASyncDate(record[@"expiryDate"]);
+    return [lot copy];
+}
+
+- (void)addLot:(NSDictionary *)record {
+    NSString *lotID = record[@"lotID"];
+    if (![lotID isKindOfClass:[NSString class]] || lotID.length == 0 || [self isLotPruned:lotID]) {
+        return;
+    }
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    entry[kAIUASyncLots][lotID] = [AIUAWordPackSyncState lotFromRecord:record];
+    [self touchLocalEntry:entry];
+}
+
+- (void)recordWords:(NSInteger)words consumedFromLot:(NSString *)lotID {
+    if (words <= 0 || lotID.length == 0 || [self isLotPruned:lotID]) {
+        return;
+    }
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    NSMutableDictionary *used = entry[kAIUASyncUsed];
+    used[lotID] = @(AIUASyncInteger(used[lotID]) + words);
+    [self touchLocalEntry:entry];
+}
+
+- (void)recordConsumedWords:(NSInteger)words {
+    if (words <= 0) {
+        return;
+    }
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    entry[kAIUASyncConsumed] = @(AIUASyncInteger(entry[kAIUASyncConsumed]) + words);
+    [self touchLocalEntry:entry];
+}
+
+- (void)awardGiftWords:(NSInteger)words atDate:(NSDate *)date {
+    if ([self giftAwarded]) {
+        return;
+    }
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    entry[kAIUASyncLots][AIUAWordPackGiftLotID] = @{@"productID": AIUAWordPackGiftLotID,
+                                                    @"words": @(MAX(0, words)),
+                                                    @"purchaseDate": date,
+                                                    @"expiryDate": [NSDate distantFuture]};
+    entry[kAIUASyncGiftAwarded] = @YES;
+    [self touchLocalEntry:entry];
+}
+
+- (void)forfeitGiftWords {
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    if ([entry[kAIUASyncGiftForfeited] boolValue]) {
+        return;
+    }
+    entry[kAIUASyncGiftForfeited] = @YES;
+    [self touchLocalEntry:entry];
+}
+
++ (NSString *)lotIDForLegacyRecord:(NSDictionary *)record {
+    NSString *lotID = record[@"lotID"];
+    if ([lotID isKindOfClass:[NSString class]] && lotID.length > 0) {
+        return lotID;
+    }
+    NSString *productID = [record[@"productID"] isKindOfClass:[NSString class]] ? record[@"productID"] : @"";
+    long long milliseconds = (long long)([AIUASyncDate(record[@"purchaseDate"]) timeIntervalSince1970] * 1000.0);
+    return [NSString stringWithFormat:@"legacy.%@.%lld", productID, milliseconds];
+}
+
+- (BOOL)mergeBaselineWithPurchases:(NSArray<NSDictionary *> *)purchases
+                         giftWords:(NSInteger)giftWords
+                remainingGiftWords:(NSInteger)remainingGiftWords
+                       giftAwarded:(BOOL)giftAwarded
+                     consumedWords:(NSInteger)consumedWords {
+    // 快照中的已扣减可能已包含各设备计数（如导入升级后导出的数据），基线只补足计数之外的部分
+    NSMutableDictionary<NSString *, NSNumber *> *deviceUsed = [NSMutableDictionary dictionary];
+    NSInteger deviceConsumed = 0;
+    for (NSDictionary *existing in self.mutableEntries.objectEnumerator) {
+        [existing[kAIUASyncUsed] enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, NSNumber *count, BOOL *stop) {
+            deviceUsed[lotID] = @(deviceUsed[lotID].integerValue + AIUASyncInteger(count));
+        }];
+        deviceConsumed += AIUASyncInteger(existing[kAIUASyncConsumed]);
+    }
+
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    NSMutableDictionary *lots = entry[kAIUASyncLots];
+    NSMutableDictionary *baseUsed = entry[kAIUASyncBaseUsed];
+    BOOL changed = NO;
+    for (NSDictionary *record in purchases) {
+        if (![record isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        NSString *lotID = [AIUAWordPackSyncState lotIDForLegacyRecord:record];
+        if ([self isLotPruned:lotID]) {
+            // 旧快照仍带着已移除的过期批次，不能借迁移复活
+            continue;
+        }
+        NSDictionary *lot = [AIUAWordPackSyncState lotFromRecord:record];
+        if (![lot isEqualToDictionary:lots[lotID]] && [self lot:lot precedesLot:lots[lotID]]) {
+            lots[lotID] = lot;
+            changed = YES;
+        }
+        NSInteger used = AIUASyncInteger(record[@"words"]) - AIUASyncInteger(record[@"remainingWords"]) - deviceUsed[lotID].integerValue;
+        changed |= AIUASyncRaiseCounter(baseUsed, lotID, used);
+    }
+    if (giftAwarded) {
+        if (!lots[AIUAWordPackGiftLotID]) {
+            // 旧快照没有赠送时间，用最早的时间，使各设备迁移出的批次相同
+            lots[AIUAWordPackGiftLotID] = @{@"productID": AIUAWordPackGiftLotID,
+                                            @"words": @(MAX(0, giftWords)),
+                                            @"purchaseDate": [NSDate distantPast],
+                                            @"expiryDate": [NSDate distantFuture]};
+            changed = YES;
+        }
+        NSInteger used = giftWords - MAX(0, remainingGiftWords) - deviceUsed[AIUAWordPackGiftLotID].integerValue;
+        changed |= AIUASyncRaiseCounter(baseUsed, AIUAWordPackGiftLotID, used);
+        if (![entry[kAIUASyncGiftAwarded] boolValue]) {
+            entry[kAIUASyncGiftAwarded] = @YES;
+            changed = YES;
+        }
+    }
+    changed |= AIUASyncRaiseCounter(entry, kAIUASyncBaseConsumed, consumedWords - deviceConsumed);
+    if (changed) {
+        [self touchLocalEntry:entry];
+    }
+    return changed;
+}
+
+// 批次在任一设备的移除记录中即视为已移除
+- (BOOL)isLotPruned:(NSString *)lotID {
+    for (NSDictionary *entry in self.mutableEntries.objectEnumerator) {
+        if (entry[kAIUASyncPruned][lotID]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (BOOL)pruneLotsExpiredBeforeDate:(NSDate *)date {
+    // 按合并后的批次判断是否过期，与 purchaseRecordsAtDate:policy: 读取时的判断一致
+    NSMutableSet<NSString *> *expired = [NSMutableSet set];
+    [[self mergedLots] enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, NSDictionary *lot, BOOL *stop) {
+        if (![lotID isEqualToString:AIUAWordPackGiftLotID] &&
+            [AIUASyncDate(lot[@"expiryDate"]) compare:date] != NSOrderedDescending) {
+            [expired addObject:lotID];
+        }
+    }];
+    // 本设备条目中还留有其他设备已移除的批次时一并清理
+    NSMutableDictionary *entry = [self entryForDeviceID:self.deviceID];
+    NSMutableDictionary *lots = entry[kAIUASyncLots];
+    NSMutableDictionary *used = entry[kAIUASyncUsed];
+    NSMutableDictionary *baseUsed = entry[kAIUASyncBaseUsed];
+    for (NSDictionary *counters in @[lots, used, baseUsed]) {
+        for (NSString *lotID in counters) {
+            if ([self isLotPruned:lotID]) {
+                [expired addObject:lotID];
+            }
+        }
+    }
+    NSMutableDictionary *pruned = entry[kAIUASyncPruned];
+    BOOL changed = NO;
+    for (NSString *lotID in expired) {
+        if (!pruned[lotID] || lots[lotID] || used[lotID] || baseUsed[lotID]) {
+            changed = YES;
+        }
+    }
+    if (!changed) {
+        return NO;
+    }
+    // 记入移除记录后再删除计数：合并旧的本设备条目或其他设备的副本时，这些键不会再被加回来
+    for (NSString *lotID in expired) {
+        pruned[lotID] = @YES;
+    }
+    NSArray<NSString *> *keys = expired.allObjects;
+    [lots removeObjectsForKeys:keys];
+    [used removeObjectsForKeys:keys];
+    [baseUsed removeObjectsForKeys:keys];
+    [self touchLocalEntry:entry];
+    return YES;
+}
+
+#pragma mark - 合并
+
+// 同一 lotID 的批次内容不同时（如两台设备各自迁移或赠送），取购买时间早的，再取字数少的，保证结果与合并顺序无关
+- (BOOL)lot:(NSDictionary *)lot precedesLot:(nullable NSDictionary *)other {
+    if (!other) {
+        return YES;
+    }
+    NSComparisonResult result = [AIUASyncDate(lot[@"purchaseDate"]) compare:AIUASyncDate(other[@"purchaseDate"])];
+    if (result != NSOrderedSame) {
+        return result == NSOrderedAscending;
+    }
+    return AIUASyncInteger(lot[@"words"]) < AIUASyncInteger(other[@"words"]);
+}
+
+// 计数表逐项取最大值，跳过 pruned 中已移除的批次
+static BOOL AIUASyncMergeCounters(NSMutableDictionary *target, NSDictionary *source, NSDictionary *pruned) {
+    if (![source isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+    __block BOOL changed = NO;
+    [source enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, id value, BOOL *stop) {
+        if ([lotID isKindOfClass:[NSString class]] && !pruned[lotID]) {
+            changed |= AIUASyncRaiseCounter(target, lotID, AIUASyncInteger(value));
+        }
+    }];
+    return changed;
+}
+
+- (BOOL)mergeEntry:(NSDictionary *)entry forDeviceID:(NSString *)deviceID {
+    if (![entry isKindOfClass:[NSDictionary class]] || deviceID.length == 0) {
+        return NO;
+    }
+    NSMutableDictionary *target = [self entryForDeviceID:deviceID];
+    NSUInteger localVersion = AIUASyncInteger(target[kAIUASyncVersion]);
+    NSUInteger remoteVersion = AIUASyncInteger(entry[kAIUASyncVersion]);
+    BOOL changed = NO;
+
+    // 移除记录取并集，已移除的批次从该条目中删去，且不再接收
+    NSMutableDictionary *targetPruned = target[kAIUASyncPruned];
+    NSDictionary *pruned = entry[kAIUASyncPruned];
+    if ([pruned isKindOfClass:[NSDictionary class]]) {
+        NSMutableArray<NSString *> *added = [NSMutableArray array];
+        for (NSString *lotID in pruned) {
+            if ([lotID isKindOfClass:[NSString class]] && !targetPruned[lotID]) {
+                targetPruned[lotID] = @YES;
+                [added addObject:lotID];
+            }
+        }
+        if (added.count > 0) {
+            for (NSString *key in @[kAIUASyncLots, kAIUASyncUsed, kAIUASyncBaseUsed]) {
+                [target[key] removeObjectsForKeys:added];
+            }
+            changed = YES;
+        }
+    }
+
+    NSDictionary *lots = entry[kAIUASyncLots];
+    if ([lots isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary *targetLots = target[kAIUASyncLots];
+        for (NSString *lotID in lots) {
+            NSDictionary *lot = lots[lotID];
+            if (![lotID isKindOfClass:[NSString class]] || ![lot isKindOfClass:[NSDictionary class]] || targetPruned[lotID]) {
+                continue;
+            }
+            lot = [AIUAWordPackSyncState lotFromRecord:lot];
+            if (![lot isEqualToDictionary:targetLots[lotID]] && [self lot:lot precedesLot:targetLots[lotID]]) {
+                targetLots[lotID] = lot;
+                changed = YES;
+            }
+        }
+    }
+    changed |= AIUASyncMergeCounters(target[kAIUASyncUsed], entry[kAIUASyncUsed], targetPruned);
+    changed |= AIUASyncMergeCounters(target[kAIUASyncBaseUsed], entry[kAIUASyncBaseUsed], targetPruned);
+    for (NSString *key in @[kAIUASyncConsumed, kAIUASyncBaseConsumed]) {
+        changed |= AIUASyncRaiseCounter(target, key, AIUASyncInteger(entry[key]));
+    }
+    for (NSString *key in @[kAIUASyncGiftAwarded, kAIUASyncGiftForfeited]) {
+        if ([entry[key] boolValue] && ![target[key] boolValue]) {
+            target[key] = @YES;
+            changed = YES;
+        }
+    }
+
+    if (changed) {
+        self.cachedLots = nil;
+        self.cachedUsed = nil;
+    }
+    if ([deviceID isEqualToString:self.deviceID] && changed && localVersion > 0) {
+        // 本设备的云端条目有本地没有的修改（本地也可能有云端没有的），合并结果比两者都新，需要重新上传
+        target[kAIUASyncVersion] = @(MAX(localVersion, remoteVersion) + 1);
+    } else {
+        target[kAIUASyncVersion] = @(MAX(localVersion, remoteVersion));
+    }
+    return changed;
+}
+
+#pragma mark - 余额
+
+- (NSDictionary<NSString *, NSDictionary *> *)mergedLots {
+    if (!self.cachedLots) {
+        NSMutableDictionary<NSString *, NSDictionary *> *lots = [NSMutableDictionary dictionary];
+        NSMutableDictionary<NSString *, NSNumber *> *used = [NSMutableDictionary dictionary];
+        NSMutableDictionary<NSString *, NSNumber *> *baseUsed = [NSMutableDictionary dictionary];
+        // 任一设备移除过的批次都不参与计算（尚未清理的设备条目中可能还留有它的计数）
+        NSMutableDictionary<NSString *, NSNumber *> *pruned = [NSMutableDictionary dictionary];
+        for (NSMutableDictionary *entry in self.mutableEntries.objectEnumerator) {
+            [pruned addEntriesFromDictionary:entry[kAIUASyncPruned]];
+        }
+        for (NSMutableDictionary *entry in self.mutableEntries.objectEnumerator) {
+            [entry[kAIUASyncLots] enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, NSDictionary *lot, BOOL *stop) {
+                if (!pruned[lotID] && [self lot:lot precedesLot:lots[lotID]]) {
+                    lots[lotID] = lot;
+                }
+            }];
+            // 各设备的扣减相加，旧快照基线取最大值
+            [entry[kAIUASyncUsed] enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, NSNumber *count, BOOL *stop) {
+                if (!pruned[lotID]) {
+                    used[lotID] = @(used[lotID].integerValue + AIUASyncInteger(count));
+                }
+            }];
+            AIUASyncMergeCounters(baseUsed, entry[kAIUASyncBaseUsed], pruned);
+        }
+        [baseUsed enumerateKeysAndObjectsUsingBlock:^(NSString *lotID, NSNumber *count, BOOL *stop) {
+            used[lotID] = @(used[lotID].integerValue + count.integerValue);
+        }];
+        self.cachedLots = lots;
+        self.cachedUsed = used;
+    }
+    return self.cachedLots;
+}
+
+- (BOOL)anyEntryFlag:(NSString *)key {
+    for (NSDictionary *entry in self.mutableEntries.objectEnumerator) {
+        if ([entry[key] boolValue]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (BOOL)giftAwarded {
+    return [self anyEntryFlag:kAIUASyncGiftAwarded];
+}
+
+// 赠送批次的剩余（可为负，表示超扣）
+- (NSInteger)giftBalance {
+    NSDictionary *lot = [self mergedLots][AIUAWordPackGiftLotID];
+    if (!lot || ![self giftAwarded] || [self anyEntryFlag:kAIUASyncGiftForfeited]) {
+        return 0;
+    }
+    return AIUASyncInteger(lot[@"words"]) - self.cachedUsed[AIUAWordPackGiftLotID].integerValue;
+}
+
+- (NSInteger)giftedWords {
+    return MAX(0, [self giftBalance]);
+}
+
+- (NSInteger)consumedWords {
+    NSInteger consumed = 0;
+    NSInteger baseConsumed = 0;
+    for (NSDictionary *entry in self.mutableEntries.objectEnumerator) {
+        consumed += AIUASyncInteger(entry[kAIUASyncConsumed]);
+        baseConsumed = MAX(baseConsumed, AIUASyncInteger(entry[kAIUASyncBaseConsumed]));
+    }
+    return consumed + baseConsumed;
+}
+
+- (NSArray<NSDictionary *> *)purchaseRecordsAtDate:(NSDate *)date policy:(AIUAWordPackConsumePolicy)policy {
+    NSDictionary<NSString *, NSDictionary *> *lots = [self mergedLots];
+    NSDictionary<NSString *, NSNumber *> *used = self.cachedUsed;
+
+    NSMutableArray<NSString *> *lotIDs = [NSMutableArray arrayWithCapacity:lots.count];
+    for (NSString *lotID in lots) {
+        if (![lotID isEqualToString:AIUAWordPackGiftLotID] &&
+            [AIUASyncDate(lots[lotID][@"expiryDate"]) compare:date] == NSOrderedDescending) {
+            [lotIDs addObject:lotID];
+        }
+    }
+    NSString *dateKey = policy == AIUAWordPackConsumePolicyEarliestExpiry ? @"expiryDate" : @"purchaseDate";
+    [lotIDs sortUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+        NSComparisonResult result = [AIUASyncDate(lots[a][dateKey]) compare:AIUASyncDate(lots[b][dateKey])];
+        return result != NSOrderedSame ? result : [a compare:b];
+    }];
+
+    // 超扣的部分（多台设备同时扣减同一批次）按消耗顺序从其他批次扣除
+    NSInteger overdraft = MAX(0, -[self giftBalance]);
+    NSMutableArray<NSNumber *> *remaining = [NSMutableArray arrayWithCapacity:lotIDs.count];
+    for (NSString *lotID in lotIDs) {
+        NSInteger balance = AIUASyncInteger(lots[lotID][@"words"]) - used[lotID].integerValue;
+        overdraft += MAX(0, -balance);
+        [remaining addObject:@(MAX(0, balance))];
+    }
+    NSMutableArray<NSDictionary *> *records = [NSMutableArray arrayWithCapacity:lotIDs.count];
+    for (NSUInteger i = 0; i < lotIDs.count; i++) {
+        NSInteger words = remaining[i].integerValue;
+        NSInteger covered = MIN(words, overdraft);
+        overdraft -= covered;
+        NSMutableDictionary *record = [lots[lotIDs[i]] mutableCopy];
+        record[@"lotID"] = lotIDs[i];
+        record[@"remainingWords"] = @(words - covered);
+        [records addObject:[record copy]];
+    }
+    return [records copy];
+}
+
+@end
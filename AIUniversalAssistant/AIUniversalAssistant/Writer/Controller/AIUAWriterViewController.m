@@ -11,6 +11,7 @@
 #import "AIUADataManager.h"
 #import "AIUAWritingDetailViewController.h"
 #import "AIUAWritingRecordsViewController.h"
+#import "AIUADeepSeekWriter.h"
 
 @interface AIUAWriterViewController ()<UITableViewDelegate, UITableViewDataSource>
 
@@ -58,7 +59,8 @@
 - (void)setupInputCell {
     self.inputCell = [[AIUAWritingInputCell alloc] init];
     self.inputCell.onTextChange = ^(NSString *text) {
-        // 文本变化处理
+        // 开始输入时预连接 AI 服务，提交时无需再等待建连（短时间内重复调用会被忽略）
+        [AIUADeepSeekWriter preconnectToServerURL:nil];
     };
     self.inputCell.onClearText = ^{
         // 清空文本处理
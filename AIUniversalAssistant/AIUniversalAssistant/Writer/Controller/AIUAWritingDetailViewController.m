@@ -1,6 +1,8 @@
 #import "AIUAWritingDetailViewController.h"
 #import "AIUADataManager.h"
 #import "AIUADeepSeekWriter.h"
+#import "AIUAStreamCoalescer.h"
+#import "AIUAMarkdownStripper.h"
 #import "AIUAAlertHelper.h"
 #import "AIUAMBProgressManager.h"
 #import "AIUADocDetailViewController.h"
@@ -15,6 +17,8 @@
 @property (nonatomic, copy) NSString *type;
 @property (nonatomic, assign) NSInteger wordCount;
 @property (nonatomic, strong) AIUADeepSeekWriter *writer;
+@property (nonatomic, strong) AIUAStreamCoalescer *streamCoalescer; // 合帧投递，避免每个 token 都刷新界面
+@property (nonatomic, strong) AIUAMarkdownStripper *markdownStripper; // 流式移除Markdown符号，标记跨 chunk 也能正确处理
 
 // UI Components
 @property (nonatomic, strong) UIScrollView *scrollView;
@@ -356,17 +360,18 @@
     // 初始化写作引擎
     self.writer = [[AIUADeepSeekWriter alloc] initWithServerURL:AIUA_AI_PROXY_URL];
     
-    // 开始流式写作
+    // 开始流式写作（chunk 先经过合帧层，按帧批量回到主线程）
     WeakType(self);
+    [self.streamCoalescer invalidate];
+    self.markdownStripper = [[AIUAMarkdownStripper alloc] init];
+    self.streamCoalescer = [[AIUAStreamCoalescer alloc] initWithFrameBudget:AIUAStreamCoalescerDefaultFrameBudget
+                                                            deliveryHandler:^(NSString *delta, BOOL finished, NSError *error) {
+        StrongType(self);
+        [strongself handleStreamChunk:delta finished:finished error:error];
+    }];
     [self.writer generateFullStreamWritingWithPrompt:[NSString stringWithFormat:@"%@/n%@:1、%@；2、%@。", self.prompt, L(@"format"), L(@"first_line"), L(@"body_below")]
                                            wordCount:self.wordCount > 0 ? self.wordCount : 0
-                                     streamHandler:^(NSString *chunk, BOOL finished, NSError *error) {
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            StrongType(self);
-            [strongself handleStreamChunk:chunk finished:finished error:error];
-        });
-    }];
+                                     streamHandler:[self.streamCoalescer streamHandler]];
 }
 
 - (void)clearCurrentContent {
@@ -381,28 +386,38 @@
 
 - (void)handleStreamChunk:(NSString *)chunk finished:(BOOL)finished error:(NSError *)error {
     if (error) {
+        // 保留已生成内容中缓存的尾部
+        [self appendStreamCleanText:[self.markdownStripper finish]];
         [self writingCompletedWithError:error];
         return;
     }
     
     if (finished) {
+        // 输出缓存中未闭合的尾部
+        [self appendStreamCleanText:[self.markdownStripper finish]];
         [self writingCompletedWithContent:self.contentTextView.attributedText.string];
     } else {
-        // 处理Markdown格式并转换为富文本
-        NSAttributedString *attributedChunk = [self processMarkdownToAttributedString:chunk];
-        
-        // 实时更新内容
-        NSMutableAttributedString *currentContent = [self.contentTextView.attributedText mutableCopy] ?: [[NSMutableAttributedString alloc] init];
-        [currentContent appendAttributedString:attributedChunk];
-        self.contentTextView.attributedText = currentContent;
-        
-        // 自动滚动到最新内容
-        [self scrollToBottomIfNeeded];
-        
-        // 如果是刚开始，尝试提取标题
-        if (currentContent.length == 0 && attributedChunk.length > 0) {
-            [self tryExtractTitleFromContent:attributedChunk.string];
-        }
+        // chunk 为合帧后的增量文本，流式移除Markdown符号
+        [self appendStreamCleanText:[self.markdownStripper appendChunk:chunk]];
+    }
+}
+
+- (void)appendStreamCleanText:(NSString *)cleanText {
+    if (cleanText.length == 0) {
+        return;
+    }
+    NSAttributedString *attributedChunk = [self attributedStringWithCleanText:cleanText];
+    
+    // 实时更新内容：只向 textStorage 追加增量，不复制整篇富文本
+    NSTextStorage *currentContent = self.contentTextView.textStorage;
+    [currentContent appendAttributedString:attributedChunk];
+    
+    // 自动滚动到最新内容
+    [self scrollToBottomIfNeeded];
+    
+    // 如果是刚开始，尝试提取标题
+    if (currentContent.length == 0 && attributedChunk.length > 0) {
+        [self tryExtractTitleFromContent:attributedChunk.string];
     }
 }
 
@@ -414,7 +429,11 @@
     
     // 先移除所有Markdown符号，获取纯文本
     NSString *cleanText = [AIUAToolsManager removeMarkdownSymbols:text];
-    
+    return [self attributedStringWithCleanText:cleanText];
+}
+
+// 为已移除Markdown符号的文本设置基础样式
+- (NSAttributedString *)attributedStringWithCleanText:(NSString *)cleanText {
     // 创建基础富文本
     NSMutableAttributedString *attributedString = [[NSMutableAttributedString alloc] initWithString:cleanText];
     NSRange fullRange = NSMakeRange(0, cleanText.length);
@@ -605,6 +624,10 @@
 
 // 停止生成
 - (void)stopButtonTapped {
+    // 先把已收到但未上屏的文本投递出来，再停止
+    [self.streamCoalescer flush];
+    [self.streamCoalescer invalidate];
+    [self appendStreamCleanText:[self.markdownStripper finish]];
     [self.writer cancelCurrentRequest];
     // 即使停止生成，也保存已生成的内容
     if (self.contentTextView.text.length > 0) {
@@ -679,6 +702,7 @@
 
 - (void)restartWriting {
     // 取消当前请求
+    [self.streamCoalescer invalidate];
     [self.writer cancelCurrentRequest];
     
     // 删除当前已生成的内容记录
@@ -701,6 +725,7 @@
 #pragma mark - 内存管理
 
 - (void)dealloc {
+    [_streamCoalescer invalidate];
     [self.writer cancelCurrentRequest];
 }
 
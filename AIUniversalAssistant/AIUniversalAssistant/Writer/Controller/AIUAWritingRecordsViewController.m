@@ -89,9 +89,9 @@
 
 - (void)loadData {
     if (self.isAllRecords) {
-        self.writingRecords = [[AIUADataManager sharedManager] loadAllWritings];
+        self.writingRecords = [[AIUADataManager sharedManager] loadAllWritingSummaries];
     } else {
-        self.writingRecords = [[AIUADataManager sharedManager] loadWritingsByType:self.type];
+        self.writingRecords = [[AIUADataManager sharedManager] loadWritingSummariesByType:self.type];
     }
     self.emptyLabel.hidden = self.writingRecords.count > 0;
     [self updateNavigationTitle];
@@ -146,7 +146,10 @@
     // 这里可以添加点击后的操作，比如查看详情等
     NSLog(@"Selected writing: %@", writing[@"title"]);
     
-    AIUADocDetailViewController *docDetailVC = [[AIUADocDetailViewController alloc] initWithWritingItem:writing];
+    // 列表数据是摘要，打开时按 id 读取正文
+    NSString *writingID = writing[@"id"];
+    NSDictionary *fullWriting = writingID ? [[AIUADataManager sharedManager] loadWritingWithID:writingID] : nil;
+    AIUADocDetailViewController *docDetailVC = [[AIUADocDetailViewController alloc] initWithWritingItem:fullWriting ?: writing];
     docDetailVC.hidesBottomBarWhenPushed = YES;
     [self.navigationController pushViewController:docDetailVC animated:YES];
 }
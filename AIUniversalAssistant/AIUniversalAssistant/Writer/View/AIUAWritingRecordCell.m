@@ -129,8 +129,8 @@
         self.promptLabel.text = [self simplifyPrompt:prompt];
     }
     
-    // 内容（截取前100个字符作为预览）
-    NSString *content = writing[@"content"] ?: @"";
+    // 内容（截取前100个字符作为预览；列表传入的是摘要，正文预览在 preview 字段）
+    NSString *content = writing[@"preview"] ?: writing[@"content"] ?: @"";
     if (content.length > 100) {
         content = [[content substringToIndex:100] stringByAppendingString:@"..."];
     }
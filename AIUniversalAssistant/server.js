@@ -1,5 +1,6 @@
 const express = require("express");
 const crypto = require("crypto");
+const { StringDecoder } = require("string_decoder");
 const fetch = (...args) =>
   import("node-fetch").then(({ default: fetchFn }) => fetchFn(...args));
 
@@ -18,9 +19,24 @@ const RATE_LIMIT_MAX = Number(process.env.RATE_LIMIT_MAX || 30);
 const UPSTREAM_TIMEOUT_MS = Number(process.env.UPSTREAM_TIMEOUT_MS || 120_000);
 const APP_SIGNING_SECRET = process.env.APP_SIGNING_SECRET || "";
 const SIGN_MAX_SKEW_SEC = Number(process.env.SIGN_MAX_SKEW_SEC || 300);
+// 本地压测用的模拟上游：MOCK_UPSTREAM=1 时不请求 DeepSeek，按注入的延迟以 SSE 回显用户消息
+const MOCK_UPSTREAM = process.env.MOCK_UPSTREAM === "1";
+const MOCK_FIRST_CHUNK_MS = Number(process.env.MOCK_FIRST_CHUNK_MS || 800);
+const MOCK_CHUNK_INTERVAL_MS = Number(process.env.MOCK_CHUNK_INTERVAL_MS || 40);
+const MOCK_CHUNK_CHARS = Math.max(1, Number(process.env.MOCK_CHUNK_CHARS || 2));
+// 模拟断线：每写出一个事件后按该概率断开客户端连接（0~1），用于验证断线续传
+const MOCK_DISCONNECT_RATE = Math.min(1, Math.max(0, Number(process.env.MOCK_DISCONNECT_RATE || 0)));
+// 流式生成的重放缓冲：生成结束后保留的时长，以及每个生成最多保留的字节数（超出时丢弃最早的事件）
+const REPLAY_TTL_MS = Number(process.env.REPLAY_TTL_MS || 60_000);
+const REPLAY_MAX_BYTES = Number(process.env.REPLAY_MAX_BYTES || 1_048_576);
+// 每个生成最多续传的次数；续传不请求上游、不计入按 IP 的频率限制，由这里兜底
+const RESUME_MAX_PER_GENERATION = Number(process.env.RESUME_MAX_PER_GENERATION || 50);
 
 const aiJsonParser = express.json({ limit: AI_BODY_LIMIT });
 const rateStore = new Map();
+// 进行中与刚结束的流式生成，键为客户端传入的 x-aiua-generation-id
+const generations = new Map();
+const replayStats = { started: 0, resumed: 0, unavailable: 0, rejected: 0 };
 
 function getClientIp(req) {
   const forwarded = req.headers["x-forwarded-for"];
@@ -67,17 +83,287 @@ function safeEqualHex(a, b) {
   }
 }
 
+// ---- 流式生成与断线续传 ----
+// 上游事件统一重新编号（id: 1, 2, ...）写入重放缓冲，再转发给当前连接的客户端。
+// 客户端断线不会中断上游，生成继续写入缓冲；客户端携带同一个 x-aiua-generation-id 与
+// Last-Event-ID 重连时，从缓冲补发之后的事件并继续接收，不会重新请求上游（不重复计费）。
+// 生成归创建它的客户端所有：创建时记录 x-aiua-app-token 与客户端随机生成的 x-aiua-resume-key 的哈希，
+// 续传必须携带相同的凭证，否则拒绝；生成 id 会出现在响应头和日志中，凭证不会。
+
+function parseGenerationId(req) {
+  const value = req.headers["x-aiua-generation-id"];
+  return typeof value === "string" && /^[A-Za-z0-9-]{8,64}$/.test(value) ? value : null;
+}
+
+// 生成的归属：应用令牌 + 续传凭证的哈希；未携带续传凭证（旧版客户端）的生成不可续传
+function parseGenerationOwner(req) {
+  const resumeKey = req.headers["x-aiua-resume-key"];
+  if (typeof resumeKey !== "string" || !/^[A-Za-z0-9-]{16,128}$/.test(resumeKey)) {
+    return null;
+  }
+  const appToken = req.headers["x-aiua-app-token"];
+  return sha256Hex(`${typeof appToken === "string" ? appToken : ""}.${resumeKey}`);
+}
+
+function parseLastEventId(req) {
+  const value = Number(req.headers["last-event-id"]);
+  return Number.isInteger(value) && value > 0 ? value : 0;
+}
+
+function openEventStream(gen, res) {
+  res.status(200);
+  res.setHeader("Content-Type", "text/event-stream; charset=utf-8");
+  res.setHeader("Cache-Control", "no-cache");
+  res.setHeader("Connection", "keep-alive");
+  // 告诉 Nginx 不要缓冲此响应，逐块透传
+  res.setHeader("X-Accel-Buffering", "no");
+  res.setHeader("x-aiua-generation-id", gen.id);
+  res.setHeader("x-aiua-resumable", gen.owner ? "1" : "0");
+  // 立即刷出 HTTP 头，让客户端尽早开始接收
+  res.flushHeaders();
+}
+
+function writeFrame(res, frame) {
+  if (res.destroyed) return;
+  res.write(frame);
+  if (typeof res.flush === "function") res.flush();
+  if (MOCK_UPSTREAM && MOCK_DISCONNECT_RATE > 0 && Math.random() < MOCK_DISCONNECT_RATE) {
+    // 下一轮事件循环再断开，已写出的事件先送达（与真实网络中途断开一致）
+    setImmediate(() => res.destroy());
+  }
+}
+
+function createGeneration(id, owner) {
+  const gen = {
+    id,
+    owner,
+    resumes: 0,
+    state: "pending", // pending：等待上游响应；streaming：接收中；finished：已结束，保留 REPLAY_TTL_MS
+    frames: [],
+    firstSeq: 1, // frames[0] 的事件 id
+    nextSeq: 1,
+    bytes: 0,
+    waiting: new Map(), // 上游响应前到达的客户端 -> Last-Event-ID
+    clients: new Set(),
+  };
+  generations.set(id, gen);
+  replayStats.started += 1;
+  return gen;
+}
+
+function attachClient(gen, res, lastSeq) {
+  if (gen.state === "pending") {
+    gen.waiting.set(res, lastSeq);
+    res.on("close", () => gen.waiting.delete(res));
+    return;
+  }
+  if (lastSeq + 1 < gen.firstSeq) {
+    replayStats.unavailable += 1;
+    return res.status(410).json({ error: "replay_unavailable" });
+  }
+  openEventStream(gen, res);
+  for (let seq = lastSeq + 1; seq < gen.nextSeq && !res.destroyed; seq++) {
+    writeFrame(res, gen.frames[seq - gen.firstSeq]);
+  }
+  if (gen.state === "finished") {
+    return res.end();
+  }
+  gen.clients.add(res);
+  res.on("close", () => gen.clients.delete(res));
+}
+
+function beginGeneration(gen) {
+  gen.state = "streaming";
+  for (const [res, lastSeq] of gen.waiting) {
+    attachClient(gen, res, lastSeq);
+  }
+  gen.waiting.clear();
+}
+
+function pushGenerationEvent(gen, data) {
+  const lines = String(data).split("\n").map((line) => `data: ${line}`);
+  const frame = `id: ${gen.nextSeq}\n${lines.join("\n")}\n\n`;
+  gen.nextSeq += 1;
+  gen.frames.push(frame);
+  gen.bytes += Buffer.byteLength(frame);
+  while (gen.bytes > REPLAY_MAX_BYTES && gen.frames.length > 1) {
+    gen.bytes -= Buffer.byteLength(gen.frames.shift());
+    gen.firstSeq += 1;
+  }
+  for (const res of gen.clients) {
+    writeFrame(res, frame);
+  }
+}
+
+function finishGeneration(gen) {
+  gen.state = "finished";
+  for (const res of gen.clients) {
+    res.end();
+  }
+  gen.clients.clear();
+  console.log(
+    `[replay] generation ${gen.id} finished events=${gen.nextSeq - 1} ` +
+      `started=${replayStats.started} resumed=${replayStats.resumed} unavailable=${replayStats.unavailable} ` +
+      `rejected=${replayStats.rejected}`
+  );
+  setTimeout(() => generations.delete(gen.id), REPLAY_TTL_MS).unref();
+}
+
+// 上游未返回事件流时，把错误转给等待中的客户端
+function failGeneration(gen, status, body) {
+  for (const res of gen.waiting.keys()) {
+    if (!res.headersSent) {
+      res.status(status).json(body);
+    }
+  }
+  gen.waiting.clear();
+  generations.delete(gen.id);
+}
+
+function streamGeneration(req, res, start) {
+  const id = parseGenerationId(req);
+  const lastSeq = parseLastEventId(req);
+  const owner = parseGenerationOwner(req);
+  const existing = id ? generations.get(id) : null;
+  if (existing) {
+    // 凭证不符（含重复使用他人的生成 id 发起新请求）时不能读取或接入该生成
+    if (!existing.owner || !owner || !safeEqualHex(owner, existing.owner)) {
+      replayStats.rejected += 1;
+      console.warn(`[replay] reject resume ${id}: owner mismatch`);
+      return res.status(403).json({ error: "generation_forbidden" });
+    }
+    if (existing.resumes >= RESUME_MAX_PER_GENERATION) {
+      replayStats.rejected += 1;
+      console.warn(`[replay] reject resume ${id}: ${existing.resumes} resumes`);
+      return res.status(429).json({ error: "too_many_resumes" });
+    }
+    existing.resumes += 1;
+    replayStats.resumed += 1;
+    console.log(`[replay] resume ${id} after event ${lastSeq} (${existing.state})`);
+    return attachClient(existing, res, lastSeq);
+  }
+  if (lastSeq > 0) {
+    // 缓冲已过期（或服务重启），无法续传；重新生成会与已收到的内容重复
+    replayStats.unavailable += 1;
+    return res.status(410).json({ error: "replay_unavailable" });
+  }
+  const gen = createGeneration(id || crypto.randomUUID(), owner);
+  attachClient(gen, res, 0);
+  start(gen);
+}
+
+// 把上游 SSE 按事件拆开，取出 data 写入生成
+function relayUpstreamEvents(gen, body) {
+  const decoder = new StringDecoder("utf8");
+  let pending = "";
+  const flushBlock = (block) => {
+    const data = block
+      .split("\n")
+      .filter((line) => line.startsWith("data:"))
+      .map((line) => line.slice(line.startsWith("data: ") ? 6 : 5));
+    if (data.length > 0) {
+      pushGenerationEvent(gen, data.join("\n"));
+    }
+  };
+  body.on("data", (chunk) => {
+    // 先拼接再替换，\r\n 被拆在两个数据块之间时也能识别
+    pending = (pending + decoder.write(chunk)).replace(/\r\n/g, "\n");
+    let index;
+    while ((index = pending.indexOf("\n\n")) >= 0) {
+      flushBlock(pending.slice(0, index));
+      pending = pending.slice(index + 2);
+    }
+  });
+  const end = () => {
+    if (gen.state === "finished") return;
+    pending += decoder.end();
+    if (pending.trim().length > 0) {
+      flushBlock(pending.replace(/\r\n/g, "\n"));
+    }
+    finishGeneration(gen);
+  };
+  body.on("end", end);
+  body.on("error", end);
+}
+
+async function runUpstreamGeneration(payload, gen) {
+  const controller = new AbortController();
+  const timeoutId = setTimeout(() => controller.abort(), UPSTREAM_TIMEOUT_MS);
+
+  let upstream;
+  try {
+    upstream = await fetch(DEEPSEEK_URL, {
+      method: "POST",
+      headers: {
+        "Content-Type": "application/json",
+        Authorization: `Bearer ${DEEPSEEK_KEY}`,
+      },
+      body: JSON.stringify(payload),
+      signal: controller.signal,
+    });
+  } catch (err) {
+    if (err && err.name === "AbortError") {
+      return failGeneration(gen, 504, { error: "upstream_timeout" });
+    }
+    return failGeneration(gen, 500, { error: "server error", detail: String(err) });
+  } finally {
+    clearTimeout(timeoutId);
+  }
+
+  if (upstream.status !== 200 || !upstream.body) {
+    const text = await upstream.text().catch(() => "");
+    let data;
+    try {
+      data = JSON.parse(text);
+    } catch (_e) {
+      data = { error: "invalid_upstream_response", raw: text };
+    }
+    return failGeneration(gen, upstream.status === 200 ? 502 : upstream.status, data);
+  }
+
+  beginGeneration(gen);
+  relayUpstreamEvents(gen, upstream.body);
+}
+
+function runMockGeneration(payload, gen) {
+  const messages = Array.isArray(payload.messages) ? payload.messages : [];
+  const last = messages[messages.length - 1];
+  const chars = Array.from(typeof last?.content === "string" ? last.content : "");
+
+  beginGeneration(gen);
+  let offset = 0;
+  const tick = () => {
+    if (offset >= chars.length) {
+      pushGenerationEvent(gen, "[DONE]");
+      return finishGeneration(gen);
+    }
+    const content = chars.slice(offset, offset + MOCK_CHUNK_CHARS).join("");
+    offset += MOCK_CHUNK_CHARS;
+    pushGenerationEvent(gen, JSON.stringify({ choices: [{ index: 0, delta: { content } }] }));
+    setTimeout(tick, MOCK_CHUNK_INTERVAL_MS);
+  };
+  setTimeout(tick, MOCK_FIRST_CHUNK_MS);
+}
+
 app.get("/", (_req, res) => {
   res.send("AI Server is running 🚀");
 });
 
 app.post("/ai", aiJsonParser, async (req, res) => {
+  if (MOCK_UPSTREAM) {
+    if (!req.body || req.body.stream !== true) {
+      return res.status(400).json({ error: "mock_supports_stream_only" });
+    }
+    return streamGeneration(req, res, (gen) => runMockGeneration(req.body, gen));
+  }
+
   if (!DEEPSEEK_KEY) {
     return res.status(500).json({ error: "missing DEEPSEEK_KEY" });
   }
 
+  // 续传请求不会请求上游，不计入频率限制（归属与续传次数由 streamGeneration 校验）
   const clientIp = getClientIp(req);
-  if (isRateLimited(clientIp)) {
+  if (!generations.has(parseGenerationId(req)) && isRateLimited(clientIp)) {
     return res.status(429).json({ error: "too_many_requests" });
   }
 
@@ -125,6 +411,10 @@ app.post("/ai", aiJsonParser, async (req, res) => {
       payload.model = "deepseek-chat";
     }
 
+    if (payload.stream === true) {
+      return streamGeneration(req, res, (gen) => runUpstreamGeneration(payload, gen));
+    }
+
     const controller = new AbortController();
     const timeoutId = setTimeout(() => controller.abort(), UPSTREAM_TIMEOUT_MS);
 
@@ -143,44 +433,6 @@ app.post("/ai", aiJsonParser, async (req, res) => {
       clearTimeout(timeoutId);
     }
 
-    const isStream = payload.stream === true;
-
-    if (isStream) {
-      res.status(upstream.status);
-      res.setHeader(
-        "Content-Type",
-        upstream.headers.get("content-type") || "text/event-stream; charset=utf-8"
-      );
-      res.setHeader("Cache-Control", "no-cache");
-      res.setHeader("Connection", "keep-alive");
-      // 告诉 Nginx 不要缓冲此响应，逐块透传
-      res.setHeader("X-Accel-Buffering", "no");
-      // 立即刷出 HTTP 头，让客户端尽早开始接收
-      res.flushHeaders();
-
-      if (!upstream.body) {
-        return res.end();
-      }
-
-      upstream.body.on("error", () => {
-        if (!res.headersSent) {
-          res.status(502).end();
-        } else {
-          res.end();
-        }
-      });
-
-      // 逐块写入并立即 flush，避免 Node.js 内部缓冲合并小块
-      upstream.body.on("data", (chunk) => {
-        res.write(chunk);
-        if (typeof res.flush === "function") res.flush();
-      });
-      upstream.body.on("end", () => {
-        res.end();
-      });
-      return;
-    }
-
     const text = await upstream.text();
     let data;
     try {
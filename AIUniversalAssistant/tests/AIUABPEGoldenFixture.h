@@ -0,0 +1,143 @@
+//
+//  AIUABPEGoldenFixture.h
+//  AIUniversalAssistant
+//
+//  读取 tools/bpe_golden.py 生成的金标准文件，按 AIUATokenizer 编译 tokenizer.json 的方式生成二进制表
+//  测试与基准共用
+//
+
+#ifndef AIUABPEGoldenFixture_h
+#define AIUABPEGoldenFixture_h
+
+#include "AIUATestSupport.h"
+#include "AIUABPETokenizer.h"
+
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    uint32_t *ids;
+    size_t idCount;
+} AIUABPEGoldenCase;
+
+typedef struct {
+    uint8_t *table;             // AIUABPETokenizerBuilderFinish 的结果
+    size_t tableLength;
+    uint32_t vocabSize;
+    size_t mergeCount;
+    AIUABPEGoldenCase *cases;
+    size_t caseCount;
+} AIUABPEGoldenFixture;
+
+static inline size_t AIUABPEGoldenDecodeHex(const char *hex, size_t hexLength, uint8_t *output) {
+    size_t length = 0;
+    for (size_t i = 0; i + 1 < hexLength; i += 2) {
+        unsigned value = 0;
+        sscanf(hex + i, "%2x", &value);
+        output[length++] = (uint8_t)value;
+    }
+    return length;
+}
+
+// 读取一行（去掉换行），返回 NULL 表示文件结束
+static inline char *AIUABPEGoldenNextLine(char **cursor) {
+    char *line = *cursor;
+    if (!line || *line == '\0') {
+        return NULL;
+    }
+    char *end = strchr(line, '\n');
+    if (end) {
+        *end = '\0';
+        *cursor = end + 1;
+    } else {
+        *cursor = line + strlen(line);
+    }
+    return line;
+}
+
+static inline void AIUABPEGoldenFixtureFree(AIUABPEGoldenFixture *fixture) {
+    for (size_t i = 0; i < fixture->caseCount; i++) {
+        free(fixture->cases[i].bytes);
+        free(fixture->cases[i].ids);
+    }
+    free(fixture->cases);
+    free(fixture->table);
+    memset(fixture, 0, sizeof(*fixture));
+}
+
+/// 加载金标准文件；格式错误时返回 false
+static inline bool AIUABPEGoldenFixtureLoad(const char *path, AIUABPEGoldenFixture *fixture) {
+    memset(fixture, 0, sizeof(*fixture));
+    size_t fileLength = 0;
+    uint8_t *file = AIUATestReadFile(path, &fileLength);
+    if (!file) {
+        return false;
+    }
+    char *text = (char *)realloc(file, fileLength + 1);
+    text[fileLength] = '\0';
+    char *cursor = text;
+    char *line = NULL;
+    unsigned ignoreMerges = 0;
+    unsigned long count = 0;
+    bool ok = (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "ignore_merges %u", &ignoreMerges) == 1 &&
+              (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "vocab %lu", &count) == 1 && count > 0;
+    AIUABPETokenizerBuilder *builder = ok ? AIUABPETokenizerBuilderCreate((uint32_t)count) : NULL;
+    fixture->vocabSize = (uint32_t)count;
+    uint8_t *bytes = malloc(fileLength + 1);
+    ok = ok && builder && bytes;
+    for (unsigned long i = 0; ok && i < fixture->vocabSize; i++) {
+        unsigned long tokenID = 0;
+        int consumed = 0;
+        ok = (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "%lu %n", &tokenID, &consumed) == 1;
+        // 无法还原为字节的特殊 token 不参与普通文本编码
+        if (ok && line[consumed] != '-') {
+            size_t length = AIUABPEGoldenDecodeHex(line + consumed, strlen(line + consumed), bytes);
+            ok = AIUABPETokenizerBuilderSetToken(builder, (uint32_t)tokenID, bytes, length);
+        }
+    }
+    ok = ok && (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "merges %lu", &count) == 1;
+    fixture->mergeCount = ok ? count : 0;
+    for (unsigned long i = 0; ok && i < fixture->mergeCount; i++) {
+        unsigned long left = 0, right = 0, merged = 0;
+        ok = (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "%lu %lu %lu", &left, &right, &merged) == 3 &&
+             AIUABPETokenizerBuilderAddMerge(builder, (uint32_t)left, (uint32_t)right, (uint32_t)merged);
+    }
+    if (ok) {
+        AIUABPETokenizerBuilderSetIgnoreMerges(builder, ignoreMerges != 0);
+        ok = AIUABPETokenizerBuilderFinish(builder, &fixture->table, &fixture->tableLength);
+    }
+    AIUABPETokenizerBuilderDestroy(builder);
+
+    ok = ok && (line = AIUABPEGoldenNextLine(&cursor)) && sscanf(line, "cases %lu", &count) == 1;
+    fixture->cases = ok ? (AIUABPEGoldenCase *)calloc(count ? count : 1, sizeof(AIUABPEGoldenCase)) : NULL;
+    ok = ok && fixture->cases;
+    for (unsigned long i = 0; ok && i < count; i++) {
+        line = AIUABPEGoldenNextLine(&cursor);
+        char *space = line ? strchr(line, ' ') : NULL;
+        ok = space != NULL;
+        if (!ok) {
+            break;
+        }
+        AIUABPEGoldenCase *golden = &fixture->cases[fixture->caseCount++];
+        size_t hexLength = (size_t)(space - line);
+        golden->bytes = malloc(hexLength / 2 + 1);
+        golden->length = AIUABPEGoldenDecodeHex(line, hexLength, golden->bytes);
+        golden->ids = malloc(sizeof(uint32_t) * (strlen(space) / 2 + 1));
+        for (char *p = space + 1; *p; ) {
+            char *end = NULL;
+            unsigned long tokenID = strtoul(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            golden->ids[golden->idCount++] = (uint32_t)tokenID;
+            p = end + (*end == ',' ? 1 : 0);
+        }
+    }
+    free(bytes);
+    free(text);
+    if (!ok) {
+        AIUABPEGoldenFixtureFree(fixture);
+    }
+    return ok;
+}
+
+#endif /* AIUABPEGoldenFixture_h */
@@ -0,0 +1,69 @@
+//
+//  AIUABPETokenizerBench.c
+//  AIUniversalAssistant
+//
+//  AIUABPETokenizer 基准：加载（含内容校验）耗时，以及按金标准文件中的片段循环拼出约 4MB 文本后的编码吞吐
+//  预分词（NSRegularExpression）不在测量范围内，这里只测合并引擎
+//  用法：AIUABPETokenizerBench [金标准文件] [MB]
+//
+
+#include "AIUABPEGoldenFixture.h"
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "fixtures/bpe_golden.txt";
+    double megabytes = argc > 2 ? strtod(argv[2], NULL) : 4.0;
+    AIUABPEGoldenFixture fixture;
+    if (!AIUABPEGoldenFixtureLoad(path, &fixture) || fixture.caseCount == 0) {
+        fprintf(stderr, "无法加载金标准文件 %s\n", path);
+        return 1;
+    }
+
+    const int loadRounds = 50;
+    double start = AIUATestNow();
+    for (int round = 0; round < loadRounds; round++) {
+        AIUABPETokenizerDestroy(AIUABPETokenizerCreate(fixture.table, fixture.tableLength));
+    }
+    double load = (AIUATestNow() - start) / loadRounds;
+    AIUABPETokenizer *tokenizer = AIUABPETokenizerCreate(fixture.table, fixture.tableLength);
+    if (!tokenizer) {
+        fprintf(stderr, "二进制表无效\n");
+        return 1;
+    }
+
+    size_t target = (size_t)(megabytes * 1024 * 1024);
+    size_t bytes = 0;
+    size_t pieces = 0;
+    size_t tokens = 0;
+    size_t longest = 0;
+    for (size_t i = 0; i < fixture.caseCount; i++) {
+        longest = fixture.cases[i].length > longest ? fixture.cases[i].length : longest;
+    }
+    uint32_t *output = malloc(sizeof(uint32_t) * (longest + 1));
+    start = AIUATestNow();
+    while (bytes < target) {
+        for (size_t i = 0; i < fixture.caseCount && bytes < target; i++) {
+            const AIUABPEGoldenCase *golden = &fixture.cases[i];
+            size_t count = AIUABPETokenizerEncode(tokenizer, golden->bytes, golden->length, output, longest + 1);
+            if (count != golden->idCount) {
+                fprintf(stderr, "第 %zu 个片段结果与金标准不一致\n", i + 1);
+                return 1;
+            }
+            bytes += golden->length;
+            tokens += count;
+            pieces++;
+        }
+    }
+    double encode = AIUATestNow() - start;
+
+    printf("[AIUABPETokenizer] %s  vocab=%u merges=%zu  表 %.1f KB\n",
+           path, fixture.vocabSize, fixture.mergeCount, fixture.tableLength / 1024.0);
+    printf("  加载（含校验）   %8.3f ms\n", load * 1000.0);
+    printf("  编码 %.1f MB     %8.1f ms  %6.1f MB/s  %6.2f M token/s  %6.2f M 片段/s  平均 %.2f 字节/token\n",
+           bytes / 1048576.0, encode * 1000.0, bytes / encode / 1048576.0,
+           tokens / encode / 1e6, pieces / encode / 1e6, (double)bytes / tokens);
+
+    free(output);
+    AIUABPETokenizerDestroy(tokenizer);
+    AIUABPEGoldenFixtureFree(&fixture);
+    return 0;
+}
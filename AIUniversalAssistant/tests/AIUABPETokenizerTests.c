@@ -0,0 +1,255 @@
+//
+//  AIUABPETokenizerTests.c
+//  AIUniversalAssistant
+//
+//  AIUABPETokenizer 测试：合并顺序、ignore_merges，损坏的二进制表（Caches 中的缓存文件）必须在加载时被拒绝，
+//  以及与 HuggingFace tokenizers 逐片段一致（金标准文件由 tools/bpe_golden.py 生成）
+//  用法：AIUABPETokenizerTests [金标准文件...]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUABPEGoldenFixture.h"
+
+// 二进制表中各段的位置（按 uint32 计），与 AIUABPETokenizer.c 的布局一致
+enum {
+    AIUATestBPEVocabSize = 2,
+    AIUATestBPEMergeCount = 3,
+    AIUATestBPEMergeCapacity = 4,
+    AIUATestBPEVocabCapacity = 5,
+    AIUATestBPEByteTokens = 8,
+    AIUATestBPETokenOffsets = 8 + 256,
+};
+
+typedef struct {
+    uint32_t *words;
+    size_t length;
+} AIUATestTable;
+
+static uint32_t *AIUATestMergeTable(const AIUATestTable *table) {
+    return table->words + AIUATestBPETokenOffsets + table->words[AIUATestBPEVocabSize] + 1;
+}
+
+static uint32_t *AIUATestVocabTable(const AIUATestTable *table) {
+    return AIUATestMergeTable(table) + (size_t)table->words[AIUATestBPEMergeCapacity] * 4;
+}
+
+// 256 个单字节 token，加上 ab(256)、abc(257)、cd(258)、abcd(259)
+static AIUATestTable AIUATestBuildTable(bool ignoreMerges) {
+    AIUABPETokenizerBuilder *builder = AIUABPETokenizerBuilderCreate(260);
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        uint8_t value = (uint8_t)byte;
+        AIUABPETokenizerBuilderSetToken(builder, byte, &value, 1);
+    }
+    AIUABPETokenizerBuilderSetToken(builder, 256, (const uint8_t *)"ab", 2);
+    AIUABPETokenizerBuilderSetToken(builder, 257, (const uint8_t *)"abc", 3);
+    AIUABPETokenizerBuilderSetToken(builder, 258, (const uint8_t *)"cd", 2);
+    AIUABPETokenizerBuilderSetToken(builder, 259, (const uint8_t *)"abcd", 4);
+    AIUABPETokenizerBuilderAddMerge(builder, 'a', 'b', 256);
+    AIUABPETokenizerBuilderAddMerge(builder, 256, 'c', 257);
+    AIUABPETokenizerBuilderAddMerge(builder, 'c', 'd', 258);
+    AIUABPETokenizerBuilderAddMerge(builder, 'a', 'b', 258);      // 重复的相邻对只保留第一条
+    AIUABPETokenizerBuilderSetIgnoreMerges(builder, ignoreMerges);
+    AIUATestTable table = {NULL, 0};
+    uint8_t *data = NULL;
+    AIUA_CHECK(AIUABPETokenizerBuilderFinish(builder, &data, &table.length));
+    table.words = (uint32_t *)data;
+    AIUABPETokenizerBuilderDestroy(builder);
+    return table;
+}
+
+static size_t AIUATestEncode(AIUABPETokenizer *tokenizer, const char *text, uint32_t *tokens, size_t capacity) {
+    return AIUABPETokenizerEncode(tokenizer, (const uint8_t *)text, strlen(text), tokens, capacity);
+}
+
+static void AIUATestEncoding(void) {
+    AIUATestTable table = AIUATestBuildTable(false);
+    AIUA_CHECK(table.words[AIUATestBPEMergeCount] == 3);
+    AIUABPETokenizer *tokenizer = AIUABPETokenizerCreate(table.words, table.length);
+    AIUA_CHECK(tokenizer != NULL);
+    AIUA_CHECK(AIUABPETokenizerGetVocabSize(tokenizer) == 260);
+
+    uint32_t tokens[16];
+    // ab 先合并，再与 c 合并；abcd 没有合并规则可达，结果为 abc + d
+    AIUA_CHECK(AIUATestEncode(tokenizer, "abcd", tokens, 16) == 2 && tokens[0] == 257 && tokens[1] == 'd');
+    AIUA_CHECK(AIUATestEncode(tokenizer, "cdab", tokens, 16) == 2 && tokens[0] == 258 && tokens[1] == 256);
+    AIUA_CHECK(AIUATestEncode(tokenizer, "xyz", tokens, 16) == 3 && tokens[0] == 'x' && tokens[2] == 'z');
+    AIUA_CHECK(AIUATestEncode(tokenizer, "ababab", NULL, 0) == 3);
+    size_t length = 0;
+    const uint8_t *bytes = AIUABPETokenizerGetTokenBytes(tokenizer, 259, &length);
+    AIUA_CHECK(length == 4 && memcmp(bytes, "abcd", 4) == 0);
+    AIUA_CHECK(AIUABPETokenizerGetTokenBytes(tokenizer, 260, &length) == NULL);
+    AIUABPETokenizerDestroy(tokenizer);
+    free(table.words);
+
+    // ignore_merges：整段在词表中时直接输出
+    table = AIUATestBuildTable(true);
+    tokenizer = AIUABPETokenizerCreate(table.words, table.length);
+    AIUA_CHECK(AIUATestEncode(tokenizer, "abcd", tokens, 16) == 1 && tokens[0] == 259);
+    AIUA_CHECK(AIUATestEncode(tokenizer, "abcdab", tokens, 16) == 3);
+    AIUABPETokenizerDestroy(tokenizer);
+    free(table.words);
+}
+
+// 改动拷贝中的一个 uint32 后加载，期望被拒绝
+static void AIUATestRejects(const AIUATestTable *table, const char *name, void (*corrupt)(AIUATestTable *)) {
+    AIUATestTable copy = {malloc(table->length), table->length};
+    memcpy(copy.words, table->words, table->length);
+    corrupt(&copy);
+    AIUABPETokenizer *tokenizer = AIUABPETokenizerCreate(copy.words, copy.length);
+    AIUA_CHECK_MSG(tokenizer == NULL, "%s", name);
+    AIUABPETokenizerDestroy(tokenizer);
+    free(copy.words);
+}
+
+static void AIUATestCorruptOffsets(AIUATestTable *table) {
+    uint32_t *offsets = table->words + AIUATestBPETokenOffsets;
+    offsets[100] = offsets[101] + 1;
+}
+
+static void AIUATestCorruptFirstOffset(AIUATestTable *table) {
+    table->words[AIUATestBPETokenOffsets] = 1;
+}
+
+static void AIUATestCorruptVocabTable(AIUATestTable *table) {
+    uint32_t *vocab = AIUATestVocabTable(table);
+    for (uint32_t slot = 0; slot < table->words[AIUATestBPEVocabCapacity]; slot++) {
+        if (vocab[slot] != AIUA_BPE_INVALID_TOKEN) {
+            vocab[slot] = table->words[AIUATestBPEVocabSize];
+            return;
+        }
+    }
+}
+
+static uint32_t *AIUATestFirstMerge(AIUATestTable *table) {
+    uint32_t *merges = AIUATestMergeTable(table);
+    for (uint32_t slot = 0; slot < table->words[AIUATestBPEMergeCapacity]; slot++) {
+        if (merges[(size_t)slot * 4] != AIUA_BPE_INVALID_TOKEN) {
+            return merges + (size_t)slot * 4;
+        }
+    }
+    return merges;
+}
+
+static void AIUATestCorruptMergeLeft(AIUATestTable *table) {
+    AIUATestFirstMerge(table)[0] = table->words[AIUATestBPEVocabSize] + 7;
+}
+
+static void AIUATestCorruptMergeRight(AIUATestTable *table) {
+    AIUATestFirstMerge(table)[1] = table->words[AIUATestBPEVocabSize];
+}
+
+static void AIUATestCorruptMergeResult(AIUATestTable *table) {
+    AIUATestFirstMerge(table)[3] = AIUA_BPE_INVALID_TOKEN - 1;
+}
+
+static void AIUATestCorruptMergeCount(AIUATestTable *table) {
+    table->words[AIUATestBPEMergeCount] += 1;
+}
+
+static void AIUATestCorruptByteTokenRange(AIUATestTable *table) {
+    table->words[AIUATestBPEByteTokens + 0] = table->words[AIUATestBPEVocabSize];
+}
+
+static void AIUATestCorruptByteTokenBytes(AIUATestTable *table) {
+    table->words[AIUATestBPEByteTokens + 'a'] = 'b';
+}
+
+static void AIUATestCorruptByteTokenLength(AIUATestTable *table) {
+    table->words[AIUATestBPEByteTokens + 'a'] = 256;
+}
+
+static void AIUATestCorruptVocabSize(AIUATestTable *table) {
+    table->words[AIUATestBPEVocabSize] = 0;
+}
+
+static void AIUATestCorruptedTables(void) {
+    AIUATestTable table = AIUATestBuildTable(false);
+    AIUATestRejects(&table, "token 偏移不单调", AIUATestCorruptOffsets);
+    AIUATestRejects(&table, "首个偏移非 0", AIUATestCorruptFirstOffset);
+    AIUATestRejects(&table, "词表索引越界", AIUATestCorruptVocabTable);
+    AIUATestRejects(&table, "合并左 id 越界", AIUATestCorruptMergeLeft);
+    AIUATestRejects(&table, "合并右 id 越界", AIUATestCorruptMergeRight);
+    AIUATestRejects(&table, "合并结果越界", AIUATestCorruptMergeResult);
+    AIUATestRejects(&table, "合并规则数不符", AIUATestCorruptMergeCount);
+    AIUATestRejects(&table, "单字节 token 越界", AIUATestCorruptByteTokenRange);
+    AIUATestRejects(&table, "单字节 token 字节不符", AIUATestCorruptByteTokenBytes);
+    AIUATestRejects(&table, "单字节 token 长度不符", AIUATestCorruptByteTokenLength);
+    AIUATestRejects(&table, "vocabSize 为 0", AIUATestCorruptVocabSize);
+    AIUA_CHECK(AIUABPETokenizerCreate(table.words, table.length - 1) == NULL);
+
+    // 随机改写：要么加载失败，要么编码不越界（配合 ASan 运行）
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 23);
+    size_t wordCount = table.length / sizeof(uint32_t);
+    uint32_t *copy = malloc(table.length);
+    uint8_t text[64];
+    uint32_t tokens[64];
+    int loaded = 0;
+    for (int round = 0; round < 2000; round++) {
+        memcpy(copy, table.words, table.length);
+        int edits = 1 + (int)AIUATestRandomBelow(&random, 4);
+        for (int e = 0; e < edits; e++) {
+            size_t index = AIUATestRandomBelow(&random, wordCount);
+            copy[index] = AIUATestRandomBelow(&random, 2) ? (uint32_t)AIUATestRandomNext(&random)
+                                                          : (uint32_t)AIUATestRandomBelow(&random, 300);
+        }
+        AIUABPETokenizer *tokenizer = AIUABPETokenizerCreate(copy, table.length);
+        if (!tokenizer) {
+            continue;
+        }
+        loaded++;
+        for (size_t i = 0; i < sizeof(text); i++) {
+            text[i] = (uint8_t)("abcdxyz"[AIUATestRandomBelow(&random, 7)]);
+        }
+        size_t count = AIUABPETokenizerEncode(tokenizer, text, sizeof(text), tokens, 64);
+        for (size_t i = 0; i < count && i < 64; i++) {
+            size_t length = 0;
+            AIUA_CHECK(tokens[i] == AIUA_BPE_INVALID_TOKEN || AIUABPETokenizerGetTokenBytes(tokenizer, tokens[i], &length) != NULL);
+        }
+        AIUABPETokenizerDestroy(tokenizer);
+    }
+    printf("  随机改写 2000 次，%d 次仍可加载（改动落在空槽或未使用的字段）\n", loaded);
+    free(copy);
+    free(table.words);
+}
+
+static void AIUATestGolden(const char *path) {
+    AIUABPEGoldenFixture fixture;
+    if (!AIUABPEGoldenFixtureLoad(path, &fixture)) {
+        AIUA_CHECK_MSG(false, "无法加载金标准文件 %s", path);
+        return;
+    }
+    AIUABPETokenizer *tokenizer = AIUABPETokenizerCreate(fixture.table, fixture.tableLength);
+    AIUA_CHECK(tokenizer != NULL);
+    size_t matched = 0;
+    size_t tokenCount = 0;
+    uint32_t *tokens = NULL;
+    size_t capacity = 0;
+    for (size_t i = 0; tokenizer && i < fixture.caseCount; i++) {
+        const AIUABPEGoldenCase *golden = &fixture.cases[i];
+        if (golden->length > capacity) {
+            capacity = golden->length;
+            tokens = realloc(tokens, sizeof(uint32_t) * capacity);
+        }
+        size_t count = AIUABPETokenizerEncode(tokenizer, golden->bytes, golden->length, tokens, capacity);
+        bool same = count == golden->idCount && memcmp(tokens, golden->ids, sizeof(uint32_t) * count) == 0;
+        AIUA_CHECK_MSG(same, "%s 第 %zu 个片段（%zu 字节）：得到 %zu 个 token，期望 %zu 个",
+                       path, i + 1, golden->length, count, golden->idCount);
+        matched += same;
+        tokenCount += golden->idCount;
+    }
+    printf("  %s：vocab=%u merges=%zu，%zu / %zu 个片段（%zu token）与 tokenizers 一致\n",
+           path, fixture.vocabSize, fixture.mergeCount, matched, fixture.caseCount, tokenCount);
+    free(tokens);
+    AIUABPETokenizerDestroy(tokenizer);
+    AIUABPEGoldenFixtureFree(&fixture);
+}
+
+int main(int argc, char **argv) {
+    AIUATestEncoding();
+    AIUATestCorruptedTables();
+    for (int i = 1; i < argc; i++) {
+        AIUATestGolden(argv[i]);
+    }
+    return AIUATestSummary("AIUABPETokenizer");
+}
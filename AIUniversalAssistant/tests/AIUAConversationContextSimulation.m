@@ -0,0 +1,229 @@
+//
+//  AIUAConversationContextSimulation.m
+//  AIUniversalAssistant
+//
+//  AIUAConversationContext 的 50 轮会话模拟：按 generateWritingWithContext: 的顺序驱动真实的上下文
+//  （追加用户消息 → messagesForRequest → 追加回答），与整段历史每轮重发（generateWritingWithMessages:）对比
+//  - 请求字节数：按 AIUADeepSeekWriter 的非流式请求体序列化 JSON
+//  - 模拟首字延迟：固定开销 + 上行传输 + 未命中缓存的 token 预填充 + 命中缓存的 token 读取，
+//    参数只用于比较两种组装方式的趋势，不代表真实线上延迟
+//  - 对照组的系统提示同样保持不变（对它最有利的情况），只比较历史增长带来的差异
+//  - 核对：首条消息每轮逐字节相同；输入 token 不超过预算；两次压缩之间可缓存前缀覆盖上一次请求；
+//    保留的历史从用户消息开始，以本轮提问结束；每 7 轮模拟一次请求失败后重试，不出现连续两条用户消息
+//  命令行下应用包中没有词表，token 数按 AIUATokenizer 的字符估算计，结果可复现
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAConversationContextSimulation [轮数] [会话个数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAConversationContext.h"
+#import "AIUATokenizer.h"
+#include "AIUATestSupport.h"
+
+// 与 AIUADeepSeekWriter 的多轮请求一致
+static const NSUInteger kAIUASimMaxTokens = 1000;
+static const double kAIUASimTemperature = 1.5;
+static const NSUInteger kAIUASimTokenBudget = 4000;
+
+// 模拟首字延迟的参数（毫秒）
+static const double kAIUASimBaseLatency = 250.0;
+static const double kAIUASimUplinkBytesPerMs = 250.0;   // 约 2 Mbps
+static const double kAIUASimPrefillMsPerToken = 0.25;
+static const double kAIUASimCachedMsPerToken = 0.025;
+
+static NSString * const kAIUASimSystemPrompt = @"你是一名专业的中文写作助手，擅长根据用户的要求撰写结构清晰、语言流畅的文章。";
+static NSString * const kAIUASimTemplatePrompt = @"写作要求：\n1. 紧扣主题，观点明确；\n2. 分段落展开，每段有中心句；\n"
+                                                 @"3. 避免空话套话，多用具体事例；\n4. 结尾总结全文并适当升华。";
+
+typedef struct {
+    NSUInteger bytes;
+    NSUInteger tokens;
+    NSUInteger cachedTokens;
+    double ttft;
+} AIUASimRequest;
+
+typedef struct {
+    AIUASimRequest baseline;
+    AIUASimRequest context;
+} AIUASimTurn;
+
+static NSString *AIUASimText(AIUATestRandom *random, NSUInteger sentences, NSUInteger turn) {
+    static NSString * const fragments[] = {
+        @"城市的清晨总是从一杯热豆浆开始", @"年轻人更愿意把时间花在自我提升上", @"科技改变了我们获取信息的方式",
+        @"读书的意义在于与更好的自己相遇", @"乡村振兴需要人才与产业的共同支撑", @"The key point is consistency",
+        @"环境保护不仅是口号更是日常的选择", @"每一次失败都为下一次尝试积累经验", @"数据显示线上学习的比例逐年上升"
+    };
+    const size_t fragmentCount = sizeof(fragments) / sizeof(fragments[0]);
+    NSMutableString *text = [NSMutableString stringWithFormat:@"第 %lu 轮：", (unsigned long)turn];
+    for (NSUInteger i = 0; i < sentences; i++) {
+        [text appendString:fragments[AIUATestRandomBelow(random, fragmentCount)]];
+        [text appendString:AIUATestRandomBelow(random, 4) == 0 ? @"！" : @"。"];
+        if (AIUATestRandomBelow(random, 6) == 0) {
+            [text appendString:@"\n"];
+        }
+    }
+    return text;
+}
+
+static NSUInteger AIUASimRequestBytes(NSArray<NSDictionary<NSString *, NSString *> *> *messages) {
+    NSDictionary *body = @{@"model": @"deepseek-chat",
+                           @"messages": messages,
+                           @"max_tokens": @(kAIUASimMaxTokens),
+                           @"temperature": @(kAIUASimTemperature),
+                           @"stream": @NO};
+    return [NSJSONSerialization dataWithJSONObject:body options:0 error:nil].length;
+}
+
+static double AIUASimTTFT(NSUInteger bytes, NSUInteger tokens, NSUInteger cachedTokens) {
+    return kAIUASimBaseLatency + bytes / kAIUASimUplinkBytesPerMs +
+           (tokens - cachedTokens) * kAIUASimPrefillMsPerToken + cachedTokens * kAIUASimCachedMsPerToken;
+}
+
+// 对照组：每条消息计一次 token（含角色标记 1 个），与上一次请求逐条比较可缓存前缀
+static void AIUASimMeasureBaseline(NSArray<NSDictionary<NSString *, NSString *> *> *messages,
+                                   NSArray<NSDictionary<NSString *, NSString *> *> *previous,
+                                   AIUASimRequest *request) {
+    AIUATokenizer *tokenizer = [AIUATokenizer sharedTokenizer];
+    NSUInteger tokens = 2;
+    NSUInteger cached = previous.count > 0 ? 1 : 0;
+    BOOL matching = previous.count > 0;
+    for (NSUInteger i = 0; i < messages.count; i++) {
+        NSUInteger messageTokens = [tokenizer countTokensInText:messages[i][@"content"]] + (i > 0 ? 1 : 0);
+        tokens += messageTokens;
+        matching = matching && i < previous.count && [previous[i] isEqualToDictionary:messages[i]];
+        if (matching) {
+            cached += messageTokens;
+        }
+    }
+    request->bytes = AIUASimRequestBytes(messages);
+    request->tokens = tokens;
+    request->cachedTokens = cached;
+    request->ttft = AIUASimTTFT(request->bytes, tokens, cached);
+}
+
+static void AIUASimRunSession(uint64_t seed, NSUInteger turns, AIUASimTurn *results) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+    AIUAConversationContext *context = [[AIUAConversationContext alloc] initWithSystemPrompt:kAIUASimSystemPrompt
+                                                                              templatePrompt:kAIUASimTemplatePrompt
+                                                                                 tokenBudget:kAIUASimTokenBudget];
+    NSString *baselinePrefix = [NSString stringWithFormat:@"%@\n\n%@", kAIUASimSystemPrompt, kAIUASimTemplatePrompt];
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *history = [NSMutableArray array];
+    NSArray<NSDictionary<NSString *, NSString *> *> *previousBaseline = @[];
+    NSData *firstPrefix = nil;
+    NSUInteger previousPromptTokens = 0;
+    NSUInteger previousCompactions = 0;
+
+    for (NSUInteger turn = 1; turn <= turns; turn++) {
+        NSString *question = AIUASimText(&random, 1 + AIUATestRandomBelow(&random, 4), turn);
+        NSString *answer = AIUASimText(&random, 8 + AIUATestRandomBelow(&random, 40), turn);
+
+        // 对照组：整段历史每轮重发
+        [history addObject:@{@"role": @"user", @"content": question}];
+        NSMutableArray *baseline = [NSMutableArray arrayWithObject:@{@"role": @"system", @"content": baselinePrefix}];
+        [baseline addObjectsFromArray:history];
+        AIUASimMeasureBaseline(baseline, previousBaseline, &results[turn - 1].baseline);
+        previousBaseline = baseline;
+        [history addObject:@{@"role": @"assistant", @"content": answer}];
+
+        if (turn % 7 == 0) {
+            // 首次请求失败：与 generateWritingWithContext: 的失败分支相同，撤回本轮提问后重试
+            [context appendUserMessage:question];
+            [context messagesForRequest];
+            AIUA_CHECK([context removeLastUserMessage]);
+            AIUA_CHECK(![context removeLastUserMessage]);
+        }
+
+        // 与 generateWritingWithContext: 相同的调用顺序
+        [context appendUserMessage:question];
+        NSArray<NSDictionary<NSString *, NSString *> *> *messages = [context messagesForRequest];
+        AIUASimRequest *request = &results[turn - 1].context;
+        request->bytes = AIUASimRequestBytes(messages);
+        request->tokens = context.promptTokenCount;
+        request->cachedTokens = context.cacheablePrefixTokenCount;
+        request->ttft = AIUASimTTFT(request->bytes, request->tokens, request->cachedTokens);
+
+        NSData *prefix = [messages.firstObject[@"content"] dataUsingEncoding:NSUTF8StringEncoding];
+        firstPrefix = firstPrefix ?: prefix;
+        AIUA_CHECK_MSG([messages.firstObject[@"role"] isEqualToString:@"system"] && [prefix isEqualToData:firstPrefix],
+                       "seed %llu 第 %lu 轮首条消息与第 1 轮不同", (unsigned long long)seed, (unsigned long)turn);
+        AIUA_CHECK_MSG(context.promptTokenCount <= kAIUASimTokenBudget, "seed %llu 第 %lu 轮输入 %lu token 超出预算",
+                       (unsigned long long)seed, (unsigned long)turn, (unsigned long)context.promptTokenCount);
+        AIUA_CHECK([messages.lastObject[@"content"] isEqualToString:question]);
+        for (NSUInteger i = 1; i < messages.count; i++) {
+            AIUA_CHECK_MSG(!([messages[i - 1][@"role"] isEqualToString:@"user"] && [messages[i][@"role"] isEqualToString:@"user"]),
+                           "seed %llu 第 %lu 轮出现连续两条用户消息", (unsigned long long)seed, (unsigned long)turn);
+        }
+        NSUInteger firstHistory = messages.count - context.messageCount;
+        AIUA_CHECK(firstHistory < messages.count && [messages[firstHistory][@"role"] isEqualToString:@"user"]);
+        if (turn > 1) {
+            AIUA_CHECK(context.cacheablePrefixTokenCount > context.stablePrefixTokenCount);
+            if (context.compactionCount == previousCompactions) {
+                // 只在末尾追加：上一次请求的全部消息都可命中缓存（差请求模板的开销）
+                AIUA_CHECK_MSG(context.cacheablePrefixTokenCount + 2 >= previousPromptTokens,
+                               "seed %llu 第 %lu 轮可缓存前缀 %lu < 上一次请求 %lu", (unsigned long long)seed,
+                               (unsigned long)turn, (unsigned long)context.cacheablePrefixTokenCount,
+                               (unsigned long)previousPromptTokens);
+            }
+        }
+        previousPromptTokens = context.promptTokenCount;
+        previousCompactions = context.compactionCount;
+
+        [context appendAssistantMessage:answer];
+    }
+
+    // 压缩是摊还的：每次压缩后若干轮只追加
+    AIUA_CHECK(context.compactionCount > 0);
+    AIUA_CHECK(context.compactionCount < turns / 3);
+    AIUA_CHECK(context.summary.length > 0);
+    AIUA_CHECK(results[turns - 1].context.bytes < results[turns - 1].baseline.bytes);
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger turns = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 50;
+        NSUInteger sessions = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 8;
+        if (turns < 6 || sessions == 0) {
+            fprintf(stderr, "用法：AIUAConversationContextSimulation [轮数 >= 6] [会话个数]\n");
+            return 2;
+        }
+        AIUASimTurn *totals = (AIUASimTurn *)calloc(turns, sizeof(AIUASimTurn));
+        AIUASimTurn *results = (AIUASimTurn *)calloc(turns, sizeof(AIUASimTurn));
+        for (uint64_t seed = 1; seed <= sessions; seed++) {
+            @autoreleasepool {
+                AIUASimRunSession(seed, turns, results);
+            }
+            for (NSUInteger i = 0; i < turns; i++) {
+                totals[i].baseline.bytes += results[i].baseline.bytes;
+                totals[i].baseline.tokens += results[i].baseline.tokens;
+                totals[i].baseline.cachedTokens += results[i].baseline.cachedTokens;
+                totals[i].baseline.ttft += results[i].baseline.ttft;
+                totals[i].context.bytes += results[i].context.bytes;
+                totals[i].context.tokens += results[i].context.tokens;
+                totals[i].context.cachedTokens += results[i].context.cachedTokens;
+                totals[i].context.ttft += results[i].context.ttft;
+            }
+        }
+
+        printf("[AIUAConversationContext] %lu 个会话 × %lu 轮，预算 %lu token，各轮平均\n",
+               (unsigned long)sessions, (unsigned long)turns, (unsigned long)kAIUASimTokenBudget);
+        printf("  轮次 | 整段重发: 字节   token   缓存  首字ms | 上下文: 字节   token   缓存  首字ms\n");
+        double baselineSum = 0;
+        double contextSum = 0;
+        for (NSUInteger i = 0; i < turns; i++) {
+            baselineSum += totals[i].baseline.ttft / sessions;
+            contextSum += totals[i].context.ttft / sessions;
+            if (i == 0 || (i + 1) % 5 == 0 || i + 1 == turns) {
+                printf("  %4lu | %14lu %7lu %6lu %7.0f | %12lu %7lu %6lu %7.0f\n", (unsigned long)(i + 1),
+                       (unsigned long)(totals[i].baseline.bytes / sessions), (unsigned long)(totals[i].baseline.tokens / sessions),
+                       (unsigned long)(totals[i].baseline.cachedTokens / sessions), totals[i].baseline.ttft / sessions,
+                       (unsigned long)(totals[i].context.bytes / sessions), (unsigned long)(totals[i].context.tokens / sessions),
+                       (unsigned long)(totals[i].context.cachedTokens / sessions), totals[i].context.ttft / sessions);
+            }
+        }
+        printf("  平均首字延迟：整段重发 %.0f ms，上下文 %.0f ms\n", baselineSum / turns, contextSum / turns);
+        free(results);
+        free(totals);
+        return AIUATestSummary("AIUAConversationContextSimulation");
+    }
+}
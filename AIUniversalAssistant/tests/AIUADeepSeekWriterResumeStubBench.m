@@ -0,0 +1,89 @@
+//
+//  AIUADeepSeekWriterResumeStubBench.m
+//  AIUniversalAssistant
+//
+//  断线续传基准：本地 SSE 模拟服务（server.js，MOCK_UPSTREAM=1，MOCK_DISCONNECT_RATE 随机断线）回显用户消息，
+//  用真实的 AIUADeepSeekWriter 并发发起多次流式生成，断线后由写作器携带 Last-Event-ID 续传
+//  统计成功 / 失败的生成数，以及 recoveredStreamCount / failedStreamCount（断线后续传完成 / 最终失败）的增量
+//  成功的生成与原文不一致（重放的事件没有去重或丢失内容）时退出码为 1
+//  只依赖 Foundation，macOS 上由 make resume-bench 启动模拟服务后运行
+//  用法：AIUADeepSeekWriterResumeStubBench [服务地址，默认 http://127.0.0.1:3000/ai] [生成数] [并发数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUADeepSeekWriter.h"
+#include "AIUATestSupport.h"
+
+static const NSTimeInterval kAIUABenchTimeout = 600;
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSString *serverURL = argc > 1 ? @(argv[1]) : @"http://127.0.0.1:3000/ai";
+        NSUInteger count = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 100;
+        NSUInteger concurrency = argc > 3 ? (NSUInteger)strtoul(argv[3], NULL, 10) : 8;
+        count = MAX(count, (NSUInteger)1);
+        concurrency = MAX(concurrency, (NSUInteger)1);
+
+        NSUInteger recoveredBefore = AIUADeepSeekWriter.recoveredStreamCount;
+        NSUInteger failedBefore = AIUADeepSeekWriter.failedStreamCount;
+        __block NSUInteger started = 0;
+        __block NSUInteger finished = 0;
+        __block NSUInteger succeeded = 0;
+        __block NSUInteger failed = 0;
+        __block NSUInteger corrupted = 0;
+        // 写作器可同时进行多个流式请求，所有生成共用一个
+        AIUADeepSeekWriter *writer = [[AIUADeepSeekWriter alloc] initWithServerURL:serverURL];
+        double start = AIUATestNow();
+
+        __block void (^startNext)(void) = nil;
+        void (^startGeneration)(void) = ^{
+            NSUInteger index = started++;
+            NSString *text = [NSString stringWithFormat:@"第 %lu 次生成：断线续传测试文本，断线续传测试文本，断线续传测试文本，断线续传测试文本。#%lu",
+                              (unsigned long)index, (unsigned long)index];
+            NSMutableString *output = [NSMutableString string];
+            [writer generateFullStreamWritingWithPrompt:text maxTokens:400 streamHandler:^(NSString *chunk, BOOL done, NSError *error) {
+                if (!done && !error) {
+                    [output appendString:chunk];
+                    return;
+                }
+                finished++;
+                if (error) {
+                    failed++;
+                    fprintf(stderr, "  生成 %lu 失败：%s\n", (unsigned long)index, error.localizedDescription.UTF8String);
+                } else if (![output isEqualToString:text]) {
+                    corrupted++;
+                    fprintf(stderr, "  生成 %lu 内容不一致：期望 %lu 字，收到 %lu 字\n", (unsigned long)index,
+                            (unsigned long)text.length, (unsigned long)output.length);
+                } else {
+                    succeeded++;
+                }
+                if (started < count) {
+                    startNext();
+                }
+            }];
+        };
+        startNext = startGeneration;
+        for (NSUInteger i = 0; i < MIN(concurrency, count); i++) {
+            startGeneration();
+        }
+
+        NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAIUABenchTimeout];
+        while (finished < count && [deadline timeIntervalSinceNow] > 0) {
+            [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+        }
+        startNext = nil;
+        if (finished < count) {
+            fprintf(stderr, "超时：%lu / %lu 次生成结束\n", (unsigned long)finished, (unsigned long)count);
+            [writer cancelCurrentRequest];
+            return 1;
+        }
+
+        printf("[AIUADeepSeekWriter] %s，%lu 次生成，并发 %lu，耗时 %.1f s\n", serverURL.UTF8String,
+               (unsigned long)count, (unsigned long)concurrency, AIUATestNow() - start);
+        printf("  成功 %lu  失败 %lu  内容不一致 %lu\n", (unsigned long)succeeded, (unsigned long)failed, (unsigned long)corrupted);
+        printf("  断线后续传完成 %lu  断线后最终失败 %lu\n",
+               (unsigned long)(AIUADeepSeekWriter.recoveredStreamCount - recoveredBefore),
+               (unsigned long)(AIUADeepSeekWriter.failedStreamCount - failedBefore));
+        return corrupted == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,154 @@
+//
+//  AIUAFullTextIndexBench.c
+//  AIUniversalAssistant
+//
+//  AIUAFullTextIndex 基准：合成 10k 篇、共约 5000 万字的写作记录（字频偏斜的常用汉字 + 少量英文），
+//  测量全量建索引（即重建工具的耗时）、快照序列化/恢复、压缩，以及 1/2/4/8 字查询的延迟分布
+//  单字查询要遍历整个词典合并以该字开头或结尾的二元组，单独列出
+//  用法：AIUAFullTextIndexBench [文档数] [每篇字数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAFullTextIndex.h"
+
+#define AIUA_BENCH_ALPHABET 3500
+
+static uint16_t AIUABenchAlphabet[AIUA_BENCH_ALPHABET];
+
+// 平方分布让低序号的字出现得更多，倒排表长度接近真实文本的长尾
+static uint16_t AIUABenchNextChar(AIUATestRandom *random) {
+    size_t roll = AIUATestRandomBelow(random, 10000);
+    if (roll < 300) {
+        return (uint16_t)('a' + AIUATestRandomBelow(random, 26));
+    }
+    if (roll < 900) {
+        return 0x3002;      // 。
+    }
+    double u = (double)AIUATestRandomBelow(random, 1u << 30) / (double)(1u << 30);
+    return AIUABenchAlphabet[(size_t)(u * u * AIUA_BENCH_ALPHABET)];
+}
+
+static void AIUABenchFill(AIUATestRandom *random, uint16_t *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        text[i] = AIUABenchNextChar(random);
+    }
+}
+
+// 不含句号的 8 字窗口，使 2/4/8 字查询只走二元组子句；找不到时退回任意窗口
+static const uint16_t *AIUABenchQueryWindow(AIUATestRandom *random, const uint16_t *content, size_t length) {
+    const uint16_t *window = content;
+    for (int attempt = 0; attempt < 64; attempt++) {
+        window = content + AIUATestRandomBelow(random, length - 8);
+        bool clean = true;
+        for (int i = 0; i < 8 && clean; i++) {
+            clean = window[i] != 0x3002;
+        }
+        if (clean) {
+            break;
+        }
+    }
+    return window;
+}
+
+static int AIUABenchCompareDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv) {
+    size_t documentCount = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+    size_t contentLength = argc > 2 ? strtoul(argv[2], NULL, 10) : 5000;
+    if (documentCount == 0 || contentLength < 16) {
+        fprintf(stderr, "用法：%s [文档数] [每篇字数 >= 16]\n", argv[0]);
+        return 1;
+    }
+    for (size_t i = 0; i < AIUA_BENCH_ALPHABET; i++) {
+        AIUABenchAlphabet[i] = (uint16_t)(0x4E00 + i * 5);
+    }
+
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 15);
+    uint16_t title[24];
+    uint16_t prompt[80];
+    uint16_t *content = malloc(sizeof(uint16_t) * contentLength);
+    // 查询词从正文里抽取，保证有命中
+    size_t queryCount = 1000;
+    uint16_t (*queries)[8] = malloc(sizeof(uint16_t[8]) * queryCount);
+    size_t queryLengths[] = {1, 2, 4, 8};
+    size_t queryStride = documentCount > queryCount ? documentCount / queryCount : 1;
+    queryCount = documentCount / queryStride < queryCount ? documentCount / queryStride : queryCount;
+
+    AIUAFullTextIndex *index = AIUAFullTextIndexCreate();
+    size_t totalCharacters = 0;
+    double start = AIUATestNow();
+    for (size_t doc = 1; doc <= documentCount; doc++) {
+        AIUABenchFill(&random, title, 24);
+        AIUABenchFill(&random, prompt, 80);
+        AIUABenchFill(&random, content, contentLength);
+        const uint16_t *fields[AIUAFullTextFieldCount] = {title, prompt, content};
+        const size_t lengths[AIUAFullTextFieldCount] = {24, 80, contentLength};
+        if (!AIUAFullTextIndexAddDocument(index, (uint32_t)doc, fields, lengths)) {
+            fprintf(stderr, "添加文档 %zu 失败\n", doc);
+            return 1;
+        }
+        totalCharacters += 24 + 80 + contentLength;
+        if (doc % queryStride == 0 && doc / queryStride <= queryCount) {
+            memcpy(queries[doc / queryStride - 1], AIUABenchQueryWindow(&random, content, contentLength), sizeof(uint16_t) * 8);
+        }
+    }
+    double build = AIUATestNow() - start;
+    printf("[AIUAFullTextIndex] %zu 篇  %.1f M 字\n", documentCount, totalCharacters / 1e6);
+    printf("  全量建索引        %8.2f s   (%.1f M 字/s)\n", build, totalCharacters / build / 1e6);
+
+    uint8_t *bytes = NULL;
+    size_t length = 0;
+    start = AIUATestNow();
+    if (!AIUAFullTextIndexSerialize(index, &bytes, &length)) {
+        fprintf(stderr, "序列化失败\n");
+        return 1;
+    }
+    double serialize = AIUATestNow() - start;
+    start = AIUATestNow();
+    AIUAFullTextIndex *restored = AIUAFullTextIndexDeserialize(bytes, length);
+    double deserialize = AIUATestNow() - start;
+    if (!restored) {
+        fprintf(stderr, "恢复失败\n");
+        return 1;
+    }
+    printf("  快照大小          %8.1f MB  (%.2f 字节/字)\n", length / 1e6, (double)length / totalCharacters);
+    printf("  序列化            %8.1f ms\n", serialize * 1000.0);
+    printf("  恢复（含校验）    %8.1f ms\n", deserialize * 1000.0);
+    AIUAFullTextIndexDestroy(restored);
+    free(bytes);
+
+    // 删除 10% 后压缩
+    for (size_t doc = 1; doc <= documentCount; doc += 10) {
+        AIUAFullTextIndexRemoveDocument(index, (uint32_t)doc);
+    }
+    start = AIUATestNow();
+    AIUAFullTextIndexCompact(index);
+    printf("  删除 10%% 后压缩   %8.1f ms\n", (AIUATestNow() - start) * 1000.0);
+
+    double *latencies = malloc(sizeof(double) * queryCount);
+    for (size_t l = 0; l < sizeof(queryLengths) / sizeof(queryLengths[0]); l++) {
+        size_t hitsTotal = 0;
+        for (size_t q = 0; q < queryCount; q++) {
+            AIUAFullTextHit *hits = NULL;
+            double t = AIUATestNow();
+            hitsTotal += AIUAFullTextIndexSearch(index, queries[q], queryLengths[l], 20, &hits);
+            latencies[q] = AIUATestNow() - t;
+            free(hits);
+        }
+        qsort(latencies, queryCount, sizeof(double), AIUABenchCompareDouble);
+        printf("  查询 %zu 字（前 20） p50 %7.3f ms  p99 %7.3f ms  max %7.3f ms  平均命中 %.1f\n",
+               queryLengths[l], latencies[queryCount / 2] * 1000.0, latencies[queryCount * 99 / 100] * 1000.0,
+               latencies[queryCount - 1] * 1000.0, (double)hitsTotal / queryCount);
+    }
+
+    free(latencies);
+    free(queries);
+    free(content);
+    AIUAFullTextIndexDestroy(index);
+    return 0;
+}
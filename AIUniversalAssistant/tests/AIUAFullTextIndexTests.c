@@ -0,0 +1,191 @@
+//
+//  AIUAFullTextIndexTests.c
+//  AIUniversalAssistant
+//
+//  AIUAFullTextIndex 测试：查询、序列化往返，以及损坏快照（校验和不符、倒排表越界）必须被拒绝
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAFullTextIndex.h"
+
+// 把 ASCII / UTF-8 中文转成 UTF-16（只处理 BMP）
+static size_t AIUATestUTF16(const char *text, uint16_t *output, size_t capacity) {
+    const uint8_t *p = (const uint8_t *)text;
+    size_t length = 0;
+    while (*p && length < capacity) {
+        uint32_t c = *p;
+        if (c >= 0xE0) {
+            c = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+            p += 3;
+        } else if (c >= 0xC0) {
+            c = ((c & 0x1F) << 6) | (p[1] & 0x3F);
+            p += 2;
+        } else {
+            p += 1;
+        }
+        output[length++] = (uint16_t)c;
+    }
+    return length;
+}
+
+static bool AIUATestAdd(AIUAFullTextIndex *index, uint32_t docID, const char *title, const char *prompt, const char *content) {
+    static uint16_t buffers[AIUAFullTextFieldCount][512];
+    const char *texts[AIUAFullTextFieldCount] = {title, prompt, content};
+    const uint16_t *fields[AIUAFullTextFieldCount];
+    size_t lengths[AIUAFullTextFieldCount];
+    for (int f = 0; f < AIUAFullTextFieldCount; f++) {
+        lengths[f] = texts[f] ? AIUATestUTF16(texts[f], buffers[f], 512) : 0;
+        fields[f] = texts[f] ? buffers[f] : NULL;
+    }
+    return AIUAFullTextIndexAddDocument(index, docID, fields, lengths);
+}
+
+static size_t AIUATestSearch(const AIUAFullTextIndex *index, const char *query, AIUAFullTextHit **hits) {
+    uint16_t buffer[128];
+    size_t length = AIUATestUTF16(query, buffer, 128);
+    return AIUAFullTextIndexSearch(index, buffer, length, 0, hits);
+}
+
+static void AIUATestPutU32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t AIUATestCRC32(const uint8_t *bytes, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 手工拼出只含一个词的快照，倒排表按 postings 原样写入，末尾补上正确的校验和
+static uint8_t *AIUATestForgeSnapshot(uint32_t maxDocID, uint32_t docCount, uint32_t lastDocID,
+                                      const uint8_t *postings, size_t postingsLength, size_t *length) {
+    size_t total = 28 + 1 + 16 + postingsLength + 4;
+    uint8_t *bytes = calloc(total, 1);
+    AIUATestPutU32(bytes, 0x46554941u);
+    AIUATestPutU32(bytes + 4, 2);
+    AIUATestPutU32(bytes + 8, maxDocID);
+    AIUATestPutU32(bytes + 12, 1);
+    AIUATestPutU32(bytes + 16, 0);
+    AIUATestPutU32(bytes + 20, 1);
+    AIUATestPutU32(bytes + 24, 1);
+    bytes[28] = 0x02;                           // 文档 1 有效
+    AIUATestPutU32(bytes + 29, ('a' << 16) | 'b');
+    AIUATestPutU32(bytes + 33, docCount);
+    AIUATestPutU32(bytes + 37, lastDocID);
+    AIUATestPutU32(bytes + 41, (uint32_t)postingsLength);
+    memcpy(bytes + 45, postings, postingsLength);
+    AIUATestPutU32(bytes + total - 4, AIUATestCRC32(bytes, total - 4));
+    *length = total;
+    return bytes;
+}
+
+static void AIUATestSearchAndRoundTrip(void) {
+    AIUAFullTextIndex *index = AIUAFullTextIndexCreate();
+    AIUA_CHECK(AIUATestAdd(index, 1, "春天的散文", "写一篇关于春天的散文", "春风拂面，万物复苏。"));
+    AIUA_CHECK(AIUATestAdd(index, 2, "工作总结", "年度工作总结", "今年完成了三个项目，春季上线了新版本。"));
+    AIUA_CHECK(AIUATestAdd(index, 3, "Weekly Report", NULL, "Shipped the search index and fixed crashes."));
+    AIUA_CHECK(!AIUATestAdd(index, 3, "重复文档号", NULL, NULL));
+
+    AIUAFullTextHit *hits = NULL;
+    size_t count = AIUATestSearch(index, "春天", &hits);
+    AIUA_CHECK(count == 1 && hits[0].docID == 1 && hits[0].field == AIUAFullTextFieldTitle && hits[0].offset == 0);
+    free(hits);
+    count = AIUATestSearch(index, "search", &hits);
+    AIUA_CHECK(count == 1 && hits[0].docID == 3 && hits[0].field == AIUAFullTextFieldContent);
+    free(hits);
+
+    AIUAFullTextIndexRemoveDocument(index, 2);
+    uint8_t *bytes = NULL;
+    size_t length = 0;
+    AIUA_CHECK(AIUAFullTextIndexSerialize(index, &bytes, &length));
+    AIUAFullTextIndex *restored = AIUAFullTextIndexDeserialize(bytes, length);
+    AIUA_CHECK(restored != NULL);
+    AIUA_CHECK(AIUAFullTextIndexDocumentCount(restored) == 2);
+    AIUA_CHECK(AIUAFullTextIndexDeletedDocumentCount(restored) == 1);
+    AIUA_CHECK(AIUAFullTextIndexMaxDocID(restored) == 3);
+    count = AIUATestSearch(restored, "工作", &hits);
+    AIUA_CHECK(count == 0);
+    free(hits);
+    count = AIUATestSearch(restored, "散文", &hits);
+    AIUA_CHECK(count == 1 && hits[0].docID == 1);
+    free(hits);
+
+    // 压缩后的索引同样能往返
+    AIUA_CHECK(AIUAFullTextIndexCompact(restored));
+    uint8_t *compacted = NULL;
+    size_t compactedLength = 0;
+    AIUA_CHECK(AIUAFullTextIndexSerialize(restored, &compacted, &compactedLength));
+    AIUAFullTextIndex *again = AIUAFullTextIndexDeserialize(compacted, compactedLength);
+    AIUA_CHECK(again != NULL && AIUAFullTextIndexDocumentCount(again) == 2);
+    AIUAFullTextIndexDestroy(again);
+    free(compacted);
+
+    // 任意一个字节被改动都要被校验和或结构检查拒绝，截断同理
+    int rejected = 0;
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] ^= 0x5A;
+        AIUAFullTextIndex *corrupted = AIUAFullTextIndexDeserialize(bytes, length);
+        rejected += corrupted == NULL;
+        AIUAFullTextIndexDestroy(corrupted);
+        bytes[i] ^= 0x5A;
+    }
+    AIUA_CHECK_MSG(rejected == (int)length, "%d / %zu", rejected, length);
+    for (size_t cut = 0; cut < length; cut += 7) {
+        AIUA_CHECK(AIUAFullTextIndexDeserialize(bytes, cut) == NULL);
+    }
+
+    AIUAFullTextIndexDestroy(restored);
+    AIUAFullTextIndexDestroy(index);
+    free(bytes);
+}
+
+// 校验和正确但内容非法的快照：旧版只检查长度，会把越界的字段号和文档号带进查询路径
+static void AIUATestForgedPostings(void) {
+    struct {
+        const char *name;
+        uint32_t maxDocID;
+        uint32_t docCount;
+        uint32_t lastDocID;
+        uint8_t postings[8];
+        size_t length;
+        bool valid;
+    } cases[] = {
+        {"合法", 1, 1, 1, {1, (0 << 2) | AIUAFullTextFieldTitle, 1}, 3, true},
+        {"字段号越界", 1, 1, 1, {1, (0 << 2) | 3, 1}, 3, false},
+        {"文档号超过 maxDocID", 1, 1, 9, {9, 0, 1}, 3, false},
+        {"文档号为 0", 1, 1, 0, {0, 0, 1}, 3, false},
+        {"文档号不递增", 2, 2, 1, {1, 0, 1, 0, 0, 1}, 6, false},
+        {"词频为 0", 1, 1, 1, {1, 0, 0}, 3, false},
+        {"条数不符", 1, 2, 1, {1, 0, 1}, 3, false},
+        {"末项文档号不符", 2, 1, 2, {1, 0, 1}, 3, false},
+        {"变长整数截断", 1, 1, 1, {1, 0, 0x80}, 3, false},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t length = 0;
+        uint8_t *bytes = AIUATestForgeSnapshot(cases[i].maxDocID, cases[i].docCount, cases[i].lastDocID,
+                                               cases[i].postings, cases[i].length, &length);
+        AIUAFullTextIndex *index = AIUAFullTextIndexDeserialize(bytes, length);
+        AIUA_CHECK_MSG((index != NULL) == cases[i].valid, "%s", cases[i].name);
+        if (index) {
+            AIUAFullTextHit *hits = NULL;
+            size_t count = AIUATestSearch(index, "ab", &hits);
+            AIUA_CHECK(count == 1 && hits[0].field < AIUAFullTextFieldCount);
+            free(hits);
+        }
+        AIUAFullTextIndexDestroy(index);
+        free(bytes);
+    }
+}
+
+int main(void) {
+    AIUATestSearchAndRoundTrip();
+    AIUATestForgedPostings();
+    return AIUATestSummary("AIUAFullTextIndex");
+}
@@ -0,0 +1,149 @@
+//
+//  AIUAHTTPSessionPoolStubBench.m
+//  AIUniversalAssistant
+//
+//  建连耗时与首 token 耗时基准：对本地 SSE 模拟服务（server.js，MOCK_UPSTREAM=1）或传入的地址依次发送流式请求
+//  - 独立会话：每个请求新建 NSURLSession（原写作器在 initWithServerURL: 中各自创建会话的做法），每次重新建连
+//  - 会话池：先 preconnectToURL:（进入写作页面时），再经 AIUAHTTPSessionPool dataTaskWithRequest:delegate: 发送
+//  建连、TLS、响应头耗时取自 NSURLSessionTaskMetrics（会话池转发），首 token 为发出请求到收到第一块数据
+//  每个请求都读完整个响应（模拟服务回显的内容很短），HTTP/1.1 中途取消会关闭连接，无法复用
+//  本地模拟服务没有 TLS，建连只有回环的 TCP 握手；传入 https 地址可测真实的握手开销
+//  任一请求失败或没有收到数据时退出码为 1
+//  只依赖 Foundation，macOS 上由 make stub-bench 启动模拟服务后运行
+//  用法：AIUAHTTPSessionPoolStubBench [服务地址，默认 http://127.0.0.1:3000/ai] [每种方式的请求数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAHTTPSessionPool.h"
+#include "AIUATestSupport.h"
+
+static const NSTimeInterval kAIUABenchTimeout = 60;
+// 预连接后等待的时间（进入页面到用户开始输入）
+static const NSTimeInterval kAIUABenchPreconnectLead = 0.5;
+
+@interface AIUABenchProbe : NSObject <NSURLSessionDataDelegate>
+@property (nonatomic, assign) double startTime;
+@property (nonatomic, assign) double firstData;
+@property (nonatomic, assign) double connect;
+@property (nonatomic, assign) double tls;
+@property (nonatomic, assign) double responseStart;
+@property (nonatomic, assign) BOOL reused;
+@property (nonatomic, assign) BOOL done;
+@property (nonatomic, strong) NSError *error;
+@end
+
+@implementation AIUABenchProbe
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    if (self.firstData == 0 && data.length > 0) {
+        self.firstData = AIUATestNow() - self.startTime;
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics {
+    NSURLSessionTaskTransactionMetrics *transaction = metrics.transactionMetrics.lastObject;
+    double (^interval)(NSDate *, NSDate *) = ^double(NSDate *start, NSDate *end) {
+        return (start && end) ? [end timeIntervalSinceDate:start] : 0;
+    };
+    self.reused = transaction.isReusedConnection;
+    self.connect = interval(transaction.connectStartDate, transaction.connectEndDate);
+    self.tls = interval(transaction.secureConnectionStartDate, transaction.secureConnectionEndDate);
+    self.responseStart = interval(transaction.fetchStartDate, transaction.responseStartDate);
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    self.error = error;
+    self.done = YES;
+}
+
+@end
+
+static NSURLRequest *AIUABenchRequest(NSURL *url, NSUInteger index) {
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    request.HTTPMethod = @"POST";
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    [request setValue:@"text/event-stream" forHTTPHeaderField:@"Accept"];
+    NSDictionary *body = @{@"model": @"deepseek-chat",
+                           @"stream": @YES,
+                           @"max_tokens": @16,
+                           @"messages": @[@{@"role": @"user", @"content": [NSString stringWithFormat:@"你好 %lu", (unsigned long)index]}]};
+    request.HTTPBody = [NSJSONSerialization dataWithJSONObject:body options:0 error:nil];
+    return request;
+}
+
+static BOOL AIUABenchWait(AIUABenchProbe *probe) {
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAIUABenchTimeout];
+    while (!probe.done && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    return probe.done;
+}
+
+static void AIUABenchPause(NSTimeInterval seconds) {
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:seconds]];
+}
+
+// 运行一种方式的全部请求，汇总一行；失败返回 NO
+static BOOL AIUABenchRun(const char *name, NSURL *url, NSUInteger requests, BOOL pooled) {
+    double connect = 0, tls = 0, responseStart = 0, firstData = 0, firstRequestData = 0;
+    NSUInteger reused = 0;
+    for (NSUInteger i = 0; i < requests; i++) {
+        AIUABenchProbe *probe = [[AIUABenchProbe alloc] init];
+        NSURLSession *session = nil;
+        NSURLSessionDataTask *task = nil;
+        if (pooled) {
+            task = [[AIUAHTTPSessionPool sharedPool] dataTaskWithRequest:AIUABenchRequest(url, i) delegate:probe];
+        } else {
+            session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                    delegate:probe
+                                               delegateQueue:[NSOperationQueue mainQueue]];
+            task = [session dataTaskWithRequest:AIUABenchRequest(url, i)];
+        }
+        probe.startTime = AIUATestNow();
+        [task resume];
+        BOOL finished = AIUABenchWait(probe);
+        [session invalidateAndCancel];
+        if (!finished || probe.error || probe.firstData == 0) {
+            fprintf(stderr, "%s 第 %lu 个请求失败：%s\n", name, (unsigned long)i,
+                    finished ? (probe.error.localizedDescription ?: @"没有收到数据").UTF8String : "超时");
+            return NO;
+        }
+        connect += probe.connect;
+        tls += probe.tls;
+        responseStart += probe.responseStart;
+        firstData += probe.firstData;
+        reused += probe.reused ? 1 : 0;
+        if (i == 0) {
+            firstRequestData = probe.firstData;
+        }
+    }
+    printf("  %-14s %4lu / %-4lu %8.2f ms %8.2f ms %8.2f ms %9.1f ms %9.1f ms\n", name,
+           (unsigned long)reused, (unsigned long)requests, connect / requests * 1e3, tls / requests * 1e3,
+           responseStart / requests * 1e3, firstRequestData * 1e3, firstData / requests * 1e3);
+    return YES;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSURL *url = [NSURL URLWithString:argc > 1 ? @(argv[1]) : @"http://127.0.0.1:3000/ai"];
+        NSUInteger requests = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 10;
+        requests = MAX(requests, (NSUInteger)1);
+        if (url.host.length == 0) {
+            fprintf(stderr, "无效的服务地址 %s\n", argc > 1 ? argv[1] : "");
+            return 1;
+        }
+
+        printf("[AIUAHTTPSessionPool] %s，每种方式 %lu 个流式请求（依次发送）\n", url.absoluteString.UTF8String, (unsigned long)requests);
+        printf("  方式           复用连接    建连平均    TLS 平均  响应头平均  首个请求首token  首token平均\n");
+        if (!AIUABenchRun("独立会话", url, requests, NO)) {
+            return 1;
+        }
+        // 进入写作页面时预连接，用户开始输入后才发出第一个请求
+        [[AIUAHTTPSessionPool sharedPool] preconnectToURL:url];
+        AIUABenchPause(kAIUABenchPreconnectLead);
+        if (!AIUABenchRun("预连接+会话池", url, requests, YES)) {
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,98 @@
+//
+//  AIUAJSONDeltaExtractorBench.c
+//  AIUniversalAssistant
+//
+//  AIUAJSONDeltaExtractor 基准：录制的 DeepSeek 流逐个 chunk 重复解析，对比
+//  - 快速路径：只定位 choices[0].delta.content，无转义时零拷贝
+//  - 通用解析：构建完整的值树（每个字符串、数组、对象都分配内存）再按 extractContentFromResponse: 查找，
+//    对应原来的 NSJSONSerialization 路径（不含创建 NSString / NSNumber 对象与自动释放的开销，是原路径耗时的下限）
+//  两者 content 不一致时退出码为 1；真机上与 NSJSONSerialization 的对比见 AIUAJSONDeltaExtractorObjCBench.m
+//  用法：AIUAJSONDeltaExtractorBench [夹具路径] [轮数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAJSONDeltaExtractor.h"
+#include "AIUAJSONReference.h"
+
+int main(int argc, char **argv) {
+    const char *fixturePath = argc > 1 ? argv[1] : "fixtures/deepseek_stream.sse";
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 2000;
+    rounds = rounds > 0 ? rounds : 1;
+    size_t length = 0;
+    uint8_t *recorded = AIUATestReadFile(fixturePath, &length);
+    if (!recorded) {
+        fprintf(stderr, "无法读取 %s\n", fixturePath);
+        return 1;
+    }
+
+    // 每个 "data: " 行即一个 chunk（跳过 [DONE]）
+    const uint8_t *chunks[1024];
+    size_t lengths[1024];
+    size_t count = 0;
+    size_t bytes = 0;
+    for (size_t start = 0; start < length && count < 1024;) {
+        const uint8_t *newline = (const uint8_t *)memchr(recorded + start, '\n', length - start);
+        size_t end = newline ? (size_t)(newline - recorded) : length;
+        if (end - start > 6 && memcmp(recorded + start, "data: ", 6) == 0 && memcmp(recorded + start + 6, "[DONE]", 6) != 0) {
+            chunks[count] = recorded + start + 6;
+            lengths[count] = end - start - 6;
+            bytes += lengths[count];
+            count++;
+        }
+        start = end + 1;
+    }
+
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+    for (size_t i = 0; i < count; i++) {
+        AIUARefJSONValue root;
+        const uint8_t *content = NULL;
+        size_t contentLength = 0;
+        AIUAJSONDeltaResult expected = AIUARefJSONExtract(chunks[i], lengths[i], &root, &content, &contentLength);
+        AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorExtract(&extractor, chunks[i], lengths[i]);
+        bool same = result == expected && extractor.contentLength == contentLength &&
+                    (contentLength == 0 || memcmp(extractor.content, content, contentLength) == 0);
+        AIUARefJSONFree(&root);
+        if (!same) {
+            fprintf(stderr, "第 %zu 个 chunk 两种方式结果不一致\n", i);
+            return 1;
+        }
+    }
+
+    double best[2] = {1e9, 1e9};
+    volatile size_t sink = 0;
+    for (size_t attempt = 0; attempt < 5; attempt++) {
+        double start = AIUATestNow();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < count; i++) {
+                AIUAJSONDeltaExtractorExtract(&extractor, chunks[i], lengths[i]);
+                sink += extractor.contentLength;
+            }
+        }
+        double fast = AIUATestNow() - start;
+        start = AIUATestNow();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < count; i++) {
+                AIUARefJSONValue root;
+                const uint8_t *content = NULL;
+                size_t contentLength = 0;
+                AIUARefJSONExtract(chunks[i], lengths[i], &root, &content, &contentLength);
+                sink += contentLength;
+                AIUARefJSONFree(&root);
+            }
+        }
+        double tree = AIUATestNow() - start;
+        best[0] = fast < best[0] ? fast : best[0];
+        best[1] = tree < best[1] ? tree : best[1];
+    }
+
+    double parsed = (double)(rounds * count);
+    double megabytes = (double)(rounds * bytes) / (1024.0 * 1024.0);
+    printf("[AIUAJSONDeltaExtractor] %zu 个 chunk（平均 %zu 字节）× %zu 轮，5 次取最快\n", count, count > 0 ? bytes / count : 0, rounds);
+    printf("  快速路径   %8.1f ns/chunk   %8.1f MB/s\n", best[0] * 1e9 / parsed, megabytes / best[0]);
+    printf("  通用解析   %8.1f ns/chunk   %8.1f MB/s\n", best[1] * 1e9 / parsed, megabytes / best[1]);
+    printf("  加速比     %8.1fx\n", best[1] / best[0]);
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+    free(recorded);
+    return 0;
+}
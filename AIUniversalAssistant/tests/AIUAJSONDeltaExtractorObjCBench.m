@@ -0,0 +1,113 @@
+//
+//  AIUAJSONDeltaExtractorObjCBench.m
+//  AIUniversalAssistant
+//
+//  processStreamJSONBytes: 快速路径与原 NSJSONSerialization 路径的对照基准，输入为录制的 DeepSeek 流中的 chunk
+//  - 快速路径：AIUAJSONDeltaExtractorExtract + initWithBytes:length:encoding: 生成 NSString
+//  - 原路径：NSJSONSerialization 构建 NSDictionary 后按 extractContentFromResponse: 取 content
+//  逐个 chunk 核对两者的 content，不一致时退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAJSONDeltaExtractorObjCBench [夹具路径] [轮数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAJSONDeltaExtractor.h"
+#include "AIUATestSupport.h"
+
+// 与 AIUADeepSeekWriter 的 extractContentFromResponse: 相同
+static NSString *AIUABenchExtractContent(NSDictionary *response) {
+    NSArray *choices = response[@"choices"];
+    if (choices && [choices isKindOfClass:[NSArray class]] && choices.count > 0) {
+        NSDictionary *firstChoice = choices[0];
+        NSDictionary *message = firstChoice[@"message"];
+        if (message && [message isKindOfClass:[NSDictionary class]]) {
+            return message[@"content"];
+        }
+        NSDictionary *delta = firstChoice[@"delta"];
+        if (delta && [delta isKindOfClass:[NSDictionary class]]) {
+            return delta[@"content"];
+        }
+    }
+    return nil;
+}
+
+static NSString *AIUABenchOriginal(NSData *chunk) {
+    NSDictionary *response = [NSJSONSerialization JSONObjectWithData:chunk options:0 error:NULL];
+    NSString *content = response ? AIUABenchExtractContent(response) : nil;
+    return [content isKindOfClass:[NSString class]] ? content : nil;
+}
+
+static NSString *AIUABenchFastPath(AIUAJSONDeltaExtractor *extractor, NSData *chunk) {
+    AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorExtract(extractor, chunk.bytes, chunk.length);
+    if (result == AIUAJSONDeltaResultContent) {
+        return [[NSString alloc] initWithBytes:extractor->content length:extractor->contentLength encoding:NSUTF8StringEncoding];
+    }
+    return result == AIUAJSONDeltaResultNoContent ? nil : AIUABenchOriginal(chunk);
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSString *fixturePath = argc > 1 ? @(argv[1]) : @"fixtures/deepseek_stream.sse";
+        NSUInteger rounds = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 500;
+        rounds = MAX(rounds, (NSUInteger)1);
+        NSString *recorded = [NSString stringWithContentsOfFile:fixturePath encoding:NSUTF8StringEncoding error:NULL];
+        if (!recorded) {
+            fprintf(stderr, "无法读取 %s\n", fixturePath.UTF8String);
+            return 1;
+        }
+        NSMutableArray<NSData *> *chunks = [NSMutableArray array];
+        NSUInteger bytes = 0;
+        for (NSString *line in [recorded componentsSeparatedByString:@"\n"]) {
+            if ([line hasPrefix:@"data: "] && ![line isEqualToString:@"data: [DONE]"]) {
+                NSData *chunk = [[line substringFromIndex:6] dataUsingEncoding:NSUTF8StringEncoding];
+                [chunks addObject:chunk];
+                bytes += chunk.length;
+            }
+        }
+
+        AIUAJSONDeltaExtractor extractor;
+        AIUAJSONDeltaExtractorInit(&extractor);
+        for (NSUInteger i = 0; i < chunks.count; i++) {
+            NSString *original = AIUABenchOriginal(chunks[i]);
+            NSString *fast = AIUABenchFastPath(&extractor, chunks[i]);
+            if (!(original == fast || [original isEqualToString:fast])) {
+                fprintf(stderr, "第 %lu 个 chunk 两种方式结果不一致\n", (unsigned long)i);
+                return 1;
+            }
+        }
+
+        double best[2] = {1e9, 1e9};
+        for (NSUInteger attempt = 0; attempt < 5; attempt++) {
+            double start = AIUATestNow();
+            for (NSUInteger r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    for (NSData *chunk in chunks) {
+                        (void)AIUABenchFastPath(&extractor, chunk);
+                    }
+                }
+            }
+            double fast = AIUATestNow() - start;
+            start = AIUATestNow();
+            for (NSUInteger r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    for (NSData *chunk in chunks) {
+                        (void)AIUABenchOriginal(chunk);
+                    }
+                }
+            }
+            double original = AIUATestNow() - start;
+            best[0] = MIN(best[0], fast);
+            best[1] = MIN(best[1], original);
+        }
+
+        double parsed = (double)(rounds * chunks.count);
+        double megabytes = (double)(rounds * bytes) / (1024.0 * 1024.0);
+        printf("[processStreamJSONBytes:] %lu 个 chunk × %lu 轮，5 次取最快，回退 %llu 次\n",
+               (unsigned long)chunks.count, (unsigned long)rounds, (unsigned long long)extractor.totalFallbacks);
+        printf("  快速路径              %8.1f ns/chunk   %8.1f MB/s\n", best[0] * 1e9 / parsed, megabytes / best[0]);
+        printf("  NSJSONSerialization   %8.1f ns/chunk   %8.1f MB/s\n", best[1] * 1e9 / parsed, megabytes / best[1]);
+        printf("  加速比                %8.1fx\n", best[1] / best[0]);
+        AIUAJSONDeltaExtractorDestroy(&extractor);
+    }
+    return 0;
+}
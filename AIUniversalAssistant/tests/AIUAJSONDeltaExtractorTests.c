@@ -0,0 +1,442 @@
+//
+//  AIUAJSONDeltaExtractorTests.c
+//  AIUniversalAssistant
+//
+//  AIUAJSONDeltaExtractor 测试：录制的 DeepSeek 流逐个 chunk 与通用解析（AIUAJSONReference.h，对应原 NSJSONSerialization 路径）对照，
+//  要求全部走快速路径且 content 逐字节一致；另覆盖 \uXXXX 与代理对解码、零拷贝区间、需要回退的非预期结构、
+//  对录制 chunk 随机截断/变异后的差分（快速路径给出结果时必须与通用解析一致），以及内存分配失败
+//  提取器以 -Drealloc=AIUATestRealloc 编译，用于注入分配失败
+//  用法：AIUAJSONDeltaExtractorTests fixtures/deepseek_stream.sse [随机用例数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAJSONDeltaExtractor.h"
+#include "AIUAJSONReference.h"
+
+#pragma mark - 分配失败注入
+
+static long AIUATestReallocFailAfter = -1;   // 再成功多少次后失败，-1 表示不失败
+
+void *AIUATestRealloc(void *pointer, size_t size);
+void *AIUATestRealloc(void *pointer, size_t size) {
+    if (AIUATestReallocFailAfter == 0) {
+        return NULL;
+    }
+    if (AIUATestReallocFailAfter > 0) {
+        AIUATestReallocFailAfter--;
+    }
+    return realloc(pointer, size);
+}
+
+#pragma mark - 工具
+
+typedef struct {
+    const uint8_t **data;
+    size_t *lengths;
+    size_t count;
+} AIUATestChunks;
+
+// 取出录制流中每个 "data: " 行的 JSON（跳过注释与 [DONE]），区间指向 recorded 内部
+static AIUATestChunks AIUATestLoadChunks(const uint8_t *recorded, size_t length) {
+    AIUATestChunks chunks = {0};
+    chunks.data = (const uint8_t **)malloc((length / 8 + 1) * sizeof(uint8_t *));
+    chunks.lengths = (size_t *)malloc((length / 8 + 1) * sizeof(size_t));
+    size_t start = 0;
+    while (start < length) {
+        const uint8_t *newline = (const uint8_t *)memchr(recorded + start, '\n', length - start);
+        size_t end = newline ? (size_t)(newline - recorded) : length;
+        size_t lineEnd = end > start && recorded[end - 1] == '\r' ? end - 1 : end;
+        if (lineEnd - start > 6 && memcmp(recorded + start, "data: ", 6) == 0 &&
+            !(lineEnd - start == 12 && memcmp(recorded + start + 6, "[DONE]", 6) == 0)) {
+            chunks.data[chunks.count] = recorded + start + 6;
+            chunks.lengths[chunks.count] = lineEnd - start - 6;
+            chunks.count++;
+        }
+        start = end + 1;
+    }
+    return chunks;
+}
+
+// 提取结果与通用解析对照；requireFastPath 为 false 时允许提取器回退（结果为 Unexpected）
+static void AIUATestCompare(AIUAJSONDeltaExtractor *extractor, const uint8_t *json, size_t length, bool requireFastPath) {
+    AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorExtract(extractor, json, length);
+    if (result == AIUAJSONDeltaResultUnexpected && !requireFastPath) {
+        AIUA_CHECK(extractor->content == NULL && extractor->contentLength == 0);
+        return;
+    }
+    AIUARefJSONValue root;
+    const uint8_t *content = NULL;
+    size_t contentLength = 0;
+    AIUAJSONDeltaResult expected = AIUARefJSONExtract(json, length, &root, &content, &contentLength);
+    AIUA_CHECK_MSG(result == expected, "结果 %d，通用解析 %d：%.*s", (int)result, (int)expected, (int)length, (const char *)json);
+    if (result == AIUAJSONDeltaResultContent && expected == AIUAJSONDeltaResultContent) {
+        AIUA_CHECK_MSG(extractor->contentLength == contentLength &&
+                       (contentLength == 0 || memcmp(extractor->content, content, contentLength) == 0),
+                       "content 不一致：%.*s", (int)length, (const char *)json);
+        // 结果只可能引用输入或解码缓冲区
+        bool inInput = extractor->content >= json && extractor->content + extractor->contentLength <= json + length;
+        bool inBuffer = extractor->content >= extractor->buffer &&
+                        extractor->content + extractor->contentLength <= extractor->buffer + extractor->bufferCapacity;
+        AIUA_CHECK(inInput || inBuffer);
+    }
+    AIUARefJSONFree(&root);
+}
+
+static AIUAJSONDeltaResult AIUATestExtract(AIUAJSONDeltaExtractor *extractor, const char *json) {
+    return AIUAJSONDeltaExtractorExtract(extractor, (const uint8_t *)json, strlen(json));
+}
+
+#pragma mark - 录制流
+
+static void AIUATestRecordedStream(const char *fixturePath) {
+    size_t length = 0;
+    uint8_t *recorded = AIUATestReadFile(fixturePath, &length);
+    AIUA_CHECK_MSG(recorded != NULL, "无法读取 %s", fixturePath);
+    if (!recorded) {
+        return;
+    }
+    AIUATestChunks chunks = AIUATestLoadChunks(recorded, length);
+    AIUA_CHECK(chunks.count > 50);
+
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+    AIUATestBuffer text = {0};
+    AIUATestBuffer expectedText = {0};
+    size_t zeroCopy = 0;
+    for (size_t i = 0; i < chunks.count; i++) {
+        AIUATestCompare(&extractor, chunks.data[i], chunks.lengths[i], true);
+        AIUAJSONDeltaResult result = AIUAJSONDeltaExtractorExtract(&extractor, chunks.data[i], chunks.lengths[i]);
+        if (result == AIUAJSONDeltaResultContent) {
+            AIUATestBufferAppend(&text, extractor.content, extractor.contentLength);
+            zeroCopy += extractor.content >= chunks.data[i] && extractor.content < chunks.data[i] + chunks.lengths[i];
+        }
+        AIUARefJSONValue root;
+        const uint8_t *content = NULL;
+        size_t contentLength = 0;
+        if (AIUARefJSONExtract(chunks.data[i], chunks.lengths[i], &root, &content, &contentLength) == AIUAJSONDeltaResultContent) {
+            AIUATestBufferAppend(&expectedText, content, contentLength);
+        }
+        AIUARefJSONFree(&root);
+    }
+    // 录制流中没有需要回退的 chunk，含转义（\n、\"）的 chunk 走解码缓冲区，其余零拷贝
+    AIUA_CHECK(extractor.totalFallbacks == 0);
+    AIUA_CHECK(extractor.totalFastPathHits == 2 * chunks.count);
+    AIUA_CHECK(zeroCopy > 0 && zeroCopy < chunks.count);
+    AIUA_CHECK(text.length == expectedText.length && text.length > 0 && memcmp(text.bytes, expectedText.bytes, text.length) == 0);
+
+    AIUATestBufferFree(&text);
+    AIUATestBufferFree(&expectedText);
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+    free(chunks.data);
+    free(chunks.lengths);
+    free(recorded);
+}
+
+#pragma mark - 转义解码
+
+static void AIUATestEscapes(void) {
+    struct {
+        const char *json;
+        const char *expected;
+        size_t expectedLength;
+    } cases[] = {
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\u4e2d\\u6587\"}}]}", "\xE4\xB8\xAD\xE6\x96\x87", 6},
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\ude00\"}}]}", "\xF0\x9F\x98\x80", 4},
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\uD83D\\uDE00!\"}}]}", "\xF0\x9F\x98\x80!", 5},
+        {"{\"choices\":[{\"delta\":{\"content\":\"a\\ud83d\\udc4d\\ud83c\\udffdb\"}}]}", "a\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD" "b", 10},
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\u00e9\\u0041\\u007f\"}}]}", "\xC3\xA9" "A\x7F", 4},
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\u0000x\"}}]}", "\0x", 2},
+        {"{\"choices\":[{\"delta\":{\"content\":\"a\\nb\\\"c\\\\d\\/e\\bf\\fg\\th\\r\"}}]}", "a\nb\"c\\d/e\bf\fg\th\r", 16},
+        {"{\"choices\":[{\"delta\":{\"content\":\"中\\n文\\ud83d\\ude00\"}}]}", "\xE4\xB8\xAD\n\xE6\x96\x87\xF0\x9F\x98\x80", 11},
+        {"{\"choices\":[{\"delta\":{\"content\":\"\\\\u4e2d\"}}]}", "\\u4e2d", 6},
+    };
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        AIUA_CHECK_MSG(AIUATestExtract(&extractor, cases[i].json) == AIUAJSONDeltaResultContent, "%s", cases[i].json);
+        AIUA_CHECK_MSG(extractor.contentLength == cases[i].expectedLength &&
+                       memcmp(extractor.content, cases[i].expected, cases[i].expectedLength) == 0, "%s", cases[i].json);
+        // 含转义时结果在解码缓冲区中
+        AIUA_CHECK(extractor.content == extractor.buffer);
+        AIUATestCompare(&extractor, (const uint8_t *)cases[i].json, strlen(cases[i].json), true);
+    }
+
+    // 无转义时直接引用输入，不分配缓冲区
+    AIUAJSONDeltaExtractor plain;
+    AIUAJSONDeltaExtractorInit(&plain);
+    const char *json = "{\"choices\":[{\"delta\":{\"content\":\"你好 world\"}}]}";
+    AIUA_CHECK(AIUATestExtract(&plain, json) == AIUAJSONDeltaResultContent);
+    AIUA_CHECK(plain.content == (const uint8_t *)strstr(json, "你好") && plain.contentLength == strlen("你好 world"));
+    AIUA_CHECK(plain.buffer == NULL);
+    AIUA_CHECK(AIUATestExtract(&plain, "{\"choices\":[{\"delta\":{\"content\":\"\"}}]}") == AIUAJSONDeltaResultContent);
+    AIUA_CHECK(plain.contentLength == 0);
+    AIUAJSONDeltaExtractorDestroy(&plain);
+
+    // 长转义串撑大缓冲区后仍可复用
+    AIUATestBuffer big = {0};
+    AIUATestBufferAppendString(&big, "{\"choices\":[{\"delta\":{\"content\":\"");
+    for (int i = 0; i < 4000; i++) {
+        AIUATestBufferAppendString(&big, i % 2 ? "\\ud83d\\ude00" : "\\u4e2d");
+    }
+    AIUATestBufferAppendString(&big, "\"}}]}");
+    AIUA_CHECK(AIUAJSONDeltaExtractorExtract(&extractor, big.bytes, big.length) == AIUAJSONDeltaResultContent);
+    AIUA_CHECK(extractor.contentLength == 2000 * 4 + 2000 * 3);
+    AIUATestCompare(&extractor, big.bytes, big.length, true);
+    AIUATestBufferFree(&big);
+    AIUA_CHECK(AIUATestExtract(&extractor, cases[0].json) == AIUAJSONDeltaResultContent && extractor.contentLength == 6);
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+}
+
+#pragma mark - 结构
+
+static void AIUATestShapes(void) {
+    // 需要回退到通用解析的输入
+    const char *unexpected[] = {
+        // 未配对的代理项（content 中与其他字段中都一样）
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83dx\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\u0041\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\ud83d\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ude00\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\n\"}}]}",
+        "{\"id\":\"\\ud83d\",\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"},\"x\":\"\\udc00\"}]}",
+        // 非法转义
+        "{\"choices\":[{\"delta\":{\"content\":\"\\u4e2\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\x41\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\ude0g\"}}]}",
+        // content 不是字符串
+        "{\"choices\":[{\"delta\":{\"content\":1}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":[\"a\"]}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":{\"text\":\"a\"}}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":true}}]}",
+        "{\"choices\":[{\"message\":{\"content\":false},\"delta\":{\"content\":\"a\"}}]}",
+        // choices[0] 不是对象、含转义的 key
+        "{\"choices\":[\"a\"]}",
+        "{\"choices\":[null,{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"choi\\u0063es\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"choices\":[{\"d\\u0065lta\":{\"content\":\"a\"}}]}",
+        // 不合法的 JSON
+        "",
+        "   ",
+        "[]",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}}]}x",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}}]}}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}}]",
+        "{\"choices\":[{\"delta\":{\"content\":\"a",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"},}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}},]}",
+        "{\"choices\":[{\"delta\":{\"content\" \"a\"}}]}",
+        "{\"index\":01,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"index\":1.,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"index\":-,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"index\":1e,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"index\":tru,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{\"index\":NaN,\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+        "{'choices':[{'delta':{'content':'a'}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\tb\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\nb\"}}]}",
+        // 非法 UTF-8：过长编码、代理项编码、超出范围、截断的序列、孤立的续字节
+        "{\"choices\":[{\"delta\":{\"content\":\"\xC0\x80\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\xE0\x80\x80\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\xED\xA0\x80\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\xF4\x90\x80\x80\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\xF5\x80\x80\x80\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\xE4\xB8\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"\x80\"}}]}",
+        "{\"model\":\"\xFF\",\"choices\":[{\"delta\":{\"content\":\"a\"}}]}",
+    };
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+    for (size_t i = 0; i < sizeof(unexpected) / sizeof(unexpected[0]); i++) {
+        AIUA_CHECK_MSG(AIUATestExtract(&extractor, unexpected[i]) == AIUAJSONDeltaResultUnexpected, "%s", unexpected[i]);
+        AIUA_CHECK(extractor.content == NULL && extractor.contentLength == 0);
+    }
+    AIUA_CHECK(extractor.totalFallbacks == sizeof(unexpected) / sizeof(unexpected[0]));
+    AIUA_CHECK(AIUAJSONDeltaExtractorExtract(&extractor, NULL, 0) == AIUAJSONDeltaResultUnexpected);
+
+    // 嵌套过深的无关字段回退，通用解析仍能得到 content
+    AIUATestBuffer deep = {0};
+    AIUATestBufferAppendString(&deep, "{\"extra\":");
+    for (int i = 0; i < 80; i++) {
+        AIUATestBufferAppendString(&deep, "[");
+    }
+    for (int i = 0; i < 80; i++) {
+        AIUATestBufferAppendString(&deep, "]");
+    }
+    AIUATestBufferAppendString(&deep, ",\"choices\":[{\"delta\":{\"content\":\"a\"}}]}");
+    AIUA_CHECK(AIUAJSONDeltaExtractorExtract(&extractor, deep.bytes, deep.length) == AIUAJSONDeltaResultUnexpected);
+    AIUARefJSONValue root;
+    const uint8_t *content = NULL;
+    size_t contentLength = 0;
+    AIUA_CHECK(AIUARefJSONExtract(deep.bytes, deep.length, &root, &content, &contentLength) == AIUAJSONDeltaResultContent);
+    AIUARefJSONFree(&root);
+    AIUATestBufferFree(&deep);
+
+    // 结构正常但没有 content
+    const char *noContent[] = {
+        "{}",
+        "{\"choices\":[]}",
+        "{\"choices\":{}}",
+        "{\"choices\":null}",
+        "{\"choices\":[{}]}",
+        "{\"choices\":[{\"delta\":{}}]}",
+        "{\"choices\":[{\"delta\":{\"role\":\"assistant\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":null}}]}",
+        "{\"choices\":[{\"delta\":\"a\"}]}",
+        "{\"choices\":[{\"index\":0,\"delta\":{},\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":10}}",
+        // message 为对象时优先，即使没有 content 也不再看 delta
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\"},\"delta\":{\"content\":\"a\"}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"},\"message\":{\"content\":null}}]}",
+        // 重复 key 以最后一次为准
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}}],\"choices\":[]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"}}],\"choices\":1}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\"},\"delta\":{}}]}",
+        "{\"choices\":[{\"delta\":{\"content\":\"a\",\"content\":null}}]}",
+    };
+    for (size_t i = 0; i < sizeof(noContent) / sizeof(noContent[0]); i++) {
+        AIUA_CHECK_MSG(AIUATestExtract(&extractor, noContent[i]) == AIUAJSONDeltaResultNoContent, "%s", noContent[i]);
+        AIUATestCompare(&extractor, (const uint8_t *)noContent[i], strlen(noContent[i]), true);
+    }
+
+    // 取到 content 的结构变体
+    struct {
+        const char *json;
+        const char *expected;
+    } contentCases[] = {
+        {" \r\n\t{ \"choices\" : [ { \"delta\" : { \"content\" : \"a\" } } ] } \n", "a"},
+        {"{\"choices\":[{\"message\":{\"content\":\"m\"},\"delta\":{\"content\":\"d\"}}]}", "m"},
+        {"{\"choices\":[{\"delta\":{\"content\":\"d\"},\"message\":{\"content\":\"m\"}}]}", "m"},
+        {"{\"choices\":[{\"message\":\"m\",\"delta\":{\"content\":\"d\"}}]}", "d"},
+        {"{\"choices\":[{\"message\":{\"content\":\"m\"},\"message\":null,\"delta\":{\"content\":\"d\"}}]}", "d"},
+        {"{\"choices\":[{\"delta\":{\"content\":\"a\"},\"delta\":{\"content\":\"b\"}}]}", "b"},
+        {"{\"choices\":[{\"delta\":{\"content\":null,\"content\":\"b\"}}]}", "b"},
+        {"{\"choices\":[],\"choices\":[{\"delta\":{\"content\":\"b\"}}]}", "b"},
+        {"{\"choices\":[{\"delta\":{\"content\":\"a\"}},{\"delta\":{\"content\":\"b\"}},7,[\"x\"]]}", "a"},
+        {"{\"a\":[1,-2.5e+3,0.0,true,false,null,{\"b\":[{}]}],\"choices\":[{\"logprobs\":{\"c\":[[]]},\"delta\":{\"content\":\"x\"}}]}", "x"},
+        {"{\"choices\":[{\"delta\":{\"tool_calls\":[{\"content\":\"no\"}],\"content\":\"yes\"}}]}", "yes"},
+    };
+    for (size_t i = 0; i < sizeof(contentCases) / sizeof(contentCases[0]); i++) {
+        const char *expected = contentCases[i].expected;
+        AIUA_CHECK_MSG(AIUATestExtract(&extractor, contentCases[i].json) == AIUAJSONDeltaResultContent, "%s", contentCases[i].json);
+        AIUA_CHECK_MSG(extractor.contentLength == strlen(expected) && memcmp(extractor.content, expected, strlen(expected)) == 0,
+                       "%s", contentCases[i].json);
+        AIUATestCompare(&extractor, (const uint8_t *)contentCases[i].json, strlen(contentCases[i].json), true);
+    }
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+}
+
+#pragma mark - 随机差分
+
+// 变异时插入的片段：结构字符、转义、代理项、非法字节
+static const char *const kAIUATestFragments[] = {
+    "{", "}", "[", "]", "\"", ":", ",", "\\", "\\\"", "\\n", "\\u", "\\ud83d", "\\ude00", "\\ud83d\\ude00", "\\u4e2d",
+    "0", "01", "-", "1e5", "null", "true", " ", "\n", "\t", "\x01", "\x80", "\xC3", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80",
+    "\"content\":", "\"delta\":{", "\"message\":{", "\"choices\":[", "\"content\":\"x\"",
+};
+
+static void AIUATestRandomDifferential(const char *fixturePath, size_t rounds) {
+    size_t length = 0;
+    uint8_t *recorded = AIUATestReadFile(fixturePath, &length);
+    if (!recorded) {
+        return;
+    }
+    AIUATestChunks chunks = AIUATestLoadChunks(recorded, length);
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 2);
+    AIUATestBuffer mutated = {0};
+    size_t fragmentCount = sizeof(kAIUATestFragments) / sizeof(kAIUATestFragments[0]);
+    for (size_t round = 0; round < rounds && chunks.count > 0; round++) {
+        size_t pick = AIUATestRandomBelow(&random, chunks.count);
+        mutated.length = 0;
+        AIUATestBufferAppend(&mutated, chunks.data[pick], chunks.lengths[pick]);
+        size_t mutations = 1 + AIUATestRandomBelow(&random, 3);
+        for (size_t m = 0; m < mutations && mutated.length > 0; m++) {
+            size_t at = AIUATestRandomBelow(&random, mutated.length + 1);
+            switch (AIUATestRandomBelow(&random, 4)) {
+                case 0:   // 截断
+                    mutated.length = at;
+                    break;
+                case 1:   // 删除一段
+                    if (at < mutated.length) {
+                        size_t count = 1 + AIUATestRandomBelow(&random, mutated.length - at < 8 ? mutated.length - at : 8);
+                        memmove(mutated.bytes + at, mutated.bytes + at + count, mutated.length - at - count);
+                        mutated.length -= count;
+                    }
+                    break;
+                case 2:   // 替换一个字节
+                    if (at < mutated.length) {
+                        mutated.bytes[at] = (uint8_t)AIUATestRandomBelow(&random, 256);
+                    }
+                    break;
+                default: {   // 插入片段
+                    const char *fragment = kAIUATestFragments[AIUATestRandomBelow(&random, fragmentCount)];
+                    size_t fragmentLength = strlen(fragment);
+                    size_t tail = mutated.length - at;
+                    AIUATestBufferAppend(&mutated, fragment, fragmentLength);
+                    memmove(mutated.bytes + at + fragmentLength, mutated.bytes + at, tail);
+                    memcpy(mutated.bytes + at, fragment, fragmentLength);
+                    break;
+                }
+            }
+        }
+        AIUATestCompare(&extractor, mutated.bytes, mutated.length, false);
+    }
+    // 变异后仍有相当一部分走快速路径，差分才有意义
+    AIUA_CHECK(extractor.totalFastPathHits > rounds / 10);
+    AIUA_CHECK(extractor.totalFallbacks > rounds / 10);
+    AIUATestBufferFree(&mutated);
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+    free(chunks.data);
+    free(chunks.lengths);
+    free(recorded);
+}
+
+#pragma mark - 内存分配失败
+
+static void AIUATestAllocationFailure(void) {
+    const char *escaped = "{\"choices\":[{\"delta\":{\"content\":\"\\ud83d\\ude00\"}}]}";
+    const char *plain = "{\"choices\":[{\"delta\":{\"content\":\"ok\"}}]}";
+    AIUAJSONDeltaExtractor extractor;
+    AIUAJSONDeltaExtractorInit(&extractor);
+
+    // 解码缓冲区分配失败时回退，由通用解析处理；无转义的 content 不需要分配
+    AIUATestReallocFailAfter = 0;
+    AIUA_CHECK(AIUATestExtract(&extractor, escaped) == AIUAJSONDeltaResultUnexpected);
+    AIUA_CHECK(extractor.content == NULL && extractor.buffer == NULL);
+    AIUA_CHECK(AIUATestExtract(&extractor, plain) == AIUAJSONDeltaResultContent && extractor.contentLength == 2);
+    AIUATestReallocFailAfter = -1;
+    AIUA_CHECK(AIUATestExtract(&extractor, escaped) == AIUAJSONDeltaResultContent && extractor.contentLength == 4);
+
+    // 扩容失败时保留原缓冲区，之后的小 chunk 照常解码
+    AIUATestBuffer big = {0};
+    AIUATestBufferAppendString(&big, "{\"choices\":[{\"delta\":{\"content\":\"");
+    for (int i = 0; i < 1000; i++) {
+        AIUATestBufferAppendString(&big, "\\n");
+    }
+    AIUATestBufferAppendString(&big, "\"}}]}");
+    uint8_t *before = extractor.buffer;
+    size_t capacity = extractor.bufferCapacity;
+    AIUATestReallocFailAfter = 0;
+    AIUA_CHECK(AIUAJSONDeltaExtractorExtract(&extractor, big.bytes, big.length) == AIUAJSONDeltaResultUnexpected);
+    AIUA_CHECK(extractor.buffer == before && extractor.bufferCapacity == capacity);
+    AIUA_CHECK(AIUATestExtract(&extractor, escaped) == AIUAJSONDeltaResultContent && extractor.contentLength == 4);
+    AIUATestReallocFailAfter = -1;
+    AIUA_CHECK(AIUAJSONDeltaExtractorExtract(&extractor, big.bytes, big.length) == AIUAJSONDeltaResultContent);
+    AIUA_CHECK(extractor.contentLength == 1000);
+    AIUATestBufferFree(&big);
+    AIUAJSONDeltaExtractorDestroy(&extractor);
+}
+
+int main(int argc, char **argv) {
+    const char *fixturePath = argc > 1 ? argv[1] : "fixtures/deepseek_stream.sse";
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 200000;
+    AIUATestRecordedStream(fixturePath);
+    AIUATestEscapes();
+    AIUATestShapes();
+    AIUATestRandomDifferential(fixturePath, rounds);
+    AIUATestAllocationFailure();
+    return AIUATestSummary("AIUAJSONDeltaExtractor");
+}
@@ -0,0 +1,385 @@
+//
+//  AIUAJSONReference.h
+//  AIUniversalAssistant
+//
+//  通用 JSON 解析（先构建完整的值树，再按 extractContentFromResponse: 的规则查找 content），
+//  对应流式 chunk 原来走的 NSJSONSerialization 路径，供 AIUAJSONDeltaExtractor 的差分测试与基准对照
+//  严格按 RFC 8259：字符串逐个解码（含 \uXXXX 代理对，拒绝未配对的代理项与非法 UTF-8），数字不允许前导 0，
+//  顶层必须是对象或数组（与 options:0 一致），重复 key 以最后一次为准
+//
+
+#ifndef AIUAJSONReference_h
+#define AIUAJSONReference_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AIUAJSONDeltaExtractor.h"
+
+// 嵌套深度上限，远大于提取器的 64，深层但合法的 chunk 由提取器回退、由这里解析
+#define AIUA_REF_JSON_MAX_DEPTH 512
+
+typedef enum {
+    AIUARefJSONNull = 0,
+    AIUARefJSONBool,
+    AIUARefJSONNumber,
+    AIUARefJSONString,
+    AIUARefJSONArray,
+    AIUARefJSONObject,
+} AIUARefJSONType;
+
+// 对象的 children 按 key、value 交替存放，key 也是字符串节点
+typedef struct AIUARefJSONValue {
+    AIUARefJSONType type;
+    uint8_t *string;               // 解码后的 UTF-8（字符串节点）
+    size_t length;
+    double number;
+    struct AIUARefJSONValue *children;
+    size_t count;
+    size_t capacity;
+} AIUARefJSONValue;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} AIUARefJSONCursor;
+
+static void AIUARefJSONFree(AIUARefJSONValue *value) {
+    for (size_t i = 0; i < value->count; i++) {
+        AIUARefJSONFree(&value->children[i]);
+    }
+    free(value->children);
+    free(value->string);
+    memset(value, 0, sizeof(*value));
+}
+
+static void AIUARefJSONSkipWhitespace(AIUARefJSONCursor *cursor) {
+    while (cursor->p < cursor->end && (*cursor->p == ' ' || *cursor->p == '\t' || *cursor->p == '\n' || *cursor->p == '\r')) {
+        cursor->p++;
+    }
+}
+
+static AIUARefJSONValue *AIUARefJSONAppendChild(AIUARefJSONValue *parent) {
+    if (parent->count == parent->capacity) {
+        parent->capacity = parent->capacity > 0 ? parent->capacity * 2 : 8;
+        parent->children = (AIUARefJSONValue *)realloc(parent->children, parent->capacity * sizeof(AIUARefJSONValue));
+    }
+    AIUARefJSONValue *child = &parent->children[parent->count++];
+    memset(child, 0, sizeof(*child));
+    return child;
+}
+
+static bool AIUARefJSONParseHex4(const uint8_t *p, const uint8_t *end, uint32_t *value) {
+    if (end - p < 4) {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t c = p[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = (uint32_t)(c - '0');
+        } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            digit = (uint32_t)((c | 0x20) - 'a' + 10);
+        } else {
+            return false;
+        }
+        *value = (*value << 4) | digit;
+    }
+    return true;
+}
+
+static void AIUARefJSONPutCodePoint(uint8_t *out, size_t *n, uint32_t cp) {
+    if (cp < 0x80) {
+        out[(*n)++] = (uint8_t)cp;
+    } else if (cp < 0x800) {
+        out[(*n)++] = (uint8_t)(0xC0 | (cp >> 6));
+        out[(*n)++] = (uint8_t)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out[(*n)++] = (uint8_t)(0xE0 | (cp >> 12));
+        out[(*n)++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        out[(*n)++] = (uint8_t)(0x80 | (cp & 0x3F));
+    } else {
+        out[(*n)++] = (uint8_t)(0xF0 | (cp >> 18));
+        out[(*n)++] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+        out[(*n)++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        out[(*n)++] = (uint8_t)(0x80 | (cp & 0x3F));
+    }
+}
+
+// 逐码点解码：先把原始字节解成码点（校验 UTF-8），再统一编码输出
+static bool AIUARefJSONParseString(AIUARefJSONCursor *cursor, AIUARefJSONValue *value) {
+    if (cursor->p >= cursor->end || *cursor->p != '"') {
+        return false;
+    }
+    cursor->p++;
+    uint8_t *out = (uint8_t *)malloc((size_t)(cursor->end - cursor->p) + 1);
+    size_t n = 0;
+    while (cursor->p < cursor->end && *cursor->p != '"') {
+        uint8_t c = *cursor->p;
+        uint32_t cp;
+        if (c < 0x20) {
+            free(out);
+            return false;
+        }
+        if (c == '\\') {
+            if (cursor->end - cursor->p < 2) {
+                free(out);
+                return false;
+            }
+            uint8_t e = cursor->p[1];
+            cursor->p += 2;
+            const char *simple = strchr("\"\\/bfnrt", e);
+            if (e != 'u') {
+                if (!simple || e == '\0') {
+                    free(out);
+                    return false;
+                }
+                const char *decoded = "\"\\/\b\f\n\r\t";
+                cp = (uint8_t)decoded[simple - "\"\\/bfnrt"];
+            } else {
+                uint32_t low;
+                if (!AIUARefJSONParseHex4(cursor->p, cursor->end, &cp)) {
+                    free(out);
+                    return false;
+                }
+                cursor->p += 4;
+                if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    free(out);
+                    return false;
+                }
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (cursor->end - cursor->p < 2 || cursor->p[0] != '\\' || cursor->p[1] != 'u' ||
+                        !AIUARefJSONParseHex4(cursor->p + 2, cursor->end, &low) || low < 0xDC00 || low > 0xDFFF) {
+                        free(out);
+                        return false;
+                    }
+                    cursor->p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+            }
+        } else if (c < 0x80) {
+            cp = c;
+            cursor->p++;
+        } else {
+            size_t extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+            uint32_t minimum = extra == 3 ? 0x10000 : extra == 2 ? 0x800 : 0x80;
+            if (extra == 0 || c > 0xF4 || (size_t)(cursor->end - cursor->p) <= extra) {
+                free(out);
+                return false;
+            }
+            cp = c & (0x3F >> extra);
+            for (size_t i = 1; i <= extra; i++) {
+                if ((cursor->p[i] & 0xC0) != 0x80) {
+                    free(out);
+                    return false;
+                }
+                cp = (cp << 6) | (cursor->p[i] & 0x3F);
+            }
+            if (cp < minimum || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+                free(out);
+                return false;
+            }
+            cursor->p += extra + 1;
+        }
+        AIUARefJSONPutCodePoint(out, &n, cp);
+    }
+    if (cursor->p >= cursor->end) {
+        free(out);
+        return false;
+    }
+    cursor->p++;
+    value->type = AIUARefJSONString;
+    value->string = out;
+    value->length = n;
+    return true;
+}
+
+static bool AIUARefJSONParseNumber(AIUARefJSONCursor *cursor, AIUARefJSONValue *value) {
+    const uint8_t *start = cursor->p;
+    if (cursor->p < cursor->end && *cursor->p == '-') {
+        cursor->p++;
+    }
+    if (cursor->p >= cursor->end || *cursor->p < '0' || *cursor->p > '9') {
+        return false;
+    }
+    if (*cursor->p == '0') {
+        cursor->p++;
+    } else {
+        while (cursor->p < cursor->end && *cursor->p >= '0' && *cursor->p <= '9') {
+            cursor->p++;
+        }
+    }
+    if (cursor->p < cursor->end && *cursor->p == '.') {
+        cursor->p++;
+        const uint8_t *digits = cursor->p;
+        while (cursor->p < cursor->end && *cursor->p >= '0' && *cursor->p <= '9') {
+            cursor->p++;
+        }
+        if (cursor->p == digits) {
+            return false;
+        }
+    }
+    if (cursor->p < cursor->end && (*cursor->p == 'e' || *cursor->p == 'E')) {
+        cursor->p++;
+        if (cursor->p < cursor->end && (*cursor->p == '+' || *cursor->p == '-')) {
+            cursor->p++;
+        }
+        const uint8_t *digits = cursor->p;
+        while (cursor->p < cursor->end && *cursor->p >= '0' && *cursor->p <= '9') {
+            cursor->p++;
+        }
+        if (cursor->p == digits) {
+            return false;
+        }
+    }
+    char text[64];
+    size_t length = (size_t)(cursor->p - start) < sizeof(text) - 1 ? (size_t)(cursor->p - start) : sizeof(text) - 1;
+    memcpy(text, start, length);
+    text[length] = '\0';
+    value->type = AIUARefJSONNumber;
+    value->number = strtod(text, NULL);
+    return true;
+}
+
+static bool AIUARefJSONParseValue(AIUARefJSONCursor *cursor, AIUARefJSONValue *value, int depth) {
+    AIUARefJSONSkipWhitespace(cursor);
+    if (cursor->p >= cursor->end || depth > AIUA_REF_JSON_MAX_DEPTH) {
+        return false;
+    }
+    uint8_t c = *cursor->p;
+    if (c == '{' || c == '[') {
+        bool isObject = c == '{';
+        uint8_t close = isObject ? '}' : ']';
+        value->type = isObject ? AIUARefJSONObject : AIUARefJSONArray;
+        cursor->p++;
+        AIUARefJSONSkipWhitespace(cursor);
+        if (cursor->p < cursor->end && *cursor->p == close) {
+            cursor->p++;
+            return true;
+        }
+        while (true) {
+            if (isObject) {
+                AIUARefJSONSkipWhitespace(cursor);
+                if (!AIUARefJSONParseString(cursor, AIUARefJSONAppendChild(value))) {
+                    return false;
+                }
+                AIUARefJSONSkipWhitespace(cursor);
+                if (cursor->p >= cursor->end || *cursor->p != ':') {
+                    return false;
+                }
+                cursor->p++;
+            }
+            if (!AIUARefJSONParseValue(cursor, AIUARefJSONAppendChild(value), depth + 1)) {
+                return false;
+            }
+            AIUARefJSONSkipWhitespace(cursor);
+            if (cursor->p < cursor->end && *cursor->p == ',') {
+                cursor->p++;
+                continue;
+            }
+            if (cursor->p < cursor->end && *cursor->p == close) {
+                cursor->p++;
+                return true;
+            }
+            return false;
+        }
+    }
+    if (c == '"') {
+        return AIUARefJSONParseString(cursor, value);
+    }
+    const char *literals[] = {"true", "false", "null"};
+    for (int i = 0; i < 3; i++) {
+        size_t length = strlen(literals[i]);
+        if ((size_t)(cursor->end - cursor->p) >= length && memcmp(cursor->p, literals[i], length) == 0) {
+            cursor->p += length;
+            value->type = i < 2 ? AIUARefJSONBool : AIUARefJSONNull;
+            value->number = i == 0;
+            return true;
+        }
+    }
+    return AIUARefJSONParseNumber(cursor, value);
+}
+
+/// 解析整段 JSON，失败时返回 false 且 root 已释放
+static inline bool AIUARefJSONParse(const uint8_t *json, size_t length, AIUARefJSONValue *root) {
+    memset(root, 0, sizeof(*root));
+    AIUARefJSONCursor cursor = { json, json + length };
+    AIUARefJSONSkipWhitespace(&cursor);
+    if (!json || cursor.p >= cursor.end || (*cursor.p != '{' && *cursor.p != '[')) {
+        return false;
+    }
+    bool ok = AIUARefJSONParseValue(&cursor, root, 0);
+    AIUARefJSONSkipWhitespace(&cursor);
+    if (!ok || cursor.p != cursor.end) {
+        AIUARefJSONFree(root);
+        return false;
+    }
+    return true;
+}
+
+/// 对象中 key 最后一次出现的值，没有时返回 NULL
+static inline const AIUARefJSONValue *AIUARefJSONMember(const AIUARefJSONValue *object, const char *key) {
+    size_t length = strlen(key);
+    for (size_t i = object->count; i >= 2; i -= 2) {
+        const AIUARefJSONValue *name = &object->children[i - 2];
+        if (name->length == length && memcmp(name->string, key, length) == 0) {
+            return &object->children[i - 1];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 按 extractContentFromResponse: 查找 content：choices[0].message 为对象时取其 content，否则取 choices[0].delta.content
+ * JSON 不合法、顶层不是对象、choices[0] 不是对象（原实现会抛异常）或 content 不是字符串（原实现丢弃）时返回 Unexpected
+ * 返回 Content 时 *content 指向 root 内的字节
+ */
+static inline AIUAJSONDeltaResult AIUARefJSONLookupContent(const AIUARefJSONValue *root, const uint8_t **content, size_t *contentLength) {
+    *content = NULL;
+    *contentLength = 0;
+    if (root->type != AIUARefJSONObject) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    const AIUARefJSONValue *choices = AIUARefJSONMember(root, "choices");
+    if (!choices || choices->type != AIUARefJSONArray || choices->count == 0) {
+        return AIUAJSONDeltaResultNoContent;
+    }
+    const AIUARefJSONValue *choice = &choices->children[0];
+    if (choice->type != AIUARefJSONObject) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    const AIUARefJSONValue *holder = AIUARefJSONMember(choice, "message");
+    if (!holder || holder->type != AIUARefJSONObject) {
+        holder = AIUARefJSONMember(choice, "delta");
+    }
+    if (!holder || holder->type != AIUARefJSONObject) {
+        return AIUAJSONDeltaResultNoContent;
+    }
+    const AIUARefJSONValue *value = AIUARefJSONMember(holder, "content");
+    if (!value || value->type == AIUARefJSONNull) {
+        return AIUAJSONDeltaResultNoContent;
+    }
+    if (value->type != AIUARefJSONString) {
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    *content = value->string;
+    *contentLength = value->length;
+    return AIUAJSONDeltaResultContent;
+}
+
+/// 解析加查找，即原来每个 chunk 的完整流程；root 由调用方 AIUARefJSONFree
+static inline AIUAJSONDeltaResult AIUARefJSONExtract(const uint8_t *json, size_t length, AIUARefJSONValue *root,
+                                                     const uint8_t **content, size_t *contentLength) {
+    if (!AIUARefJSONParse(json, length, root)) {
+        *content = NULL;
+        *contentLength = 0;
+        return AIUAJSONDeltaResultUnexpected;
+    }
+    return AIUARefJSONLookupContent(root, content, contentLength);
+}
+
+#endif /* AIUAJSONReference_h */
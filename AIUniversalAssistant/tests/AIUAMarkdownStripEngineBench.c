@@ -0,0 +1,131 @@
+//
+//  AIUAMarkdownStripEngineBench.c
+//  AIUniversalAssistant
+//
+//  AIUAMarkdownStripEngine 吞吐基准：合成 64 KB ~ 8 MB（UTF-16）的 Markdown 长文（标题、粗体、斜体、行内代码、链接、中文正文），
+//  对比整段输入、按 16 个码元一块流式输入（与 SSE 增量相当）和五个正则的逐条移植（AIUAMarkdownStripReference.h）
+//  移植版只做最短匹配的线性扫描，没有 NSRegularExpression 的编译与回溯开销，是原正则级联耗时的下限
+//  输出与移植版不一致时退出码为 1
+//  用法：AIUAMarkdownStripEngineBench [轮数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAMarkdownStripEngine.h"
+#include "AIUAMarkdownStripReference.h"
+
+static const size_t kAIUABenchChunk = 16;
+
+static void AIUABenchAppendASCII(AIUATestBuffer *buffer, const char *text) {
+    for (const char *p = text; *p; p++) {
+        uint16_t c = (uint16_t)(uint8_t)*p;
+        AIUATestBufferAppend(buffer, &c, sizeof(c));
+    }
+}
+
+static void AIUABenchAppendHan(AIUATestBuffer *buffer, AIUATestRandom *random, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint16_t c = i % 17 == 16 ? 0xFF0C : (uint16_t)(0x4E00 + AIUATestRandomBelow(random, 3000));
+        AIUATestBufferAppend(buffer, &c, sizeof(c));
+    }
+}
+
+// 合成约 units 个码元的文章：每节一个标题，段落中穿插粗体、斜体、代码与链接
+static uint16_t *AIUABenchArticle(size_t units, size_t *length) {
+    AIUATestBuffer buffer = {0};
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 404);
+    while (buffer.length / sizeof(uint16_t) < units) {
+        AIUABenchAppendASCII(&buffer, AIUATestRandomBelow(&random, 2) ? "## " : "### ");
+        AIUABenchAppendHan(&buffer, &random, 8);
+        AIUABenchAppendASCII(&buffer, "\n\n");
+        for (size_t paragraph = 0; paragraph < 4; paragraph++) {
+            AIUABenchAppendHan(&buffer, &random, 40 + AIUATestRandomBelow(&random, 80));
+            AIUABenchAppendASCII(&buffer, "**");
+            AIUABenchAppendHan(&buffer, &random, 6);
+            AIUABenchAppendASCII(&buffer, "**");
+            AIUABenchAppendHan(&buffer, &random, 30);
+            AIUABenchAppendASCII(&buffer, "*");
+            AIUABenchAppendHan(&buffer, &random, 4);
+            AIUABenchAppendASCII(&buffer, "* `snake_case` ");
+            AIUABenchAppendHan(&buffer, &random, 20);
+            AIUABenchAppendASCII(&buffer, " [");
+            AIUABenchAppendHan(&buffer, &random, 4);
+            AIUABenchAppendASCII(&buffer, "](https://example.com/a_b) ");
+            AIUABenchAppendHan(&buffer, &random, 60);
+            AIUABenchAppendASCII(&buffer, "\n\n");
+        }
+    }
+    *length = buffer.length / sizeof(uint16_t);
+    return (uint16_t *)buffer.bytes;
+}
+
+// 返回输出长度；chunk 为 0 时整段输入
+static size_t AIUABenchEngine(AIUAMarkdownStripEngine *engine, const uint16_t *text, size_t length, size_t chunk) {
+    AIUAMarkdownStripEngineReset(engine);
+    size_t total = 0;
+    size_t step = chunk > 0 ? chunk : length;
+    for (size_t start = 0; start < length; start += step) {
+        size_t end = start + step < length ? start + step : length;
+        AIUAMarkdownStripEngineFeed(engine, text + start, end - start);
+        if (chunk > 0) {
+            size_t produced = 0;
+            AIUAMarkdownStripEngineGetOutput(engine, &produced);
+            total += produced;
+            AIUAMarkdownStripEngineClearOutput(engine);
+        }
+    }
+    AIUAMarkdownStripEngineFinish(engine);
+    size_t produced = 0;
+    AIUAMarkdownStripEngineGetOutput(engine, &produced);
+    return total + produced;
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 5;
+    rounds = rounds > 0 ? rounds : 1;
+    const size_t sizes[] = {32 * 1024, 512 * 1024, 4 * 1024 * 1024};
+    AIUAMarkdownStripEngine *engine = AIUAMarkdownStripEngineCreate();
+    printf("[AIUAMarkdownStripEngine] 合成 Markdown 长文，每种方式 %zu 轮取最快，吞吐按 UTF-16 字节计\n", rounds);
+    printf("      大小        整段输入     流式（%zu 码元/块）      正则移植（五遍）\n", kAIUABenchChunk);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t length = 0;
+        uint16_t *text = AIUABenchArticle(sizes[s], &length);
+        double megabytes = (double)(length * sizeof(uint16_t)) / (1024.0 * 1024.0);
+
+        size_t refLength = 0;
+        uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+        AIUABenchEngine(engine, text, length, 0);
+        size_t outLength = 0;
+        const uint16_t *out = AIUAMarkdownStripEngineGetOutput(engine, &outLength);
+        if (outLength != refLength || memcmp(out, ref, refLength * sizeof(uint16_t)) != 0) {
+            fprintf(stderr, "%zu 码元的文章与正则移植输出不一致\n", length);
+            return 1;
+        }
+        if (AIUABenchEngine(engine, text, length, kAIUABenchChunk) != refLength) {
+            fprintf(stderr, "%zu 码元的文章流式输出长度不一致\n", length);
+            return 1;
+        }
+        free(ref);
+
+        double best[3] = {1e9, 1e9, 1e9};
+        for (size_t r = 0; r < rounds; r++) {
+            double start = AIUATestNow();
+            AIUABenchEngine(engine, text, length, 0);
+            double whole = AIUATestNow() - start;
+            start = AIUATestNow();
+            AIUABenchEngine(engine, text, length, kAIUABenchChunk);
+            double streamed = AIUATestNow() - start;
+            start = AIUATestNow();
+            free(AIUAMarkdownStripReference(text, length, &refLength));
+            double reference = AIUATestNow() - start;
+            best[0] = whole < best[0] ? whole : best[0];
+            best[1] = streamed < best[1] ? streamed : best[1];
+            best[2] = reference < best[2] ? reference : best[2];
+        }
+        printf("  %7.2f MB   %8.1f MB/s       %8.1f MB/s          %8.1f MB/s\n",
+               megabytes, megabytes / best[0], megabytes / best[1], megabytes / best[2]);
+        free(text);
+    }
+    AIUAMarkdownStripEngineDestroy(engine);
+    return 0;
+}
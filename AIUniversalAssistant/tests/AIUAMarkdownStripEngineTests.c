@@ -0,0 +1,282 @@
+//
+//  AIUAMarkdownStripEngineTests.c
+//  AIUniversalAssistant
+//
+//  AIUAMarkdownStripEngine 测试：与五个正则的逐条移植（AIUAMarkdownStripReference.h）做差分比对
+//  - 典型用例：粗体/斜体嵌套、未闭合的标记、标题与 \s+ 跨行、行内代码、链接回溯、行结束符（\r、U+0085、U+2028）
+//  - 流式输入："**bo" + "ld**"，以及随机文本在随机位置切分成多个 chunk 输入，结果必须与整段输入逐字一致
+//  - 随机文本：由标记符、空白、行结束符和普通字符组成，整段输入与移植的正则级联比对
+//  引擎以 -Drealloc=AIUATestRealloc 编译，用于注入分配失败：失败后 HasFailed 必须为 true，Reset 后恢复正常
+//  用法：AIUAMarkdownStripEngineTests [随机用例数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAMarkdownStripEngine.h"
+#include "AIUAMarkdownStripReference.h"
+
+#pragma mark - 分配失败注入
+
+static long AIUATestReallocFailAfter = -1;   // 再成功多少次后失败，-1 表示不失败
+
+void *AIUATestRealloc(void *pointer, size_t size);
+void *AIUATestRealloc(void *pointer, size_t size) {
+    if (AIUATestReallocFailAfter == 0) {
+        return NULL;
+    }
+    if (AIUATestReallocFailAfter > 0) {
+        AIUATestReallocFailAfter--;
+    }
+    return realloc(pointer, size);
+}
+
+#pragma mark - 工具
+
+// ASCII 转 UTF-16；'~' 代表 U+2028，'^' 代表 U+0085，'@' 代表 U+3000（全角空格），'%' 代表“中”
+static size_t AIUATestUTF16(const char *text, uint16_t *output) {
+    size_t length = 0;
+    for (const char *p = text; *p; p++) {
+        switch (*p) {
+            case '~': output[length++] = 0x2028; break;
+            case '^': output[length++] = 0x0085; break;
+            case '@': output[length++] = 0x3000; break;
+            case '%': output[length++] = 0x4E2D; break;
+            default: output[length++] = (uint16_t)(uint8_t)*p; break;
+        }
+    }
+    return length;
+}
+
+static void AIUATestPrintUTF16(const char *label, const uint16_t *characters, size_t length) {
+    fprintf(stderr, "  %s（%zu）: \"", label, length);
+    for (size_t i = 0; i < length; i++) {
+        uint16_t c = characters[i];
+        if (c >= 0x20 && c < 0x7F) {
+            fputc(c, stderr);
+        } else {
+            fprintf(stderr, "\\u%04X", c);
+        }
+    }
+    fprintf(stderr, "\"\n");
+}
+
+// 按 splits 把文本切成多个 chunk 输入，每个 chunk 之后取走输出并清空（与流式调用方一致）
+static uint16_t *AIUATestStrip(AIUAMarkdownStripEngine *engine, const uint16_t *text, size_t length,
+                               const size_t *splits, size_t splitCount, size_t *outLength) {
+    AIUATestBuffer output = {0};
+    AIUAMarkdownStripEngineReset(engine);
+    size_t start = 0;
+    for (size_t s = 0; s <= splitCount; s++) {
+        size_t end = s < splitCount ? splits[s] : length;
+        AIUAMarkdownStripEngineFeed(engine, text + start, end - start);
+        if (s == splitCount) {
+            AIUAMarkdownStripEngineFinish(engine);
+        }
+        size_t chunkLength = 0;
+        const uint16_t *chunk = AIUAMarkdownStripEngineGetOutput(engine, &chunkLength);
+        AIUATestBufferAppend(&output, chunk, chunkLength * sizeof(uint16_t));
+        AIUAMarkdownStripEngineClearOutput(engine);
+        start = end;
+    }
+    *outLength = output.length / sizeof(uint16_t);
+    return (uint16_t *)output.bytes;
+}
+
+static bool AIUATestSameUTF16(const uint16_t *a, size_t aLength, const uint16_t *b, size_t bLength) {
+    return aLength == bLength && (aLength == 0 || memcmp(a, b, aLength * sizeof(uint16_t)) == 0);
+}
+
+#pragma mark - 典型用例
+
+static void AIUATestCase(AIUAMarkdownStripEngine *engine, const char *input, const char *expected) {
+    uint16_t text[256];
+    uint16_t want[256];
+    size_t length = AIUATestUTF16(input, text);
+    size_t wantLength = AIUATestUTF16(expected, want);
+
+    size_t refLength = 0;
+    uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+    AIUA_CHECK_MSG(AIUATestSameUTF16(ref, refLength, want, wantLength), "正则移植与期望不一致：%s", input);
+
+    size_t gotLength = 0;
+    uint16_t *got = AIUATestStrip(engine, text, length, NULL, 0, &gotLength);
+    AIUA_CHECK_MSG(AIUATestSameUTF16(got, gotLength, want, wantLength), "引擎与期望不一致：%s", input);
+    if (!AIUATestSameUTF16(got, gotLength, want, wantLength)) {
+        AIUATestPrintUTF16("期望", want, wantLength);
+        AIUATestPrintUTF16("引擎", got, gotLength);
+    }
+    free(ref);
+    free(got);
+}
+
+static void AIUATestExamples(AIUAMarkdownStripEngine *engine) {
+    AIUATestCase(engine, "", "");
+    AIUATestCase(engine, "plain %%", "plain %%");
+    AIUATestCase(engine, "**bold** and __bold__", "bold and bold");
+    AIUATestCase(engine, "*it* and _it_", "it and it");
+    AIUATestCase(engine, "***both***", "both");
+    AIUATestCase(engine, "**a*b**", "a*b");               // 粗体内剩下的单个 '*' 在斜体阶段无配对
+    AIUATestCase(engine, "****", "");
+    AIUATestCase(engine, "**open", "open");               // 粗体不匹配，斜体阶段的 "**" 是一对空的斜体
+    AIUATestCase(engine, "**a\nb**", "a\nb");             // 粗体不跨行，斜体各自配对
+    AIUATestCase(engine, "*a\nb*", "*a\nb*");
+    AIUATestCase(engine, "snake_case_name", "snakecasename");
+    AIUATestCase(engine, "# Title\n## Sub\n####### seven\n#nospace", "Title\nSub\n####### seven\n#nospace");
+    AIUATestCase(engine, "#  \n\n  body", "body");       // \s+ 贪婪地跨过换行
+    AIUATestCase(engine, "a # not header", "a # not header");
+    AIUATestCase(engine, "#@%", "%");
+    AIUATestCase(engine, "x~# after LS", "x~after LS");
+    AIUATestCase(engine, "x^# after NEL", "x^after NEL");
+    AIUATestCase(engine, "x\r# after CR", "x\rafter CR");
+    AIUATestCase(engine, "use `code` here, `open", "use code here, `open");
+    AIUATestCase(engine, "`a\nb`", "`a\nb`");
+    AIUATestCase(engine, "[text](http://x) and [t2](y)", "text and t2");
+    AIUATestCase(engine, "[a](b [c](d)", "a");            // 目标部分取到第一个 ')' 为止
+    AIUATestCase(engine, "[a] [b](c)", "a] [b");          // 文字部分取到最近的 "](" 为止
+    AIUATestCase(engine, "[a](no close\n[b](c)", "[a](no close\nb");
+    AIUATestCase(engine, "[](x)", "");
+    AIUATestCase(engine, "**[`code`](u)**", "code");
+    AIUATestCase(engine, "*[a*](b)", "a");                // 斜体先移除了 '*'，链接阶段看到的是 "[a](b)"
+}
+
+#pragma mark - 流式
+
+static void AIUATestStreaming(AIUAMarkdownStripEngine *engine) {
+    uint16_t text[64];
+    size_t length = AIUATestUTF16("**bold**", text);
+    size_t split = 4;   // "**bo" + "ld**"
+    size_t gotLength = 0;
+    uint16_t *got = AIUATestStrip(engine, text, length, &split, 1, &gotLength);
+    uint16_t want[16];
+    size_t wantLength = AIUATestUTF16("bold", want);
+    AIUA_CHECK(AIUATestSameUTF16(got, gotLength, want, wantLength));
+    free(got);
+
+    // 每个码元一个 chunk
+    length = AIUATestUTF16("# **h** `c` [l](u) *i*\n**x", text);
+    size_t splits[64];
+    for (size_t i = 0; i + 1 < length; i++) {
+        splits[i] = i + 1;
+    }
+    got = AIUATestStrip(engine, text, length, splits, length - 1, &gotLength);
+    size_t refLength = 0;
+    uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+    AIUA_CHECK(AIUATestSameUTF16(got, gotLength, ref, refLength));
+    free(got);
+    free(ref);
+
+    // 已确定的内容及时输出：闭合的粗体在 Finish 之前就可以取走
+    AIUAMarkdownStripEngineReset(engine);
+    length = AIUATestUTF16("**bo", text);
+    AIUAMarkdownStripEngineFeed(engine, text, length);
+    AIUAMarkdownStripEngineGetOutput(engine, &gotLength);
+    AIUA_CHECK(gotLength == 0);
+    length = AIUATestUTF16("ld** tail", text);
+    AIUAMarkdownStripEngineFeed(engine, text, length);
+    const uint16_t *partial = AIUAMarkdownStripEngineGetOutput(engine, &gotLength);
+    wantLength = AIUATestUTF16("bold tail", want);
+    AIUA_CHECK(AIUATestSameUTF16(partial, gotLength, want, wantLength));
+}
+
+#pragma mark - 随机差分
+
+static const uint16_t AIUATestAlphabet[] = {
+    '*', '*', '*', '_', '_', '#', '#', '#', '`', '`', '[', ']', '(', ')', ' ', ' ', '\t',
+    '\n', '\n', '\r', 0x0085, 0x2028, 0x3000, 'a', 'b', 'c', 0x4E2D, 0x6587,
+};
+
+static void AIUATestRandomDifferential(AIUAMarkdownStripEngine *engine, size_t rounds) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 4);
+    uint16_t text[256];
+    size_t splits[16];
+    size_t alphabetSize = sizeof(AIUATestAlphabet) / sizeof(AIUATestAlphabet[0]);
+    size_t reported = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        size_t length = AIUATestRandomBelow(&random, round % 10 == 0 ? 256 : 48);
+        for (size_t i = 0; i < length; i++) {
+            text[i] = AIUATestAlphabet[AIUATestRandomBelow(&random, alphabetSize)];
+        }
+        size_t refLength = 0;
+        uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+        size_t wholeLength = 0;
+        uint16_t *whole = AIUATestStrip(engine, text, length, NULL, 0, &wholeLength);
+
+        // 随机切分点（有序、可重复，重复即空 chunk）
+        size_t splitCount = AIUATestRandomBelow(&random, 16);
+        for (size_t s = 0; s < splitCount; s++) {
+            splits[s] = AIUATestRandomBelow(&random, length + 1);
+        }
+        for (size_t s = 1; s < splitCount; s++) {
+            for (size_t t = s; t > 0 && splits[t - 1] > splits[t]; t--) {
+                size_t temp = splits[t];
+                splits[t] = splits[t - 1];
+                splits[t - 1] = temp;
+            }
+        }
+        size_t streamedLength = 0;
+        uint16_t *streamed = AIUATestStrip(engine, text, length, splits, splitCount, &streamedLength);
+
+        bool wholeOK = AIUATestSameUTF16(whole, wholeLength, ref, refLength);
+        bool streamedOK = AIUATestSameUTF16(streamed, streamedLength, whole, wholeLength);
+        AIUA_CHECK_MSG(wholeOK, "第 %zu 轮整段输入与正则级联不一致", round);
+        AIUA_CHECK_MSG(streamedOK, "第 %zu 轮分 %zu 次输入与整段输入不一致", round, splitCount + 1);
+        if ((!wholeOK || !streamedOK) && reported++ < 5) {
+            AIUATestPrintUTF16("输入", text, length);
+            AIUATestPrintUTF16("正则", ref, refLength);
+            AIUATestPrintUTF16("整段", whole, wholeLength);
+            AIUATestPrintUTF16("流式", streamed, streamedLength);
+        }
+        free(ref);
+        free(whole);
+        free(streamed);
+    }
+}
+
+#pragma mark - 分配失败
+
+static void AIUATestAllocationFailure(void) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 44);
+    uint16_t text[512];
+    for (size_t round = 0; round < 2000; round++) {
+        size_t length = 64 + AIUATestRandomBelow(&random, 448);
+        for (size_t i = 0; i < length; i++) {
+            text[i] = AIUATestAlphabet[AIUATestRandomBelow(&random, 8)];
+        }
+        AIUAMarkdownStripEngine *engine = AIUAMarkdownStripEngineCreate();
+        AIUATestReallocFailAfter = (long)AIUATestRandomBelow(&random, 4);
+        AIUAMarkdownStripEngineFeed(engine, text, length);
+        AIUAMarkdownStripEngineFinish(engine);
+        AIUATestReallocFailAfter = -1;
+        size_t outLength = 0;
+        AIUAMarkdownStripEngineGetOutput(engine, &outLength);
+        // 没有失败时输出必须正确；失败时必须报告，由调用方回退到正则
+        if (!AIUAMarkdownStripEngineHasFailed(engine)) {
+            size_t refLength = 0;
+            uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+            const uint16_t *out = AIUAMarkdownStripEngineGetOutput(engine, &outLength);
+            AIUA_CHECK(AIUATestSameUTF16(out, outLength, ref, refLength));
+            free(ref);
+        }
+        size_t recoveredLength = 0;
+        uint16_t *recovered = AIUATestStrip(engine, text, length, NULL, 0, &recoveredLength);
+        size_t refLength = 0;
+        uint16_t *ref = AIUAMarkdownStripReference(text, length, &refLength);
+        AIUA_CHECK(!AIUAMarkdownStripEngineHasFailed(engine));
+        AIUA_CHECK(AIUATestSameUTF16(recovered, recoveredLength, ref, refLength));
+        free(recovered);
+        free(ref);
+        AIUAMarkdownStripEngineDestroy(engine);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+    AIUAMarkdownStripEngine *engine = AIUAMarkdownStripEngineCreate();
+    AIUATestExamples(engine);
+    AIUATestStreaming(engine);
+    AIUATestRandomDifferential(engine, rounds);
+    AIUAMarkdownStripEngineDestroy(engine);
+    AIUATestAllocationFailure();
+    return AIUATestSummary("AIUAMarkdownStripEngine");
+}
@@ -0,0 +1,154 @@
+//
+//  AIUAMarkdownStripReference.h
+//  AIUniversalAssistant
+//
+//  removeMarkdownSymbolsWithRegex: 五个正则的逐条移植，供 AIUAMarkdownStripEngine 的差分测试与基准对照
+//  每个阶段对整段文本做一次完整的“查找-替换”，按 ICU 的语义逐位置尝试匹配：
+//  "." 不匹配行结束符，".*?" 取最短，匹配成功后从匹配末尾继续，失败则从下一个位置重试
+//  与引擎的实现方式完全不同（多遍、无流式状态），两者一致才说明引擎与正则级联一致
+//
+
+#ifndef AIUAMarkdownStripReference_h
+#define AIUAMarkdownStripReference_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ICU 中 "." 不匹配的字符，多行模式下 '^' 在它们之后匹配
+static inline bool AIUARefIsLineTerminator(uint16_t c) {
+    return c == 0x0A || c == 0x0B || c == 0x0C || c == 0x0D || c == 0x85 || c == 0x2028 || c == 0x2029;
+}
+
+// \s，即 \p{White_Space}
+static inline bool AIUARefIsWhitespace(uint16_t c) {
+    return (c >= 0x09 && c <= 0x0D) || c == 0x20 || c == 0x85 || c == 0xA0 || c == 0x1680 ||
+           (c >= 0x2000 && c <= 0x200A) || c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+}
+
+// 从 from 开始找第一个 (marker, markerLength) 出现的位置，中间不能跨行；找不到返回 length
+static size_t AIUARefFindOnLine(const uint16_t *s, size_t length, size_t from, uint16_t marker, size_t markerLength) {
+    for (size_t j = from; j + markerLength <= length; j++) {
+        if (s[j] == marker && (markerLength == 1 || s[j + 1] == marker)) {
+            return j;
+        }
+        if (AIUARefIsLineTerminator(s[j])) {
+            break;
+        }
+    }
+    return length;
+}
+
+// (\*\*|__)(.*?)\1 -> $2（markerLength 为 2）与 (\*|_)(.*?)\1 -> $2（markerLength 为 1）
+static size_t AIUARefPairedPass(const uint16_t *s, size_t length, uint16_t *out, size_t markerLength) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < length) {
+        uint16_t c = s[i];
+        if ((c == '*' || c == '_') && i + markerLength <= length && (markerLength == 1 || s[i + 1] == c)) {
+            size_t close = AIUARefFindOnLine(s, length, i + markerLength, c, markerLength);
+            if (close < length) {
+                memcpy(out + n, s + i + markerLength, (close - i - markerLength) * sizeof(uint16_t));
+                n += close - i - markerLength;
+                i = close + markerLength;
+                continue;
+            }
+        }
+        out[n++] = s[i++];
+    }
+    return n;
+}
+
+// ^(#{1,6})\s+ -> ""，多行模式
+static size_t AIUARefHeaderPass(const uint16_t *s, size_t length, uint16_t *out) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < length) {
+        if (s[i] == '#' && (i == 0 || AIUARefIsLineTerminator(s[i - 1]))) {
+            size_t hashes = 0;
+            while (i + hashes < length && s[i + hashes] == '#' && hashes < 7) {
+                hashes++;
+            }
+            // 七个及以上的 '#'：#{1,6} 回溯后后面仍是 '#'，不匹配
+            if (hashes <= 6 && i + hashes < length && AIUARefIsWhitespace(s[i + hashes])) {
+                i += hashes;
+                while (i < length && AIUARefIsWhitespace(s[i])) {
+                    i++;
+                }
+                continue;
+            }
+        }
+        out[n++] = s[i++];
+    }
+    return n;
+}
+
+// `(.*?)` -> $1
+static size_t AIUARefCodePass(const uint16_t *s, size_t length, uint16_t *out) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < length) {
+        if (s[i] == '`') {
+            size_t close = AIUARefFindOnLine(s, length, i + 1, '`', 1);
+            if (close < length) {
+                memcpy(out + n, s + i + 1, (close - i - 1) * sizeof(uint16_t));
+                n += close - i - 1;
+                i = close + 1;
+                continue;
+            }
+        }
+        out[n++] = s[i++];
+    }
+    return n;
+}
+
+// \[(.*?)\]\(.*?\) -> $1：文字部分取最短，其后的 "](" 之后再找最近的 ')'，失败时回溯到下一个 "]("
+static size_t AIUARefLinkPass(const uint16_t *s, size_t length, uint16_t *out) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < length) {
+        if (s[i] == '[') {
+            bool matched = false;
+            size_t textEnd = 0;
+            size_t matchEnd = 0;
+            for (size_t k = i + 1; k + 1 < length && !AIUARefIsLineTerminator(s[k]); k++) {
+                if (s[k] != ']' || s[k + 1] != '(') {
+                    continue;
+                }
+                size_t close = AIUARefFindOnLine(s, length, k + 2, ')', 1);
+                if (close < length) {
+                    matched = true;
+                    textEnd = k;
+                    matchEnd = close + 1;
+                    break;
+                }
+            }
+            if (matched) {
+                memcpy(out + n, s + i + 1, (textEnd - i - 1) * sizeof(uint16_t));
+                n += textEnd - i - 1;
+                i = matchEnd;
+                continue;
+            }
+        }
+        out[n++] = s[i++];
+    }
+    return n;
+}
+
+/// 依次执行粗体、斜体、标题、代码、链接五个替换，返回 malloc 的结果（调用方 free）
+static inline uint16_t *AIUAMarkdownStripReference(const uint16_t *text, size_t length, size_t *outLength) {
+    uint16_t *a = (uint16_t *)malloc((length + 1) * sizeof(uint16_t));
+    uint16_t *b = (uint16_t *)malloc((length + 1) * sizeof(uint16_t));
+    size_t n = AIUARefPairedPass(text, length, a, 2);
+    n = AIUARefPairedPass(a, n, b, 1);
+    n = AIUARefHeaderPass(b, n, a);
+    n = AIUARefCodePass(a, n, b);
+    n = AIUARefLinkPass(b, n, a);
+    free(b);
+    *outLength = n;
+    return a;
+}
+
+#endif /* AIUAMarkdownStripReference_h */
@@ -0,0 +1,214 @@
+//
+//  AIUAOrderedItemStoreBench.m
+//  AIUniversalAssistant
+//
+//  AIUAOrderedItemStore 快速滚动基准：3000 个模板、300 个收藏，热门页每个 cell 出现时判断是否已收藏，
+//  滚动中穿插收藏 / 取消收藏和记录最近使用
+//  对照原实现（AIUADataManager 旧版）：isFavorite: 每次读取 AIUAFavorites.plist 并线性查找，
+//  addFavorite: / removeFavorite: / addRecentUsed: 每次读取、查找并同步重写整个文件
+//  结束后等待合并写盘，核对文件内容与原实现的收藏、最近使用一致，不一致时退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAOrderedItemStoreBench [模板数] [收藏数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAOrderedItemStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+// 每 N 个 cell 切换一次收藏、记录一次最近使用
+static const NSUInteger kAIUABenchToggleInterval = 97;
+static const NSUInteger kAIUABenchRecentInterval = 211;
+static const NSUInteger kAIUABenchRecentLimit = 20;
+// 快速滚动时每帧新出现的 cell 数
+static const NSUInteger kAIUABenchCellsPerFrame = 6;
+
+// 与 AIUATemplateCatalog identifierForItem: 一致
+static NSString *AIUABenchItemID(NSDictionary *item) {
+    return [NSString stringWithFormat:@"%@_%@", item[@"type"] ?: @"", item[@"title"] ?: @""];
+}
+
+#pragma mark - 原实现
+
+static NSArray *AIUABenchLegacyLoad(NSString *path) {
+    if (![[NSFileManager defaultManager] fileExistsAtPath:path]) {
+        return @[];
+    }
+    NSArray *array = [NSArray arrayWithContentsOfFile:path];
+    return [array isKindOfClass:[NSArray class]] ? array : @[];
+}
+
+static BOOL AIUABenchLegacyContains(NSString *path, NSString *itemID) {
+    for (NSDictionary *item in AIUABenchLegacyLoad(path)) {
+        if ([AIUABenchItemID(item) isEqualToString:itemID]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static void AIUABenchLegacyInsert(NSString *path, NSDictionary *item, NSUInteger limit) {
+    NSMutableArray *items = [AIUABenchLegacyLoad(path) mutableCopy];
+    NSString *itemID = AIUABenchItemID(item);
+    NSMutableArray *itemsToRemove = [NSMutableArray array];
+    for (NSDictionary *existing in items) {
+        if ([AIUABenchItemID(existing) isEqualToString:itemID]) {
+            [itemsToRemove addObject:existing];
+        }
+    }
+    [items removeObjectsInArray:itemsToRemove];
+    [items insertObject:item atIndex:0];
+    if (limit > 0 && items.count > limit) {
+        [items removeObjectsInRange:NSMakeRange(limit, items.count - limit)];
+    }
+    [items writeToFile:path atomically:YES];
+}
+
+static void AIUABenchLegacyRemove(NSString *path, NSString *itemID) {
+    NSMutableArray *items = [AIUABenchLegacyLoad(path) mutableCopy];
+    NSMutableArray *itemsToRemove = [NSMutableArray array];
+    for (NSDictionary *existing in items) {
+        if ([AIUABenchItemID(existing) isEqualToString:itemID]) {
+            [itemsToRemove addObject:existing];
+        }
+    }
+    [items removeObjectsInArray:itemsToRemove];
+    [items writeToFile:path atomically:YES];
+}
+
+#pragma mark - 滚动
+
+typedef struct {
+    double lookup;
+    double mutate;
+    NSUInteger cells;
+    NSUInteger mutations;
+    NSUInteger favorites;
+} AIUABenchResult;
+
+// 在模板网格上来回滚动 passes 遍；legacy 为 YES 时走原实现
+static AIUABenchResult AIUABenchScroll(NSArray<NSDictionary *> *items, NSUInteger passes, BOOL legacy,
+                                       AIUAOrderedItemStore *favorites, AIUAOrderedItemStore *recents,
+                                       NSString *favoritesPath, NSString *recentsPath) {
+    AIUABenchResult result = {0, 0, 0, 0, 0};
+    for (NSUInteger pass = 0; pass < passes; pass++) {
+        for (NSUInteger step = 0; step < items.count; step++) {
+            NSUInteger index = pass % 2 == 0 ? step : items.count - 1 - step;
+            NSDictionary *item = items[index];
+            NSString *itemID = AIUABenchItemID(item);
+
+            double start = AIUATestNow();
+            BOOL favorite = legacy ? AIUABenchLegacyContains(favoritesPath, itemID) : [favorites containsItemWithID:itemID];
+            result.lookup += AIUATestNow() - start;
+            result.cells++;
+            result.favorites += favorite ? 1 : 0;
+
+            if (step % kAIUABenchToggleInterval == 0 || step % kAIUABenchRecentInterval == 0) {
+                start = AIUATestNow();
+                if (step % kAIUABenchToggleInterval == 0) {
+                    if (favorite) {
+                        legacy ? AIUABenchLegacyRemove(favoritesPath, itemID) : (void)[favorites removeItemWithID:itemID];
+                    } else if (legacy) {
+                        AIUABenchLegacyInsert(favoritesPath, item, 0);
+                    } else {
+                        [favorites insertItem:item moveExisting:NO];
+                    }
+                    result.mutations++;
+                }
+                if (step % kAIUABenchRecentInterval == 0) {
+                    legacy ? AIUABenchLegacyInsert(recentsPath, item, kAIUABenchRecentLimit) : (void)[recents insertItem:item moveExisting:YES];
+                    result.mutations++;
+                }
+                result.mutate += AIUATestNow() - start;
+            }
+        }
+    }
+    return result;
+}
+
+static NSArray<NSString *> *AIUABenchIDsInFile(NSString *path) {
+    NSMutableArray<NSString *> *itemIDs = [NSMutableArray array];
+    for (NSDictionary *item in AIUABenchLegacyLoad(path)) {
+        [itemIDs addObject:AIUABenchItemID(item)];
+    }
+    return itemIDs;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger itemCount = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 3000;
+        NSUInteger favoriteCount = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 300;
+        NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                               [NSString stringWithFormat:@"AIUAOrderedItemStoreBench-%d", getpid()]];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+
+        AIUATestRandom random;
+        AIUATestRandomSeed(&random, 16);
+        NSArray<NSString *> *types = @[@"speech", @"experience", @"summary", @"article", @"moments", @"answer"];
+        NSMutableArray<NSDictionary *> *items = [NSMutableArray arrayWithCapacity:itemCount];
+        for (NSUInteger i = 0; i < itemCount; i++) {
+            [items addObject:@{@"title": [NSString stringWithFormat:@"模板 %lu", (unsigned long)i],
+                               @"subtitle": @"充分准备，把握每一次机会",
+                               @"icon": @"mic",
+                               @"type": types[i % types.count],
+                               @"categoryId": [NSString stringWithFormat:@"category%lu", (unsigned long)(i % 12)]}];
+        }
+        NSMutableArray<NSDictionary *> *initialFavorites = [NSMutableArray array];
+        NSMutableSet<NSString *> *chosen = [NSMutableSet set];
+        while (initialFavorites.count < MIN(favoriteCount, itemCount)) {
+            NSDictionary *item = items[AIUATestRandomBelow(&random, itemCount)];
+            if (![chosen containsObject:AIUABenchItemID(item)]) {
+                [chosen addObject:AIUABenchItemID(item)];
+                [initialFavorites addObject:item];
+            }
+        }
+
+        NSString *legacyFavorites = [directory stringByAppendingPathComponent:@"LegacyFavorites.plist"];
+        NSString *legacyRecents = [directory stringByAppendingPathComponent:@"LegacyRecentUsed.plist"];
+        NSString *storeFavorites = [directory stringByAppendingPathComponent:@"AIUAFavorites.plist"];
+        NSString *storeRecents = [directory stringByAppendingPathComponent:@"AIUARecentUsed.plist"];
+        [initialFavorites writeToFile:legacyFavorites atomically:YES];
+        [initialFavorites writeToFile:storeFavorites atomically:YES];
+
+        AIUAOrderedItemIdentifier identifier = ^NSString *(NSDictionary *item) {
+            return AIUABenchItemID(item);
+        };
+        AIUAOrderedItemStore *favorites = [[AIUAOrderedItemStore alloc] initWithFilePath:storeFavorites capacity:0 identifier:identifier];
+        AIUAOrderedItemStore *recents = [[AIUAOrderedItemStore alloc] initWithFilePath:storeRecents
+                                                                              capacity:kAIUABenchRecentLimit
+                                                                            identifier:identifier];
+
+        // 两种实现执行完全相同的滚动与修改序列：收藏判断结果、最终文件内容都应一致
+        AIUABenchResult legacy = AIUABenchScroll(items, 1, YES, nil, nil, legacyFavorites, legacyRecents);
+        AIUABenchResult store = AIUABenchScroll(items, 1, NO, favorites, recents, storeFavorites, storeRecents);
+        if (legacy.favorites != store.favorites) {
+            fprintf(stderr, "收藏判断不一致：原实现 %lu，内存集合 %lu\n", (unsigned long)legacy.favorites, (unsigned long)store.favorites);
+            return 1;
+        }
+        [favorites flush];
+        [recents flush];
+        [NSThread sleepForTimeInterval:1.0];
+        if (![AIUABenchIDsInFile(storeFavorites) isEqualToArray:AIUABenchIDsInFile(legacyFavorites)] ||
+            ![AIUABenchIDsInFile(storeRecents) isEqualToArray:AIUABenchIDsInFile(legacyRecents)]) {
+            fprintf(stderr, "合并写盘后的文件与原实现不一致\n");
+            return 1;
+        }
+
+        // 原实现每个 cell 都要读文件，只滚动一遍；内存集合再来回滚动 20 遍取平均
+        AIUABenchResult steady = AIUABenchScroll(items, 20, NO, favorites, recents, storeFavorites, storeRecents);
+        double legacyCell = legacy.lookup / legacy.cells;
+        double storeCell = steady.lookup / steady.cells;
+        printf("[AIUAOrderedItemStore] %lu 个模板、%lu 个收藏，每 %lu 个 cell 切换收藏、每 %lu 个 cell 记录最近使用\n",
+               (unsigned long)itemCount, (unsigned long)initialFavorites.count,
+               (unsigned long)kAIUABenchToggleInterval, (unsigned long)kAIUABenchRecentInterval);
+        printf("  是否收藏（每个 cell）   原实现 %9.2f µs   内存集合 %7.3f µs\n", legacyCell * 1e6, storeCell * 1e6);
+        printf("  每帧 %lu 个新 cell        原实现 %9.2f ms   内存集合 %7.4f ms（60fps 每帧 16.7 ms）\n",
+               (unsigned long)kAIUABenchCellsPerFrame, legacyCell * kAIUABenchCellsPerFrame * 1e3,
+               storeCell * kAIUABenchCellsPerFrame * 1e3);
+        printf("  收藏 / 最近使用（每次） 原实现 %9.2f µs   内存集合 %7.3f µs（写盘在后台合并）\n",
+               legacy.mutate / legacy.mutations * 1e6, (store.mutate + steady.mutate) / (store.mutations + steady.mutations) * 1e6);
+
+        [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+        return 0;
+    }
+}
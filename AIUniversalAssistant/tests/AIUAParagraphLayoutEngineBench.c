@@ -0,0 +1,74 @@
+//
+//  AIUAParagraphLayoutEngineBench.c
+//  AIUniversalAssistant
+//
+//  AIUAParagraphLayoutEngine 打字基准：1k ~ 100k 字的文档（平均每段 200 字），在中间段落逐字输入，
+//  对比增量更新与每次全量测量的耗时和测量的码元数
+//  模拟测量按码元计费（每个码元读一次），真机上 TextKit 排版远比这里贵，测量的码元数更能反映实际差距
+//  用法：AIUAParagraphLayoutEngineBench [每种长度输入的字数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAParagraphLayoutEngine.h"
+
+static size_t AIUABenchMeasuredUnits;
+
+static double AIUABenchMeasure(const uint16_t *characters, size_t length, void *context) {
+    (void)context;
+    volatile uint32_t sink = 0;
+    for (size_t i = 0; i < length; i++) {
+        sink += characters[i];
+    }
+    AIUABenchMeasuredUnits += length;
+    return (double)(length > 0 ? (length + 19) / 20 : 1) * 19.09;
+}
+
+int main(int argc, char **argv) {
+    size_t keystrokes = argc > 1 ? strtoul(argv[1], NULL, 10) : 200;
+    const size_t sizes[] = {1000, 5000, 10000, 20000, 50000, 100000};
+    printf("[AIUAParagraphLayoutEngine] 中间段落逐字输入 %zu 次，每次按键的平均开销\n", keystrokes);
+    printf("    字数     增量耗时   增量测量码元      全量耗时   全量测量码元\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t length = sizes[s];
+        uint16_t *text = (uint16_t *)malloc((length + keystrokes) * sizeof(uint16_t));
+        for (size_t i = 0; i < length; i++) {
+            text[i] = i % 200 == 199 ? '\n' : (uint16_t)(0x4E00 + i % 50);
+        }
+        AIUAParagraphLayoutEngine *engine = AIUAParagraphLayoutEngineCreate(AIUABenchMeasure, NULL);
+        AIUAParagraphLayoutEngineSetText(engine, text, length);
+
+        size_t position = length / 2;
+        AIUABenchMeasuredUnits = 0;
+        double start = AIUATestNow();
+        for (size_t k = 0; k < keystrokes; k++) {
+            memmove(text + position + 1, text + position, (length - position) * sizeof(uint16_t));
+            text[position++] = 'x';
+            length++;
+            AIUAParagraphLayoutEngineSetText(engine, text, length);
+        }
+        double incremental = (AIUATestNow() - start) / keystrokes;
+        size_t incrementalUnits = AIUABenchMeasuredUnits / keystrokes;
+        double incrementalHeight = AIUAParagraphLayoutEngineGetHeight(engine);
+
+        // 对照：每次按键都全量测量（相当于旧实现对整个正文 sizeThatFits:）
+        AIUABenchMeasuredUnits = 0;
+        double fullHeight = 0;
+        start = AIUATestNow();
+        for (size_t k = 0; k < keystrokes; k++) {
+            AIUAParagraphLayoutEngineInvalidate(engine);
+            AIUAParagraphLayoutEngineSetText(engine, text, length);
+            fullHeight = AIUAParagraphLayoutEngineGetHeight(engine);
+        }
+        double full = (AIUATestNow() - start) / keystrokes;
+        size_t fullUnits = AIUABenchMeasuredUnits / keystrokes;
+        if (incrementalHeight - fullHeight > 1e-6 || fullHeight - incrementalHeight > 1e-6) {
+            fprintf(stderr, "增量高度 %.3f 与全量高度 %.3f 不一致\n", incrementalHeight, fullHeight);
+            return 1;
+        }
+        printf("  %6zu   %8.4f ms   %12zu   %8.4f ms   %12zu\n",
+               sizes[s], incremental * 1000.0, incrementalUnits, full * 1000.0, fullUnits);
+        AIUAParagraphLayoutEngineDestroy(engine);
+        free(text);
+    }
+    return 0;
+}
@@ -0,0 +1,286 @@
+//
+//  AIUAParagraphLayoutEngineTests.c
+//  AIUniversalAssistant
+//
+//  AIUAParagraphLayoutEngine 测试：段落划分（\n、\r、\r\n、U+2029、末尾空段落）、增量测量范围，
+//  以及随机编辑序列下与独立实现的全量测量逐步比对（高度与段落数）
+//  引擎以 -Drealloc=AIUATestRealloc 编译，用于注入分配失败：失败后下一次更新必须全量测量并得到正确结果
+//  用法：AIUAParagraphLayoutEngineTests [随机编辑次数]
+//
+
+#include <math.h>
+#include "AIUATestSupport.h"
+#include "AIUAParagraphLayoutEngine.h"
+
+#pragma mark - 分配失败注入
+
+static long AIUATestReallocFailAfter = -1;   // 再成功多少次后失败，-1 表示不失败
+
+void *AIUATestRealloc(void *pointer, size_t size);
+void *AIUATestRealloc(void *pointer, size_t size) {
+    if (AIUATestReallocFailAfter == 0) {
+        return NULL;
+    }
+    if (AIUATestReallocFailAfter > 0) {
+        AIUATestReallocFailAfter--;
+    }
+    return realloc(pointer, size);
+}
+
+#pragma mark - 模拟测量
+
+// 每行 20 个码元、行高 19.5；空段落占一行。收到的段落内容不应含分隔符
+typedef struct {
+    size_t paragraphs;
+    size_t units;
+    size_t separatorsSeen;
+} AIUATestMeasureStats;
+
+static double AIUATestMeasure(const uint16_t *characters, size_t length, void *context) {
+    AIUATestMeasureStats *stats = (AIUATestMeasureStats *)context;
+    stats->paragraphs++;
+    stats->units += length;
+    for (size_t i = 0; i < length; i++) {
+        // \r\n 中的 \r 已剥离；单独的 \r 是分隔符，也不应出现
+        if (characters[i] == '\n' || characters[i] == '\r' || characters[i] == 0x2029) {
+            stats->separatorsSeen++;
+        }
+    }
+    size_t lines = length > 0 ? (length + 19) / 20 : 1;
+    return (double)lines * 19.5;
+}
+
+// 独立的全量实现：逐个码元切分段落
+static double AIUATestReferenceHeight(const uint16_t *characters, size_t length, size_t *paragraphs) {
+    double height = 0;
+    size_t count = 0;
+    size_t content = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint16_t c = characters[i];
+        if (c == '\r' && i + 1 < length && characters[i + 1] == '\n') {
+            continue;
+        }
+        if (c == '\n' || c == '\r' || c == 0x2029) {
+            height += (double)(content > 0 ? (content + 19) / 20 : 1) * 19.5;
+            count++;
+            content = 0;
+        } else {
+            content++;
+        }
+    }
+    height += (double)(content > 0 ? (content + 19) / 20 : 1) * 19.5;
+    *paragraphs = count + 1;
+    return height;
+}
+
+static size_t AIUATestUTF16(const char *text, uint16_t *output) {
+    size_t length = 0;
+    for (const char *p = text; *p; p++) {
+        // '|' 代表 U+2029
+        output[length++] = *p == '|' ? 0x2029 : (uint16_t)(uint8_t)*p;
+    }
+    return length;
+}
+
+#pragma mark - 段落划分
+
+static void AIUATestSplitting(void) {
+    static const struct {
+        const char *text;
+        size_t paragraphs;
+    } cases[] = {
+        {"", 1},
+        {"a", 1},
+        {"a\n", 2},
+        {"\n", 2},
+        {"\n\n", 3},
+        {"a\r\nb", 2},
+        {"a\rb", 2},
+        {"a\r\rb", 3},
+        {"a\n\rb", 3},
+        {"a\r\n\r\nb", 3},
+        {"a|b|", 3},
+        {"\r", 2},
+        {"\r\n", 2},
+    };
+    AIUATestMeasureStats stats = {0};
+    AIUAParagraphLayoutEngine *engine = AIUAParagraphLayoutEngineCreate(AIUATestMeasure, &stats);
+    AIUA_CHECK(engine != NULL);
+    AIUA_CHECK(AIUAParagraphLayoutEngineGetHeight(engine) == 0 && AIUAParagraphLayoutEngineGetParagraphCount(engine) == 0);
+    uint16_t buffer[64];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t length = AIUATestUTF16(cases[i].text, buffer);
+        AIUAParagraphLayoutEngineInvalidate(engine);
+        AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, buffer, length));
+        size_t expected = 0;
+        double height = AIUATestReferenceHeight(buffer, length, &expected);
+        AIUA_CHECK_MSG(expected == cases[i].paragraphs, "用例 %zu：参考实现 %zu 段", i, expected);
+        AIUA_CHECK_MSG(AIUAParagraphLayoutEngineGetParagraphCount(engine) == cases[i].paragraphs,
+                       "用例 %zu：%zu 段，期望 %zu 段", i, AIUAParagraphLayoutEngineGetParagraphCount(engine), cases[i].paragraphs);
+        AIUA_CHECK(AIUAParagraphLayoutEngineGetHeight(engine) == height);
+        AIUA_CHECK(AIUAParagraphLayoutEngineGetLastMeasuredCount(engine) == cases[i].paragraphs);
+    }
+    AIUA_CHECK(stats.separatorsSeen == 0);
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, NULL, 0));
+    AIUA_CHECK(!AIUAParagraphLayoutEngineSetText(engine, NULL, 3));
+    AIUA_CHECK(!AIUAParagraphLayoutEngineSetText(NULL, buffer, 1));
+    AIUAParagraphLayoutEngineDestroy(engine);
+    AIUAParagraphLayoutEngineDestroy(NULL);
+}
+
+#pragma mark - 增量范围
+
+// 只改动一个段落时最多重测该段与前一段；\r 与 \n 的拆合也只影响相邻段落
+static void AIUATestIncremental(void) {
+    AIUATestMeasureStats stats = {0};
+    AIUAParagraphLayoutEngine *engine = AIUAParagraphLayoutEngineCreate(AIUATestMeasure, &stats);
+    size_t paragraphs = 1000;
+    size_t length = paragraphs * 50;
+    uint16_t *text = (uint16_t *)malloc((length + 8) * sizeof(uint16_t));
+    for (size_t i = 0; i < length; i++) {
+        text[i] = i % 50 == 49 ? '\n' : (uint16_t)(0x4E00 + i % 97);
+    }
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    AIUA_CHECK(AIUAParagraphLayoutEngineGetParagraphCount(engine) == paragraphs + 1);
+
+    // 相同文本不重测
+    stats.paragraphs = 0;
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    AIUA_CHECK(stats.paragraphs == 0 && AIUAParagraphLayoutEngineGetLastMeasuredCount(engine) == 0);
+
+    // 在中间段落逐字输入 200 次
+    size_t position = length / 2 + 10;
+    size_t maxMeasured = 0;
+    for (int k = 0; k < 200; k++) {
+        memmove(text + position + 1, text + position, (length - position) * sizeof(uint16_t));
+        text[position++] = 'x';
+        length++;
+        if (k == 199) {
+            break;
+        }
+        stats.paragraphs = 0;
+        AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+        maxMeasured = stats.paragraphs > maxMeasured ? stats.paragraphs : maxMeasured;
+        text = (uint16_t *)realloc(text, (length + 8) * sizeof(uint16_t));
+    }
+    AIUA_CHECK_MSG(maxMeasured <= 2, "输入一个字符重测了 %zu 段", maxMeasured);
+
+    // 在段落中间插入 \r 再在其后插入 \n：先拆成两段，再合为 \r\n
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    size_t before = AIUAParagraphLayoutEngineGetParagraphCount(engine);
+    memmove(text + position + 1, text + position, (length - position) * sizeof(uint16_t));
+    text[position] = '\r';
+    length++;
+    stats.paragraphs = 0;
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    AIUA_CHECK(AIUAParagraphLayoutEngineGetParagraphCount(engine) == before + 1 && stats.paragraphs <= 3);
+    text = (uint16_t *)realloc(text, (length + 8) * sizeof(uint16_t));
+    memmove(text + position + 2, text + position + 1, (length - position - 1) * sizeof(uint16_t));
+    text[position + 1] = '\n';
+    length++;
+    stats.paragraphs = 0;
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    AIUA_CHECK(AIUAParagraphLayoutEngineGetParagraphCount(engine) == before + 1 && stats.paragraphs <= 3);
+    size_t expected = 0;
+    AIUA_CHECK(AIUAParagraphLayoutEngineGetHeight(engine) == AIUATestReferenceHeight(text, length, &expected));
+
+    // 失效后全量重测
+    AIUAParagraphLayoutEngineInvalidate(engine);
+    stats.paragraphs = 0;
+    AIUA_CHECK(AIUAParagraphLayoutEngineSetText(engine, text, length));
+    AIUA_CHECK(stats.paragraphs == AIUAParagraphLayoutEngineGetParagraphCount(engine));
+    AIUA_CHECK(stats.separatorsSeen == 0);
+    free(text);
+    AIUAParagraphLayoutEngineDestroy(engine);
+}
+
+#pragma mark - 随机编辑
+
+static void AIUATestRandomEdits(size_t rounds) {
+    static const uint16_t alphabet[] = {'a', 'b', ' ', 0x4E2D, '\n', '\r', 0x2029};
+    AIUATestMeasureStats stats = {0};
+    AIUAParagraphLayoutEngine *engine = AIUAParagraphLayoutEngineCreate(AIUATestMeasure, &stats);
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 21);
+    const size_t capacity = 3000;
+    uint16_t *text = (uint16_t *)malloc(capacity * sizeof(uint16_t));
+    size_t length = 0;
+    size_t mismatches = 0;
+    size_t failures = 0;
+    size_t measured = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        size_t position = AIUATestRandomBelow(&random, length + 1);
+        size_t count = 1 + AIUATestRandomBelow(&random, AIUATestRandomBelow(&random, 50) == 0 ? 400 : 6);
+        switch (AIUATestRandomBelow(&random, 5)) {
+            case 0:
+            case 1:     // 插入（输入或粘贴）
+                if (length + count <= capacity) {
+                    memmove(text + position + count, text + position, (length - position) * sizeof(uint16_t));
+                    for (size_t k = 0; k < count; k++) {
+                        text[position + k] = alphabet[AIUATestRandomBelow(&random, 7)];
+                    }
+                    length += count;
+                }
+                break;
+            case 2:     // 删除
+                count = position + count > length ? length - position : count;
+                memmove(text + position, text + position + count, (length - position - count) * sizeof(uint16_t));
+                length -= count;
+                break;
+            case 3:     // 替换
+                for (size_t k = position; k < length && k < position + count; k++) {
+                    text[k] = alphabet[AIUATestRandomBelow(&random, 7)];
+                }
+                break;
+            default:    // 撤销式的整段替换：全部清空或重新生成
+                if (AIUATestRandomBelow(&random, 20) == 0) {
+                    length = AIUATestRandomBelow(&random, 2) ? 0 : AIUATestRandomBelow(&random, capacity);
+                    for (size_t k = 0; k < length; k++) {
+                        text[k] = alphabet[AIUATestRandomBelow(&random, 7)];
+                    }
+                }
+                break;
+        }
+        if (AIUATestRandomBelow(&random, 500) == 0) {
+            AIUAParagraphLayoutEngineInvalidate(engine);
+        }
+        // 偶尔在第 0~2 次分配时失败
+        bool inject = AIUATestRandomBelow(&random, 200) == 0;
+        AIUATestReallocFailAfter = inject ? (long)AIUATestRandomBelow(&random, 3) : -1;
+        bool ok = AIUAParagraphLayoutEngineSetText(engine, text, length);
+        AIUATestReallocFailAfter = -1;
+        if (!ok) {
+            failures++;
+            AIUA_CHECK(AIUAParagraphLayoutEngineGetParagraphCount(engine) == 0);
+            // 下一次全量测量
+            stats.paragraphs = 0;
+            ok = AIUAParagraphLayoutEngineSetText(engine, text, length);
+            AIUA_CHECK(ok && stats.paragraphs == AIUAParagraphLayoutEngineGetParagraphCount(engine));
+        }
+        measured += AIUAParagraphLayoutEngineGetLastMeasuredCount(engine);
+        size_t paragraphs = 0;
+        double height = AIUATestReferenceHeight(text, length, &paragraphs);
+        // 增量求和有浮点误差，允许极小偏差
+        if (fabs(AIUAParagraphLayoutEngineGetHeight(engine) - height) > 1e-6 ||
+            AIUAParagraphLayoutEngineGetParagraphCount(engine) != paragraphs) {
+            if (mismatches++ < 3) {
+                fprintf(stderr, "  第 %zu 次编辑：高度 %.3f / %.3f，段落 %zu / %zu\n", round,
+                        AIUAParagraphLayoutEngineGetHeight(engine), height,
+                        AIUAParagraphLayoutEngineGetParagraphCount(engine), paragraphs);
+            }
+        }
+    }
+    AIUA_CHECK_MSG(mismatches == 0, "%zu 次编辑后结果与全量测量不一致", mismatches);
+    AIUA_CHECK(stats.separatorsSeen == 0);
+    printf("  随机编辑 %zu 次（注入分配失败 %zu 次）：平均每次重测 %.2f 段\n", rounds, failures, (double)measured / rounds);
+    free(text);
+    AIUAParagraphLayoutEngineDestroy(engine);
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    AIUATestSplitting();
+    AIUATestIncremental();
+    AIUATestRandomEdits(rounds);
+    return AIUATestSummary("AIUAParagraphLayoutEngine");
+}
@@ -0,0 +1,258 @@
+//
+//  AIUAReceiptFixture.h
+//  AIUniversalAssistant
+//
+//  生成合成 App Store 收据（PKCS#7 SignedData 包裹的 ASN.1 收据），并记录每条内购记录的期望值
+//  - DER：全部定长
+//  - BER：外层 ContentInfo / SignedData 为不定长
+//  - 分段：在 BER 基础上，负载拆成多段 OCTET STRING（每段 1000 字节）
+//  测试与基准共用
+//
+
+#ifndef AIUAReceiptFixture_h
+#define AIUAReceiptFixture_h
+
+#include <stdbool.h>
+#include "AIUATestSupport.h"
+
+typedef enum {
+    AIUAReceiptFixtureDER = 0,
+    AIUAReceiptFixtureBER,
+    AIUAReceiptFixtureChunked,
+    AIUAReceiptFixtureEncodingCount
+} AIUAReceiptFixtureEncoding;
+
+static const char * const AIUAReceiptFixtureEncodingNames[AIUAReceiptFixtureEncodingCount] = {"DER", "BER", "分段"};
+
+#define AIUAReceiptFixtureBundleID "com.aiua.app"
+#define AIUAReceiptFixtureAppVersion "1.0"
+
+typedef struct {
+    char productID[48];
+    char transactionID[24];
+    char originalTransactionID[24];
+    char purchaseDate[24];
+    char expiresDate[24];           // 空串表示没有 1708（消耗型字数包）
+    bool cancelled;                 // 带 1712
+    int64_t quantity;
+    int64_t webOrderLineItemID;
+} AIUAReceiptFixturePurchase;
+
+typedef struct {
+    AIUATestBuffer receipt;
+    AIUAReceiptFixturePurchase *purchases;
+    size_t purchaseCount;
+} AIUAReceiptFixture;
+
+#pragma mark - 编码
+
+static inline void AIUAReceiptFixtureHeader(AIUATestBuffer *out, uint8_t tag, size_t length) {
+    uint8_t header[10];
+    size_t n = 0;
+    header[n++] = tag;
+    if (length < 0x80) {
+        header[n++] = (uint8_t)length;
+    } else {
+        size_t bytes = 0;
+        for (size_t v = length; v > 0; v >>= 8) {
+            bytes++;
+        }
+        header[n++] = (uint8_t)(0x80 | bytes);
+        for (size_t i = bytes; i > 0; i--) {
+            header[n++] = (uint8_t)(length >> (8 * (i - 1)));
+        }
+    }
+    AIUATestBufferAppend(out, header, n);
+}
+
+static inline void AIUAReceiptFixtureTLV(AIUATestBuffer *out, uint8_t tag, const void *content, size_t length) {
+    AIUAReceiptFixtureHeader(out, tag, length);
+    AIUATestBufferAppend(out, content, length);
+}
+
+/// indefinite 为 true 时用不定长编码（构造类型，以 00 00 结束）
+static inline void AIUAReceiptFixtureWrap(AIUATestBuffer *out, uint8_t tag, const AIUATestBuffer *content, bool indefinite) {
+    if (indefinite) {
+        uint8_t header[2] = {tag, 0x80};
+        uint8_t endOfContents[2] = {0, 0};
+        AIUATestBufferAppend(out, header, 2);
+        AIUATestBufferAppend(out, content->bytes, content->length);
+        AIUATestBufferAppend(out, endOfContents, 2);
+    } else {
+        AIUAReceiptFixtureTLV(out, tag, content->bytes, content->length);
+    }
+}
+
+static inline void AIUAReceiptFixtureInteger(AIUATestBuffer *out, int64_t value) {
+    uint8_t bytes[8];
+    size_t n = 8;
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = (uint8_t)((uint64_t)value >> (8 * (7 - i)));
+    }
+    // 最短补码
+    size_t start = 0;
+    while (start < 7 && ((bytes[start] == 0x00 && !(bytes[start + 1] & 0x80)) ||
+                         (bytes[start] == 0xFF && (bytes[start + 1] & 0x80)))) {
+        start++;
+    }
+    AIUAReceiptFixtureTLV(out, 0x02, bytes + start, n - start);
+}
+
+/// 收据属性：SEQUENCE { INTEGER type, INTEGER version, OCTET STRING value }
+static inline void AIUAReceiptFixtureAttribute(AIUATestBuffer *out, int64_t type, const AIUATestBuffer *value) {
+    AIUATestBuffer attribute = {0};
+    AIUAReceiptFixtureInteger(&attribute, type);
+    AIUAReceiptFixtureInteger(&attribute, 1);
+    AIUAReceiptFixtureTLV(&attribute, 0x04, value->bytes, value->length);
+    AIUAReceiptFixtureWrap(out, 0x30, &attribute, false);
+    AIUATestBufferFree(&attribute);
+}
+
+/// tag 0x0C 为 UTF8String，0x16 为 IA5String（日期）
+static inline void AIUAReceiptFixtureStringAttribute(AIUATestBuffer *out, int64_t type, uint8_t tag, const char *string) {
+    AIUATestBuffer value = {0};
+    AIUAReceiptFixtureTLV(&value, tag, string, strlen(string));
+    AIUAReceiptFixtureAttribute(out, type, &value);
+    AIUATestBufferFree(&value);
+}
+
+static inline void AIUAReceiptFixtureIntegerAttribute(AIUATestBuffer *out, int64_t type, int64_t integer) {
+    AIUATestBuffer value = {0};
+    AIUAReceiptFixtureInteger(&value, integer);
+    AIUAReceiptFixtureAttribute(out, type, &value);
+    AIUATestBufferFree(&value);
+}
+
+#pragma mark - 收据
+
+static inline void AIUAReceiptFixtureRandomDate(AIUATestRandom *random, char *output, size_t capacity) {
+    snprintf(output, capacity, "%04d-%02d-%02dT%02d:%02d:%02dZ",
+             2020 + (int)AIUATestRandomBelow(random, 11), 1 + (int)AIUATestRandomBelow(random, 12),
+             1 + (int)AIUATestRandomBelow(random, 28), (int)AIUATestRandomBelow(random, 24),
+             (int)AIUATestRandomBelow(random, 60), (int)AIUATestRandomBelow(random, 60));
+}
+
+/// 生成含 count 条内购记录的收据；同一 seed 的期望值相同，与编码方式无关
+static inline void AIUAReceiptFixtureBuild(AIUAReceiptFixture *fixture, size_t count,
+                                           AIUAReceiptFixtureEncoding encoding, uint64_t seed) {
+    static const char * const products[] = {
+        "com.aiua.app.vip.weekly", "com.aiua.app.vip.monthly", "com.aiua.app.vip.yearly",
+        "com.aiua.app.vip.lifetime", "com.aiua.app.wordpack.500k", "com.aiua.app.wordpack.2m",
+    };
+    memset(fixture, 0, sizeof(*fixture));
+    fixture->purchases = (AIUAReceiptFixturePurchase *)calloc(count ? count : 1, sizeof(AIUAReceiptFixturePurchase));
+    fixture->purchaseCount = count;
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+
+    AIUATestBuffer attributes = {0};
+    AIUAReceiptFixtureStringAttribute(&attributes, 2, 0x0C, AIUAReceiptFixtureBundleID);
+    AIUAReceiptFixtureStringAttribute(&attributes, 3, 0x0C, AIUAReceiptFixtureAppVersion);
+    AIUAReceiptFixtureStringAttribute(&attributes, 12, 0x16, "2026-01-01T00:00:00Z");
+    AIUAReceiptFixtureIntegerAttribute(&attributes, 9999, 5);                    // 未知属性应被跳过
+    for (size_t i = 0; i < count; i++) {
+        AIUAReceiptFixturePurchase *purchase = &fixture->purchases[i];
+        const char *product = products[AIUATestRandomBelow(&random, sizeof(products) / sizeof(products[0]))];
+        bool subscription = strstr(product, ".vip.") && !strstr(product, "lifetime");
+        snprintf(purchase->productID, sizeof(purchase->productID), "%s", product);
+        snprintf(purchase->transactionID, sizeof(purchase->transactionID), "%llu", 200000000000000ULL + i);
+        snprintf(purchase->originalTransactionID, sizeof(purchase->originalTransactionID), "%llu",
+                 200000000000000ULL + (subscription ? i % 7 : i));
+        AIUAReceiptFixtureRandomDate(&random, purchase->purchaseDate, sizeof(purchase->purchaseDate));
+        if (subscription) {
+            AIUAReceiptFixtureRandomDate(&random, purchase->expiresDate, sizeof(purchase->expiresDate));
+        }
+        purchase->cancelled = AIUATestRandomBelow(&random, 17) == 0;
+        purchase->quantity = 1 + (int64_t)AIUATestRandomBelow(&random, 3);
+        purchase->webOrderLineItemID = subscription ? (int64_t)(1000000000000ULL + AIUATestRandomBelow(&random, 1u << 30)) : 0;
+
+        AIUATestBuffer fields = {0};
+        AIUAReceiptFixtureIntegerAttribute(&fields, 1701, purchase->quantity);
+        AIUAReceiptFixtureStringAttribute(&fields, 1702, 0x0C, purchase->productID);
+        AIUAReceiptFixtureStringAttribute(&fields, 1703, 0x0C, purchase->transactionID);
+        AIUAReceiptFixtureStringAttribute(&fields, 1704, 0x16, purchase->purchaseDate);
+        AIUAReceiptFixtureStringAttribute(&fields, 1705, 0x0C, purchase->originalTransactionID);
+        AIUAReceiptFixtureStringAttribute(&fields, 1706, 0x16, purchase->purchaseDate);
+        if (subscription) {
+            AIUAReceiptFixtureStringAttribute(&fields, 1708, 0x16, purchase->expiresDate);
+            AIUAReceiptFixtureIntegerAttribute(&fields, 1711, purchase->webOrderLineItemID);
+        }
+        if (purchase->cancelled) {
+            AIUAReceiptFixtureStringAttribute(&fields, 1712, 0x16, purchase->purchaseDate);
+        }
+        AIUAReceiptFixtureIntegerAttribute(&fields, 1719, 0);                    // 未知属性应被跳过
+        AIUATestBuffer set = {0};
+        AIUAReceiptFixtureWrap(&set, 0x31, &fields, false);
+        AIUAReceiptFixtureAttribute(&attributes, 17, &set);
+        AIUATestBufferFree(&set);
+        AIUATestBufferFree(&fields);
+    }
+    AIUATestBuffer payload = {0};
+    AIUAReceiptFixtureWrap(&payload, 0x31, &attributes, false);
+    AIUATestBufferFree(&attributes);
+
+    bool indefinite = encoding != AIUAReceiptFixtureDER;
+    AIUATestBuffer octets = {0};
+    if (encoding == AIUAReceiptFixtureChunked) {
+        AIUATestBuffer chunks = {0};
+        for (size_t offset = 0; offset < payload.length; offset += 1000) {
+            size_t length = payload.length - offset < 1000 ? payload.length - offset : 1000;
+            AIUAReceiptFixtureTLV(&chunks, 0x04, payload.bytes + offset, length);
+        }
+        AIUAReceiptFixtureWrap(&octets, 0x24, &chunks, true);
+        AIUATestBufferFree(&chunks);
+    } else {
+        AIUAReceiptFixtureTLV(&octets, 0x04, payload.bytes, payload.length);
+    }
+    AIUATestBufferFree(&payload);
+
+    static const uint8_t oidData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01};
+    static const uint8_t oidSignedData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02};
+    static const uint8_t oidSHA256[] = {0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01};
+
+    // EncapsulatedContentInfo ::= SEQUENCE { OID data, [0] EXPLICIT OCTET STRING }
+    AIUATestBuffer explicitContent = {0};
+    AIUAReceiptFixtureWrap(&explicitContent, 0xA0, &octets, indefinite);
+    AIUATestBuffer encapsulated = {0};
+    AIUAReceiptFixtureTLV(&encapsulated, 0x06, oidData, sizeof(oidData));
+    AIUATestBufferAppend(&encapsulated, explicitContent.bytes, explicitContent.length);
+
+    // SignedData ::= SEQUENCE { version, digestAlgorithms, encapContentInfo, [0] certificates, signerInfos }
+    AIUATestBuffer digest = {0};
+    AIUATestBuffer algorithm = {0};
+    AIUAReceiptFixtureTLV(&algorithm, 0x06, oidSHA256, sizeof(oidSHA256));
+    AIUAReceiptFixtureWrap(&digest, 0x30, &algorithm, false);
+    AIUATestBuffer signedData = {0};
+    AIUAReceiptFixtureInteger(&signedData, 1);
+    AIUAReceiptFixtureWrap(&signedData, 0x31, &digest, false);
+    AIUAReceiptFixtureWrap(&signedData, 0x30, &encapsulated, indefinite);
+    AIUATestBuffer certificate = {0};
+    for (int i = 0; i < 64; i++) {
+        AIUATestBufferAppendString(&certificate, "cert");
+    }
+    AIUATestBuffer certificates = {0};
+    AIUAReceiptFixtureWrap(&certificates, 0x30, &certificate, false);
+    AIUAReceiptFixtureWrap(&signedData, 0xA0, &certificates, indefinite);
+    AIUAReceiptFixtureTLV(&signedData, 0x31, NULL, 0);
+
+    AIUATestBuffer signedSequence = {0};
+    AIUAReceiptFixtureWrap(&signedSequence, 0x30, &signedData, indefinite);
+    AIUATestBuffer contentInfo = {0};
+    AIUAReceiptFixtureTLV(&contentInfo, 0x06, oidSignedData, sizeof(oidSignedData));
+    AIUAReceiptFixtureWrap(&contentInfo, 0xA0, &signedSequence, indefinite);
+    AIUAReceiptFixtureWrap(&fixture->receipt, 0x30, &contentInfo, indefinite);
+
+    AIUATestBuffer *temporaries[] = {&octets, &explicitContent, &encapsulated, &digest, &algorithm, &signedData,
+                                     &certificate, &certificates, &signedSequence, &contentInfo};
+    for (size_t i = 0; i < sizeof(temporaries) / sizeof(temporaries[0]); i++) {
+        AIUATestBufferFree(temporaries[i]);
+    }
+}
+
+static inline void AIUAReceiptFixtureFree(AIUAReceiptFixture *fixture) {
+    AIUATestBufferFree(&fixture->receipt);
+    free(fixture->purchases);
+    memset(fixture, 0, sizeof(*fixture));
+}
+
+#endif /* AIUAReceiptFixture_h */
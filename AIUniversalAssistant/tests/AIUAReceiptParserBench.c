@@ -0,0 +1,64 @@
+//
+//  AIUAReceiptParserBench.c
+//  AIUniversalAssistant
+//
+//  AIUAReceiptParser 基准：含 1 ~ 2000 条内购记录的合成收据（DER 与分段负载），
+//  每条记录回调中像 AIUAIAPManager 一样解析到期时间，统计单次解析耗时与吞吐
+//  用法：AIUAReceiptParserBench
+//
+
+#include "AIUAReceiptFixture.h"
+#include "AIUAReceiptParser.h"
+
+typedef struct {
+    int64_t latestExpiry;
+    size_t purchases;
+} AIUABenchContext;
+
+static void AIUABenchPurchase(const AIUAReceiptInAppPurchase *purchase, void *context) {
+    AIUABenchContext *bench = (AIUABenchContext *)context;
+    int64_t expiry = 0;
+    if (purchase->cancellationDate.length == 0 && AIUAReceiptParseDate(purchase->expiresDate, &expiry) &&
+        expiry > bench->latestExpiry) {
+        bench->latestExpiry = expiry;
+    }
+    bench->purchases++;
+}
+
+int main(void) {
+    const size_t counts[] = {1, 50, 200, 500, 2000};
+    const AIUAReceiptFixtureEncoding encodings[] = {AIUAReceiptFixtureDER, AIUAReceiptFixtureChunked};
+    printf("[AIUAReceiptParser] 合成收据解析（含到期时间解析）\n");
+    printf("  条数       大小         单次       MB/s         每条  编码\n");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (size_t e = 0; e < sizeof(encodings) / sizeof(encodings[0]); e++) {
+            AIUAReceiptFixture fixture;
+            AIUAReceiptFixtureBuild(&fixture, counts[c], encodings[e], 1);
+            // 约 0.2 秒
+            size_t rounds = 1 + (size_t)(200000000.0 / (fixture.receipt.length * 4.0));
+            AIUABenchContext bench = {0, 0};
+            double start = AIUATestNow();
+            for (size_t round = 0; round < rounds; round++) {
+                AIUAReceiptInfo info;
+                if (AIUAReceiptParse(fixture.receipt.bytes, fixture.receipt.length, &info, AIUABenchPurchase, &bench) !=
+                    AIUAReceiptParseOK) {
+                    fprintf(stderr, "解析失败\n");
+                    return 1;
+                }
+                AIUAReceiptInfoRelease(&info);
+            }
+            double elapsed = AIUATestNow() - start;
+            if (bench.purchases != rounds * counts[c]) {
+                fprintf(stderr, "内购记录条数不一致\n");
+                return 1;
+            }
+            double perParse = elapsed / rounds;
+            printf("  %4zu %7.1f KB %9.2f µs %10.1f %9.1f ns  %s\n",
+                   counts[c], fixture.receipt.length / 1024.0, perParse * 1e6,
+                   fixture.receipt.length / perParse / 1048576.0, perParse * 1e9 / counts[c],
+                   AIUAReceiptFixtureEncodingNames[encodings[e]]);
+            AIUAReceiptFixtureFree(&fixture);
+        }
+    }
+    return 0;
+}
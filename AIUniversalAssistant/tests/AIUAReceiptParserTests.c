@@ -0,0 +1,304 @@
+//
+//  AIUAReceiptParserTests.c
+//  AIUniversalAssistant
+//
+//  AIUAReceiptParser 测试：DER / BER / 分段负载的合成收据逐字段解码、错误码、RFC 3339 时间，
+//  以及对收据随机改写（翻转、截断、删改长度字节、插入/删除片段）的模糊测试
+//  模糊测试下解析结果中的每个字符串都必须落在输入或 info->storage 之内（配合 ASan 运行）
+//  用法：AIUAReceiptParserTests [每种编码的模糊轮数]
+//
+
+#include "AIUAReceiptFixture.h"
+#include "AIUAReceiptParser.h"
+
+static bool AIUATestStringEquals(AIUAReceiptString string, const char *expected) {
+    size_t length = strlen(expected);
+    return string.length == length && (length == 0 || memcmp(string.bytes, expected, length) == 0);
+}
+
+#pragma mark - 逐字段解码
+
+typedef struct {
+    const AIUAReceiptFixture *fixture;
+    size_t index;
+    int mismatches;
+} AIUATestDecodeContext;
+
+static void AIUATestCheckPurchase(const AIUAReceiptInAppPurchase *purchase, void *context) {
+    AIUATestDecodeContext *decode = (AIUATestDecodeContext *)context;
+    if (decode->index >= decode->fixture->purchaseCount) {
+        decode->mismatches++;
+        return;
+    }
+    const AIUAReceiptFixturePurchase *expected = &decode->fixture->purchases[decode->index++];
+    bool ok = AIUATestStringEquals(purchase->productID, expected->productID) &&
+              AIUATestStringEquals(purchase->transactionID, expected->transactionID) &&
+              AIUATestStringEquals(purchase->originalTransactionID, expected->originalTransactionID) &&
+              AIUATestStringEquals(purchase->purchaseDate, expected->purchaseDate) &&
+              AIUATestStringEquals(purchase->originalPurchaseDate, expected->purchaseDate) &&
+              AIUATestStringEquals(purchase->expiresDate, expected->expiresDate) &&
+              AIUATestStringEquals(purchase->cancellationDate, expected->cancelled ? expected->purchaseDate : "") &&
+              purchase->quantity == expected->quantity &&
+              purchase->webOrderLineItemID == expected->webOrderLineItemID;
+    if (!ok) {
+        decode->mismatches++;
+        if (decode->mismatches <= 3) {
+            fprintf(stderr, "  第 %zu 条内购记录与期望不一致（%s）\n", decode->index, expected->productID);
+        }
+    }
+}
+
+static void AIUATestDecode(void) {
+    const size_t counts[] = {0, 1, 37, 500};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        for (int encoding = 0; encoding < AIUAReceiptFixtureEncodingCount; encoding++) {
+            AIUAReceiptFixture fixture;
+            AIUAReceiptFixtureBuild(&fixture, counts[c], (AIUAReceiptFixtureEncoding)encoding, 7);
+            AIUATestDecodeContext decode = {&fixture, 0, 0};
+            AIUAReceiptInfo info;
+            AIUAReceiptParseResult result = AIUAReceiptParse(fixture.receipt.bytes, fixture.receipt.length, &info,
+                                                             AIUATestCheckPurchase, &decode);
+            const char *name = AIUAReceiptFixtureEncodingNames[encoding];
+            AIUA_CHECK_MSG(result == AIUAReceiptParseOK, "%s %zu 条：结果 %d", name, counts[c], result);
+            AIUA_CHECK(AIUATestStringEquals(info.bundleID, AIUAReceiptFixtureBundleID));
+            AIUA_CHECK(AIUATestStringEquals(info.appVersion, AIUAReceiptFixtureAppVersion));
+            AIUA_CHECK(AIUATestStringEquals(info.creationDate, "2026-01-01T00:00:00Z"));
+            AIUA_CHECK(info.originalAppVersion.length == 0 && info.expirationDate.length == 0);
+            AIUA_CHECK_MSG(info.inAppPurchaseCount == counts[c] && decode.index == counts[c],
+                           "%s：解析出 %zu 条，回调 %zu 次，期望 %zu 条", name, info.inAppPurchaseCount, decode.index, counts[c]);
+            AIUA_CHECK_MSG(decode.mismatches == 0, "%s %zu 条：%d 条内购记录不一致", name, counts[c], decode.mismatches);
+            // 只有分段负载需要拼接；定长负载的字符串直接指向输入
+            if (encoding == AIUAReceiptFixtureChunked && counts[c] > 0) {
+                AIUA_CHECK(info.storage != NULL);
+            } else if (encoding != AIUAReceiptFixtureChunked) {
+                AIUA_CHECK(info.storage == NULL);
+                AIUA_CHECK(info.bundleID.bytes > fixture.receipt.bytes &&
+                           info.bundleID.bytes + info.bundleID.length <= fixture.receipt.bytes + fixture.receipt.length);
+            }
+            AIUAReceiptInfoRelease(&info);
+            AIUA_CHECK(info.storage == NULL && info.inAppPurchaseCount == 0);
+
+            // handler 为 NULL 时只计数
+            result = AIUAReceiptParse(fixture.receipt.bytes, fixture.receipt.length, &info, NULL, NULL);
+            AIUA_CHECK(result == AIUAReceiptParseOK && info.inAppPurchaseCount == counts[c]);
+            AIUAReceiptInfoRelease(&info);
+            AIUAReceiptFixtureFree(&fixture);
+        }
+    }
+}
+
+#pragma mark - 错误码
+
+static void AIUATestErrors(void) {
+    AIUAReceiptInfo info;
+    AIUA_CHECK(AIUAReceiptParse(NULL, 10, &info, NULL, NULL) == AIUAReceiptParseErrorMalformed);
+    AIUAReceiptInfoRelease(&info);
+    static const uint8_t one[] = {0x30};
+    AIUA_CHECK(AIUAReceiptParse(one, 0, &info, NULL, NULL) == AIUAReceiptParseErrorMalformed);
+    AIUA_CHECK(AIUAReceiptParse(one, 1, &info, NULL, NULL) == AIUAReceiptParseErrorMalformed);
+    AIUAReceiptInfoRelease(&info);
+
+    // ContentInfo 的类型是 pkcs7-data 而不是 signedData
+    static const uint8_t notSigned[] = {0x30, 0x0F, 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01,
+                                        0xA0, 0x02, 0x04, 0x00};
+    AIUA_CHECK(AIUAReceiptParse(notSigned, sizeof(notSigned), &info, NULL, NULL) == AIUAReceiptParseErrorNotSignedData);
+    AIUAReceiptInfoRelease(&info);
+
+    // SignedData 的 encapContentInfo 没有 [0] 负载（分离签名）
+    static const uint8_t detached[] = {0x30, 0x23, 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02,
+                                       0xA0, 0x16, 0x30, 0x14, 0x02, 0x01, 0x01, 0x31, 0x00,
+                                       0x30, 0x0B, 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01,
+                                       0x31, 0x00};
+    AIUAReceiptParseResult result = AIUAReceiptParse(detached, sizeof(detached), &info, NULL, NULL);
+    AIUA_CHECK_MSG(result == AIUAReceiptParseErrorNoPayload, "结果 %d", result);
+    AIUAReceiptInfoRelease(&info);
+
+    // 定长编码的任何截断都必须失败，且不越界读取
+    AIUAReceiptFixture fixture;
+    AIUAReceiptFixtureBuild(&fixture, 5, AIUAReceiptFixtureDER, 3);
+    size_t accepted = 0;
+    for (size_t length = 0; length < fixture.receipt.length; length++) {
+        uint8_t *copy = (uint8_t *)malloc(length ? length : 1);
+        memcpy(copy, fixture.receipt.bytes, length);
+        if (AIUAReceiptParse(copy, length, &info, NULL, NULL) == AIUAReceiptParseOK) {
+            accepted++;
+        }
+        AIUAReceiptInfoRelease(&info);
+        free(copy);
+    }
+    AIUA_CHECK_MSG(accepted == 0, "%zu 个截断的 DER 收据被当作有效", accepted);
+    AIUAReceiptFixtureFree(&fixture);
+}
+
+#pragma mark - 时间
+
+static void AIUATestDates(void) {
+    static const struct {
+        const char *text;
+        bool valid;
+        int64_t seconds;
+    } cases[] = {
+        {"1970-01-01T00:00:00Z", true, 0},
+        {"2024-05-01T08:00:00Z", true, 1714550400},
+        {"2024-02-29T12:34:56Z", true, 1709210096},
+        {"2000-03-01T00:00:00Z", true, 951868800},
+        {"1969-12-31T23:59:59Z", true, -1},
+        {"2038-01-19T03:14:08Z", true, 2147483648LL},
+        {"2024-05-01T08:00:00.123Z", true, 1714550400},
+        {"2024-05-01T16:00:00+08:00", true, 1714550400},
+        {"2024-05-01T03:30:00-04:30", true, 1714550400},
+        {"2024-05-01 08:00:00Z", true, 1714550400},
+        {"2024-05-01t08:00:00z", true, 1714550400},
+        {"2024-05-01T08:00:00", false, 0},
+        {"2024-05-01T08:00Z", false, 0},
+        {"2024-13-01T08:00:00Z", false, 0},
+        {"2024-00-10T08:00:00Z", false, 0},
+        {"2024-05-32T08:00:00Z", false, 0},
+        {"2024-05-01T24:00:00Z", false, 0},
+        {"2024-05-01T08:60:00Z", false, 0},
+        {"2024-05-01T08:00:00Zx", false, 0},
+        {"2024-05-01T08:00:00+0800", false, 0},
+        {"2024/05/01T08:00:00Z", false, 0},
+        {"", false, 0},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        AIUAReceiptString string = {(const uint8_t *)cases[i].text, strlen(cases[i].text)};
+        int64_t seconds = 0;
+        bool valid = AIUAReceiptParseDate(string, &seconds);
+        AIUA_CHECK_MSG(valid == cases[i].valid && (!valid || seconds == cases[i].seconds),
+                       "%s：%d %lld", cases[i].text, valid, (long long)seconds);
+    }
+    // 不以 NUL 结尾的缓冲区：只读 length 个字节
+    const char *padded = "2024-05-01T08:00:00Z9999";
+    int64_t seconds = 0;
+    AIUA_CHECK(AIUAReceiptParseDate((AIUAReceiptString){(const uint8_t *)padded, 20}, &seconds) && seconds == 1714550400);
+    AIUA_CHECK(!AIUAReceiptParseDate((AIUAReceiptString){NULL, 0}, &seconds));
+}
+
+#pragma mark - 模糊测试
+
+typedef struct {
+    const uint8_t *input;
+    size_t length;
+    const AIUAReceiptInfo *info;
+    size_t outOfBounds;
+} AIUATestFuzzContext;
+
+static bool AIUATestStringInBounds(const AIUATestFuzzContext *fuzz, AIUAReceiptString string) {
+    if (string.length == 0) {
+        return true;
+    }
+    const uint8_t *storage = (const uint8_t *)fuzz->info->storage;
+    bool inInput = string.bytes >= fuzz->input && string.length <= fuzz->length &&
+                   string.bytes <= fuzz->input + fuzz->length - string.length;
+    // storage 的长度不公开，只能确认指向它之后；越界读取由 ASan 捕获
+    bool inStorage = storage && string.bytes >= storage;
+    return inInput || inStorage;
+}
+
+static void AIUATestFuzzPurchase(const AIUAReceiptInAppPurchase *purchase, void *context) {
+    AIUATestFuzzContext *fuzz = (AIUATestFuzzContext *)context;
+    const AIUAReceiptString strings[] = {purchase->productID, purchase->transactionID, purchase->purchaseDate,
+                                         purchase->originalTransactionID, purchase->originalPurchaseDate,
+                                         purchase->expiresDate, purchase->cancellationDate};
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+        if (!AIUATestStringInBounds(fuzz, strings[i])) {
+            fuzz->outOfBounds++;
+            continue;
+        }
+        // 读一遍字符串内容，越界时 ASan 报错；日期顺带走一遍解析
+        volatile uint8_t sink = 0;
+        for (size_t k = 0; k < strings[i].length; k++) {
+            sink ^= strings[i].bytes[k];
+        }
+        int64_t seconds;
+        AIUAReceiptParseDate(strings[i], &seconds);
+    }
+}
+
+static void AIUATestFuzz(size_t rounds) {
+    for (int encoding = 0; encoding < AIUAReceiptFixtureEncodingCount; encoding++) {
+        AIUAReceiptFixture fixture;
+        AIUAReceiptFixtureBuild(&fixture, 12, (AIUAReceiptFixtureEncoding)encoding, 11);
+        AIUATestRandom random;
+        AIUATestRandomSeed(&random, 1000 + (uint64_t)encoding);
+        size_t results[AIUAReceiptParseErrorOutOfMemory + 1] = {0};
+        size_t outOfBounds = 0;
+        size_t base = fixture.receipt.length;
+        uint8_t *mutated = (uint8_t *)malloc(base + 64);
+        for (size_t round = 0; round < rounds; round++) {
+            memcpy(mutated, fixture.receipt.bytes, base);
+            size_t length = base;
+            size_t edits = 1 + AIUATestRandomBelow(&random, 4);
+            for (size_t e = 0; e < edits && length > 0; e++) {
+                size_t at = AIUATestRandomBelow(&random, length);
+                switch (AIUATestRandomBelow(&random, 6)) {
+                    case 0:     // 翻转一位
+                        mutated[at] ^= (uint8_t)(1u << AIUATestRandomBelow(&random, 8));
+                        break;
+                    case 1:     // 改成边界值
+                        mutated[at] = (uint8_t[]){0x00, 0x7F, 0x80, 0x81, 0x84, 0x89, 0xFF}[AIUATestRandomBelow(&random, 7)];
+                        break;
+                    case 2:     // 随机字节
+                        mutated[at] = (uint8_t)AIUATestRandomNext(&random);
+                        break;
+                    case 3:     // 截断
+                        length = at;
+                        break;
+                    case 4: {   // 删除一段
+                        size_t count = 1 + AIUATestRandomBelow(&random, 16);
+                        count = at + count > length ? length - at : count;
+                        memmove(mutated + at, mutated + at + count, length - at - count);
+                        length -= count;
+                        break;
+                    }
+                    default: {  // 插入一段（长度字段不变，结构错位）
+                        size_t count = 1 + AIUATestRandomBelow(&random, 8);
+                        if (length + count <= base + 64) {
+                            memmove(mutated + at + count, mutated + at, length - at);
+                            for (size_t k = 0; k < count; k++) {
+                                mutated[at + k] = (uint8_t)AIUATestRandomNext(&random);
+                            }
+                            length += count;
+                        }
+                        break;
+                    }
+                }
+            }
+            // 精确大小的副本，越界读取由 ASan 捕获
+            uint8_t *input = (uint8_t *)malloc(length ? length : 1);
+            memcpy(input, mutated, length);
+            AIUAReceiptInfo info;
+            AIUATestFuzzContext fuzz = {input, length, &info, 0};
+            AIUAReceiptParseResult result = AIUAReceiptParse(input, length, &info, AIUATestFuzzPurchase, &fuzz);
+            const AIUAReceiptString strings[] = {info.bundleID, info.appVersion, info.creationDate,
+                                                 info.originalAppVersion, info.expirationDate};
+            for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+                fuzz.outOfBounds += !AIUATestStringInBounds(&fuzz, strings[i]);
+            }
+            if ((size_t)result < sizeof(results) / sizeof(results[0])) {
+                results[result]++;
+            }
+            outOfBounds += fuzz.outOfBounds;
+            AIUAReceiptInfoRelease(&info);
+            free(input);
+        }
+        AIUA_CHECK_MSG(outOfBounds == 0, "%s：%zu 个字符串越界", AIUAReceiptFixtureEncodingNames[encoding], outOfBounds);
+        AIUA_CHECK(results[AIUAReceiptParseErrorOutOfMemory] == 0);
+        printf("  %s 模糊 %zu 轮：成功 %zu  结构错误 %zu  非 SignedData %zu  无负载 %zu\n",
+               AIUAReceiptFixtureEncodingNames[encoding], rounds, results[AIUAReceiptParseOK],
+               results[AIUAReceiptParseErrorMalformed], results[AIUAReceiptParseErrorNotSignedData],
+               results[AIUAReceiptParseErrorNoPayload]);
+        free(mutated);
+        AIUAReceiptFixtureFree(&fixture);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    AIUATestDecode();
+    AIUATestErrors();
+    AIUATestDates();
+    AIUATestFuzz(rounds);
+    return AIUATestSummary("AIUAReceiptParser");
+}
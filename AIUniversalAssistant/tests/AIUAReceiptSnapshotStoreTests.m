@@ -0,0 +1,173 @@
+//
+//  AIUAReceiptSnapshotStoreTests.m
+//  AIUniversalAssistant
+//
+//  AIUAReceiptSnapshotStore 测试：临时目录中的收据文件 + 独立 suite 的 NSUserDefaults
+//  - 收据未变化时返回快照；大小或修改时间变化、应用版本升级、超过最长沿用时间、收据缺失时返回 nil
+//  - 验证期间收据被替换（大小与验证内容不一致）时不保存快照
+//  - 后台复核：内容一致时不回调；大小和修改时间不变但内容不同时回调一次；
+//    复核发起后快照失效（invalidateSnapshotForKey:），迟到的复核结果不回调
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAReceiptSnapshotStoreTests
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAReceiptSnapshotStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+static NSString * const kAIUATestSnapshotKey = @"kAIUAReceiptVerificationSnapshot.user.test";
+static const NSTimeInterval kAIUATestMaxAge = 7 * 24 * 60 * 60;
+// 收据文件固定使用整秒的修改时间，便于改写内容后恢复成相同的修改时间
+static const NSTimeInterval kAIUATestReceiptModificationTime = 1700000000;
+
+static NSData *AIUATestReceiptData(NSUInteger length, uint64_t seed) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = data.mutableBytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[i] = (uint8_t)AIUATestRandomBelow(&random, 256);
+    }
+    return data;
+}
+
+static void AIUATestWriteReceipt(NSURL *receiptURL, NSData *data, NSTimeInterval modificationTime) {
+    [data writeToURL:receiptURL atomically:YES];
+    [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate: [NSDate dateWithTimeIntervalSince1970:modificationTime]}
+                                     ofItemAtPath:receiptURL.path
+                                            error:nil];
+}
+
+static AIUAReceiptSnapshotStore *AIUATestMakeStore(NSURL *receiptURL, NSString *appVersion, NSUserDefaults *defaults) {
+    return [[AIUAReceiptSnapshotStore alloc] initWithReceiptURL:receiptURL
+                                                     appVersion:appVersion
+                                                       defaults:defaults
+                                                         maxAge:kAIUATestMaxAge];
+}
+
+static void AIUATestFingerprint(NSURL *receiptURL, NSUserDefaults *defaults) {
+    NSData *receipt = AIUATestReceiptData(4096, 1);
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime);
+    AIUAReceiptSnapshotStore *store = AIUATestMakeStore(receiptURL, @"1.0", defaults);
+
+    // 尚未保存
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+
+    // 验证内容与当前文件大小不一致（验证期间被替换）：不保存
+    AIUA_CHECK(![store saveSnapshotForReceiptData:AIUATestReceiptData(4000, 1) duration:0.01 forKey:kAIUATestSnapshotKey]);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+
+    // 收据未变化：返回快照
+    AIUA_CHECK([store saveSnapshotForReceiptData:receipt duration:0.01 forKey:kAIUATestSnapshotKey]);
+    NSDictionary *snapshot = [store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey];
+    AIUA_CHECK(snapshot != nil);
+    AIUA_CHECK([snapshot[@"receiptSize"] unsignedLongLongValue] == receipt.length);
+    AIUA_CHECK([snapshot[@"appVersion"] isEqualToString:@"1.0"]);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+
+    // 大小变化
+    NSMutableData *grown = [receipt mutableCopy];
+    [grown appendData:AIUATestReceiptData(16, 2)];
+    AIUATestWriteReceipt(receiptURL, grown, kAIUATestReceiptModificationTime);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+
+    // 大小不变、只有修改时间变化
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime + 1);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+
+    // 应用版本升级：新版本不沿用旧版本的快照
+    AIUAReceiptSnapshotStore *upgraded = AIUATestMakeStore(receiptURL, @"1.1", defaults);
+    AIUA_CHECK([upgraded snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+
+    // 超过最长沿用时间
+    NSMutableDictionary *stale = [snapshot mutableCopy];
+    stale[@"verifiedAt"] = [NSDate dateWithTimeIntervalSinceNow:-(kAIUATestMaxAge + 60)];
+    [defaults setObject:stale forKey:kAIUATestSnapshotKey];
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+    [defaults setObject:snapshot forKey:kAIUATestSnapshotKey];
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+
+    // 收据缺失
+    [[NSFileManager defaultManager] removeItemAtPath:receiptURL.path error:nil];
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+
+    // 失效：删除快照并递增代数
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime);
+    NSUInteger generation = store.generation;
+    [store invalidateSnapshotForKey:kAIUATestSnapshotKey];
+    AIUA_CHECK(store.generation == generation + 1);
+    AIUA_CHECK([defaults dictionaryForKey:kAIUATestSnapshotKey] == nil);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] == nil);
+}
+
+/// 发起复核并等待结束，返回 mismatchHandler 的调用次数；beforeResume 在后台读取收据之前执行
+static NSUInteger AIUATestRevalidate(AIUAReceiptSnapshotStore *store, NSDictionary *snapshot, void (^beforeResume)(void)) {
+    dispatch_queue_t workQueue = dispatch_queue_create("com.aiua.tests.receipt.work", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_t completionQueue = dispatch_queue_create("com.aiua.tests.receipt.completion", DISPATCH_QUEUE_SERIAL);
+    store.revalidationQueue = workQueue;
+    __block NSUInteger mismatches = 0;
+    dispatch_suspend(workQueue);
+    [store revalidateSnapshot:snapshot completionQueue:completionQueue mismatchHandler:^{
+        mismatches++;
+    }];
+    if (beforeResume) {
+        beforeResume();
+    }
+    dispatch_resume(workQueue);
+    // 后台比对结束后才会向 completionQueue 派发，依次等待两个队列
+    dispatch_sync(workQueue, ^{});
+    dispatch_sync(completionQueue, ^{});
+    return mismatches;
+}
+
+static void AIUATestBackgroundRevalidation(NSURL *receiptURL, NSUserDefaults *defaults) {
+    NSData *receipt = AIUATestReceiptData(4096, 3);
+    AIUATestWriteReceipt(receiptURL, receipt, kAIUATestReceiptModificationTime);
+    AIUAReceiptSnapshotStore *store = AIUATestMakeStore(receiptURL, @"1.0", defaults);
+    AIUA_CHECK([store saveSnapshotForReceiptData:receipt duration:0.01 forKey:kAIUATestSnapshotKey]);
+    NSDictionary *snapshot = [store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey];
+    AIUA_CHECK(snapshot != nil);
+
+    // 内容一致：不回调
+    AIUA_CHECK(AIUATestRevalidate(store, snapshot, nil) == 0);
+
+    // 大小和修改时间不变但内容不同：指纹仍匹配，复核回调一次
+    AIUATestWriteReceipt(receiptURL, AIUATestReceiptData(4096, 4), kAIUATestReceiptModificationTime);
+    AIUA_CHECK([store snapshotMatchingReceiptFileForKey:kAIUATestSnapshotKey] != nil);
+    AIUA_CHECK(AIUATestRevalidate(store, snapshot, nil) == 1);
+
+    // 复核发起后快照失效（如清除购买数据）：迟到的复核结果作废
+    AIUA_CHECK(AIUATestRevalidate(store, snapshot, ^{
+        [store invalidateSnapshotForKey:kAIUATestSnapshotKey];
+    }) == 0);
+    AIUA_CHECK([defaults dictionaryForKey:kAIUATestSnapshotKey] == nil);
+
+    // 收据缺失视为不一致
+    [[NSFileManager defaultManager] removeItemAtPath:receiptURL.path error:nil];
+    AIUA_CHECK(AIUATestRevalidate(store, snapshot, nil) == 1);
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSString *suiteName = [NSString stringWithFormat:@"com.aiua.tests.receipt-snapshot.%d", getpid()];
+        NSUserDefaults *defaults = [[NSUserDefaults alloc] initWithSuiteName:suiteName];
+        NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                               [NSString stringWithFormat:@"AIUAReceiptSnapshotStoreTests-%d", getpid()]];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        NSURL *receiptURL = [NSURL fileURLWithPath:[directory stringByAppendingPathComponent:@"receipt"]];
+
+        AIUATestFingerprint(receiptURL, defaults);
+        [defaults removeObjectForKey:kAIUATestSnapshotKey];
+        AIUATestBackgroundRevalidation(receiptURL, defaults);
+
+        [defaults removePersistentDomainForName:suiteName];
+        [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+        return AIUATestSummary("AIUAReceiptSnapshotStore");
+    }
+}
@@ -0,0 +1,155 @@
+//
+//  AIUASSEParserBench.c
+//  AIUniversalAssistant
+//
+//  AIUASSEParser 基准：以录制的 DeepSeek 流为模板合成长篇生成（约 6000 字扩写），
+//  按随机网络分包大小重放，对比增量解析与旧实现的做法（每收到一包就从头扫描整个累积缓冲区并按行拆分）
+//  用法：AIUASSEParserBench [夹具路径] [目标字数...]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUASSEParser.h"
+
+// 旧实现每包都重新扫描全部累积字节，这里只数完整事件，不做解码，已是该做法的下限
+static size_t AIUABenchNaiveCountEvents(const uint8_t *buffer, size_t length) {
+    size_t events = 0;
+    size_t lineStart = 0;
+    bool hasData = false;
+    for (size_t i = 0; i < length; i++) {
+        if (buffer[i] != '\n') {
+            continue;
+        }
+        if (i == lineStart) {
+            events += hasData ? 1 : 0;
+            hasData = false;
+        } else if (i - lineStart >= 5 && memcmp(buffer + lineStart, "data:", 5) == 0) {
+            hasData = true;
+        }
+        lineStart = i + 1;
+    }
+    return events;
+}
+
+static bool AIUABenchCountEvent(const AIUASSEEvent *event, void *context) {
+    size_t *count = (size_t *)context;
+    *count += event->dataLength > 0 ? 1 : 0;
+    return true;
+}
+
+// 取夹具中的内容事件作为模板，循环拼接出约 targetWords 字的流
+static uint8_t *AIUABenchSynthesizeStream(const uint8_t *recorded, size_t recordedLength, size_t targetWords, size_t *outLength, size_t *outEvents) {
+    AIUATestBuffer stream = {0};
+    size_t words = 0;
+    size_t events = 0;
+    while (words < targetWords) {
+        size_t lineStart = 0;
+        for (size_t i = 0; i + 1 < recordedLength && words < targetWords; i++) {
+            if (recorded[i] != '\n' || recorded[i + 1] != '\n') {
+                continue;
+            }
+            const uint8_t *frame = recorded + lineStart;
+            size_t frameLength = i + 2 - lineStart;
+            lineStart = i + 2;
+            const uint8_t *content = (const uint8_t *)memmem(frame, frameLength, "\"content\":\"", 11);
+            if (!content || memmem(frame, frameLength, "[DONE]", 6)) {
+                continue;
+            }
+            AIUATestBufferAppend(&stream, frame, frameLength);
+            events++;
+            // 按 UTF-8 首字节计字，与内容中汉字为主的实际情况接近
+            for (const uint8_t *p = content + 11; p < frame + frameLength && *p != '"'; p++) {
+                words += (*p & 0xC0) != 0x80 ? 1 : 0;
+            }
+        }
+    }
+    AIUATestBufferAppendString(&stream, "data: [DONE]\n\n");
+    *outLength = stream.length;
+    *outEvents = events + 1;
+    return stream.bytes;
+}
+
+static void AIUABenchRun(const uint8_t *stream, size_t length, size_t expectedEvents, size_t targetWords) {
+    // 分包大小 1~1400 字节，接近移动网络下 didReceiveData: 的实际粒度
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, targetWords);
+    size_t packetCount = 0;
+    size_t *packets = (size_t *)malloc(sizeof(size_t) * (length + 1));
+    for (size_t offset = 0; offset < length; packetCount++) {
+        size_t packet = 1 + AIUATestRandomBelow(&random, 1400);
+        packet = packet < length - offset ? packet : length - offset;
+        packets[packetCount] = packet;
+        offset += packet;
+    }
+
+    const int rounds = 20;
+    size_t events = 0;
+    double start = AIUATestNow();
+    for (int round = 0; round < rounds; round++) {
+        AIUASSEParser parser;
+        AIUASSEParserInit(&parser);
+        AIUATestBuffer buffer = {0};
+        size_t offset = 0;
+        events = 0;
+        for (size_t p = 0; p < packetCount; p++) {
+            AIUATestBufferAppend(&buffer, stream + offset, packets[p]);
+            offset += packets[p];
+            size_t consumed = AIUASSEParserFeed(&parser, buffer.bytes, buffer.length, AIUABenchCountEvent, &events);
+            AIUATestBufferDiscard(&buffer, consumed);
+            AIUASSEParserDidDiscard(&parser, consumed);
+        }
+        AIUASSEParserFinish(&parser, buffer.bytes, buffer.length, AIUABenchCountEvent, &events);
+        AIUATestBufferFree(&buffer);
+        AIUASSEParserDestroy(&parser);
+    }
+    double incremental = (AIUATestNow() - start) / rounds;
+    if (events != expectedEvents) {
+        fprintf(stderr, "事件数不符：%zu != %zu\n", events, expectedEvents);
+        exit(1);
+    }
+
+    // 旧做法：每包从头扫描累积缓冲区（n 较大时只跑一轮）
+    int naiveRounds = length > 1000000 ? 1 : 3;
+    volatile size_t naiveEvents = 0;
+    start = AIUATestNow();
+    for (int round = 0; round < naiveRounds; round++) {
+        size_t offset = 0;
+        for (size_t p = 0; p < packetCount; p++) {
+            offset += packets[p];
+            naiveEvents = AIUABenchNaiveCountEvents(stream, offset);
+        }
+    }
+    double naive = (AIUATestNow() - start) / naiveRounds;
+
+    printf("%6zu 字  %8zu 字节  %5zu 事件  %5zu 包  增量 %8.3f ms (%7.1f MB/s)  全量重扫 %9.3f ms  加速 %6.1fx\n",
+           targetWords, length, events, packetCount,
+           incremental * 1000.0, length / incremental / 1e6,
+           naive * 1000.0, naive / incremental);
+    if (naiveEvents != expectedEvents) {
+        fprintf(stderr, "全量重扫事件数不符：%zu != %zu\n", (size_t)naiveEvents, expectedEvents);
+        exit(1);
+    }
+    free(packets);
+}
+
+int main(int argc, char **argv) {
+    const char *fixture = argc > 1 ? argv[1] : "fixtures/deepseek_stream.sse";
+    size_t recordedLength = 0;
+    uint8_t *recorded = AIUATestReadFile(fixture, &recordedLength);
+    if (!recorded) {
+        fprintf(stderr, "无法读取 %s\n", fixture);
+        return 1;
+    }
+    size_t defaultTargets[] = {1000, 6000, 20000};
+    size_t targetCount = argc > 2 ? (size_t)(argc - 2) : sizeof(defaultTargets) / sizeof(defaultTargets[0]);
+    printf("[AIUASSEParser] 随机分包重放（1~1400 字节/包）\n");
+    for (size_t i = 0; i < targetCount; i++) {
+        size_t target = argc > 2 ? (size_t)strtoul(argv[i + 2], NULL, 10) : defaultTargets[i];
+        size_t length = 0;
+        size_t events = 0;
+        uint8_t *stream = AIUABenchSynthesizeStream(recorded, recordedLength, target, &length, &events);
+        AIUABenchRun(stream, length, events, target);
+        free(stream);
+    }
+    free(recorded);
+    return 0;
+}
@@ -0,0 +1,326 @@
+//
+//  AIUASSEParserTests.c
+//  AIUniversalAssistant
+//
+//  AIUASSEParser 测试：把录制的 DeepSeek 流按随机分片大小重放（LF / CRLF / CR 三种换行），
+//  结果必须与整段解析相同；另覆盖字段解析、BOM、注释、空 data、暂停分发与内存分配失败
+//  解析器以 -Drealloc=AIUATestRealloc 编译，用于注入分配失败
+//
+
+#include "AIUATestSupport.h"
+#include "AIUASSEParser.h"
+
+#pragma mark - 分配失败注入
+
+static long AIUATestReallocFailAfter = -1;   // 再成功多少次后失败，-1 表示不失败
+
+void *AIUATestRealloc(void *pointer, size_t size);
+void *AIUATestRealloc(void *pointer, size_t size) {
+    if (AIUATestReallocFailAfter == 0) {
+        return NULL;
+    }
+    if (AIUATestReallocFailAfter > 0) {
+        AIUATestReallocFailAfter--;
+    }
+    return realloc(pointer, size);
+}
+
+#pragma mark - 事件收集
+
+typedef struct {
+    char *data;
+    size_t dataLength;
+    char *eventType;   // 未提供时为 NULL
+    char *eventID;
+} AIUATestEvent;
+
+typedef struct {
+    AIUATestEvent *events;
+    size_t count;
+    size_t capacity;
+    size_t stopAfter;  // 收到这么多事件后回调返回 false，0 表示不暂停
+} AIUATestEventList;
+
+static char *AIUATestCopyBytes(const uint8_t *bytes, size_t length) {
+    char *copy = (char *)malloc(length + 1);
+    if (length > 0) {
+        memcpy(copy, bytes, length);
+    }
+    copy[length] = '\0';
+    return copy;
+}
+
+static bool AIUATestCollectEvent(const AIUASSEEvent *event, void *context) {
+    AIUATestEventList *list = (AIUATestEventList *)context;
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        list->events = (AIUATestEvent *)realloc(list->events, list->capacity * sizeof(AIUATestEvent));
+    }
+    AIUATestEvent *copy = &list->events[list->count++];
+    copy->data = AIUATestCopyBytes(event->data, event->dataLength);
+    copy->dataLength = event->dataLength;
+    copy->eventType = event->eventType ? AIUATestCopyBytes(event->eventType, event->eventTypeLength) : NULL;
+    copy->eventID = event->eventID ? AIUATestCopyBytes(event->eventID, event->eventIDLength) : NULL;
+    return list->stopAfter == 0 || list->count % list->stopAfter != 0;
+}
+
+static void AIUATestEventListFree(AIUATestEventList *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->events[i].data);
+        free(list->events[i].eventType);
+        free(list->events[i].eventID);
+    }
+    free(list->events);
+    memset(list, 0, sizeof(*list));
+}
+
+static bool AIUATestOptionalEquals(const char *a, const char *b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static bool AIUATestEventListsEqual(const AIUATestEventList *a, const AIUATestEventList *b) {
+    if (a->count != b->count) {
+        return false;
+    }
+    for (size_t i = 0; i < a->count; i++) {
+        const AIUATestEvent *x = &a->events[i];
+        const AIUATestEvent *y = &b->events[i];
+        if (x->dataLength != y->dataLength || memcmp(x->data, y->data, x->dataLength) != 0
+            || !AIUATestOptionalEquals(x->eventType, y->eventType)
+            || !AIUATestOptionalEquals(x->eventID, y->eventID)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#pragma mark - 按写作器的方式喂数据
+
+// 与 AIUADeepSeekStream 相同：累积缓冲区 → Feed → 丢弃已消费前缀 → 结束时 Finish
+static void AIUATestReplay(AIUASSEParser *parser,
+                           const uint8_t *stream,
+                           size_t length,
+                           AIUATestRandom *random,
+                           size_t maxFragment,
+                           AIUATestEventList *events) {
+    AIUATestBuffer buffer = {0};
+    size_t offset = 0;
+    while (offset < length) {
+        size_t fragment = random ? 1 + AIUATestRandomBelow(random, maxFragment) : length;
+        if (fragment > length - offset) {
+            fragment = length - offset;
+        }
+        AIUATestBufferAppend(&buffer, stream + offset, fragment);
+        offset += fragment;
+        size_t consumed = AIUASSEParserFeed(parser, buffer.bytes, buffer.length, AIUATestCollectEvent, events);
+        if (consumed > 0) {
+            AIUATestBufferDiscard(&buffer, consumed);
+            AIUASSEParserDidDiscard(parser, consumed);
+        }
+    }
+    AIUASSEParserFinish(parser, buffer.bytes, buffer.length, AIUATestCollectEvent, events);
+    AIUATestBufferFree(&buffer);
+}
+
+static void AIUATestParseString(const char *stream, AIUATestEventList *events, AIUASSEParser *parser) {
+    AIUATestReplay(parser, (const uint8_t *)stream, strlen(stream), NULL, 0, events);
+}
+
+// 把 LF 换行改写为 CRLF 或 CR
+static uint8_t *AIUATestConvertNewlines(const uint8_t *stream, size_t length, const char *newline, size_t *outLength) {
+    AIUATestBuffer buffer = {0};
+    for (size_t i = 0; i < length; i++) {
+        if (stream[i] == '\n') {
+            AIUATestBufferAppendString(&buffer, newline);
+        } else {
+            AIUATestBufferAppend(&buffer, stream + i, 1);
+        }
+    }
+    *outLength = buffer.length;
+    return buffer.bytes;
+}
+
+#pragma mark - 用例
+
+static void AIUATestRecordedStream(const char *fixturePath) {
+    size_t length = 0;
+    uint8_t *recorded = AIUATestReadFile(fixturePath, &length);
+    AIUA_CHECK_MSG(recorded != NULL, "无法读取 %s", fixturePath);
+    if (!recorded) {
+        return;
+    }
+
+    const char *newlines[] = {"\n", "\r\n", "\r"};
+    for (size_t variant = 0; variant < 3; variant++) {
+        size_t streamLength = 0;
+        uint8_t *stream = AIUATestConvertNewlines(recorded, length, newlines[variant], &streamLength);
+
+        AIUASSEParser parser;
+        AIUASSEParserInit(&parser);
+        AIUATestEventList reference = {0};
+        AIUATestReplay(&parser, stream, streamLength, NULL, 0, &reference);
+        AIUA_CHECK(reference.count == 105);
+        AIUA_CHECK(parser.totalCommentLines == 2);
+        AIUA_CHECK(reference.count > 0 && strcmp(reference.events[reference.count - 1].data, "[DONE]") == 0);
+        AIUA_CHECK(reference.count > 1 && strstr(reference.events[1].data, "\"content\":\"") != NULL);
+        AIUASSEParserDestroy(&parser);
+
+        // 每种换行 600 个种子，分片上限在 1 字节到整包之间变化，覆盖多字节字符与 CRLF 被拆开的情况
+        for (uint64_t seed = 1; seed <= 600; seed++) {
+            AIUATestRandom random;
+            AIUATestRandomSeed(&random, seed * 31 + variant);
+            size_t maxFragment = (size_t[]){1, 3, 17, 64, 300, 1500}[seed % 6];
+            AIUASSEParserInit(&parser);
+            AIUATestEventList events = {0};
+            AIUATestReplay(&parser, stream, streamLength, &random, maxFragment, &events);
+            AIUA_CHECK_MSG(AIUATestEventListsEqual(&reference, &events),
+                           "换行变体 %zu 种子 %llu 分片上限 %zu：事件序列与整段解析不同",
+                           variant, (unsigned long long)seed, maxFragment);
+            AIUA_CHECK(parser.totalBytesScanned <= streamLength);
+            AIUATestEventListFree(&events);
+            AIUASSEParserDestroy(&parser);
+        }
+        AIUATestEventListFree(&reference);
+        free(stream);
+    }
+    free(recorded);
+}
+
+static void AIUATestFields(void) {
+    AIUASSEParser parser;
+    AIUASSEParserInit(&parser);
+    AIUATestEventList events = {0};
+    AIUATestParseString("event: update\nid: 42\ndata:first\ndata:  second\ndata\n\n"
+                        "retry: 1500\nretry: 12x\n: comment\nunknown: field\ndata: next\n\n",
+                        &events, &parser);
+    AIUA_CHECK(events.count == 2);
+    if (events.count == 2) {
+        // 多行 data 以 \n 连接；冒号后只去掉一个空格；没有冒号的 data 行值为空
+        AIUA_CHECK(strcmp(events.events[0].data, "first\n second\n") == 0);
+        AIUA_CHECK(AIUATestOptionalEquals(events.events[0].eventType, "update"));
+        AIUA_CHECK(AIUATestOptionalEquals(events.events[0].eventID, "42"));
+        AIUA_CHECK(strcmp(events.events[1].data, "next") == 0);
+        AIUA_CHECK(events.events[1].eventType == NULL && events.events[1].eventID == NULL);
+    }
+    AIUA_CHECK(parser.retryMilliseconds == 1500);
+    AIUA_CHECK(parser.totalCommentLines == 1);
+    AIUA_CHECK(strcmp(parser.lastEventID, "42") == 0);
+    AIUATestEventListFree(&events);
+
+    // 续传时保留 lastEventID 与 retry
+    AIUASSEParserReset(&parser, true);
+    AIUA_CHECK(strcmp(parser.lastEventID, "42") == 0 && parser.retryMilliseconds == 1500);
+    AIUASSEParserReset(&parser, false);
+    AIUA_CHECK(parser.lastEventIDLength == 0 && parser.retryMilliseconds == -1);
+    AIUASSEParserDestroy(&parser);
+
+    // 包含 NUL 的 id 按规范忽略
+    AIUASSEParserInit(&parser);
+    const uint8_t withNUL[] = "id: 7\n\nid: a\0b\ndata: x\n\n";
+    AIUATestReplay(&parser, withNUL, sizeof(withNUL) - 1, NULL, 0, &events);
+    AIUA_CHECK(events.count == 1 && events.events[0].eventID == NULL);
+    AIUA_CHECK(strcmp(parser.lastEventID, "7") == 0);
+    AIUATestEventListFree(&events);
+    AIUASSEParserDestroy(&parser);
+}
+
+static void AIUATestEmptyData(void) {
+    AIUASSEParser parser;
+    AIUASSEParserInit(&parser);
+    AIUATestEventList events = {0};
+    // data 为空的事件不分发，但 id 仍记录下来
+    AIUATestParseString("id: 3\ndata:\n\ndata: \n\nevent: ping\n\ndata: ok\n\n", &events, &parser);
+    AIUA_CHECK(events.count == 1 && strcmp(events.events[0].data, "ok") == 0);
+    AIUA_CHECK(strcmp(parser.lastEventID, "3") == 0);
+    AIUA_CHECK(parser.totalEventsDispatched == 1);
+    AIUATestEventListFree(&events);
+    AIUASSEParserDestroy(&parser);
+}
+
+static void AIUATestBOMAndFinish(void) {
+    const uint8_t stream[] = "\xEF\xBB\xBF" "data: a\n\ndata: tail";
+    for (size_t split = 1; split < sizeof(stream) - 1; split++) {
+        AIUASSEParser parser;
+        AIUASSEParserInit(&parser);
+        AIUATestEventList events = {0};
+        AIUATestBuffer buffer = {0};
+        AIUATestBufferAppend(&buffer, stream, split);
+        size_t consumed = AIUASSEParserFeed(&parser, buffer.bytes, buffer.length, AIUATestCollectEvent, &events);
+        AIUATestBufferDiscard(&buffer, consumed);
+        AIUASSEParserDidDiscard(&parser, consumed);
+        AIUATestBufferAppend(&buffer, stream + split, sizeof(stream) - 1 - split);
+        consumed = AIUASSEParserFeed(&parser, buffer.bytes, buffer.length, AIUATestCollectEvent, &events);
+        AIUATestBufferDiscard(&buffer, consumed);
+        AIUASSEParserDidDiscard(&parser, consumed);
+        // 最后一个事件没有以空行结束，Finish 时宽松分发
+        AIUASSEParserFinish(&parser, buffer.bytes, buffer.length, AIUATestCollectEvent, &events);
+        AIUA_CHECK_MSG(events.count == 2, "拆分位置 %zu", split);
+        if (events.count == 2) {
+            AIUA_CHECK(strcmp(events.events[0].data, "a") == 0);
+            AIUA_CHECK(strcmp(events.events[1].data, "tail") == 0);
+        }
+        AIUATestEventListFree(&events);
+        AIUATestBufferFree(&buffer);
+        AIUASSEParserDestroy(&parser);
+    }
+}
+
+static void AIUATestPauseDispatch(void) {
+    const char *stream = "data: 1\n\ndata: 2\n\ndata: 3\n\n";
+    AIUASSEParser parser;
+    AIUASSEParserInit(&parser);
+    AIUATestEventList events = {0};
+    events.stopAfter = 1;
+    // 回调返回 false 时停止分发，剩余字节保留到下一次 Feed
+    size_t length = strlen(stream);
+    size_t consumed = AIUASSEParserFeed(&parser, (const uint8_t *)stream, length, AIUATestCollectEvent, &events);
+    AIUA_CHECK(events.count == 1 && consumed == strlen("data: 1\n\n"));
+    consumed = AIUASSEParserFeed(&parser, (const uint8_t *)stream, length, AIUATestCollectEvent, &events);
+    AIUA_CHECK(events.count == 2 && consumed == 2 * strlen("data: 1\n\n"));
+    consumed = AIUASSEParserFeed(&parser, (const uint8_t *)stream, length, AIUATestCollectEvent, &events);
+    AIUA_CHECK(events.count == 3 && consumed == length);
+    AIUATestEventListFree(&events);
+    AIUASSEParserDestroy(&parser);
+}
+
+static void AIUATestAllocationFailure(void) {
+    // 多行 data 拼接时分配失败：不能把截断的数据当作完整事件分发，并停止后续解析
+    // failAfter = 0 在首次分配暂存区时失败，= 1 在暂存区扩容时失败（第三行超过初始容量）
+    char stream[1024];
+    char longLine[600];
+    memset(longLine, 'x', sizeof(longLine) - 1);
+    longLine[sizeof(longLine) - 1] = '\0';
+    snprintf(stream, sizeof(stream), "data: ok\n\ndata: line1\ndata: line2\ndata: %s\n\ndata: after\n\n", longLine);
+    for (long failAfter = 0; failAfter < 2; failAfter++) {
+        AIUASSEParser parser;
+        AIUASSEParserInit(&parser);
+        AIUATestEventList events = {0};
+        AIUATestReallocFailAfter = failAfter;
+        AIUATestParseString(stream, &events, &parser);
+        AIUATestReallocFailAfter = -1;
+        AIUA_CHECK(parser.failed);
+        AIUA_CHECK(events.count == 1 && strcmp(events.events[0].data, "ok") == 0);
+        AIUATestEventListFree(&events);
+
+        // 重置后恢复正常
+        AIUASSEParserReset(&parser, true);
+        AIUATestParseString("data: a\ndata: b\n\n", &events, &parser);
+        AIUA_CHECK(!parser.failed && events.count == 1 && strcmp(events.events[0].data, "a\nb") == 0);
+        AIUATestEventListFree(&events);
+        AIUASSEParserDestroy(&parser);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *fixture = argc > 1 ? argv[1] : "fixtures/deepseek_stream.sse";
+    AIUATestRecordedStream(fixture);
+    AIUATestFields();
+    AIUATestEmptyData();
+    AIUATestBOMAndFinish();
+    AIUATestPauseDispatch();
+    AIUATestAllocationFailure();
+    return AIUATestSummary("AIUASSEParser");
+}
@@ -0,0 +1,411 @@
+//
+//  AIUASegmentSpliceTests.m
+//  AIUniversalAssistant
+//
+//  段落缓存拼接测试：AIUASegmentedGenerator + AIUAParagraphOutputCache，写作器替换为本地假实现
+//  （按字符确定性变换：小写字母转大写、汉字码位 +1，空白原样保留；分 1~3 块在随机延迟后流式回调）
+//  - 首次生成、再次生成、改动段落后生成：拼接结果必须与不使用缓存的整体生成逐字一致（含段落分隔与首尾空白）
+//  - 只请求未缓存的段落：请求中的段落集合 = 文档段落 - 已缓存段落，uncachedText（计费依据）与请求一致
+//  - 生成参数变化不命中；超长段落拆成句子的段不缓存，只连带与它同段的相邻段落
+//  - 随机插入、删除、修改、复制、交换段落，随机并发数；容量不足时按最近使用淘汰，拼接结果仍一致
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUASegmentSpliceTests [随机编辑轮数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUASegmentedGenerator.h"
+#import "AIUAParagraphOutputCache.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+static const NSUInteger kAIUATestTokenBudget = 60;
+// 足够容纳随机编辑中出现过的全部段落，不发生淘汰
+static const NSUInteger kAIUATestLargeCapacity = 4096;
+
+static AIUATestRandom AIUATestLatencyRandom;
+static NSMutableArray<NSString *> *AIUATestRequests;     // 本轮写作器收到的提示词（即段正文）
+static NSUInteger AIUATestRunning;
+static NSUInteger AIUATestPeakRunning;
+
+#pragma mark - 假写作器
+
+// 确定性的"翻译"：逐字符变换，可按任意位置切分后分别变换再拼接
+static NSString *AIUATestTransform(NSString *text) {
+    NSMutableString *result = [NSMutableString stringWithCapacity:text.length];
+    for (NSUInteger i = 0; i < text.length; i++) {
+        unichar c = [text characterAtIndex:i];
+        if (c >= 'a' && c <= 'z') {
+            c = (unichar)(c - 'a' + 'A');
+        } else if (c >= 0x4E00 && c < 0x9FA5) {
+            c = (unichar)(c + 1);
+        }
+        [result appendString:[NSString stringWithCharacters:&c length:1]];
+    }
+    return result;
+}
+
+@interface AIUATestFakeWriter : AIUADeepSeekWriter
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, assign) BOOL running;
+@end
+
+@implementation AIUATestFakeWriter
+
+- (void)generateFullStreamWritingWithPrompt:(NSString *)prompt
+                                 maxTokens:(NSInteger)maxTokens
+                            streamHandler:(AIUAStreamHandler)streamHandler {
+    [AIUATestRequests addObject:prompt];
+    self.generation += 1;
+    self.running = YES;
+    AIUATestRunning++;
+    AIUATestPeakRunning = MAX(AIUATestPeakRunning, AIUATestRunning);
+
+    NSString *output = AIUATestTransform(prompt);
+    NSUInteger chunks = 1 + AIUATestRandomBelow(&AIUATestLatencyRandom, 3);
+    NSUInteger generation = self.generation;
+    int64_t delay = 0;
+    NSUInteger location = 0;
+    for (NSUInteger i = 0; i <= chunks; i++) {
+        delay += (int64_t)AIUATestRandomBelow(&AIUATestLatencyRandom, 3) * NSEC_PER_MSEC;
+        BOOL finished = i == chunks;
+        NSUInteger end = finished ? output.length : MIN(output.length, location + output.length / chunks + 1);
+        NSString *chunk = finished ? output : [output substringWithRange:NSMakeRange(location, end - location)];
+        location = end;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), dispatch_get_main_queue(), ^{
+            if (self.generation != generation || !self.running) {
+                return;
+            }
+            if (finished) {
+                self.running = NO;
+                AIUATestRunning--;
+            }
+            streamHandler(chunk, finished, nil);
+        });
+    }
+}
+
+- (void)cancelCurrentRequest {
+    self.generation += 1;
+    if (self.running) {
+        self.running = NO;
+        AIUATestRunning--;
+    }
+}
+
+@end
+
+#pragma mark - 运行
+
+typedef struct {
+    NSUInteger cachedSegments;
+    NSString *uncachedText;
+    NSArray<NSString *> *segments;
+} AIUATestRunInfo;
+
+// 运行一次分段生成，返回拼接结果（失败返回 nil）
+static NSString *AIUATestGenerate(NSString *text, AIUAParagraphOutputCache *cache, NSString *context,
+                                  NSUInteger concurrency, AIUATestRunInfo *info) {
+    [AIUATestRequests removeAllObjects];
+    AIUATestPeakRunning = 0;
+    AIUASegmentCachedOutputProvider provider = nil;
+    if (cache) {
+        provider = ^NSString *(NSString *paragraph) {
+            return [cache outputForParagraph:paragraph context:context];
+        };
+    }
+    AIUASegmentedGenerator *generator = [[AIUASegmentedGenerator alloc] initWithText:text
+                                                                         tokenBudget:kAIUATestTokenBudget
+                                                                cachedOutputProvider:provider
+                                                                       promptBuilder:^NSString *(NSString *segmentText, NSUInteger index, NSUInteger count) {
+        return segmentText;
+    } writerFactory:^AIUADeepSeekWriter *{
+        return [[AIUATestFakeWriter alloc] initWithServerURL:@"http://127.0.0.1:9/ai"];
+    }];
+    generator.maxConcurrentSegments = concurrency;
+    if (cache) {
+        generator.segmentOutputHandler = ^(NSString *segmentText, NSString *output) {
+            [cache storeOutput:output forText:segmentText context:context];
+        };
+    }
+    if (info) {
+        info->cachedSegments = generator.cachedOutputs.count;
+        info->uncachedText = generator.uncachedText;
+        info->segments = generator.segments;
+    }
+
+    __block BOOL done = NO;
+    __block NSString *result = nil;
+    [generator startWithStreamHandler:^(NSString *chunk, BOOL finished, NSError *error) {
+        if (finished) {
+            done = YES;
+            result = error ? nil : chunk;
+        }
+    }];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (!done && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    AIUA_CHECK_MSG(done, "分段生成超时");
+    AIUA_CHECK_MSG(AIUATestPeakRunning <= MAX(concurrency, (NSUInteger)1), "并发 %lu 超过上限 %lu",
+                   (unsigned long)AIUATestPeakRunning, (unsigned long)concurrency);
+    return result;
+}
+
+// 非空行（去掉首尾空白），与 AIUAParagraphOutputCache 的段落划分一致
+static NSArray<NSString *> *AIUATestParagraphs(NSString *text) {
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    for (NSString *line in [text componentsSeparatedByString:@"\n"]) {
+        NSString *paragraph = [line stringByTrimmingCharactersInSet:whitespace];
+        if (paragraph.length > 0) {
+            [paragraphs addObject:paragraph];
+        }
+    }
+    return paragraphs;
+}
+
+static NSArray<NSString *> *AIUATestRequestedParagraphs(void) {
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    for (NSString *request in AIUATestRequests) {
+        [paragraphs addObjectsFromArray:AIUATestParagraphs(request)];
+    }
+    return paragraphs;
+}
+
+static NSString *AIUATestRandomParagraph(AIUATestRandom *random) {
+    static NSString * const words[] = {@"清晨", @"城市", @"街角", @"早餐铺", @"雾气", @"report", @"summary", @"会议", @"季度", @"目标"};
+    NSMutableString *paragraph = [NSMutableString string];
+    NSUInteger count = 2 + AIUATestRandomBelow(random, 6);
+    for (NSUInteger i = 0; i < count; i++) {
+        [paragraph appendString:words[AIUATestRandomBelow(random, sizeof(words) / sizeof(words[0]))]];
+    }
+    [paragraph appendFormat:@"%lu。", (unsigned long)AIUATestRandomBelow(random, 1000)];
+    return paragraph;
+}
+
+static NSString *AIUATestRandomSeparator(AIUATestRandom *random) {
+    static NSString * const separators[] = {@"\n", @"\n\n", @"\n  \n", @"\n\t", @"\n\n\n"};
+    return separators[AIUATestRandomBelow(random, sizeof(separators) / sizeof(separators[0]))];
+}
+
+static NSString *AIUATestJoin(NSArray<NSString *> *paragraphs, NSArray<NSString *> *separators, NSString *leading, NSString *trailing) {
+    NSMutableString *text = [NSMutableString stringWithString:leading];
+    for (NSUInteger i = 0; i < paragraphs.count; i++) {
+        if (i > 0) {
+            [text appendString:separators[i - 1]];
+        }
+        [text appendString:paragraphs[i]];
+    }
+    [text appendString:trailing];
+    return text;
+}
+
+static NSString *AIUATestTemporaryPath(NSString *name) {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                      [NSString stringWithFormat:@"AIUASegmentSpliceTests-%d-%@.plist", getpid(), name]];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return path;
+}
+
+#pragma mark - 用例
+
+// 首次生成、原样再生成、改动一段后生成、改变参数后生成
+static void AIUATestEditOneParagraph(void) {
+    NSString *path = AIUATestTemporaryPath(@"edit");
+    AIUAParagraphOutputCache *cache = [[AIUAParagraphOutputCache alloc] initWithFilePath:path capacity:256];
+    NSString *context = [AIUAParagraphOutputCache contextWithDocumentID:@"doc-1" parameters:@[@"3", @"正式", @"", @"English"]];
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 19);
+    for (NSUInteger i = 0; i < 12; i++) {
+        [paragraphs addObject:AIUATestRandomParagraph(&random)];
+    }
+    NSMutableArray<NSString *> *separators = [NSMutableArray array];
+    for (NSUInteger i = 0; i + 1 < paragraphs.count; i++) {
+        [separators addObject:i % 2 == 0 ? @"\n\n" : @"\n"];
+    }
+    NSString *text = AIUATestJoin(paragraphs, separators, @"  ", @"\n");
+
+    AIUATestRunInfo info;
+    NSString *first = AIUATestGenerate(text, cache, context, 3, &info);
+    AIUA_CHECK([first isEqualToString:AIUATestTransform(text)]);
+    AIUA_CHECK(info.cachedSegments == 0);
+    AIUA_CHECK([AIUATestRequestedParagraphs() isEqualToArray:paragraphs]);
+
+    NSString *second = AIUATestGenerate(text, cache, context, 3, &info);
+    AIUA_CHECK([second isEqualToString:first]);
+    AIUA_CHECK(info.cachedSegments == paragraphs.count);
+    AIUA_CHECK(AIUATestRequests.count == 0);
+    AIUA_CHECK(AIUATestParagraphs(info.uncachedText).count == 0);
+
+    paragraphs[5] = [paragraphs[5] stringByAppendingString:@"补充一句。"];
+    NSString *edited = AIUATestJoin(paragraphs, separators, @"  ", @"\n");
+    NSString *third = AIUATestGenerate(edited, cache, context, 3, &info);
+    AIUA_CHECK([third isEqualToString:AIUATestTransform(edited)]);
+    AIUA_CHECK(info.cachedSegments == paragraphs.count - 1);
+    AIUA_CHECK(AIUATestRequests.count == 1);
+    AIUA_CHECK([AIUATestRequests.firstObject isEqualToString:paragraphs[5]]);
+    AIUA_CHECK([AIUATestParagraphs(info.uncachedText) isEqualToArray:@[paragraphs[5]]]);
+    AIUA_CHECK([third isEqualToString:AIUATestGenerate(edited, nil, context, 3, NULL)]);
+
+    // 风格变化：全部重新请求
+    NSString *otherContext = [AIUAParagraphOutputCache contextWithDocumentID:@"doc-1" parameters:@[@"3", @"活泼", @"", @"English"]];
+    AIUATestGenerate(edited, cache, otherContext, 3, &info);
+    AIUA_CHECK(info.cachedSegments == 0);
+    AIUA_CHECK([AIUATestRequestedParagraphs() isEqualToArray:paragraphs]);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+// 超长段落按句子拆开的段不写入缓存，与它合并在同一段的相邻段落也不缓存，其余段落正常命中
+static void AIUATestLongParagraph(void) {
+    NSString *path = AIUATestTemporaryPath(@"long");
+    AIUAParagraphOutputCache *cache = [[AIUAParagraphOutputCache alloc] initWithFilePath:path capacity:256];
+    NSString *context = [AIUAParagraphOutputCache contextWithDocumentID:@"doc-2" parameters:@[@"1"]];
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 190);
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 10; i++) {
+        [paragraphs addObject:AIUATestRandomParagraph(&random)];
+    }
+    NSMutableString *longParagraph = [NSMutableString string];
+    while ([AIUASegmentedGenerator estimatedTokensForText:longParagraph] <= kAIUATestTokenBudget * 3) {
+        [longParagraph appendString:AIUATestRandomParagraph(&random)];
+    }
+    paragraphs[4] = longParagraph;
+    NSMutableArray<NSString *> *separators = [NSMutableArray array];
+    for (NSUInteger i = 0; i + 1 < paragraphs.count; i++) {
+        [separators addObject:@"\n\n"];
+    }
+    NSString *text = AIUATestJoin(paragraphs, separators, @"", @"");
+
+    AIUATestRunInfo info;
+    NSString *first = AIUATestGenerate(text, cache, context, 2, &info);
+    AIUA_CHECK([first isEqualToString:AIUATestTransform(text)]);
+    AIUA_CHECK([cache outputForParagraph:longParagraph context:context] == nil);
+    NSMutableSet<NSString *> *uncacheable = [NSMutableSet setWithObject:longParagraph];
+    for (NSString *segment in info.segments) {
+        NSArray<NSString *> *lines = AIUATestParagraphs(segment);
+        BOOL containsLong = NO;
+        for (NSString *line in lines) {
+            containsLong = containsLong || ([longParagraph rangeOfString:line].location != NSNotFound && ![paragraphs containsObject:line]);
+        }
+        if (containsLong) {
+            [uncacheable addObjectsFromArray:lines];
+        }
+    }
+
+    NSString *second = AIUATestGenerate(text, cache, context, 2, &info);
+    AIUA_CHECK([second isEqualToString:first]);
+    NSUInteger uncachedParagraphs = 0;
+    for (NSString *paragraph in paragraphs) {
+        uncachedParagraphs += [uncacheable containsObject:paragraph] ? 1 : 0;
+    }
+    AIUA_CHECK_MSG(info.cachedSegments == paragraphs.count - uncachedParagraphs, "缓存命中 %lu 段，应为 %lu 段",
+                   (unsigned long)info.cachedSegments, (unsigned long)(paragraphs.count - uncachedParagraphs));
+    AIUA_CHECK([[AIUATestRequests componentsJoinedByString:@""] rangeOfString:[longParagraph substringToIndex:10]].location != NSNotFound);
+    for (NSString *paragraph in AIUATestRequestedParagraphs()) {
+        BOOL partOfLong = [longParagraph rangeOfString:paragraph].location != NSNotFound;
+        AIUA_CHECK_MSG(partOfLong || [uncacheable containsObject:paragraph], "请求了已缓存的段落 %lu",
+                       (unsigned long)[paragraphs indexOfObject:paragraph]);
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+// 随机编辑：请求的段落恰好是尚未缓存的段落，拼接结果与整体生成一致
+static void AIUATestRandomEdits(NSUInteger rounds, uint64_t seed, NSUInteger capacity) {
+    NSString *path = AIUATestTemporaryPath([NSString stringWithFormat:@"random-%llu", (unsigned long long)seed]);
+    AIUAParagraphOutputCache *cache = [[AIUAParagraphOutputCache alloc] initWithFilePath:path capacity:capacity];
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+    NSArray<NSString *> *contexts = @[[AIUAParagraphOutputCache contextWithDocumentID:@"doc-3" parameters:@[@"1", @"正式"]],
+                                      [AIUAParagraphOutputCache contextWithDocumentID:@"doc-3" parameters:@[@"3", @"English"]]];
+    NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *cached = [NSMutableDictionary dictionary];
+    for (NSString *context in contexts) {
+        cached[context] = [NSMutableSet set];
+    }
+
+    NSMutableArray<NSString *> *paragraphs = [NSMutableArray array];
+    NSMutableArray<NSString *> *separators = [NSMutableArray array];
+    NSUInteger initial = 8 + AIUATestRandomBelow(&random, 20);
+    for (NSUInteger i = 0; i < initial; i++) {
+        [paragraphs addObject:AIUATestRandomParagraph(&random)];
+        [separators addObject:AIUATestRandomSeparator(&random)];
+    }
+
+    for (NSUInteger round = 0; round < rounds; round++) {
+        NSUInteger edits = 1 + AIUATestRandomBelow(&random, 3);
+        for (NSUInteger e = 0; e < edits; e++) {
+            NSUInteger index = AIUATestRandomBelow(&random, paragraphs.count);
+            switch (AIUATestRandomBelow(&random, 5)) {
+                case 0:
+                    // 保留前半段再改写后半段，段落长度有上限，不会超出预算被拆成句子
+                    paragraphs[index] = [[paragraphs[index] substringToIndex:paragraphs[index].length / 2]
+                                         stringByAppendingString:AIUATestRandomParagraph(&random)];
+                    break;
+                case 1:
+                    [paragraphs insertObject:AIUATestRandomParagraph(&random) atIndex:index];
+                    [separators insertObject:AIUATestRandomSeparator(&random) atIndex:index];
+                    break;
+                case 2:
+                    if (paragraphs.count > 2) {
+                        [paragraphs removeObjectAtIndex:index];
+                        [separators removeObjectAtIndex:index];
+                    }
+                    break;
+                case 3:
+                    [paragraphs insertObject:paragraphs[AIUATestRandomBelow(&random, paragraphs.count)] atIndex:index];
+                    [separators insertObject:AIUATestRandomSeparator(&random) atIndex:index];
+                    break;
+                default:
+                    [paragraphs exchangeObjectAtIndex:index withObjectAtIndex:AIUATestRandomBelow(&random, paragraphs.count)];
+                    break;
+            }
+        }
+        NSString *leading = AIUATestRandomBelow(&random, 2) ? @"" : @"\n ";
+        NSString *trailing = AIUATestRandomBelow(&random, 2) ? @"" : @"\n\n";
+        NSString *text = AIUATestJoin(paragraphs, separators, leading, trailing);
+        NSString *context = contexts[AIUATestRandomBelow(&random, contexts.count)];
+        NSUInteger concurrency = 1 + AIUATestRandomBelow(&random, 4);
+
+        NSMutableSet<NSString *> *expected = [NSMutableSet setWithArray:paragraphs];
+        [expected minusSet:cached[context]];
+        NSUInteger expectedHits = 0;
+        for (NSString *paragraph in paragraphs) {
+            expectedHits += [cached[context] containsObject:paragraph] ? 1 : 0;
+        }
+
+        AIUATestRunInfo info;
+        NSString *output = AIUATestGenerate(text, cache, context, concurrency, &info);
+        AIUA_CHECK_MSG([output isEqualToString:AIUATestTransform(text)], "第 %lu 轮拼接结果与整体生成不一致", (unsigned long)round);
+        NSArray<NSString *> *requested = AIUATestRequestedParagraphs();
+        AIUA_CHECK([AIUATestParagraphs(info.uncachedText) isEqualToArray:requested]);
+        if (capacity >= kAIUATestLargeCapacity) {
+            AIUA_CHECK_MSG([[NSSet setWithArray:requested] isEqualToSet:expected], "第 %lu 轮请求了 %lu 段，应为 %lu 段",
+                           (unsigned long)round, (unsigned long)[NSSet setWithArray:requested].count, (unsigned long)expected.count);
+            AIUA_CHECK(info.cachedSegments == expectedHits);
+        } else {
+            // 容量不足时较早的段落可能已被淘汰，只会多请求，不会少请求
+            AIUA_CHECK([[NSSet setWithArray:requested] isSupersetOfSet:expected]);
+            AIUA_CHECK(info.cachedSegments <= expectedHits);
+        }
+        [cached[context] addObjectsFromArray:paragraphs];
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger rounds = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 200;
+        AIUATestRequests = [NSMutableArray array];
+        AIUATestRandomSeed(&AIUATestLatencyRandom, 1019);
+        AIUATestEditOneParagraph();
+        AIUATestLongParagraph();
+        for (uint64_t seed = 1; seed <= 4; seed++) {
+            @autoreleasepool {
+                AIUATestRandomEdits(rounds, seed, kAIUATestLargeCapacity);
+            }
+        }
+        AIUATestRandomEdits(rounds, 99, 16);
+        return AIUATestSummary("AIUASegmentedGenerator 段落缓存");
+    }
+}
@@ -0,0 +1,161 @@
+//
+//  AIUASegmentedGeneratorStubBench.m
+//  AIUniversalAssistant
+//
+//  长文分段生成端到端基准：对本地 SSE 模拟服务（server.js，MOCK_UPSTREAM=1 回显用户消息，注入首包延迟与逐块间隔）
+//  用真实的 AIUADeepSeekWriter 发送请求，比较
+//  - 单请求：整篇文档一个请求（原 performAIGenerationWithType: 的做法）
+//  - 分段：AIUASegmentedGenerator 按 token 预算切分，并发数 1 / 3 / 6
+//  统计首次输出与全部完成的耗时；模拟服务回显原文，输出与原文（去掉首尾空白）不一致时退出码为 1
+//  只依赖 Foundation，macOS 上由 make stub-bench 启动模拟服务后运行
+//  用法：AIUASegmentedGeneratorStubBench [服务地址，默认 http://127.0.0.1:3000/ai] [段落数] [每段 token 预算]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUASegmentedGenerator.h"
+#include "AIUATestSupport.h"
+
+static const NSTimeInterval kAIUABenchTimeout = 300;
+
+typedef struct {
+    double firstOutput;
+    double total;
+    BOOL ok;
+} AIUABenchTiming;
+
+static NSString *AIUABenchDocument(NSUInteger paragraphs) {
+    NSMutableString *text = [NSMutableString string];
+    for (NSUInteger i = 0; i < paragraphs; i++) {
+        if (i > 0) {
+            [text appendString:@"\n\n"];
+        }
+        [text appendFormat:@"第 %lu 段：", (unsigned long)(i + 1)];
+        for (NSUInteger j = 0; j < 4; j++) {
+            [text appendString:@"城市的清晨总是从一杯热豆浆开始，街角的早餐铺升起白色的雾气。"];
+        }
+    }
+    return text;
+}
+
+// 运行主线程 run loop，直到 done 置位或超时
+static BOOL AIUABenchWait(BOOL *done) {
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kAIUABenchTimeout];
+    while (!*done && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    return *done;
+}
+
+static AIUABenchTiming AIUABenchSingleRequest(NSString *serverURL, NSString *text) {
+    __block AIUABenchTiming timing = {0, 0, NO};
+    __block BOOL done = NO;
+    NSMutableString *output = [NSMutableString string];
+    AIUADeepSeekWriter *writer = [[AIUADeepSeekWriter alloc] initWithServerURL:serverURL];
+    double start = AIUATestNow();
+    [writer generateFullStreamWritingWithPrompt:text maxTokens:4000 streamHandler:^(NSString *chunk, BOOL finished, NSError *error) {
+        if (error) {
+            fprintf(stderr, "单请求失败：%s\n", error.localizedDescription.UTF8String);
+            done = YES;
+            return;
+        }
+        if (!finished) {
+            if (output.length == 0 && chunk.length > 0) {
+                timing.firstOutput = AIUATestNow() - start;
+            }
+            [output appendString:chunk];
+            return;
+        }
+        timing.total = AIUATestNow() - start;
+        timing.ok = YES;
+        done = YES;
+    }];
+    if (!AIUABenchWait(&done)) {
+        fprintf(stderr, "单请求超时\n");
+        [writer cancelCurrentRequest];
+    }
+    NSString *expected = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if (timing.ok && ![output isEqualToString:expected]) {
+        fprintf(stderr, "单请求输出与原文不一致（%lu / %lu 字符）\n", (unsigned long)output.length, (unsigned long)expected.length);
+        timing.ok = NO;
+    }
+    return timing;
+}
+
+static AIUABenchTiming AIUABenchSegmented(NSString *serverURL, NSString *text, NSUInteger tokenBudget, NSUInteger concurrency,
+                                          NSUInteger *segmentCount, double *totalSegmentTime) {
+    __block AIUABenchTiming timing = {0, 0, NO};
+    __block BOOL done = NO;
+    NSMutableString *output = [NSMutableString string];
+    AIUASegmentedGenerator *generator = [[AIUASegmentedGenerator alloc] initWithText:text
+                                                                         tokenBudget:tokenBudget
+                                                                       promptBuilder:^NSString *(NSString *segmentText, NSUInteger index, NSUInteger count) {
+        // 模拟服务回显提示词，直接以段正文作为提示词，输出即可与原文逐字比较
+        return segmentText;
+    } writerFactory:^AIUADeepSeekWriter *{
+        return [[AIUADeepSeekWriter alloc] initWithServerURL:serverURL];
+    }];
+    generator.maxConcurrentSegments = concurrency;
+    *segmentCount = generator.segments.count;
+    double start = AIUATestNow();
+    [generator startWithStreamHandler:^(NSString *chunk, BOOL finished, NSError *error) {
+        if (error) {
+            fprintf(stderr, "分段生成失败：%s\n", error.localizedDescription.UTF8String);
+            done = YES;
+            return;
+        }
+        if (!finished) {
+            if (timing.firstOutput == 0 && [chunk stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]].length > 0) {
+                timing.firstOutput = AIUATestNow() - start;
+            }
+            [output appendString:chunk];
+            return;
+        }
+        timing.total = AIUATestNow() - start;
+        timing.ok = [chunk isEqualToString:output];
+        done = YES;
+    }];
+    if (!AIUABenchWait(&done)) {
+        fprintf(stderr, "分段生成超时\n");
+        [generator cancel];
+    }
+    *totalSegmentTime = generator.totalSegmentTime;
+    if (timing.ok && ![output isEqualToString:text]) {
+        fprintf(stderr, "分段输出与原文不一致（%lu / %lu 字符）\n", (unsigned long)output.length, (unsigned long)text.length);
+        timing.ok = NO;
+    }
+    return timing;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSString *serverURL = argc > 1 ? @(argv[1]) : @"http://127.0.0.1:3000/ai";
+        NSUInteger paragraphs = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 24;
+        NSUInteger tokenBudget = argc > 3 ? (NSUInteger)strtoul(argv[3], NULL, 10) : 300;
+        NSString *text = AIUABenchDocument(MAX(paragraphs, (NSUInteger)1));
+
+        printf("[AIUASegmentedGenerator] %s，%lu 段 %lu 字，约 %lu token，每段预算 %lu token\n", serverURL.UTF8String,
+               (unsigned long)paragraphs, (unsigned long)text.length,
+               (unsigned long)[AIUASegmentedGenerator estimatedTokensForText:text], (unsigned long)tokenBudget);
+        printf("  方式             段数  并发  首次输出     全部完成   各段耗时之和\n");
+
+        AIUABenchTiming single = AIUABenchSingleRequest(serverURL, text);
+        if (!single.ok) {
+            return 1;
+        }
+        printf("  单请求              1     1  %8.0f ms  %8.0f ms\n", single.firstOutput * 1e3, single.total * 1e3);
+
+        const NSUInteger concurrencies[] = {1, 3, 6};
+        for (size_t i = 0; i < sizeof(concurrencies) / sizeof(concurrencies[0]); i++) {
+            NSUInteger segmentCount = 0;
+            double segmentTime = 0;
+            AIUABenchTiming segmented = AIUABenchSegmented(serverURL, text, tokenBudget, concurrencies[i], &segmentCount, &segmentTime);
+            if (!segmented.ok) {
+                return 1;
+            }
+            printf("  分段           %6lu %5lu  %8.0f ms  %8.0f ms  %8.0f ms（单请求的 %.0f%%）\n",
+                   (unsigned long)segmentCount, (unsigned long)concurrencies[i], segmented.firstOutput * 1e3,
+                   segmented.total * 1e3, segmentTime * 1e3, segmented.total / single.total * 100);
+        }
+        return 0;
+    }
+}
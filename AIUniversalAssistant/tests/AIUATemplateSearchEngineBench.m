@@ -0,0 +1,124 @@
+//
+//  AIUATemplateSearchEngineBench.m
+//  AIUniversalAssistant
+//
+//  AIUATemplateSearchEngine 逐键输入基准：把 AIUAHotCategories.plist 中的模板复制 50 份（标题加序号区分），
+//  按输入脚本逐键查询（含中文、全拼、拼音首字母、退格和无结果的输入），统计每次按键的平均 / 最大耗时
+//  对照原实现：每次按键用 NSPredicate 对全部标题 rangeOfString:options:NSCaseInsensitiveSearch
+//  原实现的命中必须都在新结果中（新实现还匹配副标题、描述和拼音），否则退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUATemplateSearchEngineBench [AIUAHotCategories.plist] [复制份数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUATemplateSearchEngine.h"
+#include "AIUATestSupport.h"
+
+// 输入脚本：逐键输入，"<" 表示退格
+static NSString * const kAIUABenchScripts[] = {
+    @"shixizongjie", @"sxzj", @"演讲词", @"朋友圈动态", @"zhihu<<<<<toutiao", @"xyzq<<<<weixin", @"总结<<反思", @"Report"
+};
+
+static NSArray<NSDictionary *> *AIUABenchLoadItems(NSString *path, NSUInteger copies) {
+    NSArray *categories = [NSArray arrayWithContentsOfFile:path];
+    NSMutableArray<NSDictionary *> *items = [NSMutableArray array];
+    for (NSUInteger copy = 0; copy < copies; copy++) {
+        for (NSDictionary *category in categories) {
+            for (NSDictionary *item in category[@"items"]) {
+                NSMutableDictionary *copiedItem = [item mutableCopy];
+                if (copy > 0) {
+                    copiedItem[@"title"] = [NSString stringWithFormat:@"%@ %lu", item[@"title"], (unsigned long)copy];
+                }
+                [items addObject:copiedItem];
+            }
+        }
+    }
+    return items;
+}
+
+// 展开输入脚本为逐键的查询文本
+static NSArray<NSString *> *AIUABenchKeystrokes(NSString *script) {
+    NSMutableArray<NSString *> *queries = [NSMutableArray array];
+    NSMutableString *query = [NSMutableString string];
+    for (NSUInteger i = 0; i < script.length; i++) {
+        unichar c = [script characterAtIndex:i];
+        if (c == '<') {
+            if (query.length > 0) {
+                [query deleteCharactersInRange:NSMakeRange(query.length - 1, 1)];
+            }
+        } else {
+            [query appendString:[NSString stringWithCharacters:&c length:1]];
+        }
+        [queries addObject:[query copy]];
+    }
+    return queries;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSString *path = argc > 1 ? @(argv[1]) : @"../AIUniversalAssistant/zh-Hans.lproj/AIUAHotCategories.plist";
+        NSUInteger copies = argc > 2 ? (NSUInteger)strtoul(argv[2], NULL, 10) : 50;
+        NSArray<NSDictionary *> *items = AIUABenchLoadItems(path, MAX(copies, (NSUInteger)1));
+        if (items.count == 0) {
+            fprintf(stderr, "无法读取模板目录 %s\n", path.UTF8String);
+            return 1;
+        }
+
+        double start = AIUATestNow();
+        AIUATemplateSearchEngine *engine = [[AIUATemplateSearchEngine alloc] initWithItems:items
+                                                                                   locale:[NSLocale localeWithLocaleIdentifier:@"zh_Hans_CN"]];
+        double build = AIUATestNow() - start;
+        printf("[AIUATemplateSearchEngine] %lu 个模板（目录 × %lu），建立索引 %.1f ms\n",
+               (unsigned long)items.count, (unsigned long)copies, build * 1e3);
+        printf("  输入脚本             按键  索引平均   索引最大  原实现平均  结果数（索引 / 原实现）\n");
+
+        double engineTotal = 0;
+        double legacyTotal = 0;
+        NSUInteger keystrokes = 0;
+        for (size_t s = 0; s < sizeof(kAIUABenchScripts) / sizeof(kAIUABenchScripts[0]); s++) {
+            NSArray<NSString *> *queries = AIUABenchKeystrokes(kAIUABenchScripts[s]);
+            double engineSum = 0;
+            double engineMax = 0;
+            double legacySum = 0;
+            NSUInteger engineCount = 0;
+            NSUInteger legacyCount = 0;
+            for (NSString *query in queries) {
+                start = AIUATestNow();
+                NSArray<NSDictionary *> *results = query.length > 0 ? [engine itemsMatchingText:query] : @[];
+                double elapsed = AIUATestNow() - start;
+                engineSum += elapsed;
+                engineMax = MAX(engineMax, elapsed);
+
+                // 原实现：每次按键重新扫描全部标题
+                start = AIUATestNow();
+                NSArray<NSDictionary *> *legacy = @[];
+                if (query.length > 0) {
+                    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NSDictionary *item, NSDictionary *bindings) {
+                        NSString *title = item[@"title"];
+                        return [title rangeOfString:query options:NSCaseInsensitiveSearch].location != NSNotFound;
+                    }];
+                    legacy = [items filteredArrayUsingPredicate:predicate];
+                }
+                legacySum += AIUATestNow() - start;
+
+                NSSet *resultSet = [NSSet setWithArray:results];
+                for (NSDictionary *item in legacy) {
+                    if (![resultSet containsObject:item]) {
+                        fprintf(stderr, "查询「%s」漏掉了标题「%s」\n", query.UTF8String, [item[@"title"] UTF8String]);
+                        return 1;
+                    }
+                }
+                engineCount = results.count;
+                legacyCount = legacy.count;
+            }
+            printf("  %-18s %6lu %8.1f µs %8.1f µs %8.1f µs   %lu / %lu\n", kAIUABenchScripts[s].UTF8String,
+                   (unsigned long)queries.count, engineSum / queries.count * 1e6, engineMax * 1e6,
+                   legacySum / queries.count * 1e6, (unsigned long)engineCount, (unsigned long)legacyCount);
+            engineTotal += engineSum;
+            legacyTotal += legacySum;
+            keystrokes += queries.count;
+        }
+        printf("  平均每次按键：索引 %.1f µs，原实现 %.1f µs\n", engineTotal / keystrokes * 1e6, legacyTotal / keystrokes * 1e6);
+        return 0;
+    }
+}
@@ -0,0 +1,141 @@
+//
+//  AIUATestSupport.h
+//  AIUniversalAssistant
+//
+//  纯C引擎测试与基准的公共工具：断言计数、计时、可复现的伪随机数、读取夹具文件
+//  只依赖 C 标准库与 POSIX，在 Linux 与 macOS 上都可直接编译
+//
+
+#ifndef AIUATestSupport_h
+#define AIUATestSupport_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+__attribute__((unused)) static int AIUATestFailures = 0;
+__attribute__((unused)) static int AIUATestChecks = 0;
+
+#define AIUA_CHECK(condition) do { \
+    AIUATestChecks++; \
+    if (!(condition)) { \
+        AIUATestFailures++; \
+        fprintf(stderr, "%s:%d: 断言失败: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+} while (0)
+
+#define AIUA_CHECK_MSG(condition, ...) do { \
+    AIUATestChecks++; \
+    if (!(condition)) { \
+        AIUATestFailures++; \
+        fprintf(stderr, "%s:%d: 断言失败: %s: ", __FILE__, __LINE__, #condition); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } \
+} while (0)
+
+/// 输出结果并返回进程退出码
+static inline int AIUATestSummary(const char *name) {
+    if (AIUATestFailures > 0) {
+        fprintf(stderr, "[%s] 失败 %d / %d\n", name, AIUATestFailures, AIUATestChecks);
+        return 1;
+    }
+    printf("[%s] 通过 %d 项检查\n", name, AIUATestChecks);
+    return 0;
+}
+
+/// 单调时钟（秒）
+static inline double AIUATestNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// xorshift64*，种子相同则序列相同，便于复现失败用例
+typedef struct {
+    uint64_t state;
+} AIUATestRandom;
+
+static inline void AIUATestRandomSeed(AIUATestRandom *random, uint64_t seed) {
+    random->state = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+static inline uint64_t AIUATestRandomNext(AIUATestRandom *random) {
+    uint64_t x = random->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    random->state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/// [0, bound) 内的随机整数，bound 为 0 时返回 0
+static inline size_t AIUATestRandomBelow(AIUATestRandom *random, size_t bound) {
+    return bound > 0 ? (size_t)(AIUATestRandomNext(random) % bound) : 0;
+}
+
+/// 读取整个文件，调用方 free；失败返回 NULL
+static inline uint8_t *AIUATestReadFile(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *bytes = (uint8_t *)malloc(size > 0 ? (size_t)size : 1);
+    size_t read = bytes && size > 0 ? fread(bytes, 1, (size_t)size, file) : 0;
+    fclose(file);
+    if (!bytes || (long)read != size) {
+        free(bytes);
+        return NULL;
+    }
+    *length = read;
+    return bytes;
+}
+
+/// 可增长的字节缓冲区
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+} AIUATestBuffer;
+
+static inline void AIUATestBufferAppend(AIUATestBuffer *buffer, const void *bytes, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity : 256;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        buffer->bytes = (uint8_t *)realloc(buffer->bytes, capacity);
+        buffer->capacity = capacity;
+    }
+    if (length > 0) {
+        memcpy(buffer->bytes + buffer->length, bytes, length);
+    }
+    buffer->length += length;
+}
+
+static inline void AIUATestBufferAppendString(AIUATestBuffer *buffer, const char *string) {
+    AIUATestBufferAppend(buffer, string, strlen(string));
+}
+
+/// 丢弃头部 count 字节
+static inline void AIUATestBufferDiscard(AIUATestBuffer *buffer, size_t count) {
+    if (count > buffer->length) {
+        count = buffer->length;
+    }
+    memmove(buffer->bytes, buffer->bytes + count, buffer->length - count);
+    buffer->length -= count;
+}
+
+static inline void AIUATestBufferFree(AIUATestBuffer *buffer) {
+    free(buffer->bytes);
+    buffer->bytes = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+#endif /* AIUATestSupport_h */
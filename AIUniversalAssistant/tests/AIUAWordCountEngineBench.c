@@ -0,0 +1,99 @@
+//
+//  AIUAWordCountEngineBench.c
+//  AIUniversalAssistant
+//
+//  AIUAWordCountEngine 基准：1k ~ 1M 码元的文档（中文为主、夹杂英文，约 1% 的表情/组合符号），对比
+//  - 混合计数：简单字符走快速路径（SSE2/NEON），只有复杂片段交给片段计数器
+//  - 逐簇计数：整段交给 AIUAWordCountDefaultSpanCounter，逐个码元判定类别与断开规则，
+//    相当于原实现按 NSStringEnumerationByComposedCharacterSequences 逐簇枚举（不含创建子串的开销）
+//  - 流式：按 16 个码元一块输入（与生成时的 chunk 相当）
+//  三者字数不一致时退出码为 1；真机上的原实现对比见 AIUAWordCounterBench.m
+//  用法：AIUAWordCountEngineBench [轮数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAWordCountEngine.h"
+
+static const size_t kAIUABenchChunk = 16;
+
+static uint16_t *AIUABenchDocument(size_t units, size_t *length) {
+    uint16_t *text = (uint16_t *)malloc((units + 8) * sizeof(uint16_t));
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 8);
+    size_t n = 0;
+    while (n < units) {
+        size_t pick = AIUATestRandomBelow(&random, 1000);
+        if (pick < 5) {
+            // 👍🏽（表情加肤色修饰，一个簇）
+            const uint16_t emoji[] = {0xD83D, 0xDC4D, 0xD83C, 0xDFFD};
+            memcpy(text + n, emoji, sizeof(emoji));
+            n += 4;
+        } else if (pick < 10) {
+            text[n++] = 'e';
+            text[n++] = 0x0301;
+        } else if (pick < 150) {
+            text[n++] = (uint16_t)('a' + AIUATestRandomBelow(&random, 26));
+        } else if (pick < 170) {
+            text[n++] = pick % 2 ? 0xFF0C : 0x3002;
+        } else if (pick < 175) {
+            text[n++] = '\n';
+        } else {
+            text[n++] = (uint16_t)(0x4E00 + AIUATestRandomBelow(&random, 6000));
+        }
+    }
+    *length = n;
+    return text;
+}
+
+static uint64_t AIUABenchStreamed(AIUAWordCountEngine *engine, const uint16_t *text, size_t length) {
+    AIUAWordCountEngineReset(engine);
+    for (size_t start = 0; start < length; start += kAIUABenchChunk) {
+        size_t chunk = start + kAIUABenchChunk < length ? kAIUABenchChunk : length - start;
+        AIUAWordCountEngineFeedUTF16(engine, text + start, chunk);
+    }
+    return AIUAWordCountEngineGetTotal(engine);
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 5;
+    rounds = rounds > 0 ? rounds : 1;
+    const size_t sizes[] = {1000, 10000, 100000, 1000000};
+    AIUAWordCountEngine *engine = AIUAWordCountEngineCreate(NULL, NULL);
+#if (defined(__aarch64__) && defined(__ARM_NEON)) || defined(__SSE2__)
+    const char *vector = "向量判定开启";
+#else
+    const char *vector = "向量判定关闭";
+#endif
+    printf("[AIUAWordCountEngine] 每种方式 %zu 轮取最快（%s）\n", rounds, vector);
+    printf("      码元       字数      混合计数       逐簇计数   加速比   流式（%zu 码元/块）\n", kAIUABenchChunk);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t length = 0;
+        uint16_t *text = AIUABenchDocument(sizes[s], &length);
+        size_t words = AIUAWordCountUTF16(text, length, NULL, NULL);
+        if (AIUAWordCountDefaultSpanCounter(text, length, NULL) != words || AIUABenchStreamed(engine, text, length) != words) {
+            fprintf(stderr, "%zu 码元的文档三种方式字数不一致\n", length);
+            return 1;
+        }
+        double best[3] = {1e9, 1e9, 1e9};
+        volatile size_t sink = 0;
+        for (size_t r = 0; r < rounds; r++) {
+            double start = AIUATestNow();
+            sink += AIUAWordCountUTF16(text, length, NULL, NULL);
+            double hybrid = AIUATestNow() - start;
+            start = AIUATestNow();
+            sink += AIUAWordCountDefaultSpanCounter(text, length, NULL);
+            double full = AIUATestNow() - start;
+            start = AIUATestNow();
+            sink += (size_t)AIUABenchStreamed(engine, text, length);
+            double streamed = AIUATestNow() - start;
+            best[0] = hybrid < best[0] ? hybrid : best[0];
+            best[1] = full < best[1] ? full : best[1];
+            best[2] = streamed < best[2] ? streamed : best[2];
+        }
+        printf("  %8zu   %8zu   %9.3f ms   %9.3f ms   %5.1fx   %9.3f ms\n", length, words,
+               best[0] * 1e3, best[1] * 1e3, best[1] / best[0], best[2] * 1e3);
+        free(text);
+    }
+    AIUAWordCountEngineDestroy(engine);
+    return 0;
+}
@@ -0,0 +1,290 @@
+//
+//  AIUAWordCountEngineTests.c
+//  AIUniversalAssistant
+//
+//  AIUAWordCountEngine 测试：快速路径（简单字符直接计数、NEON/SSE2 每次判断 8 个码元）不得改变计费口径
+//  - 混合计数 AIUAWordCountUTF16 必须与把整段文本交给 AIUAWordCountDefaultSpanCounter 的结果完全一致，
+//    覆盖组合附加符号、ZWJ 表情序列、肤色修饰、区域旗帜、CRLF、半角浊点 FF9E/FF9F、组合浊点 3099/309A、
+//    韩文字母、© ® 3030、孤立代理项，以及它们出现在向量块边界上的各种对齐
+//  - 流式：在每个切分位置把文本分两次输入，GetTotal 必须与一次性统计相同；随机多次切分与 UTF-8 逐字节切分同理
+//  真机上复杂片段交给 CFStringGetRangeOfComposedCharactersAtIndex 计数，这里用内置实现代替，
+//  验证的是“按简单字符切分再逐段计数”与“整段计数”在同一个片段计数器下相同
+//  引擎以 -Drealloc=AIUATestRealloc 编译，用于注入分配失败：失败后 HasFailed 必须为 true，Reset 后恢复正常
+//  用法：AIUAWordCountEngineTests [随机用例数]
+//
+
+#include "AIUATestSupport.h"
+#include "AIUAWordCountEngine.h"
+
+#pragma mark - 分配失败注入
+
+static long AIUATestReallocFailAfter = -1;   // 再成功多少次后失败，-1 表示不失败
+
+void *AIUATestRealloc(void *pointer, size_t size);
+void *AIUATestRealloc(void *pointer, size_t size) {
+    if (AIUATestReallocFailAfter == 0) {
+        return NULL;
+    }
+    if (AIUATestReallocFailAfter > 0) {
+        AIUATestReallocFailAfter--;
+    }
+    return realloc(pointer, size);
+}
+
+#pragma mark - 工具
+
+// 记录片段计数器被调用的码元数，用于确认快速路径确实生效
+static size_t AIUATestSpanUnits = 0;
+
+static size_t AIUATestCountingSpanCounter(const uint16_t *characters, size_t length, void *context) {
+    AIUATestSpanUnits += length;
+    return AIUAWordCountDefaultSpanCounter(characters, length, context);
+}
+
+static size_t AIUATestAppendCodePoint(uint16_t *output, size_t length, uint32_t cp) {
+    if (cp >= 0x10000) {
+        cp -= 0x10000;
+        output[length++] = (uint16_t)(0xD800 + (cp >> 10));
+        output[length++] = (uint16_t)(0xDC00 + (cp & 0x3FF));
+    } else {
+        output[length++] = (uint16_t)cp;
+    }
+    return length;
+}
+
+static size_t AIUATestUTF16FromCodePoints(const uint32_t *codePoints, size_t count, uint16_t *output) {
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        length = AIUATestAppendCodePoint(output, length, codePoints[i]);
+    }
+    return length;
+}
+
+// UTF-16 转 UTF-8（孤立代理项按 U+FFFD 编码，与引擎对非法输入的处理一致）
+static size_t AIUATestUTF8FromUTF16(const uint16_t *characters, size_t length, uint8_t *output) {
+    size_t n = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint32_t cp = characters[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < length && characters[i + 1] >= 0xDC00 && characters[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (characters[i + 1] - 0xDC00);
+            i++;
+        } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 0xFFFD;
+        }
+        if (cp < 0x80) {
+            output[n++] = (uint8_t)cp;
+        } else if (cp < 0x800) {
+            output[n++] = (uint8_t)(0xC0 | (cp >> 6));
+            output[n++] = (uint8_t)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            output[n++] = (uint8_t)(0xE0 | (cp >> 12));
+            output[n++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+            output[n++] = (uint8_t)(0x80 | (cp & 0x3F));
+        } else {
+            output[n++] = (uint8_t)(0xF0 | (cp >> 18));
+            output[n++] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+            output[n++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+            output[n++] = (uint8_t)(0x80 | (cp & 0x3F));
+        }
+    }
+    return n;
+}
+
+// 对同一段文本做全部一致性检查，返回一次性统计的字数
+static size_t AIUATestCheckText(AIUAWordCountEngine *engine, const uint16_t *text, size_t length, const char *label) {
+    size_t reference = AIUAWordCountDefaultSpanCounter(text, length, NULL);
+    size_t hybrid = AIUAWordCountUTF16(text, length, NULL, NULL);
+    AIUA_CHECK_MSG(hybrid == reference, "%s：混合计数 %zu，整段计数 %zu", label, hybrid, reference);
+
+    // 每个切分位置各分两次输入（包括空的前半段与后半段）
+    for (size_t split = 0; split <= length; split++) {
+        AIUAWordCountEngineReset(engine);
+        AIUAWordCountEngineFeedUTF16(engine, text, split);
+        AIUAWordCountEngineFeedUTF16(engine, text + split, length - split);
+        uint64_t streamed = AIUAWordCountEngineGetTotal(engine);
+        AIUA_CHECK_MSG(streamed == reference, "%s：在 %zu 处切分得到 %llu，一次性统计 %zu",
+                       label, split, (unsigned long long)streamed, reference);
+    }
+
+    // 每个码元单独输入，且每次输入后都取一次中间结果（GetTotal 不能改变状态）
+    AIUAWordCountEngineReset(engine);
+    for (size_t i = 0; i < length; i++) {
+        AIUAWordCountEngineFeedUTF16(engine, text + i, 1);
+        (void)AIUAWordCountEngineGetTotal(engine);
+    }
+    AIUA_CHECK_MSG(AIUAWordCountEngineGetTotal(engine) == reference, "%s：逐码元输入不一致", label);
+    return reference;
+}
+
+#pragma mark - 典型用例
+
+typedef struct {
+    const char *label;
+    uint32_t codePoints[16];
+    size_t count;
+    size_t expected;
+} AIUATestWordCase;
+
+static const AIUATestWordCase kAIUATestWordCases[] = {
+    {"ASCII", {'a', 'b', ' ', 'c'}, 4, 4},
+    {"汉字", {0x4E2D, 0x6587, 0x3002}, 3, 3},
+    {"CRLF 计 1 字", {'a', 0x0D, 0x0A, 'b'}, 4, 3},
+    {"单独的 CR", {'a', 0x0D, 'b', 0x0D}, 4, 4},
+    {"LF CR 计 2 字", {0x0A, 0x0D}, 2, 2},
+    {"组合重音", {'e', 0x0301, 'e', 0x0301, 0x0302}, 5, 2},
+    {"句首组合符号", {0x0301, 'a'}, 2, 2},
+    {"组合浊点 3099", {0x304B, 0x3099, 0x304D}, 3, 2},
+    {"组合半浊点 309A", {0x306F, 0x309A}, 2, 1},
+    {"半角浊点 FF9E", {0xFF76, 0xFF9E, 0xFF77}, 3, 2},
+    {"半角半浊点 FF9F", {0xFF8A, 0xFF9F}, 2, 1},
+    {"ZWJ 家庭", {0x1F468, 0x200D, 0x1F469, 0x200D, 0x1F467}, 5, 1},
+    {"肤色修饰", {0x1F44D, 0x1F3FD, 'x'}, 3, 2},
+    {"变体选择符", {0x2764, 0xFE0F, 0x4E2D}, 3, 2},
+    {"区域旗帜 ×2", {0x1F1E8, 0x1F1F3, 0x1F1FA, 0x1F1F8}, 4, 2},
+    {"奇数个区域旗帜", {0x1F1E8, 0x1F1F3, 0x1F1FA}, 3, 2},
+    {"ZWJ 后不是表情", {'a', 0x200D, 0x4E2D}, 3, 2},
+    {"韩文字母", {0x1100, 0x1161, 0x11A8, 0xAC00}, 4, 2},
+    {"韩文音节 + 字母 T", {0xAC00, 0x11A8, 0xAC01}, 3, 2},
+    {"© ® 3030", {0xA9, 0xFE0F, 0xAE, 0x3030, 0x303D}, 5, 4},
+    {"全角与中文标点", {0xFF01, 0x201C, 0x2026, 0x300A}, 4, 4},
+};
+
+static void AIUATestExamples(AIUAWordCountEngine *engine) {
+    uint16_t text[64];
+    for (size_t c = 0; c < sizeof(kAIUATestWordCases) / sizeof(kAIUATestWordCases[0]); c++) {
+        const AIUATestWordCase *wordCase = &kAIUATestWordCases[c];
+        size_t length = AIUATestUTF16FromCodePoints(wordCase->codePoints, wordCase->count, text);
+        size_t count = AIUATestCheckText(engine, text, length, wordCase->label);
+        AIUA_CHECK_MSG(count == wordCase->expected, "%s：%zu 字，期望 %zu", wordCase->label, count, wordCase->expected);
+    }
+
+    // 孤立代理项各计 1 字
+    const uint16_t lone[] = {0xD83D, 'a', 0xDC68, 0xDC68, 0xD83D};
+    AIUA_CHECK(AIUATestCheckText(engine, lone, 5, "孤立代理项") == 5);
+}
+
+// 复杂字符放在 8 码元向量块的每个位置，前后都是可以走向量路径的简单字符
+static void AIUATestVectorBoundaries(AIUAWordCountEngine *engine) {
+    const uint32_t complexes[][3] = {
+        {0x0301, 0, 0}, {0x0D, 0x0A, 0}, {0x0D, 0, 0}, {0xA9, 0, 0}, {0xAE, 0xFE0F, 0}, {0x200D, 0, 0},
+        {0x3099, 0, 0}, {0xFF9E, 0, 0}, {0x1F1E8, 0x1F1F3, 0}, {0x1F468, 0x200D, 0x1F469}, {0x1100, 0x1161, 0},
+    };
+    const uint32_t simples[] = {'a', 0x4E2D, 0x3042, 0xFF76};
+    uint16_t text[96];
+    for (size_t k = 0; k < sizeof(complexes) / sizeof(complexes[0]); k++) {
+        for (size_t s = 0; s < sizeof(simples) / sizeof(simples[0]); s++) {
+            for (size_t offset = 0; offset < 24; offset++) {
+                size_t length = 0;
+                for (size_t i = 0; i < offset; i++) {
+                    length = AIUATestAppendCodePoint(text, length, simples[s]);
+                }
+                for (size_t i = 0; i < 3 && complexes[k][i]; i++) {
+                    length = AIUATestAppendCodePoint(text, length, complexes[k][i]);
+                }
+                for (size_t i = 0; i < 20; i++) {
+                    length = AIUATestAppendCodePoint(text, length, i % 2 ? 0x6587 : 'z');
+                }
+                AIUATestCheckText(engine, text, length, "向量块边界");
+            }
+        }
+    }
+
+    // 纯简单字符的长文本不应调用片段计数器
+    uint16_t plain[1024];
+    for (size_t i = 0; i < 1024; i++) {
+        plain[i] = i % 3 == 0 ? 'a' : (uint16_t)(0x4E00 + i);
+    }
+    AIUATestSpanUnits = 0;
+    AIUA_CHECK(AIUAWordCountUTF16(plain, 1024, AIUATestCountingSpanCounter, NULL) == 1024);
+    AIUA_CHECK_MSG(AIUATestSpanUnits == 0, "简单字符交给了片段计数器 %zu 个码元", AIUATestSpanUnits);
+}
+
+#pragma mark - 随机差分
+
+// 简单字符的权重较高，复杂字符穿插其中并经常相邻出现
+static const uint32_t kAIUATestAlphabet[] = {
+    'a', 'b', ' ', '.', 0x4E2D, 0x6587, 0x5B57, 0x3001, 0x3042, 0x30AB, 0xFF76, 0xAC00, 0x201C,
+    0x0D, 0x0A, 0x0301, 0x0308, 0x3099, 0x309A, 0xFF9E, 0xFF9F, 0x200D, 0xFE0F, 0xA9, 0x3030,
+    0x1F468, 0x1F469, 0x1F3FB, 0x1F1E8, 0x1F1F3, 0x1100, 0x1161, 0x11A8, 0x2028, 0xD83D, 0xDC68,
+};
+
+static void AIUATestRandomTexts(AIUAWordCountEngine *engine, size_t rounds) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 8);
+    uint16_t text[160];
+    uint8_t utf8[640];
+    size_t alphabetSize = sizeof(kAIUATestAlphabet) / sizeof(kAIUATestAlphabet[0]);
+    for (size_t round = 0; round < rounds; round++) {
+        size_t length = 0;
+        size_t codePoints = AIUATestRandomBelow(&random, 64);
+        bool mostlySimple = round % 2 == 0;
+        for (size_t i = 0; i < codePoints; i++) {
+            size_t pick = AIUATestRandomBelow(&random, mostlySimple && AIUATestRandomBelow(&random, 4) ? 13 : alphabetSize);
+            // 表中的 0xD83D / 0xDC68 是孤立代理项，直接写入码元
+            length = AIUATestAppendCodePoint(text, length, kAIUATestAlphabet[pick]);
+        }
+        size_t reference = AIUAWordCountDefaultSpanCounter(text, length, NULL);
+        AIUA_CHECK_MSG(AIUAWordCountUTF16(text, length, NULL, NULL) == reference, "第 %zu 轮混合计数不一致", round);
+
+        // 随机多次切分
+        AIUAWordCountEngineReset(engine);
+        size_t start = 0;
+        while (start < length) {
+            size_t chunk = 1 + AIUATestRandomBelow(&random, 12);
+            chunk = start + chunk < length ? chunk : length - start;
+            AIUAWordCountEngineFeedUTF16(engine, text + start, chunk);
+            start += chunk;
+        }
+        AIUA_CHECK_MSG(AIUAWordCountEngineGetTotal(engine) == reference, "第 %zu 轮随机切分不一致", round);
+
+        // UTF-8 逐字节随机切分（孤立代理项编码为 U+FFFD，字数不变）
+        size_t utf8Length = AIUATestUTF8FromUTF16(text, length, utf8);
+        AIUAWordCountEngineReset(engine);
+        start = 0;
+        while (start < utf8Length) {
+            size_t chunk = 1 + AIUATestRandomBelow(&random, 7);
+            chunk = start + chunk < utf8Length ? chunk : utf8Length - start;
+            AIUAWordCountEngineFeedUTF8(engine, utf8 + start, chunk);
+            start += chunk;
+        }
+        AIUA_CHECK_MSG(AIUAWordCountEngineGetTotal(engine) == reference, "第 %zu 轮 UTF-8 切分不一致", round);
+
+        // 少量用例做完整的逐位置切分
+        if (round % 64 == 0) {
+            AIUATestCheckText(engine, text, length, "随机文本");
+        }
+    }
+}
+
+#pragma mark - 分配失败
+
+static void AIUATestAllocationFailure(void) {
+    uint16_t text[64];
+    const uint32_t codePoints[] = {'a', 0x0301, 0x1F468, 0x200D, 0x1F469, 0x200D};
+    size_t length = 0;
+    for (size_t i = 0; i < 10; i++) {
+        length = AIUATestAppendCodePoint(text, length, codePoints[i % 6]);
+    }
+    AIUAWordCountEngine *engine = AIUAWordCountEngineCreate(NULL, NULL);
+    // 末尾是未结束的 ZWJ 序列，需要缓存
+    AIUATestReallocFailAfter = 0;
+    AIUAWordCountEngineFeedUTF16(engine, text, length);
+    AIUATestReallocFailAfter = -1;
+    AIUA_CHECK(AIUAWordCountEngineHasFailed(engine));
+    AIUAWordCountEngineReset(engine);
+    AIUA_CHECK(!AIUAWordCountEngineHasFailed(engine));
+    AIUAWordCountEngineFeedUTF16(engine, text, length);
+    AIUA_CHECK(AIUAWordCountEngineGetTotal(engine) == AIUAWordCountDefaultSpanCounter(text, length, NULL));
+    AIUAWordCountEngineDestroy(engine);
+}
+
+int main(int argc, char **argv) {
+    size_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : 50000;
+    AIUAWordCountEngine *engine = AIUAWordCountEngineCreate(NULL, NULL);
+    AIUATestExamples(engine);
+    AIUATestVectorBoundaries(engine);
+    AIUATestRandomTexts(engine, rounds);
+    AIUAWordCountEngineDestroy(engine);
+    AIUATestAllocationFailure();
+    return AIUATestSummary("AIUAWordCountEngine");
+}
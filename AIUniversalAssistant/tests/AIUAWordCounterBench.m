@@ -0,0 +1,101 @@
+//
+//  AIUAWordCounterBench.m
+//  AIUniversalAssistant
+//
+//  AIUAWordCounter 对照原实现的基准与计费口径核对（真机/模拟器与 macOS 上 CoreFoundation 的字符簇规则相同）
+//  - 原实现：enumerateSubstringsInRange: 按 NSStringEnumerationByComposedCharacterSequences 逐簇计数
+//  - 新实现：+countWordsInText:（复杂片段交给 CFStringGetRangeOfComposedCharactersAtIndex），以及逐 chunk 的 appendText:
+//  先逐条核对易错文本（组合符号、ZWJ 表情、区域旗帜、CRLF、FF9E/FF9F、3099/309A），再在 1k ~ 100k 字的文档上计时
+//  任一文本的字数与原实现不同时退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAWordCounterBench [轮数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordCounter.h"
+#include "AIUATestSupport.h"
+
+static NSInteger AIUABenchOriginalCount(NSString *text) {
+    __block NSInteger count = 0;
+    [text enumerateSubstringsInRange:NSMakeRange(0, text.length)
+                             options:NSStringEnumerationByComposedCharacterSequences
+                          usingBlock:^(NSString *substring, NSRange substringRange, NSRange enclosingRange, BOOL *stop) {
+        count++;
+    }];
+    return count;
+}
+
+static NSInteger AIUABenchStreamedCount(NSString *text, NSUInteger chunk) {
+    AIUAWordCounter *counter = [[AIUAWordCounter alloc] init];
+    for (NSUInteger start = 0; start < text.length; start += chunk) {
+        [counter appendText:[text substringWithRange:NSMakeRange(start, MIN(chunk, text.length - start))]];
+    }
+    return counter.count;
+}
+
+static NSString *AIUABenchDocument(NSUInteger length) {
+    NSArray<NSString *> *pieces = @[@"城市的清晨总是从一杯热豆浆开始，", @"Hello world. ", @"👍🏽", @"👨‍👩‍👧", @"🇨🇳",
+                                    @"café ", @"が", @"ｶﾞ", @"\r\n", @"「引号」……"];
+    NSMutableString *text = [NSMutableString string];
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 8);
+    while (text.length < length) {
+        size_t pick = AIUATestRandomBelow(&random, 100);
+        [text appendString:pieces[pick < 70 ? 0 : pick < 85 ? 1 : 2 + pick % 8]];
+    }
+    return text;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger rounds = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 5;
+        rounds = MAX(rounds, (NSUInteger)1);
+        NSArray<NSString *> *samples = @[
+            @"éé̂", @"́a", @"a\r\nb\rc\n\r", @"がぱ", @"ｶﾞﾊﾟ",
+            @"👨‍👩‍👧‍👦", @"👍🏽x", @"❤️中", @"🇨🇳🇺🇸🇯", @"a‍中", @"각각",
+            @"©️®〰〽", @"！“…《", @"नमस्ते", @"ปีใหม่", @"🏳️‍🌈", @"🧑🏻‍💻",
+        ];
+        NSUInteger mismatches = 0;
+        for (NSString *sample in samples) {
+            NSInteger original = AIUABenchOriginalCount(sample);
+            NSInteger counted = [AIUAWordCounter countWordsInText:sample];
+            NSInteger streamed = AIUABenchStreamedCount(sample, 1);
+            if (counted != original || streamed != original) {
+                fprintf(stderr, "字数不一致 \"%s\"：原实现 %ld，新实现 %ld，逐码元追加 %ld\n", sample.UTF8String,
+                        (long)original, (long)counted, (long)streamed);
+                mismatches++;
+            }
+        }
+
+        printf("[AIUAWordCounter] 易错文本 %lu 条，与原实现不一致 %lu 条；每种方式 %lu 轮取最快\n",
+               (unsigned long)samples.count, (unsigned long)mismatches, (unsigned long)rounds);
+        printf("      码元       字数        原实现       新实现   加速比   流式（16 码元/块）\n");
+        const NSUInteger sizes[] = {1000, 10000, 100000};
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            NSString *text = AIUABenchDocument(sizes[s]);
+            double best[3] = {1e9, 1e9, 1e9};
+            NSInteger counts[3] = {0, 0, 0};
+            for (NSUInteger r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    double start = AIUATestNow();
+                    counts[0] = AIUABenchOriginalCount(text);
+                    best[0] = MIN(best[0], AIUATestNow() - start);
+                    start = AIUATestNow();
+                    counts[1] = [AIUAWordCounter countWordsInText:text];
+                    best[1] = MIN(best[1], AIUATestNow() - start);
+                    start = AIUATestNow();
+                    counts[2] = AIUABenchStreamedCount(text, 16);
+                    best[2] = MIN(best[2], AIUATestNow() - start);
+                }
+            }
+            if (counts[1] != counts[0] || counts[2] != counts[0]) {
+                fprintf(stderr, "%lu 码元的文档字数不一致：原实现 %ld，新实现 %ld，流式 %ld\n", (unsigned long)text.length,
+                        (long)counts[0], (long)counts[1], (long)counts[2]);
+                mismatches++;
+            }
+            printf("  %8lu   %8ld   %9.3f ms   %9.3f ms   %5.1fx   %9.3f ms\n", (unsigned long)text.length, (long)counts[0],
+                   best[0] * 1e3, best[1] * 1e3, best[0] / best[1], best[2] * 1e3);
+        }
+        return mismatches == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,167 @@
+//
+//  AIUAWordPackLedgerBench.m
+//  AIUniversalAssistant
+//
+//  字数包消耗吞吐基准：账本有 1、10、100 个购买批次时连续消耗，统计每秒消耗次数与存储写入次数
+//  - 延迟写回：AIUAWordPackLedger 默认行为，消耗只改内存，结束时由生命周期通知写回一次
+//  - 每次写回：每次消耗后立即 flush，即账本引入前每次消耗都写 Keychain 的做法
+//  存储用内存替身代替 Keychain，每次写入做一次二进制 plist 序列化（真实 Keychain 写入还要再加上
+//  SecItemUpdate 的开销，两种做法的差距只会更大）；不经过 AIUAIAPManager/试用期检查
+//  核对：两种做法结束后存储中的余额与累计消耗一致，否则退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAWordPackLedgerBench [每种批次数的消耗次数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLedger.h"
+#include "AIUATestSupport.h"
+
+static NSString * const kAIUABenchNamespace = @"user.bench";
+static NSString * const kAIUABenchLifecycleNotification = @"AIUABenchApplicationDidEnterBackgroundNotification";
+
+/// 内存存储：每次写入序列化为二进制 plist 并统计写入次数与字节数
+@interface AIUABenchLedgerStorage : NSObject <AIUAWordPackLedgerStorage>
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSData *> *values;
+@property (nonatomic, assign) NSUInteger writes;
+@property (nonatomic, assign) NSUInteger writtenBytes;
+@end
+
+@implementation AIUABenchLedgerStorage
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _values = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (BOOL)setInteger:(NSInteger)value forKey:(NSString *)key {
+    return [self setObject:@(value) forKey:key];
+}
+
+- (NSInteger)integerForKey:(NSString *)key {
+    return [[self objectForKey:key] integerValue];
+}
+
+- (BOOL)setObject:(id)object forKey:(NSString *)key {
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:object
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:nil];
+    if (!data) {
+        return NO;
+    }
+    self.values[key] = data;
+    self.writes++;
+    self.writtenBytes += data.length;
+    return YES;
+}
+
+- (id)objectForKey:(NSString *)key {
+    NSData *data = self.values[key];
+    return data ? [NSPropertyListSerialization propertyListWithData:data options:0 format:NULL error:nil] : nil;
+}
+
+@end
+
+static AIUABenchLedgerStorage *AIUABenchMakeStorage(NSUInteger lotCount, NSUInteger consumes) {
+    AIUABenchLedgerStorage *storage = [[AIUABenchLedgerStorage alloc] init];
+    NSDate *now = [NSDate date];
+    NSMutableArray *purchases = [NSMutableArray arrayWithCapacity:lotCount];
+    // 每个批次的字数足够全部消耗，消耗始终落在最早的批次上
+    for (NSUInteger i = 0; i < lotCount; i++) {
+        [purchases addObject:@{@"lotID": [NSString stringWithFormat:@"lot-%04lu", (unsigned long)i],
+                               @"productID": @"com.aiua.wordpack.6m",
+                               @"words": @(consumes * 10),
+                               @"remainingWords": @(consumes * 10),
+                               @"purchaseDate": [now dateByAddingTimeInterval:-(double)(lotCount - i) * 60],
+                               @"expiryDate": [now dateByAddingTimeInterval:90 * 24 * 60 * 60]}];
+    }
+    [storage setObject:purchases forKey:[NSString stringWithFormat:@"%@.%@", AIUAWordPackLedgerPurchasesKey, kAIUABenchNamespace]];
+    return storage;
+}
+
+/// 返回每秒消耗次数；flushEveryConsume 为 NO 时结束后发送生命周期通知写回
+static double AIUABenchRun(AIUABenchLedgerStorage *storage, NSUInteger consumes, BOOL flushEveryConsume) {
+    AIUAWordPackLedger *ledger = [[AIUAWordPackLedger alloc] initWithStorage:storage
+                                                                   giftWords:500000
+                                                            deviceIDProvider:^NSString *{
+        return @"device-bench";
+    }];
+    // 延迟远大于测量时长，延迟写回只由结束时的通知触发
+    ledger.flushDelay = 3600;
+    [ledger flushOnNotificationsNamed:@[kAIUABenchLifecycleNotification]];
+    [ledger performBlock:^{
+        [ledger loadNamespaceIfNeededLocked:kAIUABenchNamespace];
+    }];
+    storage.writes = 0;
+    storage.writtenBytes = 0;
+
+    double start = AIUATestNow();
+    for (NSUInteger i = 0; i < consumes; i++) {
+        @autoreleasepool {
+            // 与 AIUAWordPackManager 的 consumeWords: + recordConsumption: 相同的调用顺序
+            [ledger performBlock:^{
+                [ledger loadNamespaceIfNeededLocked:kAIUABenchNamespace];
+                [ledger removeExpiredPurchasesAtDateLocked:[NSDate date]];
+                if ([ledger consumeWordsLocked:10 remainingWords:NULL]) {
+                    [ledger recordConsumedWordsLocked:10];
+                }
+            }];
+            if (flushEveryConsume) {
+                [ledger flush];
+            }
+        }
+    }
+    [[NSNotificationCenter defaultCenter] postNotificationName:kAIUABenchLifecycleNotification object:nil];
+    double elapsed = AIUATestNow() - start;
+    [[NSNotificationCenter defaultCenter] removeObserver:ledger];
+    return consumes / elapsed;
+}
+
+static BOOL AIUABenchStoredTotals(AIUABenchLedgerStorage *storage, NSInteger *remaining, NSInteger *consumed) {
+    NSArray *purchases = [storage objectForKey:[NSString stringWithFormat:@"%@.%@", AIUAWordPackLedgerPurchasesKey, kAIUABenchNamespace]];
+    if (![purchases isKindOfClass:[NSArray class]]) {
+        return NO;
+    }
+    *remaining = 0;
+    for (NSDictionary *record in purchases) {
+        *remaining += [record[@"remainingWords"] integerValue];
+    }
+    *consumed = [storage integerForKey:[NSString stringWithFormat:@"%@.%@", AIUAWordPackLedgerConsumedWordsKey, kAIUABenchNamespace]];
+    return YES;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger consumes = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 5000;
+        consumes = MAX(consumes, (NSUInteger)1);
+        const NSUInteger lotCounts[] = {1, 10, 100};
+
+        printf("[AIUAWordPackLedger] 连续消耗 %lu 次（每次 10 字），每秒消耗次数与存储写入\n", (unsigned long)consumes);
+        printf("  批次数   延迟写回 次/秒   写入次数 / 字节      每次写回 次/秒   写入次数 / 字节        加速\n");
+        for (size_t c = 0; c < sizeof(lotCounts) / sizeof(lotCounts[0]); c++) {
+            NSUInteger lotCount = lotCounts[c];
+            AIUABenchLedgerStorage *debounced = AIUABenchMakeStorage(lotCount, consumes);
+            AIUABenchLedgerStorage *eager = AIUABenchMakeStorage(lotCount, consumes);
+            double debouncedRate = AIUABenchRun(debounced, consumes, NO);
+            double eagerRate = AIUABenchRun(eager, consumes, YES);
+
+            NSInteger debouncedRemaining = 0, debouncedConsumed = 0, eagerRemaining = 0, eagerConsumed = 0;
+            if (!AIUABenchStoredTotals(debounced, &debouncedRemaining, &debouncedConsumed) ||
+                !AIUABenchStoredTotals(eager, &eagerRemaining, &eagerConsumed) ||
+                debouncedRemaining != eagerRemaining || debouncedConsumed != eagerConsumed ||
+                debouncedConsumed != (NSInteger)consumes * 10) {
+                fprintf(stderr, "批次数 %lu：写回后的余额/累计消耗不一致（%ld/%ld 与 %ld/%ld）\n", (unsigned long)lotCount,
+                        (long)debouncedRemaining, (long)debouncedConsumed, (long)eagerRemaining, (long)eagerConsumed);
+                return 1;
+            }
+            printf("  %6lu   %14.0f   %8lu / %8lu   %14.0f   %8lu / %10lu   %6.1fx\n", (unsigned long)lotCount,
+                   debouncedRate, (unsigned long)debounced.writes, (unsigned long)debounced.writtenBytes,
+                   eagerRate, (unsigned long)eager.writes, (unsigned long)eager.writtenBytes,
+                   debouncedRate / eagerRate);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,272 @@
+//
+//  AIUAWordPackLedgerTests.m
+//  AIUniversalAssistant
+//
+//  AIUAWordPackLedger 测试：用记录写入的内存存储代替 Keychain，核对写回时机与写入的 key
+//  - 首次加载旧账本：立即写回同步状态与购买记录（迁移），之后重新加载不再迁移
+//  - 消耗只标记脏 key，延迟写回之前存储不变；收到生命周期通知后每个脏 key 只写一次，
+//    值为内存账本的当前值，并调用一次 uploadHandler；没有修改时通知不写入、不上传
+//  - 余额不足时消耗失败且不产生写入
+//  - 延迟到期后自动写回；切换命名空间时先把修改写回旧命名空间
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAWordPackLedgerTests
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLedger.h"
+#include "AIUATestSupport.h"
+
+static NSString * const kAIUATestNamespace = @"user.test";
+static NSString * const kAIUATestOtherNamespace = @"user.other";
+static NSString * const kAIUATestLifecycleNotification = @"AIUATestApplicationDidEnterBackgroundNotification";
+static const NSInteger kAIUATestGiftWords = 500000;
+
+/// 内存存储：写入时经 plist 序列化复制一份（与 Keychain 一样保存的是快照），并记录写入的 key
+@interface AIUATestLedgerStorage : NSObject <AIUAWordPackLedgerStorage>
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *values;
+@property (nonatomic, strong) NSMutableArray<NSString *> *writtenKeys;
+@end
+
+@implementation AIUATestLedgerStorage
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _values = [NSMutableDictionary dictionary];
+        _writtenKeys = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (BOOL)setInteger:(NSInteger)value forKey:(NSString *)key {
+    return [self setObject:@(value) forKey:key];
+}
+
+- (NSInteger)integerForKey:(NSString *)key {
+    return [self.values[key] integerValue];
+}
+
+- (BOOL)setObject:(id)object forKey:(NSString *)key {
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:object
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:nil];
+    if (!data) {
+        return NO;
+    }
+    self.values[key] = [NSPropertyListSerialization propertyListWithData:data options:0 format:NULL error:nil];
+    [self.writtenKeys addObject:key];
+    return YES;
+}
+
+- (id)objectForKey:(NSString *)key {
+    return self.values[key];
+}
+
+@end
+
+static NSString *AIUATestKey(NSString *key, NSString *ns) {
+    return [NSString stringWithFormat:@"%@.%@", key, ns];
+}
+
+static NSUInteger AIUATestWriteCount(AIUATestLedgerStorage *storage, NSString *key) {
+    NSUInteger count = 0;
+    for (NSString *written in storage.writtenKeys) {
+        count += [written isEqualToString:key] ? 1 : 0;
+    }
+    return count;
+}
+
+static NSInteger AIUATestStoredRemainingWords(AIUATestLedgerStorage *storage, NSString *ns) {
+    NSInteger remaining = 0;
+    for (NSDictionary *record in [storage objectForKey:AIUATestKey(AIUAWordPackLedgerPurchasesKey, ns)]) {
+        remaining += [record[@"remainingWords"] integerValue];
+    }
+    return remaining;
+}
+
+static AIUAWordPackLedger *AIUATestMakeLedger(AIUATestLedgerStorage *storage, NSTimeInterval flushDelay, NSUInteger *uploads) {
+    AIUAWordPackLedger *ledger = [[AIUAWordPackLedger alloc] initWithStorage:storage
+                                                                   giftWords:kAIUATestGiftWords
+                                                            deviceIDProvider:^NSString *{
+        return @"device-test";
+    }];
+    ledger.flushDelay = flushDelay;
+    ledger.uploadHandler = ^{
+        if (uploads) {
+            (*uploads)++;
+        }
+    };
+    return ledger;
+}
+
+/// 与 AIUAWordPackManager 的 consumeWords: + recordConsumption: 相同的调用顺序
+static BOOL AIUATestConsume(AIUAWordPackLedger *ledger, NSString *ns, NSInteger words, NSInteger *remainingWords) {
+    __block BOOL success = NO;
+    __block NSInteger remaining = 0;
+    [ledger performBlock:^{
+        [ledger loadNamespaceIfNeededLocked:ns];
+        [ledger removeExpiredPurchasesAtDateLocked:[NSDate date]];
+        success = [ledger consumeWordsLocked:words remainingWords:&remaining];
+        if (success) {
+            [ledger recordConsumedWordsLocked:words];
+        }
+    }];
+    if (remainingWords) {
+        *remainingWords = remaining;
+    }
+    return success;
+}
+
+static void AIUATestSeedLegacyLedger(AIUATestLedgerStorage *storage, NSString *ns) {
+    NSDate *now = [NSDate date];
+    NSArray *purchases = @[
+        @{@"productID": @"com.aiua.wordpack.3m",
+          @"words": @(3000),
+          @"remainingWords": @(3000),
+          @"purchaseDate": [now dateByAddingTimeInterval:-2 * 24 * 60 * 60],
+          @"expiryDate": [now dateByAddingTimeInterval:88 * 24 * 60 * 60]},
+        @{@"productID": @"com.aiua.wordpack.6m",
+          @"words": @(5000),
+          @"remainingWords": @(5000),
+          @"purchaseDate": [now dateByAddingTimeInterval:-24 * 60 * 60],
+          @"expiryDate": [now dateByAddingTimeInterval:89 * 24 * 60 * 60]}
+    ];
+    [storage setObject:purchases forKey:AIUATestKey(AIUAWordPackLedgerPurchasesKey, ns)];
+    [storage setInteger:200 forKey:AIUATestKey(AIUAWordPackLedgerConsumedWordsKey, ns)];
+    [storage.writtenKeys removeAllObjects];
+}
+
+static void AIUATestConsumeThenLifecycleNotification(void) {
+    AIUATestLedgerStorage *storage = [[AIUATestLedgerStorage alloc] init];
+    AIUATestSeedLegacyLedger(storage, kAIUATestNamespace);
+    NSString *purchasesKey = AIUATestKey(AIUAWordPackLedgerPurchasesKey, kAIUATestNamespace);
+    NSString *syncEntriesKey = AIUATestKey(AIUAWordPackLedgerSyncEntriesKey, kAIUATestNamespace);
+    NSString *consumedKey = AIUATestKey(AIUAWordPackLedgerConsumedWordsKey, kAIUATestNamespace);
+
+    // 延迟足够长，只有通知会触发写回
+    NSUInteger uploads = 0;
+    AIUAWordPackLedger *ledger = AIUATestMakeLedger(storage, 3600, &uploads);
+    [ledger flushOnNotificationsNamed:@[kAIUATestLifecycleNotification]];
+
+    // 首次加载：迁移旧账本，同步状态与购买记录立即写回
+    [ledger performBlock:^{
+        [ledger loadNamespaceIfNeededLocked:kAIUATestNamespace];
+    }];
+    AIUA_CHECK(storage.writtenKeys.count == 2);
+    AIUA_CHECK(AIUATestWriteCount(storage, syncEntriesKey) == 1);
+    AIUA_CHECK(AIUATestWriteCount(storage, purchasesKey) == 1);
+    AIUA_CHECK([[storage objectForKey:syncEntriesKey] isKindOfClass:[NSDictionary class]]);
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 8000);
+    [storage.writtenKeys removeAllObjects];
+
+    // 迁移需要上传，但尚未写回/上传；通知触发一次上传，没有 key 要写
+    [[NSNotificationCenter defaultCenter] postNotificationName:kAIUATestLifecycleNotification object:nil];
+    AIUA_CHECK(storage.writtenKeys.count == 0);
+    AIUA_CHECK(uploads == 1);
+    uploads = 0;
+
+    // 消耗 100 次，每次 10 字：只改内存
+    NSInteger remaining = 0;
+    for (NSInteger i = 0; i < 100; i++) {
+        AIUA_CHECK(AIUATestConsume(ledger, kAIUATestNamespace, 10, &remaining));
+    }
+    AIUA_CHECK(remaining == 7000);
+    AIUA_CHECK_MSG(storage.writtenKeys.count == 0, "通知前写入了 %lu 次", (unsigned long)storage.writtenKeys.count);
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 8000);
+    AIUA_CHECK([storage integerForKey:consumedKey] == 200);
+    AIUA_CHECK(uploads == 0);
+
+    // 余额不足：失败，返回当前余额，不产生新的修改
+    AIUA_CHECK(!AIUATestConsume(ledger, kAIUATestNamespace, 7001, &remaining));
+    AIUA_CHECK(remaining == 7000);
+
+    // 生命周期通知：三个脏 key 各写一次，值与内存账本一致
+    [[NSNotificationCenter defaultCenter] postNotificationName:kAIUATestLifecycleNotification object:nil];
+    AIUA_CHECK_MSG(storage.writtenKeys.count == 3, "写入 %s",
+                   [[storage.writtenKeys componentsJoinedByString:@", "] UTF8String]);
+    AIUA_CHECK(AIUATestWriteCount(storage, purchasesKey) == 1);
+    AIUA_CHECK(AIUATestWriteCount(storage, syncEntriesKey) == 1);
+    AIUA_CHECK(AIUATestWriteCount(storage, consumedKey) == 1);
+    AIUA_CHECK(AIUATestWriteCount(storage, AIUATestKey(AIUAWordPackLedgerGiftedWordsKey, kAIUATestNamespace)) == 0);
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 7000);
+    AIUA_CHECK([storage integerForKey:consumedKey] == 1200);
+    AIUA_CHECK(uploads == 1);
+    __block NSDictionary *entries = nil;
+    [ledger performBlock:^{
+        entries = [ledger.syncState entries];
+    }];
+    AIUA_CHECK([[storage objectForKey:syncEntriesKey] isEqualToDictionary:entries]);
+
+    // 没有修改时再次收到通知：不写入、不上传
+    [storage.writtenKeys removeAllObjects];
+    [[NSNotificationCenter defaultCenter] postNotificationName:kAIUATestLifecycleNotification object:nil];
+    AIUA_CHECK(storage.writtenKeys.count == 0);
+    AIUA_CHECK(uploads == 1);
+    [[NSNotificationCenter defaultCenter] removeObserver:ledger];
+
+    // 从存储重新加载：余额与累计消耗不变，不再迁移
+    AIUAWordPackLedger *reloaded = AIUATestMakeLedger(storage, 3600, NULL);
+    __block NSInteger reloadedRemaining = 0;
+    __block NSInteger reloadedConsumed = 0;
+    [reloaded performBlock:^{
+        [reloaded loadNamespaceIfNeededLocked:kAIUATestNamespace];
+        reloadedRemaining = reloaded.lots.remainingWords;
+        reloadedConsumed = reloaded.consumedWords;
+    }];
+    AIUA_CHECK(reloadedRemaining == 7000);
+    AIUA_CHECK(reloadedConsumed == 1200);
+    AIUA_CHECK(storage.writtenKeys.count == 0);
+}
+
+static void AIUATestDebouncedFlush(void) {
+    AIUATestLedgerStorage *storage = [[AIUATestLedgerStorage alloc] init];
+    AIUATestSeedLegacyLedger(storage, kAIUATestNamespace);
+    NSString *purchasesKey = AIUATestKey(AIUAWordPackLedgerPurchasesKey, kAIUATestNamespace);
+    NSUInteger uploads = 0;
+    AIUAWordPackLedger *ledger = AIUATestMakeLedger(storage, 0.05, &uploads);
+    [ledger performBlock:^{
+        [ledger loadNamespaceIfNeededLocked:kAIUATestNamespace];
+    }];
+    [storage.writtenKeys removeAllObjects];
+
+    // 延迟内的多次消耗合并为一次写回
+    for (NSInteger i = 0; i < 20; i++) {
+        AIUATestConsume(ledger, kAIUATestNamespace, 50, NULL);
+    }
+    AIUA_CHECK(AIUATestWriteCount(storage, purchasesKey) == 0);
+    [NSThread sleepForTimeInterval:0.5];
+    // 延迟写回在账本队列上执行，经 performBlock: 读取以确保已完成
+    [ledger performBlock:^{}];
+    AIUA_CHECK(AIUATestWriteCount(storage, purchasesKey) == 1);
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 7000);
+    AIUA_CHECK(uploads == 1);
+}
+
+static void AIUATestNamespaceSwitch(void) {
+    AIUATestLedgerStorage *storage = [[AIUATestLedgerStorage alloc] init];
+    AIUATestSeedLegacyLedger(storage, kAIUATestNamespace);
+    AIUAWordPackLedger *ledger = AIUATestMakeLedger(storage, 3600, NULL);
+    AIUA_CHECK(AIUATestConsume(ledger, kAIUATestNamespace, 500, NULL));
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 8000);
+
+    // 切换账号：旧命名空间先写回，新命名空间独立加载
+    __block NSInteger otherRemaining = -1;
+    [ledger performBlock:^{
+        [ledger loadNamespaceIfNeededLocked:kAIUATestOtherNamespace];
+        otherRemaining = ledger.lots.remainingWords;
+    }];
+    AIUA_CHECK(AIUATestStoredRemainingWords(storage, kAIUATestNamespace) == 7500);
+    AIUA_CHECK([storage integerForKey:AIUATestKey(AIUAWordPackLedgerConsumedWordsKey, kAIUATestNamespace)] == 700);
+    AIUA_CHECK(otherRemaining == 0);
+    AIUA_CHECK(!AIUATestConsume(ledger, kAIUATestOtherNamespace, 1, NULL));
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        AIUATestConsumeThenLifecycleNotification();
+        AIUATestDebouncedFlush();
+        AIUATestNamespaceSwitch();
+        return AIUATestSummary("AIUAWordPackLedger");
+    }
+}
@@ -0,0 +1,163 @@
+//
+//  AIUAWordPackLotStoreBench.m
+//  AIUniversalAssistant
+//
+//  AIUAWordPackLotStore 基准：1k / 10k 条批次（大量激励视频奖励记录），对比原实现
+//  （每次消耗前对全部记录按购买时间排序并线性跳过过期记录、清理与即将过期查询各自全表遍历）
+//  - 加载：从持久化记录数组建立索引
+//  - 消耗：先清理过期记录再扣减（与 AIUAWordPackManager 一致），每次扣减约 800 字
+//  - 即将过期：7 天内按天分组
+//  - 追加：新增一条奖励记录
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAWordPackLotStoreBench
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLotStore.h"
+#include "AIUATestSupport.h"
+
+// 原实现：记录数组 + 每次消耗排序
+static NSInteger AIUABenchLegacyConsume(NSMutableArray<NSMutableDictionary *> *records, NSInteger words, NSDate *now) {
+    [records sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return [a[@"purchaseDate"] compare:b[@"purchaseDate"]];
+    }];
+    NSInteger remainingToConsume = words;
+    for (NSMutableDictionary *record in records) {
+        if (remainingToConsume <= 0) {
+            break;
+        }
+        if ([now compare:record[@"expiryDate"]] == NSOrderedDescending) {
+            continue;
+        }
+        NSInteger remainingWords = [record[@"remainingWords"] integerValue];
+        if (remainingWords > 0) {
+            NSInteger consumeFromThis = MIN(remainingToConsume, remainingWords);
+            record[@"remainingWords"] = @(remainingWords - consumeFromThis);
+            remainingToConsume -= consumeFromThis;
+        }
+    }
+    return words - remainingToConsume;
+}
+
+static NSInteger AIUABenchLegacyClean(NSMutableArray<NSMutableDictionary *> *records, NSDate *now) {
+    NSIndexSet *expired = [records indexesOfObjectsPassingTest:^BOOL(NSMutableDictionary *record, NSUInteger idx, BOOL *stop) {
+        return [now compare:record[@"expiryDate"]] != NSOrderedAscending;
+    }];
+    [records removeObjectsAtIndexes:expired];
+    return (NSInteger)expired.count;
+}
+
+static NSDictionary *AIUABenchLegacyExpiring(NSArray<NSMutableDictionary *> *records, NSDate *now) {
+    NSMutableDictionary<NSNumber *, NSNumber *> *expiringByDays = [NSMutableDictionary dictionary];
+    for (NSDictionary *record in records) {
+        NSDate *expiryDate = record[@"expiryDate"];
+        if ([now compare:expiryDate] != NSOrderedAscending) {
+            continue;
+        }
+        NSInteger daysRemaining = (NSInteger)ceil([expiryDate timeIntervalSinceDate:now] / (24 * 60 * 60));
+        if (daysRemaining >= 1 && daysRemaining <= 7) {
+            expiringByDays[@(daysRemaining)] = @([expiringByDays[@(daysRemaining)] integerValue] + [record[@"remainingWords"] integerValue]);
+        }
+    }
+    return expiringByDays;
+}
+
+// count 条记录：购买时间乱序分布在过去 180 天，有效期 3 ~ 90 天（约三成已过期），多数为 2000 字的奖励
+static NSArray<NSDictionary *> *AIUABenchRecords(NSUInteger count, NSDate *now, AIUATestRandom *random) {
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSDate *purchaseDate = [now dateByAddingTimeInterval:-(double)AIUATestRandomBelow(random, 180 * 86400)];
+        NSInteger words = AIUATestRandomBelow(random, 20) == 0 ? 500000 : 2000;
+        [records addObject:@{@"productID": @"bonus",
+                             @"words": @(words),
+                             @"remainingWords": @(words),
+                             @"purchaseDate": purchaseDate,
+                             @"expiryDate": [purchaseDate dateByAddingTimeInterval:86400.0 * (3 + AIUATestRandomBelow(random, 88))]}];
+    }
+    return records;
+}
+
+int main(void) {
+    @autoreleasepool {
+        const NSUInteger counts[] = {1000, 10000};
+        const NSUInteger consumes = 500;
+        printf("[AIUAWordPackLotStore] 索引 vs 原实现（每次消耗排序）\n");
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            AIUATestRandom random;
+            AIUATestRandomSeed(&random, 10);
+            NSDate *now = [NSDate dateWithTimeIntervalSince1970:1767225600];
+            NSArray<NSDictionary *> *records = AIUABenchRecords(counts[c], now, &random);
+
+            double start = AIUATestNow();
+            AIUAWordPackLotStore *store = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:records];
+            double load = AIUATestNow() - start;
+            NSMutableArray<NSMutableDictionary *> *legacy = [NSMutableArray arrayWithCapacity:records.count];
+            start = AIUATestNow();
+            for (NSDictionary *record in records) {
+                [legacy addObject:[record mutableCopy]];
+            }
+            [legacy sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+                return [a[@"purchaseDate"] compare:b[@"purchaseDate"]];
+            }];
+            double legacyLoad = AIUATestNow() - start;
+
+            // 消耗：每次之间时间前进 1 分钟
+            NSInteger consumed = 0;
+            NSInteger legacyConsumed = 0;
+            NSDate *time = now;
+            start = AIUATestNow();
+            for (NSUInteger i = 0; i < consumes; i++) {
+                time = [time dateByAddingTimeInterval:60];
+                [store removeExpiredLotsAtDate:time];
+                consumed += [store consumeWords:800];
+            }
+            double consume = (AIUATestNow() - start) / consumes;
+            time = now;
+            start = AIUATestNow();
+            for (NSUInteger i = 0; i < consumes; i++) {
+                time = [time dateByAddingTimeInterval:60];
+                AIUABenchLegacyClean(legacy, time);
+                legacyConsumed += AIUABenchLegacyConsume(legacy, 800, time);
+            }
+            double legacyConsume = (AIUATestNow() - start) / consumes;
+            if (consumed != legacyConsumed || store.remainingWords != [[legacy valueForKeyPath:@"@sum.remainingWords"] integerValue]) {
+                fprintf(stderr, "索引与原实现的扣减结果不一致\n");
+                return 1;
+            }
+
+            const NSUInteger queries = 200;
+            NSDictionary *expiring = nil;
+            start = AIUATestNow();
+            for (NSUInteger i = 0; i < queries; i++) {
+                expiring = [store expiringWordsWithinDays:7 atDate:time];
+            }
+            double query = (AIUATestNow() - start) / queries;
+            NSDictionary *legacyExpiring = nil;
+            start = AIUATestNow();
+            for (NSUInteger i = 0; i < queries; i++) {
+                legacyExpiring = AIUABenchLegacyExpiring(legacy, time);
+            }
+            double legacyQuery = (AIUATestNow() - start) / queries;
+            if (![expiring isEqualToDictionary:legacyExpiring]) {
+                fprintf(stderr, "即将过期分组不一致\n");
+                return 1;
+            }
+
+            start = AIUATestNow();
+            for (NSUInteger i = 0; i < queries; i++) {
+                [store addPurchaseRecord:@{@"productID": @"bonus", @"words": @2000, @"remainingWords": @2000,
+                                           @"purchaseDate": time, @"expiryDate": [time dateByAddingTimeInterval:7 * 86400]}];
+            }
+            double add = (AIUATestNow() - start) / queries;
+
+            printf("  %5lu 条（未过期 %lu 条）\n", (unsigned long)counts[c], (unsigned long)store.count - queries);
+            printf("    加载            %9.3f ms   原实现 %9.3f ms\n", load * 1e3, legacyLoad * 1e3);
+            printf("    清理+消耗       %9.2f µs   原实现 %9.2f µs  （%.0fx）\n", consume * 1e6, legacyConsume * 1e6,
+                   legacyConsume / consume);
+            printf("    7 天内即将过期  %9.2f µs   原实现 %9.2f µs  （%.0fx）\n", query * 1e6, legacyQuery * 1e6,
+                   legacyQuery / query);
+            printf("    追加一条        %9.2f µs\n", add * 1e6);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,280 @@
+//
+//  AIUAWordPackLotStoreTests.m
+//  AIUniversalAssistant
+//
+//  AIUAWordPackLotStore 测试：随机的购买、消耗、过期清理与"N 天内即将过期"查询序列中，
+//  与按原实现写成的参考模型（每次按购买时间稳定排序、线性跳过过期记录、逐条遍历统计）逐步比对
+//  - 购买时间优先（默认）：扣减结果、各记录剩余字数、持久化顺序、剩余总数、即将过期分组必须与参考模型完全一致
+//  - 过期时间优先：按过期时间稳定排序的参考模型
+//  - 中途切换消耗顺序、从持久化记录重建后状态不变
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAWordPackLotStoreTests [操作次数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackLotStore.h"
+#include "AIUATestSupport.h"
+
+#pragma mark - 参考模型
+
+// 原 AIUAWordPackManager 的做法：记录数组，消耗前按购买时间稳定排序（缺少购买时间的排在最前）
+@interface AIUAReferenceLots : NSObject
+@property (nonatomic, strong) NSMutableArray<NSMutableDictionary *> *records;     // 加入顺序
+@property (nonatomic, assign) AIUAWordPackConsumePolicy policy;
+@end
+
+@implementation AIUAReferenceLots
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _records = [NSMutableArray array];
+    }
+    return self;
+}
+
+static NSComparisonResult AIUAReferenceCompareDates(id date1, id date2) {
+    NSDate *a = [date1 isKindOfClass:[NSDate class]] ? date1 : nil;
+    NSDate *b = [date2 isKindOfClass:[NSDate class]] ? date2 : nil;
+    if (!a || !b) {
+        return a ? NSOrderedDescending : (b ? NSOrderedAscending : NSOrderedSame);
+    }
+    return [a compare:b];
+}
+
+- (NSArray<NSMutableDictionary *> *)sortedByKey:(NSString *)key {
+    return [self.records sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return AIUAReferenceCompareDates(a[key], b[key]);
+    }];
+}
+
+- (NSArray<NSDictionary *> *)removeExpiredAtDate:(NSDate *)date {
+    NSMutableArray<NSDictionary *> *removed = [NSMutableArray array];
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    [self.records enumerateObjectsUsingBlock:^(NSMutableDictionary *record, NSUInteger idx, BOOL *stop) {
+        NSDate *expiryDate = record[@"expiryDate"];
+        if ([expiryDate isKindOfClass:[NSDate class]] && [date compare:expiryDate] == NSOrderedAscending) {
+            return;
+        }
+        [indexes addIndex:idx];
+        [removed addObject:[record copy]];
+    }];
+    [self.records removeObjectsAtIndexes:indexes];
+    return removed;
+}
+
+- (NSInteger)consumeWords:(NSInteger)words {
+    NSString *key = self.policy == AIUAWordPackConsumePolicyEarliestExpiry ? @"expiryDate" : @"purchaseDate";
+    NSInteger remainingToConsume = words;
+    for (NSMutableDictionary *record in [self sortedByKey:key]) {
+        if (remainingToConsume <= 0) {
+            break;
+        }
+        NSInteger remainingWords = [record[@"remainingWords"] integerValue];
+        if (remainingWords > 0) {
+            NSInteger consumeFromThis = MIN(remainingToConsume, remainingWords);
+            record[@"remainingWords"] = @(remainingWords - consumeFromThis);
+            remainingToConsume -= consumeFromThis;
+        }
+    }
+    return words - remainingToConsume;
+}
+
+- (NSInteger)remainingWords {
+    NSInteger total = 0;
+    for (NSDictionary *record in self.records) {
+        total += [record[@"remainingWords"] integerValue];
+    }
+    return total;
+}
+
+- (NSDictionary<NSNumber *, NSNumber *> *)expiringWordsWithinDays:(NSInteger)days atDate:(NSDate *)date {
+    NSMutableDictionary<NSNumber *, NSNumber *> *expiringByDays = [NSMutableDictionary dictionary];
+    for (NSDictionary *record in self.records) {
+        NSDate *expiryDate = record[@"expiryDate"];
+        if (![expiryDate isKindOfClass:[NSDate class]] || [date compare:expiryDate] != NSOrderedAscending) {
+            continue;
+        }
+        NSInteger daysRemaining = (NSInteger)ceil([expiryDate timeIntervalSinceDate:date] / (24 * 60 * 60));
+        if (daysRemaining >= 1 && daysRemaining <= days) {
+            expiringByDays[@(daysRemaining)] = @([expiringByDays[@(daysRemaining)] integerValue] + [record[@"remainingWords"] integerValue]);
+        }
+    }
+    return expiringByDays;
+}
+
+- (NSArray<NSDictionary *> *)purchaseRecords {
+    NSMutableArray<NSDictionary *> *records = [NSMutableArray array];
+    for (NSDictionary *record in [self sortedByKey:@"purchaseDate"]) {
+        [records addObject:[record copy]];
+    }
+    return records;
+}
+
+@end
+
+#pragma mark - 随机序列
+
+// 日期取整到小时且范围小，制造大量相同的购买/过期时间；偶尔缺少日期
+static NSMutableDictionary *AIUATestRandomRecord(AIUATestRandom *random, NSDate *now, NSUInteger serial) {
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    record[@"productID"] = [NSString stringWithFormat:@"lot.%lu", (unsigned long)serial];
+    NSInteger words = (NSInteger[]){0, 500, 20000, 500000, 2000000}[AIUATestRandomBelow(random, 5)];
+    record[@"words"] = @(words);
+    record[@"remainingWords"] = @(words > 0 ? words - (NSInteger)AIUATestRandomBelow(random, (size_t)words) : 0);
+    if (AIUATestRandomBelow(random, 40) != 0) {
+        record[@"purchaseDate"] = [now dateByAddingTimeInterval:-3600.0 * AIUATestRandomBelow(random, 48)];
+    }
+    if (AIUATestRandomBelow(random, 60) != 0) {
+        record[@"expiryDate"] = [now dateByAddingTimeInterval:3600.0 * ((double)AIUATestRandomBelow(random, 24 * 10) - 12)];
+    }
+    return record;
+}
+
+static void AIUATestCompare(AIUAWordPackLotStore *store, AIUAReferenceLots *reference, NSDate *now, NSString *label) {
+    AIUA_CHECK_MSG(store.remainingWords == reference.remainingWords, "%s：剩余 %ld / %ld", label.UTF8String,
+                   (long)store.remainingWords, (long)reference.remainingWords);
+    AIUA_CHECK_MSG(store.count == reference.records.count, "%s：%lu / %lu 条", label.UTF8String,
+                   (unsigned long)store.count, (unsigned long)reference.records.count);
+    AIUA_CHECK_MSG([[store purchaseRecords] isEqualToArray:[reference purchaseRecords]], "%s：持久化记录不一致", label.UTF8String);
+    AIUA_CHECK_MSG([[store expiringWordsWithinDays:7 atDate:now] isEqualToDictionary:[reference expiringWordsWithinDays:7 atDate:now]],
+                   "%s：即将过期分组不一致", label.UTF8String);
+}
+
+static void AIUATestRandomOperations(AIUAWordPackConsumePolicy policy, BOOL switchPolicy, NSUInteger operations, uint64_t seed) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+    NSDate *now = [NSDate dateWithTimeIntervalSince1970:1767225600];
+    AIUAReferenceLots *reference = [[AIUAReferenceLots alloc] init];
+    NSMutableArray *initial = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 50; i++) {
+        NSMutableDictionary *record = AIUATestRandomRecord(&random, now, i);
+        [initial addObject:[record copy]];
+        [reference.records addObject:record];
+    }
+    AIUAWordPackLotStore *store = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:initial];
+    store.policy = policy;
+    reference.policy = policy;
+    NSString *label = [NSString stringWithFormat:@"种子 %llu 策略 %lu", seed, (unsigned long)policy];
+    NSUInteger serial = 50;
+    for (NSUInteger op = 0; op < operations; op++) {
+        switch (AIUATestRandomBelow(&random, 6)) {
+            case 0: {
+                NSMutableDictionary *record = AIUATestRandomRecord(&random, now, serial++);
+                [store addPurchaseRecord:[record copy]];
+                [reference.records addObject:record];
+                break;
+            }
+            case 1:
+                now = [now dateByAddingTimeInterval:1800.0 * AIUATestRandomBelow(&random, 6)];
+                break;
+            case 2:
+                if (switchPolicy) {
+                    store.policy = store.policy == AIUAWordPackConsumePolicyPurchaseDate ?
+                        AIUAWordPackConsumePolicyEarliestExpiry : AIUAWordPackConsumePolicyPurchaseDate;
+                    reference.policy = store.policy;
+                }
+                break;
+            default: {
+                // 与 AIUAWordPackManager 一致：先移除过期记录再扣减
+                NSArray *removed = [store removeExpiredLotsAtDate:now];
+                NSArray *expected = [reference removeExpiredAtDate:now];
+                AIUA_CHECK_MSG(removed.count == expected.count, "%s：移除 %lu / %lu 条", label.UTF8String,
+                               (unsigned long)removed.count, (unsigned long)expected.count);
+                NSInteger words = 1 + (NSInteger)AIUATestRandomBelow(&random, AIUATestRandomBelow(&random, 10) == 0 ? 3000000 : 5000);
+                __block NSInteger reported = 0;
+                NSInteger consumed = [store consumeWords:words usingBlock:^(NSDictionary *record, NSInteger consumedWords) {
+                    reported += consumedWords;
+                }];
+                NSInteger expectedConsumed = [reference consumeWords:words];
+                AIUA_CHECK_MSG(consumed == expectedConsumed && reported == consumed, "%s：扣减 %ld / %ld（回调 %ld）",
+                               label.UTF8String, (long)consumed, (long)expectedConsumed, (long)reported);
+                break;
+            }
+        }
+        if (op % 16 == 0) {
+            [store removeExpiredLotsAtDate:now];
+            [reference removeExpiredAtDate:now];
+            AIUATestCompare(store, reference, now, label);
+        }
+    }
+    [store removeExpiredLotsAtDate:now];
+    [reference removeExpiredAtDate:now];
+    AIUATestCompare(store, reference, now, label);
+
+    // 从持久化记录重建（重启后相同日期的记录按持久化顺序排列，参考模型同样按持久化顺序重建）
+    AIUAWordPackLotStore *restored = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:[store purchaseRecords]];
+    restored.policy = store.policy;
+    NSMutableArray<NSMutableDictionary *> *persisted = [NSMutableArray array];
+    for (NSDictionary *record in [reference purchaseRecords]) {
+        [persisted addObject:[record mutableCopy]];
+    }
+    reference.records = persisted;
+    AIUATestCompare(restored, reference, now, [label stringByAppendingString:@" 重建"]);
+    AIUA_CHECK([restored consumeWords:123456] == [reference consumeWords:123456]);
+    AIUATestCompare(restored, reference, now, [label stringByAppendingString:@" 重建后扣减"]);
+}
+
+#pragma mark - 固定用例
+
+static void AIUATestOrdering(void) {
+    NSDate *now = [NSDate dateWithTimeIntervalSince1970:1767225600];
+    NSDate *day = [now dateByAddingTimeInterval:86400];
+    // a 先购买但后过期，b 后购买但先过期；c 与 a 同时购买，排在 a 之后
+    NSArray *records = @[
+        @{@"productID": @"a", @"words": @100, @"remainingWords": @100, @"purchaseDate": now, @"expiryDate": [day dateByAddingTimeInterval:86400 * 5]},
+        @{@"productID": @"b", @"words": @100, @"remainingWords": @100, @"purchaseDate": [now dateByAddingTimeInterval:60], @"expiryDate": day},
+        @{@"productID": @"c", @"words": @100, @"remainingWords": @100, @"purchaseDate": now, @"expiryDate": [day dateByAddingTimeInterval:86400 * 9]},
+        @{@"productID": @"expired", @"words": @100, @"remainingWords": @100, @"purchaseDate": now, @"expiryDate": now},
+        @{@"productID": @"noExpiry", @"words": @100, @"remainingWords": @100, @"purchaseDate": now},
+    ];
+    AIUAWordPackLotStore *store = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:records];
+    AIUA_CHECK(store.remainingWords == 500);
+    NSArray *removed = [store removeExpiredLotsAtDate:now];
+    AIUA_CHECK(removed.count == 2 && store.remainingWords == 300);
+    // 过期时间不晚于 now 的都移除（含缺少过期时间的）
+    AIUA_CHECK([[removed valueForKey:@"productID"] containsObject:@"expired"] &&
+               [[removed valueForKey:@"productID"] containsObject:@"noExpiry"]);
+
+    NSMutableArray<NSString *> *order = [NSMutableArray array];
+    [store consumeWords:250 usingBlock:^(NSDictionary *record, NSInteger consumedWords) {
+        [order addObject:[NSString stringWithFormat:@"%@%ld", record[@"productID"], (long)consumedWords]];
+    }];
+    AIUA_CHECK_MSG([order isEqualToArray:(@[@"a100", @"c100", @"b50"])], "购买时间优先：%s", order.description.UTF8String);
+
+    store = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:records];
+    [store removeExpiredLotsAtDate:now];
+    store.policy = AIUAWordPackConsumePolicyEarliestExpiry;
+    [order removeAllObjects];
+    [store consumeWords:250 usingBlock:^(NSDictionary *record, NSInteger consumedWords) {
+        [order addObject:[NSString stringWithFormat:@"%@%ld", record[@"productID"], (long)consumedWords]];
+    }];
+    AIUA_CHECK_MSG([order isEqualToArray:(@[@"b100", @"a100", @"c50"])], "过期时间优先：%s", order.description.UTF8String);
+
+    // 余额不足时只扣到 0
+    AIUA_CHECK([store consumeWords:1000] == 50 && store.remainingWords == 0);
+    AIUA_CHECK([store consumeWords:1] == 0);
+    // 已用完但未过期的记录仍保留在持久化记录中
+    AIUA_CHECK(store.count == 3 && [store purchaseRecords].count == 3);
+
+    // 即将过期：b 在 1 天后，a 在 6 天后，c 在 10 天后（超出 7 天）
+    store = [[AIUAWordPackLotStore alloc] initWithPurchaseRecords:records];
+    [store removeExpiredLotsAtDate:now];
+    NSDictionary *expiring = [store expiringWordsWithinDays:7 atDate:now];
+    AIUA_CHECK_MSG([expiring isEqualToDictionary:(@{@1: @100, @6: @100})], "%s", expiring.description.UTF8String);
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger operations = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 3000;
+        AIUATestOrdering();
+        for (uint64_t seed = 1; seed <= 8; seed++) {
+            @autoreleasepool {
+                AIUATestRandomOperations(AIUAWordPackConsumePolicyPurchaseDate, NO, operations, seed);
+                AIUATestRandomOperations(AIUAWordPackConsumePolicyEarliestExpiry, NO, operations, seed + 100);
+                AIUATestRandomOperations(AIUAWordPackConsumePolicyPurchaseDate, YES, operations, seed + 200);
+            }
+        }
+        return AIUATestSummary("AIUAWordPackLotStore");
+    }
+}
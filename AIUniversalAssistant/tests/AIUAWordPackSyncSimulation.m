@@ -0,0 +1,278 @@
+//
+//  AIUAWordPackSyncSimulation.m
+//  AIUniversalAssistant
+//
+//  AIUAWordPackSyncState 的 N 设备模拟：随机上下线、购买/消耗、过期批次移除与 iCloud 键值同步
+//  - 每台设备同时维护一个从不移除过期批次的影子状态，执行完全相同的操作；每次读取都核对两者余额一致，
+//    即移除只影响存储、不影响任何设备看到的余额
+//  - 每台设备的条目中，移除记录里的批次不得出现在批次与计数中；随机重放移除前的本设备旧条目与旧版快照，
+//    验证合并不会让它们复活
+//  - 全部上线同步后各设备余额与累计消耗收敛一致，再同步一轮不再产生变化（不会来回上传）
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAWordPackSyncSimulation [起始种子] [种子个数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWordPackSyncState.h"
+#include "AIUATestSupport.h"
+
+// 设备条目中的字段名，与 AIUAWordPackSyncState.m 一致，只用于核对不变量
+static NSString * const kAIUASimLots = @"lots";
+static NSString * const kAIUASimUsed = @"used";
+static NSString * const kAIUASimBaseUsed = @"baseUsed";
+static NSString * const kAIUASimPruned = @"pruned";
+
+@interface AIUASimDevice : NSObject
+@property (nonatomic, copy) NSString *deviceID;
+@property (nonatomic, strong) AIUAWordPackSyncState *state;
+@property (nonatomic, strong) AIUAWordPackSyncState *shadow;
+@property (nonatomic, assign) NSUInteger uploadedVersion;
+@property (nonatomic, assign) NSUInteger shadowUploadedVersion;
+@property (nonatomic, assign) BOOL online;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *staleEntries;   // 移除前的本设备条目
+@end
+
+@implementation AIUASimDevice
+@end
+
+typedef struct {
+    NSUInteger prunes;
+    NSUInteger staleReplays;
+    NSUInteger operations;
+    NSInteger recordedConsumption;
+} AIUASimStats;
+
+// 余额视图：lotID → 剩余字数（用于比较）
+static NSDictionary<NSString *, NSNumber *> *AIUASimView(AIUAWordPackSyncState *state, NSDate *now) {
+    NSMutableDictionary<NSString *, NSNumber *> *view = [NSMutableDictionary dictionary];
+    for (NSDictionary *record in [state purchaseRecordsAtDate:now policy:AIUAWordPackConsumePolicyPurchaseDate]) {
+        view[record[@"lotID"]] = record[@"remainingWords"];
+    }
+    return view;
+}
+
+static NSInteger AIUASimBalance(NSDictionary<NSString *, NSNumber *> *view) {
+    NSInteger balance = 0;
+    for (NSNumber *words in view.objectEnumerator) {
+        balance += words.integerValue;
+    }
+    return balance;
+}
+
+// 每个条目的移除记录与其批次、计数不相交
+static BOOL AIUASimNoResurrection(AIUAWordPackSyncState *state, NSString **offending) {
+    NSDictionary<NSString *, NSDictionary *> *entries = [state entries];
+    for (NSString *device in entries) {
+        NSDictionary *entry = entries[device];
+        NSDictionary *pruned = entry[kAIUASimPruned];
+        for (NSString *key in @[kAIUASimLots, kAIUASimUsed, kAIUASimBaseUsed]) {
+            for (NSString *lotID in entry[key]) {
+                if (pruned[lotID]) {
+                    *offending = [NSString stringWithFormat:@"%@ 的 %@ 中仍有已移除的 %@", device, key, lotID];
+                    return NO;
+                }
+            }
+        }
+    }
+    return YES;
+}
+
+static NSUInteger AIUASimPrunedCount(NSDictionary *entry) {
+    return [entry[kAIUASimPruned] count];
+}
+
+// 上传变化的本设备条目，再合并云端全部条目；返回是否有任何变化
+static BOOL AIUASimSync(NSArray<AIUASimDevice *> *devices, NSMutableDictionary *cloud, NSMutableDictionary *shadowCloud, AIUATestRandom *random) {
+    BOOL changed = NO;
+    for (AIUASimDevice *device in devices) {
+        if (!device.online) {
+            continue;
+        }
+        if (device.state.localVersion != device.uploadedVersion) {
+            cloud[device.deviceID] = [device.state localEntry];
+            device.uploadedVersion = device.state.localVersion;
+            changed = YES;
+        }
+        if (device.shadow.localVersion != device.shadowUploadedVersion) {
+            shadowCloud[device.deviceID] = [device.shadow localEntry];
+            device.shadowUploadedVersion = device.shadow.localVersion;
+        }
+    }
+    for (AIUASimDevice *device in devices) {
+        if (!device.online) {
+            continue;
+        }
+        // 合并顺序随机，验证与顺序无关
+        NSMutableArray<NSString *> *keys = [cloud.allKeys mutableCopy];
+        for (NSUInteger i = keys.count; i > 1; i--) {
+            [keys exchangeObjectAtIndex:i - 1 withObjectAtIndex:AIUATestRandomBelow(random, i)];
+        }
+        for (NSString *key in keys) {
+            changed |= [device.state mergeEntry:cloud[key] forDeviceID:key];
+            if (shadowCloud[key]) {
+                [device.shadow mergeEntry:shadowCloud[key] forDeviceID:key];
+            }
+        }
+    }
+    return changed;
+}
+
+static BOOL AIUASimRun(uint64_t seed) {
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, seed);
+    NSUInteger deviceCount = 2 + AIUATestRandomBelow(&random, 7);
+    NSUInteger rounds = 400;
+    double onlineRate = (double[]){0.3, 0.6, 0.9}[AIUATestRandomBelow(&random, 3)];
+    NSDate *epoch = [NSDate dateWithTimeIntervalSince1970:1767225600];     // 2026-01-01
+    int failuresBefore = AIUATestFailures;
+
+    NSMutableArray<AIUASimDevice *> *devices = [NSMutableArray array];
+    for (NSUInteger i = 0; i < deviceCount; i++) {
+        AIUASimDevice *device = [[AIUASimDevice alloc] init];
+        device.deviceID = [NSString stringWithFormat:@"D%02lu-%08llx", (unsigned long)i, AIUATestRandomNext(&random) & 0xFFFFFFFFull];
+        device.state = [[AIUAWordPackSyncState alloc] initWithDeviceID:device.deviceID entries:nil];
+        device.shadow = [[AIUAWordPackSyncState alloc] initWithDeviceID:device.deviceID entries:nil];
+        device.staleEntries = [NSMutableArray array];
+        [devices addObject:device];
+    }
+    NSMutableDictionary *cloud = [NSMutableDictionary dictionary];
+    NSMutableDictionary *shadowCloud = [NSMutableDictionary dictionary];
+    NSArray<NSDictionary *> *earlySnapshot = nil;
+    AIUASimStats stats = {0, 0, 0, 0};
+    const NSTimeInterval hour = 3600;
+    const NSTimeInterval expiries[] = {12 * hour, 48 * hour, 7 * 24 * hour, 90 * 24 * hour};
+
+    for (NSUInteger round = 0; round < rounds; round++) {
+        NSDate *now = [epoch dateByAddingTimeInterval:round * hour];
+        for (AIUASimDevice *device in devices) {
+            device.online = AIUATestRandomBelow(&random, 1000) < onlineRate * 1000;
+        }
+        for (AIUASimDevice *device in devices) {
+            NSUInteger operations = AIUATestRandomBelow(&random, 4);
+            for (NSUInteger op = 0; op < operations; op++) {
+                NSDictionary *view = AIUASimView(device.state, now);
+                AIUA_CHECK_MSG([view isEqualToDictionary:AIUASimView(device.shadow, now)],
+                               "种子 %llu 第 %lu 轮 %s：移除过期批次改变了余额", seed, (unsigned long)round, device.deviceID.UTF8String);
+                if (AIUATestRandomBelow(&random, 100) < 10) {
+                    NSDictionary *record = @{@"lotID": [NSUUID UUID].UUIDString,
+                                             @"productID": @"pack",
+                                             @"words": @((NSInteger[]){20000, 500000, 2000000}[AIUATestRandomBelow(&random, 3)]),
+                                             @"purchaseDate": now,
+                                             @"expiryDate": [now dateByAddingTimeInterval:expiries[AIUATestRandomBelow(&random, 4)]]};
+                    [device.state addLot:record];
+                    [device.shadow addLot:record];
+                } else {
+                    NSInteger words = 50 + (NSInteger)AIUATestRandomBelow(&random, 3000);
+                    if (AIUASimBalance(view) < words) {
+                        continue;
+                    }
+                    // 按消耗顺序逐批扣减，与 AIUAWordPackLotStore 一致
+                    NSInteger left = words;
+                    for (NSDictionary *record in [device.state purchaseRecordsAtDate:now policy:AIUAWordPackConsumePolicyPurchaseDate]) {
+                        NSInteger taken = MIN([record[@"remainingWords"] integerValue], left);
+                        if (taken > 0) {
+                            [device.state recordWords:taken consumedFromLot:record[@"lotID"]];
+                            [device.shadow recordWords:taken consumedFromLot:record[@"lotID"]];
+                            left -= taken;
+                        }
+                        if (left == 0) {
+                            break;
+                        }
+                    }
+                    [device.state recordConsumedWords:words];
+                    [device.shadow recordConsumedWords:words];
+                    stats.recordedConsumption += words;
+                }
+                stats.operations++;
+            }
+
+            // 管理器在消耗与刷新时调用；移除前留一份本设备条目，之后随机重放
+            if (AIUATestRandomBelow(&random, 2) == 0) {
+                NSDictionary *before = [device.state localEntry];
+                if ([device.state pruneLotsExpiredBeforeDate:now]) {
+                    stats.prunes++;
+                    [device.staleEntries addObject:before];
+                }
+            }
+            if (device.staleEntries.count > 0 && AIUATestRandomBelow(&random, 10) == 0) {
+                NSDictionary *stale = device.staleEntries[AIUATestRandomBelow(&random, device.staleEntries.count)];
+                [device.state mergeEntry:stale forDeviceID:device.deviceID];
+                stats.staleReplays++;
+            }
+            NSString *offending = nil;
+            AIUA_CHECK_MSG(AIUASimNoResurrection(device.state, &offending), "种子 %llu 第 %lu 轮：%s",
+                           seed, (unsigned long)round, offending.UTF8String);
+        }
+        if (round == 10) {
+            // 旧版本账本快照：之后其中的批次会陆续过期并被移除
+            earlySnapshot = [devices[0].shadow purchaseRecordsAtDate:now policy:AIUAWordPackConsumePolicyPurchaseDate];
+        }
+        AIUASimSync(devices, cloud, shadowCloud, &random);
+    }
+
+    // 全部上线：移除 + 同步直到稳定，期间重放旧版快照作为基线
+    NSDate *end = [epoch dateByAddingTimeInterval:rounds * hour];
+    for (AIUASimDevice *device in devices) {
+        device.online = YES;
+        [device.state mergeBaselineWithPurchases:earlySnapshot giftWords:0 remainingGiftWords:0 giftAwarded:NO consumedWords:0];
+        [device.shadow mergeBaselineWithPurchases:earlySnapshot giftWords:0 remainingGiftWords:0 giftAwarded:NO consumedWords:0];
+    }
+    NSUInteger healRounds = 0;
+    BOOL changed = YES;
+    while (changed && healRounds < 10) {
+        changed = NO;
+        for (AIUASimDevice *device in devices) {
+            changed |= [device.state pruneLotsExpiredBeforeDate:end];
+        }
+        changed |= AIUASimSync(devices, cloud, shadowCloud, &random);
+        healRounds++;
+    }
+    AIUA_CHECK_MSG(!changed, "种子 %llu：同步 10 轮后仍在变化（移除记录与合并来回覆盖）", seed);
+
+    NSDictionary *expectedView = AIUASimView(devices[0].shadow, end);
+    NSInteger expectedConsumed = devices[0].shadow.consumedWords;
+    NSUInteger prunedTotal = 0;
+    NSUInteger entryBytes = 0;
+    NSUInteger shadowEntryBytes = 0;
+    for (AIUASimDevice *device in devices) {
+        AIUA_CHECK_MSG([AIUASimView(device.state, end) isEqualToDictionary:expectedView], "种子 %llu %s：余额未收敛",
+                       seed, device.deviceID.UTF8String);
+        AIUA_CHECK_MSG([AIUASimView(device.shadow, end) isEqualToDictionary:expectedView], "种子 %llu %s：影子余额未收敛",
+                       seed, device.deviceID.UTF8String);
+        AIUA_CHECK(device.state.consumedWords == expectedConsumed);
+        NSString *offending = nil;
+        AIUA_CHECK_MSG(AIUASimNoResurrection(device.state, &offending), "种子 %llu：%s", seed, offending.UTF8String);
+        // 重放全部旧条目后不再有变化
+        for (NSDictionary *stale in device.staleEntries) {
+            AIUA_CHECK(![device.state mergeEntry:stale forDeviceID:device.deviceID]);
+        }
+        prunedTotal += AIUASimPrunedCount([device.state localEntry]);
+        entryBytes += [NSPropertyListSerialization dataWithPropertyList:[device.state localEntry]
+                                                                 format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil].length;
+        shadowEntryBytes += [NSPropertyListSerialization dataWithPropertyList:[device.shadow localEntry]
+                                                                       format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil].length;
+    }
+    AIUA_CHECK(expectedConsumed == stats.recordedConsumption);
+
+    printf("  种子 %2llu  %lu 台  在线率 %.1f  操作 %4lu  移除 %3lu 次（移除记录 %3lu）  重放旧条目 %3lu 次  收敛轮数 %lu  "
+           "本设备条目 %6.1f KB（不移除 %6.1f KB）  余额 %ld  %s\n",
+           seed, (unsigned long)deviceCount, onlineRate, (unsigned long)stats.operations, (unsigned long)stats.prunes,
+           (unsigned long)prunedTotal, (unsigned long)stats.staleReplays, (unsigned long)healRounds,
+           entryBytes / 1024.0 / deviceCount, shadowEntryBytes / 1024.0 / deviceCount, (long)AIUASimBalance(expectedView),
+           AIUATestFailures == failuresBefore ? "通过" : "失败");
+    return AIUATestFailures == failuresBefore;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        uint64_t first = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+        uint64_t count = argc > 2 ? strtoull(argv[2], NULL, 10) : 20;
+        printf("[AIUAWordPackSyncState] N 设备模拟（400 轮，每轮 1 小时）\n");
+        for (uint64_t seed = first; seed < first + count; seed++) {
+            @autoreleasepool {
+                AIUASimRun(seed);
+            }
+        }
+        return AIUATestSummary("AIUAWordPackSyncSimulation");
+    }
+}
@@ -0,0 +1,293 @@
+//
+//  AIUAWritingMigratorTests.m
+//  AIUniversalAssistant
+//
+//  AIUAWritingMigrator 断点续跑测试：由合成的 5000 条旧版 AIUAWritings.plist 导入存储后执行两个迁移步骤
+//  - 子进程执行迁移，在 v1 的第 2345 条记录处直接 _exit（相当于被杀进程），检查 writings.meta 停在 v0 与第 2200 条的断点
+//  - 再起一个子进程续跑：v1 从断点继续并完成，在 v2 的第 1000 条处再次退出，writings.meta 为 v1 与第 800 条的断点
+//  - 本进程续跑到结束：每条记录的每个步骤恰好生效一次、v2 在 v1 之后，断点之后重复交给 transform 的记录不超过 199 条，
+//    writings.meta 为 v2 且没有断点，再次执行时不再调用 transform
+//  另对同样的数据不中断地迁移一次，输出导入、各段与完整迁移的耗时
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAWritingMigratorTests [记录数]（子进程：AIUAWritingMigratorTests --interrupt 存储目录 版本 第几条）
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWritingMigrator.h"
+#import "AIUAWritingStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+// 与 AIUAWritingMigrator.m 的断点间隔一致
+static const NSUInteger kAIUATestCheckpointInterval = 200;
+static const int kAIUATestInterruptedStatus = 3;
+
+typedef struct {
+    NSUInteger invocations;        // transform 被调用次数
+    NSUInteger alreadyApplied;     // 其中记录已迁移过、返回 nil 的次数
+    NSUInteger outOfOrder;         // v2 遇到尚未经过 v1 的记录
+} AIUATestStepStats;
+
+static NSDictionary *AIUATestLegacyRecord(NSUInteger index, AIUATestRandom *random) {
+    NSMutableString *content = [NSMutableString string];
+    NSUInteger paragraphs = 1 + AIUATestRandomBelow(random, 4);
+    for (NSUInteger i = 0; i < paragraphs; i++) {
+        [content appendFormat:@"第 %lu 段 清晨的街角升起白色的雾气。\n", (unsigned long)AIUATestRandomBelow(random, 1000)];
+    }
+    NSMutableDictionary *record = [@{@"title": [NSString stringWithFormat:@"文档 %lu", (unsigned long)index],
+                                     @"content": content,
+                                     @"type": @"doc",
+                                     @"createTime": @"2025-01-01 12:00:00",
+                                     // 旧版按 NSString.length 统计
+                                     @"wordCount": @(content.length)} mutableCopy];
+    // 极早期的记录没有 id，导入时补 legacy_<下标>
+    if (index % 500 != 7) {
+        record[@"id"] = [NSString stringWithFormat:@"w-%05lu", (unsigned long)index];
+    }
+    return record;
+}
+
+static NSInteger AIUATestVisibleLength(NSString *text) {
+    NSInteger count = 0;
+    for (NSUInteger i = 0; i < text.length; i++) {
+        count += ![[NSCharacterSet whitespaceAndNewlineCharacterSet] characterIsMember:[text characterAtIndex:i]];
+    }
+    return count;
+}
+
+static BOOL AIUATestHasApplied(NSDictionary *record, NSString *step) {
+    NSArray *applied = record[@"appliedSteps"];
+    return [applied isKindOfClass:[NSArray class]] && [applied containsObject:step];
+}
+
+static NSDictionary *AIUATestAppendStep(NSMutableDictionary *record, NSString *step) {
+    NSArray *applied = [record[@"appliedSteps"] isKindOfClass:[NSArray class]] ? record[@"appliedSteps"] : @[];
+    record[@"appliedSteps"] = [applied arrayByAddingObject:step];
+    return [record copy];
+}
+
+/**
+ * 注册两个步骤；transform 与真实步骤一样可重入：已迁移的记录返回 nil
+ * interruptVersion 大于 0 时，该步骤第 interruptAt 次调用时直接退出进程
+ */
+static AIUAWritingMigrator *AIUATestMigrator(AIUAWritingStore *store, AIUATestStepStats *stats,
+                                             NSInteger interruptVersion, NSUInteger interruptAt) {
+    AIUAWritingMigrator *migrator = [[AIUAWritingMigrator alloc] initWithStore:store];
+    [migrator registerVersion:2 name:@"type" transform:^NSDictionary *(NSDictionary *record) {
+        stats[1].invocations += 1;
+        if (interruptVersion == 2 && stats[1].invocations == interruptAt) {
+            _exit(kAIUATestInterruptedStatus);
+        }
+        stats[1].outOfOrder += !AIUATestHasApplied(record, @"v1");
+        if (AIUATestHasApplied(record, @"v2")) {
+            stats[1].alreadyApplied += 1;
+            return nil;
+        }
+        NSMutableDictionary *m = [record mutableCopy];
+        m[@"type"] = [record[@"type"] isEqual:@"doc"] ? @"document" : record[@"type"];
+        return AIUATestAppendStep(m, @"v2");
+    }];
+    [migrator registerVersion:1 name:@"wordCount" transform:^NSDictionary *(NSDictionary *record) {
+        stats[0].invocations += 1;
+        if (interruptVersion == 1 && stats[0].invocations == interruptAt) {
+            _exit(kAIUATestInterruptedStatus);
+        }
+        if (AIUATestHasApplied(record, @"v1")) {
+            stats[0].alreadyApplied += 1;
+            return nil;
+        }
+        NSMutableDictionary *m = [record mutableCopy];
+        m[@"wordCount"] = @(AIUATestVisibleLength([NSString stringWithFormat:@"%@%@", record[@"title"], record[@"content"]]));
+        return AIUATestAppendStep(m, @"v1");
+    }];
+    return migrator;
+}
+
+static AIUAWritingStore *AIUATestOpenStore(NSString *directory) {
+    return [[AIUAWritingStore alloc] initWithDirectoryPath:[directory stringByAppendingPathComponent:@"store"] summaryBuilder:nil];
+}
+
+// 执行到完成回调（回调在主队列），返回是否成功
+static BOOL AIUATestRunToCompletion(AIUAWritingMigrator *migrator, NSUInteger *modified) {
+    __block BOOL done = NO;
+    __block BOOL success = NO;
+    [migrator runPendingMigrationsWithCompletion:^(BOOL ok, NSUInteger modifiedCount) {
+        success = ok;
+        if (modified) {
+            *modified = modifiedCount;
+        }
+        done = YES;
+    }];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:120];
+    while (!done && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    return done && success;
+}
+
+// 直接读取磁盘上的存储头，不经过 AIUAWritingStore
+static NSDictionary *AIUATestReadMeta(NSString *directory) {
+    NSData *data = [NSData dataWithContentsOfFile:[[directory stringByAppendingPathComponent:@"store"] stringByAppendingPathComponent:@"writings.meta"]];
+    id meta = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil] : nil;
+    return [meta isKindOfClass:[NSDictionary class]] ? meta : @{};
+}
+
+// 断点为该步骤最后一个整 200 条处理完的记录
+static NSString *AIUATestExpectedCheckpoint(NSArray<NSString *> *recordIDs, NSUInteger interruptAt) {
+    NSUInteger completed = (interruptAt - 1) / kAIUATestCheckpointInterval * kAIUATestCheckpointInterval;
+    return completed > 0 ? recordIDs[completed - 1] : nil;
+}
+
+// 子进程：在指定步骤的第 interruptAt 条记录处退出，正常跑完时返回 0
+static int AIUATestInterruptedChild(NSString *directory, NSInteger version, NSUInteger interruptAt) {
+    AIUATestStepStats stats[2] = {{0}};
+    AIUAWritingMigrator *migrator = AIUATestMigrator(AIUATestOpenStore(directory), stats, version, interruptAt);
+    AIUATestRunToCompletion(migrator, NULL);
+    return 0;
+}
+
+// 起子进程迁移并等待其退出，返回退出码与耗时
+static int AIUATestSpawnInterrupted(const char *executable, NSString *directory, NSInteger version, NSUInteger interruptAt, double *elapsed) {
+    NSTask *task = [[NSTask alloc] init];
+    task.executableURL = [NSURL fileURLWithPath:@(executable)];
+    task.arguments = @[@"--interrupt", directory, @(version).stringValue, @(interruptAt).stringValue];
+    double start = AIUATestNow();
+    NSError *error = nil;
+    if (![task launchAndReturnError:&error]) {
+        fprintf(stderr, "无法启动子进程: %s\n", error.localizedDescription.UTF8String);
+        return -1;
+    }
+    [task waitUntilExit];
+    *elapsed = AIUATestNow() - start;
+    return task.terminationStatus;
+}
+
+static void AIUATestPrepareLegacy(NSString *directory, NSUInteger recordCount, double *importElapsed) {
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    NSString *plistPath = [directory stringByAppendingPathComponent:@"AIUAWritings.plist"];
+    AIUATestRandom random;
+    AIUATestRandomSeed(&random, 7);
+    NSMutableArray<NSDictionary *> *legacy = [NSMutableArray arrayWithCapacity:recordCount];
+    for (NSUInteger i = 0; i < recordCount; i++) {
+        [legacy addObject:AIUATestLegacyRecord(recordCount - 1 - i, &random)];
+    }
+    [legacy writeToFile:plistPath atomically:YES];
+
+    double start = AIUATestNow();
+    AIUAWritingStore *store = AIUATestOpenStore(directory);
+    [store importLegacyPlistAtPathIfNeeded:plistPath];
+    *importElapsed = AIUATestNow() - start;
+    AIUA_CHECK(store.count == recordCount);
+    AIUA_CHECK(![[NSFileManager defaultManager] fileExistsAtPath:plistPath]);
+    AIUA_CHECK(store.schemaVersion == 0 && store.migrationCheckpoint == nil);
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        if (argc == 5 && strcmp(argv[1], "--interrupt") == 0) {
+            return AIUATestInterruptedChild(@(argv[2]), (NSInteger)strtol(argv[3], NULL, 10), (NSUInteger)strtoul(argv[4], NULL, 10));
+        }
+        NSUInteger recordCount = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 5000;
+        recordCount = MAX(recordCount, (NSUInteger)2400);
+        const NSUInteger firstInterrupt = 2345;
+        const NSUInteger secondInterrupt = 1000;
+        NSString *root = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                          [NSString stringWithFormat:@"AIUAWritingMigratorTests-%d", getpid()]];
+        NSString *directory = [root stringByAppendingPathComponent:@"interrupted"];
+
+        double importElapsed = 0;
+        NSArray<NSString *> *recordIDs = nil;
+        // 子进程写存储期间本进程不持有打开的存储
+        @autoreleasepool {
+            AIUATestPrepareLegacy(directory, recordCount, &importElapsed);
+            recordIDs = [AIUATestOpenStore(directory) allRecordIDs];
+        }
+        AIUA_CHECK(recordIDs.count == recordCount && [recordIDs containsObject:@"legacy_7"]);
+
+        // 第一次中断：v1 进行中，存储头仍为 v0
+        double firstElapsed = 0;
+        int status = AIUATestSpawnInterrupted(argv[0], directory, 1, firstInterrupt, &firstElapsed);
+        AIUA_CHECK_MSG(status == kAIUATestInterruptedStatus, "子进程退出码 %d", status);
+        NSDictionary *meta = AIUATestReadMeta(directory);
+        AIUA_CHECK([meta[@"schemaVersion"] integerValue] == 0);
+        AIUA_CHECK_MSG([meta[@"migrationCheckpoint"] isEqual:AIUATestExpectedCheckpoint(recordIDs, firstInterrupt)],
+                       "断点 %s", [meta[@"migrationCheckpoint"] description].UTF8String);
+
+        // 第二次中断：v1 续跑完成，v2 进行中
+        double secondElapsed = 0;
+        status = AIUATestSpawnInterrupted(argv[0], directory, 2, secondInterrupt, &secondElapsed);
+        AIUA_CHECK_MSG(status == kAIUATestInterruptedStatus, "子进程退出码 %d", status);
+        meta = AIUATestReadMeta(directory);
+        AIUA_CHECK([meta[@"schemaVersion"] integerValue] == 1);
+        AIUA_CHECK_MSG([meta[@"migrationCheckpoint"] isEqual:AIUATestExpectedCheckpoint(recordIDs, secondInterrupt)],
+                       "断点 %s", [meta[@"migrationCheckpoint"] description].UTF8String);
+
+        // 本进程续跑到结束
+        AIUATestStepStats stats[2] = {{0}};
+        AIUAWritingStore *store = AIUATestOpenStore(directory);
+        AIUA_CHECK(store.schemaVersion == 1 && store.count == recordCount);
+        AIUAWritingMigrator *migrator = AIUATestMigrator(store, stats, 0, 0);
+        AIUA_CHECK([migrator needsMigration] && migrator.latestVersion == 2);
+        double start = AIUATestNow();
+        NSUInteger modified = 0;
+        AIUA_CHECK(AIUATestRunToCompletion(migrator, &modified));
+        double resumeElapsed = AIUATestNow() - start;
+        NSUInteger resumedFrom = (secondInterrupt - 1) / kAIUATestCheckpointInterval * kAIUATestCheckpointInterval;
+        AIUA_CHECK(stats[0].invocations == 0);
+        AIUA_CHECK(stats[1].invocations == recordCount - resumedFrom);
+        // 断点之后、被杀之前已改写的记录再次交给 transform，由 transform 识别后跳过
+        AIUA_CHECK(stats[1].alreadyApplied == secondInterrupt - 1 - resumedFrom);
+        AIUA_CHECK(stats[1].alreadyApplied < kAIUATestCheckpointInterval);
+        AIUA_CHECK(stats[1].outOfOrder == 0);
+        AIUA_CHECK(modified == recordCount - (secondInterrupt - 1));
+
+        meta = AIUATestReadMeta(directory);
+        AIUA_CHECK([meta[@"schemaVersion"] integerValue] == 2 && meta[@"migrationCheckpoint"] == nil);
+        AIUA_CHECK(store.schemaVersion == 2 && store.migrationCheckpoint == nil);
+
+        // 重新打开（回放日志），每条记录的每个步骤恰好生效一次
+        store = nil;
+        migrator = nil;
+        store = AIUATestOpenStore(directory);
+        NSArray *expectedSteps = @[@"v1", @"v2"];
+        NSUInteger wrong = 0;
+        for (NSDictionary *record in [store allRecords]) {
+            NSInteger expectedCount = AIUATestVisibleLength([NSString stringWithFormat:@"%@%@", record[@"title"], record[@"content"]]);
+            if (![record[@"appliedSteps"] isEqual:expectedSteps] || [record[@"wordCount"] integerValue] != expectedCount ||
+                ![record[@"type"] isEqual:@"document"]) {
+                wrong += 1;
+            }
+        }
+        AIUA_CHECK_MSG(wrong == 0, "%lu 条记录迁移结果不正确", (unsigned long)wrong);
+        AIUA_CHECK(store.count == recordCount);
+
+        // 已是最新版本：不再调用 transform
+        AIUATestStepStats again[2] = {{0}};
+        migrator = AIUATestMigrator(store, again, 0, 0);
+        AIUA_CHECK(![migrator needsMigration]);
+        AIUA_CHECK(AIUATestRunToCompletion(migrator, NULL));
+        AIUA_CHECK(again[0].invocations == 0 && again[1].invocations == 0);
+
+        // 对照：同样的数据不中断地迁移
+        NSString *uninterrupted = [root stringByAppendingPathComponent:@"uninterrupted"];
+        double referenceImport = 0;
+        AIUATestPrepareLegacy(uninterrupted, recordCount, &referenceImport);
+        AIUATestStepStats full[2] = {{0}};
+        migrator = AIUATestMigrator(AIUATestOpenStore(uninterrupted), full, 0, 0);
+        start = AIUATestNow();
+        AIUA_CHECK(AIUATestRunToCompletion(migrator, &modified));
+        double fullElapsed = AIUATestNow() - start;
+        AIUA_CHECK(full[0].invocations == recordCount && full[1].invocations == recordCount);
+        AIUA_CHECK(full[0].alreadyApplied == 0 && full[1].alreadyApplied == 0 && modified == 2 * recordCount);
+
+        printf("[AIUAWritingMigrator] %lu 条旧版记录，两个迁移步骤\n", (unsigned long)recordCount);
+        printf("  导入旧 plist            %9.1f ms\n", importElapsed * 1e3);
+        printf("  子进程 v1 中断于第 %lu 条 %9.1f ms（含进程启动）\n", (unsigned long)firstInterrupt, firstElapsed * 1e3);
+        printf("  子进程 v2 中断于第 %lu 条 %9.1f ms（含进程启动）\n", (unsigned long)secondInterrupt, secondElapsed * 1e3);
+        printf("  续跑 v2 到结束          %9.1f ms（重复交给 transform %lu 条）\n", resumeElapsed * 1e3, (unsigned long)stats[1].alreadyApplied);
+        printf("  不中断完整迁移          %9.1f ms\n", fullElapsed * 1e3);
+
+        [[NSFileManager defaultManager] removeItemAtPath:root error:nil];
+        return AIUATestSummary("AIUAWritingMigrator");
+    }
+}
@@ -0,0 +1,156 @@
+//
+//  AIUAWritingStoreBench.m
+//  AIUniversalAssistant
+//
+//  写作记录保存/删除基准：文档库 100、1000、10000 篇（每篇约 1500 字），统计单次操作的耗时
+//  - 保存：insertRecord: 新增一篇（追加一条日志）
+//  - 删除：removeRecordWithID:（追加一条墓碑），删除的是刚保存的文档，库大小保持不变
+//  - 重新打开：有索引快照时只回放快照之后的日志尾部
+//  - 整文件 plist：日志存储之前的实现，读取 AIUAWritings.plist、插入或删除后整文件写回（只测 5 次）
+//  核对：保存/删除后记录数正确，重新打开后记录数不变，否则退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAWritingStoreBench [每种库大小的保存/删除次数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWritingStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+static const NSUInteger kAIUABenchPlistRounds = 5;
+
+static NSDictionary *AIUABenchRecord(NSString *recordID, NSUInteger index, AIUATestRandom *random) {
+    NSMutableString *content = [NSMutableString string];
+    while (content.length < 1500) {
+        [content appendFormat:@"第 %lu 段：城市的清晨总是从一杯热豆浆开始，街角的早餐铺升起白色的雾气。", (unsigned long)AIUATestRandomBelow(random, 100)];
+    }
+    return @{@"id": recordID,
+             @"title": [NSString stringWithFormat:@"文档 %lu", (unsigned long)index],
+             @"content": content,
+             @"type": @"doc",
+             @"createTime": @"2026-10-17 12:00:00",
+             @"wordCount": @(content.length)};
+}
+
+static int AIUABenchCompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double AIUABenchPercentile(double *samples, NSUInteger count, double percentile) {
+    qsort(samples, count, sizeof(double), AIUABenchCompareDoubles);
+    return samples[MIN(count - 1, (NSUInteger)(count * percentile))];
+}
+
+static double AIUABenchAverage(const double *samples, NSUInteger count) {
+    double sum = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return sum / count;
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger rounds = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 200;
+        rounds = MAX(rounds, (NSUInteger)1);
+        const NSUInteger sizes[] = {100, 1000, 10000};
+        NSString *root = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                          [NSString stringWithFormat:@"AIUAWritingStoreBench-%d", getpid()]];
+        double *saveSamples = (double *)calloc(rounds, sizeof(double));
+        double *deleteSamples = (double *)calloc(rounds, sizeof(double));
+        AIUAWritingSummaryBuilder summaryBuilder = ^NSDictionary *(NSDictionary *record) {
+            return @{@"id": record[@"id"], @"title": record[@"title"] ?: @""};
+        };
+        AIUATestRandom random;
+        AIUATestRandomSeed(&random, 23);
+
+        printf("[AIUAWritingStore] 新增一篇并保存、再删除，各 %lu 次，单次耗时\n", (unsigned long)rounds);
+        printf("    篇数   保存 平均 / p95        删除 平均 / p95        重新打开    plist 保存   plist 删除\n");
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            NSUInteger size = sizes[s];
+            NSString *directory = [root stringByAppendingPathComponent:[NSString stringWithFormat:@"%lu", (unsigned long)size]];
+            NSString *storePath = [directory stringByAppendingPathComponent:@"store"];
+            [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+            AIUAWritingStore *store = [[AIUAWritingStore alloc] initWithDirectoryPath:storePath summaryBuilder:summaryBuilder];
+            NSMutableArray<NSDictionary *> *records = [NSMutableArray arrayWithCapacity:size];
+            for (NSUInteger i = 0; i < size; i++) {
+                NSDictionary *record = AIUABenchRecord([NSString stringWithFormat:@"doc-%06lu", (unsigned long)i], i, &random);
+                [records addObject:record];
+                [store insertRecord:record];
+            }
+
+            NSMutableArray<NSDictionary *> *fresh = [NSMutableArray arrayWithCapacity:rounds];
+            for (NSUInteger r = 0; r < rounds; r++) {
+                [fresh addObject:AIUABenchRecord([NSString stringWithFormat:@"new-%06lu", (unsigned long)r], size + r, &random)];
+            }
+            for (NSUInteger r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    double start = AIUATestNow();
+                    BOOL saved = [store insertRecord:fresh[r]];
+                    saveSamples[r] = AIUATestNow() - start;
+                    if (!saved || store.count != size + 1) {
+                        fprintf(stderr, "保存失败或记录数不正确\n");
+                        return 1;
+                    }
+                    start = AIUATestNow();
+                    BOOL removed = [store removeRecordWithID:fresh[r][@"id"]];
+                    deleteSamples[r] = AIUATestNow() - start;
+                    if (!removed || store.count != size) {
+                        fprintf(stderr, "删除失败或记录数不正确\n");
+                        return 1;
+                    }
+                }
+            }
+            double saveAverage = AIUABenchAverage(saveSamples, rounds);
+            double deleteAverage = AIUABenchAverage(deleteSamples, rounds);
+            double saveP95 = AIUABenchPercentile(saveSamples, rounds, 0.95);
+            double deleteP95 = AIUABenchPercentile(deleteSamples, rounds, 0.95);
+
+            // 重新打开：读取索引快照并回放尾部
+            store = nil;
+            double start = AIUATestNow();
+            AIUAWritingStore *reopened = [[AIUAWritingStore alloc] initWithDirectoryPath:storePath summaryBuilder:summaryBuilder];
+            double reopenElapsed = AIUATestNow() - start;
+            if (reopened.count != size) {
+                fprintf(stderr, "重新打开后记录数 %lu，期望 %lu\n", (unsigned long)reopened.count, (unsigned long)size);
+                return 1;
+            }
+            reopened = nil;
+
+            // 整文件 plist：保存读取后在开头插入并写回，删除读取后按 id 移除并写回
+            NSString *plistPath = [directory stringByAppendingPathComponent:@"AIUAWritings.plist"];
+            [records writeToFile:plistPath atomically:YES];
+            double plistSave = 0;
+            double plistDelete = 0;
+            for (NSUInteger r = 0; r < kAIUABenchPlistRounds; r++) {
+                @autoreleasepool {
+                    NSDictionary *record = fresh[r % rounds];
+                    start = AIUATestNow();
+                    NSMutableArray *writings = [[NSArray arrayWithContentsOfFile:plistPath] mutableCopy];
+                    [writings insertObject:record atIndex:0];
+                    [writings writeToFile:plistPath atomically:YES];
+                    plistSave += AIUATestNow() - start;
+
+                    start = AIUATestNow();
+                    writings = [[NSArray arrayWithContentsOfFile:plistPath] mutableCopy];
+                    NSUInteger index = [[writings valueForKey:@"id"] indexOfObject:record[@"id"]];
+                    if (index != NSNotFound) {
+                        [writings removeObjectAtIndex:index];
+                    }
+                    [writings writeToFile:plistPath atomically:YES];
+                    plistDelete += AIUATestNow() - start;
+                }
+            }
+
+            printf("  %6lu   %7.3f / %7.3f ms   %7.3f / %7.3f ms   %7.2f ms   %8.2f ms   %8.2f ms\n", (unsigned long)size,
+                   saveAverage * 1e3, saveP95 * 1e3, deleteAverage * 1e3, deleteP95 * 1e3, reopenElapsed * 1e3,
+                   plistSave / kAIUABenchPlistRounds * 1e3, plistDelete / kAIUABenchPlistRounds * 1e3);
+        }
+        [[NSFileManager defaultManager] removeItemAtPath:root error:nil];
+        free(saveSamples);
+        free(deleteSamples);
+        return 0;
+    }
+}
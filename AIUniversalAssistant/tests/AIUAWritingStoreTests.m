@@ -0,0 +1,287 @@
+//
+//  AIUAWritingStoreTests.m
+//  AIUniversalAssistant
+//
+//  AIUAWritingStore 日志损坏恢复测试：写入若干记录后关闭存储，直接改写 writings.log 再重新打开
+//  - 尾部写了一半（截断在头部或 payload 中间）、最后一条 CRC 错误、尾部多出垃圾字节：丢弃尾部并截断文件，之后可继续写入
+//  - 中间某条记录 payload 或头部（魔数、长度）损坏：只丢失这一条，之后校验通过的记录全部保留，文件不截断
+//  - 损坏的是更新或删除记录：被覆盖的旧版本、被删除的记录重新生效
+//  每个场景都删除 writings.idx 强制全量回放，并再打开一次确认结果稳定
+//  只依赖 Foundation，macOS 上由 make test 运行
+//  用法：AIUAWritingStoreTests
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWritingStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+// 与 AIUAWritingStore.m 的日志格式一致
+static const NSUInteger kAIUATestRecordHeaderSize = 24;
+static const NSUInteger kAIUATestRecordCount = 10;
+
+static NSString *AIUATestRecordID(NSUInteger index) {
+    return [NSString stringWithFormat:@"w-%03lu", (unsigned long)index];
+}
+
+static NSDictionary *AIUATestRecord(NSUInteger index, NSString *content) {
+    return @{@"id": AIUATestRecordID(index), @"title": [NSString stringWithFormat:@"文档 %lu", (unsigned long)index], @"content": content};
+}
+
+static NSString *AIUATestContent(NSUInteger index) {
+    return [NSString stringWithFormat:@"第 %lu 篇 清晨的街角升起白色的雾气。", (unsigned long)index];
+}
+
+// 重新打开前删除索引快照，保证从头回放整个日志
+static AIUAWritingStore *AIUATestReopen(NSString *directory) {
+    [[NSFileManager defaultManager] removeItemAtPath:[directory stringByAppendingPathComponent:@"writings.idx"] error:nil];
+    return [[AIUAWritingStore alloc] initWithDirectoryPath:directory summaryBuilder:^NSDictionary *(NSDictionary *record) {
+        return @{@"id": record[@"id"]};
+    }];
+}
+
+static NSString *AIUATestLogPath(NSString *directory) {
+    return [directory stringByAppendingPathComponent:@"writings.log"];
+}
+
+static NSMutableData *AIUATestReadLog(NSString *directory) {
+    return [[NSData dataWithContentsOfFile:AIUATestLogPath(directory)] mutableCopy];
+}
+
+static void AIUATestWriteLog(NSString *directory, NSData *log) {
+    [log writeToFile:AIUATestLogPath(directory) atomically:NO];
+}
+
+// 按头部中的 payload 长度遍历日志，返回每条记录的起始偏移（最后追加一个日志长度）
+static NSArray<NSNumber *> *AIUATestRecordOffsets(NSData *log) {
+    NSMutableArray<NSNumber *> *offsets = [NSMutableArray array];
+    const uint8_t *bytes = (const uint8_t *)log.bytes;
+    NSUInteger offset = 0;
+    while (offset + kAIUATestRecordHeaderSize <= log.length) {
+        [offsets addObject:@(offset)];
+        const uint8_t *p = bytes + offset + 16;
+        uint32_t payloadLength = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        offset += kAIUATestRecordHeaderSize + payloadLength;
+    }
+    [offsets addObject:@(log.length)];
+    return offsets;
+}
+
+// 新建存储并写入 w-000 ~ w-009
+static NSString *AIUATestPrepare(NSString *root, NSString *name) {
+    NSString *directory = [root stringByAppendingPathComponent:name];
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        for (NSUInteger i = 0; i < kAIUATestRecordCount; i++) {
+            [store insertRecord:AIUATestRecord(i, AIUATestContent(i))];
+        }
+    }
+    return directory;
+}
+
+/**
+ * 重新打开（两次）并核对：missing 中的记录不存在，其余 w-000 ~ w-009 内容正确，日志长度为 expectedLength
+ */
+static void AIUATestExpect(NSString *directory, NSString *scenario, NSIndexSet *missing, NSUInteger expectedLength) {
+    for (int pass = 0; pass < 2; pass++) {
+        @autoreleasepool {
+            AIUAWritingStore *store = AIUATestReopen(directory);
+            AIUA_CHECK_MSG(store.count == kAIUATestRecordCount - missing.count, "%s: 记录数 %lu", scenario.UTF8String, (unsigned long)store.count);
+            for (NSUInteger i = 0; i < kAIUATestRecordCount; i++) {
+                NSDictionary *record = [store recordWithID:AIUATestRecordID(i)];
+                if ([missing containsIndex:i]) {
+                    AIUA_CHECK_MSG(record == nil, "%s: %s 应丢失", scenario.UTF8String, AIUATestRecordID(i).UTF8String);
+                } else {
+                    AIUA_CHECK_MSG([record[@"content"] isEqualToString:AIUATestContent(i)], "%s: %s 内容不正确", scenario.UTF8String, AIUATestRecordID(i).UTF8String);
+                }
+            }
+            AIUA_CHECK_MSG(store.allSummaries.count == store.count, "%s: 摘要数与记录数不一致", scenario.UTF8String);
+        }
+        NSUInteger length = AIUATestReadLog(directory).length;
+        AIUA_CHECK_MSG(length == expectedLength, "%s: 日志长度 %lu，期望 %lu", scenario.UTF8String, (unsigned long)length, (unsigned long)expectedLength);
+    }
+}
+
+// 恢复后还能继续写入，新记录重新打开后可读
+static void AIUATestExpectWritable(NSString *directory, NSString *scenario) {
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        AIUA_CHECK_MSG([store insertRecord:AIUATestRecord(99, @"恢复后写入")], "%s: 恢复后写入失败", scenario.UTF8String);
+    }
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        AIUA_CHECK_MSG([[store recordWithID:AIUATestRecordID(99)][@"content"] isEqualToString:@"恢复后写入"],
+                       "%s: 恢复后写入的记录丢失", scenario.UTF8String);
+    }
+}
+
+static void AIUATestFlipByte(NSMutableData *log, NSUInteger offset) {
+    ((uint8_t *)log.mutableBytes)[offset] ^= 0x5A;
+}
+
+static void AIUATestTornTail(NSString *root) {
+    NSString *directory = AIUATestPrepare(root, @"torn-template");
+    NSData *log = AIUATestReadLog(directory);
+    NSArray<NSNumber *> *offsets = AIUATestRecordOffsets(log);
+    AIUA_CHECK(offsets.count == kAIUATestRecordCount + 1);
+    NSUInteger last = offsets[kAIUATestRecordCount - 1].unsignedIntegerValue;
+    NSUInteger lastLength = log.length - last;
+    // 截断在头部内、头部边界、payload 中、最后一个字节之前
+    const NSUInteger cuts[] = {1, 4, 17, kAIUATestRecordHeaderSize - 1, kAIUATestRecordHeaderSize, kAIUATestRecordHeaderSize + 3, lastLength / 2, lastLength - 1};
+    for (size_t c = 0; c < sizeof(cuts) / sizeof(cuts[0]); c++) {
+        NSString *scenario = [NSString stringWithFormat:@"尾部写了一半（保留 %lu 字节）", (unsigned long)cuts[c]];
+        NSString *torn = [root stringByAppendingPathComponent:[NSString stringWithFormat:@"torn-%lu", (unsigned long)cuts[c]]];
+        [[NSFileManager defaultManager] createDirectoryAtPath:torn withIntermediateDirectories:YES attributes:nil error:nil];
+        AIUATestWriteLog(torn, [log subdataWithRange:NSMakeRange(0, last + cuts[c])]);
+        AIUATestExpect(torn, scenario, [NSIndexSet indexSetWithIndex:kAIUATestRecordCount - 1], last);
+        AIUATestExpectWritable(torn, scenario);
+    }
+}
+
+static void AIUATestCorruptTail(NSString *root) {
+    NSString *directory = AIUATestPrepare(root, @"tail-crc");
+    NSMutableData *log = AIUATestReadLog(directory);
+    NSArray<NSNumber *> *offsets = AIUATestRecordOffsets(log);
+    NSUInteger last = offsets[kAIUATestRecordCount - 1].unsignedIntegerValue;
+    AIUATestFlipByte(log, log.length - 2);
+    AIUATestWriteLog(directory, log);
+    AIUATestExpect(directory, @"最后一条 CRC 错误", [NSIndexSet indexSetWithIndex:kAIUATestRecordCount - 1], last);
+    AIUATestExpectWritable(directory, @"最后一条 CRC 错误");
+
+    directory = AIUATestPrepare(root, @"tail-garbage");
+    log = AIUATestReadLog(directory);
+    NSUInteger validLength = log.length;
+    // 垃圾中含一个魔数，恢复不能把它当作记录
+    const uint8_t garbage[] = {0x41, 0x49, 0x55, 0x57, 0x01, 0, 0, 0, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB,
+                               0x10, 0, 0, 0, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB, 0xAB};
+    [log appendBytes:garbage length:sizeof(garbage)];
+    AIUATestWriteLog(directory, log);
+    AIUATestExpect(directory, @"尾部多出垃圾字节", [NSIndexSet indexSet], validLength);
+    AIUATestExpectWritable(directory, @"尾部多出垃圾字节");
+}
+
+// 中间的第 4 条记录按 corrupt 改写，之后的记录都应保留且文件长度不变
+static void AIUATestCorruptMiddle(NSString *root, NSString *name, NSString *scenario, void (^corrupt)(NSMutableData *log, NSUInteger offset)) {
+    NSString *directory = AIUATestPrepare(root, name);
+    NSMutableData *log = AIUATestReadLog(directory);
+    NSUInteger length = log.length;
+    corrupt(log, AIUATestRecordOffsets(log)[4].unsignedIntegerValue);
+    AIUATestWriteLog(directory, log);
+    AIUATestExpect(directory, scenario, [NSIndexSet indexSetWithIndex:4], length);
+    AIUATestExpectWritable(directory, scenario);
+
+    // 压缩后损坏的字节被丢弃，记录不变
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        [store compact];
+    }
+    AIUA_CHECK_MSG(AIUATestRecordOffsets(AIUATestReadLog(directory)).count == kAIUATestRecordCount + 1,
+                   "%s: 压缩后日志仍有失效数据", scenario.UTF8String);
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        AIUA_CHECK_MSG(store.count == kAIUATestRecordCount, "%s: 压缩后记录数 %lu", scenario.UTF8String, (unsigned long)store.count);
+        AIUA_CHECK_MSG([store recordWithID:AIUATestRecordID(4)] == nil && [store recordWithID:AIUATestRecordID(9)] != nil,
+                       "%s: 压缩后记录不正确", scenario.UTF8String);
+    }
+}
+
+static void AIUATestWriteU32(NSMutableData *log, NSUInteger offset, uint32_t value) {
+    uint8_t *p = (uint8_t *)log.mutableBytes + offset;
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static void AIUATestMiddle(NSString *root) {
+    AIUATestCorruptMiddle(root, @"middle-payload", @"中间记录 payload 损坏", ^(NSMutableData *log, NSUInteger offset) {
+        AIUATestFlipByte(log, offset + kAIUATestRecordHeaderSize + 8);
+    });
+    AIUATestCorruptMiddle(root, @"middle-crc", @"中间记录 CRC 字段损坏", ^(NSMutableData *log, NSUInteger offset) {
+        AIUATestFlipByte(log, offset + 21);
+    });
+    AIUATestCorruptMiddle(root, @"middle-magic", @"中间记录魔数损坏", ^(NSMutableData *log, NSUInteger offset) {
+        AIUATestFlipByte(log, offset);
+    });
+    AIUATestCorruptMiddle(root, @"middle-length-huge", @"中间记录长度超出文件", ^(NSMutableData *log, NSUInteger offset) {
+        AIUATestWriteU32(log, offset + 16, 0xFFFFFFF0u);
+    });
+    AIUATestCorruptMiddle(root, @"middle-length-short", @"中间记录长度变短", ^(NSMutableData *log, NSUInteger offset) {
+        AIUATestWriteU32(log, offset + 16, 3);
+    });
+    AIUATestCorruptMiddle(root, @"middle-zeroed", @"中间记录被清零", ^(NSMutableData *log, NSUInteger offset) {
+        NSUInteger next = AIUATestRecordOffsets(log)[5].unsignedIntegerValue;
+        memset((uint8_t *)log.mutableBytes + offset, 0, next - offset);
+    });
+}
+
+// 损坏的是更新或删除记录：回放跳过它，之前的版本重新生效
+static void AIUATestCorruptOverwrite(NSString *root) {
+    NSString *directory = AIUATestPrepare(root, @"overwrite");
+    @autoreleasepool {
+        AIUAWritingStore *store = AIUATestReopen(directory);
+        [store updateRecord:AIUATestRecord(3, @"更新后的内容")];
+        [store removeRecordWithID:AIUATestRecordID(6)];
+        [store insertRecord:AIUATestRecord(10, @"之后写入")];
+    }
+    NSMutableData *log = AIUATestReadLog(directory);
+    NSArray<NSNumber *> *offsets = AIUATestRecordOffsets(log);
+    AIUA_CHECK(offsets.count == kAIUATestRecordCount + 4);
+    NSUInteger length = log.length;
+    AIUATestFlipByte(log, offsets[kAIUATestRecordCount].unsignedIntegerValue + kAIUATestRecordHeaderSize + 4);
+    AIUATestFlipByte(log, offsets[kAIUATestRecordCount + 1].unsignedIntegerValue + kAIUATestRecordHeaderSize);
+    AIUATestWriteLog(directory, log);
+
+    for (int pass = 0; pass < 2; pass++) {
+        @autoreleasepool {
+            AIUAWritingStore *store = AIUATestReopen(directory);
+            AIUA_CHECK(store.count == kAIUATestRecordCount + 1);
+            AIUA_CHECK([[store recordWithID:AIUATestRecordID(3)][@"content"] isEqualToString:AIUATestContent(3)]);
+            AIUA_CHECK([[store recordWithID:AIUATestRecordID(6)][@"content"] isEqualToString:AIUATestContent(6)]);
+            AIUA_CHECK([[store recordWithID:AIUATestRecordID(10)][@"content"] isEqualToString:@"之后写入"]);
+        }
+        AIUA_CHECK(AIUATestReadLog(directory).length == length);
+    }
+}
+
+// 有索引快照时尾部损坏：快照覆盖的部分不受影响，只回放并截断快照之后的尾部
+static void AIUATestCorruptAfterSnapshot(NSString *root) {
+    NSString *directory = [root stringByAppendingPathComponent:@"snapshot"];
+    NSUInteger total = 40;
+    @autoreleasepool {
+        AIUAWritingStore *store = [[AIUAWritingStore alloc] initWithDirectoryPath:directory summaryBuilder:nil];
+        for (NSUInteger i = 0; i < total; i++) {
+            [store insertRecord:AIUATestRecord(i, AIUATestContent(i))];
+        }
+    }
+    NSMutableData *log = AIUATestReadLog(directory);
+    NSArray<NSNumber *> *offsets = AIUATestRecordOffsets(log);
+    NSUInteger last = offsets[total - 1].unsignedIntegerValue;
+    AIUA_CHECK([[NSFileManager defaultManager] fileExistsAtPath:[directory stringByAppendingPathComponent:@"writings.idx"]]);
+    [log setLength:last + 10];
+    AIUATestWriteLog(directory, log);
+    @autoreleasepool {
+        AIUAWritingStore *store = [[AIUAWritingStore alloc] initWithDirectoryPath:directory summaryBuilder:nil];
+        AIUA_CHECK(store.count == total - 1);
+        AIUA_CHECK([store recordWithID:AIUATestRecordID(total - 1)] == nil);
+        AIUA_CHECK([[store recordWithID:AIUATestRecordID(total - 2)][@"content"] isEqualToString:AIUATestContent(total - 2)]);
+    }
+    AIUA_CHECK(AIUATestReadLog(directory).length == last);
+}
+
+int main(void) {
+    @autoreleasepool {
+        NSString *root = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                          [NSString stringWithFormat:@"AIUAWritingStoreTests-%d", getpid()]];
+        [[NSFileManager defaultManager] removeItemAtPath:root error:nil];
+
+        AIUATestTornTail(root);
+        AIUATestCorruptTail(root);
+        AIUATestMiddle(root);
+        AIUATestCorruptOverwrite(root);
+        AIUATestCorruptAfterSnapshot(root);
+
+        [[NSFileManager defaultManager] removeItemAtPath:root error:nil];
+        return AIUATestSummary("AIUAWritingStore");
+    }
+}
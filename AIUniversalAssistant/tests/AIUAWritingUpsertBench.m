@@ -0,0 +1,179 @@
+//
+//  AIUAWritingUpsertBench.m
+//  AIUniversalAssistant
+//
+//  文档编辑保存基准：文档库 100 ~ 10000 篇（每篇约 1500 字），反复编辑同一篇并保存，统计每次保存的耗时
+//  - 原位更新：与 AIUADataManager upsertWriting: 相同的读取-合并-比较-追加（不含搜索索引更新）
+//  - 未修改：定时自动保存时内容没有变化，比较后跳过写入
+//  - 删除后追加：旧的 saveDocumentIfNeeded（deleteWritingWithID: + saveWritingToPlist:，两条日志且记录移到末尾）
+//  - 整文件 plist：日志存储之前的实现，每次保存读取并重写两次 AIUAWritings.plist（只测 5 次）
+//  核对：原位更新后记录数与列表位置不变，重新打开存储后读到最后一次编辑的内容，否则退出码为 1
+//  只依赖 Foundation，macOS 上由 make bench 运行
+//  用法：AIUAWritingUpsertBench [每种库大小的保存次数]
+//
+
+#import <Foundation/Foundation.h>
+#import "AIUAWritingStore.h"
+#include "AIUATestSupport.h"
+#include <unistd.h>
+
+static const NSUInteger kAIUABenchPlistRounds = 5;
+
+static NSDictionary *AIUABenchRecord(NSUInteger index, AIUATestRandom *random) {
+    NSMutableString *content = [NSMutableString string];
+    while (content.length < 1500) {
+        [content appendFormat:@"第 %lu 段：城市的清晨总是从一杯热豆浆开始，街角的早餐铺升起白色的雾气。", (unsigned long)AIUATestRandomBelow(random, 100)];
+    }
+    return @{@"id": [NSString stringWithFormat:@"doc-%06lu", (unsigned long)index],
+             @"title": [NSString stringWithFormat:@"文档 %lu", (unsigned long)index],
+             @"content": content,
+             @"type": @"doc",
+             @"createTime": @"2026-10-17 12:00:00",
+             @"wordCount": @(content.length)};
+}
+
+// 与 AIUADataManager upsertWriting: 一致（不含搜索索引更新）
+static BOOL AIUABenchUpsert(AIUAWritingStore *store, NSDictionary *writingRecord) {
+    __block BOOL exists = NO;
+    BOOL written = [store transformRecordWithID:writingRecord[@"id"] usingBlock:^NSDictionary *(NSDictionary *record) {
+        exists = YES;
+        NSMutableDictionary *merged = [record mutableCopy];
+        [merged addEntriesFromDictionary:writingRecord];
+        if ([merged isEqualToDictionary:record]) {
+            return nil;
+        }
+        return [merged copy];
+    }];
+    if (!exists) {
+        written = [store insertRecord:writingRecord];
+    }
+    return written;
+}
+
+// 列表摘要只保留 id，用于核对排序位置
+static NSArray<NSString *> *AIUABenchListOrder(AIUAWritingStore *store) {
+    return [[store allSummaries] valueForKey:@"id"];
+}
+
+static int AIUABenchCompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static double AIUABenchPercentile(double *samples, NSUInteger count, double percentile) {
+    qsort(samples, count, sizeof(double), AIUABenchCompareDoubles);
+    return samples[MIN(count - 1, (NSUInteger)(count * percentile))];
+}
+
+int main(int argc, char **argv) {
+    @autoreleasepool {
+        NSUInteger rounds = argc > 1 ? (NSUInteger)strtoul(argv[1], NULL, 10) : 200;
+        rounds = MAX(rounds, (NSUInteger)1);
+        const NSUInteger sizes[] = {100, 1000, 5000, 10000};
+        NSString *root = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                          [NSString stringWithFormat:@"AIUAWritingUpsertBench-%d", getpid()]];
+        double *samples = (double *)calloc(rounds, sizeof(double));
+        AIUAWritingSummaryBuilder summaryBuilder = ^NSDictionary *(NSDictionary *record) {
+            return @{@"id": record[@"id"]};
+        };
+        AIUATestRandom random;
+        AIUATestRandomSeed(&random, 17);
+
+        printf("[AIUAWritingStore] 编辑同一篇文档并保存 %lu 次，每次保存的耗时\n", (unsigned long)rounds);
+        printf("    篇数   原位更新 平均 / p95      未修改     删除后追加   整文件 plist\n");
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            NSUInteger size = sizes[s];
+            NSString *directory = [root stringByAppendingPathComponent:[NSString stringWithFormat:@"%lu", (unsigned long)size]];
+            [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+            AIUAWritingStore *store = [[AIUAWritingStore alloc] initWithDirectoryPath:[directory stringByAppendingPathComponent:@"store"]
+                                                                       summaryBuilder:summaryBuilder];
+            NSMutableArray<NSDictionary *> *records = [NSMutableArray arrayWithCapacity:size];
+            for (NSUInteger i = 0; i < size; i++) {
+                NSDictionary *record = AIUABenchRecord(i, &random);
+                [records addObject:record];
+                [store insertRecord:record];
+            }
+            NSDictionary *target = records[size / 2];
+            NSUInteger position = [AIUABenchListOrder(store) indexOfObject:target[@"id"]];
+
+            // 原位更新：每次在正文末尾多输入一个字
+            NSMutableDictionary *edited = [target mutableCopy];
+            NSMutableString *content = [target[@"content"] mutableCopy];
+            double upsertSum = 0;
+            for (NSUInteger r = 0; r < rounds; r++) {
+                [content appendString:@"字"];
+                edited[@"content"] = [content copy];
+                edited[@"wordCount"] = @(content.length);
+                double start = AIUATestNow();
+                if (!AIUABenchUpsert(store, edited)) {
+                    fprintf(stderr, "原位更新失败\n");
+                    return 1;
+                }
+                samples[r] = AIUATestNow() - start;
+                upsertSum += samples[r];
+            }
+            double upsertP95 = AIUABenchPercentile(samples, rounds, 0.95);
+            if (store.count != size || [AIUABenchListOrder(store) indexOfObject:target[@"id"]] != position) {
+                fprintf(stderr, "原位更新改变了记录数或列表位置\n");
+                return 1;
+            }
+
+            // 未修改：自动保存时比较后跳过
+            double unchangedSum = 0;
+            for (NSUInteger r = 0; r < rounds; r++) {
+                double start = AIUATestNow();
+                if (AIUABenchUpsert(store, edited)) {
+                    fprintf(stderr, "内容未变化时不应写入\n");
+                    return 1;
+                }
+                unchangedSum += AIUATestNow() - start;
+            }
+
+            // 删除后追加（旧实现），在另一篇文档上进行，不影响上面的核对
+            NSMutableDictionary *other = [records[size / 3] mutableCopy];
+            double replaceSum = 0;
+            for (NSUInteger r = 0; r < rounds; r++) {
+                other[@"content"] = [other[@"content"] stringByAppendingString:@"字"];
+                double start = AIUATestNow();
+                [store removeRecordWithID:other[@"id"]];
+                [store insertRecord:other];
+                replaceSum += AIUATestNow() - start;
+            }
+
+            // 整文件 plist：读取、删除后写回，再读取、插入后写回
+            NSString *plistPath = [directory stringByAppendingPathComponent:@"AIUAWritings.plist"];
+            [records writeToFile:plistPath atomically:YES];
+            double plistSum = 0;
+            for (NSUInteger r = 0; r < kAIUABenchPlistRounds; r++) {
+                double start = AIUATestNow();
+                NSMutableArray *writings = [[NSArray arrayWithContentsOfFile:plistPath] mutableCopy];
+                NSUInteger index = [[writings valueForKey:@"id"] indexOfObject:target[@"id"]];
+                if (index != NSNotFound) {
+                    [writings removeObjectAtIndex:index];
+                }
+                [writings writeToFile:plistPath atomically:YES];
+                writings = [[NSArray arrayWithContentsOfFile:plistPath] mutableCopy];
+                [writings insertObject:edited atIndex:0];
+                [writings writeToFile:plistPath atomically:YES];
+                plistSum += AIUATestNow() - start;
+            }
+
+            // 重新打开存储（回放日志），读到最后一次编辑
+            store = nil;
+            AIUAWritingStore *reopened = [[AIUAWritingStore alloc] initWithDirectoryPath:[directory stringByAppendingPathComponent:@"store"]
+                                                                          summaryBuilder:summaryBuilder];
+            if (![[reopened recordWithID:target[@"id"]][@"content"] isEqualToString:edited[@"content"]]) {
+                fprintf(stderr, "重新打开后没有读到最后一次编辑\n");
+                return 1;
+            }
+
+            printf("  %6lu   %7.3f / %7.3f ms   %7.3f ms   %8.3f ms   %9.2f ms\n", (unsigned long)size,
+                   upsertSum / rounds * 1e3, upsertP95 * 1e3, unchangedSum / rounds * 1e3,
+                   replaceSum / rounds * 1e3, plistSum / kAIUABenchPlistRounds * 1e3);
+        }
+        [[NSFileManager defaultManager] removeItemAtPath:root error:nil];
+        free(samples);
+        return 0;
+    }
+}
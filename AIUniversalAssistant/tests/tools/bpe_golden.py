@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+AIUABPETokenizer 的金标准数据生成工具（依赖 HuggingFace tokenizers：pip install tokenizers）
+
+  bpe_golden.py train  输出.json 语料...             用 DeepSeek-V3 同构的预分词配置训练一个小词表
+  bpe_golden.py golden tokenizer.json 输出.txt 文本...  按 tokenizers 的结果生成逐片段的期望 token
+
+golden 的输出是纯文本，C 测试无需解析 JSON：
+  ignore_merges <0|1>
+  vocab <N>           之后 N 行 "<id> <字节十六进制>"，无法还原为字节的特殊 token 写 "-"
+  merges <M>          之后 M 行 "<左 id> <右 id> <合并结果 id>"，按优先级顺序
+  cases <K>           之后 K 行 "<片段字节十六进制> <id,id,...>"
+词表字节的还原与合并规则的解析和 AIUATokenizer.m 的 compileTokenizerJSONAtPath: 保持一致
+"""
+
+import json
+import sys
+
+
+# DeepSeek-V3 tokenizer.json 的 pre_tokenizer（数字每 3 位一段、连续汉字/假名一段、其余按标点与空白切分，最后做字节映射）
+DEEPSEEK_PRE_TOKENIZER = {
+    "type": "Sequence",
+    "pretokenizers": [
+        {"type": "Split", "pattern": {"Regex": "\\p{N}{1,3}"}, "behavior": "Isolated", "invert": False},
+        {"type": "Split", "pattern": {"Regex": "[一-龥぀-ゟ゠-ヿ]+"}, "behavior": "Isolated", "invert": False},
+        {"type": "Split", "pattern": {"Regex": "[!\"#$%&'()*+,\\-./:;<=>?@\\[\\\\\\]^_`{|}~][A-Za-z]+|[^\r\n\\p{L}\\p{P}\\p{S}]?[\\p{L}\\p{M}]+| ?[\\p{P}\\p{S}]+[\r\n]*|\\s*[\r\n]+|\\s+(?!\\S)|\\s+"},
+         "behavior": "Isolated", "invert": False},
+        {"type": "ByteLevel", "add_prefix_space": False, "trim_offsets": True, "use_regex": False},
+    ],
+}
+
+
+def byte_decoder():
+    """GPT-2 bytes_to_unicode 的反向映射"""
+    printable = list(range(ord("!"), ord("~") + 1)) + list(range(0xA1, 0xAC + 1)) + list(range(0xAE, 0xFF + 1))
+    decoder = {}
+    extra = 0
+    for byte in range(256):
+        if byte in printable:
+            decoder[chr(byte)] = byte
+        else:
+            decoder[chr(256 + extra)] = byte
+            extra += 1
+    return decoder
+
+
+def train(output, corpus_paths):
+    from tokenizers import Tokenizer, models, pre_tokenizers, trainers, decoders
+
+    tokenizer = Tokenizer(models.BPE())
+    config = json.loads(tokenizer.to_str())
+    config["pre_tokenizer"] = DEEPSEEK_PRE_TOKENIZER
+    tokenizer = Tokenizer.from_str(json.dumps(config))
+    tokenizer.decoder = decoders.ByteLevel()
+    trainer = trainers.BpeTrainer(vocab_size=3000, min_frequency=2, show_progress=False,
+                                  initial_alphabet=pre_tokenizers.ByteLevel.alphabet(),
+                                  special_tokens=["<｜begin▁of▁sentence｜>", "<｜end▁of▁sentence｜>"])
+    tokenizer.train(corpus_paths, trainer)
+    tokenizer.save(output)
+
+
+def golden(tokenizer_path, output, text_paths):
+    from tokenizers import Tokenizer
+
+    with open(tokenizer_path, encoding="utf-8") as f:
+        config = json.load(f)
+    model = config["model"]
+    vocab = model["vocab"]
+    decoder = byte_decoder()
+
+    def token_bytes(token):
+        if all(c in decoder for c in token):
+            return bytes(decoder[c] for c in token)
+        return None
+
+    tokenizer = Tokenizer.from_file(tokenizer_path)
+    lines = ["ignore_merges %d" % (1 if model.get("ignore_merges") else 0)]
+    vocab_size = max(vocab.values()) + 1
+    by_id = {token_id: token for token, token_id in vocab.items()}
+    lines.append("vocab %d" % vocab_size)
+    for token_id in range(vocab_size):
+        raw = token_bytes(by_id[token_id]) if token_id in by_id else None
+        lines.append("%d %s" % (token_id, raw.hex() if raw else "-"))
+
+    merges = []
+    for merge in model["merges"]:
+        left, right = merge.split(" ", 1) if isinstance(merge, str) else merge
+        if left in vocab and right in vocab and left + right in vocab:
+            merges.append("%d %d %d" % (vocab[left], vocab[right], vocab[left + right]))
+    lines.append("merges %d" % len(merges))
+    lines.extend(merges)
+
+    # 逐片段调用 BPE 模型；同时核对片段结果拼接后与整段编码一致，确认逐片段比较等价于真实编码
+    cases = []
+    seen = set()
+    for path in text_paths:
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+        for paragraph in text.split("\n\n"):
+            if tokenizer.normalizer:
+                paragraph = tokenizer.normalizer.normalize_str(paragraph)
+            pieces = tokenizer.pre_tokenizer.pre_tokenize_str(paragraph)
+            joined = []
+            for piece, _ in pieces:
+                ids = [token.id for token in tokenizer.model.tokenize(piece)]
+                joined.extend(ids)
+                raw = token_bytes(piece)
+                if raw is not None and raw not in seen:
+                    seen.add(raw)
+                    cases.append("%s %s" % (raw.hex(), ",".join(str(i) for i in ids)))
+            expected = tokenizer.encode(paragraph, add_special_tokens=False).ids
+            if joined != expected:
+                sys.exit("逐片段结果与整段编码不一致：%r" % paragraph[:40])
+    lines.append("cases %d" % len(cases))
+    lines.extend(cases)
+    with open(output, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+    print("vocab=%d merges=%d cases=%d" % (vocab_size, len(merges), len(cases)))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) >= 4 and sys.argv[1] == "train":
+        train(sys.argv[2], sys.argv[3:])
+    elif len(sys.argv) >= 5 and sys.argv[1] == "golden":
+        golden(sys.argv[2], sys.argv[3], sys.argv[4:])
+    else:
+        sys.exit(__doc__)
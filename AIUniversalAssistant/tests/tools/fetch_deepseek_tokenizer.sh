@@ -0,0 +1,20 @@
+#!/bin/sh
+# 下载 DeepSeek 发布的 tokenizer.json，放到 DeepSeekV/AIUADeepSeekTokenizer.json（同步文件夹，加入后随应用打包）
+# AIUATokenizer 在应用包中找到它之后才会给出精确 token 数（isExact），否则按字符估算
+#   tools/fetch_deepseek_tokenizer.sh [模型仓库，默认 deepseek-ai/DeepSeek-V3]
+set -eu
+
+REPO="${1:-deepseek-ai/DeepSeek-V3}"
+DEST="$(cd "$(dirname "$0")/../../AIUniversalAssistant/DeepSeekV" && pwd)/AIUADeepSeekTokenizer.json"
+TMP="$DEST.download"
+
+curl -fL --retry 3 -o "$TMP" "https://huggingface.co/$REPO/resolve/main/tokenizer.json"
+# 只接受 BPE 模型，避免把错误页面打进应用包
+if ! grep -q '"type": *"BPE"' "$TMP"; then
+    rm -f "$TMP"
+    echo "下载的文件不是 BPE tokenizer.json" >&2
+    exit 1
+fi
+mv "$TMP" "$DEST"
+echo "已写入 $DEST"
+echo "生成金标准并运行测试：make -C $(cd "$(dirname "$0")/.." && pwd) golden TOKENIZER=$DEST"
@@ -0,0 +1,302 @@
+#!/usr/bin/env node
+/*
+ * 本地 SSE 模拟服务（server.js，MOCK_UPSTREAM=1）的命令行客户端，在没有 macOS 的环境下复现 Objective-C 基准的测量
+ *
+ *   sse_stub_client.js connect [服务地址] [请求数]
+ *       依次发送流式请求，比较每次新建连接（原写作器各自创建会话）与预连接后复用连接（AIUAHTTPSessionPool）
+ *       的建连耗时、响应头耗时与首 token 耗时
+ *
+ *   sse_stub_client.js resume [服务地址] [生成数] [并发数]
+ *       模拟服务需开启 MOCK_DISCONNECT_RATE（随机断线）。按 AIUADeepSeekWriter 的做法续传：携带 x-aiua-generation-id 与 x-aiua-resume-key，
+ *       断线后按指数退避（0.5s 起，翻倍，上限 8s，±20% 抖动）携带 Last-Event-ID 重连，按事件 id 丢弃重放的事件，
+ *       连续 5 次重连没有新事件则放弃。统计未断线 / 续传完成 / 最终失败的生成数；
+ *       模拟服务回显用户消息，完成的生成与原文不一致（重复或丢失内容）时退出码为 1；
+ *       最后校验续传归属（其他凭证续传返回 403）与每个生成的续传次数上限（超出返回 429）
+ *
+ * 服务地址默认 http://127.0.0.1:3000/ai；只使用 Node 内置模块
+ */
+
+"use strict";
+
+const http = require("http");
+const crypto = require("crypto");
+
+const DEFAULT_URL = "http://127.0.0.1:3000/ai";
+// 预连接后等待的时间（进入页面到用户开始输入），与 AIUAHTTPSessionPoolStubBench 一致
+const PRECONNECT_LEAD_MS = 500;
+// 与 AIUADeepSeekWriter 的 kAIUAStreamMaxResumeAttempts / kAIUAStreamResumeBaseDelay / kAIUAStreamResumeMaxDelay 一致
+const RESUME_MAX_ATTEMPTS = 5;
+const RESUME_BASE_DELAY_MS = 500;
+const RESUME_MAX_DELAY_MS = 8000;
+// 归属校验中同一凭证最多续传的次数，应大于服务端的 RESUME_MAX_PER_GENERATION
+const RESUME_GUARD_MAX_ATTEMPTS = 1000;
+
+function now() {
+  return Number(process.hrtime.bigint()) / 1e6;
+}
+
+function streamBody(content) {
+  return JSON.stringify({
+    model: "deepseek-chat",
+    stream: true,
+    max_tokens: 16,
+    messages: [{ role: "user", content }],
+  });
+}
+
+// 发送一个流式请求并读完响应，返回各阶段耗时（毫秒）
+function probe(url, agent, index) {
+  return new Promise((resolve, reject) => {
+    const start = now();
+    const timing = { connect: 0, headers: 0, firstData: 0, reused: false };
+    const body = streamBody(`你好 ${index}`);
+    const req = http.request(url, {
+      method: "POST",
+      agent,
+      headers: { "Content-Type": "application/json", Accept: "text/event-stream", "Content-Length": Buffer.byteLength(body) },
+    });
+    req.on("socket", (socket) => {
+      timing.reused = req.reusedSocket;
+      if (!socket.connecting) return;
+      socket.once("connect", () => {
+        timing.connect = now() - start;
+      });
+    });
+    req.on("response", (res) => {
+      timing.headers = now() - start;
+      if (res.statusCode !== 200) {
+        res.resume();
+        return reject(new Error(`HTTP ${res.statusCode}`));
+      }
+      // 读完整个响应（模拟服务回显的内容很短），连接才能留给下一个请求复用
+      res.once("data", () => {
+        timing.firstData = now() - start;
+      });
+      res.on("end", () => resolve(timing));
+      res.resume();
+    });
+    req.on("error", reject);
+    req.end(body);
+  });
+}
+
+function preconnect(url, agent) {
+  return new Promise((resolve) => {
+    const root = new URL("/", url);
+    const req = http.request(root, { method: "HEAD", agent }, (res) => {
+      res.resume();
+      res.on("end", resolve);
+    });
+    req.on("error", resolve);
+    req.end();
+  });
+}
+
+function average(values) {
+  return values.length ? values.reduce((a, b) => a + b, 0) / values.length : 0;
+}
+
+function report(name, timings) {
+  const reused = timings.filter((t) => t.reused).length;
+  console.log(
+    `  ${name.padEnd(14)} ${String(reused).padStart(4)} / ${String(timings.length).padEnd(4)}` +
+      ` ${average(timings.map((t) => t.connect)).toFixed(2).padStart(8)} ms` +
+      ` ${average(timings.map((t) => t.headers)).toFixed(2).padStart(8)} ms` +
+      ` ${timings[0].firstData.toFixed(1).padStart(9)} ms` +
+      ` ${average(timings.map((t) => t.firstData)).toFixed(1).padStart(9)} ms`
+  );
+}
+
+async function connectBench(url, count) {
+  console.log(`[connect] ${url.href}，每种方式 ${count} 个流式请求（依次发送）`);
+  console.log("  方式           复用连接    建连平均  响应头平均  首个请求首token  首token平均");
+
+  const fresh = [];
+  for (let i = 0; i < count; i++) {
+    const agent = new http.Agent({ keepAlive: false });
+    fresh.push(await probe(url, agent, i));
+    agent.destroy();
+  }
+  report("独立连接", fresh);
+
+  const shared = new http.Agent({ keepAlive: true, maxSockets: 1 });
+  await preconnect(url, shared);
+  await new Promise((resolve) => setTimeout(resolve, PRECONNECT_LEAD_MS));
+  const pooled = [];
+  for (let i = 0; i < count; i++) {
+    pooled.push(await probe(url, shared, i));
+  }
+  shared.destroy();
+  report("预连接+复用", pooled);
+}
+
+// 一次连接：返回收到的完整事件，以及连接是正常结束还是中途断开
+function streamOnce(url, agent, body, generationId, resumeKey, lastEventId) {
+  return new Promise((resolve) => {
+    const headers = {
+      "Content-Type": "application/json",
+      "Content-Length": Buffer.byteLength(body),
+      "x-aiua-generation-id": generationId,
+      "x-aiua-resume-key": resumeKey,
+    };
+    if (lastEventId > 0) headers["Last-Event-ID"] = String(lastEventId);
+    const events = [];
+    let settled = false;
+    const settle = (result) => {
+      if (settled) return;
+      settled = true;
+      resolve({ events, ...result });
+    };
+    const req = http.request(url, { method: "POST", agent, headers }, (res) => {
+      if (res.statusCode !== 200) {
+        res.resume();
+        return settle({ status: res.statusCode });
+      }
+      let pending = "";
+      res.setEncoding("utf8");
+      res.on("data", (chunk) => {
+        pending += chunk;
+        let index;
+        while ((index = pending.indexOf("\n\n")) >= 0) {
+          const event = { id: 0, data: [] };
+          for (const line of pending.slice(0, index).split("\n")) {
+            if (line.startsWith("id:")) event.id = Number(line.slice(3).trim());
+            else if (line.startsWith("data:")) event.data.push(line.slice(line.startsWith("data: ") ? 6 : 5));
+          }
+          events.push({ id: event.id, data: event.data.join("\n") });
+          pending = pending.slice(index + 2);
+        }
+      });
+      res.on("end", () => settle({ status: 200, complete: true }));
+      res.on("aborted", () => settle({ status: 200, complete: false }));
+      res.on("error", () => settle({ status: 200, complete: false }));
+    });
+    req.on("error", () => settle({ status: 0, complete: false }));
+    req.end(body);
+  });
+}
+
+async function resumableGeneration(url, agent, text, generationId = crypto.randomUUID(), resumeKey = crypto.randomUUID()) {
+  const body = streamBody(text);
+  let lastEventId = 0;
+  let output = "";
+  let done = false;
+  let failures = 0;
+  const result = { resumes: 0, replayed: 0 };
+  for (;;) {
+    const response = await streamOnce(url, agent, body, generationId, resumeKey, lastEventId);
+    if (response.status !== 200 && response.status !== 0) {
+      return { ...result, ok: false, reason: `HTTP ${response.status}` };
+    }
+    for (const event of response.events) {
+      // 重放的事件按 id 去重
+      if (event.id > 0 && event.id <= lastEventId) {
+        result.replayed += 1;
+        continue;
+      }
+      lastEventId = event.id || lastEventId;
+      failures = 0;
+      if (event.data === "[DONE]") {
+        done = true;
+        continue;
+      }
+      output += JSON.parse(event.data).choices[0].delta.content || "";
+    }
+    if (done || response.complete) {
+      return { ...result, ok: done, output, lastEventId, reason: done ? null : "stream ended without [DONE]" };
+    }
+    if (failures >= RESUME_MAX_ATTEMPTS) {
+      return { ...result, ok: false, reason: "gave up" };
+    }
+    failures += 1;
+    result.resumes += 1;
+    const delay = Math.min(RESUME_BASE_DELAY_MS * 2 ** (failures - 1), RESUME_MAX_DELAY_MS) * (0.8 + 0.4 * Math.random());
+    await new Promise((resolve) => setTimeout(resolve, delay));
+  }
+}
+
+async function resumeBench(url, count, concurrency) {
+  const agent = new http.Agent({ keepAlive: true });
+  const stats = { clean: 0, recovered: 0, failed: 0, corrupted: 0, resumes: 0, replayed: 0 };
+  const start = now();
+  let next = 0;
+  const worker = async () => {
+    while (next < count) {
+      const index = next++;
+      const text = `第 ${index} 次生成：` + "断线续传测试文本，".repeat(8) + `#${index}`;
+      const result = await resumableGeneration(url, agent, text);
+      stats.resumes += result.resumes;
+      stats.replayed += result.replayed;
+      if (!result.ok) {
+        stats.failed += 1;
+        console.error(`  生成 ${index} 失败：${result.reason}（重连 ${result.resumes} 次）`);
+      } else if (result.output !== text) {
+        stats.corrupted += 1;
+        console.error(`  生成 ${index} 内容不一致：期望 ${text.length} 字，收到 ${result.output.length} 字`);
+      } else if (result.resumes > 0) {
+        stats.recovered += 1;
+      } else {
+        stats.clean += 1;
+      }
+    }
+  };
+  await Promise.all(Array.from({ length: concurrency }, worker));
+  console.log(`[resume] ${url.href}，${count} 次生成，并发 ${concurrency}，耗时 ${((now() - start) / 1000).toFixed(1)} s`);
+  console.log(`  未断线 ${stats.clean}  断线后续传完成 ${stats.recovered}  最终失败 ${stats.failed}  内容不一致 ${stats.corrupted}`);
+  console.log(`  重连 ${stats.resumes} 次，丢弃重放事件 ${stats.replayed} 个`);
+  const guarded = await resumeGuards(url, agent);
+  agent.destroy();
+  return stats.corrupted === 0 && guarded;
+}
+
+// 续传归属与次数限制：换一个续传凭证（或不带）续传他人的生成应被拒绝（403），
+// 同一凭证反复续传已结束的生成，超过服务端每个生成的续传上限后返回 429
+async function resumeGuards(url, agent) {
+  const generationId = crypto.randomUUID();
+  const resumeKey = crypto.randomUUID();
+  const text = "续传归属校验文本";
+  const owned = await resumableGeneration(url, agent, text, generationId, resumeKey);
+  if (!owned.ok) {
+    console.error(`  归属校验：生成失败：${owned.reason}`);
+    return false;
+  }
+  const body = streamBody(text);
+  const foreign = await streamOnce(url, agent, body, generationId, crypto.randomUUID(), owned.lastEventId);
+  const fresh = await streamOnce(url, agent, body, generationId, crypto.randomUUID(), 0);
+  let allowed = 0;
+  let limited = 0;
+  while (allowed < RESUME_GUARD_MAX_ATTEMPTS) {
+    const response = await streamOnce(url, agent, body, generationId, resumeKey, owned.lastEventId);
+    if (response.status !== 200) {
+      limited = response.status;
+      break;
+    }
+    allowed += 1;
+  }
+  const ok = foreign.status === 403 && fresh.status === 403 && limited === 429;
+  console.log(
+    `  归属校验：其他凭证续传 HTTP ${foreign.status}，其他凭证重复生成 id HTTP ${fresh.status}，` +
+      `同一凭证续传 ${allowed} 次后 HTTP ${limited || "-"}${ok ? "" : "（不符合预期）"}`
+  );
+  return ok;
+}
+
+async function main() {
+  const [command, address, countArg, concurrencyArg] = process.argv.slice(2);
+  const url = new URL(address || DEFAULT_URL);
+  if (command === "connect") {
+    await connectBench(url, Math.max(1, Number(countArg) || 10));
+  } else if (command === "resume") {
+    const ok = await resumeBench(url, Math.max(1, Number(countArg) || 100), Math.max(1, Number(concurrencyArg) || 8));
+    process.exitCode = ok ? 0 : 1;
+  } else {
+    console.error("用法：sse_stub_client.js connect [服务地址] [请求数]");
+    console.error("      sse_stub_client.js resume [服务地址] [生成数] [并发数]");
+    process.exit(2);
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});